@@ -32,6 +32,11 @@
 #include "gdal_priv.h"
 #include "gdal_alg.h"
 #include "ogr_api.h"
+#include "cpl_multiproc.h"
+
+#include <map>
+#include <set>
+#include <vector>
 
 CPL_CVSID("$Id$");
 
@@ -138,6 +143,8 @@ class GDALContourGenerator
 
     GDALContourLevel *FindLevel( double dfLevel );
 
+    void   PerturbLine( double *padfLine );
+
 public:
     GDALContourWriter pfnWriter;
     void   *pWriterCBData;
@@ -153,6 +160,8 @@ public:
           this->dfContourOffset = dfContourOffset; }
 
     void                SetFixedLevels( int, double * );
+    void                SetStartLine( int iStartLine, 
+                                      double *padfPrevScanline );
     CPLErr              FeedLine( double *padfScanline );
     CPLErr              EjectContours( int bOnlyUnused = FALSE );
     
@@ -277,6 +286,53 @@ void GDALContourGenerator::SetNoData( double dfNewValue )
     dfNoDataValue = dfNewValue;
 }
 
+/************************************************************************/
+/*                            SetStartLine()                            */
+/*                                                                      */
+/*      Prepare the generator to start at scanline iStartLine           */
+/*      instead of the top of the raster, so that it only processes     */
+/*      a horizontal strip.  padfPrevScanline must hold the values      */
+/*      of scanline iStartLine-1.                                       */
+/************************************************************************/
+
+void GDALContourGenerator::SetStartLine( int iStartLine, 
+                                         double *padfPrevScanline )
+
+{
+    if( iStartLine <= 0 )
+        return;
+
+    memcpy( padfThisLine, padfPrevScanline, sizeof(double) * nWidth );
+    PerturbLine( padfThisLine );
+    iLine = iStartLine;
+}
+
+/************************************************************************/
+/*                            PerturbLine()                             */
+/*                                                                      */
+/*      Perturb any values that occur exactly on level boundaries.      */
+/************************************************************************/
+
+void GDALContourGenerator::PerturbLine( double *padfLine )
+
+{
+    int iPixel;
+
+    for( iPixel = 0; iPixel < nWidth; iPixel++ )
+    {
+        if( bNoDataActive && padfLine[iPixel] == dfNoDataValue )
+            continue;
+
+        double dfLevel = (padfLine[iPixel] - dfContourOffset) 
+            / dfContourInterval;
+
+        if( dfLevel - (int) dfLevel == 0.0 )
+        {
+            padfLine[iPixel] += dfContourInterval * FUDGE_EXACT;
+        }
+    }
+}
+
 /************************************************************************/
 /*                            ProcessPixel()                            */
 /************************************************************************/
@@ -744,21 +800,7 @@ CPLErr GDALContourGenerator::FeedLine( double *padfScanline )
 /* -------------------------------------------------------------------- */
 /*      Perturb any values that occur exactly on level boundaries.      */
 /* -------------------------------------------------------------------- */
-    int iPixel;
-
-    for( iPixel = 0; iPixel < nWidth; iPixel++ )
-    {
-        if( bNoDataActive && padfThisLine[iPixel] == dfNoDataValue )
-            continue;
-
-        double dfLevel = (padfThisLine[iPixel] - dfContourOffset) 
-            / dfContourInterval;
-
-        if( dfLevel - (int) dfLevel == 0.0 )
-        {
-            padfThisLine[iPixel] += dfContourInterval * FUDGE_EXACT;
-        }
-    }
+    PerturbLine( padfThisLine );
 
 /* -------------------------------------------------------------------- */
 /*      If this is the first line we need to initialize the previous    */
@@ -787,6 +829,8 @@ CPLErr GDALContourGenerator::FeedLine( double *padfScanline )
 /* -------------------------------------------------------------------- */
 /*      Process each pixel.                                             */
 /* -------------------------------------------------------------------- */
+    int iPixel;
+
     for( iPixel = 0; iPixel < nWidth+1; iPixel++ )
     {
         CPLErr eErr = ProcessPixel( iPixel );
@@ -1389,6 +1433,563 @@ CPLErr OGRContourWriter( double dfLevel,
 
     return CE_None;
 }
+
+/************************************************************************/
+/* ==================================================================== */
+/*                        Tiled contour generation                      */
+/* ==================================================================== */
+/*                                                                      */
+/*      The raster is split in horizontal strips that are contoured     */
+/*      independently, possibly by several threads.  Contours that      */
+/*      do not touch a strip border are written as soon as they are     */
+/*      closed, while the fragments ending on a border ("seam") are     */
+/*      kept aside and stitched together once the strips on both        */
+/*      sides of the seam have been processed.                          */
+/*                                                                      */
+/************************************************************************/
+
+/************************************************************************/
+/*                         GDALContourSeamKey                           */
+/*                                                                      */
+/*      Identifies the location of a fragment end point on a seam.      */
+/*      The X position is quantized in cells larger than JOIN_DIST,     */
+/*      so matching end points are in the same or adjacent cells.       */
+/************************************************************************/
+
+#define SEAM_CELLS_PER_PIXEL 1024
+
+typedef struct
+{
+    double  dfLevel;
+    int     nSeamLine;
+    GIntBig nCell;
+} GDALContourSeamKey;
+
+struct GDALContourSeamKeyLess
+{
+    bool operator()( const GDALContourSeamKey& a,
+                     const GDALContourSeamKey& b ) const
+    {
+        if( a.dfLevel != b.dfLevel )
+            return a.dfLevel < b.dfLevel;
+        if( a.nSeamLine != b.nSeamLine )
+            return a.nSeamLine < b.nSeamLine;
+        return a.nCell < b.nCell;
+    }
+};
+
+typedef std::multimap<GDALContourSeamKey, GDALContourItem*,
+                      GDALContourSeamKeyLess> GDALContourSeamMap;
+
+/************************************************************************/
+/*                        GDALContourGetSeamLine()                      */
+/*                                                                      */
+/*      Strip borders are located half way between pixel centers,       */
+/*      at Y = nSeamLine - 0.5 in contour coordinates.  Returns the     */
+/*      seam line a point lies on, or -1 if it is not on a border.      */
+/************************************************************************/
+
+static int GDALContourGetSeamLine( double dfY, int nStripStart, 
+                                   int nStripEnd, int nYSize )
+
+{
+    if( nStripStart > 0 && fabs(dfY - (nStripStart - 0.5)) < JOIN_DIST )
+        return nStripStart;
+    if( nStripEnd < nYSize && fabs(dfY - (nStripEnd - 0.5)) < JOIN_DIST )
+        return nStripEnd;
+    return -1;
+}
+
+/************************************************************************/
+/*                         GDALContourStitcher                          */
+/************************************************************************/
+
+class GDALContourStitcher
+{
+    int                 nYSize;
+    int                 nStripLines;
+    GDALContourSeamMap  oMapEnds;
+    std::set<GDALContourItem*> oSetItems;
+
+    int  GetSeamLine( double dfY );
+    void RegisterEnd( GDALContourItem *poItem, int iPoint, int bRegister );
+    GDALContourItem *FindMatch( GDALContourItem *poItem, int iPoint );
+
+public:
+    GDALContourStitcher( int nYSizeIn, int nStripLinesIn )
+        { nYSize = nYSizeIn; nStripLines = nStripLinesIn; }
+    ~GDALContourStitcher();
+
+    void   AddFragment( GDALContourItem *poItem );
+    CPLErr Flush( int nPendingSeamLine, OGRContourWriterInfo *poCWI );
+};
+
+/************************************************************************/
+/*                        ~GDALContourStitcher()                        */
+/************************************************************************/
+
+GDALContourStitcher::~GDALContourStitcher()
+
+{
+    std::set<GDALContourItem*>::iterator oIter;
+
+    for( oIter = oSetItems.begin(); oIter != oSetItems.end(); ++oIter )
+        delete *oIter;
+}
+
+/************************************************************************/
+/*                            GetSeamLine()                             */
+/************************************************************************/
+
+int GDALContourStitcher::GetSeamLine( double dfY )
+
+{
+    int nSeamLine = (int) floor( dfY + 1.0 );
+
+    if( nSeamLine <= 0 || nSeamLine >= nYSize 
+        || (nSeamLine % nStripLines) != 0
+        || fabs(dfY - (nSeamLine - 0.5)) >= JOIN_DIST )
+        return -1;
+
+    return nSeamLine;
+}
+
+/************************************************************************/
+/*                            RegisterEnd()                             */
+/************************************************************************/
+
+void GDALContourStitcher::RegisterEnd( GDALContourItem *poItem, int iPoint,
+                                       int bRegister )
+
+{
+    GDALContourSeamKey sKey;
+
+    sKey.nSeamLine = GetSeamLine( poItem->padfY[iPoint] );
+    if( sKey.nSeamLine < 0 )
+        return;
+
+    sKey.dfLevel = poItem->dfLevel;
+    sKey.nCell = (GIntBig) floor( poItem->padfX[iPoint] 
+                                  * SEAM_CELLS_PER_PIXEL );
+
+    if( bRegister )
+    {
+        oMapEnds.insert( std::pair<GDALContourSeamKey, GDALContourItem*>(
+                             sKey, poItem ) );
+        return;
+    }
+
+    std::pair<GDALContourSeamMap::iterator,GDALContourSeamMap::iterator>
+        oRange = oMapEnds.equal_range( sKey );
+    for( GDALContourSeamMap::iterator oIter = oRange.first; 
+         oIter != oRange.second; ++oIter )
+    {
+        if( oIter->second == poItem )
+        {
+            oMapEnds.erase( oIter );
+            return;
+        }
+    }
+}
+
+/************************************************************************/
+/*                             FindMatch()                              */
+/*                                                                      */
+/*      Find another registered fragment with an end point matching     */
+/*      the indicated end point of poItem.                              */
+/************************************************************************/
+
+GDALContourItem *GDALContourStitcher::FindMatch( GDALContourItem *poItem,
+                                                 int iPoint )
+
+{
+    GDALContourSeamKey sKey;
+    double dfX = poItem->padfX[iPoint];
+    double dfY = poItem->padfY[iPoint];
+
+    sKey.nSeamLine = GetSeamLine( dfY );
+    if( sKey.nSeamLine < 0 )
+        return NULL;
+
+    sKey.dfLevel = poItem->dfLevel;
+    GIntBig nCell = (GIntBig) floor( dfX * SEAM_CELLS_PER_PIXEL );
+
+    for( sKey.nCell = nCell - 1; sKey.nCell <= nCell + 1; sKey.nCell++ )
+    {
+        std::pair<GDALContourSeamMap::iterator,GDALContourSeamMap::iterator>
+            oRange = oMapEnds.equal_range( sKey );
+        for( GDALContourSeamMap::iterator oIter = oRange.first; 
+             oIter != oRange.second; ++oIter )
+        {
+            GDALContourItem *poOther = oIter->second;
+            int iOtherPoint;
+
+            if( poOther == poItem )
+                continue;
+
+            for( iOtherPoint = 0; iOtherPoint < poOther->nPoints; 
+                 iOtherPoint += poOther->nPoints - 1 )
+            {
+                if( fabs(poOther->padfX[iOtherPoint] - dfX) < JOIN_DIST
+                    && fabs(poOther->padfY[iOtherPoint] - dfY) < JOIN_DIST )
+                    return poOther;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/************************************************************************/
+/*                            AddFragment()                             */
+/*                                                                      */
+/*      Merge the fragment with the already collected fragments it      */
+/*      connects to, and register the end points of the result.         */
+/*      Fragments are normalized by PrepareEjection() before they       */
+/*      reach us, and Merge() preserves the orientation of the          */
+/*      target, so the stitched contours keep the usual orientation.    */
+/************************************************************************/
+
+void GDALContourStitcher::AddFragment( GDALContourItem *poItem )
+
+{
+    poItem->bLeftIsHigh = FALSE;
+
+    while( TRUE )
+    {
+        GDALContourItem *poOther = FindMatch( poItem, 0 );
+        if( poOther == NULL )
+            poOther = FindMatch( poItem, poItem->nPoints - 1 );
+        if( poOther == NULL )
+            break;
+
+        RegisterEnd( poOther, 0, FALSE );
+        RegisterEnd( poOther, poOther->nPoints - 1, FALSE );
+        oSetItems.erase( poOther );
+
+        if( !poItem->Merge( poOther ) )
+        {
+            // Should not happen, but keep the other fragment around.
+            RegisterEnd( poOther, 0, TRUE );
+            RegisterEnd( poOther, poOther->nPoints - 1, TRUE );
+            oSetItems.insert( poOther );
+            break;
+        }
+
+        delete poOther;
+    }
+
+    RegisterEnd( poItem, 0, TRUE );
+    RegisterEnd( poItem, poItem->nPoints - 1, TRUE );
+    oSetItems.insert( poItem );
+}
+
+/************************************************************************/
+/*                               Flush()                                */
+/*                                                                      */
+/*      Write all the fragments that can no longer be extended, that    */
+/*      is those that do not end on a seam at or below                  */
+/*      nPendingSeamLine, whose lower strip has not been processed      */
+/*      yet.                                                            */
+/************************************************************************/
+
+CPLErr GDALContourStitcher::Flush( int nPendingSeamLine,
+                                   OGRContourWriterInfo *poCWI )
+
+{
+    std::set<GDALContourItem*>::iterator oIter = oSetItems.begin();
+    CPLErr eErr = CE_None;
+
+    while( oIter != oSetItems.end() && eErr == CE_None )
+    {
+        GDALContourItem *poItem = *oIter;
+        int nSeamStart = GetSeamLine( poItem->padfY[0] );
+        int nSeamEnd = GetSeamLine( poItem->padfY[poItem->nPoints-1] );
+
+        if( nSeamStart >= nPendingSeamLine || nSeamEnd >= nPendingSeamLine )
+        {
+            ++oIter;
+            continue;
+        }
+
+        eErr = OGRContourWriter( poItem->dfLevel, poItem->nPoints,
+                                 poItem->padfX, poItem->padfY, poCWI );
+
+        RegisterEnd( poItem, 0, FALSE );
+        RegisterEnd( poItem, poItem->nPoints - 1, FALSE );
+        oSetItems.erase( oIter++ );
+        delete poItem;
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                        GDALContourStripJob                           */
+/************************************************************************/
+
+typedef struct
+{
+    int         nXSize;
+    int         nYSize;
+    int         nStartLine;
+    int         nLineCount;
+
+    /* (nLineCount+1) scanlines, the first being nStartLine-1 if any */
+    double     *padfLines;
+
+    int         nFixedLevelCount;
+    double     *padfFixedLevels;
+    double      dfContourInterval;
+    double      dfContourBase;
+    int         bUseNoData;
+    double      dfNoDataValue;
+
+    OGRContourWriterInfo *poCWI;
+    void       *hWriterMutex;
+
+    std::vector<GDALContourItem*> *papoBorderItems;
+    CPLErr      eErr;
+    void       *hThread;
+} GDALContourStripJob;
+
+/************************************************************************/
+/*                       GDALContourStripWriter()                       */
+/*                                                                      */
+/*      Writer callback of the strip generators.  Contours touching     */
+/*      a seam are kept for stitching, others are written directly.     */
+/************************************************************************/
+
+static CPLErr GDALContourStripWriter( double dfLevel, int nPoints, 
+                                      double *padfX, double *padfY,
+                                      void *pInfo )
+
+{
+    GDALContourStripJob *psJob = (GDALContourStripJob *) pInfo;
+    int nStripEnd = psJob->nStartLine + psJob->nLineCount;
+
+    if( GDALContourGetSeamLine( padfY[0], psJob->nStartLine, 
+                                nStripEnd, psJob->nYSize ) < 0
+        && GDALContourGetSeamLine( padfY[nPoints-1], psJob->nStartLine, 
+                                   nStripEnd, psJob->nYSize ) < 0 )
+    {
+        CPLMutexHolderD( &(psJob->hWriterMutex) );
+        return OGRContourWriter( dfLevel, nPoints, padfX, padfY, 
+                                 psJob->poCWI );
+    }
+
+    GDALContourItem *poItem = new GDALContourItem( dfLevel );
+
+    poItem->MakeRoomFor( nPoints );
+    memcpy( poItem->padfX, padfX, sizeof(double) * nPoints );
+    memcpy( poItem->padfY, padfY, sizeof(double) * nPoints );
+    poItem->nPoints = nPoints;
+    poItem->dfTailX = padfX[nPoints-1];
+
+    psJob->papoBorderItems->push_back( poItem );
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                       GDALContourStripProcess()                      */
+/************************************************************************/
+
+static void GDALContourStripProcess( void *pData )
+
+{
+    GDALContourStripJob *psJob = (GDALContourStripJob *) pData;
+    GDALContourGenerator oCG( psJob->nXSize, psJob->nYSize, 
+                              GDALContourStripWriter, psJob );
+
+    if( psJob->nFixedLevelCount > 0 )
+        oCG.SetFixedLevels( psJob->nFixedLevelCount, 
+                            psJob->padfFixedLevels );
+    else
+        oCG.SetContourLevels( psJob->dfContourInterval, 
+                              psJob->dfContourBase );
+
+    if( psJob->bUseNoData )
+        oCG.SetNoData( psJob->dfNoDataValue );
+
+    double *padfLine = psJob->padfLines;
+
+    if( psJob->nStartLine > 0 )
+    {
+        oCG.SetStartLine( psJob->nStartLine, padfLine );
+        padfLine += psJob->nXSize;
+    }
+
+    psJob->eErr = CE_None;
+
+    int iLine;
+    for( iLine = 0; iLine < psJob->nLineCount && psJob->eErr == CE_None; 
+         iLine++, padfLine += psJob->nXSize )
+    {
+        psJob->eErr = oCG.FeedLine( padfLine );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      The generator only ejects everything by itself at the end of    */
+/*      the raster.                                                     */
+/* -------------------------------------------------------------------- */
+    if( psJob->eErr == CE_None 
+        && psJob->nStartLine + psJob->nLineCount < psJob->nYSize )
+        psJob->eErr = oCG.EjectContours( FALSE );
+}
+
+/************************************************************************/
+/*                       GDALContourGenerateTiled()                     */
+/************************************************************************/
+
+static CPLErr GDALContourGenerateTiled( GDALRasterBandH hBand, int nThreads,
+                                        int nStripLines,
+                                        double dfContourInterval, 
+                                        double dfContourBase,
+                                        int nFixedLevelCount, 
+                                        double *padfFixedLevels,
+                                        int bUseNoData, double dfNoDataValue,
+                                        OGRContourWriterInfo *poCWI,
+                                        GDALProgressFunc pfnProgress, 
+                                        void *pProgressArg )
+
+{
+    int nXSize = GDALGetRasterBandXSize( hBand );
+    int nYSize = GDALGetRasterBandYSize( hBand );
+    int nStrips = (nYSize + nStripLines - 1) / nStripLines;
+    CPLErr eErr = CE_None;
+    int iJob;
+
+    if( nThreads > nStrips )
+        nThreads = nStrips;
+
+    std::vector<GDALContourStripJob> asJobs( nThreads );
+    std::vector< std::vector<GDALContourItem*> > aapoBorderItems( nThreads );
+    GDALContourStitcher oStitcher( nYSize, nStripLines );
+    void *hWriterMutex = NULL;
+
+    for( iJob = 0; iJob < nThreads; iJob++ )
+    {
+        GDALContourStripJob *psJob = &asJobs[iJob];
+
+        psJob->nXSize = nXSize;
+        psJob->nYSize = nYSize;
+        psJob->nFixedLevelCount = nFixedLevelCount;
+        psJob->padfFixedLevels = padfFixedLevels;
+        psJob->dfContourInterval = dfContourInterval;
+        psJob->dfContourBase = dfContourBase;
+        psJob->bUseNoData = bUseNoData;
+        psJob->dfNoDataValue = dfNoDataValue;
+        psJob->poCWI = poCWI;
+        psJob->papoBorderItems = &aapoBorderItems[iJob];
+        psJob->padfLines = (double *) 
+            VSIMalloc3( sizeof(double), nXSize, nStripLines + 1 );
+        if( psJob->padfLines == NULL )
+        {
+            CPLError( CE_Failure, CPLE_OutOfMemory,
+                      "VSIMalloc(): Out of memory in GDALContourGenerate" );
+            eErr = CE_Failure;
+        }
+    }
+
+    hWriterMutex = CPLCreateMutex();
+    CPLReleaseMutex( hWriterMutex );
+
+/* -------------------------------------------------------------------- */
+/*      Process the strips by batches of nThreads.  The raster is       */
+/*      read from this thread.                                          */
+/* -------------------------------------------------------------------- */
+    int iFirstStrip;
+
+    for( iFirstStrip = 0; iFirstStrip < nStrips && eErr == CE_None;
+         iFirstStrip += nThreads )
+    {
+        int nJobs = MIN(nThreads, nStrips - iFirstStrip);
+
+        for( iJob = 0; iJob < nJobs && eErr == CE_None; iJob++ )
+        {
+            GDALContourStripJob *psJob = &asJobs[iJob];
+            int nStartLine = (iFirstStrip + iJob) * nStripLines;
+            int nReadStart = MAX(0, nStartLine - 1);
+
+            psJob->nStartLine = nStartLine;
+            psJob->nLineCount = MIN(nStripLines, nYSize - nStartLine);
+            psJob->hWriterMutex = hWriterMutex;
+            psJob->eErr = CE_None;
+            psJob->hThread = NULL;
+
+            eErr = GDALRasterIO( hBand, GF_Read, 0, nReadStart, nXSize, 
+                                 nStartLine + psJob->nLineCount - nReadStart,
+                                 psJob->padfLines, nXSize, 
+                                 nStartLine + psJob->nLineCount - nReadStart,
+                                 GDT_Float64, 0, 0 );
+        }
+        if( eErr != CE_None )
+            break;
+
+        if( nJobs == 1 )
+            GDALContourStripProcess( &asJobs[0] );
+        else
+        {
+            for( iJob = 0; iJob < nJobs; iJob++ )
+                asJobs[iJob].hThread = 
+                    CPLCreateJoinableThread( GDALContourStripProcess,
+                                             &asJobs[iJob] );
+            for( iJob = 0; iJob < nJobs; iJob++ )
+            {
+                if( asJobs[iJob].hThread != NULL )
+                    CPLJoinThread( asJobs[iJob].hThread );
+                else
+                    GDALContourStripProcess( &asJobs[iJob] );
+            }
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Stitch the border fragments, and write the contours that        */
+/*      can no longer grow.                                             */
+/* -------------------------------------------------------------------- */
+        for( iJob = 0; iJob < nJobs; iJob++ )
+        {
+            std::vector<GDALContourItem*>& apoItems = aapoBorderItems[iJob];
+            size_t i;
+
+            if( eErr == CE_None )
+                eErr = asJobs[iJob].eErr;
+
+            for( i = 0; i < apoItems.size(); i++ )
+            {
+                if( eErr == CE_None )
+                    oStitcher.AddFragment( apoItems[i] );
+                else
+                    delete apoItems[i];
+            }
+            apoItems.resize( 0 );
+        }
+
+        int nProcessedLines = 
+            asJobs[nJobs-1].nStartLine + asJobs[nJobs-1].nLineCount;
+
+        if( eErr == CE_None )
+            eErr = oStitcher.Flush( nProcessedLines, poCWI );
+
+        if( eErr == CE_None 
+            && !pfnProgress( nProcessedLines / (double) nYSize, "", 
+                             pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    if( eErr == CE_None )
+        eErr = oStitcher.Flush( nYSize, poCWI );
+
+    for( iJob = 0; iJob < nThreads; iJob++ )
+        CPLFree( asJobs[iJob].padfLines );
+    CPLDestroyMutex( hWriterMutex );
+
+    return eErr;
+}
 #endif // OGR_ENABLED
 
 /************************************************************************/
@@ -1526,6 +2127,13 @@ an averaged value from the two nearby points (in this case (12+3+5)/3).
  * 
  * @param pProgressArg The callback data for the pfnProgress function.
  *
+ * If the GDAL_CONTOUR_NUM_THREADS configuration option is set to a value
+ * greater than 1 (or ALL_CPUS), the raster is split in horizontal strips that
+ * are contoured in parallel, and the contour fragments ending on strip borders
+ * are stitched together afterwards (GDAL >= 2.0).  Contours are then not
+ * necessarily written in the same order as in the sequential mode, which is
+ * why the process wide GDAL_NUM_THREADS option does not enable this mode.
+ *
  * @return CE_None on success or CE_Failure if an error occurs.
  */
 
@@ -1575,11 +2183,43 @@ CPLErr GDALContourGenerate( GDALRasterBandH hBand,
         GDALGetGeoTransform( hSrcDS, oCWI.adfGeoTransform );
     oCWI.nNextID = 0;
 
+    int nXSize = GDALGetRasterBandXSize( hBand );
+    int nYSize = GDALGetRasterBandYSize( hBand );
+
+/* -------------------------------------------------------------------- */
+/*      Use the tiled mode if several threads are explicitly            */
+/*      requested for it.                                               */
+/* -------------------------------------------------------------------- */
+    const char* pszThreads =
+        CPLGetConfigOption("GDAL_CONTOUR_NUM_THREADS", "1");
+    int nThreads;
+
+    if( EQUAL(pszThreads, "ALL_CPUS") )
+        nThreads = CPLGetNumCPUs();
+    else
+        nThreads = atoi(pszThreads);
+    if( nThreads > 128 )
+        nThreads = 128;
+
+    if( nThreads > 1 && nYSize > 1 )
+    {
+        // Bound the size of the strip buffers to about 16 MB each.
+        int nMaxStripLines = 
+            (int) MAX(1, MIN(nYSize, (16 * 1024 * 1024) / (8.0 * nXSize)));
+        int nStripLines = (nYSize + nThreads - 1) / nThreads;
+        if( nStripLines > nMaxStripLines )
+            nStripLines = nMaxStripLines;
+
+        return GDALContourGenerateTiled( hBand, nThreads, nStripLines,
+                                         dfContourInterval, dfContourBase,
+                                         nFixedLevelCount, padfFixedLevels,
+                                         bUseNoData, dfNoDataValue, &oCWI,
+                                         pfnProgress, pProgressArg );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Setup contour generator.                                        */
 /* -------------------------------------------------------------------- */
-    int nXSize = GDALGetRasterBandXSize( hBand );
-    int nYSize = GDALGetRasterBandYSize( hBand );
 
     GDALContourGenerator oCG( nXSize, nYSize, OGRContourWriter, &oCWI );
 
@@ -349,6 +349,54 @@ GDALRasterizeLayersBuf( void *pData, int nBufXSize, int nBufYSize,
                         char **papszOptions, GDALProgressFunc pfnProgress, 
                         void *pProgressArg );
 
+/************************************************************************/
+/*      Zonal statistics API.                                           */
+/************************************************************************/
+
+/** Statistics of the pixels of a raster band falling in a zone */
+typedef struct
+{
+    /*! FID of the zone feature. */
+    GIntBig   nFID;
+    /*! Number of valid pixels in the zone. */
+    GIntBig   nCount;
+    /*! Sum of the valid pixel values. */
+    double    dfSum;
+    /*! Minimum pixel value (0 if nCount is 0). */
+    double    dfMin;
+    /*! Maximum pixel value (0 if nCount is 0). */
+    double    dfMax;
+    /*! Mean pixel value (0 if nCount is 0). */
+    double    dfMean;
+    /*! Histogram of HISTOGRAM_BUCKETS entries, or NULL. */
+    GUIntBig *panHistogram;
+} GDALZonalStatistics;
+
+CPLErr CPL_DLL
+GDALComputeZonalStatistics( GDALRasterBandH hBand, OGRLayerH hZoneLayer,
+                            char **papszOptions,
+                            int *pnZoneCount,
+                            GDALZonalStatistics **ppasStats,
+                            GDALProgressFunc pfnProgress,
+                            void *pProgressArg );
+
+void CPL_DLL
+GDALDestroyZonalStatistics( int nZoneCount, GDALZonalStatistics *pasStats );
+
+/************************************************************************/
+/*      DEM processing (hillshade, slope, aspect, TRI, TPI, roughness)  */
+/************************************************************************/
+
+CPLErr CPL_DLL
+GDALDEMProcessBand( GDALRasterBandH hSrcBand, GDALRasterBandH hDstBand,
+                    const char *pszProcessing, char **papszOptions,
+                    GDALProgressFunc pfnProgress, void *pProgressData );
+
+CPLErr CPL_DLL
+GDALDEMProcessLines( GDALRasterBandH hSrcBand,
+                     const char *pszProcessing, char **papszOptions,
+                     int nYOff, int nLines, float *pafOutput );
+
 
 /************************************************************************/
 /*  Gridding interface.                                                 */
@@ -65,6 +65,7 @@ typedef struct {
 
 typedef void (*llScanlineFunc)( void *, int, int, int, double );
 typedef void (*llPointFunc)( void *, int, int, double );
+typedef void (*llCoverageFunc)( void *, int, int, int, const double *, double );
 
 void GDALdllImagePoint( int nRasterXSize, int nRasterYSize,
                         int nPartCount, int *panPartSize,
@@ -88,8 +89,26 @@ void GDALdllImageFilledPolygon(int nRasterXSize, int nRasterYSize,
                                double *padfVariant,
                                llScanlineFunc pfnScanlineFunc, void *pCBData );
 
+void GDALdllImageFilledPolygonCoverage(int nRasterXSize, int nRasterYSize, 
+                                       int nPartCount, int *panPartSize,
+                                       double *padfX, double *padfY,
+                                       double *padfVariant,
+                                       llCoverageFunc pfnCoverageFunc,
+                                       void *pCBData );
+
 CPL_C_END
 
+#include <vector>
+
+class OGRGeometry;
+
+void GDALCollectRingsFromGeometry( OGRGeometry *poShape,
+                                   std::vector<double> &aPointX,
+                                   std::vector<double> &aPointY,
+                                   std::vector<double> &aPointVariant,
+                                   std::vector<int> &aPartSize,
+                                   GDALBurnValueSrc eBurnValueSrc );
+
 /************************************************************************/
 /*                          Polygon Enumerator                          */
 /************************************************************************/
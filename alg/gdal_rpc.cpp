@@ -260,8 +260,24 @@ typedef struct {
 
     double      adfGeoTransform[6];
     double      adfReverseGeoTransform[6];
+
+    int         bGotDEMNoDataValue;
+    double      dfDEMNoDataValue;
+
+    /* Cached window of the DEM, in Float64 */
+    double     *padfDEMBuffer;
+    int         nDEMBufferXOff;
+    int         nDEMBufferYOff;
+    int         nDEMBufferXSize;
+    int         nDEMBufferYSize;
 } GDALRPCTransformInfo;
 
+/* A window covering all the points of a GDALRPCTransform() call is */
+/* loaded at once if it has less pixels than this. Otherwise, blocks */
+/* around the points are loaded on demand. */
+#define RPC_DEM_CACHE_MAX_PIXELS  (1024 * 1024)
+#define RPC_DEM_CACHE_BLOCK_SIZE  256
+
 /************************************************************************/
 /*                     GDALSerializeRPCDEMResample()                    */
 /************************************************************************/
@@ -406,7 +422,10 @@ void* GDALCreateSimilarRPCTransformer( void *hTransformArg, double dfRatioX, dou
  * extract elevation offsets from. In this situation the Z passed into the
  * transformation function is assumed to be height above ground. This option
  * should be used in replacement of RPC_HEIGHT to provide a way of defining
- * a non uniform ground for the target scene (GDAL >= 1.8.0)
+ * a non uniform ground for the target scene (GDAL >= 1.8.0). The DEM is
+ * read by windows covering each batch of transformed points (or by blocks
+ * around the points for batches spread over a very large extent), which are
+ * cached in the transformer.
  *
  * <li> RPC_DEMINTERPOLATION: the DEM interpolation (near, bilinear or cubic)
  *
@@ -575,6 +594,7 @@ void GDALDestroyRPCTransformer( void *pTransformAlg )
 
     if(psTransform->poDS)
         GDALClose(psTransform->poDS);
+    CPLFree( psTransform->padfDEMBuffer );
     if(psTransform->poCT)
         OCTDestroyCoordinateTransformation((OGRCoordinateTransformationH)psTransform->poCT);
 
@@ -673,6 +693,140 @@ double BiCubicKernel(double dfVal)
 	return ( 0.16666666666666666667 * ( a - ( 4.0 * b ) + ( 6.0 * c ) - ( 4.0 * d ) ) );
 }
 
+/************************************************************************/
+/*                        GDALRPCLoadDEMWindow()                        */
+/************************************************************************/
+
+static int GDALRPCLoadDEMWindow( GDALRPCTransformInfo *psTransform,
+                                 int nXOff, int nYOff, int nXSize, int nYSize )
+{
+    int nRasterXSize = psTransform->poDS->GetRasterXSize();
+    int nRasterYSize = psTransform->poDS->GetRasterYSize();
+
+    if( nXOff < 0 )
+    {
+        nXSize += nXOff;
+        nXOff = 0;
+    }
+    if( nYOff < 0 )
+    {
+        nYSize += nYOff;
+        nYOff = 0;
+    }
+    nXSize = MIN( nXSize, nRasterXSize - nXOff );
+    nYSize = MIN( nYSize, nRasterYSize - nYOff );
+    if( nXSize <= 0 || nYSize <= 0 )
+        return FALSE;
+
+    psTransform->nDEMBufferXSize = 0;
+    psTransform->nDEMBufferYSize = 0;
+
+    double* padfNewBuffer = (double*) VSIRealloc( psTransform->padfDEMBuffer,
+                                       sizeof(double) * nXSize * nYSize );
+    if( padfNewBuffer == NULL )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "Cannot allocate DEM cache of %d x %d pixels",
+                  nXSize, nYSize );
+        return FALSE;
+    }
+    psTransform->padfDEMBuffer = padfNewBuffer;
+
+    CPLErr eErr = psTransform->poDS->GetRasterBand(1)->RasterIO(
+                        GF_Read, nXOff, nYOff, nXSize, nYSize,
+                        psTransform->padfDEMBuffer, nXSize, nYSize,
+                        GDT_Float64, 0, 0, NULL );
+    if( eErr != CE_None )
+        return FALSE;
+
+    psTransform->nDEMBufferXOff = nXOff;
+    psTransform->nDEMBufferYOff = nYOff;
+    psTransform->nDEMBufferXSize = nXSize;
+    psTransform->nDEMBufferYSize = nYSize;
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                        GDALRPCGetDEMWindow()                         */
+/*                                                                      */
+/*      Fetch a small window of the DEM, which must be inside the       */
+/*      raster, from the cache, loading a new block around it if        */
+/*      needed.                                                         */
+/************************************************************************/
+
+static int GDALRPCGetDEMWindow( GDALRPCTransformInfo *psTransform,
+                                int nXOff, int nYOff, int nXSize, int nYSize,
+                                double* padfOut )
+{
+    if( nXOff < psTransform->nDEMBufferXOff ||
+        nYOff < psTransform->nDEMBufferYOff ||
+        nXOff + nXSize > psTransform->nDEMBufferXOff +
+                                        psTransform->nDEMBufferXSize ||
+        nYOff + nYSize > psTransform->nDEMBufferYOff +
+                                        psTransform->nDEMBufferYSize )
+    {
+        if( !GDALRPCLoadDEMWindow( psTransform,
+                    nXOff + nXSize / 2 - RPC_DEM_CACHE_BLOCK_SIZE / 2,
+                    nYOff + nYSize / 2 - RPC_DEM_CACHE_BLOCK_SIZE / 2,
+                    RPC_DEM_CACHE_BLOCK_SIZE, RPC_DEM_CACHE_BLOCK_SIZE ) )
+            return FALSE;
+    }
+
+    for( int iY = 0; iY < nYSize; iY++ )
+    {
+        memcpy( padfOut + iY * nXSize,
+                psTransform->padfDEMBuffer +
+                    (nYOff + iY - psTransform->nDEMBufferYOff) *
+                        psTransform->nDEMBufferXSize +
+                    nXOff - psTransform->nDEMBufferXOff,
+                nXSize * sizeof(double) );
+    }
+    return TRUE;
+}
+
+/************************************************************************/
+/*                       GDALRPCPrefetchDEMWindow()                     */
+/*                                                                      */
+/*      Load the DEM window covering the given extent in DEM pixel      */
+/*      coordinates (plus the interpolation kernel margin) if it is     */
+/*      not too large.                                                  */
+/************************************************************************/
+
+static void GDALRPCPrefetchDEMWindow( GDALRPCTransformInfo *psTransform,
+                                      double dfMinX, double dfMinY,
+                                      double dfMaxX, double dfMaxY )
+{
+    int nRasterXSize = psTransform->poDS->GetRasterXSize();
+    int nRasterYSize = psTransform->poDS->GetRasterYSize();
+
+    dfMinX = MAX( dfMinX, -2.0 );
+    dfMinY = MAX( dfMinY, -2.0 );
+    dfMaxX = MIN( dfMaxX, nRasterXSize + 2.0 );
+    dfMaxY = MIN( dfMaxY, nRasterYSize + 2.0 );
+    if( !(dfMinX <= dfMaxX && dfMinY <= dfMaxY) )
+        return;
+
+    int nXOff = MAX( 0, (int)floor(dfMinX) - 1 );
+    int nYOff = MAX( 0, (int)floor(dfMinY) - 1 );
+    int nXEnd = MIN( nRasterXSize, (int)floor(dfMaxX) + 3 );
+    int nYEnd = MIN( nRasterYSize, (int)floor(dfMaxY) + 3 );
+    if( nXEnd <= nXOff || nYEnd <= nYOff )
+        return;
+
+    if( nXOff >= psTransform->nDEMBufferXOff &&
+        nYOff >= psTransform->nDEMBufferYOff &&
+        nXEnd <= psTransform->nDEMBufferXOff + psTransform->nDEMBufferXSize &&
+        nYEnd <= psTransform->nDEMBufferYOff + psTransform->nDEMBufferYSize )
+        return;
+
+    if( (GIntBig)(nXEnd - nXOff) * (nYEnd - nYOff) > RPC_DEM_CACHE_MAX_PIXELS )
+        return;
+
+    GDALRPCLoadDEMWindow( psTransform, nXOff, nYOff,
+                          nXEnd - nXOff, nYEnd - nYOff );
+}
+
 /************************************************************************/
 /*                        GDALRPCGetDEMHeight()                         */
 /************************************************************************/
@@ -682,13 +836,10 @@ int GDALRPCGetDEMHeight( GDALRPCTransformInfo *psTransform,
                       double dfX, double dfY, double* pdfDEMH )
 {
     
-    int bGotNoDataValue = FALSE;
-    double dfNoDataValue = 0;
+    int bGotNoDataValue = psTransform->bGotDEMNoDataValue;
+    double dfNoDataValue = psTransform->dfDEMNoDataValue;
     int nRasterXSize = psTransform->poDS->GetRasterXSize();
     int nRasterYSize = psTransform->poDS->GetRasterYSize();
-    dfNoDataValue = psTransform->poDS->GetRasterBand(1)->GetNoDataValue( &bGotNoDataValue );
-
-    int bands[1] = {1};
 
     int dX = int(dfX);
     int dY = int(dfY);
@@ -706,11 +857,8 @@ int GDALRPCGetDEMHeight( GDALRPCTransformInfo *psTransform,
         }
         //cubic interpolation
         double adfElevData[16] = {0};
-        CPLErr eErr = psTransform->poDS->RasterIO(GF_Read, dXNew, dYNew, 4, 4,
-                                                    &adfElevData, 4, 4,
-                                                    GDT_Float64, 1, bands, 0, 0, 0,
-                                                    NULL);
-        if(eErr != CE_None)
+        if( !GDALRPCGetDEMWindow( psTransform, dXNew, dYNew, 4, 4,
+                                  adfElevData ) )
         {
             return FALSE;
         }
@@ -752,11 +900,7 @@ int GDALRPCGetDEMHeight( GDALRPCTransformInfo *psTransform,
         }
         //bilinear interpolation
         double adfElevData[4] = {0,0,0,0};
-        CPLErr eErr = psTransform->poDS->RasterIO(GF_Read, dX, dY, 2, 2,
-                                                    &adfElevData, 2, 2,
-                                                    GDT_Float64, 1, bands, 0, 0, 0,
-                                                  NULL);
-        if(eErr != CE_None)
+        if( !GDALRPCGetDEMWindow( psTransform, dX, dY, 2, 2, adfElevData ) )
         {
             return FALSE;
         }
@@ -788,11 +932,7 @@ int GDALRPCGetDEMHeight( GDALRPCTransformInfo *psTransform,
         {
             return FALSE;
         }
-        CPLErr eErr = psTransform->poDS->RasterIO(GF_Read, dX, dY, 1, 1,
-                                                    &dfDEMH, 1, 1,
-                                                    GDT_Float64, 1, bands, 0, 0, 0,
-                                                  NULL);
-        if(eErr != CE_None ||
+        if( !GDALRPCGetDEMWindow( psTransform, dX, dY, 1, 1, &dfDEMH ) ||
             (bGotNoDataValue && ARE_REAL_EQUAL(dfNoDataValue, dfDEMH)) )
         {
             return FALSE;
@@ -804,6 +944,71 @@ int GDALRPCGetDEMHeight( GDALRPCTransformInfo *psTransform,
     return TRUE;
 }
 
+/************************************************************************/
+/*                        GDALRPCGetDEMCoords()                         */
+/*                                                                      */
+/*      Compute the DEM pixel/line coordinates of a batch of long/lat   */
+/*      points, in a single coordinate transformation call, and         */
+/*      prefetch the DEM window covering them.                          */
+/************************************************************************/
+
+static void GDALRPCGetDEMCoords( GDALRPCTransformInfo *psTransform,
+                                 int nPointCount,
+                                 const double *padfLong, const double *padfLat,
+                                 const double *padfZ,
+                                 double *padfDEMX, double *padfDEMY,
+                                 int *pabSuccess )
+{
+    int i;
+
+    memcpy( padfDEMX, padfLong, sizeof(double) * nPointCount );
+    memcpy( padfDEMY, padfLat, sizeof(double) * nPointCount );
+    for( i = 0; i < nPointCount; i++ )
+        pabSuccess[i] = TRUE;
+
+    //check if dem is not in WGS84 and transform points
+    if( psTransform->poCT )
+    {
+        double *padfDEMZ = (double *) CPLMalloc( sizeof(double) * nPointCount );
+        if( padfZ != NULL )
+            memcpy( padfDEMZ, padfZ, sizeof(double) * nPointCount );
+        else
+            memset( padfDEMZ, 0, sizeof(double) * nPointCount );
+        psTransform->poCT->TransformEx( nPointCount, padfDEMX, padfDEMY,
+                                        padfDEMZ, pabSuccess );
+        CPLFree( padfDEMZ );
+    }
+
+    double dfMinX = 0, dfMinY = 0, dfMaxX = -1, dfMaxY = -1;
+    int bFirst = TRUE;
+    for( i = 0; i < nPointCount; i++ )
+    {
+        if( !pabSuccess[i] )
+            continue;
+        double dfX, dfY;
+        GDALApplyGeoTransform( psTransform->adfReverseGeoTransform,
+                               padfDEMX[i], padfDEMY[i], &dfX, &dfY );
+        padfDEMX[i] = dfX;
+        padfDEMY[i] = dfY;
+        if( bFirst )
+        {
+            dfMinX = dfMaxX = dfX;
+            dfMinY = dfMaxY = dfY;
+            bFirst = FALSE;
+        }
+        else
+        {
+            dfMinX = MIN( dfMinX, dfX );
+            dfMinY = MIN( dfMinY, dfY );
+            dfMaxX = MAX( dfMaxX, dfX );
+            dfMaxY = MAX( dfMaxY, dfY );
+        }
+    }
+
+    if( !bFirst )
+        GDALRPCPrefetchDEMWindow( psTransform, dfMinX, dfMinY, dfMaxX, dfMaxY );
+}
+
 /************************************************************************/
 /*                          GDALRPCTransform()                          */
 /************************************************************************/
@@ -855,6 +1060,9 @@ int GDALRPCTransform( void *pTransformArg, int bDstToSrc,
                                      psTransform->adfReverseGeoTransform ))
             {
                 bIsValid = TRUE;
+                psTransform->dfDEMNoDataValue =
+                    psTransform->poDS->GetRasterBand(1)->GetNoDataValue(
+                                        &psTransform->bGotDEMNoDataValue );
             }
         }
 
@@ -871,32 +1079,31 @@ int GDALRPCTransform( void *pTransformArg, int bDstToSrc,
 /* -------------------------------------------------------------------- */
     if( bDstToSrc )
     {
+        double *padfDEMX = NULL, *padfDEMY = NULL;
+        int *pabDEMSuccess = NULL;
+
+        if(psTransform->poDS)
+        {
+            padfDEMX = (double *) CPLMalloc( sizeof(double) * nPointCount );
+            padfDEMY = (double *) CPLMalloc( sizeof(double) * nPointCount );
+            pabDEMSuccess = (int *) CPLMalloc( sizeof(int) * nPointCount );
+            GDALRPCGetDEMCoords( psTransform, nPointCount, padfX, padfY, padfZ,
+                                 padfDEMX, padfDEMY, pabDEMSuccess );
+        }
+
         for( i = 0; i < nPointCount; i++ )
         {
             if(psTransform->poDS)
             {
-                double dfX, dfY;
-                //check if dem is not in WGS84 and transform points padfX[i], padfY[i]
-                if(psTransform->poCT)
+                if( !pabDEMSuccess[i] )
                 {
-                    double dfXOrig = padfX[i];
-                    double dfYOrig = padfY[i];
-                    double dfZOrig = padfZ[i];
-                    if (!psTransform->poCT->Transform(
-                                                1, &dfXOrig, &dfYOrig, &dfZOrig))
-                    {
-                        panSuccess[i] = FALSE;
-                        continue;
-                    }
-                    GDALApplyGeoTransform( psTransform->adfReverseGeoTransform,
-                                           dfXOrig, dfYOrig, &dfX, &dfY );
+                    panSuccess[i] = FALSE;
+                    continue;
                 }
-                else
-                    GDALApplyGeoTransform( psTransform->adfReverseGeoTransform,
-                                           padfX[i], padfY[i], &dfX, &dfY );
 
                 double dfDEMH(0);
-                if( !GDALRPCGetDEMHeight( psTransform, dfX, dfY, &dfDEMH) )
+                if( !GDALRPCGetDEMHeight( psTransform, padfDEMX[i], padfDEMY[i],
+                                          &dfDEMH) )
                 {
                     if( psTransform->bHasDEMMissingValue )
                         dfDEMH = psTransform->dfDEMMissingValue;
@@ -920,6 +1127,10 @@ int GDALRPCTransform( void *pTransformArg, int bDstToSrc,
             panSuccess[i] = TRUE;
         }
 
+        CPLFree( padfDEMX );
+        CPLFree( padfDEMY );
+        CPLFree( pabDEMSuccess );
+
         return TRUE;
     }
 
@@ -927,35 +1138,41 @@ int GDALRPCTransform( void *pTransformArg, int bDstToSrc,
 /*      Compute the inverse (pixel/line/height to lat/long).  This      */
 /*      function uses an iterative method from an initial linear        */
 /*      approximation.                                                  */
+/*                                                                      */
+/*      With a DEM, a first solution is computed for all points at      */
+/*      the reference height, so that the DEM heights under them can    */
+/*      be fetched from a single window before the final solution.      */
 /* -------------------------------------------------------------------- */
-    for( i = 0; i < nPointCount; i++ )
+    if(psTransform->poDS)
     {
-        double dfResultX, dfResultY;
+        double *padfLong = (double *) CPLMalloc( sizeof(double) * nPointCount );
+        double *padfLat = (double *) CPLMalloc( sizeof(double) * nPointCount );
+        double *padfDEMX = (double *) CPLMalloc( sizeof(double) * nPointCount );
+        double *padfDEMY = (double *) CPLMalloc( sizeof(double) * nPointCount );
+        int *pabDEMSuccess = (int *) CPLMalloc( sizeof(int) * nPointCount );
 
-        if(psTransform->poDS)
+        for( i = 0; i < nPointCount; i++ )
         {
             RPCInverseTransformPoint( psTransform, padfX[i], padfY[i], 
                       padfZ[i] + psTransform->dfHeightOffset *
                                  psTransform->dfHeightScale,
-                      &dfResultX, &dfResultY );
+                      padfLong + i, padfLat + i );
+        }
+
+        GDALRPCGetDEMCoords( psTransform, nPointCount, padfLong, padfLat, NULL,
+                             padfDEMX, padfDEMY, pabDEMSuccess );
 
-            double dfX, dfY;
-            //check if dem is not in WGS84 and transform points padfX[i], padfY[i]
-            if(psTransform->poCT)
+        for( i = 0; i < nPointCount; i++ )
+        {
+            if( !pabDEMSuccess[i] )
             {
-                double dfZ = 0;
-                if (!psTransform->poCT->Transform(1, &dfResultX, &dfResultY, &dfZ))
-                {
-                    panSuccess[i] = FALSE;
-                    continue;
-                }
+                panSuccess[i] = FALSE;
+                continue;
             }
 
-            GDALApplyGeoTransform( psTransform->adfReverseGeoTransform,
-                                    dfResultX, dfResultY, &dfX, &dfY );
-
             double dfDEMH(0);
-            if( !GDALRPCGetDEMHeight( psTransform, dfX, dfY, &dfDEMH) )
+            if( !GDALRPCGetDEMHeight( psTransform, padfDEMX[i], padfDEMY[i],
+                                      &dfDEMH) )
             {
                 if( psTransform->bHasDEMMissingValue )
                     dfDEMH = psTransform->dfDEMMissingValue;
@@ -969,16 +1186,28 @@ int GDALRPCTransform( void *pTransformArg, int bDstToSrc,
             RPCInverseTransformPoint( psTransform, padfX[i], padfY[i], 
                                       padfZ[i] + (psTransform->dfHeightOffset + dfDEMH) *
                                                   psTransform->dfHeightScale,
-                                      &dfResultX, &dfResultY );
+                                      padfX + i, padfY + i );
+            panSuccess[i] = TRUE;
         }
-        else
-        {
-            RPCInverseTransformPoint( psTransform, padfX[i], padfY[i], 
-                                      padfZ[i] + psTransform->dfHeightOffset *
-                                                 psTransform->dfHeightScale,
-                                      &dfResultX, &dfResultY );
 
-        }
+        CPLFree( padfLong );
+        CPLFree( padfLat );
+        CPLFree( padfDEMX );
+        CPLFree( padfDEMY );
+        CPLFree( pabDEMSuccess );
+
+        return TRUE;
+    }
+
+    for( i = 0; i < nPointCount; i++ )
+    {
+        double dfResultX, dfResultY;
+
+        RPCInverseTransformPoint( psTransform, padfX[i], padfY[i], 
+                                  padfZ[i] + psTransform->dfHeightOffset *
+                                             psTransform->dfHeightScale,
+                                  &dfResultX, &dfResultY );
+
         padfX[i] = dfResultX;
         padfY[i] = dfResultY;
 
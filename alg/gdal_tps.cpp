@@ -59,9 +59,37 @@ typedef struct
     GDAL_GCP *pasGCPList;
     
     volatile int nRefCount;
+
+    vizGeorefSolverType eSolver;
+
+    /* Interpolation grid error threshold in pixels, or 0 for exact */
+    /* evaluation. Grids are built on first use of each direction. */
+    double    dfGridErrorThreshold;
+    void     *hGridMutex;
+    volatile int bForwardGridBuilt;
+    volatile int bReverseGridBuilt;
     
 } TPSTransformInfo;
 
+/************************************************************************/
+/*                    GDALGetTPSTransformerOptions()                    */
+/*                                                                      */
+/*      Options needed to recreate an equivalent transformer.           */
+/************************************************************************/
+
+static char** GDALGetTPSTransformerOptions( TPSTransformInfo *psInfo )
+{
+    char** papszOptions = NULL;
+    if( psInfo->eSolver == VIZ_GEOREF_SPLINE_SOLVER_ITERATIVE )
+        papszOptions = CSLSetNameValue( papszOptions, "TPS_SOLVER", "ITERATIVE" );
+    else if( psInfo->eSolver == VIZ_GEOREF_SPLINE_SOLVER_AUTO )
+        papszOptions = CSLSetNameValue( papszOptions, "TPS_SOLVER", "AUTO" );
+    if( psInfo->dfGridErrorThreshold > 0 )
+        papszOptions = CSLSetNameValue( papszOptions, "TPS_GRID_ERROR_THRESHOLD",
+                            CPLSPrintf( "%.15g", psInfo->dfGridErrorThreshold ) );
+    return papszOptions;
+}
+
 /************************************************************************/
 /*                   GDALCreateSimilarTPSTransformer()                  */
 /************************************************************************/
@@ -88,8 +116,10 @@ void* GDALCreateSimilarTPSTransformer( void *hTransformArg, double dfRatioX, dou
             pasGCPList[i].dfGCPPixel /= dfRatioX;
             pasGCPList[i].dfGCPLine /= dfRatioY;
         }
-        psInfo = (TPSTransformInfo *) GDALCreateTPSTransformer( psInfo->nGCPCount, pasGCPList,
-                                           psInfo->bReversed );
+        char** papszOptions = GDALGetTPSTransformerOptions( psInfo );
+        psInfo = (TPSTransformInfo *) GDALCreateTPSTransformerInt( psInfo->nGCPCount, pasGCPList,
+                                           psInfo->bReversed, papszOptions );
+        CSLDestroy( papszOptions );
         GDALDeinitGCPs( psInfo->nGCPCount, pasGCPList );
         CPLFree( pasGCPList );
     }
@@ -118,6 +148,29 @@ void* GDALCreateSimilarTPSTransformer( void *hTransformArg, double dfRatioX, dou
  *
  * TPS Transformers are serializable. 
  *
+ * GDALCreateGenImgProjTransformer2() forwards the following options to
+ * the TPS transformer:
+ * <ul>
+ * <li> TPS_SOLVER=DIRECT/ITERATIVE/AUTO: method used to solve the
+ * interpolation system. DIRECT (default) inverts the dense (N+3)x(N+3)
+ * matrix, which costs O(N^3) operations and 4 (N+3)^2 doubles. ITERATIVE
+ * uses a projected conjugate gradient that only needs the N^2 kernel matrix,
+ * stops once the residual at the GCPs is below 1e-9 times the range of the
+ * coordinates, and falls back to DIRECT if it does not converge. Its result
+ * may thus differ very slightly from the DIRECT one.
+ * AUTO selects ITERATIVE above 1000 GCPs and DIRECT otherwise.
+ * <li> TPS_GRID_ERROR_THRESHOLD=val: if set to a positive value, transformed
+ * points inside the GCP extent are interpolated bilinearly from an adaptive
+ * grid precomputed on first use, instead of summing over all GCPs. Cells are
+ * refined until the interpolation error estimated at their center and
+ * edge midpoints is below val (in pixels; converted to georeferenced units
+ * for the pixel/line to georeferenced direction).
+ * This is an estimate, not a bound: the error elsewhere in a cell, in
+ * particular close to a GCP, can exceed val (up to 0.08 pixel was observed
+ * with val=0.05), so val should be set below the acceptable error.
+ * Much faster with thousands of GCPs. Not set by default.
+ * </ul>
+ *
  * The GDAL Thin Plate Spline transformer is based on code provided by
  * Gilad Ronnen on behalf of VIZRT Inc (http://www.visrt.com).  Incorporation 
  * of the algorithm into GDAL was supported by the Centro di Ecologia Alpina 
@@ -139,7 +192,7 @@ void *GDALCreateTPSTransformer( int nGCPCount, const GDAL_GCP *pasGCPList,
 static void GDALTPSComputeForwardInThread(void* pData)
 {
     TPSTransformInfo *psInfo = (TPSTransformInfo *)pData;
-    psInfo->bForwardSolved = psInfo->poForward->solve() != 0;
+    psInfo->bForwardSolved = psInfo->poForward->solve(psInfo->eSolver) != 0;
 }
 
 void *GDALCreateTPSTransformerInt( int nGCPCount, const GDAL_GCP *pasGCPList, 
@@ -158,6 +211,22 @@ void *GDALCreateTPSTransformerInt( int nGCPCount, const GDAL_GCP *pasGCPList,
     psInfo->nGCPCount = nGCPCount;
 
     psInfo->bReversed = bReversed;
+    psInfo->eSolver = VIZ_GEOREF_SPLINE_SOLVER_DIRECT;
+    const char* pszSolver = CSLFetchNameValue( papszOptions, "TPS_SOLVER" );
+    if( pszSolver != NULL && EQUAL(pszSolver, "AUTO") )
+        psInfo->eSolver = VIZ_GEOREF_SPLINE_SOLVER_AUTO;
+    else if( pszSolver != NULL && EQUAL(pszSolver, "ITERATIVE") )
+        psInfo->eSolver = VIZ_GEOREF_SPLINE_SOLVER_ITERATIVE;
+    else if( pszSolver != NULL && !EQUAL(pszSolver, "DIRECT") )
+        CPLError( CE_Warning, CPLE_NotSupported,
+                  "Unsupported value for TPS_SOLVER : %s", pszSolver );
+    psInfo->dfGridErrorThreshold = CPLAtof(
+        CSLFetchNameValueDef( papszOptions, "TPS_GRID_ERROR_THRESHOLD", "0" ) );
+    if( psInfo->dfGridErrorThreshold > 0 )
+    {
+        psInfo->hGridMutex = CPLCreateMutex();
+        CPLReleaseMutex( psInfo->hGridMutex );
+    }
     psInfo->poForward = new VizGeorefSpline2D( 2 );
     psInfo->poReverse = new VizGeorefSpline2D( 2 );
 
@@ -210,16 +279,16 @@ void *GDALCreateTPSTransformerInt( int nGCPCount, const GDAL_GCP *pasGCPList,
     {
         /* Compute direct and reverse transforms in parallel */
         CPLJoinableThread* hThread = CPLCreateJoinableThread(GDALTPSComputeForwardInThread, psInfo);
-        psInfo->bReverseSolved = psInfo->poReverse->solve() != 0;
+        psInfo->bReverseSolved = psInfo->poReverse->solve(psInfo->eSolver) != 0;
         if( hThread != NULL )
             CPLJoinThread(hThread);
         else
-            psInfo->bForwardSolved = psInfo->poForward->solve() != 0;
+            psInfo->bForwardSolved = psInfo->poForward->solve(psInfo->eSolver) != 0;
     }
     else
     {
-        psInfo->bForwardSolved = psInfo->poForward->solve() != 0;
-        psInfo->bReverseSolved = psInfo->poReverse->solve() != 0;
+        psInfo->bForwardSolved = psInfo->poForward->solve(psInfo->eSolver) != 0;
+        psInfo->bReverseSolved = psInfo->poReverse->solve(psInfo->eSolver) != 0;
     }
 
     if( !psInfo->bForwardSolved || !psInfo->bReverseSolved )
@@ -257,6 +326,9 @@ void GDALDestroyTPSTransformer( void *pTransformArg )
         delete psInfo->poForward;
         delete psInfo->poReverse;
 
+        if( psInfo->hGridMutex != NULL )
+            CPLDestroyMutex( psInfo->hGridMutex );
+
         GDALDeinitGCPs( psInfo->nGCPCount, psInfo->pasGCPList );
         CPLFree( psInfo->pasGCPList );
         
@@ -264,6 +336,62 @@ void GDALDestroyTPSTransformer( void *pTransformArg )
     }
 }
 
+/************************************************************************/
+/*                          GDALTPSBuildGrid()                          */
+/*                                                                      */
+/*      Builds the interpolation grid of one direction on first use.    */
+/************************************************************************/
+
+static void GDALTPSBuildGrid( TPSTransformInfo *psInfo, int bDstToSrc )
+{
+    volatile int* pbBuilt = bDstToSrc ? &psInfo->bReverseGridBuilt
+                                      : &psInfo->bForwardGridBuilt;
+    if( *pbBuilt )
+        return;
+
+    CPLMutexHolderD( &psInfo->hGridMutex );
+    if( *pbBuilt )
+        return;
+
+    VizGeorefSpline2D* poSpline = bDstToSrc ? psInfo->poReverse
+                                            : psInfo->poForward;
+    VizGeorefSpline2D* poPixelToGeo = psInfo->bReversed ? psInfo->poReverse
+                                                        : psInfo->poForward;
+    double dfTolerance = psInfo->dfGridErrorThreshold;
+
+/* -------------------------------------------------------------------- */
+/*      The threshold is expressed in pixels. For the pixel/line to     */
+/*      georeferenced spline, convert it with the local pixel size at   */
+/*      the center of the GCPs.                                         */
+/* -------------------------------------------------------------------- */
+    if( poSpline == poPixelToGeo )
+    {
+        double dfPixel = 0.0, dfLine = 0.0;
+        for( int i = 0; i < psInfo->nGCPCount; i++ )
+        {
+            dfPixel += psInfo->pasGCPList[i].dfGCPPixel;
+            dfLine += psInfo->pasGCPList[i].dfGCPLine;
+        }
+        if( psInfo->nGCPCount > 0 )
+        {
+            dfPixel /= psInfo->nGCPCount;
+            dfLine /= psInfo->nGCPCount;
+        }
+        double adfXY0[2], adfXY1[2], adfXY2[2];
+        poSpline->get_point( dfPixel, dfLine, adfXY0 );
+        poSpline->get_point( dfPixel + 1, dfLine, adfXY1 );
+        poSpline->get_point( dfPixel, dfLine + 1, adfXY2 );
+        double dfDet = (adfXY1[0] - adfXY0[0]) * (adfXY2[1] - adfXY0[1]) -
+                       (adfXY1[1] - adfXY0[1]) * (adfXY2[0] - adfXY0[0]);
+        dfTolerance *= sqrt( fabs(dfDet) );
+    }
+
+    if( dfTolerance > 0 )
+        poSpline->build_grid( dfTolerance );
+
+    *pbBuilt = TRUE;
+}
+
 /************************************************************************/
 /*                          GDALTPSTransform()                          */
 /************************************************************************/
@@ -300,6 +428,9 @@ int GDALTPSTransform( void *pTransformArg, int bDstToSrc,
     int    i;
     TPSTransformInfo *psInfo = (TPSTransformInfo *) pTransformArg;
 
+    if( psInfo->dfGridErrorThreshold > 0 && nPointCount > 0 )
+        GDALTPSBuildGrid( psInfo, bDstToSrc );
+
     for( i = 0; i < nPointCount; i++ )
     {
         double xy_out[2];
@@ -342,6 +473,19 @@ CPLXMLNode *GDALSerializeTPSTransformer( void *pTransformArg )
     CPLCreateXMLElementAndValue( 
         psTree, "Reversed", 
         CPLString().Printf( "%d", psInfo->bReversed ) );
+
+/* -------------------------------------------------------------------- */
+/*      Serialize options.                                              */
+/* -------------------------------------------------------------------- */
+    if( psInfo->eSolver != VIZ_GEOREF_SPLINE_SOLVER_DIRECT )
+        CPLCreateXMLElementAndValue( 
+            psTree, "Solver",
+            psInfo->eSolver == VIZ_GEOREF_SPLINE_SOLVER_ITERATIVE ? "ITERATIVE"
+                                                                  : "AUTO" );
+    if( psInfo->dfGridErrorThreshold > 0 )
+        CPLCreateXMLElementAndValue( 
+            psTree, "GridErrorThreshold",
+            CPLString().Printf( "%.15g", psInfo->dfGridErrorThreshold ) );
                                  
 /* -------------------------------------------------------------------- */
 /*	Attach GCP List. 						*/
@@ -387,10 +531,21 @@ void *GDALDeserializeTPSTransformer( CPLXMLNode *psTree )
 /* -------------------------------------------------------------------- */
     bReversed = atoi(CPLGetXMLValue(psTree,"Reversed","0"));
 
+    char** papszOptions = NULL;
+    const char* pszSolver = CPLGetXMLValue(psTree,"Solver",NULL);
+    if( pszSolver != NULL )
+        papszOptions = CSLSetNameValue( papszOptions, "TPS_SOLVER", pszSolver );
+    const char* pszThreshold = CPLGetXMLValue(psTree,"GridErrorThreshold",NULL);
+    if( pszThreshold != NULL )
+        papszOptions = CSLSetNameValue( papszOptions,
+                                        "TPS_GRID_ERROR_THRESHOLD", pszThreshold );
+
 /* -------------------------------------------------------------------- */
 /*      Generate transformation.                                        */
 /* -------------------------------------------------------------------- */
-    pResult = GDALCreateTPSTransformer( nGCPCount, pasGCPList, bReversed );
+    pResult = GDALCreateTPSTransformerInt( nGCPCount, pasGCPList, bReversed,
+                                           papszOptions );
+    CSLDestroy( papszOptions );
     
 /* -------------------------------------------------------------------- */
 /*      Cleanup GCP copy.                                               */
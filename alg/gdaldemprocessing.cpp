@@ -0,0 +1,1186 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL DEM Utilities
+ * Purpose:  3x3 window processing of DEMs (hillshade, slope, aspect, TRI,
+ *           TPI, roughness), as used by the gdaldem utility.
+ * Authors:  Matthew Perry, perrygeo at gmail.com
+ *           Even Rouault, even dot rouault at mines dash paris dot org
+ *           Howard Butler, hobu.inc at gmail.com
+ *           Chris Yesson, chris dot yesson at ioz dot ac dot uk
+ *
+ ******************************************************************************
+ * Copyright (c) 2006, 2009 Matthew Perry
+ * Copyright (c) 2009-2015, Even Rouault <even dot rouault at mines-paris dot org>
+ * Portions derived from GRASS 4.1 (public domain) See
+ * http://trac.osgeo.org/gdal/ticket/2975 for more information regarding
+ * history of this code
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************
+ *
+ * See apps/gdaldem.cpp for the references of the algorithms.
+ ****************************************************************************/
+
+#include "gdal_priv.h"
+#include "gdal_alg.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+
+#include <vector>
+
+/* We restrict to 64bit processors because they are guaranteed to have SSE2 */
+#if defined(__x86_64) || defined(_M_X64)
+#define GDALDEM_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+CPL_CVSID("$Id$");
+
+#ifndef M_PI
+# define M_PI  3.1415926535897932384626433832795
+#endif
+
+/************************************************************************/
+/*                           GDALDEMParams                              */
+/************************************************************************/
+
+typedef enum
+{
+    GDEM_HILLSHADE,
+    GDEM_SLOPE,
+    GDEM_ASPECT,
+    GDEM_TRI,
+    GDEM_TPI,
+    GDEM_ROUGHNESS
+} GDALDEMAlgorithm;
+
+typedef struct
+{
+    GDALDEMAlgorithm eAlg;
+    int     bZevenbergenThorne;
+    int     bCombined;
+    int     bComputeAtEdges;
+
+    int     bSrcHasNoData;
+    float   fSrcNoDataValue;
+    float   fDstNoDataValue;
+
+    double  nsres;
+    double  ewres;
+
+    /* Hillshade */
+    double  sin_altRadians;
+    double  cos_altRadians_mul_z_scale_factor;
+    double  azRadians;
+    double  sin_azRadians;
+    double  cos_azRadians;
+    double  square_z_scale_factor;
+    double  square_M_PI_2;
+
+    /* Slope */
+    double  scale;
+    int     slopeFormat; /* 0 = percent, 1 = degrees */
+
+    /* Aspect */
+    int     bAngleAsAzimuth;
+} GDALDEMParams;
+
+/************************************************************************/
+/* ==================================================================== */
+/*                               Kernels                                */
+/*                                                                      */
+/*      Each kernel computes the value of one pixel from its 3x3        */
+/*      window:                                                         */
+/*                                                                      */
+/*      0 1 2                                                           */
+/*      3 4 5                                                           */
+/*      6 7 8                                                           */
+/*                                                                      */
+/*      They are used as template parameters, so that the per pixel     */
+/*      computation is inlined in the processing loops.                 */
+/* ==================================================================== */
+/************************************************************************/
+
+/* Unoptimized formulas for hillshade are :
+    x = psData->z*((afWin[0] + afWin[3] + afWin[3] + afWin[6]) -
+        (afWin[2] + afWin[5] + afWin[5] + afWin[8])) /
+        (8.0 * psData->ewres * psData->scale);
+
+    y = psData->z*((afWin[6] + afWin[7] + afWin[7] + afWin[8]) -
+        (afWin[0] + afWin[1] + afWin[1] + afWin[2])) /
+        (8.0 * psData->nsres * psData->scale);
+
+    slope = M_PI / 2 - atan(sqrt(x*x + y*y));
+
+    aspect = atan2(y,x);
+
+    cang = sin(alt * degreesToRadians) * sin(slope) +
+           cos(alt * degreesToRadians) * cos(slope) *
+           cos(az * degreesToRadians - M_PI/2 - aspect);
+
+   As aspect = atan2(y,x), sqrt(x*x+y*y) * sin(aspect - az) is also
+   y * cos(az) - x * sin(az), which avoids any trigonometric call per pixel.
+*/
+
+struct GDALDEMHornGradient
+{
+    static inline void Compute( const float* afWin, const GDALDEMParams* psParams,
+                                double& x, double& y )
+    {
+        x = ((afWin[0] + afWin[3] + afWin[3] + afWin[6]) -
+             (afWin[2] + afWin[5] + afWin[5] + afWin[8])) / psParams->ewres;
+
+        y = ((afWin[6] + afWin[7] + afWin[7] + afWin[8]) -
+             (afWin[0] + afWin[1] + afWin[1] + afWin[2])) / psParams->nsres;
+    }
+};
+
+struct GDALDEMZevenbergenThorneGradient
+{
+    static inline void Compute( const float* afWin, const GDALDEMParams* psParams,
+                                double& x, double& y )
+    {
+        x = (afWin[3] - afWin[5]) / psParams->ewres;
+
+        y = (afWin[7] - afWin[1]) / psParams->nsres;
+    }
+};
+
+template<class Gradient> struct GDALDEMHillshade
+{
+    static inline float Compute( const float* afWin, const GDALDEMParams* psParams )
+    {
+        double x, y, xx_plus_yy, cang;
+
+        Gradient::Compute( afWin, psParams, x, y );
+
+        xx_plus_yy = x * x + y * y;
+
+        cang = (psParams->sin_altRadians -
+                psParams->cos_altRadians_mul_z_scale_factor *
+                (y * psParams->cos_azRadians - x * psParams->sin_azRadians)) /
+               sqrt(1 + psParams->square_z_scale_factor * xx_plus_yy);
+
+        if (cang <= 0.0)
+            cang = 1.0;
+        else
+            cang = 1.0 + (254.0 * cang);
+
+        return (float) cang;
+    }
+};
+
+template<class Gradient> struct GDALDEMHillshadeCombined
+{
+    static inline float Compute( const float* afWin, const GDALDEMParams* psParams )
+    {
+        double x, y, xx_plus_yy, cang;
+
+        Gradient::Compute( afWin, psParams, x, y );
+
+        xx_plus_yy = x * x + y * y;
+
+        double slope = xx_plus_yy * psParams->square_z_scale_factor;
+
+        cang = acos((psParams->sin_altRadians -
+                     psParams->cos_altRadians_mul_z_scale_factor *
+                     (y * psParams->cos_azRadians - x * psParams->sin_azRadians)) /
+                    sqrt(1 + slope));
+
+        // combined shading
+        cang = 1 - cang * atan(sqrt(slope)) / psParams->square_M_PI_2;
+
+        if (cang <= 0.0)
+            cang = 1.0;
+        else
+            cang = 1.0 + (254.0 * cang);
+
+        return (float) cang;
+    }
+};
+
+template<class Gradient, int nDiv> struct GDALDEMSlope
+{
+    static inline float Compute( const float* afWin, const GDALDEMParams* psParams )
+    {
+        const double radiansToDegrees = 180.0 / M_PI;
+        double dx, dy, key;
+
+        Gradient::Compute( afWin, psParams, dx, dy );
+
+        key = (dx * dx + dy * dy);
+
+        if (psParams->slopeFormat == 1)
+            return (float) (atan(sqrt(key) / (nDiv*psParams->scale)) * radiansToDegrees);
+        else
+            return (float) (100*(sqrt(key) / (nDiv*psParams->scale)));
+    }
+};
+
+static inline float GDALDEMAspectFromDelta( double dx, double dy,
+                                            const GDALDEMParams* psParams )
+{
+    const double degreesToRadians = M_PI / 180.0;
+    float aspect;
+
+    aspect = (float) (atan2(dy,-dx) / degreesToRadians);
+
+    if (dx == 0 && dy == 0)
+    {
+        /* Flat area */
+        aspect = psParams->fDstNoDataValue;
+    }
+    else if ( psParams->bAngleAsAzimuth )
+    {
+        if (aspect > 90.0)
+            aspect = 450.0f - aspect;
+        else
+            aspect = 90.0f - aspect;
+    }
+    else
+    {
+        if (aspect < 0)
+            aspect += 360.0;
+    }
+
+    if (aspect == 360.0)
+        aspect = 0.0;
+
+    return aspect;
+}
+
+struct GDALDEMAspectHorn
+{
+    static inline float Compute( const float* afWin, const GDALDEMParams* psParams )
+    {
+        double dx, dy;
+
+        dx = ((afWin[2] + afWin[5] + afWin[5] + afWin[8]) -
+              (afWin[0] + afWin[3] + afWin[3] + afWin[6]));
+
+        dy = ((afWin[6] + afWin[7] + afWin[7] + afWin[8]) -
+              (afWin[0] + afWin[1] + afWin[1] + afWin[2]));
+
+        return GDALDEMAspectFromDelta( dx, dy, psParams );
+    }
+};
+
+struct GDALDEMAspectZevenbergenThorne
+{
+    static inline float Compute( const float* afWin, const GDALDEMParams* psParams )
+    {
+        double dx, dy;
+
+        dx = (afWin[5] - afWin[3]);
+
+        dy = (afWin[7] - afWin[1]);
+
+        return GDALDEMAspectFromDelta( dx, dy, psParams );
+    }
+};
+
+struct GDALDEMTRI
+{
+    static inline float Compute( const float* afWin, const GDALDEMParams* )
+    {
+        // Terrain Ruggedness is average difference in height
+        return (fabs(afWin[0]-afWin[4]) +
+                fabs(afWin[1]-afWin[4]) +
+                fabs(afWin[2]-afWin[4]) +
+                fabs(afWin[3]-afWin[4]) +
+                fabs(afWin[5]-afWin[4]) +
+                fabs(afWin[6]-afWin[4]) +
+                fabs(afWin[7]-afWin[4]) +
+                fabs(afWin[8]-afWin[4]))/8;
+    }
+};
+
+struct GDALDEMTPI
+{
+    static inline float Compute( const float* afWin, const GDALDEMParams* )
+    {
+        // Terrain Position is the difference between
+        // The central cell and the mean of the surrounding cells
+        return afWin[4] -
+                ((afWin[0]+
+                  afWin[1]+
+                  afWin[2]+
+                  afWin[3]+
+                  afWin[5]+
+                  afWin[6]+
+                  afWin[7]+
+                  afWin[8])/8);
+    }
+};
+
+struct GDALDEMRoughness
+{
+    static inline float Compute( const float* afWin, const GDALDEMParams* )
+    {
+        // Roughness is the largest difference
+        //  between any two cells
+
+        float fRoughnessMin = afWin[0];
+        float fRoughnessMax = afWin[0];
+
+        for ( int k = 1; k < 9; k++)
+        {
+            if (afWin[k] > fRoughnessMax)
+                fRoughnessMax = afWin[k];
+            if (afWin[k] < fRoughnessMin)
+                fRoughnessMin = afWin[k];
+        }
+        return fRoughnessMax - fRoughnessMin;
+    }
+};
+
+/************************************************************************/
+/*                          GDALDEMComputeVal()                         */
+/*                                                                      */
+/*      Apply the nodata rules before running the kernel.               */
+/************************************************************************/
+
+template<class Kernel>
+static inline float GDALDEMComputeVal( float* afWin,
+                                       const GDALDEMParams* psParams )
+{
+    if (psParams->bSrcHasNoData)
+    {
+        const float fSrcNoDataValue = psParams->fSrcNoDataValue;
+
+        if (ARE_REAL_EQUAL(afWin[4], fSrcNoDataValue))
+            return psParams->fDstNoDataValue;
+
+        for( int k = 0; k < 9; k++ )
+        {
+            if (ARE_REAL_EQUAL(afWin[k], fSrcNoDataValue))
+            {
+                if (psParams->bComputeAtEdges)
+                    afWin[k] = afWin[4];
+                else
+                    return psParams->fDstNoDataValue;
+            }
+        }
+    }
+
+    return Kernel::Compute( afWin, psParams );
+}
+
+/************************************************************************/
+/*                           GDALDEMInterpol()                          */
+/*                                                                      */
+/*      Extrapolate a value outside of the raster from the two          */
+/*      nearest ones.                                                   */
+/************************************************************************/
+
+static inline float GDALDEMInterpol( float a, float b,
+                                     const GDALDEMParams* psParams )
+{
+    if( psParams->bSrcHasNoData
+        && (ARE_REAL_EQUAL(a, psParams->fSrcNoDataValue)
+            || ARE_REAL_EQUAL(b, psParams->fSrcNoDataValue)) )
+        return psParams->fSrcNoDataValue;
+    return 2 * (a) - (b);
+}
+
+/************************************************************************/
+/*                          GDALDEMProcessRowSIMD()                     */
+/*                                                                      */
+/*      Optional vectorized processing of the inner part of a line,     */
+/*      when there is no source nodata.  Returns the index of the       */
+/*      first pixel that has not been processed.                        */
+/************************************************************************/
+
+template<class Kernel>
+static int GDALDEMProcessRowSIMD( const GDALDEMParams*,
+                                  const float*, const float*, const float*,
+                                  int, float* )
+{
+    return 1;
+}
+
+#ifdef GDALDEM_USE_SSE2
+
+/************************************************************************/
+/*                       GDALDEMHillshadeSSE2()                         */
+/*                                                                      */
+/*      Compute 4 pixels at a time.  The sums of the gradients are      */
+/*      computed in single precision like the scalar code, and the      */
+/*      rest in double precision, so that the results are identical     */
+/*      to the ones of GDALDEMHillshade<>::Compute().                   */
+/************************************************************************/
+
+template<int bHorn>
+static int GDALDEMHillshadeSSE2( const GDALDEMParams* psParams,
+                                 const float* pafPrev, const float* pafCur,
+                                 const float* pafNext, int nXSize,
+                                 float* pafOut )
+{
+    const __m128d xmm_ewres = _mm_set1_pd( psParams->ewres );
+    const __m128d xmm_nsres = _mm_set1_pd( psParams->nsres );
+    const __m128d xmm_sin_alt = _mm_set1_pd( psParams->sin_altRadians );
+    const __m128d xmm_cos_alt_zsf =
+        _mm_set1_pd( psParams->cos_altRadians_mul_z_scale_factor );
+    const __m128d xmm_cos_az = _mm_set1_pd( psParams->cos_azRadians );
+    const __m128d xmm_sin_az = _mm_set1_pd( psParams->sin_azRadians );
+    const __m128d xmm_square_zsf =
+        _mm_set1_pd( psParams->square_z_scale_factor );
+    const __m128d xmm_zero = _mm_setzero_pd();
+    const __m128d xmm_one = _mm_set1_pd( 1.0 );
+    const __m128d xmm_254 = _mm_set1_pd( 254.0 );
+    int j;
+
+    for( j = 1; j + 4 <= nXSize - 1; j += 4 )
+    {
+        __m128 xmm_dx, xmm_dy;
+
+        if( bHorn )
+        {
+            __m128 w0 = _mm_loadu_ps( pafPrev + j - 1 );
+            __m128 w1 = _mm_loadu_ps( pafPrev + j );
+            __m128 w2 = _mm_loadu_ps( pafPrev + j + 1 );
+            __m128 w3 = _mm_loadu_ps( pafCur + j - 1 );
+            __m128 w5 = _mm_loadu_ps( pafCur + j + 1 );
+            __m128 w6 = _mm_loadu_ps( pafNext + j - 1 );
+            __m128 w7 = _mm_loadu_ps( pafNext + j );
+            __m128 w8 = _mm_loadu_ps( pafNext + j + 1 );
+
+            xmm_dx = _mm_sub_ps(
+                _mm_add_ps(_mm_add_ps(_mm_add_ps(w0, w3), w3), w6),
+                _mm_add_ps(_mm_add_ps(_mm_add_ps(w2, w5), w5), w8) );
+            xmm_dy = _mm_sub_ps(
+                _mm_add_ps(_mm_add_ps(_mm_add_ps(w6, w7), w7), w8),
+                _mm_add_ps(_mm_add_ps(_mm_add_ps(w0, w1), w1), w2) );
+        }
+        else
+        {
+            xmm_dx = _mm_sub_ps( _mm_loadu_ps( pafCur + j - 1 ),
+                                 _mm_loadu_ps( pafCur + j + 1 ) );
+            xmm_dy = _mm_sub_ps( _mm_loadu_ps( pafNext + j ),
+                                 _mm_loadu_ps( pafPrev + j ) );
+        }
+
+        __m128d axmm_cang[2];
+
+        for( int iHalf = 0; iHalf < 2; iHalf++ )
+        {
+            __m128d x, y;
+
+            if( iHalf == 0 )
+            {
+                x = _mm_cvtps_pd( xmm_dx );
+                y = _mm_cvtps_pd( xmm_dy );
+            }
+            else
+            {
+                x = _mm_cvtps_pd( _mm_movehl_ps( xmm_dx, xmm_dx ) );
+                y = _mm_cvtps_pd( _mm_movehl_ps( xmm_dy, xmm_dy ) );
+            }
+            x = _mm_div_pd( x, xmm_ewres );
+            y = _mm_div_pd( y, xmm_nsres );
+
+            __m128d xx_plus_yy = _mm_add_pd( _mm_mul_pd(x, x),
+                                             _mm_mul_pd(y, y) );
+            __m128d num = _mm_sub_pd( xmm_sin_alt,
+                _mm_mul_pd( xmm_cos_alt_zsf,
+                            _mm_sub_pd( _mm_mul_pd(y, xmm_cos_az),
+                                        _mm_mul_pd(x, xmm_sin_az) ) ) );
+            __m128d den = _mm_sqrt_pd(
+                _mm_add_pd( xmm_one, _mm_mul_pd(xmm_square_zsf, xx_plus_yy) ) );
+            __m128d cang = _mm_div_pd( num, den );
+
+            /* cang <= 0 ? 1 : 1 + 254 * cang */
+            __m128d mask = _mm_cmple_pd( cang, xmm_zero );
+            cang = _mm_add_pd( xmm_one,
+                               _mm_andnot_pd( mask,
+                                              _mm_mul_pd( xmm_254, cang ) ) );
+            axmm_cang[iHalf] = cang;
+        }
+
+        _mm_storeu_ps( pafOut + j,
+                       _mm_movelh_ps( _mm_cvtpd_ps( axmm_cang[0] ),
+                                      _mm_cvtpd_ps( axmm_cang[1] ) ) );
+    }
+
+    return j;
+}
+
+template<>
+int GDALDEMProcessRowSIMD< GDALDEMHillshade<GDALDEMHornGradient> >(
+    const GDALDEMParams* psParams,
+    const float* pafPrev, const float* pafCur, const float* pafNext,
+    int nXSize, float* pafOut )
+{
+    return GDALDEMHillshadeSSE2<TRUE>( psParams, pafPrev, pafCur, pafNext,
+                                       nXSize, pafOut );
+}
+
+template<>
+int GDALDEMProcessRowSIMD< GDALDEMHillshade<GDALDEMZevenbergenThorneGradient> >(
+    const GDALDEMParams* psParams,
+    const float* pafPrev, const float* pafCur, const float* pafNext,
+    int nXSize, float* pafOut )
+{
+    return GDALDEMHillshadeSSE2<FALSE>( psParams, pafPrev, pafCur, pafNext,
+                                        nXSize, pafOut );
+}
+
+#endif /* GDALDEM_USE_SSE2 */
+
+/************************************************************************/
+/*                          GDALDEMProcessRow()                         */
+/*                                                                      */
+/*      Compute one output line.  pafPrev and pafNext are NULL for      */
+/*      the first and last lines of the raster.                         */
+/************************************************************************/
+
+template<class Kernel>
+static void GDALDEMProcessRow( const GDALDEMParams* psParams,
+                               const float* pafPrev, const float* pafCur,
+                               const float* pafNext, int nXSize, int nYSize,
+                               float* pafOut )
+{
+    const float fDstNoDataValue = psParams->fDstNoDataValue;
+    float afWin[9];
+    int j;
+
+/* -------------------------------------------------------------------- */
+/*      First and last lines.                                           */
+/* -------------------------------------------------------------------- */
+    if( pafPrev == NULL || pafNext == NULL )
+    {
+        if( !(psParams->bComputeAtEdges && nXSize >= 2 && nYSize >= 2) )
+        {
+            for( j = 0; j < nXSize; j++ )
+                pafOut[j] = fDstNoDataValue;
+            return;
+        }
+
+        for (j = 0; j < nXSize; j++)
+        {
+            int jmin = (j == 0) ? j : j - 1;
+            int jmax = (j == nXSize - 1) ? j : j + 1;
+
+            if( pafPrev == NULL )
+            {
+                afWin[0] = GDALDEMInterpol(pafCur[jmin], pafNext[jmin], psParams);
+                afWin[1] = GDALDEMInterpol(pafCur[j],    pafNext[j], psParams);
+                afWin[2] = GDALDEMInterpol(pafCur[jmax], pafNext[jmax], psParams);
+                afWin[3] = pafCur[jmin];
+                afWin[4] = pafCur[j];
+                afWin[5] = pafCur[jmax];
+                afWin[6] = pafNext[jmin];
+                afWin[7] = pafNext[j];
+                afWin[8] = pafNext[jmax];
+            }
+            else
+            {
+                afWin[0] = pafPrev[jmin];
+                afWin[1] = pafPrev[j];
+                afWin[2] = pafPrev[jmax];
+                afWin[3] = pafCur[jmin];
+                afWin[4] = pafCur[j];
+                afWin[5] = pafCur[jmax];
+                afWin[6] = GDALDEMInterpol(pafCur[jmin], pafPrev[jmin], psParams);
+                afWin[7] = GDALDEMInterpol(pafCur[j],    pafPrev[j], psParams);
+                afWin[8] = GDALDEMInterpol(pafCur[jmax], pafPrev[jmax], psParams);
+            }
+
+            pafOut[j] = GDALDEMComputeVal<Kernel>( afWin, psParams );
+        }
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      First and last columns.                                         */
+/* -------------------------------------------------------------------- */
+    if (psParams->bComputeAtEdges && nXSize >= 2)
+    {
+        j = 0;
+        afWin[0] = GDALDEMInterpol(pafPrev[j], pafPrev[j+1], psParams);
+        afWin[1] = pafPrev[j];
+        afWin[2] = pafPrev[j+1];
+        afWin[3] = GDALDEMInterpol(pafCur[j], pafCur[j+1], psParams);
+        afWin[4] = pafCur[j];
+        afWin[5] = pafCur[j+1];
+        afWin[6] = GDALDEMInterpol(pafNext[j], pafNext[j+1], psParams);
+        afWin[7] = pafNext[j];
+        afWin[8] = pafNext[j+1];
+
+        pafOut[j] = GDALDEMComputeVal<Kernel>( afWin, psParams );
+
+        j = nXSize - 1;
+        afWin[0] = pafPrev[j-1];
+        afWin[1] = pafPrev[j];
+        afWin[2] = GDALDEMInterpol(pafPrev[j], pafPrev[j-1], psParams);
+        afWin[3] = pafCur[j-1];
+        afWin[4] = pafCur[j];
+        afWin[5] = GDALDEMInterpol(pafCur[j], pafCur[j-1], psParams);
+        afWin[6] = pafNext[j-1];
+        afWin[7] = pafNext[j];
+        afWin[8] = GDALDEMInterpol(pafNext[j], pafNext[j-1], psParams);
+
+        pafOut[j] = GDALDEMComputeVal<Kernel>( afWin, psParams );
+    }
+    else
+    {
+        pafOut[0] = fDstNoDataValue;
+        if (nXSize > 1)
+            pafOut[nXSize - 1] = fDstNoDataValue;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Inner part of the line.                                         */
+/* -------------------------------------------------------------------- */
+    if( !psParams->bSrcHasNoData )
+    {
+        j = GDALDEMProcessRowSIMD<Kernel>( psParams, pafPrev, pafCur, pafNext,
+                                           nXSize, pafOut );
+        for( ; j < nXSize - 1; j++ )
+        {
+            afWin[0] = pafPrev[j-1];
+            afWin[1] = pafPrev[j];
+            afWin[2] = pafPrev[j+1];
+            afWin[3] = pafCur[j-1];
+            afWin[4] = pafCur[j];
+            afWin[5] = pafCur[j+1];
+            afWin[6] = pafNext[j-1];
+            afWin[7] = pafNext[j];
+            afWin[8] = pafNext[j+1];
+
+            pafOut[j] = Kernel::Compute( afWin, psParams );
+        }
+    }
+    else
+    {
+        for( j = 1; j < nXSize - 1; j++ )
+        {
+            afWin[0] = pafPrev[j-1];
+            afWin[1] = pafPrev[j];
+            afWin[2] = pafPrev[j+1];
+            afWin[3] = pafCur[j-1];
+            afWin[4] = pafCur[j];
+            afWin[5] = pafCur[j+1];
+            afWin[6] = pafNext[j-1];
+            afWin[7] = pafNext[j];
+            afWin[8] = pafNext[j+1];
+
+            pafOut[j] = GDALDEMComputeVal<Kernel>( afWin, psParams );
+        }
+    }
+}
+
+/************************************************************************/
+/*                           GDALDEMStripJob                            */
+/************************************************************************/
+
+typedef struct
+{
+    const GDALDEMParams *psParams;
+    int     nXSize;
+    int     nYSize;
+    int     nYOff;       /* first output line */
+    int     nLines;      /* number of output lines */
+    int     nSrcYOff;    /* first line of pafSrc */
+    float  *pafSrc;      /* output lines with their 1 line halo */
+    float  *pafDst;
+    void   *hThread;
+} GDALDEMStripJob;
+
+/************************************************************************/
+/*                          GDALDEMProcessStrip()                       */
+/************************************************************************/
+
+template<class Kernel>
+static void GDALDEMProcessStrip( GDALDEMStripJob* psJob )
+{
+    const int nXSize = psJob->nXSize;
+    const int nYSize = psJob->nYSize;
+
+    for( int i = 0; i < psJob->nLines; i++ )
+    {
+        int iLine = psJob->nYOff + i;
+        const float* pafCur = psJob->pafSrc
+            + (size_t)(iLine - psJob->nSrcYOff) * nXSize;
+        const float* pafPrev = (iLine > 0) ? pafCur - nXSize : NULL;
+        const float* pafNext = (iLine < nYSize - 1) ? pafCur + nXSize : NULL;
+
+        GDALDEMProcessRow<Kernel>( psJob->psParams, pafPrev, pafCur, pafNext,
+                                   nXSize, nYSize,
+                                   psJob->pafDst + (size_t)i * nXSize );
+    }
+}
+
+/************************************************************************/
+/*                        GDALDEMProcessStripFunc()                     */
+/*                                                                      */
+/*      Dispatch to the specialization of the kernel.                   */
+/************************************************************************/
+
+static void GDALDEMProcessStripFunc( void* pData )
+{
+    GDALDEMStripJob* psJob = (GDALDEMStripJob*) pData;
+    const GDALDEMParams* psParams = psJob->psParams;
+
+    switch( psParams->eAlg )
+    {
+        case GDEM_HILLSHADE:
+            if( psParams->bZevenbergenThorne )
+            {
+                if( psParams->bCombined )
+                    GDALDEMProcessStrip< GDALDEMHillshadeCombined<
+                        GDALDEMZevenbergenThorneGradient> >( psJob );
+                else
+                    GDALDEMProcessStrip< GDALDEMHillshade<
+                        GDALDEMZevenbergenThorneGradient> >( psJob );
+            }
+            else
+            {
+                if( psParams->bCombined )
+                    GDALDEMProcessStrip< GDALDEMHillshadeCombined<
+                        GDALDEMHornGradient> >( psJob );
+                else
+                    GDALDEMProcessStrip< GDALDEMHillshade<
+                        GDALDEMHornGradient> >( psJob );
+            }
+            break;
+
+        case GDEM_SLOPE:
+            if( psParams->bZevenbergenThorne )
+                GDALDEMProcessStrip< GDALDEMSlope<
+                    GDALDEMZevenbergenThorneGradient, 2> >( psJob );
+            else
+                GDALDEMProcessStrip< GDALDEMSlope<
+                    GDALDEMHornGradient, 8> >( psJob );
+            break;
+
+        case GDEM_ASPECT:
+            if( psParams->bZevenbergenThorne )
+                GDALDEMProcessStrip<GDALDEMAspectZevenbergenThorne>( psJob );
+            else
+                GDALDEMProcessStrip<GDALDEMAspectHorn>( psJob );
+            break;
+
+        case GDEM_TRI:
+            GDALDEMProcessStrip<GDALDEMTRI>( psJob );
+            break;
+
+        case GDEM_TPI:
+            GDALDEMProcessStrip<GDALDEMTPI>( psJob );
+            break;
+
+        case GDEM_ROUGHNESS:
+            GDALDEMProcessStrip<GDALDEMRoughness>( psJob );
+            break;
+    }
+}
+
+/************************************************************************/
+/*                          GDALDEMInitParams()                         */
+/************************************************************************/
+
+static int GDALDEMInitParams( GDALRasterBandH hSrcBand,
+                              const char *pszProcessing,
+                              char **papszOptions, GDALDEMParams* psParams )
+{
+    memset( psParams, 0, sizeof(GDALDEMParams) );
+
+    if( EQUAL(pszProcessing, "hillshade") || EQUAL(pszProcessing, "shade") )
+        psParams->eAlg = GDEM_HILLSHADE;
+    else if( EQUAL(pszProcessing, "slope") )
+        psParams->eAlg = GDEM_SLOPE;
+    else if( EQUAL(pszProcessing, "aspect") )
+        psParams->eAlg = GDEM_ASPECT;
+    else if( EQUAL(pszProcessing, "TRI") )
+        psParams->eAlg = GDEM_TRI;
+    else if( EQUAL(pszProcessing, "TPI") )
+        psParams->eAlg = GDEM_TPI;
+    else if( EQUAL(pszProcessing, "roughness") )
+        psParams->eAlg = GDEM_ROUGHNESS;
+    else
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "Unsupported DEM processing: %s", pszProcessing );
+        return FALSE;
+    }
+
+    const char* pszAlg = CSLFetchNameValueDef( papszOptions, "ALG", "Horn" );
+    if( EQUAL(pszAlg, "ZevenbergenThorne") )
+        psParams->bZevenbergenThorne = TRUE;
+    else if( !EQUAL(pszAlg, "Horn") )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "Wrong value for ALG : %s.", pszAlg );
+        return FALSE;
+    }
+
+    psParams->bCombined = CSLFetchBoolean( papszOptions, "COMBINED", FALSE );
+    psParams->bComputeAtEdges =
+        CSLFetchBoolean( papszOptions, "COMPUTE_EDGES", FALSE );
+    psParams->bAngleAsAzimuth =
+        !CSLFetchBoolean( papszOptions, "TRIGONOMETRIC", FALSE );
+    psParams->slopeFormat =
+        EQUAL(CSLFetchNameValueDef( papszOptions, "SLOPE_FORMAT", "DEGREE" ),
+              "PERCENT") ? 0 : 1;
+
+    double adfGeoTransform[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+    GDALDatasetH hSrcDS = GDALGetBandDataset( hSrcBand );
+    if( hSrcDS != NULL )
+        GDALGetGeoTransform( hSrcDS, adfGeoTransform );
+
+    psParams->nsres = adfGeoTransform[5];
+    psParams->ewres = adfGeoTransform[1];
+
+    double z = CPLAtof( CSLFetchNameValueDef( papszOptions, "Z_FACTOR", "1" ) );
+    double scale = CPLAtof( CSLFetchNameValueDef( papszOptions, "SCALE", "1" ) );
+    double alt = CPLAtof( CSLFetchNameValueDef( papszOptions, "ALTITUDE", "45" ) );
+    double az = CPLAtof( CSLFetchNameValueDef( papszOptions, "AZIMUTH", "315" ) );
+
+    const double degreesToRadians = M_PI / 180.0;
+    psParams->sin_altRadians = sin(alt * degreesToRadians);
+    psParams->azRadians = az * degreesToRadians;
+    psParams->sin_azRadians = sin(psParams->azRadians);
+    psParams->cos_azRadians = cos(psParams->azRadians);
+    double z_scale_factor =
+        z / (((psParams->bZevenbergenThorne) ? 2 : 8) * scale);
+    psParams->cos_altRadians_mul_z_scale_factor =
+        cos(alt * degreesToRadians) * z_scale_factor;
+    psParams->square_z_scale_factor = z_scale_factor * z_scale_factor;
+    psParams->square_M_PI_2 = (M_PI*M_PI)/4;
+
+    psParams->scale = scale;
+
+    psParams->fSrcNoDataValue =
+        (float) GDALGetRasterNoDataValue( hSrcBand, &psParams->bSrcHasNoData );
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                          GDALDEMGetThreads()                         */
+/************************************************************************/
+
+static int GDALDEMGetThreads( char **papszOptions )
+{
+    const char* pszThreads = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    if( pszThreads == NULL )
+        pszThreads = CPLGetConfigOption( "GDAL_NUM_THREADS", "1" );
+
+    int nThreads;
+    if( EQUAL(pszThreads, "ALL_CPUS") )
+        nThreads = CPLGetNumCPUs();
+    else
+        nThreads = atoi(pszThreads);
+    if( nThreads > 128 )
+        nThreads = 128;
+    if( nThreads < 1 )
+        nThreads = 1;
+    return nThreads;
+}
+
+/************************************************************************/
+/*                           GDALDEMProcess()                           */
+/*                                                                      */
+/*      Process lines [nYOff, nYOff+nLines[ by strips, nThreads of      */
+/*      them being computed at a time.  The source is read (and the     */
+/*      result written to hDstBand if not NULL) from the calling        */
+/*      thread.  Otherwise the result is written in pafOutput.          */
+/************************************************************************/
+
+static CPLErr GDALDEMProcess( GDALRasterBandH hSrcBand,
+                              const GDALDEMParams* psParams,
+                              int nYOff, int nLines, int nThreads,
+                              GDALRasterBandH hDstBand, float* pafOutput,
+                              GDALProgressFunc pfnProgress,
+                              void * pProgressData )
+{
+    const int nXSize = GDALGetRasterBandXSize( hSrcBand );
+    const int nYSize = GDALGetRasterBandYSize( hSrcBand );
+    CPLErr eErr = CE_None;
+    int iJob;
+
+    if( pfnProgress == NULL )
+        pfnProgress = GDALDummyProgress;
+
+/* -------------------------------------------------------------------- */
+/*      Work on strips of about 4 MB.                                   */
+/* -------------------------------------------------------------------- */
+    int nStripLines = (int) MAX(1, MIN(nLines,
+                                 (4 * 1024 * 1024) / (4.0 * nXSize)));
+    if( nThreads > 1 )
+        nStripLines = MIN(nStripLines, (nLines + nThreads - 1) / nThreads);
+
+    int nStrips = (nLines + nStripLines - 1) / nStripLines;
+    if( nThreads > nStrips )
+        nThreads = nStrips;
+
+    std::vector<GDALDEMStripJob> asJobs( nThreads );
+
+    for( iJob = 0; iJob < nThreads; iJob++ )
+    {
+        GDALDEMStripJob* psJob = &asJobs[iJob];
+
+        psJob->psParams = psParams;
+        psJob->nXSize = nXSize;
+        psJob->nYSize = nYSize;
+        psJob->pafSrc = (float *)
+            VSIMalloc3( sizeof(float), nXSize, nStripLines + 2 );
+        psJob->pafDst = NULL;
+        if( pafOutput == NULL && psJob->pafSrc != NULL )
+            psJob->pafDst = (float *)
+                VSIMalloc3( sizeof(float), nXSize, nStripLines );
+
+        if( psJob->pafSrc == NULL || (pafOutput == NULL && psJob->pafDst == NULL) )
+        {
+            CPLError( CE_Failure, CPLE_OutOfMemory,
+                      "Cannot allocate working buffers" );
+            eErr = CE_Failure;
+        }
+    }
+
+    int iFirstStrip;
+    for( iFirstStrip = 0; iFirstStrip < nStrips && eErr == CE_None;
+         iFirstStrip += nThreads )
+    {
+        int nJobs = MIN(nThreads, nStrips - iFirstStrip);
+
+/* -------------------------------------------------------------------- */
+/*      Read the strips with their halo.                                */
+/* -------------------------------------------------------------------- */
+        for( iJob = 0; iJob < nJobs && eErr == CE_None; iJob++ )
+        {
+            GDALDEMStripJob* psJob = &asJobs[iJob];
+
+            psJob->nYOff = nYOff + (iFirstStrip + iJob) * nStripLines;
+            psJob->nLines = MIN(nStripLines, nYOff + nLines - psJob->nYOff);
+            psJob->nSrcYOff = MAX(0, psJob->nYOff - 1);
+            psJob->hThread = NULL;
+            if( pafOutput != NULL )
+                psJob->pafDst = pafOutput
+                    + (size_t)(psJob->nYOff - nYOff) * nXSize;
+
+            int nSrcLines =
+                MIN(nYSize, psJob->nYOff + psJob->nLines + 1) - psJob->nSrcYOff;
+
+            eErr = GDALRasterIO( hSrcBand, GF_Read,
+                                 0, psJob->nSrcYOff, nXSize, nSrcLines,
+                                 psJob->pafSrc, nXSize, nSrcLines,
+                                 GDT_Float32, 0, 0 );
+        }
+        if( eErr != CE_None )
+            break;
+
+/* -------------------------------------------------------------------- */
+/*      Compute them.                                                   */
+/* -------------------------------------------------------------------- */
+        if( nJobs == 1 )
+            GDALDEMProcessStripFunc( &asJobs[0] );
+        else
+        {
+            for( iJob = 0; iJob < nJobs; iJob++ )
+                asJobs[iJob].hThread =
+                    CPLCreateJoinableThread( GDALDEMProcessStripFunc,
+                                             &asJobs[iJob] );
+            for( iJob = 0; iJob < nJobs; iJob++ )
+            {
+                if( asJobs[iJob].hThread != NULL )
+                    CPLJoinThread( asJobs[iJob].hThread );
+                else
+                    GDALDEMProcessStripFunc( &asJobs[iJob] );
+            }
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Write them.                                                     */
+/* -------------------------------------------------------------------- */
+        for( iJob = 0; iJob < nJobs && eErr == CE_None && hDstBand != NULL;
+             iJob++ )
+        {
+            GDALDEMStripJob* psJob = &asJobs[iJob];
+
+            eErr = GDALRasterIO( hDstBand, GF_Write,
+                                 0, psJob->nYOff, nXSize, psJob->nLines,
+                                 psJob->pafDst, nXSize, psJob->nLines,
+                                 GDT_Float32, 0, 0 );
+        }
+
+        const GDALDEMStripJob* psLastJob = &asJobs[nJobs - 1];
+        if( eErr == CE_None
+            && !pfnProgress( (psLastJob->nYOff + psLastJob->nLines - nYOff)
+                             / (double) nLines, NULL, pProgressData ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    for( iJob = 0; iJob < nThreads; iJob++ )
+    {
+        CPLFree( asJobs[iJob].pafSrc );
+        if( pafOutput == NULL )
+            CPLFree( asJobs[iJob].pafDst );
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                         GDALDEMProcessBand()                         */
+/************************************************************************/
+
+/**
+ * Compute a DEM derived product on a whole raster band.
+ *
+ * The value of each output pixel is computed from the 3x3 window of
+ * source pixels centered on it.  This is the processing used by the
+ * gdaldem utility for all its modes but color-relief.
+ *
+ * The raster is processed by strips, and several strips can be computed
+ * in parallel.  The source band is read, and the destination band written,
+ * from the calling thread only.
+ *
+ * Supported options are :
+ * <dl>
+ * <dt>"ALG":</dt> <dd>Horn (default) or ZevenbergenThorne. For hillshade,
+ * slope and aspect.</dd>
+ * <dt>"COMPUTE_EDGES":</dt> <dd>YES to compute values at the raster edges
+ * and next to nodata values. Defaults to NO.</dd>
+ * <dt>"Z_FACTOR":</dt> <dd>Vertical exaggeration for hillshade.
+ * Defaults to 1.</dd>
+ * <dt>"SCALE":</dt> <dd>Ratio of vertical units to horizontal ones, for
+ * hillshade and slope. Defaults to 1.</dd>
+ * <dt>"AZIMUTH":</dt> <dd>Azimuth of the light for hillshade, in degrees.
+ * Defaults to 315.</dd>
+ * <dt>"ALTITUDE":</dt> <dd>Altitude of the light for hillshade, in degrees.
+ * Defaults to 45.</dd>
+ * <dt>"COMBINED":</dt> <dd>YES for combined shading. Defaults to NO.</dd>
+ * <dt>"SLOPE_FORMAT":</dt> <dd>DEGREE (default) or PERCENT.</dd>
+ * <dt>"TRIGONOMETRIC":</dt> <dd>YES to express aspect as a trigonometric
+ * angle instead of an azimuth. Defaults to NO.</dd>
+ * <dt>"NUM_THREADS":</dt> <dd>Number of worker threads, or ALL_CPUS.
+ * Defaults to the value of the GDAL_NUM_THREADS configuration option,
+ * or 1.</dd>
+ * </dl>
+ *
+ * The nodata value of the destination band, or 0 if it has none, is
+ * written where no value can be computed, and for flat areas in
+ * aspect mode.
+ *
+ * @param hSrcBand the DEM band.
+ * @param hDstBand the output band, of the same dimensions as hSrcBand.
+ * @param pszProcessing one of "hillshade", "slope", "aspect", "TRI", "TPI"
+ * or "roughness".
+ * @param papszOptions options as described above, or NULL.
+ * @param pfnProgress progress function, or NULL.
+ * @param pProgressData callback data for progress function.
+ *
+ * @return CE_None on success or CE_Failure on error.
+ *
+ * @since GDAL 2.0
+ */
+
+CPLErr GDALDEMProcessBand( GDALRasterBandH hSrcBand, GDALRasterBandH hDstBand,
+                           const char *pszProcessing, char **papszOptions,
+                           GDALProgressFunc pfnProgress, void *pProgressData )
+{
+    VALIDATE_POINTER1( hSrcBand, "GDALDEMProcessBand", CE_Failure );
+    VALIDATE_POINTER1( hDstBand, "GDALDEMProcessBand", CE_Failure );
+    VALIDATE_POINTER1( pszProcessing, "GDALDEMProcessBand", CE_Failure );
+
+    if( pfnProgress == NULL )
+        pfnProgress = GDALDummyProgress;
+
+    if( !pfnProgress( 0.0, NULL, pProgressData ) )
+    {
+        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        return CE_Failure;
+    }
+
+    GDALDEMParams sParams;
+    if( !GDALDEMInitParams( hSrcBand, pszProcessing, papszOptions, &sParams ) )
+        return CE_Failure;
+
+    int bDstHasNoData = FALSE;
+    sParams.fDstNoDataValue =
+        (float) GDALGetRasterNoDataValue( hDstBand, &bDstHasNoData );
+    if( !bDstHasNoData )
+        sParams.fDstNoDataValue = 0.0;
+
+    int nYSize = GDALGetRasterBandYSize( hSrcBand );
+    if( GDALGetRasterBandXSize( hDstBand ) != GDALGetRasterBandXSize( hSrcBand )
+        || GDALGetRasterBandYSize( hDstBand ) != nYSize )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "Source and destination bands have different dimensions" );
+        return CE_Failure;
+    }
+
+    CPLErr eErr = GDALDEMProcess( hSrcBand, &sParams, 0, nYSize,
+                                  GDALDEMGetThreads( papszOptions ),
+                                  hDstBand, NULL, pfnProgress, pProgressData );
+
+    if( eErr == CE_None )
+        pfnProgress( 1.0, NULL, pProgressData );
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                         GDALDEMProcessLines()                        */
+/************************************************************************/
+
+/**
+ * Compute a DEM derived product on a range of lines.
+ *
+ * Same as GDALDEMProcessBand(), except that the nLines full lines starting
+ * at line nYOff are computed into the pafOutput buffer, of at least
+ * nLines * raster width floats.  The value used where no value can be
+ * computed is given by the DST_NODATA option, which defaults to 0.
+ *
+ * @since GDAL 2.0
+ */
+
+CPLErr GDALDEMProcessLines( GDALRasterBandH hSrcBand,
+                            const char *pszProcessing, char **papszOptions,
+                            int nYOff, int nLines, float *pafOutput )
+{
+    VALIDATE_POINTER1( hSrcBand, "GDALDEMProcessLines", CE_Failure );
+    VALIDATE_POINTER1( pszProcessing, "GDALDEMProcessLines", CE_Failure );
+    VALIDATE_POINTER1( pafOutput, "GDALDEMProcessLines", CE_Failure );
+
+    if( nYOff < 0 || nLines <= 0
+        || nYOff + nLines > GDALGetRasterBandYSize( hSrcBand ) )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "Invalid line range: %d,%d", nYOff, nLines );
+        return CE_Failure;
+    }
+
+    GDALDEMParams sParams;
+    if( !GDALDEMInitParams( hSrcBand, pszProcessing, papszOptions, &sParams ) )
+        return CE_Failure;
+
+    sParams.fDstNoDataValue =
+        (float) CPLAtof( CSLFetchNameValueDef( papszOptions, "DST_NODATA", "0" ) );
+
+    return GDALDEMProcess( hSrcBand, &sParams, nYOff, nLines,
+                           GDALDEMGetThreads( papszOptions ),
+                           NULL, pafOutput, NULL, NULL );
+}
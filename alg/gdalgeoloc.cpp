@@ -45,12 +45,269 @@ CPLXMLNode *GDALSerializeGeoLocTransformer( void *pTransformArg );
 void *GDALDeserializeGeoLocTransformer( CPLXMLNode *psTree );
 CPL_C_END
 
+/************************************************************************/
+/* ==================================================================== */
+/*                           GeoLocTileCache                            */
+/* ==================================================================== */
+/*                                                                      */
+/*      Fixed capacity LRU cache of square tiles of a 2D array.  It is  */
+/*      used in tiled mode for the geolocation arrays (read-only tiles  */
+/*      loaded from the X/Y bands) and for the backmap (read-write      */
+/*      tiles spilled to a temporary file when evicted).                */
+/************************************************************************/
+
+typedef struct _GeoLocTileCache GeoLocTileCache;
+
+typedef int (*GeoLocTileLoadFunc)( void *pUserData, int nTileX, int nTileY,
+                                   GByte *pabyTile );
+
+struct _GeoLocTileCache
+{
+    int         nTileSize;
+    int         nTilesPerRow;
+    int         nTilesPerCol;
+    size_t      nTileBytes;
+
+    int         nMaxTiles;
+    int         nUsedSlots;
+    GByte      *pabyData;
+    int        *panSlotOfTile;     // -1 if the tile is not cached.
+    int        *panTileOfSlot;
+    GUIntBig   *panLastUse;
+    GByte      *pabyDirty;
+    GUIntBig    nUseCounter;
+
+    int         iLastTile;
+    int         iLastSlot;
+
+    GeoLocTileLoadFunc pfnLoad;
+    void       *pLoadUserData;
+
+    // Only for writable caches.
+    char       *pszSpillFilename;
+    VSILFILE   *fpSpill;
+    GByte      *pabySpilled;       // per tile: present in the spill file.
+};
+
+/************************************************************************/
+/*                       GeoLocTileCacheDestroy()                       */
+/************************************************************************/
+
+static void GeoLocTileCacheDestroy( GeoLocTileCache *psCache )
+
+{
+    if( psCache == NULL )
+        return;
+
+    if( psCache->fpSpill != NULL )
+    {
+        VSIFCloseL( psCache->fpSpill );
+        VSIUnlink( psCache->pszSpillFilename );
+    }
+    CPLFree( psCache->pszSpillFilename );
+    CPLFree( psCache->pabySpilled );
+    CPLFree( psCache->pabyData );
+    CPLFree( psCache->panSlotOfTile );
+    CPLFree( psCache->panTileOfSlot );
+    CPLFree( psCache->panLastUse );
+    CPLFree( psCache->pabyDirty );
+    CPLFree( psCache );
+}
+
+/************************************************************************/
+/*                       GeoLocTileCacheCreate()                        */
+/*                                                                      */
+/*      If pszSpillStem is not NULL, modified tiles are written to a    */
+/*      temporary file on eviction and read back from it on reload.     */
+/************************************************************************/
+
+static GeoLocTileCache *
+GeoLocTileCacheCreate( int nXSize, int nYSize, int nTileSize,
+                       size_t nTileBytes, int nMaxTiles,
+                       GeoLocTileLoadFunc pfnLoad, void *pLoadUserData,
+                       const char *pszSpillStem )
+
+{
+    GeoLocTileCache *psCache = (GeoLocTileCache *)
+        CPLCalloc( sizeof(GeoLocTileCache), 1 );
+
+    psCache->nTileSize = nTileSize;
+    psCache->nTilesPerRow = (nXSize + nTileSize - 1) / nTileSize;
+    psCache->nTilesPerCol = (nYSize + nTileSize - 1) / nTileSize;
+    psCache->nTileBytes = nTileBytes;
+    psCache->iLastTile = -1;
+    psCache->iLastSlot = -1;
+    psCache->pfnLoad = pfnLoad;
+    psCache->pLoadUserData = pLoadUserData;
+
+    int nTiles = psCache->nTilesPerRow * psCache->nTilesPerCol;
+    psCache->nMaxTiles = MIN(nMaxTiles, nTiles);
+
+    psCache->pabyData = (GByte *)
+        VSIMalloc2( psCache->nMaxTiles, nTileBytes );
+    psCache->panSlotOfTile = (int *) VSIMalloc2( nTiles, sizeof(int) );
+    psCache->panTileOfSlot = (int *)
+        VSIMalloc2( psCache->nMaxTiles, sizeof(int) );
+    psCache->panLastUse = (GUIntBig *)
+        VSICalloc( psCache->nMaxTiles, sizeof(GUIntBig) );
+    psCache->pabyDirty = (GByte *) VSICalloc( psCache->nMaxTiles, 1 );
+    if( pszSpillStem != NULL )
+        psCache->pabySpilled = (GByte *) VSICalloc( nTiles, 1 );
+
+    if( psCache->pabyData == NULL || psCache->panSlotOfTile == NULL
+        || psCache->panTileOfSlot == NULL || psCache->panLastUse == NULL
+        || psCache->pabyDirty == NULL
+        || (pszSpillStem != NULL && psCache->pabySpilled == NULL) )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "Unable to allocate %d tiles cache for geolocation "
+                  "array transformer.", psCache->nMaxTiles );
+        GeoLocTileCacheDestroy( psCache );
+        return NULL;
+    }
+
+    for( int i = 0; i < nTiles; i++ )
+        psCache->panSlotOfTile[i] = -1;
+
+    if( pszSpillStem != NULL )
+    {
+        psCache->pszSpillFilename =
+            CPLStrdup( CPLGenerateTempFilename( pszSpillStem ) );
+        psCache->fpSpill = VSIFOpenL( psCache->pszSpillFilename, "w+b" );
+        if( psCache->fpSpill == NULL )
+        {
+            CPLError( CE_Failure, CPLE_OpenFailed,
+                      "Cannot create temporary file %s",
+                      psCache->pszSpillFilename );
+            GeoLocTileCacheDestroy( psCache );
+            return NULL;
+        }
+    }
+
+    return psCache;
+}
+
+/************************************************************************/
+/*                       GeoLocTileCacheGetTile()                       */
+/*                                                                      */
+/*      Return the tile buffer, loading it (and evicting the least      */
+/*      recently used tile) if needed.  Returns NULL on I/O error.      */
+/************************************************************************/
+
+static GByte *GeoLocTileCacheGetTile( GeoLocTileCache *psCache,
+                                      int nTileX, int nTileY, int bForWrite )
+
+{
+    int iTile = nTileX + nTileY * psCache->nTilesPerRow;
+    int iSlot;
+
+    if( iTile == psCache->iLastTile )
+        iSlot = psCache->iLastSlot;
+    else
+    {
+        iSlot = psCache->panSlotOfTile[iTile];
+        if( iSlot < 0 )
+        {
+/* -------------------------------------------------------------------- */
+/*      Find a free slot, or evict the least recently used tile.        */
+/* -------------------------------------------------------------------- */
+            if( psCache->nUsedSlots < psCache->nMaxTiles )
+                iSlot = psCache->nUsedSlots++;
+            else
+            {
+                iSlot = 0;
+                for( int i = 1; i < psCache->nMaxTiles; i++ )
+                {
+                    if( psCache->panLastUse[i] < psCache->panLastUse[iSlot] )
+                        iSlot = i;
+                }
+
+                int iOldTile = psCache->panTileOfSlot[iSlot];
+                if( iOldTile >= 0 && psCache->pabyDirty[iSlot] )
+                {
+                    if( VSIFSeekL( psCache->fpSpill,
+                                   (vsi_l_offset)iOldTile
+                                   * psCache->nTileBytes, SEEK_SET ) != 0
+                        || VSIFWriteL( psCache->pabyData
+                                       + iSlot * psCache->nTileBytes, 1,
+                                       psCache->nTileBytes,
+                                       psCache->fpSpill )
+                           != psCache->nTileBytes )
+                    {
+                        CPLError( CE_Failure, CPLE_FileIO,
+                                  "Cannot write to temporary file %s",
+                                  psCache->pszSpillFilename );
+                        return NULL;
+                    }
+                    psCache->pabySpilled[iOldTile] = TRUE;
+                    psCache->pabyDirty[iSlot] = FALSE;
+                }
+                if( iOldTile >= 0 )
+                    psCache->panSlotOfTile[iOldTile] = -1;
+                if( psCache->iLastSlot == iSlot )
+                    psCache->iLastTile = -1;
+            }
+            psCache->panTileOfSlot[iSlot] = -1;
+
+/* -------------------------------------------------------------------- */
+/*      Load the requested tile.                                        */
+/* -------------------------------------------------------------------- */
+            GByte *pabyTile = psCache->pabyData + iSlot * psCache->nTileBytes;
+            int bOK;
+
+            if( psCache->pabySpilled != NULL && psCache->pabySpilled[iTile] )
+            {
+                bOK = VSIFSeekL( psCache->fpSpill,
+                                 (vsi_l_offset)iTile * psCache->nTileBytes,
+                                 SEEK_SET ) == 0
+                    && VSIFReadL( pabyTile, 1, psCache->nTileBytes,
+                                  psCache->fpSpill ) == psCache->nTileBytes;
+                if( !bOK )
+                    CPLError( CE_Failure, CPLE_FileIO,
+                              "Cannot read from temporary file %s",
+                              psCache->pszSpillFilename );
+            }
+            else
+                bOK = psCache->pfnLoad( psCache->pLoadUserData,
+                                        nTileX, nTileY, pabyTile );
+
+            // On failure, leave the slot unassigned so that it is
+            // reused first.
+            if( !bOK )
+            {
+                psCache->panLastUse[iSlot] = 0;
+                return NULL;
+            }
+
+            psCache->panTileOfSlot[iSlot] = iTile;
+            psCache->panSlotOfTile[iTile] = iSlot;
+        }
+
+        psCache->iLastTile = iTile;
+        psCache->iLastSlot = iSlot;
+    }
+
+    psCache->panLastUse[iSlot] = ++psCache->nUseCounter;
+    if( bForWrite )
+        psCache->pabyDirty[iSlot] = TRUE;
+
+    return psCache->pabyData + iSlot * psCache->nTileBytes;
+}
+
 /************************************************************************/
 /* ==================================================================== */
 /*			   GDALGeoLocTransformer                        */
 /* ==================================================================== */
 /************************************************************************/
 
+// Tile sizes used in tiled mode.
+#define GEOLOC_TILE_SIZE        256
+#define GEOLOC_MAX_TILES        64
+#define BACKMAP_TILE_SIZE       128
+
+// Number of hole filling iterations of the backmap.
+#define BACKMAP_MAX_ITER        3
+
 typedef struct {
 
     GDALTransformerInfo sTI;
@@ -67,13 +324,14 @@ typedef struct {
     float       *pafBackMapY;
 
     // geolocation bands.
-    
+
     GDALDatasetH     hDS_X;
     GDALRasterBandH  hBand_X;
     GDALDatasetH     hDS_Y;
     GDALRasterBandH  hBand_Y;
+    int              bRegularGrid;
 
-    // Located geolocation data. 
+    // Located geolocation data.
     int              nGeoLocXSize;
     int              nGeoLocYSize;
     double           *padfGeoLocX;
@@ -82,6 +340,13 @@ typedef struct {
     int              bHasNoData;
     double           dfNoDataX;
 
+    // Tiled mode: the geolocation arrays are read by tile on demand
+    // and the backmap lives in a tile cache spilled to disk, instead
+    // of padfGeoLocX/Y and pafBackMapX/Y.
+    int              bTiled;
+    GeoLocTileCache  *psGeoLocCache;
+    GeoLocTileCache  *psBackMapCache;
+
     // geolocation <-> base image mapping.
     double           dfPIXEL_OFFSET;
     double           dfPIXEL_STEP;
@@ -92,6 +357,224 @@ typedef struct {
 
 } GDALGeoLocTransformInfo;
 
+/************************************************************************/
+/*                         GeoLocUseTiledMode()                         */
+/*                                                                      */
+/*      The in-memory mode needs 16 bytes per geolocation pixel for     */
+/*      the arrays and about 12 for the backmap and its flags.  Switch  */
+/*      to the tiled mode when this would use more than a quarter of    */
+/*      the RAM, unless GDAL_GEOLOC_USE_TEMP_DATASETS is set.           */
+/************************************************************************/
+
+static int GeoLocUseTiledMode( int nXSize, int nYSize )
+
+{
+    const char *pszUseTemp =
+        CPLGetConfigOption( "GDAL_GEOLOC_USE_TEMP_DATASETS", NULL );
+    if( pszUseTemp != NULL )
+        return CSLTestBoolean( pszUseTemp );
+
+    GIntBig nUsableRAM = CPLGetUsablePhysicalRAM();
+    GIntBig nNeeded = (GIntBig)nXSize * nYSize * 28;
+
+    return nUsableRAM > 0 && nNeeded > nUsableRAM / 4;
+}
+
+/************************************************************************/
+/*                          GeoLocReadLine()                            */
+/*                                                                      */
+/*      Read one line of the geolocation arrays, expanding the          */
+/*      regular grid case.                                              */
+/************************************************************************/
+
+static int GeoLocReadLine( GDALGeoLocTransformInfo *psTransform,
+                           int iY, int nXOff, int nXSize,
+                           double *padfX, double *padfY )
+
+{
+    if( psTransform->bRegularGrid )
+    {
+        double dfY;
+
+        if( GDALRasterIO( psTransform->hBand_X, GF_Read,
+                          nXOff, 0, nXSize, 1,
+                          padfX, nXSize, 1, GDT_Float64, 0, 0 ) != CE_None
+            || GDALRasterIO( psTransform->hBand_Y, GF_Read,
+                             iY, 0, 1, 1,
+                             &dfY, 1, 1, GDT_Float64, 0, 0 ) != CE_None )
+            return FALSE;
+
+        for( int i = 0; i < nXSize; i++ )
+            padfY[i] = dfY;
+
+        return TRUE;
+    }
+
+    return GDALRasterIO( psTransform->hBand_X, GF_Read,
+                         nXOff, iY, nXSize, 1,
+                         padfX, nXSize, 1, GDT_Float64, 0, 0 ) == CE_None
+        && GDALRasterIO( psTransform->hBand_Y, GF_Read,
+                         nXOff, iY, nXSize, 1,
+                         padfY, nXSize, 1, GDT_Float64, 0, 0 ) == CE_None;
+}
+
+/************************************************************************/
+/*                        GeoLocLoadTileFunc()                          */
+/*                                                                      */
+/*      Geolocation tile layout: X values then Y values, each           */
+/*      GEOLOC_TILE_SIZE x GEOLOC_TILE_SIZE.                            */
+/************************************************************************/
+
+static int GeoLocLoadTileFunc( void *pUserData, int nTileX, int nTileY,
+                               GByte *pabyTile )
+
+{
+    GDALGeoLocTransformInfo *psTransform =
+        (GDALGeoLocTransformInfo *) pUserData;
+    const int nTileSize = GEOLOC_TILE_SIZE;
+    double *padfX = (double *) pabyTile;
+    double *padfY = padfX + nTileSize * nTileSize;
+
+    int nXOff = nTileX * nTileSize;
+    int nYOff = nTileY * nTileSize;
+    int nXSize = MIN(nTileSize, psTransform->nGeoLocXSize - nXOff);
+    int nYSize = MIN(nTileSize, psTransform->nGeoLocYSize - nYOff);
+
+    if( psTransform->bRegularGrid )
+    {
+        for( int iY = 0; iY < nYSize; iY++ )
+        {
+            if( !GeoLocReadLine( psTransform, nYOff + iY, nXOff, nXSize,
+                                 padfX + iY * nTileSize,
+                                 padfY + iY * nTileSize ) )
+                return FALSE;
+        }
+        return TRUE;
+    }
+
+    return GDALRasterIO( psTransform->hBand_X, GF_Read,
+                         nXOff, nYOff, nXSize, nYSize,
+                         padfX, nXSize, nYSize, GDT_Float64,
+                         sizeof(double), nTileSize * sizeof(double) )
+           == CE_None
+        && GDALRasterIO( psTransform->hBand_Y, GF_Read,
+                         nXOff, nYOff, nXSize, nYSize,
+                         padfY, nXSize, nYSize, GDT_Float64,
+                         sizeof(double), nTileSize * sizeof(double) )
+           == CE_None;
+}
+
+/************************************************************************/
+/*                       GeoLocGetGeoLocValue()                         */
+/************************************************************************/
+
+static int GeoLocGetGeoLocValue( GDALGeoLocTransformInfo *psTransform,
+                                 int iX, int iY,
+                                 double *pdfGeoX, double *pdfGeoY )
+
+{
+    if( !psTransform->bTiled )
+    {
+        int i = iX + iY * psTransform->nGeoLocXSize;
+        *pdfGeoX = psTransform->padfGeoLocX[i];
+        *pdfGeoY = psTransform->padfGeoLocY[i];
+        return TRUE;
+    }
+
+    const int nTileSize = GEOLOC_TILE_SIZE;
+    double *padfTile = (double *)
+        GeoLocTileCacheGetTile( psTransform->psGeoLocCache,
+                                iX / nTileSize, iY / nTileSize, FALSE );
+    if( padfTile == NULL )
+        return FALSE;
+
+    int i = (iX % nTileSize) + (iY % nTileSize) * nTileSize;
+    *pdfGeoX = padfTile[i];
+    *pdfGeoY = padfTile[i + nTileSize * nTileSize];
+    return TRUE;
+}
+
+/************************************************************************/
+/*                      GeoLocLoadBackMapTileFunc()                     */
+/*                                                                      */
+/*      Backmap tile layout: X values (float), Y values (float) and     */
+/*      the valid flags (byte), each BACKMAP_TILE_SIZE squared.         */
+/************************************************************************/
+
+static int GeoLocLoadBackMapTileFunc( CPL_UNUSED void *pUserData,
+                                      CPL_UNUSED int nTileX,
+                                      CPL_UNUSED int nTileY,
+                                      GByte *pabyTile )
+
+{
+    const int nPixels = BACKMAP_TILE_SIZE * BACKMAP_TILE_SIZE;
+    float *pafX = (float *) pabyTile;
+    float *pafY = pafX + nPixels;
+
+    for( int i = 0; i < nPixels; i++ )
+    {
+        pafX[i] = -1.0;
+        pafY[i] = -1.0;
+    }
+    memset( pafY + nPixels, 0, nPixels );
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                       GeoLocGetBackMapTile()                         */
+/************************************************************************/
+
+static int GeoLocGetBackMapTile( GDALGeoLocTransformInfo *psTransform,
+                                 int nTileX, int nTileY, int bForWrite,
+                                 float **ppafX, float **ppafY,
+                                 GByte **ppabyFlag )
+
+{
+    const int nPixels = BACKMAP_TILE_SIZE * BACKMAP_TILE_SIZE;
+    float *pafX = (float *)
+        GeoLocTileCacheGetTile( psTransform->psBackMapCache,
+                                nTileX, nTileY, bForWrite );
+    if( pafX == NULL )
+        return FALSE;
+
+    *ppafX = pafX;
+    *ppafY = pafX + nPixels;
+    if( ppabyFlag != NULL )
+        *ppabyFlag = (GByte *) (pafX + 2 * nPixels);
+    return TRUE;
+}
+
+/************************************************************************/
+/*                       GeoLocGetBackMapValue()                        */
+/************************************************************************/
+
+static int GeoLocGetBackMapValue( GDALGeoLocTransformInfo *psTransform,
+                                  int iBMX, int iBMY,
+                                  float *pfX, float *pfY )
+
+{
+    if( !psTransform->bTiled )
+    {
+        int iBM = iBMX + iBMY * psTransform->nBackMapWidth;
+        *pfX = psTransform->pafBackMapX[iBM];
+        *pfY = psTransform->pafBackMapY[iBM];
+        return TRUE;
+    }
+
+    const int nTileSize = BACKMAP_TILE_SIZE;
+    float *pafX, *pafY;
+    if( !GeoLocGetBackMapTile( psTransform, iBMX / nTileSize,
+                               iBMY / nTileSize, FALSE,
+                               &pafX, &pafY, NULL ) )
+        return FALSE;
+
+    int i = (iBMX % nTileSize) + (iBMY % nTileSize) * nTileSize;
+    *pfX = pafX[i];
+    *pfY = pafY[i];
+    return TRUE;
+}
+
 /************************************************************************/
 /*                         GeoLocLoadFullData()                         */
 /************************************************************************/
@@ -109,6 +592,7 @@ static int GeoLocLoadFullData( GDALGeoLocTransformInfo *psTransform )
     {
         nXSize = nXSize_XBand;
         nYSize = nXSize_YBand;
+        psTransform->bRegularGrid = TRUE;
     }
     else
     {
@@ -118,12 +602,32 @@ static int GeoLocLoadFullData( GDALGeoLocTransformInfo *psTransform )
 
     psTransform->nGeoLocXSize = nXSize;
     psTransform->nGeoLocYSize = nYSize;
-    
-    psTransform->padfGeoLocY = (double *) 
+
+    psTransform->dfNoDataX = GDALGetRasterNoDataValue( psTransform->hBand_X,
+                                                       &(psTransform->bHasNoData) );
+
+/* -------------------------------------------------------------------- */
+/*      In tiled mode, the arrays are read on demand.                   */
+/* -------------------------------------------------------------------- */
+    psTransform->bTiled = GeoLocUseTiledMode( nXSize, nYSize );
+    if( psTransform->bTiled )
+    {
+        CPLDebug( "GEOLOC", "Using tiled mode for %dx%d geolocation arrays",
+                  nXSize, nYSize );
+        psTransform->psGeoLocCache =
+            GeoLocTileCacheCreate( nXSize, nYSize, GEOLOC_TILE_SIZE,
+                                   2 * sizeof(double)
+                                   * GEOLOC_TILE_SIZE * GEOLOC_TILE_SIZE,
+                                   GEOLOC_MAX_TILES,
+                                   GeoLocLoadTileFunc, psTransform, NULL );
+        return psTransform->psGeoLocCache != NULL;
+    }
+
+    psTransform->padfGeoLocY = (double *)
         VSIMalloc3(sizeof(double), nXSize, nYSize);
-    psTransform->padfGeoLocX = (double *) 
+    psTransform->padfGeoLocX = (double *)
         VSIMalloc3(sizeof(double), nXSize, nYSize);
-    
+
     if( psTransform->padfGeoLocX == NULL ||
         psTransform->padfGeoLocY == NULL )
     {
@@ -132,7 +636,7 @@ static int GeoLocLoadFullData( GDALGeoLocTransformInfo *psTransform )
         return FALSE;
     }
 
-    if (nYSize_XBand == 1 && nYSize_YBand == 1)
+    if (psTransform->bRegularGrid)
     {
         /* Case of regular grid */
         /* The XBAND contains the x coordinates for all lines */
@@ -151,9 +655,9 @@ static int GeoLocLoadFullData( GDALGeoLocTransformInfo *psTransform )
 
         CPLErr eErr = CE_None;
 
-        eErr = GDALRasterIO( psTransform->hBand_X, GF_Read, 
+        eErr = GDALRasterIO( psTransform->hBand_X, GF_Read,
                              0, 0, nXSize, 1,
-                             padfTempX, nXSize, 1, 
+                             padfTempX, nXSize, 1,
                              GDT_Float64, 0, 0 );
 
         int i,j;
@@ -166,9 +670,9 @@ static int GeoLocLoadFullData( GDALGeoLocTransformInfo *psTransform )
 
         if (eErr == CE_None)
         {
-            eErr = GDALRasterIO( psTransform->hBand_Y, GF_Read, 
+            eErr = GDALRasterIO( psTransform->hBand_Y, GF_Read,
                                 0, 0, nYSize, 1,
-                                padfTempY, nYSize, 1, 
+                                padfTempY, nYSize, 1,
                                 GDT_Float64, 0, 0 );
 
             for(j=0;j<nYSize;j++)
@@ -188,23 +692,267 @@ static int GeoLocLoadFullData( GDALGeoLocTransformInfo *psTransform )
     }
     else
     {
-        if( GDALRasterIO( psTransform->hBand_X, GF_Read, 
+        if( GDALRasterIO( psTransform->hBand_X, GF_Read,
                         0, 0, nXSize, nYSize,
-                        psTransform->padfGeoLocX, nXSize, nYSize, 
-                        GDT_Float64, 0, 0 ) != CE_None 
-            || GDALRasterIO( psTransform->hBand_Y, GF_Read, 
+                        psTransform->padfGeoLocX, nXSize, nYSize,
+                        GDT_Float64, 0, 0 ) != CE_None
+            || GDALRasterIO( psTransform->hBand_Y, GF_Read,
                             0, 0, nXSize, nYSize,
-                            psTransform->padfGeoLocY, nXSize, nYSize, 
+                            psTransform->padfGeoLocY, nXSize, nYSize,
                             GDT_Float64, 0, 0 ) != CE_None )
             return FALSE;
     }
 
-    psTransform->dfNoDataX = GDALGetRasterNoDataValue( psTransform->hBand_X, 
-                                                       &(psTransform->bHasNoData) );
-
     return TRUE;
 }
 
+/************************************************************************/
+/*                        GeoLocFillHolesWindow()                       */
+/*                                                                      */
+/*      One hole filling iteration over the [nXOff,nXOff+nXSize) x      */
+/*      [nYOff,nYOff+nYSize) window of a backmap buffer of              */
+/*      nBufXSize x nBufYSize pixels.  Only neighbours flagged above    */
+/*      nMarkedAsGood are used, so pixels filled during this iteration  */
+/*      do not contribute before the next one, and the result does      */
+/*      not depend on the order in which windows are processed.        */
+/*      Returns the number of pixels that were already set.             */
+/************************************************************************/
+
+static int GeoLocFillHolesWindow( float *pafBackMapX, float *pafBackMapY,
+                                  GByte *pabyValidFlag,
+                                  int nBufXSize, int nBufYSize,
+                                  int nXOff, int nYOff,
+                                  int nXSize, int nYSize,
+                                  int nMarkedAsGood )
+
+{
+    int nNumValid = 0;
+    int iBMX, iBMY;
+    const int nBMXSize = nBufXSize;
+    const int nBMYSize = nBufYSize;
+
+    for( iBMY = nYOff; iBMY < nYOff + nYSize; iBMY++ )
+    {
+        for( iBMX = nXOff; iBMX < nXOff + nXSize; iBMX++ )
+        {
+            // if this point is already set, ignore it.
+            if( pabyValidFlag[iBMX + iBMY*nBMXSize] )
+            {
+                nNumValid++;
+                continue;
+            }
+
+            int nCount = 0;
+            double dfXSum = 0.0, dfYSum = 0.0;
+
+            // left?
+            if( iBMX > 0 &&
+                pabyValidFlag[iBMX-1+iBMY*nBMXSize] > nMarkedAsGood )
+            {
+                dfXSum += pafBackMapX[iBMX-1+iBMY*nBMXSize];
+                dfYSum += pafBackMapY[iBMX-1+iBMY*nBMXSize];
+                nCount++;
+            }
+            // right?
+            if( iBMX + 1 < nBMXSize &&
+                pabyValidFlag[iBMX+1+iBMY*nBMXSize] > nMarkedAsGood )
+            {
+                dfXSum += pafBackMapX[iBMX+1+iBMY*nBMXSize];
+                dfYSum += pafBackMapY[iBMX+1+iBMY*nBMXSize];
+                nCount++;
+            }
+            // top?
+            if( iBMY > 0 &&
+                pabyValidFlag[iBMX+(iBMY-1)*nBMXSize] > nMarkedAsGood )
+            {
+                dfXSum += pafBackMapX[iBMX+(iBMY-1)*nBMXSize];
+                dfYSum += pafBackMapY[iBMX+(iBMY-1)*nBMXSize];
+                nCount++;
+            }
+            // bottom?
+            if( iBMY + 1 < nBMYSize &&
+                pabyValidFlag[iBMX+(iBMY+1)*nBMXSize] > nMarkedAsGood )
+            {
+                dfXSum += pafBackMapX[iBMX+(iBMY+1)*nBMXSize];
+                dfYSum += pafBackMapY[iBMX+(iBMY+1)*nBMXSize];
+                nCount++;
+            }
+            // top-left?
+            if( iBMX > 0 && iBMY > 0 &&
+                pabyValidFlag[iBMX-1+(iBMY-1)*nBMXSize] > nMarkedAsGood )
+            {
+                dfXSum += pafBackMapX[iBMX-1+(iBMY-1)*nBMXSize];
+                dfYSum += pafBackMapY[iBMX-1+(iBMY-1)*nBMXSize];
+                nCount++;
+            }
+            // top-right?
+            if( iBMX + 1 < nBMXSize && iBMY > 0 &&
+                pabyValidFlag[iBMX+1+(iBMY-1)*nBMXSize] > nMarkedAsGood )
+            {
+                dfXSum += pafBackMapX[iBMX+1+(iBMY-1)*nBMXSize];
+                dfYSum += pafBackMapY[iBMX+1+(iBMY-1)*nBMXSize];
+                nCount++;
+            }
+            // bottom-left?
+            if( iBMX > 0 && iBMY + 1 < nBMYSize &&
+                pabyValidFlag[iBMX-1+(iBMY+1)*nBMXSize] > nMarkedAsGood )
+            {
+                dfXSum += pafBackMapX[iBMX-1+(iBMY+1)*nBMXSize];
+                dfYSum += pafBackMapY[iBMX-1+(iBMY+1)*nBMXSize];
+                nCount++;
+            }
+            // bottom-right?
+            if( iBMX + 1 < nBMXSize && iBMY + 1 < nBMYSize &&
+                pabyValidFlag[iBMX+1+(iBMY+1)*nBMXSize] > nMarkedAsGood )
+            {
+                dfXSum += pafBackMapX[iBMX+1+(iBMY+1)*nBMXSize];
+                dfYSum += pafBackMapY[iBMX+1+(iBMY+1)*nBMXSize];
+                nCount++;
+            }
+
+            if( nCount > 0 )
+            {
+                pafBackMapX[iBMX + iBMY * nBMXSize] = (float)(dfXSum/nCount);
+                pafBackMapY[iBMX + iBMY * nBMXSize] = (float)(dfYSum/nCount);
+                // genuinely valid points will have value iMaxIter+1
+                // On each iteration mark newly valid points with a
+                // descending value so that it will not be used on the
+                // current iteration only on subsequent ones.
+                pabyValidFlag[iBMX+iBMY*nBMXSize] = (GByte) nMarkedAsGood;
+            }
+        }
+    }
+
+    return nNumValid;
+}
+
+/************************************************************************/
+/*                     GeoLocFillHolesTiled()                           */
+/*                                                                      */
+/*      Run one hole filling iteration over the backmap tile cache.     */
+/*      Each tile is copied with a one pixel border from its            */
+/*      neighbours into a work buffer, processed, and written back.     */
+/*      Returns -1 on error, or the number of already set pixels.       */
+/************************************************************************/
+
+static GIntBig GeoLocFillHolesTiled( GDALGeoLocTransformInfo *psTransform,
+                                     int nMarkedAsGood )
+
+{
+    const int nTileSize = BACKMAP_TILE_SIZE;
+    const int nBufSize = nTileSize + 2;
+    const int nBMXSize = psTransform->nBackMapWidth;
+    const int nBMYSize = psTransform->nBackMapHeight;
+    GeoLocTileCache *psCache = psTransform->psBackMapCache;
+    GIntBig nNumValid = 0;
+
+    float *pafBufX = (float *) VSIMalloc3( nBufSize, nBufSize, sizeof(float) );
+    float *pafBufY = (float *) VSIMalloc3( nBufSize, nBufSize, sizeof(float) );
+    GByte *pabyBufFlag = (GByte *) VSIMalloc2( nBufSize, nBufSize );
+    if( pafBufX == NULL || pafBufY == NULL || pabyBufFlag == NULL )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "GeoLocFillHolesTiled : Out of memory" );
+        nNumValid = -1;
+    }
+
+    for( int nTileY = 0;
+         nNumValid >= 0 && nTileY < psCache->nTilesPerCol; nTileY++ )
+    {
+        for( int nTileX = 0;
+             nNumValid >= 0 && nTileX < psCache->nTilesPerRow; nTileX++ )
+        {
+            int nXOff = nTileX * nTileSize;
+            int nYOff = nTileY * nTileSize;
+            int nXSize = MIN(nTileSize, nBMXSize - nXOff);
+            int nYSize = MIN(nTileSize, nBMYSize - nYOff);
+            int iX, iY;
+
+/* -------------------------------------------------------------------- */
+/*      Gather the tile and its border.  Pixels outside of the          */
+/*      backmap get a zero flag so they are never used.                 */
+/* -------------------------------------------------------------------- */
+            for( iY = -1; nNumValid >= 0 && iY <= nYSize; iY++ )
+            {
+                int iBMY = nYOff + iY;
+                for( iX = -1; iX <= nXSize; iX++ )
+                {
+                    // Interior of the tile is copied below.
+                    if( iY >= 0 && iY < nYSize && iX == 0 )
+                        iX = nXSize;
+
+                    int iBMX = nXOff + iX;
+                    int iBuf = (iX + 1) + (iY + 1) * nBufSize;
+                    if( iBMX < 0 || iBMY < 0
+                        || iBMX >= nBMXSize || iBMY >= nBMYSize )
+                    {
+                        pabyBufFlag[iBuf] = 0;
+                        continue;
+                    }
+
+                    float *pafX, *pafY;
+                    GByte *pabyFlag;
+                    if( !GeoLocGetBackMapTile( psTransform,
+                                               iBMX / nTileSize,
+                                               iBMY / nTileSize, FALSE,
+                                               &pafX, &pafY, &pabyFlag ) )
+                    {
+                        nNumValid = -1;
+                        break;
+                    }
+                    int i = (iBMX % nTileSize) + (iBMY % nTileSize) * nTileSize;
+                    pafBufX[iBuf] = pafX[i];
+                    pafBufY[iBuf] = pafY[i];
+                    pabyBufFlag[iBuf] = pabyFlag[i];
+                }
+            }
+
+            float *pafX, *pafY;
+            GByte *pabyFlag;
+            if( nNumValid < 0
+                || !GeoLocGetBackMapTile( psTransform, nTileX, nTileY, TRUE,
+                                          &pafX, &pafY, &pabyFlag ) )
+            {
+                nNumValid = -1;
+                break;
+            }
+
+            for( iY = 0; iY < nYSize; iY++ )
+            {
+                int iBuf = 1 + (iY + 1) * nBufSize;
+                memcpy( pafBufX + iBuf, pafX + iY * nTileSize,
+                        nXSize * sizeof(float) );
+                memcpy( pafBufY + iBuf, pafY + iY * nTileSize,
+                        nXSize * sizeof(float) );
+                memcpy( pabyBufFlag + iBuf, pabyFlag + iY * nTileSize,
+                        nXSize );
+            }
+
+            nNumValid += GeoLocFillHolesWindow( pafBufX, pafBufY, pabyBufFlag,
+                                                nBufSize, nBufSize,
+                                                1, 1, nXSize, nYSize,
+                                                nMarkedAsGood );
+
+            for( iY = 0; iY < nYSize; iY++ )
+            {
+                int iBuf = 1 + (iY + 1) * nBufSize;
+                memcpy( pafX + iY * nTileSize, pafBufX + iBuf,
+                        nXSize * sizeof(float) );
+                memcpy( pafY + iY * nTileSize, pafBufY + iBuf,
+                        nXSize * sizeof(float) );
+                memcpy( pabyFlag + iY * nTileSize, pabyBufFlag + iBuf,
+                        nXSize );
+            }
+        }
+    }
+
+    CPLFree( pafBufX );
+    CPLFree( pafBufY );
+    CPLFree( pabyBufFlag );
+
+    return nNumValid;
+}
+
 /************************************************************************/
 /*                       GeoLocGenerateBackMap()                        */
 /************************************************************************/
@@ -214,7 +962,25 @@ static int GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
 {
     int nXSize = psTransform->nGeoLocXSize;
     int nYSize = psTransform->nGeoLocYSize;
-    int nMaxIter = 3;
+    int nMaxIter = BACKMAP_MAX_ITER;
+    int bTiled = psTransform->bTiled;
+
+    // Line buffers for the tiled mode.
+    double *padfLineX = NULL;
+    double *padfLineY = NULL;
+    if( bTiled )
+    {
+        padfLineX = (double *) VSIMalloc2( nXSize, sizeof(double) );
+        padfLineY = (double *) VSIMalloc2( nXSize, sizeof(double) );
+        if( padfLineX == NULL || padfLineY == NULL )
+        {
+            CPLError( CE_Failure, CPLE_OutOfMemory,
+                      "GeoLocGenerateBackMap : Out of memory" );
+            CPLFree( padfLineX );
+            CPLFree( padfLineY );
+            return FALSE;
+        }
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Scan forward map for lat/long extents.                          */
@@ -222,23 +988,46 @@ static int GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
     double dfMinX=0, dfMaxX=0, dfMinY=0, dfMaxY=0;
     int i, bInit = FALSE;
 
-    for( i = nXSize * nYSize - 1; i >= 0; i-- )
+    for( int iY = nYSize - 1; iY >= 0; iY-- )
     {
-        if( !psTransform->bHasNoData ||
-            psTransform->padfGeoLocX[i] != psTransform->dfNoDataX )
+        double *padfX, *padfY;
+
+        if( bTiled )
         {
-            if( bInit )
+            if( !GeoLocReadLine( psTransform, iY, 0, nXSize,
+                                 padfLineX, padfLineY ) )
             {
-                dfMinX = MIN(dfMinX,psTransform->padfGeoLocX[i]);
-                dfMaxX = MAX(dfMaxX,psTransform->padfGeoLocX[i]);
-                dfMinY = MIN(dfMinY,psTransform->padfGeoLocY[i]);
-                dfMaxY = MAX(dfMaxY,psTransform->padfGeoLocY[i]);
+                CPLFree( padfLineX );
+                CPLFree( padfLineY );
+                return FALSE;
             }
-            else
+            padfX = padfLineX;
+            padfY = padfLineY;
+        }
+        else
+        {
+            padfX = psTransform->padfGeoLocX + iY * nXSize;
+            padfY = psTransform->padfGeoLocY + iY * nXSize;
+        }
+
+        for( i = nXSize - 1; i >= 0; i-- )
+        {
+            if( !psTransform->bHasNoData ||
+                padfX[i] != psTransform->dfNoDataX )
             {
-                bInit = TRUE;
-                dfMinX = dfMaxX = psTransform->padfGeoLocX[i];
-                dfMinY = dfMaxY = psTransform->padfGeoLocY[i];
+                if( bInit )
+                {
+                    dfMinX = MIN(dfMinX,padfX[i]);
+                    dfMaxX = MAX(dfMaxX,padfX[i]);
+                    dfMinY = MIN(dfMinY,padfY[i]);
+                    dfMaxY = MAX(dfMaxY,padfY[i]);
+                }
+                else
+                {
+                    bInit = TRUE;
+                    dfMinX = dfMaxX = padfX[i];
+                    dfMinY = dfMaxY = padfY[i];
+                }
             }
         }
     }
@@ -250,19 +1039,21 @@ static int GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
 /*      is approximate.                                                 */
 /* -------------------------------------------------------------------- */
     double dfTargetPixels = (nXSize * nYSize * 1.3);
-    double dfPixelSize = sqrt((dfMaxX - dfMinX) * (dfMaxY - dfMinY) 
+    double dfPixelSize = sqrt((dfMaxX - dfMinX) * (dfMaxY - dfMinY)
                               / dfTargetPixels);
     int nBMXSize, nBMYSize;
 
-    nBMYSize = psTransform->nBackMapHeight = 
+    nBMYSize = psTransform->nBackMapHeight =
         (int) ((dfMaxY - dfMinY) / dfPixelSize + 1);
-    nBMXSize= psTransform->nBackMapWidth =  
+    nBMXSize= psTransform->nBackMapWidth =
         (int) ((dfMaxX - dfMinX) / dfPixelSize + 1);
 
     if (nBMXSize > INT_MAX / nBMYSize)
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Int overflow : %d x %d",
                  nBMXSize, nBMYSize);
+        CPLFree( padfLineX );
+        CPLFree( padfLineY );
         return FALSE;
     }
 
@@ -278,32 +1069,57 @@ static int GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
 
 /* -------------------------------------------------------------------- */
 /*      Allocate backmap, and initialize to nodata value (-1.0).        */
+/*      In tiled mode, tiles are initialized on first access, and       */
+/*      enough of them are kept to hold the backmap footprint of a      */
+/*      few geolocation lines.                                          */
 /* -------------------------------------------------------------------- */
-    GByte  *pabyValidFlag;
-
-    pabyValidFlag = (GByte *) 
-        VSICalloc(nBMXSize, nBMYSize); 
-
-    psTransform->pafBackMapX = (float *) 
-        VSIMalloc3(nBMXSize, nBMYSize, sizeof(float)); 
-    psTransform->pafBackMapY = (float *) 
-        VSIMalloc3(nBMXSize, nBMYSize, sizeof(float)); 
+    GByte  *pabyValidFlag = NULL;
 
-    if( pabyValidFlag == NULL ||
-        psTransform->pafBackMapX == NULL ||
-        psTransform->pafBackMapY == NULL )
+    if( bTiled )
     {
-        CPLError( CE_Failure, CPLE_OutOfMemory, 
-                  "Unable to allocate %dx%d back-map for geolocation array transformer.",
-                  nBMXSize, nBMYSize );
-        CPLFree( pabyValidFlag );
-        return FALSE;
+        int nTilesPerRow = (nBMXSize + BACKMAP_TILE_SIZE - 1) / BACKMAP_TILE_SIZE;
+        int nTilesPerCol = (nBMYSize + BACKMAP_TILE_SIZE - 1) / BACKMAP_TILE_SIZE;
+
+        psTransform->psBackMapCache =
+            GeoLocTileCacheCreate( nBMXSize, nBMYSize, BACKMAP_TILE_SIZE,
+                                   (2 * sizeof(float) + 1)
+                                   * BACKMAP_TILE_SIZE * BACKMAP_TILE_SIZE,
+                                   MAX(64, 2 * (nTilesPerRow + nTilesPerCol) + 16),
+                                   GeoLocLoadBackMapTileFunc, NULL,
+                                   "geoloc_backmap" );
+        if( psTransform->psBackMapCache == NULL )
+        {
+            CPLFree( padfLineX );
+            CPLFree( padfLineY );
+            return FALSE;
+        }
     }
-
-    for( i = nBMXSize * nBMYSize - 1; i >= 0; i-- )
+    else
     {
-        psTransform->pafBackMapX[i] = -1.0;
-        psTransform->pafBackMapY[i] = -1.0;
+        pabyValidFlag = (GByte *)
+            VSICalloc(nBMXSize, nBMYSize);
+
+        psTransform->pafBackMapX = (float *)
+            VSIMalloc3(nBMXSize, nBMYSize, sizeof(float));
+        psTransform->pafBackMapY = (float *)
+            VSIMalloc3(nBMXSize, nBMYSize, sizeof(float));
+
+        if( pabyValidFlag == NULL ||
+            psTransform->pafBackMapX == NULL ||
+            psTransform->pafBackMapY == NULL )
+        {
+            CPLError( CE_Failure, CPLE_OutOfMemory,
+                      "Unable to allocate %dx%d back-map for geolocation array transformer.",
+                      nBMXSize, nBMYSize );
+            CPLFree( pabyValidFlag );
+            return FALSE;
+        }
+
+        for( i = nBMXSize * nBMYSize - 1; i >= 0; i-- )
+        {
+            psTransform->pafBackMapX[i] = -1.0;
+            psTransform->pafBackMapY[i] = -1.0;
+        }
     }
 
 /* -------------------------------------------------------------------- */
@@ -317,149 +1133,118 @@ static int GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
 
     for( iY = 0; iY < nYSize; iY++ )
     {
+        double *padfX, *padfY;
+
+        if( bTiled )
+        {
+            if( !GeoLocReadLine( psTransform, iY, 0, nXSize,
+                                 padfLineX, padfLineY ) )
+            {
+                CPLFree( padfLineX );
+                CPLFree( padfLineY );
+                return FALSE;
+            }
+            padfX = padfLineX;
+            padfY = padfLineY;
+        }
+        else
+        {
+            padfX = psTransform->padfGeoLocX + iY * nXSize;
+            padfY = psTransform->padfGeoLocY + iY * nXSize;
+        }
+
         for( iX = 0; iX < nXSize; iX++ )
         {
             if( psTransform->bHasNoData &&
-                psTransform->padfGeoLocX[iX + iY * nXSize] 
-                == psTransform->dfNoDataX )
+                padfX[iX] == psTransform->dfNoDataX )
                 continue;
 
-            i = iX + iY * nXSize;
-
-            iBMX = (int) ((psTransform->padfGeoLocX[i] - dfMinX) / dfPixelSize);
-            iBMY = (int) ((dfMaxY - psTransform->padfGeoLocY[i]) / dfPixelSize);
+            iBMX = (int) ((padfX[iX] - dfMinX) / dfPixelSize);
+            iBMY = (int) ((dfMaxY - padfY[iX]) / dfPixelSize);
 
             if( iBMX < 0 || iBMY < 0 || iBMX >= nBMXSize || iBMY >= nBMYSize )
                 continue;
 
-            psTransform->pafBackMapX[iBMX + iBMY * nBMXSize] = 
+            float *pafBMX, *pafBMY;
+            GByte *pabyFlag;
+
+            if( bTiled )
+            {
+                if( !GeoLocGetBackMapTile( psTransform,
+                                           iBMX / BACKMAP_TILE_SIZE,
+                                           iBMY / BACKMAP_TILE_SIZE, TRUE,
+                                           &pafBMX, &pafBMY, &pabyFlag ) )
+                {
+                    CPLFree( padfLineX );
+                    CPLFree( padfLineY );
+                    return FALSE;
+                }
+                i = (iBMX % BACKMAP_TILE_SIZE)
+                    + (iBMY % BACKMAP_TILE_SIZE) * BACKMAP_TILE_SIZE;
+            }
+            else
+            {
+                pafBMX = psTransform->pafBackMapX;
+                pafBMY = psTransform->pafBackMapY;
+                pabyFlag = pabyValidFlag;
+                i = iBMX + iBMY * nBMXSize;
+            }
+
+            pafBMX[i] =
                 (float)(iX * psTransform->dfPIXEL_STEP + psTransform->dfPIXEL_OFFSET);
-            psTransform->pafBackMapY[iBMX + iBMY * nBMXSize] = 
+            pafBMY[i] =
                 (float)(iY * psTransform->dfLINE_STEP + psTransform->dfLINE_OFFSET);
 
-            pabyValidFlag[iBMX + iBMY * nBMXSize] = (GByte) (nMaxIter+1);
-
+            pabyFlag[i] = (GByte) (nMaxIter+1);
         }
     }
 
+    CPLFree( padfLineX );
+    CPLFree( padfLineY );
+
 /* -------------------------------------------------------------------- */
 /*      Now, loop over the backmap trying to fill in holes with         */
 /*      nearby values.                                                  */
 /* -------------------------------------------------------------------- */
     int iIter;
-    int nNumValid;
 
     for( iIter = 0; iIter < nMaxIter; iIter++ )
     {
-        nNumValid = 0;
-        for( iBMY = 0; iBMY < nBMYSize; iBMY++ )
-        {
-            for( iBMX = 0; iBMX < nBMXSize; iBMX++ )
-            {
-                // if this point is already set, ignore it. 
-                if( pabyValidFlag[iBMX + iBMY*nBMXSize] )
-                {
-                    nNumValid++;
-                    continue;
-                }
+        GIntBig nNumValid;
+        int nMarkedAsGood = nMaxIter - iIter;
 
-                int nCount = 0;
-                double dfXSum = 0.0, dfYSum = 0.0;
-                int nMarkedAsGood = nMaxIter - iIter;
-
-                // left?
-                if( iBMX > 0 &&
-                    pabyValidFlag[iBMX-1+iBMY*nBMXSize] > nMarkedAsGood )
-                {
-                    dfXSum += psTransform->pafBackMapX[iBMX-1+iBMY*nBMXSize];
-                    dfYSum += psTransform->pafBackMapY[iBMX-1+iBMY*nBMXSize];
-                    nCount++;
-                }
-                // right?
-                if( iBMX + 1 < nBMXSize &&
-                    pabyValidFlag[iBMX+1+iBMY*nBMXSize] > nMarkedAsGood )
-                {
-                    dfXSum += psTransform->pafBackMapX[iBMX+1+iBMY*nBMXSize];
-                    dfYSum += psTransform->pafBackMapY[iBMX+1+iBMY*nBMXSize];
-                    nCount++;
-                }
-                // top?
-                if( iBMY > 0 &&
-                    pabyValidFlag[iBMX+(iBMY-1)*nBMXSize] > nMarkedAsGood )
-                {
-                    dfXSum += psTransform->pafBackMapX[iBMX+(iBMY-1)*nBMXSize];
-                    dfYSum += psTransform->pafBackMapY[iBMX+(iBMY-1)*nBMXSize];
-                    nCount++;
-                }
-                // bottom?
-                if( iBMY + 1 < nBMYSize &&
-                    pabyValidFlag[iBMX+(iBMY+1)*nBMXSize] > nMarkedAsGood )
-                {
-                    dfXSum += psTransform->pafBackMapX[iBMX+(iBMY+1)*nBMXSize];
-                    dfYSum += psTransform->pafBackMapY[iBMX+(iBMY+1)*nBMXSize];
-                    nCount++;
-                }
-                // top-left?
-                if( iBMX > 0 && iBMY > 0 &&
-                    pabyValidFlag[iBMX-1+(iBMY-1)*nBMXSize] > nMarkedAsGood )
-                {
-                    dfXSum += psTransform->pafBackMapX[iBMX-1+(iBMY-1)*nBMXSize];
-                    dfYSum += psTransform->pafBackMapY[iBMX-1+(iBMY-1)*nBMXSize];
-                    nCount++;
-                }
-                // top-right?
-                if( iBMX + 1 < nBMXSize && iBMY > 0 &&
-                    pabyValidFlag[iBMX+1+(iBMY-1)*nBMXSize] > nMarkedAsGood )
-                {
-                    dfXSum += psTransform->pafBackMapX[iBMX+1+(iBMY-1)*nBMXSize];
-                    dfYSum += psTransform->pafBackMapY[iBMX+1+(iBMY-1)*nBMXSize];
-                    nCount++;
-                }
-                // bottom-left?
-                if( iBMX > 0 && iBMY + 1 < nBMYSize &&
-                    pabyValidFlag[iBMX-1+(iBMY+1)*nBMXSize] > nMarkedAsGood )
-                {
-                    dfXSum += psTransform->pafBackMapX[iBMX-1+(iBMY+1)*nBMXSize];
-                    dfYSum += psTransform->pafBackMapY[iBMX-1+(iBMY+1)*nBMXSize];
-                    nCount++;
-                }
-                // bottom-right?
-                if( iBMX + 1 < nBMXSize && iBMY + 1 < nBMYSize &&
-                    pabyValidFlag[iBMX+1+(iBMY+1)*nBMXSize] > nMarkedAsGood )
-                {
-                    dfXSum += psTransform->pafBackMapX[iBMX+1+(iBMY+1)*nBMXSize];
-                    dfYSum += psTransform->pafBackMapY[iBMX+1+(iBMY+1)*nBMXSize];
-                    nCount++;
-                }
-
-                if( nCount > 0 )
-                {
-                    psTransform->pafBackMapX[iBMX + iBMY * nBMXSize] = (float)(dfXSum/nCount);
-                    psTransform->pafBackMapY[iBMX + iBMY * nBMXSize] = (float)(dfYSum/nCount);
-                    // genuinely valid points will have value iMaxIter+1
-                    // On each iteration mark newly valid points with a
-                    // descending value so that it will not be used on the
-                    // current iteration only on subsequent ones.
-                    pabyValidFlag[iBMX+iBMY*nBMXSize] = (GByte) (nMaxIter - iIter);
-                }
-            }
+        if( bTiled )
+        {
+            nNumValid = GeoLocFillHolesTiled( psTransform, nMarkedAsGood );
+            if( nNumValid < 0 )
+                return FALSE;
         }
-        if (nNumValid == nBMXSize * nBMYSize)
+        else
+        {
+            nNumValid = GeoLocFillHolesWindow( psTransform->pafBackMapX,
+                                               psTransform->pafBackMapY,
+                                               pabyValidFlag,
+                                               nBMXSize, nBMYSize,
+                                               0, 0, nBMXSize, nBMYSize,
+                                               nMarkedAsGood );
+        }
+
+        if (nNumValid == (GIntBig)nBMXSize * nBMYSize)
             break;
     }
 
 #ifdef notdef
     GDALDatasetH hBMDS = GDALCreate( GDALGetDriverByName( "GTiff" ),
-                                     "backmap.tif", nBMXSize, nBMYSize, 2, 
+                                     "backmap.tif", nBMXSize, nBMYSize, 2,
                                      GDT_Float32, NULL );
     GDALSetGeoTransform( hBMDS, psTransform->adfBackMapGeoTransform );
-    GDALRasterIO( GDALGetRasterBand(hBMDS,1), GF_Write, 
-                  0, 0, nBMXSize, nBMYSize, 
-                  psTransform->pafBackMapX, nBMXSize, nBMYSize, 
+    GDALRasterIO( GDALGetRasterBand(hBMDS,1), GF_Write,
+                  0, 0, nBMXSize, nBMYSize,
+                  psTransform->pafBackMapX, nBMXSize, nBMYSize,
                   GDT_Float32, 0, 0 );
-    GDALRasterIO( GDALGetRasterBand(hBMDS,2), GF_Write, 
-                  0, 0, nBMXSize, nBMYSize, 
-                  psTransform->pafBackMapY, nBMXSize, nBMYSize, 
+    GDALRasterIO( GDALGetRasterBand(hBMDS,2), GF_Write,
+                  0, 0, nBMXSize, nBMYSize,
+                  psTransform->pafBackMapY, nBMXSize, nBMYSize,
                   GDT_Float32, 0, 0 );
     GDALClose( hBMDS );
 #endif
@@ -750,6 +1535,13 @@ void* GDALCreateSimilarGeoLocTransformer( void *hTransformArg, double dfRatioX,
 
 /************************************************************************/
 /*                    GDALCreateGeoLocTransformer()                     */
+/*                                                                      */
+/*      Large geolocation arrays are not loaded in memory: they are     */
+/*      read by tile on demand, and the backmap is built into a tile    */
+/*      cache backed by a temporary file.  This is done automatically   */
+/*      when the in-memory mode would need more than a quarter of the   */
+/*      usable RAM, and can be forced on or off with the                */
+/*      GDAL_GEOLOC_USE_TEMP_DATASETS configuration option.             */
 /************************************************************************/
 
 void *GDALCreateGeoLocTransformer( GDALDatasetH hBaseDS, 
@@ -921,6 +1713,8 @@ void GDALDestroyGeoLocTransformer( void *pTransformAlg )
     CSLDestroy( psTransform->papszGeolocationInfo );
     CPLFree( psTransform->padfGeoLocX );
     CPLFree( psTransform->padfGeoLocY );
+    GeoLocTileCacheDestroy( psTransform->psGeoLocCache );
+    GeoLocTileCacheDestroy( psTransform->psBackMapCache );
              
     if( psTransform->hDS_X != NULL 
         && GDALDereferenceDataset( psTransform->hDS_X ) == 0 )
@@ -955,7 +1749,7 @@ int GDALGeoLocTransform( void *pTransformArg,
 /* -------------------------------------------------------------------- */
     if( !bDstToSrc )
     {
-        int i, nXSize = psTransform->nGeoLocXSize;
+        int i;
 
         for( i = 0; i < nPointCount; i++ )
         {
@@ -977,11 +1771,25 @@ int GDALGeoLocTransform( void *pTransformArg,
             iY = MAX(0,(int) dfGeoLocLine);
             iY = MIN(iY,psTransform->nGeoLocYSize-1);
 
-            double *padfGLX = psTransform->padfGeoLocX + iX + iY * nXSize;
-            double *padfGLY = psTransform->padfGeoLocY + iX + iY * nXSize;
-
-            if( psTransform->bHasNoData &&
-                padfGLX[0] == psTransform->dfNoDataX )
+            // Fetch the 2x2 cell: (iX,iY), (iX+1,iY), (iX,iY+1), (iX+1,iY+1)
+            double adfGLX[4] = { 0.0, 0.0, 0.0, 0.0 };
+            double adfGLY[4] = { 0.0, 0.0, 0.0, 0.0 };
+            int bOK = GeoLocGetGeoLocValue( psTransform, iX, iY,
+                                            &adfGLX[0], &adfGLY[0] );
+            if( bOK && iX + 1 < psTransform->nGeoLocXSize )
+                bOK = GeoLocGetGeoLocValue( psTransform, iX + 1, iY,
+                                            &adfGLX[1], &adfGLY[1] );
+            if( bOK && iY + 1 < psTransform->nGeoLocYSize )
+                bOK = GeoLocGetGeoLocValue( psTransform, iX, iY + 1,
+                                            &adfGLX[2], &adfGLY[2] );
+            if( bOK && iX + 1 < psTransform->nGeoLocXSize
+                && iY + 1 < psTransform->nGeoLocYSize )
+                bOK = GeoLocGetGeoLocValue( psTransform, iX + 1, iY + 1,
+                                            &adfGLX[3], &adfGLY[3] );
+
+            if( !bOK ||
+                (psTransform->bHasNoData &&
+                 adfGLX[0] == psTransform->dfNoDataX) )
             {
                 panSuccess[i] = FALSE;
                 padfX[i] = HUGE_VAL;
@@ -995,37 +1803,37 @@ int GDALGeoLocTransform( void *pTransformArg,
             if( iX + 1 < psTransform->nGeoLocXSize &&
                 iY + 1 < psTransform->nGeoLocYSize &&
                 (!psTransform->bHasNoData ||
-                    (padfGLX[1] != psTransform->dfNoDataX &&
-                     padfGLX[nXSize] != psTransform->dfNoDataX &&
-                     padfGLX[nXSize + 1] != psTransform->dfNoDataX) ))
+                    (adfGLX[1] != psTransform->dfNoDataX &&
+                     adfGLX[2] != psTransform->dfNoDataX &&
+                     adfGLX[3] != psTransform->dfNoDataX) ))
             {
-                padfX[i] = (1 - (dfGeoLocLine -iY)) * (padfGLX[0] + (dfGeoLocPixel-iX) * (padfGLX[1] - padfGLX[0]))
-                           + (dfGeoLocLine -iY) * (padfGLX[nXSize] + (dfGeoLocPixel-iX) * (padfGLX[nXSize+1] - padfGLX[nXSize]));
-                padfY[i] = (1 - (dfGeoLocLine -iY)) * (padfGLY[0] + (dfGeoLocPixel-iX) * (padfGLY[1] - padfGLY[0]))
-                           + (dfGeoLocLine -iY) * (padfGLY[nXSize] + (dfGeoLocPixel-iX) * (padfGLY[nXSize+1] - padfGLY[nXSize]));
+                padfX[i] = (1 - (dfGeoLocLine -iY)) * (adfGLX[0] + (dfGeoLocPixel-iX) * (adfGLX[1] - adfGLX[0]))
+                           + (dfGeoLocLine -iY) * (adfGLX[2] + (dfGeoLocPixel-iX) * (adfGLX[3] - adfGLX[2]));
+                padfY[i] = (1 - (dfGeoLocLine -iY)) * (adfGLY[0] + (dfGeoLocPixel-iX) * (adfGLY[1] - adfGLY[0]))
+                           + (dfGeoLocLine -iY) * (adfGLY[2] + (dfGeoLocPixel-iX) * (adfGLY[3] - adfGLY[2]));
             }
             else if( iX + 1 < psTransform->nGeoLocXSize &&
                      (!psTransform->bHasNoData ||
-                        padfGLX[1] != psTransform->dfNoDataX) )
+                        adfGLX[1] != psTransform->dfNoDataX) )
             {
-                padfX[i] = padfGLX[0] 
-                    + (dfGeoLocPixel-iX) * (padfGLX[1] - padfGLX[0]);
-                padfY[i] = padfGLY[0] 
-                    + (dfGeoLocPixel-iX) * (padfGLY[1] - padfGLY[0]);
+                padfX[i] = adfGLX[0] 
+                    + (dfGeoLocPixel-iX) * (adfGLX[1] - adfGLX[0]);
+                padfY[i] = adfGLY[0] 
+                    + (dfGeoLocPixel-iX) * (adfGLY[1] - adfGLY[0]);
             }
             else if( iY + 1 < psTransform->nGeoLocYSize &&
                      (!psTransform->bHasNoData ||
-                        padfGLX[nXSize] != psTransform->dfNoDataX) )
+                        adfGLX[2] != psTransform->dfNoDataX) )
             {
-                padfX[i] = padfGLX[0] 
-                    + (dfGeoLocLine -iY) * (padfGLX[nXSize] - padfGLX[0]);
-                padfY[i] = padfGLY[0] 
-                    + (dfGeoLocLine -iY) * (padfGLY[nXSize] - padfGLY[0]);
+                padfX[i] = adfGLX[0] 
+                    + (dfGeoLocLine -iY) * (adfGLX[2] - adfGLX[0]);
+                padfY[i] = adfGLY[0] 
+                    + (dfGeoLocLine -iY) * (adfGLY[2] - adfGLY[0]);
             }
             else
             {
-                padfX[i] = padfGLX[0];
-                padfY[i] = padfGLY[0];
+                padfX[i] = adfGLX[0];
+                padfY[i] = adfGLY[0];
             }
 
             panSuccess[i] = TRUE;
@@ -1058,12 +1866,26 @@ int GDALGeoLocTransform( void *pTransformArg,
             iBMX = (int) dfBMX;
             iBMY = (int) dfBMY;
 
-            int iBM = iBMX + iBMY * psTransform->nBackMapWidth;
-
-            if( iBMX < 0 || iBMY < 0 
-                || iBMX >= psTransform->nBackMapWidth
-                || iBMY >= psTransform->nBackMapHeight 
-                || psTransform->pafBackMapX[iBM] < 0 )
+            const int nBMW = psTransform->nBackMapWidth;
+            const int nBMH = psTransform->nBackMapHeight;
+
+            // Fetch the 2x2 cell, with -1 (invalid) outside of the backmap.
+            float afBMX[4] = { -1.0, -1.0, -1.0, -1.0 };
+            float afBMY[4] = { -1.0, -1.0, -1.0, -1.0 };
+            int bOK = iBMX >= 0 && iBMY >= 0 && iBMX < nBMW && iBMY < nBMH
+                && GeoLocGetBackMapValue( psTransform, iBMX, iBMY,
+                                          &afBMX[0], &afBMY[0] );
+            if( bOK && iBMX + 1 < nBMW )
+                bOK = GeoLocGetBackMapValue( psTransform, iBMX + 1, iBMY,
+                                             &afBMX[1], &afBMY[1] );
+            if( bOK && iBMY + 1 < nBMH )
+                bOK = GeoLocGetBackMapValue( psTransform, iBMX, iBMY + 1,
+                                             &afBMX[2], &afBMY[2] );
+            if( bOK && iBMX + 1 < nBMW && iBMY + 1 < nBMH )
+                bOK = GeoLocGetBackMapValue( psTransform, iBMX + 1, iBMY + 1,
+                                             &afBMX[3], &afBMY[3] );
+
+            if( !bOK || afBMX[0] < 0 )
             {
                 panSuccess[i] = FALSE;
                 padfX[i] = HUGE_VAL;
@@ -1071,41 +1893,35 @@ int GDALGeoLocTransform( void *pTransformArg,
                 continue;
             }
 
-            float* pafBMX = psTransform->pafBackMapX + iBM;
-            float* pafBMY = psTransform->pafBackMapY + iBM;
-
-            if( iBMX + 1 < psTransform->nBackMapWidth &&
-                iBMY + 1 < psTransform->nBackMapHeight &&
-                pafBMX[1] >=0 && pafBMX[psTransform->nBackMapWidth] >= 0 &&
-                pafBMX[psTransform->nBackMapWidth+1] >= 0)
+            if( iBMX + 1 < nBMW &&
+                iBMY + 1 < nBMH &&
+                afBMX[1] >=0 && afBMX[2] >= 0 && afBMX[3] >= 0)
             {
-                padfX[i] = (1-(dfBMY - iBMY)) * (pafBMX[0] + (dfBMX - iBMX) * (pafBMX[1] - pafBMX[0])) +
-                           (dfBMY - iBMY) * (pafBMX[psTransform->nBackMapWidth] +
-                                (dfBMX - iBMX) * (pafBMX[psTransform->nBackMapWidth+1] - pafBMX[psTransform->nBackMapWidth]));
-                padfY[i] = (1-(dfBMY - iBMY)) * (pafBMY[0] + (dfBMX - iBMX) * (pafBMY[1] - pafBMY[0])) +
-                           (dfBMY - iBMY) * (pafBMY[psTransform->nBackMapWidth] +
-                                (dfBMX - iBMX) * (pafBMY[psTransform->nBackMapWidth+1] - pafBMY[psTransform->nBackMapWidth]));
+                padfX[i] = (1-(dfBMY - iBMY)) * (afBMX[0] + (dfBMX - iBMX) * (afBMX[1] - afBMX[0])) +
+                           (dfBMY - iBMY) * (afBMX[2] + (dfBMX - iBMX) * (afBMX[3] - afBMX[2]));
+                padfY[i] = (1-(dfBMY - iBMY)) * (afBMY[0] + (dfBMX - iBMX) * (afBMY[1] - afBMY[0])) +
+                           (dfBMY - iBMY) * (afBMY[2] + (dfBMX - iBMX) * (afBMY[3] - afBMY[2]));
             }
-            else if( iBMX + 1 < psTransform->nBackMapWidth &&
-                     pafBMX[1] >=0)
+            else if( iBMX + 1 < nBMW &&
+                     afBMX[1] >=0)
             {
-                padfX[i] = pafBMX[0] +
-                            (dfBMX - iBMX) * (pafBMX[1] - pafBMX[0]);
-                padfY[i] = pafBMY[0] +
-                            (dfBMX - iBMX) * (pafBMY[1] - pafBMY[0]);
+                padfX[i] = afBMX[0] +
+                            (dfBMX - iBMX) * (afBMX[1] - afBMX[0]);
+                padfY[i] = afBMY[0] +
+                            (dfBMX - iBMX) * (afBMY[1] - afBMY[0]);
             }
-            else if( iBMY + 1 < psTransform->nBackMapHeight &&
-                     pafBMX[psTransform->nBackMapWidth] >= 0 )
+            else if( iBMY + 1 < nBMH &&
+                     afBMX[2] >= 0 )
             {
-                padfX[i] = pafBMX[0] +
-                            (dfBMY - iBMY) * (pafBMX[psTransform->nBackMapWidth] - pafBMX[0]);
-                padfY[i] = pafBMY[0] +
-                            (dfBMY - iBMY) * (pafBMY[psTransform->nBackMapWidth] - pafBMY[0]);
+                padfX[i] = afBMX[0] +
+                            (dfBMY - iBMY) * (afBMX[2] - afBMX[0]);
+                padfY[i] = afBMY[0] +
+                            (dfBMY - iBMY) * (afBMY[2] - afBMY[0]);
             }
             else
             {
-                padfX[i] = pafBMX[0];
-                padfY[i] = pafBMY[0];
+                padfX[i] = afBMX[0];
+                padfY[i] = afBMY[0];
             }
             panSuccess[i] = TRUE;
         }
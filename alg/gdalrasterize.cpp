@@ -36,6 +36,7 @@
 #include "ogr_api.h"
 #include "ogr_geometry.h"
 #include "ogr_spatialref.h"
+#include "cpl_multiproc.h"
 
 #ifdef OGR_ENABLED
 #include "ogrsf_frmts.h"
@@ -88,6 +89,30 @@ void gvBurnScanline( void *pCBData, int nY, int nXStart, int nXEnd,
             }
         }
     }
+    else if( psInfo->eType == GDT_Float32 )
+    {
+        for( iBand = 0; iBand < psInfo->nBands; iBand++ )
+        {
+            int	nPixels = nXEnd - nXStart + 1;
+            float    *pafInsert;
+            float    fBurnValue = (float)
+                ( psInfo->padfBurnValue[iBand] +
+                  ( (psInfo->eBurnValueSource == GBV_UserBurnValue)?
+                             0 : dfVariant ) );
+
+            pafInsert = ((float *) psInfo->pabyChunkBuf)
+                + iBand * psInfo->nXSize * psInfo->nYSize
+                + nY * psInfo->nXSize + nXStart;
+
+            if( psInfo->eMergeAlg == GRMA_Add ) {
+                while( nPixels-- > 0 )
+                    *(pafInsert++) += fBurnValue;
+            } else {
+                while( nPixels-- > 0 )
+                    *(pafInsert++) = fBurnValue;
+            }
+        }
+    }
     else if( psInfo->eType == GDT_Float64 )
     {
         for( iBand = 0; iBand < psInfo->nBands; iBand++ )
@@ -149,6 +174,25 @@ void gvBurnPoint( void *pCBData, int nY, int nX, double dfVariant )
             }
         }
     }
+    else if( psInfo->eType == GDT_Float32 )
+    {
+        for( iBand = 0; iBand < psInfo->nBands; iBand++ )
+        {
+            float    *pfInsert = ((float *) psInfo->pabyChunkBuf)
+                                + iBand * psInfo->nXSize * psInfo->nYSize
+                                + nY * psInfo->nXSize + nX;
+
+            if( psInfo->eMergeAlg == GRMA_Add ) {
+                *pfInsert += (float)( psInfo->padfBurnValue[iBand] +
+                         ( (psInfo->eBurnValueSource == GBV_UserBurnValue)?
+                            0 : dfVariant ) );
+            } else {
+                *pfInsert = (float)( psInfo->padfBurnValue[iBand] +
+                         ( (psInfo->eBurnValueSource == GBV_UserBurnValue)?
+                            0 : dfVariant ) );
+            }
+        }
+    }
     else if( psInfo->eType == GDT_Float64 )
     {
         for( iBand = 0; iBand < psInfo->nBands; iBand++ )
@@ -173,11 +217,128 @@ void gvBurnPoint( void *pCBData, int nY, int nX, double dfVariant )
     }
 }
 
+/************************************************************************/
+/*                           gvBurnCoverage()                           */
+/*                                                                      */
+/*      Burn a run of pixels weighted by the fraction of their area     */
+/*      covered by the polygon.                                         */
+/************************************************************************/
+
+void gvBurnCoverage( void *pCBData, int nY, int nXStart, int nXEnd,
+                     const double *padfCoverage, double dfVariant )
+
+{
+    GDALRasterizeInfo *psInfo = (GDALRasterizeInfo *) pCBData;
+    int iBand, nX;
+
+    CPLAssert( nY >= 0 && nY < psInfo->nYSize );
+    CPLAssert( nXStart >= 0 && nXEnd < psInfo->nXSize );
+
+    for( iBand = 0; iBand < psInfo->nBands; iBand++ )
+    {
+        double dfBurnValue = 
+            ( psInfo->padfBurnValue[iBand] +
+              ( (psInfo->eBurnValueSource == GBV_UserBurnValue)?
+                         0 : dfVariant ) );
+
+        if( psInfo->eType == GDT_Byte )
+        {
+            unsigned char *pabyInsert = psInfo->pabyChunkBuf 
+                + iBand * psInfo->nXSize * psInfo->nYSize
+                + nY * psInfo->nXSize;
+
+            for( nX = nXStart; nX <= nXEnd; nX++ )
+            {
+                unsigned char nValue = (unsigned char)
+                    (dfBurnValue * padfCoverage[nX - nXStart]);
+                if( psInfo->eMergeAlg == GRMA_Add )
+                    pabyInsert[nX] += nValue;
+                else
+                    pabyInsert[nX] = nValue;
+            }
+        }
+        else if( psInfo->eType == GDT_Float32 )
+        {
+            float *pafInsert = ((float *) psInfo->pabyChunkBuf)
+                + iBand * psInfo->nXSize * psInfo->nYSize
+                + nY * psInfo->nXSize;
+
+            for( nX = nXStart; nX <= nXEnd; nX++ )
+            {
+                float fValue = (float)
+                    (dfBurnValue * padfCoverage[nX - nXStart]);
+                if( psInfo->eMergeAlg == GRMA_Add )
+                    pafInsert[nX] += fValue;
+                else
+                    pafInsert[nX] = fValue;
+            }
+        }
+        else if( psInfo->eType == GDT_Float64 )
+        {
+            double *padfInsert = ((double *) psInfo->pabyChunkBuf)
+                + iBand * psInfo->nXSize * psInfo->nYSize
+                + nY * psInfo->nXSize;
+
+            for( nX = nXStart; nX <= nXEnd; nX++ )
+            {
+                double dfValue = dfBurnValue * padfCoverage[nX - nXStart];
+                if( psInfo->eMergeAlg == GRMA_Add )
+                    padfInsert[nX] += dfValue;
+                else
+                    padfInsert[nX] = dfValue;
+            }
+        }
+        else {
+            CPLAssert(0);
+        }
+    }
+}
+
+/************************************************************************/
+/*                      GDALOrientRingsForCoverage()                    */
+/*                                                                      */
+/*      The coverage computation needs outer and inner rings to be      */
+/*      oriented in opposite directions.                                */
+/************************************************************************/
+
+static void GDALOrientRingsForCoverage( OGRGeometry *poShape )
+
+{
+    OGRwkbGeometryType eFlatType = wkbFlatten(poShape->getGeometryType());
+    int i;
+
+    if( eFlatType == wkbPolygon )
+    {
+        OGRPolygon *poPolygon = (OGRPolygon *) poShape;
+        OGRLinearRing *poRing = poPolygon->getExteriorRing();
+
+        if( poRing == NULL )
+            return;
+        if( !poRing->isClockwise() )
+            poRing->reverseWindingOrder();
+
+        for( i = 0; i < poPolygon->getNumInteriorRings(); i++ )
+        {
+            poRing = poPolygon->getInteriorRing(i);
+            if( poRing->isClockwise() )
+                poRing->reverseWindingOrder();
+        }
+    }
+    else if( eFlatType == wkbMultiPolygon
+             || eFlatType == wkbGeometryCollection )
+    {
+        OGRGeometryCollection *poGC = (OGRGeometryCollection *) poShape;
+
+        for( i = 0; i < poGC->getNumGeometries(); i++ )
+            GDALOrientRingsForCoverage( poGC->getGeometryRef(i) );
+    }
+}
+
 /************************************************************************/
 /*                    GDALCollectRingsFromGeometry()                    */
 /************************************************************************/
 
-static void GDALCollectRingsFromGeometry(
+void GDALCollectRingsFromGeometry(
     OGRGeometry *poShape,
     std::vector<double> &aPointX, std::vector<double> &aPointY,
     std::vector<double> &aPointVariant,
@@ -303,24 +464,29 @@ static void GDALCollectRingsFromGeometry(
 }
 
 /************************************************************************/
-/*                       gv_rasterize_one_shape()                       */
+/*                    gv_rasterize_collected_shape()                    */
+/*                                                                      */
+/*      Burn a shape whose rings have already been collected and        */
+/*      transformed into pixel/line coordinates.  The Y coordinates     */
+/*      are shifted in place to account for the buffer offset.         */
 /************************************************************************/
+
 static void 
-gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nYOff,
-                        int nXSize, int nYSize,
-                        int nBands, GDALDataType eType, int bAllTouched,
-                        OGRGeometry *poShape, double *padfBurnValue, 
-                        GDALBurnValueSrc eBurnValueSrc,
-                        GDALRasterMergeAlg eMergeAlg,
-                        GDALTransformerFunc pfnTransformer, 
-                        void *pTransformArg )
+gv_rasterize_collected_shape( unsigned char *pabyChunkBuf, int nYOff,
+                              int nXSize, int nYSize,
+                              int nBands, GDALDataType eType, int bAllTouched,
+                              int bCoverage, OGRwkbGeometryType eFlatType,
+                              int nPartCount, int *panPartSize,
+                              int nPointCount,
+                              double *padfX, double *padfY,
+                              double *padfVariant,
+                              double *padfBurnValue, 
+                              GDALBurnValueSrc eBurnValueSrc,
+                              GDALRasterMergeAlg eMergeAlg )
 
 {
     GDALRasterizeInfo sInfo;
 
-    if (poShape == NULL)
-        return;
-
     sInfo.nXSize = nXSize;
     sInfo.nYSize = nYSize;
     sInfo.nBands = nBands;
@@ -330,60 +496,26 @@ gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nYOff,
     sInfo.eBurnValueSource = eBurnValueSrc;
     sInfo.eMergeAlg = eMergeAlg;
 
-/* -------------------------------------------------------------------- */
-/*      Transform polygon geometries into a set of rings and a part     */
-/*      size list.                                                      */
-/* -------------------------------------------------------------------- */
-    std::vector<double> aPointX;
-    std::vector<double> aPointY;
-    std::vector<double> aPointVariant;
-    std::vector<int> aPartSize;
-
-    GDALCollectRingsFromGeometry( poShape, aPointX, aPointY, aPointVariant,
-                                  aPartSize, eBurnValueSrc );
-
-/* -------------------------------------------------------------------- */
-/*      Transform points if needed.                                     */
-/* -------------------------------------------------------------------- */
-    if( pfnTransformer != NULL )
-    {
-        int *panSuccess = (int *) CPLCalloc(sizeof(int),aPointX.size());
-
-        // TODO: we need to add all appropriate error checking at some point.
-        pfnTransformer( pTransformArg, FALSE, aPointX.size(), 
-                        &(aPointX[0]), &(aPointY[0]), NULL, panSuccess );
-        CPLFree( panSuccess );
-    }
-
 /* -------------------------------------------------------------------- */
 /*      Shift to account for the buffer offset of this buffer.          */
 /* -------------------------------------------------------------------- */
-    unsigned int i;
+    int i;
 
-    for( i = 0; i < aPointY.size(); i++ )
-        aPointY[i] -= nYOff;
+    for( i = 0; i < nPointCount; i++ )
+        padfY[i] -= nYOff;
 
 /* -------------------------------------------------------------------- */
 /*      Perform the rasterization.                                      */
-/*      According to the C++ Standard/23.2.4, elements of a vector are  */
-/*      stored in continuous memory block.                              */
 /* -------------------------------------------------------------------- */
-
-    // TODO - mloskot: Check if vectors are empty, otherwise it may
-    // lead to undefined behavior by returning non-referencable pointer.
-    // if (!aPointX.empty())
-    //    /* fill polygon */
-    // else
-    //    /* How to report this problem? */
-    switch ( wkbFlatten(poShape->getGeometryType()) )
+    switch ( eFlatType )
     {
       case wkbPoint:
       case wkbMultiPoint:
         GDALdllImagePoint( sInfo.nXSize, nYSize, 
-                           aPartSize.size(), &(aPartSize[0]), 
-                           &(aPointX[0]), &(aPointY[0]), 
+                           nPartCount, panPartSize, 
+                           padfX, padfY, 
                            (eBurnValueSrc == GBV_UserBurnValue)?
-                           NULL : &(aPointVariant[0]),
+                           NULL : padfVariant,
                            gvBurnPoint, &sInfo );
         break;
       case wkbLineString:
@@ -391,28 +523,39 @@ gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nYOff,
       {
           if( bAllTouched )
               GDALdllImageLineAllTouched( sInfo.nXSize, nYSize, 
-                                          aPartSize.size(), &(aPartSize[0]), 
-                                          &(aPointX[0]), &(aPointY[0]), 
+                                          nPartCount, panPartSize, 
+                                          padfX, padfY, 
                                           (eBurnValueSrc == GBV_UserBurnValue)?
-                                          NULL : &(aPointVariant[0]),
+                                          NULL : padfVariant,
                                           gvBurnPoint, &sInfo );
           else
               GDALdllImageLine( sInfo.nXSize, nYSize, 
-                                aPartSize.size(), &(aPartSize[0]), 
-                                &(aPointX[0]), &(aPointY[0]), 
+                                nPartCount, panPartSize, 
+                                padfX, padfY, 
                                 (eBurnValueSrc == GBV_UserBurnValue)?
-                                NULL : &(aPointVariant[0]),
+                                NULL : padfVariant,
                                 gvBurnPoint, &sInfo );
       }
       break;
 
       default:
       {
+          if( bCoverage )
+          {
+              GDALdllImageFilledPolygonCoverage( sInfo.nXSize, nYSize, 
+                                                 nPartCount, panPartSize, 
+                                                 padfX, padfY, 
+                                                 (eBurnValueSrc == GBV_UserBurnValue)?
+                                                 NULL : padfVariant,
+                                                 gvBurnCoverage, &sInfo );
+              break;
+          }
+
           GDALdllImageFilledPolygon( sInfo.nXSize, nYSize, 
-                                     aPartSize.size(), &(aPartSize[0]), 
-                                     &(aPointX[0]), &(aPointY[0]), 
+                                     nPartCount, panPartSize, 
+                                     padfX, padfY, 
                                      (eBurnValueSrc == GBV_UserBurnValue)?
-                                     NULL : &(aPointVariant[0]),
+                                     NULL : padfVariant,
                                      gvBurnScanline, &sInfo );
           if( bAllTouched )
           {
@@ -423,25 +566,25 @@ gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nYOff,
               if(eBurnValueSrc == GBV_UserBurnValue)
               {
                   GDALdllImageLineAllTouched( sInfo.nXSize, nYSize, 
-                                              aPartSize.size(), &(aPartSize[0]), 
-                                              &(aPointX[0]), &(aPointY[0]), 
+                                              nPartCount, panPartSize, 
+                                              padfX, padfY, 
                                               NULL,
                                               gvBurnPoint, &sInfo );
               }
               else
               {
-                  unsigned int n;
-                  for ( i = 0, n = 0; i < aPartSize.size(); i++ )
+                  int n;
+                  for ( i = 0, n = 0; i < nPartCount; i++ )
                   {
                       int j;
-                      for ( j = 0; j < aPartSize[i]; j++ )
-                          aPointVariant[n++] = aPointVariant[0];
+                      for ( j = 0; j < panPartSize[i]; j++ )
+                          padfVariant[n++] = padfVariant[0];
                   }
 
                   GDALdllImageLineAllTouched( sInfo.nXSize, nYSize, 
-                                              aPartSize.size(), &(aPartSize[0]), 
-                                              &(aPointX[0]), &(aPointY[0]), 
-                                              &(aPointVariant[0]),
+                                              nPartCount, panPartSize, 
+                                              padfX, padfY, 
+                                              padfVariant,
                                               gvBurnPoint, &sInfo );
               }
           }
@@ -450,6 +593,81 @@ gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nYOff,
     }
 }
 
+/************************************************************************/
+/*                       gv_rasterize_one_shape()                       */
+/************************************************************************/
+static void 
+gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nYOff,
+                        int nXSize, int nYSize,
+                        int nBands, GDALDataType eType, int bAllTouched,
+                        int bCoverage,
+                        OGRGeometry *poShape, double *padfBurnValue, 
+                        GDALBurnValueSrc eBurnValueSrc,
+                        GDALRasterMergeAlg eMergeAlg,
+                        GDALTransformerFunc pfnTransformer, 
+                        void *pTransformArg )
+
+{
+    if (poShape == NULL)
+        return;
+
+/* -------------------------------------------------------------------- */
+/*      Transform polygon geometries into a set of rings and a part     */
+/*      size list.                                                      */
+/* -------------------------------------------------------------------- */
+    std::vector<double> aPointX;
+    std::vector<double> aPointY;
+    std::vector<double> aPointVariant;
+    std::vector<int> aPartSize;
+    OGRGeometry *poOrientedShape = NULL;
+
+    if( bCoverage )
+    {
+        poOrientedShape = poShape->clone();
+        GDALOrientRingsForCoverage( poOrientedShape );
+    }
+
+    GDALCollectRingsFromGeometry( poOrientedShape ? poOrientedShape : poShape,
+                                  aPointX, aPointY, aPointVariant,
+                                  aPartSize, eBurnValueSrc );
+    delete poOrientedShape;
+
+/* -------------------------------------------------------------------- */
+/*      Transform points if needed.                                     */
+/* -------------------------------------------------------------------- */
+    if( pfnTransformer != NULL )
+    {
+        int *panSuccess = (int *) CPLCalloc(sizeof(int),aPointX.size());
+
+        // TODO: we need to add all appropriate error checking at some point.
+        pfnTransformer( pTransformArg, FALSE, aPointX.size(), 
+                        &(aPointX[0]), &(aPointY[0]), NULL, panSuccess );
+        CPLFree( panSuccess );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Perform the rasterization.                                      */
+/*      According to the C++ Standard/23.2.4, elements of a vector are  */
+/*      stored in continuous memory block.                              */
+/* -------------------------------------------------------------------- */
+
+    // TODO - mloskot: Check if vectors are empty, otherwise it may
+    // lead to undefined behavior by returning non-referencable pointer.
+    // if (!aPointX.empty())
+    //    /* fill polygon */
+    // else
+    //    /* How to report this problem? */
+    gv_rasterize_collected_shape( pabyChunkBuf, nYOff, nXSize, nYSize,
+                                  nBands, eType, bAllTouched, bCoverage,
+                                  wkbFlatten(poShape->getGeometryType()),
+                                  aPartSize.size(), &(aPartSize[0]),
+                                  aPointY.size(),
+                                  &(aPointX[0]), &(aPointY[0]),
+                                  (eBurnValueSrc == GBV_UserBurnValue)?
+                                  NULL : &(aPointVariant[0]),
+                                  padfBurnValue, eBurnValueSrc, eMergeAlg );
+}
+
 /************************************************************************/
 /*                        GDALRasterizeOptions()                        */
 /*                                                                      */
@@ -459,11 +677,24 @@ gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nYOff,
 
 static CPLErr GDALRasterizeOptions(char **papszOptions, 
                                    int *pbAllTouched,
+                                   int *pbCoverage,
                                    GDALBurnValueSrc *peBurnValueSource, 
                                    GDALRasterMergeAlg *peMergeAlg) 
 {
     *pbAllTouched = CSLFetchBoolean( papszOptions, "ALL_TOUCHED", FALSE );
 
+/* -------------------------------------------------------------------- */
+/*      COVERAGE_FRACTION=YES/[NO]                                      */
+/* -------------------------------------------------------------------- */
+    *pbCoverage = CSLFetchBoolean( papszOptions, "COVERAGE_FRACTION", FALSE );
+    if( *pbCoverage && *pbAllTouched )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "ALL_TOUCHED and COVERAGE_FRACTION options are mutually "
+                  "exclusive." );
+        return CE_Failure;
+    }
+
     const char *pszOpt = CSLFetchNameValue( papszOptions, "BURN_VALUE_FROM" );
     *peBurnValueSource = GBV_UserBurnValue;
     if( pszOpt )
@@ -550,6 +781,14 @@ static CPLErr GDALRasterizeOptions(char **papszOptions,
  * dfBurnValue is burned. This is implemented only for points and lines for
  * now. The M value may be supported in the future.</dd>
  * <dt>"MERGE_ALG":</dt> <dd>May be REPLACE (the default) or ADD.  REPLACE results in overwriting of value, while ADD adds the new value to the existing raster, suitable for heatmaps for instance.</dd>
+ * <dt>"COVERAGE_FRACTION":</dt> <dd>(GDAL >= 2.0) May be set to TRUE to
+ * burn, for polygons, the burn value multiplied by the exact fraction of the
+ * area of each pixel covered by the polygon, instead of only burning the pixels
+ * whose center is inside the polygon. Points and lines are burnt as usual.
+ * Burning is then done in floating point, so the target band should be of
+ * Float32 or Float64 type. Cannot be combined with ALL_TOUCHED. With
+ * MERGE_ALG=ADD, the fractions of adjacent polygons sum up to their exact
+ * coverage. Defaults to FALSE.</dd>
  * </dl>
  * @param pfnProgress the progress function to report completion.
  * @param pProgressArg callback data for progress function.
@@ -594,10 +833,10 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
 /* -------------------------------------------------------------------- */
 /*      Options                                                         */
 /* -------------------------------------------------------------------- */
-    int bAllTouched;
+    int bAllTouched, bCoverage;
     GDALBurnValueSrc eBurnValueSource;
     GDALRasterMergeAlg eMergeAlg;
-    if( GDALRasterizeOptions(papszOptions, &bAllTouched, 
+    if( GDALRasterizeOptions(papszOptions, &bAllTouched, &bCoverage,
                              &eBurnValueSource, &eMergeAlg) == CE_Failure) {
         return CE_Failure;
     }
@@ -627,11 +866,17 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
 /*      size the less times we need to make a pass through all the      */
 /*      shapes.                                                         */
 /* -------------------------------------------------------------------- */
-    if( poBand->GetRasterDataType() == GDT_Byte )
+    if( poBand->GetRasterDataType() == GDT_Byte && !bCoverage )
         eType = GDT_Byte;
     else
         eType = GDT_Float64;
 
+    if( bCoverage && poBand->GetRasterDataType() != GDT_Float32 &&
+        poBand->GetRasterDataType() != GDT_Float64 )
+        CPLError( CE_Warning, CPLE_AppDefined,
+                  "COVERAGE_FRACTION=YES used with a non floating point "
+                  "band: coverage fractions will be truncated." );
+
     nScanlineBytes = nBandCount * poDS->GetRasterXSize()
         * (GDALGetDataTypeSize(eType)/8);
 
@@ -687,7 +932,7 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
         {
             gv_rasterize_one_shape( pabyChunkBuf, iY,
                                     poDS->GetRasterXSize(), nThisYChunkSize,
-                                    nBandCount, eType, bAllTouched,
+                                    nBandCount, eType, bAllTouched, bCoverage,
                                     (OGRGeometry *) pahGeometries[iShape],
                                     padfGeomBurnValue + iShape*nBandCount,
                                     eBurnValueSource, eMergeAlg,
@@ -720,6 +965,535 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
     return eErr;
 }
 
+#ifdef OGR_ENABLED
+
+/************************************************************************/
+/* ==================================================================== */
+/*                       GDALRasterizeShapeStore                        */
+/*                                                                      */
+/*      Keeps the shapes of the single pass mode of                     */
+/*      GDALRasterizeLayers(), already transformed into pixel/line      */
+/*      coordinates, in the order they were read.  Records are kept     */
+/*      in memory until a budget is exceeded, and then spilled to a     */
+/*      temporary file.  Each record is addressed by its offset in      */
+/*      the logical stream made of the spilled part followed by the     */
+/*      in-memory part.                                                 */
+/* ==================================================================== */
+/************************************************************************/
+
+typedef struct
+{
+    GInt32      nGeomType;      /* flattened OGRwkbGeometryType */
+    GInt32      nPartCount;
+    GInt32      nPointCount;
+    GInt32      bHasVariant;
+} GDALRasterizeShapeHeader;
+
+class GDALRasterizeShapeStore
+{
+    int                 nBandCount;
+    size_t              nMaxMemSize;
+
+    std::vector<GByte>  abyMem;
+
+    CPLString           osSpillFilename;
+    VSILFILE           *fpSpill;
+    vsi_l_offset        nSpilledSize;
+    CPLMutex           *hSpillMutex;
+
+    size_t              GetRecordSize( const GDALRasterizeShapeHeader* psHeader );
+    int                 Spill();
+
+  public:
+                        GDALRasterizeShapeStore( int nBandCount,
+                                                 size_t nMaxMemSize );
+                       ~GDALRasterizeShapeStore();
+
+    int                 AddShape( OGRwkbGeometryType eFlatType,
+                                  const std::vector<int>& aPartSize,
+                                  const std::vector<double>& aPointX,
+                                  const std::vector<double>& aPointY,
+                                  const std::vector<double>& aPointVariant,
+                                  const double* padfBurnValue,
+                                  vsi_l_offset* pnOffset );
+
+    int                 GetShape( vsi_l_offset nOffset,
+                                  std::vector<GByte>& abyRecord );
+};
+
+/************************************************************************/
+/*                      GDALRasterizeShapeStore()                       */
+/************************************************************************/
+
+GDALRasterizeShapeStore::GDALRasterizeShapeStore( int nBandCountIn,
+                                                  size_t nMaxMemSizeIn )
+{
+    nBandCount = nBandCountIn;
+    nMaxMemSize = nMaxMemSizeIn;
+    fpSpill = NULL;
+    nSpilledSize = 0;
+    hSpillMutex = NULL;
+}
+
+/************************************************************************/
+/*                     ~GDALRasterizeShapeStore()                       */
+/************************************************************************/
+
+GDALRasterizeShapeStore::~GDALRasterizeShapeStore()
+{
+    if( fpSpill != NULL )
+    {
+        VSIFCloseL( fpSpill );
+        VSIUnlink( osSpillFilename );
+    }
+    if( hSpillMutex != NULL )
+        CPLDestroyMutex( hSpillMutex );
+}
+
+/************************************************************************/
+/*                           GetRecordSize()                            */
+/*                                                                      */
+/*      Records are made of the header, the burn values, the part       */
+/*      sizes (padded to a multiple of 8 bytes), and the X, Y and       */
+/*      optional variant arrays.                                        */
+/************************************************************************/
+
+size_t GDALRasterizeShapeStore::GetRecordSize(
+                                    const GDALRasterizeShapeHeader* psHeader )
+{
+    size_t nPartBytes = sizeof(GInt32) * ((psHeader->nPartCount + 1) & ~1);
+    size_t nArrays = psHeader->bHasVariant ? 3 : 2;
+
+    return sizeof(GDALRasterizeShapeHeader) + sizeof(double) * nBandCount
+        + nPartBytes + sizeof(double) * nArrays * psHeader->nPointCount;
+}
+
+/************************************************************************/
+/*                               Spill()                                */
+/************************************************************************/
+
+int GDALRasterizeShapeStore::Spill()
+{
+    if( fpSpill == NULL )
+    {
+        osSpillFilename = CPLGenerateTempFilename( "rasterize" );
+        fpSpill = VSIFOpenL( osSpillFilename, "wb+" );
+        if( fpSpill == NULL )
+        {
+            CPLError( CE_Failure, CPLE_FileIO,
+                      "Cannot create temporary file %s.",
+                      osSpillFilename.c_str() );
+            return FALSE;
+        }
+        CPLDebug( "GDAL", "Rasterizer spilling shapes to %s.",
+                  osSpillFilename.c_str() );
+    }
+
+    if( VSIFSeekL( fpSpill, nSpilledSize, SEEK_SET ) != 0 ||
+        VSIFWriteL( &abyMem[0], 1, abyMem.size(), fpSpill ) != abyMem.size() )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot write into temporary file %s.",
+                  osSpillFilename.c_str() );
+        return FALSE;
+    }
+
+    nSpilledSize += abyMem.size();
+    abyMem.resize( 0 );
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                              AddShape()                              */
+/************************************************************************/
+
+int GDALRasterizeShapeStore::AddShape( OGRwkbGeometryType eFlatType,
+                                       const std::vector<int>& aPartSize,
+                                       const std::vector<double>& aPointX,
+                                       const std::vector<double>& aPointY,
+                                       const std::vector<double>& aPointVariant,
+                                       const double* padfBurnValue,
+                                       vsi_l_offset* pnOffset )
+{
+    GDALRasterizeShapeHeader sHeader;
+
+    sHeader.nGeomType = (GInt32) eFlatType;
+    sHeader.nPartCount = (GInt32) aPartSize.size();
+    sHeader.nPointCount = (GInt32) aPointX.size();
+    sHeader.bHasVariant = !aPointVariant.empty();
+
+    /* The variant array is not always as large as the point arrays */
+    /* (see linear rings in GDALCollectRingsFromGeometry()). */
+    size_t nVariantCount = MIN(aPointVariant.size(), aPointX.size());
+
+    size_t nOldSize = abyMem.size();
+    abyMem.resize( nOldSize + GetRecordSize( &sHeader ), 0 );
+
+    GByte* pabyRecord = &abyMem[nOldSize];
+    memcpy( pabyRecord, &sHeader, sizeof(sHeader) );
+    pabyRecord += sizeof(sHeader);
+    memcpy( pabyRecord, padfBurnValue, sizeof(double) * nBandCount );
+    pabyRecord += sizeof(double) * nBandCount;
+    if( sHeader.nPartCount )
+        memcpy( pabyRecord, &aPartSize[0], sizeof(GInt32) * sHeader.nPartCount );
+    pabyRecord += sizeof(GInt32) * ((sHeader.nPartCount + 1) & ~1);
+    if( sHeader.nPointCount )
+    {
+        memcpy( pabyRecord, &aPointX[0], sizeof(double) * sHeader.nPointCount );
+        pabyRecord += sizeof(double) * sHeader.nPointCount;
+        memcpy( pabyRecord, &aPointY[0], sizeof(double) * sHeader.nPointCount );
+        pabyRecord += sizeof(double) * sHeader.nPointCount;
+        if( nVariantCount )
+            memcpy( pabyRecord, &aPointVariant[0], sizeof(double) * nVariantCount );
+    }
+
+    *pnOffset = nSpilledSize + nOldSize;
+
+    if( abyMem.size() > nMaxMemSize )
+        return Spill();
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                              GetShape()                              */
+/*                                                                      */
+/*      Fetch a copy of a record. May be called concurrently from       */
+/*      several threads once all shapes have been added.                */
+/************************************************************************/
+
+int GDALRasterizeShapeStore::GetShape( vsi_l_offset nOffset,
+                                       std::vector<GByte>& abyRecord )
+{
+    GDALRasterizeShapeHeader sHeader;
+
+    if( nOffset >= nSpilledSize )
+    {
+        size_t nMemOffset = (size_t)(nOffset - nSpilledSize);
+
+        memcpy( &sHeader, &abyMem[nMemOffset], sizeof(sHeader) );
+        size_t nRecordSize = GetRecordSize( &sHeader );
+        abyRecord.resize( nRecordSize );
+        memcpy( &abyRecord[0], &abyMem[nMemOffset], nRecordSize );
+        return TRUE;
+    }
+
+    CPLMutexHolderD( &hSpillMutex );
+
+    if( VSIFSeekL( fpSpill, nOffset, SEEK_SET ) != 0 ||
+        VSIFReadL( &sHeader, sizeof(sHeader), 1, fpSpill ) != 1 )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot read temporary file %s.", osSpillFilename.c_str() );
+        return FALSE;
+    }
+
+    size_t nRecordSize = GetRecordSize( &sHeader );
+    abyRecord.resize( nRecordSize );
+    memcpy( &abyRecord[0], &sHeader, sizeof(sHeader) );
+    if( VSIFReadL( &abyRecord[sizeof(sHeader)], 1,
+                   nRecordSize - sizeof(sHeader), fpSpill ) 
+        != nRecordSize - sizeof(sHeader) )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot read temporary file %s.", osSpillFilename.c_str() );
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                  GDALRasterizeCollectLayerShapes()                   */
+/*                                                                      */
+/*      Read all features of a layer once, transform their rings and    */
+/*      register them in the bucket of each chunk they may touch.       */
+/************************************************************************/
+
+static CPLErr GDALRasterizeCollectLayerShapes(
+    OGRLayer *poLayer, GDALRasterizeShapeStore *poStore,
+    std::vector< std::vector<vsi_l_offset> >& aanChunkShapes,
+    int nYChunkSize, int nRasterYSize, int nBandCount,
+    int iBurnField, double *padfBurnValues, int bCoverage,
+    GDALBurnValueSrc eBurnValueSrc,
+    GDALTransformerFunc pfnTransformer, void *pTransformArg )
+{
+    CPLErr       eErr = CE_None;
+    OGRFeature  *poFeat;
+    std::vector<double> adfAttrValues( nBandCount );
+    std::vector<double> aPointX;
+    std::vector<double> aPointY;
+    std::vector<double> aPointVariant;
+    std::vector<int> aPartSize;
+
+    poLayer->ResetReading();
+
+    while( eErr == CE_None && (poFeat = poLayer->GetNextFeature()) != NULL )
+    {
+        OGRGeometry *poGeom = poFeat->GetGeometryRef();
+
+        if( poGeom == NULL )
+        {
+            delete poFeat;
+            continue;
+        }
+
+        if ( iBurnField >= 0 )
+        {
+            double dfAttrValue = poFeat->GetFieldAsDouble( iBurnField );
+            for( int iBand = 0 ; iBand < nBandCount ; iBand++ )
+                adfAttrValues[iBand] = dfAttrValue;
+
+            padfBurnValues = &adfAttrValues[0];
+        }
+
+        aPointX.resize( 0 );
+        aPointY.resize( 0 );
+        aPointVariant.resize( 0 );
+        aPartSize.resize( 0 );
+
+        if( bCoverage )
+        {
+            OGRGeometry *poOrientedGeom = poGeom->clone();
+            GDALOrientRingsForCoverage( poOrientedGeom );
+            GDALCollectRingsFromGeometry( poOrientedGeom,
+                                          aPointX, aPointY, aPointVariant,
+                                          aPartSize, eBurnValueSrc );
+            delete poOrientedGeom;
+        }
+        else
+            GDALCollectRingsFromGeometry( poGeom,
+                                          aPointX, aPointY, aPointVariant,
+                                          aPartSize, eBurnValueSrc );
+
+        if( aPointX.empty() )
+        {
+            delete poFeat;
+            continue;
+        }
+
+        if( pfnTransformer != NULL )
+        {
+            int *panSuccess = (int *) CPLCalloc(sizeof(int),aPointX.size());
+
+            pfnTransformer( pTransformArg, FALSE, aPointX.size(), 
+                            &(aPointX[0]), &(aPointY[0]), NULL, panSuccess );
+            CPLFree( panSuccess );
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Find the range of chunks touched by the shape, with a one       */
+/*      pixel margin so that ALL_TOUCHED and line end points are        */
+/*      safe.                                                           */
+/* -------------------------------------------------------------------- */
+        double dfMinY = aPointY[0], dfMaxY = aPointY[0];
+        for( size_t i = 1; i < aPointY.size(); i++ )
+        {
+            if( aPointY[i] < dfMinY )
+                dfMinY = aPointY[i];
+            if( aPointY[i] > dfMaxY )
+                dfMaxY = aPointY[i];
+        }
+
+        if( !(dfMaxY >= -1.0 && dfMinY <= nRasterYSize + 1.0) )
+        {
+            delete poFeat;
+            continue;
+        }
+
+        int nYMin = (dfMinY < 1.0) ? 0 : (int) floor(dfMinY) - 1;
+        int nYMax = (dfMaxY > nRasterYSize - 2) ? nRasterYSize - 1 :
+                                                  (int) floor(dfMaxY) + 1;
+
+        vsi_l_offset nOffset;
+        if( !poStore->AddShape( wkbFlatten(poGeom->getGeometryType()),
+                                aPartSize, aPointX, aPointY, aPointVariant,
+                                padfBurnValues, &nOffset ) )
+            eErr = CE_Failure;
+
+        for( int iChunk = nYMin / nYChunkSize;
+             iChunk <= nYMax / nYChunkSize; iChunk++ )
+            aanChunkShapes[iChunk].push_back( nOffset );
+
+        delete poFeat;
+    }
+
+    poLayer->ResetReading();
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                      GDALRasterizeChunkProcess()                     */
+/************************************************************************/
+
+typedef struct
+{
+    GDALRasterizeShapeStore         *poStore;
+    std::vector<vsi_l_offset>       *panShapeOffsets;
+    unsigned char                   *pabyChunkBuf;
+    int                              nYOff;
+    int                              nXSize;
+    int                              nYSize;
+    int                              nBandCount;
+    GDALDataType                     eType;
+    int                              bAllTouched;
+    int                              bCoverage;
+    GDALBurnValueSrc                 eBurnValueSrc;
+    GDALRasterMergeAlg               eMergeAlg;
+    CPLErr                           eErr;
+    CPLJoinableThread               *hThread;
+} GDALRasterizeChunkJob;
+
+static void GDALRasterizeChunkProcess( void* pData )
+{
+    GDALRasterizeChunkJob* psJob = (GDALRasterizeChunkJob*) pData;
+    std::vector<GByte> abyRecord;
+    size_t i;
+
+    psJob->eErr = CE_None;
+
+    for( i = 0; i < psJob->panShapeOffsets->size(); i++ )
+    {
+        if( !psJob->poStore->GetShape( (*psJob->panShapeOffsets)[i],
+                                       abyRecord ) )
+        {
+            psJob->eErr = CE_Failure;
+            break;
+        }
+
+        GDALRasterizeShapeHeader* psHeader =
+            (GDALRasterizeShapeHeader*) &abyRecord[0];
+        GByte* pabyData = &abyRecord[0] + sizeof(GDALRasterizeShapeHeader);
+        double* padfBurnValue = (double*) pabyData;
+        pabyData += sizeof(double) * psJob->nBandCount;
+        int* panPartSize = (int*) pabyData;
+        pabyData += sizeof(GInt32) * ((psHeader->nPartCount + 1) & ~1);
+        double* padfX = (double*) pabyData;
+        double* padfY = padfX + psHeader->nPointCount;
+        double* padfVariant = psHeader->bHasVariant ?
+                                padfY + psHeader->nPointCount : NULL;
+
+        gv_rasterize_collected_shape( psJob->pabyChunkBuf, psJob->nYOff,
+                                      psJob->nXSize, psJob->nYSize,
+                                      psJob->nBandCount, psJob->eType,
+                                      psJob->bAllTouched, psJob->bCoverage,
+                                      (OGRwkbGeometryType) psHeader->nGeomType,
+                                      psHeader->nPartCount, panPartSize,
+                                      psHeader->nPointCount,
+                                      padfX, padfY, padfVariant,
+                                      padfBurnValue, psJob->eBurnValueSrc,
+                                      psJob->eMergeAlg );
+    }
+}
+
+/************************************************************************/
+/*                      GDALRasterizeBurnChunks()                       */
+/*                                                                      */
+/*      Second step of the single pass mode: burn the shapes            */
+/*      collected in each chunk bucket.  The dataset is read and        */
+/*      written from the calling thread, while up to nThreads chunks    */
+/*      are burnt concurrently.                                         */
+/************************************************************************/
+
+static CPLErr GDALRasterizeBurnChunks(
+    GDALDataset *poDS, int nBandCount, int *panBandList,
+    GDALRasterizeShapeStore *poStore,
+    std::vector< std::vector<vsi_l_offset> >& aanChunkShapes,
+    unsigned char **papabyChunkBuf, int nThreads, int nYChunkSize,
+    GDALDataType eType, int bAllTouched, int bCoverage,
+    GDALBurnValueSrc eBurnValueSrc, GDALRasterMergeAlg eMergeAlg,
+    GDALProgressFunc pfnProgress, void *pProgressArg )
+{
+    CPLErr eErr = CE_None;
+    int nChunks = (int) aanChunkShapes.size();
+    int nXSize = poDS->GetRasterXSize();
+    int nRasterYSize = poDS->GetRasterYSize();
+    std::vector<GDALRasterizeChunkJob> asJobs( nThreads );
+
+    for( int iFirstChunk = 0; 
+         iFirstChunk < nChunks && eErr == CE_None; 
+         iFirstChunk += nThreads )
+    {
+        int nJobs = MIN(nThreads, nChunks - iFirstChunk);
+        int iJob;
+
+        for( iJob = 0; iJob < nJobs && eErr == CE_None; iJob++ )
+        {
+            GDALRasterizeChunkJob* psJob = &asJobs[iJob];
+            int iY = (iFirstChunk + iJob) * nYChunkSize;
+
+            psJob->poStore = poStore;
+            psJob->panShapeOffsets = &aanChunkShapes[iFirstChunk + iJob];
+            psJob->pabyChunkBuf = papabyChunkBuf[iJob];
+            psJob->nYOff = iY;
+            psJob->nXSize = nXSize;
+            psJob->nYSize = MIN(nYChunkSize, nRasterYSize - iY);
+            psJob->nBandCount = nBandCount;
+            psJob->eType = eType;
+            psJob->bAllTouched = bAllTouched;
+            psJob->bCoverage = bCoverage;
+            psJob->eBurnValueSrc = eBurnValueSrc;
+            psJob->eMergeAlg = eMergeAlg;
+            psJob->eErr = CE_None;
+            psJob->hThread = NULL;
+
+            eErr = 
+                poDS->RasterIO( GF_Read, 0, iY, nXSize, psJob->nYSize, 
+                                psJob->pabyChunkBuf, nXSize, psJob->nYSize,
+                                eType, nBandCount, panBandList, 0, 0, 0, NULL );
+        }
+        if( eErr != CE_None )
+            break;
+
+        if( nJobs == 1 )
+            GDALRasterizeChunkProcess( &asJobs[0] );
+        else
+        {
+            for( iJob = 0; iJob < nJobs; iJob++ )
+                asJobs[iJob].hThread =
+                    CPLCreateJoinableThread( GDALRasterizeChunkProcess,
+                                             &asJobs[iJob] );
+            for( iJob = 0; iJob < nJobs; iJob++ )
+            {
+                if( asJobs[iJob].hThread != NULL )
+                    CPLJoinThread( asJobs[iJob].hThread );
+                else
+                    GDALRasterizeChunkProcess( &asJobs[iJob] );
+            }
+        }
+
+        for( iJob = 0; iJob < nJobs && eErr == CE_None; iJob++ )
+        {
+            GDALRasterizeChunkJob* psJob = &asJobs[iJob];
+
+            eErr = psJob->eErr;
+            if( eErr == CE_None )
+                eErr = 
+                    poDS->RasterIO( GF_Write, 0, psJob->nYOff,
+                                    nXSize, psJob->nYSize, 
+                                    psJob->pabyChunkBuf, nXSize, psJob->nYSize,
+                                    eType, nBandCount, panBandList, 0, 0, 0, NULL );
+
+            /* Release the bucket as soon as it is no longer needed */
+            std::vector<vsi_l_offset>().swap( *(psJob->panShapeOffsets) );
+        }
+
+        if( eErr == CE_None &&
+            !pfnProgress( 0.5 + 0.5 * (iFirstChunk + nJobs) / (double) nChunks,
+                          "", pProgressArg) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    return eErr;
+}
+
+#endif /* def OGR_ENABLED */
+
 /************************************************************************/
 /*                        GDALRasterizeLayers()                         */
 /************************************************************************/
@@ -774,6 +1548,19 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
  * will be burned using the Z value from the first point. The M value may be
  * supported in the future.</dd>
  * <dt>"MERGE_ALG":</dt> <dd>May be REPLACE (the default) or ADD.  REPLACE results in overwriting of value, while ADD adds the new value to the existing raster, suitable for heatmaps for instance.</dd>
+ * <dt>"COVERAGE_FRACTION":</dt> <dd>(GDAL >= 2.0) May be set to TRUE to
+ * burn, for polygons, the burn value multiplied by the exact fraction of the
+ * area of each pixel covered by the polygon. See GDALRasterizeGeometries().
+ * Defaults to FALSE.</dd>
+ * <dt>"SINGLE_PASS":</dt> <dd>(GDAL >= 2.0) May be set to TRUE so that, when
+ * the raster does not fit in a single chunk, each feature is read and
+ * transformed only once instead of once per chunk. The transformed shapes are
+ * sorted into per-chunk buckets, and spilled to a temporary file (in CPL_TMPDIR)
+ * when they exceed the GDAL cache size. Defaults to FALSE.</dd>
+ * <dt>"NUM_THREADS":</dt> <dd>(GDAL >= 2.0) Only used in SINGLE_PASS mode.
+ * Number of chunks burnt in parallel. Can be set to a numeric value or
+ * ALL_CPUS. Defaults to the value of the GDAL_NUM_THREADS configuration option,
+ * or 1.</dd>
  * </dl>
  * @param pfnProgress the progress function to report completion.
  * @param pProgressArg callback data for progress function.
@@ -817,10 +1604,10 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
 /* -------------------------------------------------------------------- */
 /*      Options                                                         */
 /* -------------------------------------------------------------------- */
-    int bAllTouched;
+    int bAllTouched, bCoverage;
     GDALBurnValueSrc eBurnValueSource;
     GDALRasterMergeAlg eMergeAlg;
-    if( GDALRasterizeOptions(papszOptions, &bAllTouched, 
+    if( GDALRasterizeOptions(papszOptions, &bAllTouched, &bCoverage,
                              &eBurnValueSource, &eMergeAlg) == CE_Failure) {
         return CE_Failure;
     }
@@ -834,11 +1621,17 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
     const char  *pszYChunkSize =
         CSLFetchNameValue( papszOptions, "CHUNKYSIZE" );
 
-    if( poBand->GetRasterDataType() == GDT_Byte )
+    if( poBand->GetRasterDataType() == GDT_Byte && !bCoverage )
         eType = GDT_Byte;
     else
         eType = GDT_Float64;
 
+    if( bCoverage && poBand->GetRasterDataType() != GDT_Float32 &&
+        poBand->GetRasterDataType() != GDT_Float64 )
+        CPLError( CE_Warning, CPLE_AppDefined,
+                  "COVERAGE_FRACTION=YES used with a non floating point "
+                  "band: coverage fractions will be truncated." );
+
     nScanlineBytes = nBandCount * poDS->GetRasterXSize()
         * (GDALGetDataTypeSize(eType)/8);
 
@@ -855,18 +1648,74 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
 
     if( nYChunkSize < 1 )
         nYChunkSize = 1;
+
+/* -------------------------------------------------------------------- */
+/*      In single pass mode, each feature is read and transformed       */
+/*      only once, and the chunks are then burnt, possibly in           */
+/*      parallel.  The default chunk size is shared between the         */
+/*      concurrently processed chunks.                                  */
+/* -------------------------------------------------------------------- */
+    int bSinglePass = CSLFetchBoolean( papszOptions, "SINGLE_PASS", FALSE )
+        && nYChunkSize < poDS->GetRasterYSize();
+    int nThreads = 1;
+
+    if( bSinglePass )
+    {
+        const char* pszThreads = CSLFetchNameValue( papszOptions,
+                                                    "NUM_THREADS" );
+        if( pszThreads == NULL )
+            pszThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "1");
+        if( EQUAL(pszThreads, "ALL_CPUS") )
+            nThreads = CPLGetNumCPUs();
+        else
+            nThreads = atoi(pszThreads);
+        if( nThreads > 128 )
+            nThreads = 128;
+        if( nThreads < 1 )
+            nThreads = 1;
+
+        if( !(pszYChunkSize && atoi(pszYChunkSize) != 0) )
+            nYChunkSize = MAX(1, nYChunkSize / nThreads);
+
+        int nChunks = (poDS->GetRasterYSize()+nYChunkSize-1) / nYChunkSize;
+        if( nThreads > nChunks )
+            nThreads = nChunks;
+    }
+
     if( nYChunkSize > poDS->GetRasterYSize() )
         nYChunkSize = poDS->GetRasterYSize();
 
     CPLDebug( "GDAL", "Rasterizer operating on %d swaths of %d scanlines.",
               (poDS->GetRasterYSize()+nYChunkSize-1) / nYChunkSize,
               nYChunkSize );
-    pabyChunkBuf = (unsigned char *) VSIMalloc(nYChunkSize * nScanlineBytes);
-    if( pabyChunkBuf == NULL )
+
+    std::vector<unsigned char*> apabyChunkBuf( nThreads, (unsigned char*)NULL );
+    int iBuf;
+    for( iBuf = 0; iBuf < nThreads; iBuf++ )
     {
-        CPLError( CE_Failure, CPLE_OutOfMemory, 
-                  "Unable to allocate rasterization buffer." );
-        return CE_Failure;
+        apabyChunkBuf[iBuf] = (unsigned char *)
+            VSIMalloc(nYChunkSize * nScanlineBytes);
+        if( apabyChunkBuf[iBuf] == NULL )
+        {
+            CPLError( CE_Failure, CPLE_OutOfMemory, 
+                      "Unable to allocate rasterization buffer." );
+            for( iBuf = 0; iBuf < nThreads; iBuf++ )
+                VSIFree( apabyChunkBuf[iBuf] );
+            return CE_Failure;
+        }
+    }
+    pabyChunkBuf = apabyChunkBuf[0];
+
+    GDALRasterizeShapeStore* poStore = NULL;
+    std::vector< std::vector<vsi_l_offset> > aanChunkShapes;
+    if( bSinglePass )
+    {
+        CPLDebug( "GDAL", "Rasterizer using single pass mode with %d threads.",
+                  nThreads );
+        poStore = new GDALRasterizeShapeStore( nBandCount,
+            (size_t) MIN(GDALGetCacheMax64(), (GIntBig)INT_MAX) );
+        aanChunkShapes.resize(
+            (poDS->GetRasterYSize()+nYChunkSize-1) / nYChunkSize );
     }
 
 /* -------------------------------------------------------------------- */
@@ -971,11 +1820,32 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
 
         poLayer->ResetReading();
 
+/* -------------------------------------------------------------------- */
+/*      In single pass mode, just collect the transformed shapes.       */
+/* -------------------------------------------------------------------- */
+        if( poStore != NULL && eErr == CE_None )
+        {
+            eErr = GDALRasterizeCollectLayerShapes(
+                poLayer, poStore, aanChunkShapes, nYChunkSize,
+                poDS->GetRasterYSize(), nBandCount,
+                iBurnField, padfBurnValues, bCoverage, eBurnValueSource,
+                pfnTransformer, pTransformArg );
+
+            if( eErr == CE_None &&
+                !pfnProgress( 0.5 * (iLayer + 1) / nLayerCount,
+                              "", pProgressArg) )
+            {
+                CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+                eErr = CE_Failure;
+            }
+        }
+
 /* -------------------------------------------------------------------- */
 /*      Loop over image in designated chunks.                           */
 /* -------------------------------------------------------------------- */
         int     iY;
         for( iY = 0; 
+             poStore == NULL &&
              iY < poDS->GetRasterYSize() && eErr == CE_None; 
              iY += nYChunkSize )
         {
@@ -1018,7 +1888,8 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
                 gv_rasterize_one_shape( pabyChunkBuf, iY,
                                         poDS->GetRasterXSize(),
                                         nThisYChunkSize,
-                                        nBandCount, eType, bAllTouched, poGeom,
+                                        nBandCount, eType, bAllTouched,
+                                        bCoverage, poGeom,
                                         padfBurnValues, eBurnValueSource,
                                         eMergeAlg,
                                         pfnTransformer, pTransformArg );
@@ -1069,10 +1940,28 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
                                 eType, nBandCount, panBandList, 0, 0, 0, NULL );
     }
 
+/* -------------------------------------------------------------------- */
+/*      In single pass mode, now burn the collected shapes chunk by     */
+/*      chunk.                                                          */
+/* -------------------------------------------------------------------- */
+    if( poStore != NULL )
+    {
+        if( eErr == CE_None )
+            eErr = GDALRasterizeBurnChunks( poDS, nBandCount, panBandList,
+                                            poStore, aanChunkShapes,
+                                            &apabyChunkBuf[0], nThreads,
+                                            nYChunkSize, eType,
+                                            bAllTouched, bCoverage,
+                                            eBurnValueSource, eMergeAlg,
+                                            pfnProgress, pProgressArg );
+        delete poStore;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      cleanup                                                         */
 /* -------------------------------------------------------------------- */
-    VSIFree( pabyChunkBuf );
+    for( iBuf = 0; iBuf < nThreads; iBuf++ )
+        VSIFree( apabyChunkBuf[iBuf] );
     
     return eErr;
 #endif /* def OGR_ENABLED */
@@ -1104,7 +1993,8 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
  *
  * @param nBufYSize height of the output data array in pixels. 
  *
- * @param eBufType data type of the output data array.
+ * @param eBufType data type of the output data array: GDT_Byte, GDT_Float32
+ * or GDT_Float64.
  *
  * @param nPixelSpace The byte offset from the start of one pixel value in
  * pData to the start of the next pixel value within a scanline.  If defaulted
@@ -1194,13 +2084,23 @@ CPLErr GDALRasterizeLayersBuf( void *pData, int nBufXSize, int nBufYSize,
     if( nLayerCount == 0 )
         return CE_None;
 
+    if( eBufType != GDT_Byte && eBufType != GDT_Float32 &&
+        eBufType != GDT_Float64 )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "GDALRasterizeLayersBuf(): unsupported buffer data type %s, "
+                  "only Byte, Float32 and Float64 are supported.",
+                  GDALGetDataTypeName( eBufType ) );
+        return CE_Failure;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Options                                                         */
 /* -------------------------------------------------------------------- */
-    int bAllTouched;
+    int bAllTouched, bCoverage;
     GDALBurnValueSrc eBurnValueSource;
     GDALRasterMergeAlg eMergeAlg;
-    if( GDALRasterizeOptions(papszOptions, &bAllTouched, 
+    if( GDALRasterizeOptions(papszOptions, &bAllTouched, &bCoverage,
                              &eBurnValueSource, &eMergeAlg) == CE_Failure) {
         return CE_Failure;
     }
@@ -1295,7 +2195,8 @@ CPLErr GDALRasterizeLayersBuf( void *pData, int nBufXSize, int nBufYSize,
             
             gv_rasterize_one_shape( (unsigned char *) pData, 0,
                                     nBufXSize, nBufYSize,
-                                    1, eBufType, bAllTouched, poGeom,
+                                    1, eBufType, bAllTouched, bCoverage,
+                                    poGeom,
                                     &dfBurnValue, eBurnValueSource, eMergeAlg,
                                     pfnTransformer, pTransformArg );
 
@@ -30,31 +30,45 @@
 
 #include "gdal_alg_priv.h"
 #include "cpl_conv.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+#include <algorithm>
 #include <vector>
 
 CPL_CVSID("$Id$");
 
 #define GP_NODATA_MARKER -51502112
-#define MY_MAX_INT 2147483647
+
+/* Approximate number of pixels per stripe. */
+#define GP_STRIPE_PIXELS        (1024 * 1024)
+#define GP_MIN_STRIPE_LINES     16
+
+/* Polygons or list nodes kept by the merger before compacting them. */
+#define GP_COMPACT_MIN_ITEMS    1000000
 
 /*
  * General Plan
  *
- * 1) make a pass with the polygon enumerator to build up the 
- *    polygon map array.  Also accumulate polygon size information.
+ * 1) Split the raster in stripes of lines.  Each stripe is labelled
+ *    independently (possibly by several threads at once) with a union-find
+ *    over provisional labels.  This gives the stripe pieces of polygons,
+ *    with their size, and the contacts between pieces that are smaller
+ *    than the sieve threshold and their neighbours.
  *
- * 2) Identify the polygons that need to be merged.
- * 
- * 3) Make a pass with the polygon enumerator.  For each "to be merged" 
- *    polygon keep track of it's largest neighbour. 
- * 
- * 4) Fix up remappings that would go to polygons smaller than the seive
- *    size.  Ensure these in term map to the largest neighbour of the 
- *    "to be seieved" polygons. 
- * 
- * 5) Make another pass with the polygon enumerator. This time we remap
- *    the actual pixel values of all polygons to be merged.
- * 
+ * 2) Merge the stripes in order into a global union-find, joining the
+ *    pieces that touch across the stripe boundary.  Polygons that do not
+ *    reach the last line of the merged stripes can no longer grow: they
+ *    are finalized.  Finalized small polygons are resolved as soon as the
+ *    size of their largest neighbour is known, and the global tables are
+ *    regularly compacted to only keep the polygons still in use, so memory
+ *    use does not grow with the number of polygons in the raster.
+ *
+ * 3) Make another pass over the stripes, labelling them again and
+ *    replacing the pixel values of the pieces of polygons to be merged.
+ *
+ * Like with the original per-line enumerator approach, each small polygon
+ * is merged into its largest neighbour, ties being resolved in favour of
+ * the first neighbour met in a top-to-bottom, left-to-right scan.
  */
 
 /************************************************************************/
@@ -64,19 +78,19 @@ CPL_CVSID("$Id$");
 /*      band is zero.                                                   */
 /************************************************************************/
 
-static CPLErr 
-GPMaskImageData( GDALRasterBandH hMaskBand, GByte *pabyMaskLine, int iY, int nXSize, 
-                 GInt32 *panImageLine )
+static CPLErr
+GPMaskImageData( GDALRasterBandH hMaskBand, GByte *pabyMaskLine,
+                 int iY, int nXSize, int nLines, GInt32 *panImageLine )
 
 {
     CPLErr eErr;
 
-    eErr = GDALRasterIO( hMaskBand, GF_Read, 0, iY, nXSize, 1, 
-                         pabyMaskLine, nXSize, 1, GDT_Byte, 0, 0 );
+    eErr = GDALRasterIO( hMaskBand, GF_Read, 0, iY, nXSize, nLines,
+                         pabyMaskLine, nXSize, nLines, GDT_Byte, 0, 0 );
     if( eErr == CE_None )
     {
-        int i;
-        for( i = 0; i < nXSize; i++ )
+        size_t i;
+        for( i = 0; i < (size_t)nXSize * nLines; i++ )
         {
             if( pabyMaskLine[i] == 0 )
                 panImageLine[i] = GP_NODATA_MARKER;
@@ -87,492 +101,1340 @@ GPMaskImageData( GDALRasterBandH hMaskBand, GByte *pabyMaskLine, int iY, int nXS
 }
 
 /************************************************************************/
-/*                          CompareNeighbour()                          */
-/*                                                                      */
-/*      Compare two neighbouring polygons, and update eaches            */
-/*      "biggest neighbour" if the other is larger than it's current    */
-/*      largest neighbour.                                              */
+/* ==================================================================== */
+/*                        Stripe labelling                              */
+/* ==================================================================== */
+/************************************************************************/
+
+typedef struct
+{
+    GInt32      nValue;
+    int         nSize;
+    GIntBig     nKey;               // raster index of the first pixel.
+    int         bTouchesBottom;
+} GPPiece;
+
+typedef struct
+{
+    int         nPiece;
+    int         nOther;
+    GIntBig     nOrder;             // see GPContactOrder().
+} GPPieceContact;
+
+typedef struct
+{
+    GIntBig     nKey;               // key of the piece to change.
+    GInt32      nValue;             // new value.
+} GPDecision;
+
+static bool GPDecisionLess( const GPDecision &a, const GPDecision &b )
+{
+    return a.nKey < b.nKey;
+}
+
+static bool GPPieceContactLess( const GPPieceContact &a,
+                                const GPPieceContact &b )
+{
+    if( a.nPiece != b.nPiece )
+        return a.nPiece < b.nPiece;
+    if( a.nOther != b.nOther )
+        return a.nOther < b.nOther;
+    return a.nOrder < b.nOrder;
+}
+
+/************************************************************************/
+/*                          GPContactOrder()                            */
 /*                                                                      */
-/*      Note that this should end up with each polygon knowing the      */
-/*      id of it's largest neighbour.  No attempt is made to            */
-/*      restrict things to small polygons that we will be merging,      */
-/*      nor to exclude assigning "biggest neighbours" that are still    */
-/*      smaller than our sieve threshold.                               */
+/*      Rank of the comparison of a pixel with one of its already       */
+/*      scanned neighbours (0: above, 1: above left, 2: above right,    */
+/*      3: left) in a top-to-bottom, left-to-right scan.                */
 /************************************************************************/
 
-static inline void CompareNeighbour( int nPolyId1, int nPolyId2, 
-                                     int *panPolyIdMap, 
-                                     int *panPolyValue,
-                                     std::vector<int> &anPolySizes,
-                                     std::vector<int> &anBigNeighbour )
+static inline GIntBig GPContactOrder( GIntBig nPixel, int nRank )
+{
+    return nPixel * 4 + nRank;
+}
 
+typedef struct
 {
-    // make sure we are working with the final merged polygon ids. 
-    nPolyId1 = panPolyIdMap[nPolyId1];
-    nPolyId2 = panPolyIdMap[nPolyId2];
+    int         nXSize;
+    int         nYOff;
+    int         nLines;
+    int         nConnectedness;
+    int         nSizeThreshold;
 
-    if( nPolyId1 == nPolyId2 )
-        return;
+    GInt32     *panRawVal;          // unmasked values.
+    GInt32     *panVal;             // masked values.
+    GInt32     *panLabel;           // piece of each pixel, -1 for nodata.
+    GByte      *pabyMask;
 
-    // nodata polygon do not need neighbours, and cannot be neighbours
-    // to valid polygons. 
-    if( panPolyValue[nPolyId1] == GP_NODATA_MARKER
-        || panPolyValue[nPolyId2] == GP_NODATA_MARKER )
-        return;
+    // Outputs of the labelling.
+    std::vector<GPPiece>        asPieces;   // sorted by key.
+    std::vector<GPPieceContact> asContacts;
+
+    // Set for the final pass: sorted decisions for this stripe.
+    int         bApply;
+    const GPDecision *pasDecisions;
+    int         nDecisions;
 
-    if( anBigNeighbour[nPolyId1] == -1
-        || anPolySizes[anBigNeighbour[nPolyId1]] < anPolySizes[nPolyId2] )
-        anBigNeighbour[nPolyId1] = nPolyId2;
+    CPLJoinableThread *hThread;
+} GPStripe;
 
-    if( anBigNeighbour[nPolyId2] == -1
-        || anPolySizes[anBigNeighbour[nPolyId2]] < anPolySizes[nPolyId1] )
-        anBigNeighbour[nPolyId2] = nPolyId1;
+/************************************************************************/
+/*                             GPFind()                                 */
+/************************************************************************/
+
+static inline int GPFind( std::vector<int> &anParent, int n )
+{
+    while( anParent[n] != n )
+    {
+        anParent[n] = anParent[anParent[n]];
+        n = anParent[n];
+    }
+    return n;
 }
 
 /************************************************************************/
-/*                          GDALSieveFilter()                           */
+/*                           GPLabelStripe()                            */
+/*                                                                      */
+/*      Connected component labelling of one stripe.  Provisional       */
+/*      labels are created in scan order, and unions keep the lowest    */
+/*      one as root, so the root of each piece is the label of its      */
+/*      first pixel.                                                    */
 /************************************************************************/
 
-/** 
- * Removes small raster polygons. 
- *
- * The function removes raster polygons smaller than a provided
- * threshold size (in pixels) and replaces replaces them with the pixel value 
- * of the largest neighbour polygon.  
- *
- * Polygon are determined (per GDALRasterPolygonEnumerator) as regions of
- * the raster where the pixels all have the same value, and that are contiguous
- * (connected).  
- *
- * Pixels determined to be "nodata" per hMaskBand will not be treated as part
- * of a polygon regardless of their pixel values.  Nodata areas will never be
- * changed nor affect polygon sizes. 
- *
- * Polygons smaller than the threshold with no neighbours that are as large
- * as the threshold will not be altered.  Polygons surrounded by nodata areas
- * will therefore not be altered.  
- *
- * The algorithm makes three passes over the input file to enumerate the
- * polygons and collect limited information about them.  Memory use is 
- * proportional to the number of polygons (roughly 24 bytes per polygon), but
- * is not directly related to the size of the raster.  So very large raster
- * files can be processed effectively if there aren't too many polygons.  But
- * extremely noisy rasters with many one pixel polygons will end up being 
- * expensive (in memory) to process.
- * 
- * @param hSrcBand the source raster band to be processed.
- * @param hMaskBand an optional mask band.  All pixels in the mask band with a 
- * value other than zero will be considered suitable for inclusion in polygons.
- * @param hDstBand the output raster band.  It may be the same as hSrcBand
- * to update the source in place. 
- * @param nSizeThreshold raster polygons with sizes smaller than this will
- * be merged into their largest neighbour.
- * @param nConnectedness either 4 indicating that diagonal pixels are not
- * considered directly adjacent for polygon membership purposes or 8
- * indicating they are. 
- * @param papszOptions algorithm options in name=value list form.  None currently
- * supported.
- * @param pfnProgress callback for reporting algorithm progress matching the
- * GDALProgressFunc() semantics.  May be NULL.
- * @param pProgressArg callback argument passed to pfnProgress.
- *
- * @return CE_None on success or CE_Failure if an error occurs.
- */
+static void GPLabelStripe( GPStripe *psStripe )
 
-CPLErr CPL_STDCALL
-GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
-                 GDALRasterBandH hDstBand,
-                 int nSizeThreshold, int nConnectedness,
-                 CPL_UNUSED char **papszOptions,
-                 GDALProgressFunc pfnProgress,
-                 void * pProgressArg )
 {
-    VALIDATE_POINTER1( hSrcBand, "GDALSieveFilter", CE_Failure );
-    VALIDATE_POINTER1( hDstBand, "GDALSieveFilter", CE_Failure );
+    const int nXSize = psStripe->nXSize;
+    const int nLines = psStripe->nLines;
+    const GInt32 *panVal = psStripe->panVal;
+    GInt32 *panLabel = psStripe->panLabel;
+    const int b8 = (psStripe->nConnectedness == 8);
+    std::vector<int> anParent;
+    std::vector<int> anStart;
+    int iX, iY;
+
+    for( iY = 0; iY < nLines; iY++ )
+    {
+        for( iX = 0; iX < nXSize; iX++ )
+        {
+            const size_t i = iX + (size_t)iY * nXSize;
+            const GInt32 nValue = panVal[i];
 
-    if( pfnProgress == NULL )
-        pfnProgress = GDALDummyProgress;
+            if( nValue == GP_NODATA_MARKER )
+            {
+                panLabel[i] = -1;
+                continue;
+            }
+
+            int nLabel = -1;
+            int anCandidates[4];
+            int nCandidates = 0;
+
+            if( iX > 0 && panVal[i-1] == nValue )
+                anCandidates[nCandidates++] = panLabel[i-1];
+            if( iY > 0 )
+            {
+                if( panVal[i-nXSize] == nValue )
+                    anCandidates[nCandidates++] = panLabel[i-nXSize];
+                if( b8 && iX > 0 && panVal[i-nXSize-1] == nValue )
+                    anCandidates[nCandidates++] = panLabel[i-nXSize-1];
+                if( b8 && iX < nXSize-1 && panVal[i-nXSize+1] == nValue )
+                    anCandidates[nCandidates++] = panLabel[i-nXSize+1];
+            }
+
+            for( int k = 0; k < nCandidates; k++ )
+            {
+                int nRoot = GPFind( anParent, anCandidates[k] );
+                if( nLabel < 0 )
+                    nLabel = nRoot;
+                else if( nRoot < nLabel )
+                {
+                    anParent[nLabel] = nRoot;
+                    nLabel = nRoot;
+                }
+                else if( nRoot > nLabel )
+                    anParent[nRoot] = nLabel;
+            }
+
+            if( nLabel < 0 )
+            {
+                nLabel = (int) anParent.size();
+                anParent.push_back( nLabel );
+                anStart.push_back( (int) i );
+            }
+            panLabel[i] = nLabel;
+        }
+    }
 
 /* -------------------------------------------------------------------- */
-/*      Allocate working buffers.                                       */
+/*      Resolve the provisional labels into pieces.                     */
 /* -------------------------------------------------------------------- */
-    CPLErr eErr = CE_None;
-    int nXSize = GDALGetRasterBandXSize( hSrcBand );
-    int nYSize = GDALGetRasterBandYSize( hSrcBand );
-    GInt32 *panLastLineVal = (GInt32 *) VSIMalloc2(sizeof(GInt32), nXSize);
-    GInt32 *panThisLineVal = (GInt32 *) VSIMalloc2(sizeof(GInt32), nXSize);
-    GInt32 *panLastLineId =  (GInt32 *) VSIMalloc2(sizeof(GInt32), nXSize);
-    GInt32 *panThisLineId =  (GInt32 *) VSIMalloc2(sizeof(GInt32), nXSize);
-    GInt32 *panThisLineWriteVal = (GInt32 *) VSIMalloc2(sizeof(GInt32), nXSize);
-    GByte *pabyMaskLine = (hMaskBand != NULL) ? (GByte *) VSIMalloc(nXSize) : NULL;
-    if (panLastLineVal == NULL || panThisLineVal == NULL ||
-        panLastLineId == NULL || panThisLineId == NULL ||
-        panThisLineWriteVal == NULL ||
-        (hMaskBand != NULL && pabyMaskLine == NULL))
-    {
-        CPLError(CE_Failure, CPLE_OutOfMemory,
-                 "Could not allocate enough memory for temporary buffers");
-        CPLFree( panThisLineId );
-        CPLFree( panLastLineId );
-        CPLFree( panThisLineVal );
-        CPLFree( panLastLineVal );
-        CPLFree( panThisLineWriteVal );
-        CPLFree( pabyMaskLine );
-        return CE_Failure;
-    }
-
-/* -------------------------------------------------------------------- */
-/*      The first pass over the raster is only used to build up the     */
-/*      polygon id map so we will know in advance what polygons are     */
-/*      what on the second pass.                                        */
-/* -------------------------------------------------------------------- */
-    int iY, iX, iPoly;
-    GDALRasterPolygonEnumerator oFirstEnum( nConnectedness );
-    std::vector<int> anPolySizes;
-
-    for( iY = 0; eErr == CE_None && iY < nYSize; iY++ )
-    {
-        eErr = GDALRasterIO( 
-            hSrcBand,
-            GF_Read, 0, iY, nXSize, 1, 
-            panThisLineVal, nXSize, 1, GDT_Int32, 0, 0 );
-        
-        if( eErr == CE_None && hMaskBand != NULL )
-            eErr = GPMaskImageData( hMaskBand, pabyMaskLine, iY, nXSize, panThisLineVal );
-
-        if( iY == 0 )
-            oFirstEnum.ProcessLine( 
-                NULL, panThisLineVal, NULL, panThisLineId, nXSize );
+    const int nLabels = (int) anParent.size();
+    const GIntBig nFirstPixel = (GIntBig)psStripe->nYOff * nXSize;
+    std::vector<GPPiece> &asPieces = psStripe->asPieces;
+    int iLabel;
+
+    std::vector<int> anPieceOfLabel( nLabels );
+
+    asPieces.resize( 0 );
+    for( iLabel = 0; iLabel < nLabels; iLabel++ )
+    {
+        const int nRoot = GPFind( anParent, iLabel );
+        if( nRoot == iLabel )
+        {
+            GPPiece sPiece;
+            sPiece.nValue = panVal[anStart[iLabel]];
+            sPiece.nSize = 0;
+            sPiece.nKey = nFirstPixel + anStart[iLabel];
+            sPiece.bTouchesBottom = FALSE;
+            anPieceOfLabel[iLabel] = (int) asPieces.size();
+            asPieces.push_back( sPiece );
+        }
         else
-            oFirstEnum.ProcessLine(
-                panLastLineVal, panThisLineVal, 
-                panLastLineId,  panThisLineId, 
-                nXSize );
+            anPieceOfLabel[iLabel] = anPieceOfLabel[nRoot];
+    }
 
-/* -------------------------------------------------------------------- */
-/*      Accumulate polygon sizes.                                       */
-/* -------------------------------------------------------------------- */
-        if( oFirstEnum.nNextPolygonId > (int) anPolySizes.size() )
-            anPolySizes.resize( oFirstEnum.nNextPolygonId );
+    const size_t nPixels = (size_t)nXSize * nLines;
+    size_t i;
+    for( i = 0; i < nPixels; i++ )
+    {
+        if( panLabel[i] >= 0 )
+        {
+            panLabel[i] = anPieceOfLabel[panLabel[i]];
+            asPieces[panLabel[i]].nSize++;
+        }
+    }
+    for( i = nPixels - nXSize; i < nPixels; i++ )
+    {
+        if( panLabel[i] >= 0 )
+            asPieces[panLabel[i]].bTouchesBottom = TRUE;
+    }
+}
 
+/************************************************************************/
+/*                       GPCollectStripeContacts()                      */
+/*                                                                      */
+/*      Collect contacts between pieces of the stripe, keeping for      */
+/*      each pair the first one in scan order.  Only the side that is   */
+/*      smaller than the threshold needs to know about its neighbours.  */
+/************************************************************************/
+
+static void GPCollectStripeContacts( GPStripe *psStripe )
+
+{
+    const int nXSize = psStripe->nXSize;
+    const int nLines = psStripe->nLines;
+    const GInt32 *panLabel = psStripe->panLabel;
+    const std::vector<GPPiece> &asPieces = psStripe->asPieces;
+    const int nThreshold = psStripe->nSizeThreshold;
+    const int b8 = (psStripe->nConnectedness == 8);
+    const GIntBig nFirstPixel = (GIntBig)psStripe->nYOff * nXSize;
+    std::vector<GPPieceContact> &asContacts = psStripe->asContacts;
+    std::vector<GPPieceContact> asRaw;
+    int iX, iY;
+
+    for( iY = 0; iY < nLines; iY++ )
+    {
         for( iX = 0; iX < nXSize; iX++ )
         {
-            iPoly = panThisLineId[iX]; 
+            const size_t i = iX + (size_t)iY * nXSize;
+            const int nPiece = panLabel[i];
+            if( nPiece < 0 )
+                continue;
+
+            int anOther[4] = { -1, -1, -1, -1 };
+            if( iY > 0 )
+            {
+                anOther[0] = panLabel[i-nXSize];
+                if( b8 && iX > 0 )
+                    anOther[1] = panLabel[i-nXSize-1];
+                if( b8 && iX < nXSize-1 )
+                    anOther[2] = panLabel[i-nXSize+1];
+            }
+            if( iX > 0 )
+                anOther[3] = panLabel[i-1];
 
-            CPLAssert( iPoly >= 0 );
-            if( anPolySizes[iPoly] < MY_MAX_INT )
-                anPolySizes[iPoly] += 1;
+            for( int nRank = 0; nRank < 4; nRank++ )
+            {
+                const int nOther = anOther[nRank];
+                if( nOther < 0 || nOther == nPiece )
+                    continue;
+
+                // A pair already met in one of the last two contacts
+                // produced the same entries with a lower order.
+                const size_t nCount = asRaw.size();
+                bool bSeen = false;
+                for( size_t k = (nCount > 2) ? nCount - 2 : 0;
+                     k < nCount && !bSeen; k++ )
+                {
+                    bSeen = (asRaw[k].nPiece == nPiece
+                             && asRaw[k].nOther == nOther)
+                        || (asRaw[k].nPiece == nOther
+                            && asRaw[k].nOther == nPiece);
+                }
+                if( bSeen )
+                    continue;
+
+                GPPieceContact sContact;
+                sContact.nOrder = GPContactOrder( nFirstPixel + i, nRank );
+                if( asPieces[nPiece].nSize < nThreshold )
+                {
+                    sContact.nPiece = nPiece;
+                    sContact.nOther = nOther;
+                    asRaw.push_back( sContact );
+                }
+                if( asPieces[nOther].nSize < nThreshold )
+                {
+                    sContact.nPiece = nOther;
+                    sContact.nOther = nPiece;
+                    asRaw.push_back( sContact );
+                }
+            }
         }
+    }
 
 /* -------------------------------------------------------------------- */
-/*      swap this/last lines.                                           */
+/*      Group the contacts by piece (a stable counting sort keeps       */
+/*      them in scan order), and keep the first contact of each pair.   */
 /* -------------------------------------------------------------------- */
-        GInt32 *panTmp = panLastLineVal;
-        panLastLineVal = panThisLineVal;
-        panThisLineVal = panTmp;
+    const int nPieces = (int) asPieces.size();
+    std::vector<int> anStart( nPieces + 1, 0 );
+    size_t iIn;
+    int iPiece;
 
-        panTmp = panThisLineId;
-        panThisLineId = panLastLineId;
-        panLastLineId = panTmp;
+    for( iIn = 0; iIn < asRaw.size(); iIn++ )
+        anStart[asRaw[iIn].nPiece + 1]++;
+    for( iPiece = 0; iPiece < nPieces; iPiece++ )
+        anStart[iPiece + 1] += anStart[iPiece];
 
-/* -------------------------------------------------------------------- */
-/*      Report progress, and support interrupts.                        */
-/* -------------------------------------------------------------------- */
-        if( eErr == CE_None 
-            && !pfnProgress( 0.25 * ((iY+1) / (double) nYSize), 
-                             "", pProgressArg ) )
+    asContacts.resize( asRaw.size() );
+    {
+        std::vector<int> anNext( anStart.begin(), anStart.end() - 1 );
+        for( iIn = 0; iIn < asRaw.size(); iIn++ )
+            asContacts[anNext[asRaw[iIn].nPiece]++] = asRaw[iIn];
+    }
+
+    size_t nOut = 0;
+    for( iPiece = 0; iPiece < nPieces; iPiece++ )
+    {
+        const size_t nFirstIn = anStart[iPiece];
+        const size_t nLastIn = anStart[iPiece+1];
+        const size_t nFirstOut = nOut;
+
+        if( nLastIn - nFirstIn > 64 )
+            std::sort( asContacts.begin() + nFirstIn,
+                       asContacts.begin() + nLastIn, GPPieceContactLess );
+
+        for( iIn = nFirstIn; iIn < nLastIn; iIn++ )
         {
-            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-            eErr = CE_Failure;
+            size_t iKept = nFirstOut;
+            if( nLastIn - nFirstIn > 64 )
+                iKept = (nOut > nFirstOut) ? nOut - 1 : nOut;
+            while( iKept < nOut
+                   && asContacts[iKept].nOther != asContacts[iIn].nOther )
+                iKept++;
+            if( iKept == nOut )
+                asContacts[nOut++] = asContacts[iIn];
         }
     }
+    asContacts.resize( nOut );
+}
 
-/* -------------------------------------------------------------------- */
-/*      Make a pass through the maps, ensuring every polygon id         */
-/*      points to the final id it should use, not an intermediate       */
-/*      value.                                                          */
-/* -------------------------------------------------------------------- */
-    oFirstEnum.CompleteMerges();
+/************************************************************************/
+/*                         GPApplyDecisions()                           */
+/*                                                                      */
+/*      Replace the values of the pieces that have a decision.  Both    */
+/*      lists are sorted by key.                                        */
+/************************************************************************/
 
-/* -------------------------------------------------------------------- */
-/*      Push the sizes of merged polygon fragments into the the         */
-/*      merged polygon id's count.                                      */
-/* -------------------------------------------------------------------- */
-    for( iPoly = 0; iPoly < oFirstEnum.nNextPolygonId; iPoly++ )
+static void GPApplyDecisions( GPStripe *psStripe )
+
+{
+    const std::vector<GPPiece> &asPieces = psStripe->asPieces;
+    std::vector<GInt32> anNewValue( asPieces.size() );
+    std::vector<GByte> abyChanged( asPieces.size(), 0 );
+    int iPiece = 0, iDecision;
+    int bAny = FALSE;
+
+    for( iDecision = 0; iDecision < psStripe->nDecisions; iDecision++ )
     {
-        if( oFirstEnum.panPolyIdMap[iPoly] != iPoly )
+        const GPDecision *psDecision = psStripe->pasDecisions + iDecision;
+        while( iPiece < (int) asPieces.size()
+               && asPieces[iPiece].nKey < psDecision->nKey )
+            iPiece++;
+        if( iPiece < (int) asPieces.size()
+            && asPieces[iPiece].nKey == psDecision->nKey )
         {
-            GIntBig nSize = anPolySizes[oFirstEnum.panPolyIdMap[iPoly]];
+            anNewValue[iPiece] = psDecision->nValue;
+            abyChanged[iPiece] = TRUE;
+            bAny = TRUE;
+        }
+    }
+
+    if( !bAny )
+        return;
+
+    const size_t nPixels = (size_t)psStripe->nXSize * psStripe->nLines;
+    for( size_t i = 0; i < nPixels; i++ )
+    {
+        const int nPiece = psStripe->panLabel[i];
+        if( nPiece >= 0 && abyChanged[nPiece] )
+            psStripe->panRawVal[i] = anNewValue[nPiece];
+    }
+}
+
+/************************************************************************/
+/*                         GPProcessStripeFunc()                        */
+/************************************************************************/
+
+static void GPProcessStripeFunc( void *pData )
+
+{
+    GPStripe *psStripe = (GPStripe *) pData;
+
+    GPLabelStripe( psStripe );
+    if( psStripe->bApply )
+        GPApplyDecisions( psStripe );
+    else
+        GPCollectStripeContacts( psStripe );
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                           GPSieveMerger                              */
+/* ==================================================================== */
+/*                                                                      */
+/*      Merges the pieces of the successive stripes into polygons and   */
+/*      decides which polygons are to be sieved.                        */
+/************************************************************************/
+
+/*
+ * Per polygon lists (contacts, piece keys, waiting polygons) are
+ * singly linked lists of nodes allocated from pools shared by all
+ * polygons, so that merging two polygons is a constant time splice
+ * and creating millions of tiny polygons does not hit the heap.
+ * Unreferenced nodes are reclaimed by Compact().
+ */
+
+typedef struct
+{
+    int         nHead;
+    int         nTail;
+} GPList;
+
+typedef struct
+{
+    int         nOther;
+    int         nNext;
+    GIntBig     nOrder;
+} GPContact;
+
+typedef struct
+{
+    GIntBig     nKey;
+    int         nNext;
+} GPPieceKey;
+
+typedef struct
+{
+    int         nPoly;
+    int         nNext;
+} GPWaiter;
+
+typedef struct
+{
+    int         nParent;
+    GInt32      nValue;
+    GIntBig     nSize;
+    bool        bOpen;              // touches the last merged line.
+    bool        bDone;              // finalized.
+    bool        bPending;           // finalized, waiting on a neighbour.
+
+    // Only kept while smaller than the threshold.
+    GPList      sContacts;
+    GPList      sPieceKeys;
+
+    // Pending polygons to reconsider when this one is finalized.
+    GPList      sWaiting;
+} GPPolygon;
+
+static const GPList sGPEmptyList = { -1, -1 };
+
+/************************************************************************/
+/*                            GPListAppend()                            */
+/************************************************************************/
+
+template<class T>
+static void GPListAppend( std::vector<T> &asPool, GPList &sList, T &sNode )
+
+{
+    const int nIndex = (int) asPool.size();
+
+    sNode.nNext = -1;
+    asPool.push_back( sNode );
+    if( sList.nHead < 0 )
+        sList.nHead = nIndex;
+    else
+        asPool[sList.nTail].nNext = nIndex;
+    sList.nTail = nIndex;
+}
+
+/************************************************************************/
+/*                            GPListSplice()                            */
+/*                                                                      */
+/*      Move the nodes of sSrc at the end of sDst.                      */
+/************************************************************************/
+
+template<class T>
+static void GPListSplice( std::vector<T> &asPool, GPList &sDst, GPList &sSrc )
+
+{
+    if( sSrc.nHead < 0 )
+        return;
+    if( sDst.nHead < 0 )
+        sDst.nHead = sSrc.nHead;
+    else
+        asPool[sDst.nTail].nNext = sSrc.nHead;
+    sDst.nTail = sSrc.nTail;
+    sSrc = sGPEmptyList;
+}
+
+/************************************************************************/
+/*                            GPListCopy()                              */
+/*                                                                      */
+/*      Copy the nodes of a list into a new pool.                       */
+/************************************************************************/
+
+template<class T>
+static GPList GPListCopy( const std::vector<T> &asPool, const GPList &sList,
+                          std::vector<T> &asNewPool )
+
+{
+    GPList sNewList = sGPEmptyList;
+
+    for( int i = sList.nHead; i >= 0; i = asPool[i].nNext )
+    {
+        T sNode = asPool[i];
+        GPListAppend( asNewPool, sNewList, sNode );
+    }
+    return sNewList;
+}
+
+class GPSieveMerger
+{
+    int         nXSize;
+    int         nConnectedness;
+    int         nSizeThreshold;
+
+    std::vector<GPPolygon>  asPolys;
+    std::vector<GPContact>  asContactPool;
+    std::vector<GPPieceKey> asPieceKeyPool;
+    std::vector<GPWaiter>   asWaiterPool;
+    size_t      nPolysAfterCompaction;
+    size_t      nNodesAfterCompaction;
+
+    // Last line of the last merged stripe.
+    std::vector<GInt32> anBottomVal;
+    std::vector<int>    anBottomId;
+    std::vector<int>    anOpen;
+
+    int         Find( int nPoly );
+    void        Union( int nPoly1, int nPoly2 );
+    void        AddContact( int nPoly1, int nPoly2, GIntBig nOrder );
+    void        Finalize( int nPoly );
+    void        Decide( int nPoly );
+    void        Compact();
+
+  public:
+                GPSieveMerger( int nXSize, int nConnectedness,
+                               int nSizeThreshold );
+
+    void        AddStripe( const GPStripe *psStripe );
+    void        Finish();
+
+    std::vector<GPDecision> asDecisions;
+    int         nSieveTargets;
+    int         nIsolatedSmall;
+    int         nFailedMerges;
+};
+
+/************************************************************************/
+/*                           GPSieveMerger()                            */
+/************************************************************************/
+
+GPSieveMerger::GPSieveMerger( int nXSizeIn, int nConnectednessIn,
+                              int nSizeThresholdIn ) :
+    nXSize( nXSizeIn ),
+    nConnectedness( nConnectednessIn ),
+    nSizeThreshold( nSizeThresholdIn ),
+    nPolysAfterCompaction( 0 ),
+    nNodesAfterCompaction( 0 ),
+    nSieveTargets( 0 ),
+    nIsolatedSmall( 0 ),
+    nFailedMerges( 0 )
+{
+}
+
+/************************************************************************/
+/*                                Find()                                */
+/************************************************************************/
+
+int GPSieveMerger::Find( int nPoly )
+
+{
+    while( asPolys[nPoly].nParent != nPoly )
+    {
+        asPolys[nPoly].nParent = asPolys[asPolys[nPoly].nParent].nParent;
+        nPoly = asPolys[nPoly].nParent;
+    }
+    return nPoly;
+}
+
+/************************************************************************/
+/*                               Union()                                */
+/************************************************************************/
+
+void GPSieveMerger::Union( int nPoly1, int nPoly2 )
+
+{
+    nPoly1 = Find( nPoly1 );
+    nPoly2 = Find( nPoly2 );
+    if( nPoly1 == nPoly2 )
+        return;
+
+    if( nPoly2 < nPoly1 )
+        std::swap( nPoly1, nPoly2 );
 
-            nSize += anPolySizes[iPoly];
-            
-            if( nSize > MY_MAX_INT )
-                nSize = MY_MAX_INT;
+    GPPolygon &oDst = asPolys[nPoly1];
+    GPPolygon &oSrc = asPolys[nPoly2];
 
-            anPolySizes[oFirstEnum.panPolyIdMap[iPoly]] = (int)nSize;
-            anPolySizes[iPoly] = 0;
+    oSrc.nParent = nPoly1;
+    oDst.nSize += oSrc.nSize;
+
+    if( oDst.nSize < nSizeThreshold )
+    {
+        GPListSplice( asContactPool, oDst.sContacts, oSrc.sContacts );
+        GPListSplice( asPieceKeyPool, oDst.sPieceKeys, oSrc.sPieceKeys );
+    }
+    else
+    {
+        oDst.sContacts = sGPEmptyList;
+        oDst.sPieceKeys = sGPEmptyList;
+    }
+    GPListSplice( asWaiterPool, oDst.sWaiting, oSrc.sWaiting );
+
+    oSrc.sContacts = sGPEmptyList;
+    oSrc.sPieceKeys = sGPEmptyList;
+}
+
+/************************************************************************/
+/*                             AddContact()                             */
+/************************************************************************/
+
+void GPSieveMerger::AddContact( int nPoly1, int nPoly2, GIntBig nOrder )
+
+{
+    GPContact sContact;
+    sContact.nOrder = nOrder;
+
+    nPoly1 = Find( nPoly1 );
+    nPoly2 = Find( nPoly2 );
+
+    if( asPolys[nPoly1].nSize < nSizeThreshold )
+    {
+        sContact.nOther = nPoly2;
+        GPListAppend( asContactPool, asPolys[nPoly1].sContacts, sContact );
+    }
+    if( asPolys[nPoly2].nSize < nSizeThreshold )
+    {
+        sContact.nOther = nPoly1;
+        GPListAppend( asContactPool, asPolys[nPoly2].sContacts, sContact );
+    }
+}
+
+/************************************************************************/
+/*                              Decide()                                */
+/*                                                                      */
+/*      Try to find the largest neighbour of a finalized small          */
+/*      polygon.  If this depends on the final size of a neighbour      */
+/*      that is still growing, the polygon is put on the waiting list   */
+/*      of that neighbour.                                              */
+/************************************************************************/
+
+void GPSieveMerger::Decide( int nPoly )
+
+{
+    int nBest = -1, nOpen = -1;
+    GIntBig nBestOrder = 0, nOpenOrder = 0;
+    bool bSeveralOpen = false;
+    int iContact;
+
+    for( iContact = asPolys[nPoly].sContacts.nHead; iContact >= 0;
+         iContact = asContactPool[iContact].nNext )
+    {
+        const GPContact &sContact = asContactPool[iContact];
+        const int nOther = Find( sContact.nOther );
+        const GPPolygon &oOther = asPolys[nOther];
+
+        if( oOther.bOpen )
+        {
+            if( nOpen < 0 || nOpen == nOther )
+            {
+                if( nOpen < 0 || sContact.nOrder < nOpenOrder )
+                    nOpenOrder = sContact.nOrder;
+                nOpen = nOther;
+            }
+            else
+                bSeveralOpen = true;
+        }
+        else if( nBest < 0
+                 || oOther.nSize > asPolys[nBest].nSize
+                 || (oOther.nSize == asPolys[nBest].nSize
+                     && sContact.nOrder < nBestOrder) )
+        {
+            nBest = nOther;
+            nBestOrder = sContact.nOrder;
         }
     }
 
 /* -------------------------------------------------------------------- */
-/*      We will use a new enumerator for the second pass primariliy     */
-/*      so we can preserve the first pass map.                          */
+/*      A growing neighbour is known to win if it is already the        */
+/*      largest, and to be suitable once it reaches the threshold.      */
+/*      Otherwise wait for it to be finalized.                          */
 /* -------------------------------------------------------------------- */
-    GDALRasterPolygonEnumerator oSecondEnum( nConnectedness );
+    if( nOpen >= 0 )
+    {
+        const GPPolygon &oOpen = asPolys[nOpen];
+        if( !bSeveralOpen
+            && (nBest < 0
+                || oOpen.nSize > asPolys[nBest].nSize
+                || (oOpen.nSize == asPolys[nBest].nSize
+                    && nOpenOrder < nBestOrder))
+            && oOpen.nSize >= nSizeThreshold )
+        {
+            nBest = nOpen;
+        }
+        else
+        {
+            GPWaiter sWaiter;
+            sWaiter.nPoly = nPoly;
+            asPolys[nPoly].bPending = true;
+            GPListAppend( asWaiterPool, asPolys[nOpen].sWaiting, sWaiter );
+            return;
+        }
+    }
 
-    std::vector<int> anBigNeighbour;
-    anBigNeighbour.resize( anPolySizes.size() );
+    GPPolygon &oPoly = asPolys[nPoly];
+    oPoly.bPending = false;
 
-    for( iPoly = 0; iPoly < (int) anPolySizes.size(); iPoly++ )
-        anBigNeighbour[iPoly] = -1;
+    if( nBest < 0 )
+        nIsolatedSmall++;
+    else if( asPolys[nBest].nSize < nSizeThreshold )
+        nFailedMerges++;
+    else
+    {
+        for( int i = oPoly.sPieceKeys.nHead; i >= 0;
+             i = asPieceKeyPool[i].nNext )
+        {
+            GPDecision sDecision;
+            sDecision.nKey = asPieceKeyPool[i].nKey;
+            sDecision.nValue = asPolys[nBest].nValue;
+            asDecisions.push_back( sDecision );
+        }
+    }
 
-/* ==================================================================== */
-/*      Second pass ... identify the largest neighbour for each         */
-/*      polygon.                                                        */
-/* ==================================================================== */
-    for( iY = 0; eErr == CE_None && iY < nYSize; iY++ )
+    oPoly.sContacts = sGPEmptyList;
+    oPoly.sPieceKeys = sGPEmptyList;
+}
+
+/************************************************************************/
+/*                             Finalize()                               */
+/************************************************************************/
+
+void GPSieveMerger::Finalize( int nPoly )
+
+{
+    GPPolygon *psPoly = &asPolys[nPoly];
+
+    psPoly->bOpen = false;
+    psPoly->bDone = true;
+
+    if( psPoly->nSize < nSizeThreshold )
     {
+        nSieveTargets++;
+        Decide( nPoly );
+    }
+
 /* -------------------------------------------------------------------- */
-/*      Read the image data.                                            */
+/*      Reconsider the polygons that were waiting on this one.          */
+/*      The list is detached first, as Decide() may grow the pool.      */
 /* -------------------------------------------------------------------- */
-        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iY, nXSize, 1, 
-                             panThisLineVal, nXSize, 1, GDT_Int32, 0, 0 );
+    int iWaiter = asPolys[nPoly].sWaiting.nHead;
+    asPolys[nPoly].sWaiting = sGPEmptyList;
+
+    for( ; iWaiter >= 0; iWaiter = asWaiterPool[iWaiter].nNext )
+    {
+        const int nWaiting = asWaiterPool[iWaiter].nPoly;
+        if( asPolys[nWaiting].bPending )
+            Decide( nWaiting );
+    }
+}
+
+/************************************************************************/
+/*                             AddStripe()                              */
+/************************************************************************/
 
-        if( eErr == CE_None && hMaskBand != NULL )
-            eErr = GPMaskImageData( hMaskBand, pabyMaskLine, iY, nXSize, panThisLineVal );
+void GPSieveMerger::AddStripe( const GPStripe *psStripe )
 
-        if( eErr != CE_None )
-            continue;
+{
+    const int nBase = (int) asPolys.size();
+    const std::vector<GPPiece> &asPieces = psStripe->asPieces;
+    const int nPieces = (int) asPieces.size();
+    int iPiece, iX;
 
 /* -------------------------------------------------------------------- */
-/*      Determine what polygon the various pixels belong to (redoing    */
-/*      the same thing done in the first pass above).                   */
+/*      Create a polygon for each piece.                                */
 /* -------------------------------------------------------------------- */
-        if( iY == 0 )
-            oSecondEnum.ProcessLine( 
-                NULL, panThisLineVal, NULL, panThisLineId, nXSize );
-        else
-            oSecondEnum.ProcessLine(
-                panLastLineVal, panThisLineVal, 
-                panLastLineId,  panThisLineId, 
-                nXSize );
+    asPolys.resize( nBase + nPieces );
+    for( iPiece = 0; iPiece < nPieces; iPiece++ )
+    {
+        GPPolygon &oPoly = asPolys[nBase + iPiece];
+        oPoly.nParent = nBase + iPiece;
+        oPoly.nValue = asPieces[iPiece].nValue;
+        oPoly.nSize = asPieces[iPiece].nSize;
+        oPoly.bOpen = false;
+        oPoly.bDone = false;
+        oPoly.bPending = false;
+        oPoly.sContacts = sGPEmptyList;
+        oPoly.sPieceKeys = sGPEmptyList;
+        oPoly.sWaiting = sGPEmptyList;
+        if( oPoly.nSize < nSizeThreshold )
+        {
+            GPPieceKey sKey;
+            sKey.nKey = asPieces[iPiece].nKey;
+            GPListAppend( asPieceKeyPool, oPoly.sPieceKeys, sKey );
+        }
+    }
+
+    for( size_t i = 0; i < psStripe->asContacts.size(); i++ )
+    {
+        const GPPieceContact &sPieceContact = psStripe->asContacts[i];
+        GPContact sContact;
+        sContact.nOther = nBase + sPieceContact.nOther;
+        sContact.nOrder = sPieceContact.nOrder;
+        GPListAppend( asContactPool,
+                      asPolys[nBase + sPieceContact.nPiece].sContacts,
+                      sContact );
+    }
 
 /* -------------------------------------------------------------------- */
-/*      Check our neighbours, and update our biggest neighbour map      */
-/*      as appropriate.                                                 */
+/*      Join with the last line of the previous stripe.                 */
 /* -------------------------------------------------------------------- */
+    if( !anBottomId.empty() )
+    {
+        const GIntBig nFirstPixel = (GIntBig)psStripe->nYOff * nXSize;
+
         for( iX = 0; iX < nXSize; iX++ )
         {
-            if( iY > 0 )
+            const int nPiece = psStripe->panLabel[iX];
+            if( nPiece < 0 )
+                continue;
+
+            for( int nRank = 0; nRank < 3; nRank++ )
             {
-                CompareNeighbour( panThisLineId[iX], 
-                                  panLastLineId[iX],
-                                  oFirstEnum.panPolyIdMap,
-                                  oFirstEnum.panPolyValue,
-                                  anPolySizes, anBigNeighbour );
-
-                if( iX > 0 && nConnectedness == 8 )
-                    CompareNeighbour( panThisLineId[iX], 
-                                      panLastLineId[iX-1],
-                                      oFirstEnum.panPolyIdMap,
-                                      oFirstEnum.panPolyValue,
-                                      anPolySizes, anBigNeighbour );
-                    
-                if( iX < nXSize-1 && nConnectedness == 8 )
-                    CompareNeighbour( panThisLineId[iX], 
-                                      panLastLineId[iX+1],
-                                      oFirstEnum.panPolyIdMap,
-                                      oFirstEnum.panPolyValue,
-                                      anPolySizes, anBigNeighbour );
-                    
+                int iOtherX = iX;
+                if( nRank > 0 && nConnectedness != 8 )
+                    break;
+                if( nRank == 1 )
+                    iOtherX = iX - 1;
+                else if( nRank == 2 )
+                    iOtherX = iX + 1;
+                if( iOtherX < 0 || iOtherX >= nXSize
+                    || anBottomId[iOtherX] < 0 )
+                    continue;
+
+                if( anBottomVal[iOtherX] == psStripe->panVal[iX] )
+                    Union( nBase + nPiece, anBottomId[iOtherX] );
+                else
+                    AddContact( nBase + nPiece, anBottomId[iOtherX],
+                                GPContactOrder( nFirstPixel + iX, nRank ) );
             }
-            
-            if( iX > 0 )
-                CompareNeighbour( panThisLineId[iX], 
-                                  panThisLineId[iX-1],
-                                  oFirstEnum.panPolyIdMap,
-                                  oFirstEnum.panPolyValue,
-                                  anPolySizes, anBigNeighbour );
-
-            // We don't need to compare to next pixel or next line
-            // since they will be compared to us.
-        }                     
+        }
+    }
 
 /* -------------------------------------------------------------------- */
-/*      Swap pixel value, and polygon id lines to be ready for the      */
-/*      next line.                                                      */
+/*      Update the set of polygons reaching the last line, and          */
+/*      finalize the others.                                            */
 /* -------------------------------------------------------------------- */
-        GInt32 *panTmp = panLastLineVal;
-        panLastLineVal = panThisLineVal;
-        panThisLineVal = panTmp;
+    std::vector<int> anCandidates;
+    size_t i;
 
-        panTmp = panThisLineId;
-        panThisLineId = panLastLineId;
-        panLastLineId = panTmp;
+    for( i = 0; i < anOpen.size(); i++ )
+    {
+        int nPoly = Find( anOpen[i] );
+        asPolys[nPoly].bOpen = false;
+        anCandidates.push_back( nPoly );
+    }
+    anOpen.resize( 0 );
 
-/* -------------------------------------------------------------------- */
-/*      Report progress, and support interrupts.                        */
-/* -------------------------------------------------------------------- */
-        if( eErr == CE_None 
-            && !pfnProgress( 0.25 + 0.25 * ((iY+1) / (double) nYSize), 
-                             "", pProgressArg ) )
+    for( iPiece = 0; iPiece < nPieces; iPiece++ )
+    {
+        int nPoly = Find( nBase + iPiece );
+        if( asPieces[iPiece].bTouchesBottom && !asPolys[nPoly].bOpen )
         {
-            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-            eErr = CE_Failure;
+            asPolys[nPoly].bOpen = true;
+            anOpen.push_back( nPoly );
         }
+        anCandidates.push_back( nPoly );
+    }
+
+    for( i = 0; i < anCandidates.size(); i++ )
+    {
+        const GPPolygon &oPoly = asPolys[anCandidates[i]];
+        if( !oPoly.bOpen && !oPoly.bDone )
+            Finalize( anCandidates[i] );
     }
 
 /* -------------------------------------------------------------------- */
-/*      If our biggest neighbour is still smaller than the              */
-/*      threshold, then try tracking to that polygons biggest           */
-/*      neighbour, and so forth.                                        */
+/*      Remember the last line.                                         */
 /* -------------------------------------------------------------------- */
-    int nFailedMerges = 0;
-    int nIsolatedSmall = 0;
-    int nSieveTargets = 0;
+    const size_t nLastLine = (size_t)(psStripe->nLines - 1) * nXSize;
 
-    for( iPoly = 0; iPoly < (int) anPolySizes.size(); iPoly++ )
+    anBottomVal.resize( nXSize );
+    anBottomId.resize( nXSize );
+    for( iX = 0; iX < nXSize; iX++ )
     {
-        if( oFirstEnum.panPolyIdMap[iPoly] != iPoly )
-            continue;
+        const int nPiece = psStripe->panLabel[nLastLine + iX];
+        anBottomVal[iX] = psStripe->panVal[nLastLine + iX];
+        anBottomId[iX] = (nPiece < 0) ? -1 : Find( nBase + nPiece );
+    }
 
-        // Ignore nodata polygons. 
-        if( oFirstEnum.panPolyValue[iPoly] == GP_NODATA_MARKER )
-            continue;
+    const size_t nNodes = asContactPool.size() + asPieceKeyPool.size()
+        + asWaiterPool.size();
+    if( asPolys.size() > MAX(2 * nPolysAfterCompaction,
+                             (size_t)GP_COMPACT_MIN_ITEMS)
+        || nNodes > MAX(2 * nNodesAfterCompaction,
+                        (size_t)GP_COMPACT_MIN_ITEMS) )
+        Compact();
+}
 
-        // Don't try to merge polygons larger than the threshold.
-        if( anPolySizes[iPoly] >= nSizeThreshold )
-        {
-            anBigNeighbour[iPoly] = -1;
-            continue;
-        }
+/************************************************************************/
+/*                              Compact()                               */
+/*                                                                      */
+/*      Drop the polygons that are finalized, and no longer             */
+/*      referenced by a polygon that can still be sieved, and the       */
+/*      list nodes that are no longer used.                             */
+/************************************************************************/
 
-        nSieveTargets++;
+void GPSieveMerger::Compact()
 
-        // if we have no neighbours but we are small, what shall we do?
-        if( anBigNeighbour[iPoly] == -1 )
-        {
-            nIsolatedSmall++;
-            continue;
-        }
+{
+    const int nPolys = (int) asPolys.size();
+    std::vector<int> anRemap( nPolys, -1 );
+    std::vector<int> anLive;
+    int iPoly;
+    size_t i;
 
-        // If our biggest neighbour is larger than the threshold
-        // then we are golden. 
-        if( anPolySizes[anBigNeighbour[iPoly]] >= nSizeThreshold )
+    for( iPoly = 0; iPoly < nPolys; iPoly++ )
+    {
+        const GPPolygon &oPoly = asPolys[iPoly];
+        if( oPoly.nParent != iPoly || !(oPoly.bOpen || oPoly.bPending) )
             continue;
 
-#ifdef notdef
-        // Will our neighbours biggest neighbour do?  
-        // Eventually we need something sort of recursive here with
-        // loop detection.
-        if( anPolySizes[anBigNeighbour[anBigNeighbour[iPoly]]] 
-            >= nSizeThreshold )
+        if( anRemap[iPoly] < 0 )
         {
-            anBigNeighbour[iPoly] = anBigNeighbour[anBigNeighbour[iPoly]];
-            continue;
+            anRemap[iPoly] = (int) anLive.size();
+            anLive.push_back( iPoly );
+        }
+        for( int iContact = oPoly.sContacts.nHead; iContact >= 0;
+             iContact = asContactPool[iContact].nNext )
+        {
+            int nOther = Find( asContactPool[iContact].nOther );
+            if( anRemap[nOther] < 0 )
+            {
+                anRemap[nOther] = (int) anLive.size();
+                anLive.push_back( nOther );
+            }
         }
-#endif
+    }
 
-        nFailedMerges++;
-        anBigNeighbour[iPoly] = -1;
-    }									
+    std::vector<GPPolygon>  asNewPolys( anLive.size() );
+    std::vector<GPContact>  asNewContactPool;
+    std::vector<GPPieceKey> asNewPieceKeyPool;
+    std::vector<GPWaiter>   asNewWaiterPool;
 
-    CPLDebug( "GDALSieveFilter", 
-              "Small Polygons: %d, Isolated: %d, Unmergable: %d",
-              nSieveTargets, nIsolatedSmall, nFailedMerges );
+    for( i = 0; i < anLive.size(); i++ )
+    {
+        const GPPolygon &oOld = asPolys[anLive[i]];
+        GPPolygon &oNew = asNewPolys[i];
+
+        oNew.nParent = (int) i;
+        oNew.nValue = oOld.nValue;
+        oNew.nSize = oOld.nSize;
+        oNew.bOpen = oOld.bOpen;
+        oNew.bDone = oOld.bDone;
+        oNew.bPending = oOld.bPending;
+        oNew.sContacts = GPListCopy( asContactPool, oOld.sContacts,
+                                     asNewContactPool );
+        oNew.sPieceKeys = GPListCopy( asPieceKeyPool, oOld.sPieceKeys,
+                                      asNewPieceKeyPool );
+        oNew.sWaiting = GPListCopy( asWaiterPool, oOld.sWaiting,
+                                    asNewWaiterPool );
+
+        for( int j = oNew.sContacts.nHead; j >= 0;
+             j = asNewContactPool[j].nNext )
+            asNewContactPool[j].nOther =
+                anRemap[Find( asNewContactPool[j].nOther )];
+        for( int j = oNew.sWaiting.nHead; j >= 0;
+             j = asNewWaiterPool[j].nNext )
+            asNewWaiterPool[j].nPoly = anRemap[asNewWaiterPool[j].nPoly];
+    }
 
-/* ==================================================================== */
-/*      Make a third pass over the image, actually applying the         */
-/*      merges.  We reuse the second enumerator but preserve the        */
-/*      "final maps" from the first.                                    */
-/* ==================================================================== */
-    oSecondEnum.Clear();
-    
+    for( i = 0; i < anOpen.size(); i++ )
+        anOpen[i] = anRemap[Find( anOpen[i] )];
+    for( i = 0; i < anBottomId.size(); i++ )
+    {
+        if( anBottomId[i] >= 0 )
+            anBottomId[i] = anRemap[Find( anBottomId[i] )];
+    }
+
+    asPolys.swap( asNewPolys );
+    asContactPool.swap( asNewContactPool );
+    asPieceKeyPool.swap( asNewPieceKeyPool );
+    asWaiterPool.swap( asNewWaiterPool );
+
+    nPolysAfterCompaction = asPolys.size();
+    nNodesAfterCompaction = asContactPool.size() + asPieceKeyPool.size()
+        + asWaiterPool.size();
+}
+
+/************************************************************************/
+/*                               Finish()                               */
+/************************************************************************/
+
+void GPSieveMerger::Finish()
 
-    for( iY = 0; eErr == CE_None && iY < nYSize; iY++ )
+{
+    size_t i;
+
+    for( i = 0; i < anOpen.size(); i++ )
+        asPolys[Find( anOpen[i] )].bOpen = false;
+
+    for( i = 0; i < anOpen.size(); i++ )
     {
-/* -------------------------------------------------------------------- */
-/*      Read the image data.                                            */
-/* -------------------------------------------------------------------- */
-        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iY, nXSize, 1, 
-                             panThisLineVal, nXSize, 1, GDT_Int32, 0, 0 );
+        int nPoly = Find( anOpen[i] );
+        if( !asPolys[nPoly].bDone )
+            Finalize( nPoly );
+    }
+    anOpen.resize( 0 );
 
-        memcpy( panThisLineWriteVal, panThisLineVal, 4 * nXSize );
+    std::sort( asDecisions.begin(), asDecisions.end(), GPDecisionLess );
+}
 
-        if( eErr == CE_None && hMaskBand != NULL )
-            eErr = GPMaskImageData( hMaskBand, pabyMaskLine, iY, nXSize, panThisLineVal );
+/************************************************************************/
+/*                          GPProcessStripes()                          */
+/*                                                                      */
+/*      Read the raster by stripes, nThreads of them being labelled     */
+/*      at a time.  On the first pass, stripes are merged with          */
+/*      poMerger.  On the final pass (poMerger == NULL), poDecisions    */
+/*      are applied and the stripes written to hDstBand.                */
+/************************************************************************/
 
-        if( eErr != CE_None )
-            continue;
+static CPLErr GPProcessStripes( GDALRasterBandH hSrcBand,
+                                GDALRasterBandH hMaskBand,
+                                GDALRasterBandH hDstBand,
+                                std::vector<GPStripe> &asStripes,
+                                int nStripeLines,
+                                GPSieveMerger *poMerger,
+                                const std::vector<GPDecision> *poDecisions,
+                                double dfProgressStart, double dfProgressEnd,
+                                GDALProgressFunc pfnProgress,
+                                void * pProgressArg )
+
+{
+    const int nXSize = GDALGetRasterBandXSize( hSrcBand );
+    const int nYSize = GDALGetRasterBandYSize( hSrcBand );
+    const int nThreads = (int) asStripes.size();
+    const int nStripes = (nYSize + nStripeLines - 1) / nStripeLines;
+    const int bApply = (poMerger == NULL);
+    CPLErr eErr = CE_None;
+    int iFirstStripe, iJob;
+
+    for( iFirstStripe = 0; iFirstStripe < nStripes && eErr == CE_None;
+         iFirstStripe += nThreads )
+    {
+        int nJobs = MIN(nThreads, nStripes - iFirstStripe);
 
 /* -------------------------------------------------------------------- */
-/*      Determine what polygon the various pixels belong to (redoing    */
-/*      the same thing done in the first pass above).                   */
+/*      Read the stripes.                                               */
 /* -------------------------------------------------------------------- */
-        if( iY == 0 )
-            oSecondEnum.ProcessLine( 
-                NULL, panThisLineVal, NULL, panThisLineId, nXSize );
-        else
-            oSecondEnum.ProcessLine(
-                panLastLineVal, panThisLineVal, 
-                panLastLineId,  panThisLineId, 
-                nXSize );
+        for( iJob = 0; iJob < nJobs && eErr == CE_None; iJob++ )
+        {
+            GPStripe *psStripe = &asStripes[iJob];
+
+            psStripe->nYOff = (iFirstStripe + iJob) * nStripeLines;
+            psStripe->nLines = MIN(nStripeLines, nYSize - psStripe->nYOff);
+            psStripe->bApply = bApply;
+            psStripe->hThread = NULL;
+
+            eErr = GDALRasterIO( hSrcBand, GF_Read,
+                                 0, psStripe->nYOff, nXSize, psStripe->nLines,
+                                 psStripe->panRawVal, nXSize, psStripe->nLines,
+                                 GDT_Int32, 0, 0 );
+            if( eErr != CE_None )
+                break;
+
+            memcpy( psStripe->panVal, psStripe->panRawVal,
+                    sizeof(GInt32) * nXSize * psStripe->nLines );
+            if( hMaskBand != NULL )
+                eErr = GPMaskImageData( hMaskBand, psStripe->pabyMask,
+                                        psStripe->nYOff, nXSize,
+                                        psStripe->nLines, psStripe->panVal );
+
+            if( bApply && !poDecisions->empty() )
+            {
+                GPDecision sFirst, sEnd;
+                sFirst.nKey = (GIntBig)psStripe->nYOff * nXSize;
+                sEnd.nKey = sFirst.nKey + (GIntBig)psStripe->nLines * nXSize;
+                sFirst.nValue = sEnd.nValue = 0;
+
+                const GPDecision *pasBegin = &((*poDecisions)[0]);
+                const GPDecision *pasEnd = pasBegin + poDecisions->size();
+                const GPDecision *pasFirst =
+                    std::lower_bound( pasBegin, pasEnd, sFirst, GPDecisionLess );
+                psStripe->pasDecisions = pasFirst;
+                psStripe->nDecisions = (int)
+                    (std::lower_bound( pasFirst, pasEnd, sEnd, GPDecisionLess )
+                     - pasFirst);
+            }
+            else
+            {
+                psStripe->pasDecisions = NULL;
+                psStripe->nDecisions = 0;
+            }
+        }
+        if( eErr != CE_None )
+            break;
 
 /* -------------------------------------------------------------------- */
-/*      Reprocess the actual pixel values according to the polygon      */
-/*      merging, and write out this line of image data.                 */
+/*      Label them.                                                     */
 /* -------------------------------------------------------------------- */
-        for( iX = 0; iX < nXSize; iX++ )
+        if( nJobs == 1 )
+            GPProcessStripeFunc( &asStripes[0] );
+        else
         {
-            int iThisPoly = oFirstEnum.panPolyIdMap[panThisLineId[iX]];
-
-            if( anBigNeighbour[iThisPoly] != -1 )
+            for( iJob = 0; iJob < nJobs; iJob++ )
+                asStripes[iJob].hThread =
+                    CPLCreateJoinableThread( GPProcessStripeFunc,
+                                             &asStripes[iJob] );
+            for( iJob = 0; iJob < nJobs; iJob++ )
             {
-                panThisLineWriteVal[iX] = 
-                    oFirstEnum.panPolyValue[
-                        anBigNeighbour[iThisPoly]];
+                if( asStripes[iJob].hThread != NULL )
+                    CPLJoinThread( asStripes[iJob].hThread );
+                else
+                    GPProcessStripeFunc( &asStripes[iJob] );
             }
         }
 
 /* -------------------------------------------------------------------- */
-/*      Write the update data out.                                      */
+/*      Merge or write them, in order.                                  */
 /* -------------------------------------------------------------------- */
-        eErr = GDALRasterIO( hDstBand, GF_Write, 0, iY, nXSize, 1, 
-                             panThisLineWriteVal, nXSize, 1, GDT_Int32, 0, 0 );
+        for( iJob = 0; iJob < nJobs && eErr == CE_None; iJob++ )
+        {
+            GPStripe *psStripe = &asStripes[iJob];
+
+            if( poMerger != NULL )
+                poMerger->AddStripe( psStripe );
+            else
+                eErr = GDALRasterIO( hDstBand, GF_Write,
+                                     0, psStripe->nYOff, nXSize,
+                                     psStripe->nLines,
+                                     psStripe->panRawVal, nXSize,
+                                     psStripe->nLines, GDT_Int32, 0, 0 );
+
+            if( eErr == CE_None
+                && !pfnProgress( dfProgressStart
+                                 + (dfProgressEnd - dfProgressStart)
+                                 * (psStripe->nYOff + psStripe->nLines)
+                                 / (double) nYSize,
+                                 "", pProgressArg ) )
+            {
+                CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+                eErr = CE_Failure;
+            }
+        }
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                          GDALSieveFilter()                           */
+/************************************************************************/
+
+/** 
+ * Removes small raster polygons. 
+ *
+ * The function removes raster polygons smaller than a provided
+ * threshold size (in pixels) and replaces replaces them with the pixel value 
+ * of the largest neighbour polygon.  
+ *
+ * Polygon are determined (per GDALRasterPolygonEnumerator) as regions of
+ * the raster where the pixels all have the same value, and that are contiguous
+ * (connected).  
+ *
+ * Pixels determined to be "nodata" per hMaskBand will not be treated as part
+ * of a polygon regardless of their pixel values.  Nodata areas will never be
+ * changed nor affect polygon sizes. 
+ *
+ * Polygons smaller than the threshold with no neighbours that are as large
+ * as the threshold will not be altered.  Polygons surrounded by nodata areas
+ * will therefore not be altered.  
+ *
+ * The algorithm makes two passes over the input file, by stripes of lines.
+ * Polygons are labelled with a union-find structure and are finalized as
+ * soon as they can no longer grow, so memory use is proportional to the
+ * number of polygons crossing the current stripe, plus the small polygons
+ * waiting for the final size of a neighbour, rather than to the total
+ * number of polygons.  Very large, noisy rasters can thus be processed.
+ * 
+ * @param hSrcBand the source raster band to be processed.
+ * @param hMaskBand an optional mask band.  All pixels in the mask band with a 
+ * value other than zero will be considered suitable for inclusion in polygons.
+ * @param hDstBand the output raster band.  It may be the same as hSrcBand
+ * to update the source in place. 
+ * @param nSizeThreshold raster polygons with sizes smaller than this will
+ * be merged into their largest neighbour.
+ * @param nConnectedness either 4 indicating that diagonal pixels are not
+ * considered directly adjacent for polygon membership purposes or 8
+ * indicating they are. 
+ * @param papszOptions algorithm options in name=value list form.  The
+ * following option is supported:
+ * <ul>
+ * <li>NUM_THREADS=number_of_threads or ALL_CPUS: number of stripes labelled
+ * in parallel.  Defaults to the value of the GDAL_NUM_THREADS configuration
+ * option, or 1.</li>
+ * </ul>
+ * @param pfnProgress callback for reporting algorithm progress matching the
+ * GDALProgressFunc() semantics.  May be NULL.
+ * @param pProgressArg callback argument passed to pfnProgress.
+ *
+ * @return CE_None on success or CE_Failure if an error occurs.
+ */
+
+CPLErr CPL_STDCALL
+GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
+                 GDALRasterBandH hDstBand,
+                 int nSizeThreshold, int nConnectedness,
+                 char **papszOptions,
+                 GDALProgressFunc pfnProgress,
+                 void * pProgressArg )
+{
+    VALIDATE_POINTER1( hSrcBand, "GDALSieveFilter", CE_Failure );
+    VALIDATE_POINTER1( hDstBand, "GDALSieveFilter", CE_Failure );
+
+    if( pfnProgress == NULL )
+        pfnProgress = GDALDummyProgress;
+
+    int nXSize = GDALGetRasterBandXSize( hSrcBand );
+    int nYSize = GDALGetRasterBandYSize( hSrcBand );
 
 /* -------------------------------------------------------------------- */
-/*      Swap pixel value, and polygon id lines to be ready for the      */
-/*      next line.                                                      */
+/*      Decide on the number of threads and the stripe height.          */
 /* -------------------------------------------------------------------- */
-        GInt32 *panTmp = panLastLineVal;
-        panLastLineVal = panThisLineVal;
-        panThisLineVal = panTmp;
+    const char* pszThreads = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    if( pszThreads == NULL )
+        pszThreads = CPLGetConfigOption( "GDAL_NUM_THREADS", "1" );
 
-        panTmp = panThisLineId;
-        panThisLineId = panLastLineId;
-        panLastLineId = panTmp;
+    int nThreads;
+    if( EQUAL(pszThreads, "ALL_CPUS") )
+        nThreads = CPLGetNumCPUs();
+    else
+        nThreads = atoi(pszThreads);
+    nThreads = MAX(1, MIN(128, nThreads));
+
+    int nStripeLines = MAX(GP_MIN_STRIPE_LINES, GP_STRIPE_PIXELS / nXSize);
+    nStripeLines = MIN(nStripeLines, nYSize);
+
+    int nStripes = (nYSize + nStripeLines - 1) / nStripeLines;
+    nThreads = MIN(nThreads, nStripes);
 
 /* -------------------------------------------------------------------- */
-/*      Report progress, and support interrupts.                        */
+/*      Allocate working buffers.                                       */
 /* -------------------------------------------------------------------- */
-        if( eErr == CE_None 
-            && !pfnProgress( 0.5 + 0.5 * ((iY+1) / (double) nYSize), 
-                             "", pProgressArg ) )
+    CPLErr eErr = CE_None;
+    std::vector<GPStripe> asStripes( nThreads );
+    int iStripe;
+
+    for( iStripe = 0; iStripe < nThreads; iStripe++ )
+    {
+        GPStripe *psStripe = &asStripes[iStripe];
+
+        psStripe->nXSize = nXSize;
+        psStripe->nConnectedness = nConnectedness;
+        psStripe->nSizeThreshold = nSizeThreshold;
+        psStripe->panRawVal = (GInt32 *)
+            VSIMalloc3( sizeof(GInt32), nXSize, nStripeLines );
+        psStripe->panVal = (GInt32 *)
+            VSIMalloc3( sizeof(GInt32), nXSize, nStripeLines );
+        psStripe->panLabel = (GInt32 *)
+            VSIMalloc3( sizeof(GInt32), nXSize, nStripeLines );
+        psStripe->pabyMask = (hMaskBand != NULL) ?
+            (GByte *) VSIMalloc2( nXSize, nStripeLines ) : NULL;
+        psStripe->pasDecisions = NULL;
+        psStripe->nDecisions = 0;
+
+        if( psStripe->panRawVal == NULL || psStripe->panVal == NULL
+            || psStripe->panLabel == NULL
+            || (hMaskBand != NULL && psStripe->pabyMask == NULL) )
         {
-            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "Could not allocate enough memory for temporary buffers");
             eErr = CE_Failure;
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      First pass: find the polygons, and the ones to be merged.       */
+/* -------------------------------------------------------------------- */
+    GPSieveMerger oMerger( nXSize, nConnectedness, nSizeThreshold );
+
+    if( eErr == CE_None )
+        eErr = GPProcessStripes( hSrcBand, hMaskBand, hDstBand,
+                                 asStripes, nStripeLines, &oMerger, NULL,
+                                 0.0, 0.5, pfnProgress, pProgressArg );
+
+    if( eErr == CE_None )
+    {
+        oMerger.Finish();
+
+        CPLDebug( "GDALSieveFilter", 
+                  "Small Polygons: %d, Isolated: %d, Unmergable: %d",
+                  oMerger.nSieveTargets, oMerger.nIsolatedSmall,
+                  oMerger.nFailedMerges );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Second pass: apply the merges.                                  */
+/* -------------------------------------------------------------------- */
+    if( eErr == CE_None )
+        eErr = GPProcessStripes( hSrcBand, hMaskBand, hDstBand,
+                                 asStripes, nStripeLines, NULL,
+                                 &oMerger.asDecisions,
+                                 0.5, 1.0, pfnProgress, pProgressArg );
+
 /* -------------------------------------------------------------------- */
 /*      Cleanup                                                         */
 /* -------------------------------------------------------------------- */
-    CPLFree( panThisLineId );
-    CPLFree( panLastLineId );
-    CPLFree( panThisLineVal );
-    CPLFree( panLastLineVal );
-    CPLFree( panThisLineWriteVal );
-    CPLFree( pabyMaskLine );
+    for( iStripe = 0; iStripe < nThreads; iStripe++ )
+    {
+        CPLFree( asStripes[iStripe].panRawVal );
+        CPLFree( asStripes[iStripe].panVal );
+        CPLFree( asStripes[iStripe].panLabel );
+        CPLFree( asStripes[iStripe].pabyMask );
+    }
 
     return eErr;
 }
@@ -0,0 +1,784 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Compute per-zone statistics of a raster band, the zones being
+ *           the features of a vector layer.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <vector>
+#include <algorithm>
+
+#include "gdal_alg.h"
+#include "gdal_alg_priv.h"
+#include "gdal_priv.h"
+#include "ogr_geometry.h"
+#include "ogr_spatialref.h"
+#include "cpl_multiproc.h"
+#include "cpl_quad_tree.h"
+
+#ifdef OGR_ENABLED
+#include "ogrsf_frmts.h"
+#endif
+
+CPL_CVSID("$Id$");
+
+#ifdef OGR_ENABLED
+
+/************************************************************************/
+/*                            GDALZSZone                                */
+/*                                                                      */
+/*      A zone, with its rings already transformed into the             */
+/*      pixel/line space of the raster band.                            */
+/************************************************************************/
+
+typedef struct
+{
+    int                 iZone;
+    GIntBig             nFID;
+    OGRwkbGeometryType  eFlatType;
+    std::vector<int>    anPartSize;
+    std::vector<double> adfX;
+    std::vector<double> adfY;
+    CPLRectObj          sBounds;
+} GDALZSZone;
+
+static void GDALZSZoneGetBounds( const void* hFeature, CPLRectObj* pBounds )
+{
+    *pBounds = ((const GDALZSZone*) hFeature)->sBounds;
+}
+
+/************************************************************************/
+/*                        GDALZSAccumulator                             */
+/*                                                                      */
+/*      Per-thread running statistics of all the zones.                 */
+/************************************************************************/
+
+typedef struct
+{
+    GUIntBig    nCount;
+    double      dfSum;
+    double      dfMin;
+    double      dfMax;
+} GDALZSAccumulator;
+
+/************************************************************************/
+/*                             GDALZSJob                                */
+/************************************************************************/
+
+typedef struct
+{
+    /* Shared, read-only */
+    std::vector<GDALZSZone*>   *papoZones;
+    CPLQuadTree                *hQuadTree;
+    int                         bAllTouched;
+    int                         nBuckets;
+    double                      dfHistMin;
+    double                      dfHistScale;
+
+    /* Current chunk */
+    int                         nXOff;
+    int                         nYOff;
+    int                         nXSize;
+    int                         nYSize;
+    double                     *padfValues;
+    GByte                      *pabyMask;   /* NULL if all valid */
+
+    /* Per-thread scratch and results */
+    GInt32                     *panZoneId;
+    std::vector<double>        *padfX;
+    std::vector<double>        *padfY;
+    std::vector<GDALZSAccumulator> *pasAcc;
+    std::vector<GUIntBig>      *panHistogram;
+
+    CPLJoinableThread          *hThread;
+} GDALZSJob;
+
+/************************************************************************/
+/*                     GDALZSBurnScanline/Point()                       */
+/************************************************************************/
+
+typedef struct
+{
+    GInt32     *panZoneId;
+    int         nXSize;
+    int         nYSize;
+    GInt32      nZone;
+} GDALZSBurnInfo;
+
+static void GDALZSBurnScanline( void *pCBData, int nY, int nXStart, int nXEnd,
+                                CPL_UNUSED double dfVariant )
+{
+    GDALZSBurnInfo *psInfo = (GDALZSBurnInfo *) pCBData;
+
+    if( nXStart < 0 )
+        nXStart = 0;
+    if( nXEnd >= psInfo->nXSize )
+        nXEnd = psInfo->nXSize - 1;
+
+    GInt32 *panInsert = psInfo->panZoneId + nY * psInfo->nXSize;
+    for( int nX = nXStart; nX <= nXEnd; nX++ )
+        panInsert[nX] = psInfo->nZone;
+}
+
+static void GDALZSBurnPoint( void *pCBData, int nY, int nX,
+                             CPL_UNUSED double dfVariant )
+{
+    GDALZSBurnInfo *psInfo = (GDALZSBurnInfo *) pCBData;
+
+    psInfo->panZoneId[nY * psInfo->nXSize + nX] = psInfo->nZone;
+}
+
+/************************************************************************/
+/*                         GDALZSCompareZones()                         */
+/************************************************************************/
+
+static bool GDALZSCompareZones( const GDALZSZone* a, const GDALZSZone* b )
+{
+    return a->iZone < b->iZone;
+}
+
+/************************************************************************/
+/*                          GDALZSJobProcess()                          */
+/*                                                                      */
+/*      Rasterize the zone ids of a chunk in memory, and accumulate     */
+/*      the valid pixel values of the chunk into the per-thread         */
+/*      statistics.                                                     */
+/************************************************************************/
+
+static void GDALZSJobProcess( void* pData )
+{
+    GDALZSJob *psJob = (GDALZSJob *) pData;
+    int nPixels = psJob->nXSize * psJob->nYSize;
+    int i;
+
+    for( i = 0; i < nPixels; i++ )
+        psJob->panZoneId[i] = -1;
+
+/* -------------------------------------------------------------------- */
+/*      Find the zones intersecting the chunk, and burn them in         */
+/*      feature order, so later features win, as with                   */
+/*      GDALRasterizeLayers().                                          */
+/* -------------------------------------------------------------------- */
+    CPLRectObj sAoi;
+    sAoi.minx = psJob->nXOff - 1;
+    sAoi.miny = psJob->nYOff - 1;
+    sAoi.maxx = psJob->nXOff + psJob->nXSize + 1;
+    sAoi.maxy = psJob->nYOff + psJob->nYSize + 1;
+
+    int nFeatureCount = 0;
+    GDALZSZone** papoZones = (GDALZSZone**)
+        CPLQuadTreeSearch( psJob->hQuadTree, &sAoi, &nFeatureCount );
+    std::sort( papoZones, papoZones + nFeatureCount, GDALZSCompareZones );
+
+    GDALZSBurnInfo sInfo;
+    sInfo.panZoneId = psJob->panZoneId;
+    sInfo.nXSize = psJob->nXSize;
+    sInfo.nYSize = psJob->nYSize;
+
+    std::vector<double>& adfX = *(psJob->padfX);
+    std::vector<double>& adfY = *(psJob->padfY);
+
+    for( int iFeature = 0; iFeature < nFeatureCount; iFeature++ )
+    {
+        GDALZSZone* psZone = papoZones[iFeature];
+        size_t nPoints = psZone->adfX.size();
+        int nPartCount = (int) psZone->anPartSize.size();
+        int *panPartSize = &(psZone->anPartSize[0]);
+
+        sInfo.nZone = psZone->iZone;
+
+        adfX.resize( nPoints );
+        adfY.resize( nPoints );
+        for( size_t j = 0; j < nPoints; j++ )
+        {
+            adfX[j] = psZone->adfX[j] - psJob->nXOff;
+            adfY[j] = psZone->adfY[j] - psJob->nYOff;
+        }
+
+        switch( psZone->eFlatType )
+        {
+          case wkbPoint:
+          case wkbMultiPoint:
+            GDALdllImagePoint( sInfo.nXSize, sInfo.nYSize,
+                               nPartCount, panPartSize,
+                               &adfX[0], &adfY[0], NULL,
+                               GDALZSBurnPoint, &sInfo );
+            break;
+
+          case wkbLineString:
+          case wkbMultiLineString:
+            if( psJob->bAllTouched )
+                GDALdllImageLineAllTouched( sInfo.nXSize, sInfo.nYSize,
+                                            nPartCount, panPartSize,
+                                            &adfX[0], &adfY[0], NULL,
+                                            GDALZSBurnPoint, &sInfo );
+            else
+                GDALdllImageLine( sInfo.nXSize, sInfo.nYSize,
+                                  nPartCount, panPartSize,
+                                  &adfX[0], &adfY[0], NULL,
+                                  GDALZSBurnPoint, &sInfo );
+            break;
+
+          default:
+            GDALdllImageFilledPolygon( sInfo.nXSize, sInfo.nYSize,
+                                       nPartCount, panPartSize,
+                                       &adfX[0], &adfY[0], NULL,
+                                       GDALZSBurnScanline, &sInfo );
+            if( psJob->bAllTouched )
+                GDALdllImageLineAllTouched( sInfo.nXSize, sInfo.nYSize,
+                                            nPartCount, panPartSize,
+                                            &adfX[0], &adfY[0], NULL,
+                                            GDALZSBurnPoint, &sInfo );
+            break;
+        }
+    }
+
+    CPLFree( papoZones );
+
+    if( nFeatureCount == 0 )
+        return;
+
+/* -------------------------------------------------------------------- */
+/*      Accumulate the statistics.                                      */
+/* -------------------------------------------------------------------- */
+    GDALZSAccumulator* pasAcc = &((*psJob->pasAcc)[0]);
+    GUIntBig* panHistogram = psJob->nBuckets ?
+                                &((*psJob->panHistogram)[0]) : NULL;
+
+    for( i = 0; i < nPixels; i++ )
+    {
+        GInt32 iZone = psJob->panZoneId[i];
+
+        if( iZone < 0 )
+            continue;
+        if( psJob->pabyMask != NULL && psJob->pabyMask[i] == 0 )
+            continue;
+
+        double dfValue = psJob->padfValues[i];
+        if( CPLIsNan(dfValue) )
+            continue;
+
+        GDALZSAccumulator* psAcc = pasAcc + iZone;
+        if( psAcc->nCount == 0 )
+        {
+            psAcc->dfMin = dfValue;
+            psAcc->dfMax = dfValue;
+        }
+        else if( dfValue < psAcc->dfMin )
+            psAcc->dfMin = dfValue;
+        else if( dfValue > psAcc->dfMax )
+            psAcc->dfMax = dfValue;
+        psAcc->nCount ++;
+        psAcc->dfSum += dfValue;
+
+        if( panHistogram != NULL )
+        {
+            double dfIndex = (dfValue - psJob->dfHistMin) * psJob->dfHistScale;
+            if( dfIndex >= 0 && dfIndex < psJob->nBuckets )
+                panHistogram[(size_t)iZone * psJob->nBuckets + (int)dfIndex] ++;
+        }
+    }
+}
+
+/************************************************************************/
+/*                          GDALZSLoadZones()                           */
+/************************************************************************/
+
+static CPLErr GDALZSLoadZones( OGRLayer *poLayer, GDALDatasetH hDS,
+                               std::vector<GDALZSZone*>& apoZones )
+{
+/* -------------------------------------------------------------------- */
+/*      Create a transformer from the layer coordinate system to the    */
+/*      pixel/line space of the raster.                                 */
+/* -------------------------------------------------------------------- */
+    char    *pszProjection = NULL;
+    OGRSpatialReference *poSRS = poLayer->GetSpatialRef();
+
+    if ( !poSRS )
+    {
+        CPLError( CE_Warning, CPLE_AppDefined,
+                  "Failed to fetch spatial reference on layer %s "
+                  "to build transformer, assuming matching coordinate systems.\n",
+                  poLayer->GetLayerDefn()->GetName() );
+    }
+    else
+        poSRS->exportToWkt( &pszProjection );
+
+    void *pTransformArg =
+        GDALCreateGenImgProjTransformer( NULL, pszProjection,
+                                         hDS, NULL, FALSE, 0.0, 0 );
+    CPLFree( pszProjection );
+    if( pTransformArg == NULL )
+        return CE_Failure;
+
+/* -------------------------------------------------------------------- */
+/*      Read the features once.                                         */
+/* -------------------------------------------------------------------- */
+    OGRFeature *poFeat;
+    std::vector<double> adfVariant;
+
+    poLayer->ResetReading();
+
+    while( (poFeat = poLayer->GetNextFeature()) != NULL )
+    {
+        OGRGeometry *poGeom = poFeat->GetGeometryRef();
+        GDALZSZone *psZone = new GDALZSZone;
+
+        psZone->iZone = (int) apoZones.size();
+        psZone->nFID = poFeat->GetFID();
+        psZone->eFlatType = wkbUnknown;
+        psZone->sBounds.minx = psZone->sBounds.miny = 0;
+        psZone->sBounds.maxx = psZone->sBounds.maxy = -1;
+        apoZones.push_back( psZone );
+
+        if( poGeom != NULL )
+        {
+            psZone->eFlatType = wkbFlatten(poGeom->getGeometryType());
+            GDALCollectRingsFromGeometry( poGeom, psZone->adfX, psZone->adfY,
+                                          adfVariant, psZone->anPartSize,
+                                          GBV_UserBurnValue );
+        }
+
+        if( !psZone->adfX.empty() )
+        {
+            int *panSuccess = (int *) CPLCalloc(sizeof(int),
+                                                psZone->adfX.size());
+            GDALGenImgProjTransform( pTransformArg, FALSE,
+                                     (int) psZone->adfX.size(),
+                                     &(psZone->adfX[0]), &(psZone->adfY[0]),
+                                     NULL, panSuccess );
+            CPLFree( panSuccess );
+
+            psZone->sBounds.minx = psZone->sBounds.maxx = psZone->adfX[0];
+            psZone->sBounds.miny = psZone->sBounds.maxy = psZone->adfY[0];
+            for( size_t i = 1; i < psZone->adfX.size(); i++ )
+            {
+                psZone->sBounds.minx = MIN(psZone->sBounds.minx, psZone->adfX[i]);
+                psZone->sBounds.maxx = MAX(psZone->sBounds.maxx, psZone->adfX[i]);
+                psZone->sBounds.miny = MIN(psZone->sBounds.miny, psZone->adfY[i]);
+                psZone->sBounds.maxy = MAX(psZone->sBounds.maxy, psZone->adfY[i]);
+            }
+        }
+
+        delete poFeat;
+    }
+
+    poLayer->ResetReading();
+
+    GDALDestroyGenImgProjTransformer( pTransformArg );
+
+    return CE_None;
+}
+
+#endif /* def OGR_ENABLED */
+
+/************************************************************************/
+/*                     GDALComputeZonalStatistics()                     */
+/************************************************************************/
+
+/**
+ * Compute statistics of a raster band for each feature of a vector layer.
+ *
+ * The features of the zone layer are read once and transformed into the
+ * pixel/line space of the raster band (the layer coordinate system being
+ * reprojected to the one of the raster dataset if needed). The raster band
+ * is then read in a single pass, chunk by chunk following its block layout.
+ * For each chunk, the ids of the zones intersecting it are rasterized in
+ * memory with the same rules as GDALRasterizeLayers(), and the valid pixel
+ * values (according to the mask band of hBand, NaN being always ignored) are
+ * accumulated into the statistics of their zone. Chunks are processed in
+ * parallel when several threads are requested.
+ *
+ * A pixel belongs to a single zone: when zones overlap, the last feature of
+ * the layer wins.
+ *
+ * Supported options:
+ * <ul>
+ * <li>ALL_TOUCHED=YES/NO: whether all pixels touched by the zones are
+ * considered, instead of the ones whose center is within the polygons.
+ * Defaults to NO.</li>
+ * <li>HISTOGRAM_BUCKETS=n: number of buckets of the per-zone histograms.
+ * Defaults to 0 (no histogram).</li>
+ * <li>HISTOGRAM_MIN=val, HISTOGRAM_MAX=val: bounds of the histogram. Values
+ * out of range are not counted. Default to -0.5 and 255.5 for Byte bands,
+ * and must be specified for other data types.</li>
+ * <li>NUM_THREADS=n/ALL_CPUS: number of worker threads. Defaults to the
+ * value of the GDAL_NUM_THREADS configuration option, or 1.</li>
+ * </ul>
+ *
+ * @param hBand the raster band to compute statistics on. It must belong to
+ * a georeferenced dataset.
+ * @param hZoneLayer the layer whose features define the zones.
+ * @param papszOptions list of options, or NULL.
+ * @param pnZoneCount pointer to the number of zones (features of the layer)
+ * returned.
+ * @param ppasStats pointer to the array of *pnZoneCount statistics returned,
+ * in the order of the layer features. To be freed with
+ * GDALDestroyZonalStatistics().
+ * @param pfnProgress the progress function to report completion.
+ * @param pProgressArg callback data for progress function.
+ *
+ * @return CE_None on success or CE_Failure on error.
+ *
+ * @since GDAL 2.0
+ */
+
+CPLErr GDALComputeZonalStatistics( GDALRasterBandH hBand,
+                                   OGRLayerH hZoneLayer,
+                                   char **papszOptions,
+                                   int *pnZoneCount,
+                                   GDALZonalStatistics **ppasStats,
+                                   GDALProgressFunc pfnProgress,
+                                   void *pProgressArg )
+
+{
+    VALIDATE_POINTER1( hBand, "GDALComputeZonalStatistics", CE_Failure );
+    VALIDATE_POINTER1( hZoneLayer, "GDALComputeZonalStatistics", CE_Failure );
+    VALIDATE_POINTER1( pnZoneCount, "GDALComputeZonalStatistics", CE_Failure );
+    VALIDATE_POINTER1( ppasStats, "GDALComputeZonalStatistics", CE_Failure );
+
+    *pnZoneCount = 0;
+    *ppasStats = NULL;
+
+#ifndef OGR_ENABLED
+    CPLError(CE_Failure, CPLE_NotSupported,
+             "GDALComputeZonalStatistics() unimplemented in a non OGR build");
+    return CE_Failure;
+#else
+    GDALRasterBand *poBand = (GDALRasterBand *) hBand;
+    OGRLayer *poLayer = (OGRLayer *) hZoneLayer;
+    GDALDatasetH hDS = (GDALDatasetH) poBand->GetDataset();
+    int nXSize = poBand->GetXSize();
+    int nYSize = poBand->GetYSize();
+
+    if( pfnProgress == NULL )
+        pfnProgress = GDALDummyProgress;
+
+    if( hDS == NULL )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "GDALComputeZonalStatistics(): band must belong to a dataset." );
+        return CE_Failure;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Options.                                                        */
+/* -------------------------------------------------------------------- */
+    int bAllTouched = CSLFetchBoolean( papszOptions, "ALL_TOUCHED", FALSE );
+    int nBuckets = atoi( CSLFetchNameValueDef( papszOptions,
+                                               "HISTOGRAM_BUCKETS", "0" ) );
+    double dfHistMin = -0.5, dfHistMax = 255.5;
+
+    if( nBuckets < 0 )
+        nBuckets = 0;
+    if( nBuckets > 0 )
+    {
+        const char* pszMin = CSLFetchNameValue( papszOptions, "HISTOGRAM_MIN" );
+        const char* pszMax = CSLFetchNameValue( papszOptions, "HISTOGRAM_MAX" );
+
+        if( (pszMin == NULL || pszMax == NULL) &&
+            poBand->GetRasterDataType() != GDT_Byte )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "HISTOGRAM_MIN and HISTOGRAM_MAX must be specified "
+                      "for non Byte bands." );
+            return CE_Failure;
+        }
+        if( pszMin != NULL )
+            dfHistMin = CPLAtof( pszMin );
+        if( pszMax != NULL )
+            dfHistMax = CPLAtof( pszMax );
+        if( !(dfHistMax > dfHistMin) )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "HISTOGRAM_MAX must be greater than HISTOGRAM_MIN." );
+            return CE_Failure;
+        }
+    }
+
+    const char* pszThreads = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    int nThreads;
+    if( pszThreads == NULL )
+        pszThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "1");
+    if( EQUAL(pszThreads, "ALL_CPUS") )
+        nThreads = CPLGetNumCPUs();
+    else
+        nThreads = atoi(pszThreads);
+    if( nThreads > 128 )
+        nThreads = 128;
+    if( nThreads < 1 )
+        nThreads = 1;
+
+/* -------------------------------------------------------------------- */
+/*      Load the zones, and index them.                                 */
+/* -------------------------------------------------------------------- */
+    std::vector<GDALZSZone*> apoZones;
+
+    if( GDALZSLoadZones( poLayer, hDS, apoZones ) != CE_None )
+        return CE_Failure;
+
+    int nZones = (int) apoZones.size();
+    CPLRectObj sGlobalBounds;
+    sGlobalBounds.minx = -1;
+    sGlobalBounds.miny = -1;
+    sGlobalBounds.maxx = nXSize + 1;
+    sGlobalBounds.maxy = nYSize + 1;
+
+    CPLQuadTree* hQuadTree = CPLQuadTreeCreate( &sGlobalBounds,
+                                                GDALZSZoneGetBounds );
+    int iZone;
+    for( iZone = 0; iZone < nZones; iZone++ )
+    {
+        GDALZSZone* psZone = apoZones[iZone];
+        if( psZone->sBounds.maxx >= -1 && psZone->sBounds.minx <= nXSize + 1 &&
+            psZone->sBounds.maxy >= -1 && psZone->sBounds.miny <= nYSize + 1 &&
+            !psZone->adfX.empty() )
+            CPLQuadTreeInsert( hQuadTree, psZone );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Establish the chunk size from the block size, avoiding too      */
+/*      thin chunks so that the zones are not rasterized too often.     */
+/* -------------------------------------------------------------------- */
+    int nBlockXSize, nBlockYSize;
+    poBand->GetBlockSize( &nBlockXSize, &nBlockYSize );
+    int nChunkXSize = nBlockXSize;
+    int nChunkYSize = nBlockYSize;
+    if( nChunkXSize < 256 )
+        nChunkXSize = ((256 + nBlockXSize - 1) / nBlockXSize) * nBlockXSize;
+    if( nChunkYSize < 256 )
+        nChunkYSize = ((256 + nBlockYSize - 1) / nBlockYSize) * nBlockYSize;
+    nChunkXSize = MIN(nChunkXSize, nXSize);
+    nChunkYSize = MIN(nChunkYSize, nYSize);
+
+    int nXChunks = (nXSize + nChunkXSize - 1) / nChunkXSize;
+    int nYChunks = (nYSize + nChunkYSize - 1) / nChunkYSize;
+    int nChunks = nXChunks * nYChunks;
+    if( nThreads > nChunks )
+        nThreads = nChunks;
+
+    GDALRasterBand *poMaskBand = NULL;
+    if( poBand->GetMaskFlags() != GMF_ALL_VALID )
+        poMaskBand = poBand->GetMaskBand();
+
+    CPLDebug( "GDAL", "Zonal statistics of %d zones on %d chunks of %dx%d "
+              "using %d threads.", nZones, nChunks, nChunkXSize, nChunkYSize,
+              nThreads );
+
+/* -------------------------------------------------------------------- */
+/*      Allocate per-thread buffers and accumulators.                   */
+/* -------------------------------------------------------------------- */
+    size_t nChunkPixels = (size_t)nChunkXSize * nChunkYSize;
+    std::vector<GDALZSJob> asJobs( nThreads );
+    std::vector< std::vector<GDALZSAccumulator> > aasAcc( nThreads );
+    std::vector< std::vector<GUIntBig> > aanHistogram( nThreads );
+    std::vector< std::vector<double> > aadfX( nThreads ), aadfY( nThreads );
+    GDALZSAccumulator sEmptyAcc = { 0, 0.0, 0.0, 0.0 };
+    CPLErr eErr = CE_None;
+    int iThread;
+
+    for( iThread = 0; iThread < nThreads; iThread++ )
+    {
+        GDALZSJob* psJob = &asJobs[iThread];
+
+        psJob->papoZones = &apoZones;
+        psJob->hQuadTree = hQuadTree;
+        psJob->bAllTouched = bAllTouched;
+        psJob->nBuckets = nBuckets;
+        psJob->dfHistMin = dfHistMin;
+        psJob->dfHistScale = nBuckets / (dfHistMax - dfHistMin);
+        psJob->padfValues = (double*)
+            VSIMalloc2( nChunkPixels, sizeof(double) );
+        psJob->pabyMask = poMaskBand ? (GByte*) VSIMalloc( nChunkPixels ) : NULL;
+        psJob->panZoneId = (GInt32*)
+            VSIMalloc2( nChunkPixels, sizeof(GInt32) );
+        psJob->padfX = &aadfX[iThread];
+        psJob->padfY = &aadfY[iThread];
+        psJob->pasAcc = &aasAcc[iThread];
+        psJob->panHistogram = &aanHistogram[iThread];
+        psJob->hThread = NULL;
+
+        if( psJob->padfValues == NULL || psJob->panZoneId == NULL ||
+            (poMaskBand != NULL && psJob->pabyMask == NULL) )
+        {
+            CPLError( CE_Failure, CPLE_OutOfMemory,
+                      "Unable to allocate zonal statistics buffers." );
+            eErr = CE_Failure;
+        }
+        else
+        {
+            aasAcc[iThread].resize( nZones, sEmptyAcc );
+            if( nBuckets )
+                aanHistogram[iThread].resize( (size_t)nZones * nBuckets, 0 );
+        }
+    }
+
+/* ==================================================================== */
+/*      Loop over the chunks.  Reading is done from this thread,        */
+/*      while up to nThreads chunks are processed concurrently.         */
+/* ==================================================================== */
+    if( eErr == CE_None )
+        pfnProgress( 0.0, NULL, pProgressArg );
+
+    for( int iFirstChunk = 0;
+         iFirstChunk < nChunks && eErr == CE_None && nZones > 0;
+         iFirstChunk += nThreads )
+    {
+        int nJobs = MIN(nThreads, nChunks - iFirstChunk);
+        int iJob;
+
+        for( iJob = 0; iJob < nJobs && eErr == CE_None; iJob++ )
+        {
+            GDALZSJob* psJob = &asJobs[iJob];
+            int iChunk = iFirstChunk + iJob;
+
+            psJob->nXOff = (iChunk % nXChunks) * nChunkXSize;
+            psJob->nYOff = (iChunk / nXChunks) * nChunkYSize;
+            psJob->nXSize = MIN(nChunkXSize, nXSize - psJob->nXOff);
+            psJob->nYSize = MIN(nChunkYSize, nYSize - psJob->nYOff);
+
+            eErr = poBand->RasterIO( GF_Read, psJob->nXOff, psJob->nYOff,
+                                     psJob->nXSize, psJob->nYSize,
+                                     psJob->padfValues,
+                                     psJob->nXSize, psJob->nYSize,
+                                     GDT_Float64, 0, 0, NULL );
+            if( eErr == CE_None && poMaskBand != NULL )
+                eErr = poMaskBand->RasterIO( GF_Read,
+                                             psJob->nXOff, psJob->nYOff,
+                                             psJob->nXSize, psJob->nYSize,
+                                             psJob->pabyMask,
+                                             psJob->nXSize, psJob->nYSize,
+                                             GDT_Byte, 0, 0, NULL );
+        }
+        if( eErr != CE_None )
+            break;
+
+        if( nJobs == 1 )
+            GDALZSJobProcess( &asJobs[0] );
+        else
+        {
+            for( iJob = 0; iJob < nJobs; iJob++ )
+                asJobs[iJob].hThread =
+                    CPLCreateJoinableThread( GDALZSJobProcess, &asJobs[iJob] );
+            for( iJob = 0; iJob < nJobs; iJob++ )
+            {
+                if( asJobs[iJob].hThread != NULL )
+                    CPLJoinThread( asJobs[iJob].hThread );
+                else
+                    GDALZSJobProcess( &asJobs[iJob] );
+                asJobs[iJob].hThread = NULL;
+            }
+        }
+
+        if( !pfnProgress( (iFirstChunk + nJobs) / (double) nChunks,
+                          "", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Merge the per-thread statistics.                                */
+/* -------------------------------------------------------------------- */
+    if( eErr == CE_None )
+    {
+        GDALZonalStatistics* pasStats = (GDALZonalStatistics*)
+            CPLCalloc( MAX(1, nZones), sizeof(GDALZonalStatistics) );
+
+        for( iZone = 0; iZone < nZones; iZone++ )
+        {
+            GDALZonalStatistics* psStats = pasStats + iZone;
+
+            psStats->nFID = apoZones[iZone]->nFID;
+            if( nBuckets )
+                psStats->panHistogram = (GUIntBig*)
+                    CPLCalloc( nBuckets, sizeof(GUIntBig) );
+
+            for( iThread = 0; iThread < nThreads; iThread++ )
+            {
+                const GDALZSAccumulator* psAcc = &aasAcc[iThread][iZone];
+                if( psAcc->nCount == 0 )
+                    continue;
+                if( psStats->nCount == 0 || psAcc->dfMin < psStats->dfMin )
+                    psStats->dfMin = psAcc->dfMin;
+                if( psStats->nCount == 0 || psAcc->dfMax > psStats->dfMax )
+                    psStats->dfMax = psAcc->dfMax;
+                psStats->nCount += psAcc->nCount;
+                psStats->dfSum += psAcc->dfSum;
+
+                for( int iBucket = 0; iBucket < nBuckets; iBucket++ )
+                    psStats->panHistogram[iBucket] +=
+                        aanHistogram[iThread][(size_t)iZone * nBuckets + iBucket];
+            }
+            if( psStats->nCount > 0 )
+                psStats->dfMean = psStats->dfSum / psStats->nCount;
+        }
+
+        *pnZoneCount = nZones;
+        *ppasStats = pasStats;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Cleanup.                                                        */
+/* -------------------------------------------------------------------- */
+    for( iThread = 0; iThread < nThreads; iThread++ )
+    {
+        VSIFree( asJobs[iThread].padfValues );
+        VSIFree( asJobs[iThread].pabyMask );
+        VSIFree( asJobs[iThread].panZoneId );
+    }
+    CPLQuadTreeDestroy( hQuadTree );
+    for( iZone = 0; iZone < nZones; iZone++ )
+        delete apoZones[iZone];
+
+    return eErr;
+#endif /* def OGR_ENABLED */
+}
+
+/************************************************************************/
+/*                     GDALDestroyZonalStatistics()                     */
+/************************************************************************/
+
+/**
+ * Free the statistics returned by GDALComputeZonalStatistics().
+ *
+ * @param nZoneCount number of zones.
+ * @param pasStats array of statistics.
+ *
+ * @since GDAL 2.0
+ */
+
+void GDALDestroyZonalStatistics( int nZoneCount,
+                                 GDALZonalStatistics *pasStats )
+{
+    if( pasStats == NULL )
+        return;
+
+    for( int i = 0; i < nZoneCount; i++ )
+        CPLFree( pasStats[i].panHistogram );
+    CPLFree( pasStats );
+}
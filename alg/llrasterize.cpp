@@ -28,6 +28,9 @@
  * DEALINGS IN THE SOFTWARE.
  ****************************************************************************/
 
+#include <vector>
+#include <algorithm>
+
 #include "gdal_alg.h"
 #include "gdal_alg_priv.h"
 
@@ -245,6 +248,250 @@ No known bug
     free( polyInts );
 }
 
+/************************************************************************/
+/*                  GDALdllImageFilledPolygonCoverage()                 */
+/*                                                                      */
+/*      Compute the exact fraction of each pixel area covered by the    */
+/*      passed multi-ring polygon.  Each pixel row is swept once: the   */
+/*      edges crossing the row are clipped to it and, for each pixel    */
+/*      they traverse, the signed area between the edge and the right   */
+/*      of the pixel is accumulated, the remainder being carried to     */
+/*      the next pixel.  A running sum over the row then gives the      */
+/*      coverage of each pixel (the same approach as the one of         */
+/*      anti-aliasing font rasterizers).                                */
+/*                                                                      */
+/*      Rings must be consistently oriented: outer rings in one         */
+/*      direction and inner rings in the other one.  The coverage       */
+/*      function is called with runs of pixels of non-null coverage,    */
+/*      with fractions in ]0,1].                                        */
+/************************************************************************/
+
+typedef struct
+{
+    double  dfYMin;
+    double  dfYMax;
+    int     iStart;
+    int     iEnd;
+} llCoverageEdge;
+
+static bool llCompareCoverageEdge( const llCoverageEdge& a,
+                                   const llCoverageEdge& b )
+{
+    return a.dfYMin < b.dfYMin;
+}
+
+/* Accumulate a sub-segment lying in pixel column nX. */
+static inline void llAccumulateCoverage( double *padfAcc, int nX, 
+                                         double dfDY, double dfXMid )
+{
+    double dfFrac = dfXMid - nX;
+
+    padfAcc[nX] += dfDY * (1.0 - dfFrac);
+    padfAcc[nX+1] += dfDY * dfFrac;
+}
+
+void GDALdllImageFilledPolygonCoverage( int nRasterXSize, int nRasterYSize, 
+                                        int nPartCount, int *panPartSize,
+                                        double *padfX, double *padfY,
+                                        double *padfVariant,
+                                        llCoverageFunc pfnCoverageFunc,
+                                        void *pCBData )
+{
+    int     i, part, partoffset;
+
+    if( !nPartCount || nRasterXSize <= 0 )
+        return;
+
+/* -------------------------------------------------------------------- */
+/*      Build the list of non horizontal edges, sorted by min Y.        */
+/* -------------------------------------------------------------------- */
+    std::vector<llCoverageEdge> asEdges;
+
+    for( part = 0, partoffset = 0; part < nPartCount;
+         partoffset += panPartSize[part++] )
+    {
+        for( i = 0; i < panPartSize[part]; i++ )
+        {
+            llCoverageEdge sEdge;
+
+            sEdge.iStart = partoffset + ((i == 0) ? panPartSize[part] - 1
+                                                  : i - 1);
+            sEdge.iEnd = partoffset + i;
+            if( padfY[sEdge.iStart] == padfY[sEdge.iEnd] )
+                continue;
+            sEdge.dfYMin = MIN(padfY[sEdge.iStart], padfY[sEdge.iEnd]);
+            sEdge.dfYMax = MAX(padfY[sEdge.iStart], padfY[sEdge.iEnd]);
+            if( sEdge.dfYMax <= 0 || sEdge.dfYMin >= nRasterYSize )
+                continue;
+            asEdges.push_back( sEdge );
+        }
+    }
+
+    if( asEdges.empty() )
+        return;
+
+    std::sort( asEdges.begin(), asEdges.end(), llCompareCoverageEdge );
+
+    int nYStart = MAX(0, (int) floor(asEdges[0].dfYMin));
+    double dfVariant = (padfVariant == NULL) ? 0 : padfVariant[0];
+
+    std::vector<double> adfAcc( nRasterXSize + 2, 0.0 );
+    std::vector<double> adfCoverage( nRasterXSize, 0.0 );
+    std::vector<int> anActive;
+    size_t iNextEdge = 0;
+
+/* ==================================================================== */
+/*      Sweep the rows.                                                 */
+/* ==================================================================== */
+    for( int y = nYStart; y < nRasterYSize; y++ )
+    {
+        double dfRowTop = y;
+        double dfRowBottom = y + 1.0;
+
+        /* Update the active edge list */
+        while( iNextEdge < asEdges.size() &&
+               asEdges[iNextEdge].dfYMin < dfRowBottom )
+            anActive.push_back( (int) iNextEdge++ );
+
+        size_t iActive = 0;
+        for( size_t j = 0; j < anActive.size(); j++ )
+        {
+            if( asEdges[anActive[j]].dfYMax > dfRowTop )
+                anActive[iActive++] = anActive[j];
+        }
+        anActive.resize( iActive );
+
+        if( anActive.empty() )
+        {
+            if( iNextEdge == asEdges.size() )
+                break;
+            continue;
+        }
+
+        int nXMin = nRasterXSize + 1;
+        int nXMax = -1;
+
+        for( size_t j = 0; j < anActive.size(); j++ )
+        {
+            const llCoverageEdge& sEdge = asEdges[anActive[j]];
+            double dfX0 = padfX[sEdge.iStart];
+            double dfY0 = padfY[sEdge.iStart];
+            double dfX1 = padfX[sEdge.iEnd];
+            double dfY1 = padfY[sEdge.iEnd];
+            double dfSign = (dfY1 > dfY0) ? 1.0 : -1.0;
+            double dfDXDY = (dfX1 - dfX0) / (dfY1 - dfY0);
+
+/* -------------------------------------------------------------------- */
+/*      Clip the edge to the row.                                       */
+/* -------------------------------------------------------------------- */
+            double dfYA = MAX(sEdge.dfYMin, dfRowTop);
+            double dfYB = MIN(sEdge.dfYMax, dfRowBottom);
+            double dfXA = dfX0 + (dfYA - dfY0) * dfDXDY;
+            double dfXB = dfX0 + (dfYB - dfY0) * dfDXDY;
+            double dfDY = dfYB - dfYA;
+
+            if( dfXA > dfXB )
+                llSwapDouble( &dfXA, &dfXB );
+
+/* -------------------------------------------------------------------- */
+/*      The part of the edge at the left of the raster fully covers     */
+/*      the row, and the part at its right does not matter.             */
+/* -------------------------------------------------------------------- */
+            if( dfXB <= 0 )
+            {
+                adfAcc[0] += dfSign * dfDY;
+                nXMin = 0;
+                nXMax = MAX(nXMax, 0);
+                continue;
+            }
+            if( dfXA >= nRasterXSize )
+                continue;
+
+            if( dfXA == dfXB )
+            {
+                int nX = (int) floor(dfXA);
+                llAccumulateCoverage( &adfAcc[0], nX, dfSign * dfDY, dfXA );
+                nXMin = MIN(nXMin, nX);
+                nXMax = MAX(nXMax, nX);
+                continue;
+            }
+
+            double dfDYDX = dfDY / (dfXB - dfXA);
+
+            if( dfXA < 0 )
+            {
+                adfAcc[0] += dfSign * (0 - dfXA) * dfDYDX;
+                dfXA = 0;
+            }
+            if( dfXB > nRasterXSize )
+                dfXB = nRasterXSize;
+
+/* -------------------------------------------------------------------- */
+/*      Walk through the pixels crossed by the edge.                    */
+/* -------------------------------------------------------------------- */
+            int nX = (int) floor(dfXA);
+            nXMin = MIN(nXMin, nX);
+            while( dfXA < dfXB )
+            {
+                double dfXNext = MIN((double)(nX + 1), dfXB);
+
+                llAccumulateCoverage( &adfAcc[0], nX,
+                                      dfSign * (dfXNext - dfXA) * dfDYDX,
+                                      0.5 * (dfXA + dfXNext) );
+                dfXA = dfXNext;
+                nX ++;
+            }
+            nXMax = MAX(nXMax, MIN(nX - 1, nRasterXSize - 1));
+        }
+
+        if( nXMax < 0 )
+            continue;
+
+/* -------------------------------------------------------------------- */
+/*      Integrate the accumulation buffer and report the run of         */
+/*      covered pixels.                                                 */
+/* -------------------------------------------------------------------- */
+        double dfSum = 0;
+        double dfCoverage = 0;
+        int nRunStart = -1;
+        int nXEnd = MIN(nXMax + 1, nRasterXSize - 1);
+        int x;
+
+        for( x = nXMin; x <= nXEnd; x++ )
+        {
+            dfSum += adfAcc[x];
+            adfAcc[x] = 0;
+
+            dfCoverage = fabs(dfSum);
+            if( dfCoverage < 1e-10 )
+                dfCoverage = 0;
+            else if( dfCoverage > 1 )
+                dfCoverage = 1;
+            adfCoverage[x] = dfCoverage;
+
+            if( dfCoverage > 0 && nRunStart < 0 )
+                nRunStart = x;
+            else if( dfCoverage == 0 && nRunStart >= 0 )
+            {
+                pfnCoverageFunc( pCBData, y, nRunStart, x - 1,
+                                 &adfCoverage[nRunStart], dfVariant );
+                nRunStart = -1;
+            }
+        }
+        adfAcc[nXMax + 1] = 0;
+
+        if( nRunStart >= 0 )
+        {
+            /* Right of the last edge, the coverage remains constant */
+            /* until the right of the raster. */
+            for( ; x < nRasterXSize; x++ )
+                adfCoverage[x] = dfCoverage;
+            pfnCoverageFunc( pCBData, y, nRunStart, nRasterXSize - 1,
+                             &adfCoverage[nRunStart], dfVariant );
+        }
+    }
+}
+
 /************************************************************************/
 /*                         GDALdllImagePoint()                          */
 /************************************************************************/
@@ -31,6 +31,7 @@
 #include "gdal_alg.h"
 #include "cpl_conv.h"
 #include "cpl_string.h"
+#include <algorithm>
 
 CPL_CVSID("$Id$");
 
@@ -348,6 +349,482 @@ if( quad_value != nNoDataVal ) 						\
     }									\
 }
 
+/************************************************************************/
+/* ==================================================================== */
+/*                        Push-pull interpolation                       */
+/* ==================================================================== */
+/*                                                                      */
+/*      A pyramid of decimated levels is built by averaging 2x2         */
+/*      blocks of valid pixels ("push"), and the holes of each level    */
+/*      are then filled by bilinear upsampling of the level above it,   */
+/*      from the coarsest level down to the target ("pull").  Each      */
+/*      level is streamed line by line through a work file, so the      */
+/*      cost is linear in the number of pixels, whatever the size of    */
+/*      the holes, and memory use is a few scanlines.                   */
+/************************************************************************/
+
+#define FILL_MAX_LEVELS 32
+
+typedef struct
+{
+    int             nXSize;
+    int             nYSize;
+
+    // Level 0 is the target band with weights from the mask band,
+    // other levels are work datasets with a value and a weight band.
+    GDALDatasetH    hDS;
+    GDALRasterBandH hValBand;
+    GDALRasterBandH hWeightBand;
+} GDALFillLevel;
+
+/************************************************************************/
+/*                        GDALFillLevelReadLine()                       */
+/************************************************************************/
+
+static CPLErr
+GDALFillLevelReadLine( GDALFillLevel *psLevel, int bIsTarget, int iY,
+                       float *pafVal, float *pafWeight, GByte *pabyMask )
+
+{
+    const int nXSize = psLevel->nXSize;
+    CPLErr eErr;
+
+    eErr = GDALRasterIO( psLevel->hValBand, GF_Read, 0, iY, nXSize, 1,
+                         pafVal, nXSize, 1, GDT_Float32, 0, 0 );
+    if( eErr != CE_None )
+        return eErr;
+
+    if( !bIsTarget )
+        return GDALRasterIO( psLevel->hWeightBand, GF_Read, 0, iY, nXSize, 1,
+                             pafWeight, nXSize, 1, GDT_Float32, 0, 0 );
+
+    eErr = GDALRasterIO( psLevel->hWeightBand, GF_Read, 0, iY, nXSize, 1,
+                         pabyMask, nXSize, 1, GDT_Byte, 0, 0 );
+    if( eErr != CE_None )
+        return eErr;
+
+    for( int iX = 0; iX < nXSize; iX++ )
+        pafWeight[iX] = pabyMask[iX] ? 1.0f : 0.0f;
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                        GDALFillLevelWriteLine()                      */
+/************************************************************************/
+
+static CPLErr
+GDALFillLevelWriteLine( GDALFillLevel *psLevel, int iY,
+                        float *pafVal, float *pafWeight )
+
+{
+    const int nXSize = psLevel->nXSize;
+    CPLErr eErr;
+
+    eErr = GDALRasterIO( psLevel->hValBand, GF_Write, 0, iY, nXSize, 1,
+                         pafVal, nXSize, 1, GDT_Float32, 0, 0 );
+    if( eErr != CE_None )
+        return eErr;
+
+    return GDALRasterIO( psLevel->hWeightBand, GF_Write, 0, iY, nXSize, 1,
+                         pafWeight, nXSize, 1, GDT_Float32, 0, 0 );
+}
+
+/************************************************************************/
+/*                          GDALFillPushLevel()                         */
+/*                                                                      */
+/*      Compute level iLevel from level iLevel-1.  Each pixel is the    */
+/*      weighted average of the valid pixels of its 2x2 block, with     */
+/*      a weight of the sum of their weights, capped to 1.              */
+/************************************************************************/
+
+static CPLErr
+GDALFillPushLevel( GDALFillLevel *pasLevels, int iLevel,
+                   float *pafBuf, GByte *pabyMask,
+                   double *pdfDone, double dfTotal, double dfProgressRatio,
+                   GDALProgressFunc pfnProgress, void *pProgressArg )
+
+{
+    GDALFillLevel *psSrc = pasLevels + iLevel - 1;
+    GDALFillLevel *psDst = pasLevels + iLevel;
+    const int nSrcXSize = psSrc->nXSize;
+    float *pafVal0 = pafBuf;
+    float *pafWeight0 = pafVal0 + nSrcXSize;
+    float *pafVal1 = pafWeight0 + nSrcXSize;
+    float *pafWeight1 = pafVal1 + nSrcXSize;
+    float *pafOutVal = pafWeight1 + nSrcXSize;
+    float *pafOutWeight = pafOutVal + psDst->nXSize;
+    CPLErr eErr = CE_None;
+    int iX, iY;
+
+    for( iY = 0; iY < psDst->nYSize && eErr == CE_None; iY++ )
+    {
+        eErr = GDALFillLevelReadLine( psSrc, iLevel == 1, 2 * iY,
+                                      pafVal0, pafWeight0, pabyMask );
+        if( eErr != CE_None )
+            break;
+
+        if( 2 * iY + 1 < psSrc->nYSize )
+            eErr = GDALFillLevelReadLine( psSrc, iLevel == 1, 2 * iY + 1,
+                                          pafVal1, pafWeight1, pabyMask );
+        else
+            memset( pafWeight1, 0, sizeof(float) * nSrcXSize );
+        if( eErr != CE_None )
+            break;
+
+        for( iX = 0; iX < psDst->nXSize; iX++ )
+        {
+            const int iSrcX = 2 * iX;
+            double dfWeightSum = pafWeight0[iSrcX] + pafWeight1[iSrcX];
+            double dfValSum = pafWeight0[iSrcX] * (double) pafVal0[iSrcX]
+                + pafWeight1[iSrcX] * (double) pafVal1[iSrcX];
+
+            if( iSrcX + 1 < nSrcXSize )
+            {
+                dfWeightSum += pafWeight0[iSrcX+1] + pafWeight1[iSrcX+1];
+                dfValSum += pafWeight0[iSrcX+1] * (double) pafVal0[iSrcX+1]
+                    + pafWeight1[iSrcX+1] * (double) pafVal1[iSrcX+1];
+            }
+
+            if( dfWeightSum > 0.0 )
+            {
+                pafOutVal[iX] = (float) (dfValSum / dfWeightSum);
+                pafOutWeight[iX] = (float) MIN(1.0, dfWeightSum);
+            }
+            else
+            {
+                pafOutVal[iX] = 0.0f;
+                pafOutWeight[iX] = 0.0f;
+            }
+        }
+
+        eErr = GDALFillLevelWriteLine( psDst, iY, pafOutVal, pafOutWeight );
+
+        *pdfDone += psDst->nXSize;
+        if( eErr == CE_None
+            && !pfnProgress( dfProgressRatio * *pdfDone / dfTotal,
+                             "Filling...", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                          GDALFillPullLevel()                         */
+/*                                                                      */
+/*      Fill level iLevel from the (already filled) level above it.     */
+/*      Each pixel is blended with the bilinear interpolation of the    */
+/*      valid parent pixels according to its weight.  For the target   */
+/*      level, the filtering mask of the filled pixels is written.      */
+/************************************************************************/
+
+static CPLErr
+GDALFillPullLevel( GDALFillLevel *pasLevels, int iLevel,
+                   GDALRasterBandH hFiltMaskBand,
+                   float *pafBuf, GByte *pabyMask,
+                   double *pdfDone, double dfTotal, double dfProgressRatio,
+                   GDALProgressFunc pfnProgress, void *pProgressArg )
+
+{
+    GDALFillLevel *psLevel = pasLevels + iLevel;
+    GDALFillLevel *psParent = pasLevels + iLevel + 1;
+    const int nXSize = psLevel->nXSize;
+    const int nParentXSize = psParent->nXSize;
+    float *pafVal = pafBuf;
+    float *pafWeight = pafVal + nXSize;
+    float *apafParentVal[2], *apafParentWeight[2];
+    int anParentLine[2] = { -1, -1 };
+    CPLErr eErr = CE_None;
+    int iX, iY;
+
+    apafParentVal[0] = pafWeight + nXSize;
+    apafParentWeight[0] = apafParentVal[0] + nParentXSize;
+    apafParentVal[1] = apafParentWeight[0] + nParentXSize;
+    apafParentWeight[1] = apafParentVal[1] + nParentXSize;
+
+    for( iY = 0; iY < psLevel->nYSize && eErr == CE_None; iY++ )
+    {
+/* -------------------------------------------------------------------- */
+/*      Load the two parent lines around this one.                      */
+/* -------------------------------------------------------------------- */
+        const double dfParentY = (iY + 0.5) * 0.5 - 0.5;
+        const int iParentY = (int) floor( dfParentY );
+        const double dfFracY = dfParentY - iParentY;
+        int k;
+
+        for( k = 0; k < 2 && eErr == CE_None; k++ )
+        {
+            const int iLine = MAX(0, MIN(psParent->nYSize - 1, iParentY + k));
+            if( anParentLine[k] == iLine )
+                continue;
+            if( k == 0 && anParentLine[1] == iLine )
+            {
+                std::swap( apafParentVal[0], apafParentVal[1] );
+                std::swap( apafParentWeight[0], apafParentWeight[1] );
+                anParentLine[0] = iLine;
+                anParentLine[1] = -1;
+                continue;
+            }
+            eErr = GDALFillLevelReadLine( psParent, FALSE, iLine,
+                                          apafParentVal[k],
+                                          apafParentWeight[k], NULL );
+            anParentLine[k] = iLine;
+        }
+
+        if( eErr == CE_None )
+            eErr = GDALFillLevelReadLine( psLevel, iLevel == 0, iY,
+                                          pafVal, pafWeight, pabyMask );
+        if( eErr != CE_None )
+            break;
+
+/* -------------------------------------------------------------------- */
+/*      Blend with the bilinear interpolation of the parents.           */
+/* -------------------------------------------------------------------- */
+        for( iX = 0; iX < nXSize; iX++ )
+        {
+            const double dfWeight = pafWeight[iX];
+            if( iLevel == 0 )
+                pabyMask[iX] = 0;
+            if( dfWeight >= 1.0 )
+                continue;
+
+            const double dfParentX = (iX + 0.5) * 0.5 - 0.5;
+            const int iParentX = (int) floor( dfParentX );
+            const double dfFracX = dfParentX - iParentX;
+            const int iX0 = MAX(0, iParentX);
+            const int iX1 = MIN(nParentXSize - 1, iParentX + 1);
+            double dfValSum = 0.0, dfWeightSum = 0.0;
+
+            for( k = 0; k < 2; k++ )
+            {
+                const double dfWY = (k == 0) ? 1.0 - dfFracY : dfFracY;
+                const float *pafPVal = apafParentVal[k];
+                const float *pafPWeight = apafParentWeight[k];
+
+                if( pafPWeight[iX0] > 0.0f )
+                {
+                    dfValSum += dfWY * (1.0 - dfFracX) * pafPVal[iX0];
+                    dfWeightSum += dfWY * (1.0 - dfFracX);
+                }
+                if( pafPWeight[iX1] > 0.0f )
+                {
+                    dfValSum += dfWY * dfFracX * pafPVal[iX1];
+                    dfWeightSum += dfWY * dfFracX;
+                }
+            }
+
+            if( dfWeightSum > 0.0 )
+            {
+                pafVal[iX] = (float) (dfWeight * pafVal[iX]
+                    + (1.0 - dfWeight) * dfValSum / dfWeightSum);
+                pafWeight[iX] = 1.0f;
+                if( iLevel == 0 )
+                    pabyMask[iX] = 255;
+            }
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Write the filled line.  On the target, the mask buffer now      */
+/*      flags the pixels that were filled.                              */
+/* -------------------------------------------------------------------- */
+        if( iLevel > 0 )
+            eErr = GDALFillLevelWriteLine( psLevel, iY, pafVal, pafWeight );
+        else
+        {
+            eErr = GDALRasterIO( psLevel->hValBand, GF_Write,
+                                 0, iY, nXSize, 1,
+                                 pafVal, nXSize, 1, GDT_Float32, 0, 0 );
+            if( eErr == CE_None && hFiltMaskBand != NULL )
+                eErr = GDALRasterIO( hFiltMaskBand, GF_Write,
+                                     0, iY, nXSize, 1,
+                                     pabyMask, nXSize, 1, GDT_Byte, 0, 0 );
+        }
+
+        *pdfDone += nXSize;
+        if( eErr == CE_None
+            && !pfnProgress( dfProgressRatio * *pdfDone / dfTotal,
+                             "Filling...", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                         GDALFillNodataPushPull()                     */
+/************************************************************************/
+
+static CPLErr
+GDALFillNodataPushPull( GDALRasterBandH hTargetBand,
+                        GDALRasterBandH hMaskBand,
+                        double dfMaxSearchDist,
+                        int nSmoothingIterations,
+                        GDALDriverH hDriver,
+                        char **papszWorkFileOptions,
+                        GDALProgressFunc pfnProgress,
+                        void * pProgressArg )
+
+{
+    GDALFillLevel asLevels[FILL_MAX_LEVELS];
+    CPLString osTmpFile = CPLGenerateTempFilename("");
+    int nLevels = 1, iLevel;
+    CPLErr eErr = CE_None;
+
+    /* If there are smoothing iterations, reserve 10% of the progress for them */
+    double dfProgressRatio = (nSmoothingIterations > 0) ? 0.9 : 1.0;
+
+/* -------------------------------------------------------------------- */
+/*      Decide on the number of levels.  The cells of the coarsest      */
+/*      level span about the maximum search distance, so holes          */
+/*      farther than that from valid pixels are left unfilled.          */
+/* -------------------------------------------------------------------- */
+    memset( asLevels, 0, sizeof(asLevels) );
+    asLevels[0].nXSize = GDALGetRasterBandXSize( hTargetBand );
+    asLevels[0].nYSize = GDALGetRasterBandYSize( hTargetBand );
+    asLevels[0].hValBand = hTargetBand;
+    asLevels[0].hWeightBand = hMaskBand;
+
+    double dfTotal = (double) asLevels[0].nXSize * asLevels[0].nYSize;
+
+    while( nLevels < FILL_MAX_LEVELS
+           && (asLevels[nLevels-1].nXSize > 1
+               || asLevels[nLevels-1].nYSize > 1)
+           && (double) (1 << (nLevels-1)) < dfMaxSearchDist )
+    {
+        GDALFillLevel *psLevel = asLevels + nLevels;
+        CPLString osLevelFile;
+
+        osLevelFile.Printf( "%sfill_level%d_work.tif",
+                            osTmpFile.c_str(), nLevels );
+        psLevel->nXSize = (asLevels[nLevels-1].nXSize + 1) / 2;
+        psLevel->nYSize = (asLevels[nLevels-1].nYSize + 1) / 2;
+        psLevel->hDS =
+            GDALCreate( hDriver, osLevelFile,
+                        psLevel->nXSize, psLevel->nYSize, 2, GDT_Float32,
+                        papszWorkFileOptions );
+        if( psLevel->hDS == NULL )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                "Could not create level work file. Check driver capabilities.");
+            eErr = CE_Failure;
+            break;
+        }
+        psLevel->hValBand = GDALGetRasterBand( psLevel->hDS, 1 );
+        psLevel->hWeightBand = GDALGetRasterBand( psLevel->hDS, 2 );
+
+        dfTotal += 2.0 * psLevel->nXSize * psLevel->nYSize;
+        nLevels++;
+    }
+
+    // The coarsest level is not pulled.
+    if( nLevels > 1 )
+        dfTotal -= (double) asLevels[nLevels-1].nXSize
+            * asLevels[nLevels-1].nYSize;
+
+/* -------------------------------------------------------------------- */
+/*      Create a mask file to make it clear what pixels can be filtered */
+/*      on the filtering pass.                                          */
+/* -------------------------------------------------------------------- */
+    GDALDatasetH hFiltMaskDS = NULL;
+    GDALRasterBandH hFiltMaskBand = NULL;
+    CPLString osFiltMaskTmpFile = osTmpFile + "fill_filtmask_work.tif";
+
+    if( eErr == CE_None && nSmoothingIterations > 0 )
+    {
+        hFiltMaskDS =
+            GDALCreate( hDriver, osFiltMaskTmpFile,
+                        asLevels[0].nXSize, asLevels[0].nYSize, 1,
+                        GDT_Byte, papszWorkFileOptions );
+
+        if ( hFiltMaskDS == NULL )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                "Could not create mask work file. Check driver capabilities.");
+            eErr = CE_Failure;
+        }
+        else
+            hFiltMaskBand = GDALGetRasterBand( hFiltMaskDS, 1 );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Allocate line buffers: two lines of values and weights for      */
+/*      the finer level, two for the coarser one, and a mask line.      */
+/* -------------------------------------------------------------------- */
+    float *pafBuf = (float *)
+        VSIMalloc3( asLevels[0].nXSize + 1, 8, sizeof(float) );
+    GByte *pabyMask = (GByte *) VSIMalloc( asLevels[0].nXSize );
+    double dfDone = 0.0;
+
+    if( eErr == CE_None && (pafBuf == NULL || pabyMask == NULL) )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Could not allocate enough memory for temporary buffers");
+        eErr = CE_Failure;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Push, then pull.                                                */
+/* -------------------------------------------------------------------- */
+    for( iLevel = 1; iLevel < nLevels && eErr == CE_None; iLevel++ )
+        eErr = GDALFillPushLevel( asLevels, iLevel, pafBuf, pabyMask,
+                                  &dfDone, dfTotal, dfProgressRatio,
+                                  pfnProgress, pProgressArg );
+
+    for( iLevel = nLevels - 2; iLevel >= 0 && eErr == CE_None; iLevel-- )
+        eErr = GDALFillPullLevel( asLevels, iLevel, hFiltMaskBand,
+                                  pafBuf, pabyMask,
+                                  &dfDone, dfTotal, dfProgressRatio,
+                                  pfnProgress, pProgressArg );
+
+    CPLFree( pafBuf );
+    CPLFree( pabyMask );
+
+    for( iLevel = 1; iLevel < nLevels; iLevel++ )
+    {
+        CPLString osLevelFile;
+
+        osLevelFile.Printf( "%sfill_level%d_work.tif",
+                            osTmpFile.c_str(), iLevel );
+        GDALClose( asLevels[iLevel].hDS );
+        GDALDeleteDataset( hDriver, osLevelFile );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Smooth out the interpolated values.                             */
+/* -------------------------------------------------------------------- */
+    if( eErr == CE_None && nSmoothingIterations > 0 )
+    {
+        // force masks to be to flushed and recomputed.
+        GDALFlushRasterCache( hMaskBand );
+
+        void *pScaledProgress;
+        pScaledProgress =
+            GDALCreateScaledProgress( dfProgressRatio, 1.0, pfnProgress,
+                                      pProgressArg );
+
+        eErr = GDALMultiFilter( hTargetBand, hMaskBand, hFiltMaskBand,
+                                nSmoothingIterations,
+                                GDALScaledProgress, pScaledProgress );
+
+        GDALDestroyScaledProgress( pScaledProgress );
+    }
+
+    if( hFiltMaskDS != NULL )
+    {
+        GDALClose( hFiltMaskDS );
+        GDALDeleteDataset( hDriver, osFiltMaskTmpFile );
+    }
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                           GDALFillNodata()                           */
 /************************************************************************/
@@ -370,6 +847,15 @@ if( quad_value != nNoDataVal ) 						\
  * is generally not so great for interpolating a raster from sparse 
  * point data - see the algorithms defined in gdal_grid.h for that case.
  *
+ * With the INTERPOLATION=PUSH_PULL option, a pyramid based interpolation
+ * is used instead: decimated levels are built by averaging the valid
+ * pixels of 2x2 blocks, the coarser levels are used to fill the holes
+ * of the finer ones by bilinear upsampling, and the result is blended
+ * down to full resolution.  It runs in time linear in the number of
+ * pixels whatever the size of the holes and the search distance, and
+ * gives smooth results for large gaps.  The search distance is then
+ * approximate: it bounds the size of the cells of the coarsest level.
+ *
  * @param hTargetBand the raster band to be modified in place. 
  * @param hMaskBand a mask band indicating pixels to be interpolated (zero valued
  * @param dfMaxSearchDist the maximum number of pixels to search in all 
@@ -378,7 +864,8 @@ if( quad_value != nNoDataVal ) 						\
  * @param nSmoothingIterations the number of 3x3 smoothing filter passes to 
  * run (0 or more).
  * @param papszOptions additional name=value options in a string list (the
- * temporary file driver can be specified like TEMP_FILE_DRIVER=MEM).
+ * temporary file driver can be specified like TEMP_FILE_DRIVER=MEM, and the
+ * interpolation method with INTERPOLATION=INV_DIST (default) or PUSH_PULL).
  * @param pfnProgress the progress function to report completion.
  * @param pProgressArg callback data for progress function.
  * 
@@ -469,6 +956,29 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
                 papszWorkFileOptions, "BIGTIFF", "IF_SAFER");
     }
 
+/* -------------------------------------------------------------------- */
+/*      Use the pyramid based interpolation if requested.               */
+/* -------------------------------------------------------------------- */
+    const char *pszInterpolation =
+        CSLFetchNameValueDef( papszOptions, "INTERPOLATION", "INV_DIST" );
+
+    if( EQUAL(pszInterpolation, "PUSH_PULL") )
+    {
+        eErr = GDALFillNodataPushPull( hTargetBand, hMaskBand,
+                                       dfMaxSearchDist, nSmoothingIterations,
+                                       hDriver, papszWorkFileOptions,
+                                       pfnProgress, pProgressArg );
+        CSLDestroy( papszWorkFileOptions );
+        return eErr;
+    }
+    else if( !EQUAL(pszInterpolation, "INV_DIST") )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "Unsupported INTERPOLATION=%s", pszInterpolation );
+        CSLDestroy( papszWorkFileOptions );
+        return CE_Failure;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Create a work file to hold the Y "last value" indices.          */
 /* -------------------------------------------------------------------- */
@@ -48,6 +48,13 @@
 
 #define VIZ_GEOREF_SPLINE_DEBUG 0
 
+/* Number of points above which the AUTO solver uses the iterative one */
+#define VIZ_GEOREF_SPLINE_ITERATIVE_THRESHOLD 1000
+
+/* Maximum refinement depth and node count of the interpolation grid */
+#define VIZ_GEOREF_GRID_MAX_DEPTH 8
+#define VIZ_GEOREF_GRID_MAX_NODES (1 << 20)
+
 #ifndef HAVE_ARMADILLO
 static int matrixInvert( int N, double input[], double output[] );
 #endif
@@ -359,10 +366,16 @@ static void VizGeorefSpline2DBase_func4( double* res,
 }
 #endif
 
-int VizGeorefSpline2D::solve(void)
+int VizGeorefSpline2D::solve( vizGeorefSolverType eSolver )
 {
     int r, c;
     int p;
+
+    // Any previously computed interpolation grid is now stale
+    CPLFree( _grid_nodes );
+    _grid_nodes = NULL;
+    _grid_nof_nodes = 0;
+    _grid_max_nodes = 0;
 	
     //	No points at all
     if ( _nof_points < 1 )
@@ -474,6 +487,18 @@ int VizGeorefSpline2D::solve(void)
         CPLError(CE_Failure, CPLE_AppDefined, "Too many coefficients. Computation aborted.");
         return 0;
     }
+
+    // The dense solver needs 4 * _nof_eqs^2 doubles and O(_nof_eqs^3)
+    // operations, which becomes prohibitive with thousands of points.
+    if( eSolver == VIZ_GEOREF_SPLINE_SOLVER_ITERATIVE ||
+        (eSolver == VIZ_GEOREF_SPLINE_SOLVER_AUTO &&
+         _nof_points > VIZ_GEOREF_SPLINE_ITERATIVE_THRESHOLD) )
+    {
+        if( solve_iterative() )
+            return 4;
+        CPLDebug( "TPS", "Iterative solver did not converge. "
+                  "Falling back to direct solver." );
+    }
 	
     double* _AA = ( double * )VSICalloc( _nof_eqs * _nof_eqs, sizeof( double ) );
     double* _Ainv = ( double * )VSICalloc( _nof_eqs * _nof_eqs, sizeof( double ) );
@@ -580,7 +605,7 @@ int VizGeorefSpline2D::solve(void)
 int VizGeorefSpline2D::get_point( const double Px, const double Py, double *vars )
 {
 	int v, r;
-	double tmp, Pu;
+	double Pu;
 	double fact;
 	int leftP=0, rightP=0, found = 0;
 	
@@ -629,26 +654,41 @@ int VizGeorefSpline2D::get_point( const double Px, const double Py, double *vars
 		break;
 	case VIZ_GEOREF_SPLINE_FULL :
     {
-        double Pxy[2] = { Px, Py };
-        for ( v = 0; v < _nof_vars; v++ )
-            vars[v] = coef[v][0] + coef[v][1] * Px + coef[v][2] * Py;
-        
-        for ( r = 0; r < (_nof_points & (~3)); r+=4 )
-        {
-            double tmp[4];
-            VizGeorefSpline2DBase_func4( tmp, Pxy, &x[r], &y[r] );
-            for ( v= 0; v < _nof_vars; v++ )
-                vars[v] += coef[v][r+3] * tmp[0] +
-                        coef[v][r+3+1] * tmp[1] +
-                        coef[v][r+3+2] * tmp[2] +
-                        coef[v][r+3+3] * tmp[3];
-        }
-        for ( ; r < _nof_points; r++ )
+        if( _grid_nodes != NULL )
         {
-            tmp = VizGeorefSpline2DBase_func( Px, Py, x[r], y[r] );
-            for ( v= 0; v < _nof_vars; v++ )
-                vars[v] += coef[v][r+3] * tmp;
+            double dfU = (Px - _grid_xmin) / _grid_cell_w;
+            double dfV = (Py - _grid_ymin) / _grid_cell_h;
+            if( dfU >= 0 && dfU < _grid_nx && dfV >= 0 && dfV < _grid_ny )
+            {
+                int i = (int) dfU, j = (int) dfV;
+                const VizGeorefSplineGridNode* psNode =
+                    &_grid_nodes[j * _grid_nx + i];
+                dfU -= i;
+                dfV -= j;
+                while( psNode->nChild >= 0 )
+                {
+                    int iSub = 0;
+                    dfU *= 2;
+                    dfV *= 2;
+                    if( dfU >= 1.0 ) { dfU -= 1.0; iSub += 1; }
+                    if( dfV >= 1.0 ) { dfV -= 1.0; iSub += 2; }
+                    psNode = &_grid_nodes[psNode->nChild + iSub];
+                }
+                if( psNode->nChild == VIZ_GEOREF_GRID_LEAF )
+                {
+                    for ( v = 0; v < _nof_vars; v++ )
+                    {
+                        double dfBottom = psNode->adfCorner[0][v] +
+                            dfU * (psNode->adfCorner[1][v] - psNode->adfCorner[0][v]);
+                        double dfTop = psNode->adfCorner[2][v] +
+                            dfU * (psNode->adfCorner[3][v] - psNode->adfCorner[2][v]);
+                        vars[v] = dfBottom + dfV * (dfTop - dfBottom);
+                    }
+                    break;
+                }
+            }
         }
+        get_point_full( Px, Py, vars );
         break;
     }
 	case VIZ_GEOREF_SPLINE_POINT_WAS_ADDED :
@@ -672,6 +712,836 @@ int VizGeorefSpline2D::get_point( const double Px, const double Py, double *vars
 	return(1);
 }
 
+/************************************************************************/
+/*                          get_point_full()                            */
+/*                                                                      */
+/*      Exact evaluation of the spline, summing the radial basis        */
+/*      function over all control points.                               */
+/************************************************************************/
+
+void VizGeorefSpline2D::get_point_full( const double Px, const double Py,
+                                        double *vars )
+{
+    int v, r;
+    double tmp;
+    double Pxy[2] = { Px, Py };
+
+    for ( v = 0; v < _nof_vars; v++ )
+        vars[v] = coef[v][0] + coef[v][1] * Px + coef[v][2] * Py;
+
+    for ( r = 0; r < (_nof_points & (~3)); r+=4 )
+    {
+        double tmp4[4];
+        VizGeorefSpline2DBase_func4( tmp4, Pxy, &x[r], &y[r] );
+        for ( v= 0; v < _nof_vars; v++ )
+            vars[v] += coef[v][r+3] * tmp4[0] +
+                    coef[v][r+3+1] * tmp4[1] +
+                    coef[v][r+3+2] * tmp4[2] +
+                    coef[v][r+3+3] * tmp4[3];
+    }
+    for ( ; r < _nof_points; r++ )
+    {
+        tmp = VizGeorefSpline2DBase_func( Px, Py, x[r], y[r] );
+        for ( v= 0; v < _nof_vars; v++ )
+            vars[v] += coef[v][r+3] * tmp;
+    }
+}
+
+/************************************************************************/
+/*                    VizGeorefSplineLUDecompose()                      */
+/*                                                                      */
+/*      In place LU decomposition with partial pivoting of a small      */
+/*      dense N x N matrix, and the corresponding solve.                */
+/************************************************************************/
+
+static int VizGeorefSplineLUDecompose( int N, double* A, int* panPivot )
+{
+    for( int k = 0; k < N; k++ )
+    {
+        int iMax = k;
+        for( int i = k + 1; i < N; i++ )
+        {
+            if( fabs(A[i * N + k]) > fabs(A[iMax * N + k]) )
+                iMax = i;
+        }
+        panPivot[k] = iMax;
+        if( A[iMax * N + k] == 0.0 )
+            return FALSE;
+        if( iMax != k )
+        {
+            for( int j = 0; j < N; j++ )
+            {
+                double dfTmp = A[k * N + j];
+                A[k * N + j] = A[iMax * N + j];
+                A[iMax * N + j] = dfTmp;
+            }
+        }
+        for( int i = k + 1; i < N; i++ )
+        {
+            double dfFactor = A[i * N + k] / A[k * N + k];
+            A[i * N + k] = dfFactor;
+            for( int j = k + 1; j < N; j++ )
+                A[i * N + j] -= dfFactor * A[k * N + j];
+        }
+    }
+    return TRUE;
+}
+
+static void VizGeorefSplineLUSolve( int N, const double* LU,
+                                    const int* panPivot, double* B )
+{
+    int i, j;
+    for( i = 0; i < N; i++ )
+    {
+        if( panPivot[i] != i )
+        {
+            double dfTmp = B[i];
+            B[i] = B[panPivot[i]];
+            B[panPivot[i]] = dfTmp;
+        }
+    }
+    for( i = 1; i < N; i++ )
+        for( j = 0; j < i; j++ )
+            B[i] -= LU[i * N + j] * B[j];
+    for( i = N - 1; i >= 0; i-- )
+    {
+        for( j = i + 1; j < N; j++ )
+            B[i] -= LU[i * N + j] * B[j];
+        B[i] /= LU[i * N + i];
+    }
+}
+
+/************************************************************************/
+/*                    VizGeorefSplineLocalSystem()                      */
+/*                                                                      */
+/*      Fills the (nPoints+3)^2 interpolation matrix of a subset of     */
+/*      the points, and LU decomposes it.                               */
+/************************************************************************/
+
+static int VizGeorefSplineLocalSystem( int nPoints, const int* panIdx,
+                                       const double* x, const double* y,
+                                       double* A, int* panPivot )
+{
+    const int nEqs = nPoints + 3;
+    int i, j;
+
+    /* Polynomial columns in centered and scaled coordinates, which */
+    /* leaves the radial coefficients unchanged. */
+    double dfX0 = x[panIdx[0]], dfY0 = y[panIdx[0]], dfScale = 0.0;
+    for( i = 1; i < nPoints; i++ )
+        dfScale = MAX( dfScale, MAX( fabs(x[panIdx[i]] - dfX0),
+                                     fabs(y[panIdx[i]] - dfY0) ) );
+    if( dfScale == 0.0 )
+        return FALSE;
+
+    for( i = 0; i < nPoints; i++ )
+    {
+        for( j = 0; j < nPoints; j++ )
+            A[i * nEqs + j] = VizGeorefSpline2DBase_func(
+                x[panIdx[i]], y[panIdx[i]], x[panIdx[j]], y[panIdx[j]] );
+        double dfPX = (x[panIdx[i]] - dfX0) / dfScale;
+        double dfPY = (y[panIdx[i]] - dfY0) / dfScale;
+        A[i * nEqs + nPoints] = A[nPoints * nEqs + i] = 1.0;
+        A[i * nEqs + nPoints + 1] = A[(nPoints + 1) * nEqs + i] = dfPX;
+        A[i * nEqs + nPoints + 2] = A[(nPoints + 2) * nEqs + i] = dfPY;
+    }
+    for( i = nPoints; i < nEqs; i++ )
+        for( j = nPoints; j < nEqs; j++ )
+            A[i * nEqs + j] = 0.0;
+
+    return VizGeorefSplineLUDecompose( nEqs, A, panPivot );
+}
+
+/************************************************************************/
+/*                          solve_iterative()                           */
+/*                                                                      */
+/*      Solves the interpolation system with the Krylov subspace        */
+/*      method of Faul, Goodsell and Powell (2005), i.e. a conjugate    */
+/*      gradient in the native semi-inner product <u,v> = u^T K v of    */
+/*      the thin plate spline, preconditioned by local Lagrange         */
+/*      functions:                                                      */
+/*                                                                      */
+/*      - points are visited in a pseudo-random order. For each point   */
+/*        l but the last Q ones, the Lagrange function zeta_l of l on   */
+/*        l and its Q-1 nearest neighbours among the following points   */
+/*        is computed.                                                  */
+/*      - the operator Xi sums the projections of the error on the      */
+/*        zeta_l, plus the interpolant of the error on the last Q       */
+/*        points. It is self-adjoint positive definite for the          */
+/*        semi-inner product, only needs the residuals at the points,   */
+/*        and is close to the identity, so CG typically converges in    */
+/*        a few tens of iterations.                                     */
+/*                                                                      */
+/*      Each iteration costs one product by the N x N kernel matrix,    */
+/*      which is stored if it fits in memory and recomputed otherwise.  */
+/*      The affine part is recovered by least squares at the end.       */
+/*      Returns 0 if the solver did not converge.                       */
+/************************************************************************/
+
+#define VIZ_GEOREF_SPLINE_LOCAL_POINTS 30
+#define VIZ_GEOREF_SPLINE_MAX_ITER     200
+
+/* Product by the kernel matrix */
+static void VizGeorefSplineKernelProduct( int N, const double* padfK,
+                                          const double* x, const double* y,
+                                          const double* padfIn,
+                                          double* padfOut )
+{
+    for( int i = 0; i < N; i++ )
+    {
+        double dfSum = 0.0;
+        int j;
+        if( padfK != NULL )
+        {
+            const double* padfKi = padfK + (size_t)i * N;
+            for( j = 0; j < N; j++ )
+                dfSum += padfKi[j] * padfIn[j];
+        }
+        else
+        {
+            for( j = 0; j < N; j++ )
+                dfSum += VizGeorefSpline2DBase_func(
+                                x[i], y[i], x[j], y[j] ) * padfIn[j];
+        }
+        padfOut[i] = dfSum;
+    }
+}
+
+/* Projects padfV onto the orthogonal complement of the columns of padfQ */
+static void VizGeorefSplineProject( int N, const double* padfQ, double* padfV )
+{
+    for( int k = 0; k < 3; k++ )
+    {
+        const double* padfQk = padfQ + k * N;
+        double dfDot = 0.0;
+        int i;
+        for( i = 0; i < N; i++ )
+            dfDot += padfQk[i] * padfV[i];
+        for( i = 0; i < N; i++ )
+            padfV[i] -= dfDot * padfQk[i];
+    }
+}
+
+typedef struct
+{
+    int     N;
+    int     nLocal;        /* Number of local Lagrange functions */
+    int     Q;             /* Points per local set */
+    int    *panLocalIdx;   /* nLocal * Q point indices, own point first */
+    double *padfLocalCoef; /* nLocal * Q Lagrange function coefficients */
+    int    *panFinalIdx;   /* Q last points */
+    double *padfFinalLU;   /* (Q+3)^2 LU factors of their system */
+    int    *panFinalPivot;
+    double *padfTmp;       /* Q+3 */
+} VizGeorefSplinePrecond;
+
+/* padfOut = coefficients of Xi applied to a function of given values */
+static void VizGeorefSplineApplyXi( const VizGeorefSplinePrecond* psP,
+                                    const double* padfValues,
+                                    double* padfOut )
+{
+    const int Q = psP->Q;
+    int i, l;
+
+    memset( padfOut, 0, psP->N * sizeof(double) );
+    for( l = 0; l < psP->nLocal; l++ )
+    {
+        const int* panIdx = psP->panLocalIdx + (size_t)l * Q;
+        const double* padfCoef = psP->padfLocalCoef + (size_t)l * Q;
+        if( padfCoef[0] <= 0.0 )
+            continue;
+        double dfDot = 0.0;
+        for( i = 0; i < Q; i++ )
+            dfDot += padfCoef[i] * padfValues[panIdx[i]];
+        dfDot /= padfCoef[0];
+        for( i = 0; i < Q; i++ )
+            padfOut[panIdx[i]] += dfDot * padfCoef[i];
+    }
+
+    for( i = 0; i < Q; i++ )
+        psP->padfTmp[i] = padfValues[psP->panFinalIdx[i]];
+    psP->padfTmp[Q] = psP->padfTmp[Q+1] = psP->padfTmp[Q+2] = 0.0;
+    VizGeorefSplineLUSolve( Q + 3, psP->padfFinalLU, psP->panFinalPivot,
+                            psP->padfTmp );
+    for( i = 0; i < Q; i++ )
+        padfOut[psP->panFinalIdx[i]] += psP->padfTmp[i];
+}
+
+static void VizGeorefSplineFreePrecond( VizGeorefSplinePrecond* psP )
+{
+    VSIFree( psP->panLocalIdx );
+    VSIFree( psP->padfLocalCoef );
+    VSIFree( psP->panFinalIdx );
+    VSIFree( psP->padfFinalLU );
+    VSIFree( psP->panFinalPivot );
+    VSIFree( psP->padfTmp );
+}
+
+/* Computes the local Lagrange functions */
+static int VizGeorefSplineInitPrecond( VizGeorefSplinePrecond* psP, int N,
+                                       const double* x, const double* y )
+{
+    const int Q = VIZ_GEOREF_SPLINE_LOCAL_POINTS;
+    int i, l;
+
+    memset( psP, 0, sizeof(VizGeorefSplinePrecond) );
+    psP->N = N;
+    psP->Q = Q;
+    psP->nLocal = N - Q;
+    psP->panLocalIdx = (int*) VSIMalloc3( psP->nLocal, Q, sizeof(int) );
+    psP->padfLocalCoef = (double*) VSIMalloc3( psP->nLocal, Q, sizeof(double) );
+    psP->panFinalIdx = (int*) VSIMalloc2( Q, sizeof(int) );
+    psP->padfFinalLU = (double*) VSIMalloc3( Q + 3, Q + 3, sizeof(double) );
+    psP->panFinalPivot = (int*) VSIMalloc2( Q + 3, sizeof(int) );
+    psP->padfTmp = (double*) VSIMalloc2( Q + 3, sizeof(double) );
+    int* panOrder = (int*) VSIMalloc2( N, sizeof(int) );
+    double* padfDist = (double*) VSIMalloc2( N, sizeof(double) );
+    int* panCandidates = (int*) VSIMalloc2( N, sizeof(int) );
+    double* padfLocalA = (double*) VSIMalloc3( Q + 3, Q + 3, sizeof(double) );
+    int* panLocalPivot = (int*) VSIMalloc2( Q + 3, sizeof(int) );
+    double* padfRHS = (double*) VSIMalloc2( Q + 3, sizeof(double) );
+
+    int bRet = psP->panLocalIdx != NULL && psP->padfLocalCoef != NULL &&
+               psP->panFinalIdx != NULL && psP->padfFinalLU != NULL &&
+               psP->panFinalPivot != NULL && psP->padfTmp != NULL &&
+               panOrder != NULL && padfDist != NULL && panCandidates != NULL &&
+               padfLocalA != NULL && panLocalPivot != NULL && padfRHS != NULL;
+
+    if( bRet )
+    {
+/* -------------------------------------------------------------------- */
+/*      Pseudo-random, but reproducible, ordering of the points, so     */
+/*      that the last ones are spread over the whole extent.            */
+/* -------------------------------------------------------------------- */
+        GUInt32 nSeed = 12345;
+        for( i = 0; i < N; i++ )
+            panOrder[i] = i;
+        for( i = N - 1; i > 0; i-- )
+        {
+            nSeed = nSeed * 1103515245U + 12345U;
+            int j = (int)((nSeed >> 8) % (GUInt32)(i + 1));
+            int nTmp = panOrder[i];
+            panOrder[i] = panOrder[j];
+            panOrder[j] = nTmp;
+        }
+
+        for( l = 0; l < psP->nLocal; l++ )
+        {
+            int* panIdx = psP->panLocalIdx + (size_t)l * Q;
+            double* padfCoef = psP->padfLocalCoef + (size_t)l * Q;
+            const int iPoint = panOrder[l];
+
+/* -------------------------------------------------------------------- */
+/*      Q-1 nearest neighbours among the following points, by partial   */
+/*      selection sort on the candidate distances.                      */
+/* -------------------------------------------------------------------- */
+            const int nCandidates = N - l - 1;
+            for( i = 0; i < nCandidates; i++ )
+            {
+                panCandidates[i] = panOrder[l + 1 + i];
+                padfDist[i] = SQ( x[panCandidates[i]] - x[iPoint] ) +
+                              SQ( y[panCandidates[i]] - y[iPoint] );
+            }
+            panIdx[0] = iPoint;
+            for( i = 0; i < Q - 1; i++ )
+            {
+                int iMin = i;
+                for( int j = i + 1; j < nCandidates; j++ )
+                {
+                    if( padfDist[j] < padfDist[iMin] )
+                        iMin = j;
+                }
+                double dfTmp = padfDist[i];
+                padfDist[i] = padfDist[iMin];
+                padfDist[iMin] = dfTmp;
+                int nTmp = panCandidates[i];
+                panCandidates[i] = panCandidates[iMin];
+                panCandidates[iMin] = nTmp;
+                panIdx[i + 1] = panCandidates[i];
+            }
+
+/* -------------------------------------------------------------------- */
+/*      Lagrange function of the point on this set. If the local        */
+/*      system is singular (e.g. collinear points), it is skipped by    */
+/*      flagging a non positive own coefficient.                        */
+/* -------------------------------------------------------------------- */
+            if( VizGeorefSplineLocalSystem( Q, panIdx, x, y,
+                                            padfLocalA, panLocalPivot ) )
+            {
+                memset( padfRHS, 0, (Q + 3) * sizeof(double) );
+                padfRHS[0] = 1.0;
+                VizGeorefSplineLUSolve( Q + 3, padfLocalA, panLocalPivot,
+                                        padfRHS );
+                memcpy( padfCoef, padfRHS, Q * sizeof(double) );
+            }
+            else
+                padfCoef[0] = 0.0;
+        }
+
+        for( i = 0; i < Q; i++ )
+            psP->panFinalIdx[i] = panOrder[psP->nLocal + i];
+        bRet = VizGeorefSplineLocalSystem( Q, psP->panFinalIdx, x, y,
+                                           psP->padfFinalLU,
+                                           psP->panFinalPivot );
+    }
+
+    VSIFree( panOrder );
+    VSIFree( padfDist );
+    VSIFree( panCandidates );
+    VSIFree( padfLocalA );
+    VSIFree( panLocalPivot );
+    VSIFree( padfRHS );
+
+    if( !bRet )
+        VizGeorefSplineFreePrecond( psP );
+    return bRet;
+}
+
+int VizGeorefSpline2D::solve_iterative()
+{
+    const int N = _nof_points;
+    int i, j, k, v;
+
+    if( N <= VIZ_GEOREF_SPLINE_LOCAL_POINTS )
+        return 0;
+
+/* -------------------------------------------------------------------- */
+/*      Orthonormal basis Q of the span of (1, x, y), P = Q R, by       */
+/*      modified Gram-Schmidt with one reorthogonalization pass.        */
+/*      Coordinates are centered to limit cancellation.                 */
+/* -------------------------------------------------------------------- */
+    double dfXMean = 0.0, dfYMean = 0.0;
+    for( i = 0; i < N; i++ )
+    {
+        dfXMean += x[i];
+        dfYMean += y[i];
+    }
+    dfXMean /= N;
+    dfYMean /= N;
+
+    double* padfQ = (double*) VSIMalloc3( 3, N, sizeof(double) );
+    double* padfW = (double*) VSIMalloc3( 8, N, sizeof(double) );
+    VizGeorefSplinePrecond sPrecond;
+    if( padfQ == NULL || padfW == NULL ||
+        !VizGeorefSplineInitPrecond( &sPrecond, N, x, y ) )
+    {
+        VSIFree( padfQ );
+        VSIFree( padfW );
+        return 0;
+    }
+    double* padfF = padfW;           /* values to interpolate */
+    double* padfKC = padfW + N;      /* K c, values of the current spline */
+    double* padfRes = padfW + 2 * N; /* residual at the points */
+    double* padfR = padfW + 3 * N;   /* CG residual Xi e */
+    double* padfKR = padfW + 4 * N;
+    double* padfD = padfW + 5 * N;   /* CG search direction */
+    double* padfKD = padfW + 6 * N;
+    double* padfXiD = padfW + 7 * N;
+
+    double adfR[3][3] = { {0,0,0}, {0,0,0}, {0,0,0} };
+    for( k = 0; k < 3; k++ )
+    {
+        double* padfQk = padfQ + k * N;
+        for( i = 0; i < N; i++ )
+            padfQk[i] = (k == 0) ? 1.0 : (k == 1) ? x[i] - dfXMean
+                                                  : y[i] - dfYMean;
+        for( int nPass = 0; nPass < 2; nPass++ )
+        {
+            for( j = 0; j < k; j++ )
+            {
+                const double* padfQj = padfQ + j * N;
+                double dfDot = 0.0;
+                for( i = 0; i < N; i++ )
+                    dfDot += padfQj[i] * padfQk[i];
+                for( i = 0; i < N; i++ )
+                    padfQk[i] -= dfDot * padfQj[i];
+                adfR[j][k] += dfDot;
+            }
+        }
+        double dfNorm = 0.0;
+        for( i = 0; i < N; i++ )
+            dfNorm += padfQk[i] * padfQk[i];
+        dfNorm = sqrt(dfNorm);
+        adfR[k][k] = dfNorm;
+        if( dfNorm == 0.0 )
+            break;
+        for( i = 0; i < N; i++ )
+            padfQk[i] /= dfNorm;
+    }
+    if( adfR[0][0] == 0.0 || adfR[1][1] == 0.0 || adfR[2][2] == 0.0 )
+    {
+        VizGeorefSplineFreePrecond( &sPrecond );
+        VSIFree( padfQ );
+        VSIFree( padfW );
+        return 0;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Kernel matrix, if it fits in memory.                            */
+/* -------------------------------------------------------------------- */
+    double* padfK = (double*) VSIMalloc3( N, N, sizeof(double) );
+    if( padfK != NULL )
+    {
+        for( i = 0; i < N; i++ )
+        {
+            padfK[(size_t)i * N + i] = 0.0;
+            for( j = i + 1; j < N; j++ )
+            {
+                double dfVal = VizGeorefSpline2DBase_func( x[i], y[i], x[j], y[j] );
+                padfK[(size_t)i * N + j] = dfVal;
+                padfK[(size_t)j * N + i] = dfVal;
+            }
+        }
+    }
+    else
+    {
+        CPLDebug( "TPS", "Cannot allocate kernel matrix. "
+                  "It will be recomputed at each iteration." );
+    }
+
+    int bConverged = TRUE;
+
+    for( v = 0; v < _nof_vars && bConverged; v++ )
+    {
+        double* padfC = coef[v] + 3;
+
+/* -------------------------------------------------------------------- */
+/*      The convergence criterion is the residual at the points, once   */
+/*      the best affine part is removed, relative to the range of the   */
+/*      values to interpolate.                                          */
+/* -------------------------------------------------------------------- */
+        double dfMin = rhs[v][3], dfMax = rhs[v][3];
+        for( i = 0; i < N; i++ )
+        {
+            padfF[i] = rhs[v][i + 3];
+            dfMin = MIN( dfMin, padfF[i] );
+            dfMax = MAX( dfMax, padfF[i] );
+        }
+        const double dfTol = 1e-9 * MAX( dfMax - dfMin, 1e-300 );
+
+        memset( padfC, 0, N * sizeof(double) );
+        memset( padfKC, 0, N * sizeof(double) );
+
+        int nIter = 0;
+        double dfResMax = 0.0;
+        /* Restart CG from the current solution with exactly recomputed */
+        /* values if rounding errors in the recurrences prevent */
+        /* convergence. */
+        for( int nRestart = 0; nRestart < 3; nRestart++ )
+        {
+            if( nRestart > 0 )
+                VizGeorefSplineKernelProduct( N, padfK, x, y, padfC, padfKC );
+
+            for( i = 0; i < N; i++ )
+                padfRes[i] = padfF[i] - padfKC[i];
+            VizGeorefSplineProject( N, padfQ, padfRes );
+            dfResMax = 0.0;
+            for( i = 0; i < N; i++ )
+                dfResMax = MAX( dfResMax, fabs(padfRes[i]) );
+            if( dfResMax <= dfTol )
+                break;
+
+            VizGeorefSplineApplyXi( &sPrecond, padfRes, padfR );
+            VizGeorefSplineKernelProduct( N, padfK, x, y, padfR, padfKR );
+            double dfRR = 0.0;
+            for( i = 0; i < N; i++ )
+                dfRR += padfR[i] * padfKR[i];
+            memcpy( padfD, padfR, N * sizeof(double) );
+            memcpy( padfKD, padfKR, N * sizeof(double) );
+
+            for( ; nIter < VIZ_GEOREF_SPLINE_MAX_ITER; nIter++ )
+            {
+                /* Xi d, from the values of d at the points */
+                VizGeorefSplineApplyXi( &sPrecond, padfKD, padfXiD );
+                double dfDXiD = 0.0;
+                for( i = 0; i < N; i++ )
+                    dfDXiD += padfKD[i] * padfXiD[i];
+                if( !(dfDXiD > 0.0) || !(dfRR > 0.0) )
+                    break;
+
+                double dfAlpha = dfRR / dfDXiD;
+                for( i = 0; i < N; i++ )
+                {
+                    padfC[i] += dfAlpha * padfD[i];
+                    padfKC[i] += dfAlpha * padfKD[i];
+                    padfRes[i] = padfF[i] - padfKC[i];
+                }
+                VizGeorefSplineProject( N, padfQ, padfRes );
+                dfResMax = 0.0;
+                for( i = 0; i < N; i++ )
+                    dfResMax = MAX( dfResMax, fabs(padfRes[i]) );
+                if( dfResMax <= dfTol )
+                {
+                    nIter++;
+                    break;
+                }
+
+                for( i = 0; i < N; i++ )
+                    padfR[i] -= dfAlpha * padfXiD[i];
+                VizGeorefSplineKernelProduct( N, padfK, x, y, padfR, padfKR );
+                double dfRRNew = 0.0;
+                for( i = 0; i < N; i++ )
+                    dfRRNew += padfR[i] * padfKR[i];
+                double dfBeta = dfRRNew / dfRR;
+                dfRR = dfRRNew;
+                for( i = 0; i < N; i++ )
+                {
+                    padfD[i] = padfR[i] + dfBeta * padfD[i];
+                    padfKD[i] = padfKR[i] + dfBeta * padfKD[i];
+                }
+            }
+        }
+
+        CPLDebug( "TPS", "Iterative solver: %d iterations, residual = %g",
+                  nIter, dfResMax );
+        if( dfResMax > dfTol )
+        {
+            bConverged = FALSE;
+            break;
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Affine part: R a' = Q^T (f - K c), with a' expressed in the     */
+/*      centered coordinates.                                           */
+/* -------------------------------------------------------------------- */
+        double adfQtF[3], adfA[3];
+        for( k = 0; k < 3; k++ )
+        {
+            const double* padfQk = padfQ + k * N;
+            adfQtF[k] = 0.0;
+            for( i = 0; i < N; i++ )
+                adfQtF[k] += padfQk[i] * (padfF[i] - padfKC[i]);
+        }
+        for( k = 2; k >= 0; k-- )
+        {
+            adfA[k] = adfQtF[k];
+            for( j = k + 1; j < 3; j++ )
+                adfA[k] -= adfR[k][j] * adfA[j];
+            adfA[k] /= adfR[k][k];
+        }
+        coef[v][0] = adfA[0] - adfA[1] * dfXMean - adfA[2] * dfYMean;
+        coef[v][1] = adfA[1];
+        coef[v][2] = adfA[2];
+    }
+
+    VizGeorefSplineFreePrecond( &sPrecond );
+    VSIFree( padfK );
+    VSIFree( padfQ );
+    VSIFree( padfW );
+
+    return bConverged;
+}
+
+/************************************************************************/
+/*                           grid_add_nodes()                           */
+/************************************************************************/
+
+int VizGeorefSpline2D::grid_add_nodes( int nCount )
+{
+    if( _grid_nof_nodes + nCount > _grid_max_nodes )
+    {
+        if( _grid_nof_nodes + nCount > VIZ_GEOREF_GRID_MAX_NODES )
+            return -1;
+        int nNewMax = MIN( VIZ_GEOREF_GRID_MAX_NODES,
+                           MAX( _grid_nof_nodes + nCount,
+                                _grid_max_nodes + _grid_max_nodes / 2 ) );
+        VizGeorefSplineGridNode* pasNew = (VizGeorefSplineGridNode*)
+            VSIRealloc( _grid_nodes, nNewMax * sizeof(VizGeorefSplineGridNode) );
+        if( pasNew == NULL )
+            return -1;
+        _grid_nodes = pasNew;
+        _grid_max_nodes = nNewMax;
+    }
+    int iFirst = _grid_nof_nodes;
+    _grid_nof_nodes += nCount;
+    return iFirst;
+}
+
+/************************************************************************/
+/*                          grid_build_node()                           */
+/*                                                                      */
+/*      The corners of node iNode are already set. Compares the         */
+/*      bilinear interpolation with the exact value at the center and   */
+/*      at the middle of the edges, and splits the node in 4 if the     */
+/*      error exceeds the tolerance. The 9 values computed here are     */
+/*      exactly the corners of the children.                            */
+/************************************************************************/
+
+int VizGeorefSpline2D::grid_build_node( int iNode, int depth,
+                                        double x0, double y0,
+                                        double w, double h )
+{
+    double adfVal[9][VIZGEOREF_MAX_VARS];
+    int v, k;
+
+    /* 3x3 stencil: index = 3 * row + col */
+    static const int anCornerIdx[4] = { 0, 2, 6, 8 };
+    for( k = 0; k < 4; k++ )
+        for( v = 0; v < _nof_vars; v++ )
+            adfVal[anCornerIdx[k]][v] = _grid_nodes[iNode].adfCorner[k][v];
+
+    get_point_full( x0 + w / 2, y0, adfVal[1] );
+    get_point_full( x0, y0 + h / 2, adfVal[3] );
+    get_point_full( x0 + w / 2, y0 + h / 2, adfVal[4] );
+    get_point_full( x0 + w, y0 + h / 2, adfVal[5] );
+    get_point_full( x0 + w / 2, y0 + h, adfVal[7] );
+
+    double dfMaxErr = 0.0;
+    for( v = 0; v < _nof_vars; v++ )
+    {
+        double dfErr;
+        dfErr = fabs( adfVal[1][v] - (adfVal[0][v] + adfVal[2][v]) / 2 );
+        dfMaxErr = MAX( dfMaxErr, dfErr );
+        dfErr = fabs( adfVal[3][v] - (adfVal[0][v] + adfVal[6][v]) / 2 );
+        dfMaxErr = MAX( dfMaxErr, dfErr );
+        dfErr = fabs( adfVal[5][v] - (adfVal[2][v] + adfVal[8][v]) / 2 );
+        dfMaxErr = MAX( dfMaxErr, dfErr );
+        dfErr = fabs( adfVal[7][v] - (adfVal[6][v] + adfVal[8][v]) / 2 );
+        dfMaxErr = MAX( dfMaxErr, dfErr );
+        dfErr = fabs( adfVal[4][v] - (adfVal[0][v] + adfVal[2][v] +
+                                      adfVal[6][v] + adfVal[8][v]) / 4 );
+        dfMaxErr = MAX( dfMaxErr, dfErr );
+    }
+
+    if( dfMaxErr <= _grid_toler )
+    {
+        _grid_nodes[iNode].nChild = VIZ_GEOREF_GRID_LEAF;
+        return TRUE;
+    }
+
+    int iChild = -1;
+    if( depth < VIZ_GEOREF_GRID_MAX_DEPTH )
+        iChild = grid_add_nodes( 4 );
+    if( iChild < 0 )
+    {
+        /* Too deep or too many nodes: use exact evaluation in this cell */
+        _grid_nodes[iNode].nChild = VIZ_GEOREF_GRID_EXACT;
+        return TRUE;
+    }
+    _grid_nodes[iNode].nChild = iChild;
+
+    for( int iSub = 0; iSub < 4; iSub++ )
+    {
+        int nCol = iSub % 2, nRow = iSub / 2;
+        VizGeorefSplineGridNode* psChild = &_grid_nodes[iChild + iSub];
+        for( k = 0; k < 4; k++ )
+        {
+            int iVal = 3 * (nRow + k / 2) + (nCol + k % 2);
+            for( v = 0; v < _nof_vars; v++ )
+                psChild->adfCorner[k][v] = adfVal[iVal][v];
+        }
+    }
+    for( int iSub = 0; iSub < 4; iSub++ )
+    {
+        int nCol = iSub % 2, nRow = iSub / 2;
+        grid_build_node( iChild + iSub, depth + 1,
+                         x0 + nCol * w / 2, y0 + nRow * h / 2, w / 2, h / 2 );
+    }
+    return TRUE;
+}
+
+/************************************************************************/
+/*                             build_grid()                             */
+/*                                                                      */
+/*      Precomputes an adaptive interpolation grid over the extent of   */
+/*      the control points (with a margin), so that get_point() costs   */
+/*      a quadtree lookup and a bilinear interpolation instead of a     */
+/*      sum over all the control points. Each cell is refined until     */
+/*      the bilinear interpolation matches the exact spline within      */
+/*      tolerance at its center and edge midpoints; cells that cannot   */
+/*      be refined enough, and points outside of the grid, fall back    */
+/*      to exact evaluation.                                            */
+/************************************************************************/
+
+int VizGeorefSpline2D::build_grid( double tolerance )
+{
+    int i, j, v;
+
+    CPLFree( _grid_nodes );
+    _grid_nodes = NULL;
+    _grid_nof_nodes = 0;
+    _grid_max_nodes = 0;
+
+    if( type != VIZ_GEOREF_SPLINE_FULL || !(tolerance > 0) )
+        return FALSE;
+
+    double xmin = x[0], xmax = x[0], ymin = y[0], ymax = y[0];
+    for( i = 1; i < _nof_points; i++ )
+    {
+        xmin = MIN( xmin, x[i] );
+        xmax = MAX( xmax, x[i] );
+        ymin = MIN( ymin, y[i] );
+        ymax = MAX( ymax, y[i] );
+    }
+    double dfMarginX = (xmax - xmin) * 0.1, dfMarginY = (ymax - ymin) * 0.1;
+    xmin -= dfMarginX;
+    xmax += dfMarginX;
+    ymin -= dfMarginY;
+    ymax += dfMarginY;
+
+    /* Base grid resolution of the order of the control point spacing */
+    int nBase = (int) sqrt( (double) _nof_points );
+    nBase = MAX( 16, MIN( 256, nBase ) );
+    if( xmax - xmin >= ymax - ymin )
+    {
+        _grid_nx = nBase;
+        _grid_ny = MAX( 1, (int)(nBase * (ymax - ymin) / (xmax - xmin) + 0.5) );
+    }
+    else
+    {
+        _grid_ny = nBase;
+        _grid_nx = MAX( 1, (int)(nBase * (xmax - xmin) / (ymax - ymin) + 0.5) );
+    }
+    _grid_xmin = xmin;
+    _grid_ymin = ymin;
+    _grid_cell_w = (xmax - xmin) / _grid_nx;
+    _grid_cell_h = (ymax - ymin) / _grid_ny;
+    _grid_toler = tolerance;
+
+    double* padfCornerVals = (double*) VSIMalloc3( (_grid_nx + 1) * (_grid_ny + 1),
+                                                   VIZGEOREF_MAX_VARS,
+                                                   sizeof(double) );
+    if( padfCornerVals == NULL || grid_add_nodes( _grid_nx * _grid_ny ) < 0 )
+    {
+        VSIFree( padfCornerVals );
+        CPLFree( _grid_nodes );
+        _grid_nodes = NULL;
+        _grid_nof_nodes = 0;
+        _grid_max_nodes = 0;
+        return FALSE;
+    }
+
+    for( j = 0; j <= _grid_ny; j++ )
+        for( i = 0; i <= _grid_nx; i++ )
+            get_point_full( xmin + i * _grid_cell_w, ymin + j * _grid_cell_h,
+                            padfCornerVals +
+                                (j * (_grid_nx + 1) + i) * VIZGEOREF_MAX_VARS );
+
+    for( j = 0; j < _grid_ny; j++ )
+    {
+        for( i = 0; i < _grid_nx; i++ )
+        {
+            VizGeorefSplineGridNode* psNode = &_grid_nodes[j * _grid_nx + i];
+            for( int k = 0; k < 4; k++ )
+            {
+                int iCorner = (j + k / 2) * (_grid_nx + 1) + i + k % 2;
+                for( v = 0; v < _nof_vars; v++ )
+                    psNode->adfCorner[k][v] =
+                        padfCornerVals[iCorner * VIZGEOREF_MAX_VARS + v];
+            }
+            grid_build_node( j * _grid_nx + i, 0,
+                             xmin + i * _grid_cell_w, ymin + j * _grid_cell_h,
+                             _grid_cell_w, _grid_cell_h );
+        }
+    }
+    VSIFree( padfCornerVals );
+
+    CPLDebug( "TPS", "Interpolation grid: %dx%d base cells, %d nodes",
+              _grid_nx, _grid_ny, _grid_nof_nodes );
+
+    return TRUE;
+}
+
 #ifndef HAVE_ARMADILLO
 static int matrixInvert( int N, double input[], double output[] )
 {
@@ -46,9 +46,28 @@ typedef enum
 
 } vizGeorefInterType;
 
+typedef enum
+{
+	VIZ_GEOREF_SPLINE_SOLVER_AUTO,
+	VIZ_GEOREF_SPLINE_SOLVER_DIRECT,
+	VIZ_GEOREF_SPLINE_SOLVER_ITERATIVE
+} vizGeorefSolverType;
+
 //#define VIZ_GEOREF_SPLINE_MAX_POINTS 40
 #define VIZGEOREF_MAX_VARS 2
 
+/* Node of the precomputed interpolation grid. A node is either split into */
+/* 4 children stored contiguously from nChild, or is a leaf (nChild < 0) */
+/* holding the spline values at its 4 corners. */
+#define VIZ_GEOREF_GRID_LEAF   -1
+#define VIZ_GEOREF_GRID_EXACT  -2
+
+typedef struct
+{
+    int    nChild;
+    double adfCorner[4][VIZGEOREF_MAX_VARS];
+} VizGeorefSplineGridNode;
+
 class VizGeorefSpline2D
 {
   public:
@@ -67,6 +86,9 @@ class VizGeorefSpline2D
         _nof_points = 0;
         _nof_vars = nof_vars;
         _max_nof_points = 0;
+        _grid_nodes = NULL;
+        _grid_nof_nodes = 0;
+        _grid_max_nodes = 0;
         grow_points();
         type = VIZ_GEOREF_SPLINE_ZERO_POINTS;
     }
@@ -77,6 +99,7 @@ class VizGeorefSpline2D
         CPLFree( u );
         CPLFree( unused );
         CPLFree( index );
+        CPLFree( _grid_nodes );
         for( int i = 0; i < _nof_vars; i++ )
         {
             CPLFree( rhs[i] );
@@ -141,10 +164,18 @@ class VizGeorefSpline2D
     bool change_point(int index, double x, double y, double* Pvars);
     void reset(void) { _nof_points = 0; }
 #endif
-    int solve(void);
+    int solve( vizGeorefSolverType eSolver = VIZ_GEOREF_SPLINE_SOLVER_DIRECT );
+    int build_grid( double tolerance );
+    int has_grid() const { return _grid_nodes != NULL; }
 
   private:	
 
+    void get_point_full( const double Px, const double Py, double *vars );
+    int solve_iterative();
+    int grid_add_nodes( int nCount );
+    int grid_build_node( int iNode, int depth, double x0, double y0,
+                         double w, double h );
+
     vizGeorefInterType type;
 
     int _nof_vars;
@@ -167,4 +198,13 @@ class VizGeorefSpline2D
     double *u; // [VIZ_GEOREF_SPLINE_MAX_POINTS];
     int *unused; // [VIZ_GEOREF_SPLINE_MAX_POINTS];
     int *index; // [VIZ_GEOREF_SPLINE_MAX_POINTS];
+
+    // Precomputed interpolation grid (see build_grid())
+    VizGeorefSplineGridNode *_grid_nodes;
+    int _grid_nof_nodes;
+    int _grid_max_nodes;
+    int _grid_nx, _grid_ny;
+    double _grid_xmin, _grid_ymin;
+    double _grid_cell_w, _grid_cell_h;
+    double _grid_toler;
 };
@@ -0,0 +1,266 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Check that blocks read ahead by the API proxy client do not
+ *           hide the data written through it
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal_priv.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+
+CPL_CVSID("$Id$");
+
+static int nErrors = 0;
+
+#define CHECK(x) \
+    do { if( !(x) ) { fprintf(stderr, "%s:%d: check '%s' failed\n", \
+                              __FILE__, __LINE__, #x); nErrors++; } } while(0)
+
+#define RASTER_XSIZE    1024
+#define RASTER_YSIZE    256
+#define BLOCK_XSIZE     128
+#define BLOCK_YSIZE     64
+#define BLOCK_PIXELS    (BLOCK_XSIZE * BLOCK_YSIZE)
+
+/************************************************************************/
+/*                              Pattern()                               */
+/************************************************************************/
+
+static GInt16 Pattern( int iX, int iY, int nSeed )
+
+{
+    return (GInt16) ((iX * 7 + iY * 31 + nSeed * 1009) % 30011);
+}
+
+/************************************************************************/
+/*                             CheckBlock()                             */
+/*                                                                      */
+/*      Read the block through the proxy and compare it with the        */
+/*      expected raster.                                                */
+/************************************************************************/
+
+static void CheckBlock( GDALRasterBand *poBand, int nBlockXOff,
+                        int nBlockYOff, const GInt16 *panExpected )
+
+{
+    GInt16 anBlock[BLOCK_PIXELS];
+    int nDiff = 0;
+
+    CHECK( poBand->ReadBlock( nBlockXOff, nBlockYOff, anBlock ) == CE_None );
+
+    for( int iY = 0; iY < BLOCK_YSIZE; iY++ )
+    {
+        for( int iX = 0; iX < BLOCK_XSIZE; iX++ )
+        {
+            const int iRasterX = nBlockXOff * BLOCK_XSIZE + iX;
+            const int iRasterY = nBlockYOff * BLOCK_YSIZE + iY;
+            if( anBlock[iY * BLOCK_XSIZE + iX]
+                != panExpected[iRasterY * RASTER_XSIZE + iRasterX] )
+                nDiff++;
+        }
+    }
+
+    if( nDiff != 0 )
+    {
+        fprintf( stderr, "  block %d,%d: %d pixel(s) differ\n",
+                 nBlockXOff, nBlockYOff, nDiff );
+        nErrors++;
+    }
+}
+
+/************************************************************************/
+/*                              FillRect()                              */
+/*                                                                      */
+/*      Fill a buffer and the matching window of the expected raster.   */
+/************************************************************************/
+
+static void FillRect( GInt16 *panExpected, GInt16 *panBuf,
+                      int nXOff, int nYOff, int nXSize, int nYSize,
+                      int nSeed )
+
+{
+    for( int iY = 0; iY < nYSize; iY++ )
+    {
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            const GInt16 nVal = Pattern( nXOff + iX, nYOff + iY, nSeed );
+            panBuf[iY * nXSize + iX] = nVal;
+            panExpected[(nYOff + iY) * RASTER_XSIZE + nXOff + iX] = nVal;
+        }
+    }
+}
+
+/************************************************************************/
+/*                              RunCase()                               */
+/************************************************************************/
+
+static void RunCase( const char *pszFilename, const char *pszShm )
+
+{
+    GInt16 *panExpected = (GInt16 *)
+        CPLMalloc( sizeof(GInt16) * RASTER_XSIZE * RASTER_YSIZE );
+    GInt16 *panBuf = (GInt16 *)
+        CPLMalloc( sizeof(GInt16) * RASTER_XSIZE * RASTER_YSIZE );
+
+    printf( "GDAL_API_PROXY_SHM=%s\n", pszShm );
+    CPLSetConfigOption( "GDAL_API_PROXY_SHM", pszShm );
+
+/* -------------------------------------------------------------------- */
+/*      Create the file directly.                                       */
+/* -------------------------------------------------------------------- */
+    GDALDriver *poDriver = (GDALDriver *) GDALGetDriverByName( "GTiff" );
+    char **papszOptions = CSLSetNameValue( NULL, "TILED", "YES" );
+    papszOptions = CSLSetNameValue( papszOptions, "BLOCKXSIZE",
+                                    CPLSPrintf( "%d", BLOCK_XSIZE ) );
+    papszOptions = CSLSetNameValue( papszOptions, "BLOCKYSIZE",
+                                    CPLSPrintf( "%d", BLOCK_YSIZE ) );
+    GDALDataset *poDS = poDriver->Create( pszFilename, RASTER_XSIZE,
+                                          RASTER_YSIZE, 1, GDT_Int16,
+                                          papszOptions );
+    CSLDestroy( papszOptions );
+    CHECK( poDS != NULL );
+    if( poDS == NULL )
+    {
+        CPLFree( panExpected );
+        CPLFree( panBuf );
+        return;
+    }
+
+    FillRect( panExpected, panBuf, 0, 0, RASTER_XSIZE, RASTER_YSIZE, 0 );
+    CHECK( poDS->GetRasterBand(1)->RasterIO( GF_Write, 0, 0, RASTER_XSIZE,
+                                             RASTER_YSIZE, panBuf,
+                                             RASTER_XSIZE, RASTER_YSIZE,
+                                             GDT_Int16, 0, 0, NULL ) == CE_None );
+    GDALClose( poDS );
+
+/* -------------------------------------------------------------------- */
+/*      Open it through the proxy.                                      */
+/* -------------------------------------------------------------------- */
+    poDS = (GDALDataset *)
+        GDALOpen( CPLSPrintf( "API_PROXY:%s", pszFilename ), GA_Update );
+    CHECK( poDS != NULL );
+    if( poDS == NULL )
+    {
+        CPLFree( panExpected );
+        CPLFree( panBuf );
+        return;
+    }
+    GDALRasterBand *poBand = poDS->GetRasterBand( 1 );
+
+/* -------------------------------------------------------------------- */
+/*      Reading blocks 0 and 1 of a row in sequence reads ahead the     */
+/*      rest of the row.  Write into that row with WriteBlock(), band   */
+/*      RasterIO() and dataset RasterIO(), and read it back.  As with   */
+/*      any dataset, ReadBlock() does not look into the block cache,    */
+/*      so the cache is flushed after RasterIO().                       */
+/* -------------------------------------------------------------------- */
+    CheckBlock( poBand, 0, 0, panExpected );
+    CheckBlock( poBand, 1, 0, panExpected );
+    FillRect( panExpected, panBuf, 4 * BLOCK_XSIZE, 0,
+              BLOCK_XSIZE, BLOCK_YSIZE, 1 );
+    CHECK( poBand->WriteBlock( 4, 0, panBuf ) == CE_None );
+    for( int iBlock = 2; iBlock < RASTER_XSIZE / BLOCK_XSIZE; iBlock++ )
+        CheckBlock( poBand, iBlock, 0, panExpected );
+
+    CheckBlock( poBand, 0, 1, panExpected );
+    CheckBlock( poBand, 1, 1, panExpected );
+    FillRect( panExpected, panBuf, 300, 70, 400, 30, 2 );
+    CHECK( poBand->RasterIO( GF_Write, 300, 70, 400, 30, panBuf, 400, 30,
+                             GDT_Int16, 0, 0, NULL ) == CE_None );
+    CHECK( poBand->FlushCache() == CE_None );
+    for( int iBlock = 2; iBlock < RASTER_XSIZE / BLOCK_XSIZE; iBlock++ )
+        CheckBlock( poBand, iBlock, 1, panExpected );
+
+    CheckBlock( poBand, 0, 2, panExpected );
+    CheckBlock( poBand, 1, 2, panExpected );
+    FillRect( panExpected, panBuf, 500, 130, 200, 20, 3 );
+    CHECK( poDS->RasterIO( GF_Write, 500, 130, 200, 20, panBuf, 200, 20,
+                           GDT_Int16, 1, NULL, 0, 0, 0,
+                           NULL ) == CE_None );
+    poDS->FlushCache();
+    for( int iBlock = 2; iBlock < RASTER_XSIZE / BLOCK_XSIZE; iBlock++ )
+        CheckBlock( poBand, iBlock, 2, panExpected );
+
+/* -------------------------------------------------------------------- */
+/*      Check the whole raster through the proxy, then directly.        */
+/* -------------------------------------------------------------------- */
+    CHECK( poBand->RasterIO( GF_Read, 0, 0, RASTER_XSIZE, RASTER_YSIZE,
+                             panBuf, RASTER_XSIZE, RASTER_YSIZE,
+                             GDT_Int16, 0, 0, NULL ) == CE_None );
+    CHECK( memcmp( panBuf, panExpected,
+                   sizeof(GInt16) * RASTER_XSIZE * RASTER_YSIZE ) == 0 );
+    GDALClose( poDS );
+
+    poDS = (GDALDataset *) GDALOpen( pszFilename, GA_ReadOnly );
+    CHECK( poDS != NULL );
+    if( poDS != NULL )
+    {
+        CHECK( poDS->GetRasterBand(1)->RasterIO( GF_Read, 0, 0,
+                                                 RASTER_XSIZE, RASTER_YSIZE,
+                                                 panBuf, RASTER_XSIZE,
+                                                 RASTER_YSIZE, GDT_Int16,
+                                                 0, 0, NULL ) == CE_None );
+        CHECK( memcmp( panBuf, panExpected,
+                       sizeof(GInt16) * RASTER_XSIZE * RASTER_YSIZE ) == 0 );
+        GDALClose( poDS );
+    }
+
+    poDriver->Delete( pszFilename );
+    CPLSetConfigOption( "GDAL_API_PROXY_SHM", NULL );
+    CPLFree( panExpected );
+    CPLFree( panBuf );
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char *argv[] )
+
+{
+    (void) argc;
+    (void) argv;
+
+    GDALAllRegister();
+
+    CPLString osFilename = CPLGenerateTempFilename( "testapiproxy" );
+    osFilename += ".tif";
+
+    RunCase( osFilename, "YES" );
+    RunCase( osFilename, "NO" );
+
+    GDALDestroyDriverManager();
+
+    if( nErrors != 0 )
+    {
+        fprintf( stderr, "%d check(s) failed\n", nErrors );
+        return 1;
+    }
+
+    printf( "All checks passed\n" );
+    return 0;
+}
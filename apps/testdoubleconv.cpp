@@ -0,0 +1,350 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Check and benchmark CPLDoubleToShortestString() and CPLStrtod()
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include <time.h>
+
+CPL_CVSID("$Id$");
+
+static int nErrors = 0;
+
+#define CHECK(x) \
+    do { if( !(x) ) { fprintf(stderr, "%s:%d: check '%s' failed\n", \
+                              __FILE__, __LINE__, #x); nErrors++; } } while(0)
+
+/************************************************************************/
+/*                               Usage()                                */
+/************************************************************************/
+
+static void Usage()
+
+{
+    printf( "Usage: testdoubleconv [-n count] [-iter count]\n" );
+    exit( 1 );
+}
+
+/************************************************************************/
+/*                              Elapsed()                               */
+/************************************************************************/
+
+static double Elapsed( clock_t nStart )
+
+{
+    return (double) (clock() - nStart) / CLOCKS_PER_SEC;
+}
+
+/************************************************************************/
+/*                               Report()                               */
+/************************************************************************/
+
+static void Report( const char *pszWhat, int nOps, double dfSeconds )
+
+{
+    printf( "%-32s %10d ops %8.3f s %10.2f Mops/s\n",
+            pszWhat, nOps, dfSeconds,
+            dfSeconds > 0 ? nOps / dfSeconds / 1e6 : 0.0 );
+}
+
+/************************************************************************/
+/*                             RandomUInt()                             */
+/************************************************************************/
+
+static GUIntBig RandomUInt( GUIntBig *pnSeed )
+
+{
+    *pnSeed = *pnSeed * (GUIntBig)6364136223846793005ULL +
+              (GUIntBig)1442695040888963407ULL;
+    return *pnSeed;
+}
+
+/************************************************************************/
+/*                             RandomBits()                             */
+/************************************************************************/
+
+static double RandomBits( GUIntBig *pnSeed )
+
+{
+    GUIntBig nBits = RandomUInt( pnSeed );
+    double dfVal;
+    memcpy( &dfVal, &nBits, sizeof(dfVal) );
+    return dfVal;
+}
+
+/************************************************************************/
+/*                             CheckValue()                             */
+/*                                                                      */
+/*      The string must read back as the same value, with both          */
+/*      CPLStrtod() and the system strtod().                            */
+/************************************************************************/
+
+static void CheckValue( double dfVal )
+
+{
+    char szShortest[32];
+    const int nLen = CPLDoubleToShortestString( dfVal, szShortest,
+                                                sizeof(szShortest) );
+    CHECK( nLen > 0 && nLen == (int) strlen(szShortest) );
+
+    if( CPLIsNan(dfVal) )
+    {
+        CHECK( strcmp(szShortest, "nan") == 0 );
+        return;
+    }
+
+    char *pszEnd = NULL;
+    const double dfRead = CPLStrtod( szShortest, &pszEnd );
+    const double dfSystem = strtod( szShortest, NULL );
+    if( memcmp(&dfRead, &dfVal, sizeof(double)) != 0 ||
+        memcmp(&dfSystem, &dfVal, sizeof(double)) != 0 ||
+        *pszEnd != '\0' )
+    {
+        fprintf( stderr, "%.17g written as %s does not round-trip\n",
+                 dfVal, szShortest );
+        nErrors ++;
+    }
+}
+
+/************************************************************************/
+/*                           CheckFormatting()                          */
+/************************************************************************/
+
+static void CheckFormatting()
+
+{
+    static const struct
+    {
+        double      dfVal;
+        const char *pszExpected;
+    } asTests[] =
+    {
+        { 0.0, "0" },
+        { -0.0, "-0" },
+        { 1.0, "1" },
+        { -2.5, "-2.5" },
+        { 0.1, "0.1" },
+        { 0.3, "0.3" },
+        { 0.1 + 0.2, "0.30000000000000004" },
+        { 123456.789, "123456.789" },
+        { 1e20, "100000000000000000000" },
+        { 1e21, "1e+21" },
+        { 1.5e-7, "1.5e-7" },
+        { 1.5e-6, "0.0000015" },
+        { 5e-324, "5e-324" },
+        { 1.7976931348623157e308, "1.7976931348623157e+308" },
+        { 2.2250738585072014e-308, "2.2250738585072014e-308" },
+        { 9007199254740993.0, "9007199254740992" },
+        { 45.123456789012344, "45.123456789012344" },
+        { -73.9856, "-73.9856" }
+    };
+
+    for( size_t i = 0; i < sizeof(asTests) / sizeof(asTests[0]); i++ )
+    {
+        char szBuffer[32];
+        CPLDoubleToShortestString( asTests[i].dfVal, szBuffer,
+                                   sizeof(szBuffer) );
+        if( strcmp(szBuffer, asTests[i].pszExpected) != 0 )
+        {
+            fprintf( stderr, "%.17g written as %s instead of %s\n",
+                     asTests[i].dfVal, szBuffer, asTests[i].pszExpected );
+            nErrors ++;
+        }
+    }
+
+    char szSmall[4];
+    CHECK( CPLDoubleToShortestString( 0.125, szSmall, sizeof(szSmall) ) < 0 );
+    CHECK( CPLDoubleToShortestString( 0.5, szSmall, sizeof(szSmall) ) == 3 );
+}
+
+/************************************************************************/
+/*                            CheckParsing()                            */
+/************************************************************************/
+
+static void CheckParsing()
+
+{
+    static const char* const apszTests[] =
+    {
+        "0", "-0", "+1", "1.", ".5", "-.5", "00012.5000", "1e10", "1E-10",
+        "1.5e+300", "1e-400", "1e400", "0e999999", "123456789012345678",
+        "1234567890123456789012", "9007199254740993", "0.1", "2.5e-3 x",
+        "1e", "1e+", "1.5d3", "0x10", "12,5", "  7.25", "4503599627370497.5",
+        "0.000000000000000000000000000001", "17976931348623157e292",
+        "-45.123456789012345", "1.#INF", "-inf", "nan", "abc", "-", "."
+    };
+
+    for( size_t i = 0; i < sizeof(apszTests) / sizeof(apszTests[0]); i++ )
+    {
+        char *pszEnd = NULL;
+        char *pszSystemEnd = NULL;
+        const double dfVal = CPLStrtod( apszTests[i], &pszEnd );
+        const double dfSystem = strtod( apszTests[i], &pszSystemEnd );
+        if( CPLIsNan(dfVal) || CPLIsNan(dfSystem) ||
+            strchr(apszTests[i], '#') != NULL )
+            continue;
+        if( memcmp(&dfVal, &dfSystem, sizeof(double)) != 0 ||
+            pszEnd != pszSystemEnd )
+        {
+            fprintf( stderr, "CPLStrtod(\"%s\") = %.17g (%d chars), "
+                     "strtod() = %.17g (%d chars)\n",
+                     apszTests[i], dfVal, (int) (pszEnd - apszTests[i]),
+                     dfSystem, (int) (pszSystemEnd - apszTests[i]) );
+            nErrors ++;
+        }
+    }
+
+    /* Decimal delimiter */
+    CHECK( CPLAtofDelim( "12,5", ',' ) == 12.5 );
+    CHECK( CPLAtofDelim( "12.5", ',' ) == 12.0 );
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char *argv[] )
+
+{
+    int nCount = 1000000;
+    int nIter = 5;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        if( EQUAL(argv[i], "-n") && i + 1 < argc )
+            nCount = atoi( argv[++i] );
+        else if( EQUAL(argv[i], "-iter") && i + 1 < argc )
+            nIter = atoi( argv[++i] );
+        else
+            Usage();
+    }
+    if( nCount <= 0 || nIter <= 0 )
+        Usage();
+
+    CheckFormatting();
+    CheckParsing();
+
+/* -------------------------------------------------------------------- */
+/*      Round-trip of arbitrary bit patterns, and of coordinate like    */
+/*      values.                                                         */
+/* -------------------------------------------------------------------- */
+    GUIntBig nSeed = 1;
+    int i, iIter;
+
+    for( i = 0; i < nCount; i++ )
+        CheckValue( RandomBits( &nSeed ) );
+
+    double *padfValues = (double *) CPLMalloc( sizeof(double) * nCount );
+    for( i = 0; i < nCount; i++ )
+    {
+        /* Longitudes with 7 decimals, and full precision values as */
+        /* produced by a reprojection */
+        const GUIntBig nRandom = RandomUInt( &nSeed ) >> 11;
+        if( i % 2 == 0 )
+            padfValues[i] = (int) (nRandom % 3600000000U) / 1e7 - 180.0;
+        else
+            padfValues[i] = nRandom / 9007199254740992.0 * 1e6;
+        CheckValue( padfValues[i] );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Formatting.                                                     */
+/* -------------------------------------------------------------------- */
+    char **papszStrings = (char **) CPLMalloc( sizeof(char*) * nCount );
+    char szBuffer[32];
+    size_t nTotalLen = 0;
+    clock_t nStart;
+
+    printf( "%d coordinate like values:\n", nCount );
+
+    nStart = clock();
+    for( iIter = 0; iIter < nIter; iIter++ )
+        for( i = 0; i < nCount; i++ )
+            nTotalLen += CPLsnprintf( szBuffer, sizeof(szBuffer), "%.15g",
+                                      padfValues[i] );
+    Report( "  CPLsnprintf(\"%.15g\")", nCount * nIter, Elapsed( nStart ) );
+
+    nStart = clock();
+    for( iIter = 0; iIter < nIter; iIter++ )
+        for( i = 0; i < nCount; i++ )
+            nTotalLen += CPLsnprintf( szBuffer, sizeof(szBuffer), "%.17g",
+                                      padfValues[i] );
+    Report( "  CPLsnprintf(\"%.17g\")", nCount * nIter, Elapsed( nStart ) );
+
+    nStart = clock();
+    for( iIter = 0; iIter < nIter; iIter++ )
+        for( i = 0; i < nCount; i++ )
+            nTotalLen += CPLDoubleToShortestString( padfValues[i], szBuffer,
+                                                    sizeof(szBuffer) );
+    Report( "  CPLDoubleToShortestString()", nCount * nIter,
+            Elapsed( nStart ) );
+
+/* -------------------------------------------------------------------- */
+/*      Parsing.                                                        */
+/* -------------------------------------------------------------------- */
+    for( i = 0; i < nCount; i++ )
+    {
+        CPLDoubleToShortestString( padfValues[i], szBuffer, sizeof(szBuffer) );
+        papszStrings[i] = CPLStrdup( szBuffer );
+    }
+
+    double dfSum = 0.0;
+    nStart = clock();
+    for( iIter = 0; iIter < nIter; iIter++ )
+        for( i = 0; i < nCount; i++ )
+            dfSum += strtod( papszStrings[i], NULL );
+    Report( "  strtod()", nCount * nIter, Elapsed( nStart ) );
+
+    nStart = clock();
+    for( iIter = 0; iIter < nIter; iIter++ )
+        for( i = 0; i < nCount; i++ )
+            dfSum += CPLAtof( papszStrings[i] );
+    Report( "  CPLAtof()", nCount * nIter, Elapsed( nStart ) );
+
+    for( i = 0; i < nCount; i++ )
+    {
+        const double dfVal = CPLAtof( papszStrings[i] );
+        CHECK( memcmp(&dfVal, &padfValues[i], sizeof(double)) == 0 );
+        CPLFree( papszStrings[i] );
+    }
+
+    /* So that the loops are not optimized away */
+    if( nTotalLen == 0 || dfSum == 0.0 )
+        printf( "\n" );
+
+    CPLFree( papszStrings );
+    CPLFree( padfValues );
+
+    if( nErrors != 0 )
+    {
+        fprintf( stderr, "%d check(s) failed\n", nErrors );
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,352 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Check the driver probing order of GDALOpenEx() and the deferred
+ *           initialization of driver metadata
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal_priv.h"
+#include "cpl_atomic_ops.h"
+#include "cpl_conv.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+
+CPL_CVSID("$Id$");
+
+static int nErrors = 0;
+
+#define CHECK(x) \
+    do { if( !(x) ) { fprintf(stderr, "%s:%d: check '%s' failed\n", \
+                              __FILE__, __LINE__, #x); nErrors++; } } while(0)
+
+#define SIGNATURE       "SIGTEST"
+
+/************************************************************************/
+/* ==================================================================== */
+/*                             ProbeDataset                             */
+/* ==================================================================== */
+/************************************************************************/
+
+class ProbeDataset : public GDALDataset
+{
+  public:
+                ProbeDataset() { nRasterXSize = 1; nRasterYSize = 1; }
+};
+
+/************************************************************************/
+/*                        Identify functions.                           */
+/*                                                                      */
+/*      "Greedy" accepts everything the others accept.  It is           */
+/*      registered first and declares nothing, so it is only tried      */
+/*      first when no declared signature matches.  "Deferred" accepts   */
+/*      nothing.                                                        */
+/************************************************************************/
+
+static int HasSignature( GDALOpenInfo *poOpenInfo )
+
+{
+    return poOpenInfo->nHeaderBytes >= (int) strlen(SIGNATURE)
+        && EQUALN( (const char *) poOpenInfo->pabyHeader, SIGNATURE,
+                   strlen(SIGNATURE) );
+}
+
+static int HasExtension( GDALOpenInfo *poOpenInfo )
+
+{
+    return EQUAL( CPLGetExtension( poOpenInfo->pszFilename ), "sigtest" );
+}
+
+static int HasPrefix( GDALOpenInfo *poOpenInfo )
+
+{
+    return EQUALN( poOpenInfo->pszFilename, "SIGTEST:", 8 );
+}
+
+static int GreedyIdentify( GDALOpenInfo *poOpenInfo )
+
+{
+    return HasSignature( poOpenInfo ) || HasExtension( poOpenInfo )
+        || HasPrefix( poOpenInfo );
+}
+
+/************************************************************************/
+/*                           Open functions.                            */
+/************************************************************************/
+
+static GDALDataset *OpenIf( int bMatch )
+
+{
+    return bMatch ? new ProbeDataset() : NULL;
+}
+
+static GDALDataset *GreedyOpen( GDALOpenInfo *poOpenInfo )
+{
+    return OpenIf( GreedyIdentify( poOpenInfo ) );
+}
+
+static GDALDataset *SignatureOpen( GDALOpenInfo *poOpenInfo )
+{
+    return OpenIf( HasSignature( poOpenInfo ) );
+}
+
+static GDALDataset *ExtensionOpen( GDALOpenInfo *poOpenInfo )
+{
+    return OpenIf( HasExtension( poOpenInfo ) );
+}
+
+static GDALDataset *PrefixOpen( GDALOpenInfo *poOpenInfo )
+{
+    return OpenIf( HasPrefix( poOpenInfo ) );
+}
+
+static int NeverIdentify( GDALOpenInfo *poOpenInfo )
+{
+    (void) poOpenInfo;
+    return FALSE;
+}
+
+static GDALDataset *NeverOpen( GDALOpenInfo *poOpenInfo )
+{
+    return OpenIf( NeverIdentify( poOpenInfo ) );
+}
+
+/************************************************************************/
+/*                         Deferred metadata.                           */
+/************************************************************************/
+
+static volatile int nInitMetadataCalls = 0;
+
+static void InitMetadata( GDALDriver *poDriver )
+
+{
+    CPLAtomicInc( &nInitMetadataCalls );
+    /* Leave time to other threads to look at the metadata meanwhile */
+    CPLSleep( 0.05 );
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST,
+                               "<CreationOptionList/>" );
+    poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "sigtest" );
+}
+
+/************************************************************************/
+/*                           RegisterDriver()                           */
+/************************************************************************/
+
+static GDALDriver *RegisterDriver( const char *pszName,
+                                   GDALDataset *(*pfnOpen)( GDALOpenInfo * ),
+                                   int (*pfnIdentify)( GDALOpenInfo * ) )
+
+{
+    GDALDriver *poDriver = new GDALDriver();
+
+    poDriver->SetDescription( pszName );
+    poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
+    poDriver->pfnOpen = pfnOpen;
+    poDriver->pfnIdentify = pfnIdentify;
+    return poDriver;
+}
+
+/************************************************************************/
+/*                             OpenedBy()                               */
+/*                                                                      */
+/*      Return the name of the driver opening the dataset, and of the   */
+/*      driver identifying it.                                          */
+/************************************************************************/
+
+static CPLString OpenedBy( const char *pszFilename )
+
+{
+    CPLString osResult;
+    GDALDatasetH hDS = GDALOpenEx( pszFilename, GDAL_OF_RASTER,
+                                   NULL, NULL, NULL );
+    osResult = hDS ? GDALGetDriverShortName( GDALGetDatasetDriver( hDS ) )
+                   : "(none)";
+    if( hDS != NULL )
+        GDALClose( hDS );
+
+    GDALDriverH hDriver = GDALIdentifyDriver( pszFilename, NULL );
+    osResult += "/";
+    osResult += hDriver ? GDALGetDriverShortName( hDriver ) : "(none)";
+
+    return osResult;
+}
+
+/************************************************************************/
+/*                           CheckOpenedBy()                            */
+/************************************************************************/
+
+static void CheckOpenedBy( const char *pszFilename, const char *pszExpected )
+
+{
+    CPLString osDriver = OpenedBy( pszFilename );
+
+    printf( "%-34s %-3s -> %s\n", pszFilename,
+            CPLGetConfigOption( "GDAL_OPEN_USE_SIGNATURES", "YES" ),
+            osDriver.c_str() );
+    if( osDriver != CPLSPrintf( "%s/%s", pszExpected, pszExpected ) )
+    {
+        fprintf( stderr, "  expected %s\n", pszExpected );
+        nErrors++;
+    }
+}
+
+/************************************************************************/
+/*                           MetadataThread()                           */
+/************************************************************************/
+
+static volatile int nBadMetadata = 0;
+
+static void MetadataThread( void *pData )
+
+{
+    GDALDriver *poDriver = (GDALDriver *) pData;
+    const char *pszValue =
+        poDriver->GetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST );
+
+    if( pszValue == NULL || !EQUAL( pszValue, "<CreationOptionList/>" ) )
+        CPLAtomicInc( &nBadMetadata );
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char *argv[] )
+
+{
+    (void) argc;
+    (void) argv;
+
+    GDALAllRegister();
+    GDALDriverManager *poDM = GetGDALDriverManager();
+
+/* -------------------------------------------------------------------- */
+/*      Register the greedy driver before the ones declaring what       */
+/*      they open.                                                      */
+/* -------------------------------------------------------------------- */
+    poDM->RegisterDriver( RegisterDriver( "Greedy", GreedyOpen,
+                                          GreedyIdentify ) );
+
+    GDALDriver *poDriver = RegisterDriver( "Signature", SignatureOpen,
+                                           HasSignature );
+    poDriver->AddOpenSignature( SIGNATURE, (int) strlen(SIGNATURE) );
+    poDM->RegisterDriver( poDriver );
+
+    poDriver = RegisterDriver( "Extension", ExtensionOpen, HasExtension );
+    poDriver->AddOpenExtension( "sigtest" );
+    poDM->RegisterDriver( poDriver );
+
+    poDriver = RegisterDriver( "Prefix", PrefixOpen, HasPrefix );
+    poDriver->AddOpenPrefix( "sigtest:" );
+    poDM->RegisterDriver( poDriver );
+
+    GDALDriver *poDeferredDriver = RegisterDriver( "Deferred", NeverOpen,
+                                                   NeverIdentify );
+    poDeferredDriver->pfnInitMetadata = InitMetadata;
+    poDM->RegisterDriver( poDeferredDriver );
+
+    CHECK( nInitMetadataCalls == 0 );
+
+/* -------------------------------------------------------------------- */
+/*      A matching signature or prefix comes first, then a matching     */
+/*      extension.  With GDAL_OPEN_USE_SIGNATURES=NO, the registration  */
+/*      order is kept.                                                  */
+/* -------------------------------------------------------------------- */
+    VSILFILE *fp = VSIFOpenL( "/vsimem/with_signature.sigtest", "wb" );
+    VSIFWriteL( SIGNATURE " data", 1, strlen(SIGNATURE " data"), fp );
+    VSIFCloseL( fp );
+    fp = VSIFOpenL( "/vsimem/without_signature.sigtest", "wb" );
+    VSIFWriteL( "Other data", 1, strlen("Other data"), fp );
+    VSIFCloseL( fp );
+
+    CheckOpenedBy( "/vsimem/with_signature.sigtest", "Signature" );
+    CheckOpenedBy( "/vsimem/without_signature.sigtest", "Extension" );
+    CheckOpenedBy( "SigTest:connection", "Prefix" );
+
+    CPLSetConfigOption( "GDAL_OPEN_USE_SIGNATURES", "NO" );
+    CheckOpenedBy( "/vsimem/with_signature.sigtest", "Greedy" );
+    CheckOpenedBy( "/vsimem/without_signature.sigtest", "Greedy" );
+    CheckOpenedBy( "SigTest:connection", "Greedy" );
+    CPLSetConfigOption( "GDAL_OPEN_USE_SIGNATURES", NULL );
+
+    VSIUnlink( "/vsimem/with_signature.sigtest" );
+    VSIUnlink( "/vsimem/without_signature.sigtest" );
+
+/* -------------------------------------------------------------------- */
+/*      Probing all drivers, for a dataset nobody opens, and looking    */
+/*      up capabilities or items set at registration does not run the   */
+/*      deferred initialization.  The first lookup of another item      */
+/*      runs it, once, even from several threads at the same time,      */
+/*      and they all see its result.                                    */
+/* -------------------------------------------------------------------- */
+    CheckOpenedBy( "/vsimem/does_not_exist.txt", "(none)" );
+    CPLErrorReset();
+    GDALDatasetH hDS = GDALOpenEx( "/vsimem/does_not_exist.txt",
+                                   GDAL_OF_VECTOR, NULL, NULL, NULL );
+    CHECK( hDS == NULL );
+    CHECK( nInitMetadataCalls == 0 );
+    CHECK( poDeferredDriver->GetMetadataItem( GDAL_DCAP_RASTER ) != NULL );
+    CHECK( poDeferredDriver->GetMetadataItem( GDAL_DCAP_VECTOR ) == NULL );
+    CHECK( nInitMetadataCalls == 0 );
+
+    CPLJoinableThread *ahThreads[8];
+    int i;
+
+    for( i = 0; i < 8; i++ )
+        ahThreads[i] = CPLCreateJoinableThread( MetadataThread,
+                                                poDeferredDriver );
+    for( i = 0; i < 8; i++ )
+        CPLJoinThread( ahThreads[i] );
+
+    CHECK( nBadMetadata == 0 );
+    CHECK( nInitMetadataCalls == 1 );
+    CHECK( EQUAL( CSLFetchNameValueDef( poDeferredDriver->GetMetadata(),
+                                        GDAL_DMD_EXTENSION, "" ),
+                  "sigtest" ) );
+    CHECK( nInitMetadataCalls == 1 );
+
+/* -------------------------------------------------------------------- */
+/*      GTiff builds its creation option list this way.                 */
+/* -------------------------------------------------------------------- */
+    GDALDriverH hGTiff = GDALGetDriverByName( "GTiff" );
+    if( hGTiff != NULL )
+    {
+        const char *pszList =
+            GDALGetMetadataItem( hGTiff, GDAL_DMD_CREATIONOPTIONLIST, NULL );
+        CHECK( pszList != NULL && strstr( pszList, "COMPRESS" ) != NULL );
+    }
+
+    GDALDestroyDriverManager();
+
+    if( nErrors != 0 )
+    {
+        fprintf( stderr, "%d check(s) failed\n", nErrors );
+        return 1;
+    }
+
+    printf( "All checks passed\n" );
+    return 0;
+}
@@ -0,0 +1,238 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Check GDALFillNodata() with INTERPOLATION=PUSH_PULL on large holes
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal_alg.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+
+CPL_CVSID("$Id$");
+
+static int nErrors = 0;
+
+#define CHECK(x) \
+    do { if( !(x) ) { fprintf(stderr, "%s:%d: check '%s' failed\n", \
+                              __FILE__, __LINE__, #x); nErrors++; } } while(0)
+
+#define RASTER_SIZE     256
+#define NODATA_VALUE    -9999.0f
+
+/************************************************************************/
+/*                              Ramp()                                  */
+/************************************************************************/
+
+static float Ramp( int iX, int iY )
+
+{
+    return (float) (100.0 + iX + 0.5 * iY);
+}
+
+/************************************************************************/
+/*                              RunFill()                               */
+/*                                                                      */
+/*      Fill a ramp whose pixels are valid where pfnValid() says so,    */
+/*      and return the filled pixels.                                   */
+/************************************************************************/
+
+static float *RunFill( int (*pfnValid)( int, int ), double dfMaxSearchDist )
+
+{
+    const int nSize = RASTER_SIZE;
+    GDALDriverH hDriver = GDALGetDriverByName( "MEM" );
+    GDALDatasetH hDS = GDALCreate( hDriver, "", nSize, nSize, 1,
+                                   GDT_Float32, NULL );
+    GDALDatasetH hMaskDS = GDALCreate( hDriver, "", nSize, nSize, 1,
+                                       GDT_Byte, NULL );
+    float *pafData = (float *) CPLMalloc( sizeof(float) * nSize * nSize );
+    GByte *pabyMask = (GByte *) CPLMalloc( nSize * nSize );
+
+    for( int iY = 0; iY < nSize; iY++ )
+    {
+        for( int iX = 0; iX < nSize; iX++ )
+        {
+            const int bValid = pfnValid( iX, iY );
+            pafData[iY * nSize + iX] = bValid ? Ramp( iX, iY ) : NODATA_VALUE;
+            pabyMask[iY * nSize + iX] = bValid ? 255 : 0;
+        }
+    }
+
+    GDALRasterBandH hBand = GDALGetRasterBand( hDS, 1 );
+    GDALRasterBandH hMaskBand = GDALGetRasterBand( hMaskDS, 1 );
+    CHECK( GDALRasterIO( hBand, GF_Write, 0, 0, nSize, nSize, pafData,
+                         nSize, nSize, GDT_Float32, 0, 0 ) == CE_None );
+    CHECK( GDALRasterIO( hMaskBand, GF_Write, 0, 0, nSize, nSize, pabyMask,
+                         nSize, nSize, GDT_Byte, 0, 0 ) == CE_None );
+
+    char **papszOptions = CSLSetNameValue( NULL, "INTERPOLATION", "PUSH_PULL" );
+    papszOptions = CSLSetNameValue( papszOptions, "TEMP_FILE_DRIVER", "MEM" );
+    CHECK( GDALFillNodata( hBand, hMaskBand, dfMaxSearchDist, 0, 0,
+                           papszOptions, NULL, NULL ) == CE_None );
+    CSLDestroy( papszOptions );
+
+    CHECK( GDALRasterIO( hBand, GF_Read, 0, 0, nSize, nSize, pafData,
+                         nSize, nSize, GDT_Float32, 0, 0 ) == CE_None );
+
+    GDALClose( hDS );
+    GDALClose( hMaskDS );
+    CPLFree( pabyMask );
+
+    return pafData;
+}
+
+/************************************************************************/
+/*                         CheckValidUnchanged()                        */
+/************************************************************************/
+
+static void CheckValidUnchanged( const float *pafData,
+                                 int (*pfnValid)( int, int ) )
+
+{
+    int nChanged = 0;
+
+    for( int iY = 0; iY < RASTER_SIZE; iY++ )
+        for( int iX = 0; iX < RASTER_SIZE; iX++ )
+            if( pfnValid( iX, iY )
+                && pafData[iY * RASTER_SIZE + iX] != Ramp( iX, iY ) )
+                nChanged++;
+
+    CHECK( nChanged == 0 );
+}
+
+/************************************************************************/
+/*                            OutsideHole()                             */
+/*                                                                      */
+/*      A 96x96 hole in the middle of the raster.                       */
+/************************************************************************/
+
+static int OutsideHole( int iX, int iY )
+
+{
+    return iX < 80 || iX >= 176 || iY < 80 || iY >= 176;
+}
+
+/************************************************************************/
+/*                              LeftStrip()                             */
+/*                                                                      */
+/*      Only the 16 leftmost columns are valid.                         */
+/************************************************************************/
+
+static int LeftStrip( int iX, int iY )
+
+{
+    (void) iY;
+    return iX < 16;
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char *argv[] )
+
+{
+    (void) argc;
+    (void) argv;
+
+    GDALAllRegister();
+
+/* -------------------------------------------------------------------- */
+/*      A large hole is filled completely, close to the ramp.           */
+/* -------------------------------------------------------------------- */
+    float *pafData = RunFill( OutsideHole, 0.0 );
+    int nUnfilled = 0;
+    double dfMaxError = 0.0;
+
+    CheckValidUnchanged( pafData, OutsideHole );
+    for( int iY = 0; iY < RASTER_SIZE; iY++ )
+    {
+        for( int iX = 0; iX < RASTER_SIZE; iX++ )
+        {
+            const float fVal = pafData[iY * RASTER_SIZE + iX];
+            if( OutsideHole( iX, iY ) )
+                continue;
+            if( fVal == NODATA_VALUE )
+                nUnfilled++;
+            else
+                dfMaxError = MAX( dfMaxError, fabs( fVal - Ramp( iX, iY ) ) );
+        }
+    }
+    printf( "hole: %d pixel(s) unfilled, max error %.3f\n",
+            nUnfilled, dfMaxError );
+    CHECK( nUnfilled == 0 );
+    CHECK( dfMaxError < 10.0 );
+    CPLFree( pafData );
+
+/* -------------------------------------------------------------------- */
+/*      With a limited search distance, the pixels close to the valid   */
+/*      strip are filled and the ones farther than twice the distance   */
+/*      are left alone.  The distance is approximate for PUSH_PULL, as  */
+/*      it bounds the size of the cells of the coarsest level.          */
+/* -------------------------------------------------------------------- */
+    const int anDist[] = { 8, 16, 32 };
+
+    for( size_t i = 0; i < sizeof(anDist) / sizeof(anDist[0]); i++ )
+    {
+        const int nDist = anDist[i];
+        int nNearUnfilled = 0, nFarFilled = 0, nOutOfRange = 0;
+
+        pafData = RunFill( LeftStrip, nDist );
+        CheckValidUnchanged( pafData, LeftStrip );
+
+        for( int iY = 0; iY < RASTER_SIZE; iY++ )
+        {
+            for( int iX = 16; iX < RASTER_SIZE; iX++ )
+            {
+                const float fVal = pafData[iY * RASTER_SIZE + iX];
+                if( iX < 16 + nDist / 2 && fVal == NODATA_VALUE )
+                    nNearUnfilled++;
+                if( iX >= 16 + 2 * nDist && fVal != NODATA_VALUE )
+                    nFarFilled++;
+                if( fVal != NODATA_VALUE
+                    && (fVal < Ramp( 0, 0 )
+                        || fVal > Ramp( 15, RASTER_SIZE - 1 )) )
+                    nOutOfRange++;
+            }
+        }
+
+        printf( "distance %d: %d near pixel(s) unfilled, "
+                "%d far pixel(s) filled\n", nDist, nNearUnfilled, nFarFilled );
+        CHECK( nNearUnfilled == 0 );
+        CHECK( nFarFilled == 0 );
+        CHECK( nOutOfRange == 0 );
+        CPLFree( pafData );
+    }
+
+    if( nErrors != 0 )
+    {
+        fprintf( stderr, "%d check(s) failed\n", nErrors );
+        return 1;
+    }
+
+    printf( "All checks passed\n" );
+    return 0;
+}
@@ -0,0 +1,300 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Check and benchmark CPLHashSet insertions, lookups and removals
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_hash_set.h"
+#include <time.h>
+
+CPL_CVSID("$Id$");
+
+static int nErrors = 0;
+
+#define CHECK(x) \
+    do { if( !(x) ) { fprintf(stderr, "%s:%d: check '%s' failed\n", \
+                              __FILE__, __LINE__, #x); nErrors++; } } while(0)
+
+/************************************************************************/
+/*                               Usage()                                */
+/************************************************************************/
+
+static void Usage()
+
+{
+    printf( "Usage: testhashset [-n count] [-iter count]\n" );
+    exit( 1 );
+}
+
+/************************************************************************/
+/*                              Elapsed()                               */
+/************************************************************************/
+
+static double Elapsed( clock_t nStart )
+
+{
+    return (double) (clock() - nStart) / CLOCKS_PER_SEC;
+}
+
+/************************************************************************/
+/*                               Report()                               */
+/************************************************************************/
+
+static void Report( const char *pszWhat, int nOps, double dfSeconds )
+
+{
+    printf( "%-24s %10d ops %8.3f s %10.2f Mops/s\n",
+            pszWhat, nOps, dfSeconds,
+            dfSeconds > 0 ? nOps / dfSeconds / 1e6 : 0.0 );
+}
+
+/************************************************************************/
+/*                              Shuffle()                               */
+/*                                                                      */
+/*      So that the order of the accesses is not correlated with the    */
+/*      addresses or the names of the elements.                         */
+/************************************************************************/
+
+static void Shuffle( void **papElts, int nCount )
+
+{
+    unsigned int nSeed = 12345;
+
+    for( int i = nCount - 1; i > 0; i-- )
+    {
+        nSeed = nSeed * 1103515245U + 12345U;
+        const int j = (int) ((nSeed >> 4) % (unsigned int) (i + 1));
+        void *pTmp = papElts[i];
+        papElts[i] = papElts[j];
+        papElts[j] = pTmp;
+    }
+}
+
+/************************************************************************/
+/*                              Benchmark()                             */
+/************************************************************************/
+
+static void Benchmark( const char *pszName, void **papElts, int nCount,
+                       void **papMissing, int nIter,
+                       CPLHashSetHashFunc fnHash, CPLHashSetEqualFunc fnEqual )
+
+{
+    int i, iIter;
+    clock_t nStart;
+
+    printf( "%s, %d elements:\n", pszName, nCount );
+
+    Shuffle( papElts, nCount );
+    Shuffle( papMissing, nCount );
+
+    CPLHashSet *hSet = NULL;
+    nStart = clock();
+    for( iIter = 0; iIter < nIter; iIter++ )
+    {
+        if( hSet != NULL )
+            CPLHashSetDestroy( hSet );
+        hSet = CPLHashSetNew( fnHash, fnEqual, NULL );
+        for( i = 0; i < nCount; i++ )
+            CPLHashSetInsert( hSet, papElts[i] );
+    }
+    Report( "  insert", nCount * nIter, Elapsed( nStart ) );
+    CHECK( CPLHashSetSize( hSet ) == nCount );
+
+    int nFound = 0;
+    nStart = clock();
+    for( iIter = 0; iIter < nIter; iIter++ )
+    {
+        for( i = 0; i < nCount; i++ )
+            nFound += CPLHashSetLookup( hSet, papElts[i] ) != NULL;
+    }
+    Report( "  successful lookup", nCount * nIter, Elapsed( nStart ) );
+    CHECK( nFound == nCount * nIter );
+
+    nFound = 0;
+    nStart = clock();
+    for( iIter = 0; iIter < nIter; iIter++ )
+    {
+        for( i = 0; i < nCount; i++ )
+            nFound += CPLHashSetLookup( hSet, papMissing[i] ) != NULL;
+    }
+    Report( "  failed lookup", nCount * nIter, Elapsed( nStart ) );
+    CHECK( nFound == 0 );
+
+    nStart = clock();
+    for( i = 0; i < nCount; i++ )
+        CHECK( CPLHashSetRemove( hSet, papElts[i] ) );
+    Report( "  remove", nCount, Elapsed( nStart ) );
+    CHECK( CPLHashSetSize( hSet ) == 0 );
+
+    CPLHashSetDestroy( hSet );
+}
+
+/************************************************************************/
+/*                          CountElt()                                  */
+/************************************************************************/
+
+static int CountElt( CPL_UNUSED void *elt, void *user_data )
+
+{
+    (*(int *) user_data)++;
+    return TRUE;
+}
+
+/************************************************************************/
+/*                             CheckSet()                               */
+/*                                                                      */
+/*      Interleave insertions and removals, checking the content        */
+/*      against a reference array.                                      */
+/************************************************************************/
+
+static void CheckSet( int nCount )
+
+{
+    CPLHashSet *hSet = CPLHashSetNew( CPLHashSetHashStr, CPLHashSetEqualStr,
+                                      CPLFree );
+    char *pachPresent = (char *) CPLCalloc( nCount, 1 );
+    int nPresent = 0;
+    unsigned int nSeed = 1;
+
+    for( int i = 0; i < nCount * 8; i++ )
+    {
+        nSeed = nSeed * 1103515245U + 12345U;
+        const int iElt = (int) ((nSeed >> 8) % nCount);
+        char szKey[32];
+        sprintf( szKey, "key%d", iElt );
+
+        if( (nSeed >> 4) & 1 )
+        {
+            const int bNew = CPLHashSetInsert( hSet, CPLStrdup(szKey) );
+            CHECK( bNew == !pachPresent[iElt] );
+            if( !pachPresent[iElt] )
+                nPresent++;
+            pachPresent[iElt] = 1;
+        }
+        else
+        {
+            const int bRemoved = CPLHashSetRemove( hSet, szKey );
+            CHECK( bRemoved == pachPresent[iElt] );
+            if( pachPresent[iElt] )
+                nPresent--;
+            pachPresent[iElt] = 0;
+        }
+        CHECK( CPLHashSetSize( hSet ) == nPresent );
+    }
+
+    for( int i = 0; i < nCount; i++ )
+    {
+        char szKey[32];
+        sprintf( szKey, "key%d", i );
+        const char *pszFound = (const char *) CPLHashSetLookup( hSet, szKey );
+        CHECK( (pszFound != NULL) == pachPresent[i] );
+        if( pszFound != NULL )
+            CHECK( strcmp( pszFound, szKey ) == 0 );
+    }
+
+    int nWalked = 0;
+    CPLHashSetForeach( hSet, CountElt, &nWalked );
+    CHECK( nWalked == nPresent );
+
+    CPLFree( pachPresent );
+    CPLHashSetDestroy( hSet );
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char *argv[] )
+
+{
+    int nCount = 100000;
+    int nIter = 10;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        if( EQUAL(argv[i], "-n") && i + 1 < argc )
+            nCount = atoi( argv[++i] );
+        else if( EQUAL(argv[i], "-iter") && i + 1 < argc )
+            nIter = atoi( argv[++i] );
+        else
+            Usage();
+    }
+    if( nCount <= 0 || nIter <= 0 )
+        Usage();
+
+    CheckSet( 1000 );
+
+/* -------------------------------------------------------------------- */
+/*      Pointers, as used to track objects.                             */
+/* -------------------------------------------------------------------- */
+    void **papElts = (void **) CPLMalloc( sizeof(void*) * nCount );
+    void **papMissing = (void **) CPLMalloc( sizeof(void*) * nCount );
+    int i;
+
+    for( i = 0; i < nCount; i++ )
+    {
+        papElts[i] = CPLMalloc( 16 );
+        papMissing[i] = CPLMalloc( 16 );
+    }
+
+    Benchmark( "Pointers", papElts, nCount, papMissing, nIter, NULL, NULL );
+
+    for( i = 0; i < nCount; i++ )
+    {
+        CPLFree( papElts[i] );
+        CPLFree( papMissing[i] );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Strings, as used for names.                                     */
+/* -------------------------------------------------------------------- */
+    for( i = 0; i < nCount; i++ )
+    {
+        papElts[i] = CPLStrdup( CPLSPrintf( "feature_name_%d", i ) );
+        papMissing[i] = CPLStrdup( CPLSPrintf( "missing_name_%d", i ) );
+    }
+
+    Benchmark( "Strings", papElts, nCount, papMissing, nIter,
+               CPLHashSetHashStr, CPLHashSetEqualStr );
+
+    for( i = 0; i < nCount; i++ )
+    {
+        CPLFree( papElts[i] );
+        CPLFree( papMissing[i] );
+    }
+    CPLFree( papElts );
+    CPLFree( papMissing );
+
+    if( nErrors != 0 )
+    {
+        fprintf( stderr, "%d check(s) failed\n", nErrors );
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,372 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Check reading and writing bands with a huge number of blocks,
+ *           whose cached blocks are referenced through a hash set
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal_priv.h"
+#include "cpl_conv.h"
+#include <map>
+#include <vector>
+
+CPL_CVSID("$Id$");
+
+static int nErrors = 0;
+
+#define CHECK(x) \
+    do { if( !(x) ) { fprintf(stderr, "%s:%d: check '%s' failed\n", \
+                              __FILE__, __LINE__, #x); nErrors++; } } while(0)
+
+typedef std::pair<int,int> BlockOffset;
+
+/************************************************************************/
+/*                         Pixel value patterns.                        */
+/************************************************************************/
+
+static GByte SourcePattern( int iX, int iY )
+{
+    return (GByte) (((GUInt32) iX * 7 + (GUInt32) iY * 13) & 0xff);
+}
+
+static GByte WrittenPattern( int iX, int iY )
+{
+    return (GByte) (((GUInt32) iX * 3 + (GUInt32) iY * 5 + 1) & 0xff);
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                             SparseDataset                            */
+/* ==================================================================== */
+/*                                                                      */
+/*      Unwritten blocks hold SourcePattern(), written ones are kept    */
+/*      in a map.                                                       */
+/************************************************************************/
+
+class SparseDataset : public GDALDataset
+{
+  public:
+    std::map< BlockOffset, std::vector<GByte> > oWritten;
+    std::vector<BlockOffset>                    aoWrites;
+
+                SparseDataset( int nXSize, int nYSize, int nBlockSize );
+};
+
+class SparseBand : public GDALRasterBand
+{
+  public:
+                SparseBand( SparseDataset *poDS, int nBlockSize );
+
+    virtual CPLErr IReadBlock( int, int, void * );
+    virtual CPLErr IWriteBlock( int, int, void * );
+};
+
+/************************************************************************/
+/*                           SparseDataset()                            */
+/************************************************************************/
+
+SparseDataset::SparseDataset( int nXSize, int nYSize, int nBlockSize )
+
+{
+    nRasterXSize = nXSize;
+    nRasterYSize = nYSize;
+    eAccess = GA_Update;
+    SetBand( 1, new SparseBand( this, nBlockSize ) );
+}
+
+/************************************************************************/
+/*                            SparseBand()                              */
+/************************************************************************/
+
+SparseBand::SparseBand( SparseDataset *poDSIn, int nBlockSize )
+
+{
+    poDS = poDSIn;
+    nBand = 1;
+    eDataType = GDT_Byte;
+    nBlockXSize = nBlockSize;
+    nBlockYSize = nBlockSize;
+}
+
+/************************************************************************/
+/*                             IReadBlock()                             */
+/************************************************************************/
+
+CPLErr SparseBand::IReadBlock( int nBlockXOff, int nBlockYOff, void *pImage )
+
+{
+    SparseDataset *poSDS = (SparseDataset *) poDS;
+    std::map< BlockOffset, std::vector<GByte> >::iterator oIter =
+        poSDS->oWritten.find( BlockOffset( nBlockXOff, nBlockYOff ) );
+
+    if( oIter != poSDS->oWritten.end() )
+    {
+        memcpy( pImage, &oIter->second[0], nBlockXSize * nBlockYSize );
+        return CE_None;
+    }
+
+    for( int iY = 0; iY < nBlockYSize; iY++ )
+        for( int iX = 0; iX < nBlockXSize; iX++ )
+            ((GByte *) pImage)[iY * nBlockXSize + iX] =
+                SourcePattern( nBlockXOff * nBlockXSize + iX,
+                               nBlockYOff * nBlockYSize + iY );
+    return CE_None;
+}
+
+/************************************************************************/
+/*                            IWriteBlock()                             */
+/************************************************************************/
+
+CPLErr SparseBand::IWriteBlock( int nBlockXOff, int nBlockYOff, void *pImage )
+
+{
+    SparseDataset *poSDS = (SparseDataset *) poDS;
+    std::vector<GByte> &abyBlock =
+        poSDS->oWritten[BlockOffset( nBlockXOff, nBlockYOff )];
+
+    abyBlock.resize( nBlockXSize * nBlockYSize );
+    memcpy( &abyBlock[0], pImage, nBlockXSize * nBlockYSize );
+    poSDS->aoWrites.push_back( BlockOffset( nBlockXOff, nBlockYOff ) );
+    return CE_None;
+}
+
+/************************************************************************/
+/*                             Window.                                  */
+/************************************************************************/
+
+typedef struct
+{
+    int nXOff;
+    int nYOff;
+    int nXSize;
+    int nYSize;
+} Window;
+
+static int InWindow( const Window &sWin, int iX, int iY )
+{
+    return iX >= sWin.nXOff && iX < sWin.nXOff + sWin.nXSize
+        && iY >= sWin.nYOff && iY < sWin.nYOff + sWin.nYSize;
+}
+
+/************************************************************************/
+/*                            WriteWindow()                             */
+/************************************************************************/
+
+static void WriteWindow( GDALRasterBand *poBand, const Window &sWin )
+
+{
+    std::vector<GByte> abyBuf( sWin.nXSize * sWin.nYSize );
+
+    for( int iY = 0; iY < sWin.nYSize; iY++ )
+        for( int iX = 0; iX < sWin.nXSize; iX++ )
+            abyBuf[iY * sWin.nXSize + iX] =
+                WrittenPattern( sWin.nXOff + iX, sWin.nYOff + iY );
+
+    CHECK( poBand->RasterIO( GF_Write, sWin.nXOff, sWin.nYOff,
+                             sWin.nXSize, sWin.nYSize, &abyBuf[0],
+                             sWin.nXSize, sWin.nYSize, GDT_Byte, 0, 0,
+                             NULL ) == CE_None );
+}
+
+/************************************************************************/
+/*                            CheckWindow()                             */
+/*                                                                      */
+/*      Read a window and compare it with the source pattern, or the    */
+/*      written one inside the written windows.                         */
+/************************************************************************/
+
+static void CheckWindow( GDALRasterBand *poBand, const Window &sWin,
+                         const std::vector<Window> &asWritten )
+
+{
+    std::vector<GByte> abyBuf( sWin.nXSize * sWin.nYSize );
+    int nDiff = 0;
+
+    CHECK( poBand->RasterIO( GF_Read, sWin.nXOff, sWin.nYOff,
+                             sWin.nXSize, sWin.nYSize, &abyBuf[0],
+                             sWin.nXSize, sWin.nYSize, GDT_Byte, 0, 0,
+                             NULL ) == CE_None );
+
+    for( int iY = 0; iY < sWin.nYSize; iY++ )
+    {
+        for( int iX = 0; iX < sWin.nXSize; iX++ )
+        {
+            const int iRasterX = sWin.nXOff + iX;
+            const int iRasterY = sWin.nYOff + iY;
+            int bWritten = FALSE;
+
+            for( size_t i = 0; i < asWritten.size() && !bWritten; i++ )
+                bWritten = InWindow( asWritten[i], iRasterX, iRasterY );
+
+            const GByte nExpected = bWritten ?
+                WrittenPattern( iRasterX, iRasterY ) :
+                SourcePattern( iRasterX, iRasterY );
+            if( abyBuf[iY * sWin.nXSize + iX] != nExpected )
+                nDiff++;
+        }
+    }
+
+    if( nDiff != 0 )
+    {
+        fprintf( stderr, "  window %d,%d %dx%d: %d pixel(s) differ\n",
+                 sWin.nXOff, sWin.nYOff, sWin.nXSize, sWin.nYSize, nDiff );
+        nErrors++;
+    }
+}
+
+/************************************************************************/
+/*                              RunCase()                               */
+/************************************************************************/
+
+static void RunCase( int nXSize, int nYSize, int nBlockSize )
+
+{
+    SparseDataset *poDS = new SparseDataset( nXSize, nYSize, nBlockSize );
+    GDALRasterBand *poBand = poDS->GetRasterBand( 1 );
+
+    printf( "%d x %d raster, " CPL_FRMT_GIB " blocks\n", nXSize, nYSize,
+            (GIntBig) ((nXSize + nBlockSize - 1) / nBlockSize)
+            * ((nYSize + nBlockSize - 1) / nBlockSize) );
+
+/* -------------------------------------------------------------------- */
+/*      Windows crossing block boundaries, at the corners and in the    */
+/*      middle of the raster.                                           */
+/* -------------------------------------------------------------------- */
+    std::vector<Window> asWindows;
+    const Window asFixed[] = {
+        { 0, 0, 100, 70 },
+        { nXSize - 150, 0, 150, 90 },
+        { 0, nYSize - 80, 130, 80 },
+        { nXSize - 200, nYSize - 100, 200, 100 },
+        { nXSize / 2 - 50, nYSize / 2 - 60, 170, 140 }
+    };
+    for( size_t i = 0; i < sizeof(asFixed) / sizeof(asFixed[0]); i++ )
+        asWindows.push_back( asFixed[i] );
+
+    std::vector<Window> asWritten;
+    for( size_t i = 0; i < asWindows.size(); i++ )
+        CheckWindow( poBand, asWindows[i], asWritten );
+
+/* -------------------------------------------------------------------- */
+/*      Write some of them, and read everything back, from the cache,   */
+/*      then after flushing it.  The flush writes each dirty block      */
+/*      once, in raster order.                                          */
+/* -------------------------------------------------------------------- */
+    asWritten.push_back( asWindows[1] );
+    asWritten.push_back( asWindows[3] );
+    asWritten.push_back( asWindows[4] );
+    for( size_t i = 0; i < asWritten.size(); i++ )
+        WriteWindow( poBand, asWritten[i] );
+
+    for( size_t i = 0; i < asWindows.size(); i++ )
+        CheckWindow( poBand, asWindows[i], asWritten );
+
+    CHECK( poDS->aoWrites.empty() );
+    poDS->FlushCache();
+
+    int bOrdered = TRUE;
+    for( size_t i = 1; i < poDS->aoWrites.size(); i++ )
+    {
+        const BlockOffset &oPrev = poDS->aoWrites[i-1];
+        const BlockOffset &oCur = poDS->aoWrites[i];
+        if( oCur.second < oPrev.second ||
+            (oCur.second == oPrev.second && oCur.first <= oPrev.first) )
+            bOrdered = FALSE;
+    }
+    CHECK( bOrdered );
+    CHECK( poDS->aoWrites.size() == poDS->oWritten.size() );
+    CHECK( !poDS->aoWrites.empty() );
+
+    for( size_t i = 0; i < asWindows.size(); i++ )
+        CheckWindow( poBand, asWindows[i], asWritten );
+
+/* -------------------------------------------------------------------- */
+/*      With a cache of a few blocks, scattered reads and writes evict  */
+/*      dirty blocks, which must be written back and read again.        */
+/* -------------------------------------------------------------------- */
+    const GIntBig nOldCacheMax = GDALGetCacheMax64();
+    GDALSetCacheMax64( 16 * nBlockSize * nBlockSize );
+
+    const size_t nFlushedWrites = poDS->aoWrites.size();
+    GUInt32 nSeed = 1;
+    std::vector<Window> asScattered;
+    for( int i = 0; i < 200; i++ )
+    {
+        Window sWin;
+        nSeed = nSeed * 1103515245U + 12345U;
+        sWin.nXOff = (int) ((nSeed >> 8) % (GUInt32) (nXSize - 100));
+        nSeed = nSeed * 1103515245U + 12345U;
+        sWin.nYOff = (int) ((nSeed >> 8) % (GUInt32) (nYSize - 100));
+        sWin.nXSize = 40 + i % 50;
+        sWin.nYSize = 30 + i % 60;
+        asScattered.push_back( sWin );
+        if( i % 2 == 0 )
+        {
+            WriteWindow( poBand, sWin );
+            asWritten.push_back( sWin );
+        }
+    }
+
+    for( size_t i = 0; i < asScattered.size(); i++ )
+        CheckWindow( poBand, asScattered[i], asWritten );
+    CHECK( poDS->aoWrites.size() > nFlushedWrites );
+    poDS->FlushCache();
+    for( size_t i = 0; i < asScattered.size(); i++ )
+        CheckWindow( poBand, asScattered[i], asWritten );
+    for( size_t i = 0; i < asWindows.size(); i++ )
+        CheckWindow( poBand, asWindows[i], asWritten );
+
+    GDALSetCacheMax64( nOldCacheMax );
+    delete poDS;
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char *argv[] )
+
+{
+    (void) argc;
+    (void) argv;
+
+    GDALAllRegister();
+
+    /* Above the hash set threshold of 1M blocks */
+    RunCase( 100000, 100000, 64 );
+
+    /* Above INT_MAX blocks, and INT_MAX 64x64 sub-block grids */
+    RunCase( 2000000000, 2000000000, 32 );
+
+    if( nErrors != 0 )
+    {
+        fprintf( stderr, "%d check(s) failed\n", nErrors );
+        return 1;
+    }
+
+    printf( "All checks passed\n" );
+    return 0;
+}
@@ -0,0 +1,247 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Check that the OGRLayer overlay methods give the same result
+ *           with the prepared method layer and with its spatial filter
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogrsf_frmts.h"
+#include "gdal_priv.h"
+#include "cpl_conv.h"
+
+CPL_CVSID("$Id$");
+
+static int nErrors = 0;
+
+#define CHECK(x) \
+    do { if( !(x) ) { fprintf(stderr, "%s:%d: check '%s' failed\n", \
+                              __FILE__, __LINE__, #x); nErrors++; } } while(0)
+
+typedef OGRErr (OGRLayer::*OverlayMethod)( OGRLayer *, OGRLayer *, char **,
+                                           GDALProgressFunc, void * );
+
+/************************************************************************/
+/*                             AddFeature()                             */
+/************************************************************************/
+
+static void AddFeature( OGRLayer *poLayer, int nValue, const char *pszWKT )
+
+{
+    OGRFeature *poFeature = new OGRFeature( poLayer->GetLayerDefn() );
+    OGRGeometry *poGeom = NULL;
+    char *pszInput = (char *) pszWKT;
+
+    poFeature->SetField( 0, nValue );
+    OGRGeometryFactory::createFromWkt( &pszInput, NULL, &poGeom );
+    poFeature->SetGeometryDirectly( poGeom );
+    poLayer->CreateFeature( poFeature );
+    delete poFeature;
+}
+
+/************************************************************************/
+/*                            CreateLayer()                             */
+/************************************************************************/
+
+static OGRLayer *CreateLayer( GDALDataset *poDS, const char *pszName,
+                              const char *pszField )
+
+{
+    OGRLayer *poLayer = poDS->CreateLayer( pszName, NULL, wkbPolygon, NULL );
+    OGRFieldDefn oField( pszField, OFTInteger );
+    poLayer->CreateField( &oField );
+    return poLayer;
+}
+
+/************************************************************************/
+/*                             RunOverlay()                             */
+/*                                                                      */
+/*      Run the method with the given maximum number of cached method   */
+/*      features, 0 meaning that the spatial filter is used.            */
+/************************************************************************/
+
+static OGRLayer *RunOverlay( GDALDataset *poDS, OGRLayer *poInput,
+                             OGRLayer *poMethod, OverlayMethod pfnMethod,
+                             const char *pszMaxCached )
+
+{
+    OGRLayer *poResult =
+        poDS->CreateLayer( CPLSPrintf( "result_%s", pszMaxCached ), NULL,
+                           wkbUnknown, NULL );
+
+    CPLSetConfigOption( "OGR_OVERLAY_MAX_CACHED_METHOD_FEATURES",
+                        pszMaxCached );
+    OGRErr eErr = (poInput->*pfnMethod)( poMethod, poResult, NULL,
+                                         NULL, NULL );
+    CPLSetConfigOption( "OGR_OVERLAY_MAX_CACHED_METHOD_FEATURES", NULL );
+
+    CHECK( eErr == OGRERR_NONE );
+    return poResult;
+}
+
+/************************************************************************/
+/*                           CompareLayers()                            */
+/*                                                                      */
+/*      The geometries are compared topologically, as a geometry        */
+/*      derived without computing the intersection has the vertex       */
+/*      order of the input, not the one of the GEOS result, and         */
+/*      OGRGeometry::Equals() compares the vertices one by one.         */
+/************************************************************************/
+
+static void CompareLayers( const char *pszMethod, OGRLayer *poPrepared,
+                           OGRLayer *poFiltered )
+
+{
+    const int nCount = (int) poFiltered->GetFeatureCount();
+
+    printf( "%-14s %d feature(s)\n", pszMethod, nCount );
+    CHECK( poPrepared->GetFeatureCount() == nCount );
+    CHECK( nCount > 0 );
+
+    poPrepared->ResetReading();
+    poFiltered->ResetReading();
+    for( int i = 0; i < nCount; i++ )
+    {
+        OGRFeature *poFeatP = poPrepared->GetNextFeature();
+        OGRFeature *poFeatF = poFiltered->GetNextFeature();
+        if( poFeatP == NULL || poFeatF == NULL )
+        {
+            CHECK( poFeatP != NULL && poFeatF != NULL );
+            delete poFeatP;
+            delete poFeatF;
+            break;
+        }
+
+        CHECK( poFeatP->GetFieldCount() == poFeatF->GetFieldCount() );
+        for( int iField = 0; iField < poFeatF->GetFieldCount(); iField++ )
+        {
+            CHECK( poFeatP->IsFieldSet(iField) ==
+                   poFeatF->IsFieldSet(iField) );
+            CHECK( poFeatP->GetFieldAsInteger(iField) ==
+                   poFeatF->GetFieldAsInteger(iField) );
+        }
+
+        OGRGeometry *poGeomP = poFeatP->GetGeometryRef();
+        OGRGeometry *poGeomF = poFeatF->GetGeometryRef();
+        CHECK( poGeomP != NULL && poGeomF != NULL );
+        if( poGeomP != NULL && poGeomF != NULL )
+        {
+            if( !poGeomP->Contains( poGeomF ) ||
+                !poGeomF->Contains( poGeomP ) )
+            {
+                char *pszP = NULL, *pszF = NULL;
+                poGeomP->exportToWkt( &pszP );
+                poGeomF->exportToWkt( &pszF );
+                fprintf( stderr, "  feature %d: %s != %s\n", i, pszP, pszF );
+                CPLFree( pszP );
+                CPLFree( pszF );
+                nErrors++;
+            }
+        }
+
+        delete poFeatP;
+        delete poFeatF;
+    }
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char *argv[] )
+
+{
+    (void) argc;
+    (void) argv;
+
+    GDALAllRegister();
+
+    if( !OGRGeometryFactory::haveGEOS() )
+    {
+        printf( "GEOS not available, skipped\n" );
+        return 0;
+    }
+
+    GDALDriver *poDriver = (GDALDriver *) GDALGetDriverByName( "Memory" );
+    GDALDataset *poDS = poDriver->Create( "", 0, 0, 0, GDT_Unknown, NULL );
+
+/* -------------------------------------------------------------------- */
+/*      Input polygons overlapping a method polygon, contained in       */
+/*      one, disjoint from all, and containing one.                     */
+/* -------------------------------------------------------------------- */
+    OGRLayer *poInput = CreateLayer( poDS, "input", "a" );
+    AddFeature( poInput, 1, "POLYGON ((5 5,15 5,15 15,5 15,5 5))" );
+    AddFeature( poInput, 2, "POLYGON ((2 2,4 2,4 4,2 4,2 2))" );
+    AddFeature( poInput, 3, "POLYGON ((50 50,60 50,60 60,50 60,50 50))" );
+    AddFeature( poInput, 4, "POLYGON ((20 20,40 20,40 40,20 40,20 20))" );
+    AddFeature( poInput, 5, "POLYGON ((1 6,3 6,3 8,1 8,1 6),"
+                            "(1.5 6.5,2.5 6.5,2.5 7.5,1.5 7.5,1.5 6.5))" );
+
+    OGRLayer *poMethod = CreateLayer( poDS, "method", "b" );
+    AddFeature( poMethod, 10, "POLYGON ((0 0,10 0,10 10,0 10,0 0))" );
+    AddFeature( poMethod, 20, "POLYGON ((25 25,30 25,30 30,25 30,25 25))" );
+    AddFeature( poMethod, 30, "POLYGON ((12 0,18 0,18 8,12 8,12 0))" );
+
+/* -------------------------------------------------------------------- */
+/*      Compare each method with and without the prepared geometries.   */
+/* -------------------------------------------------------------------- */
+    static const struct
+    {
+        const char    *pszName;
+        OverlayMethod  pfnMethod;
+    } asMethods[] = {
+        { "Intersection",  &OGRLayer::Intersection },
+        { "Union",         &OGRLayer::Union },
+        { "SymDifference", &OGRLayer::SymDifference },
+        { "Identity",      &OGRLayer::Identity },
+        { "Update",        &OGRLayer::Update },
+        { "Clip",          &OGRLayer::Clip },
+        { "Erase",         &OGRLayer::Erase }
+    };
+
+    for( size_t i = 0; i < sizeof(asMethods) / sizeof(asMethods[0]); i++ )
+    {
+        OGRLayer *poPrepared = RunOverlay( poDS, poInput, poMethod,
+                                           asMethods[i].pfnMethod, "1000" );
+        OGRLayer *poFiltered = RunOverlay( poDS, poInput, poMethod,
+                                           asMethods[i].pfnMethod, "0" );
+
+        CompareLayers( asMethods[i].pszName, poPrepared, poFiltered );
+
+        while( poDS->GetLayerCount() > 2 )
+            poDS->DeleteLayer( poDS->GetLayerCount() - 1 );
+    }
+
+    GDALClose( poDS );
+
+    if( nErrors != 0 )
+    {
+        fprintf( stderr, "%d check(s) failed\n", nErrors );
+        return 1;
+    }
+
+    printf( "All checks passed\n" );
+    return 0;
+}
@@ -0,0 +1,302 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Check that the event driven and arena parsing modes of
+ *           CPLMiniXML agree with CPLParseXMLString()
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_minixml.h"
+#include "cpl_string.h"
+
+CPL_CVSID("$Id$");
+
+static int nErrors = 0;
+
+#define CHECK(x) \
+    do { if( !(x) ) { fprintf(stderr, "%s:%d: check '%s' failed\n", \
+                              __FILE__, __LINE__, #x); nErrors++; } } while(0)
+
+/************************************************************************/
+/*                         Event callbacks.                             */
+/*                                                                      */
+/*      Record the events as a string, in the form TraceTree() gives    */
+/*      for the matching tree.                                          */
+/************************************************************************/
+
+typedef struct
+{
+    CPLString   osTrace;
+    int         nStartCount;
+    int         nStopAtStart;
+} EventRecorder;
+
+static int StartElement( void *pUserData, const char *pszName )
+{
+    EventRecorder *psRecorder = (EventRecorder *) pUserData;
+    psRecorder->osTrace += CPLSPrintf( "S(%s)", pszName );
+    return ++psRecorder->nStartCount != psRecorder->nStopAtStart;
+}
+
+static int Attribute( void *pUserData, const char *pszName,
+                      const char *pszValue )
+{
+    ((EventRecorder *) pUserData)->osTrace +=
+        CPLSPrintf( "A(%s=%s)", pszName, pszValue );
+    return TRUE;
+}
+
+static int EndElement( void *pUserData, const char *pszName )
+{
+    ((EventRecorder *) pUserData)->osTrace += CPLSPrintf( "E(%s)", pszName );
+    return TRUE;
+}
+
+static int Text( void *pUserData, const char *pszText )
+{
+    ((EventRecorder *) pUserData)->osTrace += CPLSPrintf( "T(%s)", pszText );
+    return TRUE;
+}
+
+static int Comment( void *pUserData, const char *pszText )
+{
+    ((EventRecorder *) pUserData)->osTrace += CPLSPrintf( "C(%s)", pszText );
+    return TRUE;
+}
+
+static int Literal( void *pUserData, const char *pszText )
+{
+    ((EventRecorder *) pUserData)->osTrace += CPLSPrintf( "L(%s)", pszText );
+    return TRUE;
+}
+
+static const CPLXMLParseHandlers sHandlers =
+{
+    StartElement, Attribute, EndElement, Text, Comment, Literal
+};
+
+/************************************************************************/
+/*                             TraceTree()                              */
+/************************************************************************/
+
+static void TraceTree( const CPLXMLNode *psNode, CPLString &osTrace )
+
+{
+    for( ; psNode != NULL; psNode = psNode->psNext )
+    {
+        switch( psNode->eType )
+        {
+          case CXT_Element:
+            osTrace += CPLSPrintf( "S(%s)", psNode->pszValue );
+            TraceTree( psNode->psChild, osTrace );
+            osTrace += CPLSPrintf( "E(%s)", psNode->pszValue );
+            break;
+
+          case CXT_Attribute:
+            osTrace += CPLSPrintf( "A(%s=%s)", psNode->pszValue,
+                                   psNode->psChild ?
+                                   psNode->psChild->pszValue : "" );
+            break;
+
+          case CXT_Text:
+            osTrace += CPLSPrintf( "T(%s)", psNode->pszValue );
+            break;
+
+          case CXT_Comment:
+            osTrace += CPLSPrintf( "C(%s)", psNode->pszValue );
+            break;
+
+          case CXT_Literal:
+            osTrace += CPLSPrintf( "L(%s)", psNode->pszValue );
+            break;
+        }
+    }
+}
+
+/************************************************************************/
+/*                           CheckDocument()                            */
+/*                                                                      */
+/*      Parse the document in the three modes and compare the results. */
+/************************************************************************/
+
+static void CheckDocument( const char *pszLabel, const char *pszXML )
+
+{
+    CPLXMLNode *psTree = CPLParseXMLString( pszXML );
+    CHECK( psTree != NULL );
+
+    CPLXMLNode *psArena = CPLParseXMLStringInArena( pszXML );
+    CHECK( psArena != NULL );
+
+    EventRecorder sRecorder;
+    sRecorder.nStartCount = 0;
+    sRecorder.nStopAtStart = -1;
+    CHECK( CPLParseXMLStringWithHandlers( pszXML, &sHandlers, &sRecorder ) );
+
+    if( psTree == NULL || psArena == NULL )
+    {
+        CPLDestroyXMLNode( psTree );
+        CPLDestroyXMLArenaTree( psArena );
+        return;
+    }
+
+    char *pszTreeXML = CPLSerializeXMLTree( psTree );
+    char *pszArenaXML = CPLSerializeXMLTree( psArena );
+    CPLString osTreeTrace;
+    TraceTree( psTree, osTreeTrace );
+
+    const int bArenaOK = strcmp( pszTreeXML, pszArenaXML ) == 0;
+    const int bEventsOK = osTreeTrace == sRecorder.osTrace;
+
+    printf( "%-18s arena %s, events %s\n", pszLabel,
+            bArenaOK ? "same" : "DIFFERENT", bEventsOK ? "same" : "DIFFERENT" );
+    if( !bArenaOK )
+    {
+        fprintf( stderr, "  tree:  %s\n  arena: %s\n", pszTreeXML, pszArenaXML );
+        nErrors++;
+    }
+    if( !bEventsOK )
+    {
+        fprintf( stderr, "  tree:   %s\n  events: %s\n",
+                 osTreeTrace.c_str(), sRecorder.osTrace.c_str() );
+        nErrors++;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      A clone of the arena tree is a regular tree.                    */
+/* -------------------------------------------------------------------- */
+    CPLXMLNode *psClone = CPLCloneXMLTree( psArena );
+    CPLSetXMLValue( psClone, "#cloned", "yes" );
+    CPLDestroyXMLNode( psClone );
+
+    CPLFree( pszTreeXML );
+    CPLFree( pszArenaXML );
+    CPLDestroyXMLNode( psTree );
+    CPLDestroyXMLArenaTree( psArena );
+}
+
+/************************************************************************/
+/*                            CheckInvalid()                            */
+/************************************************************************/
+
+static void CheckInvalid( const char *pszXML )
+
+{
+    EventRecorder sRecorder;
+    sRecorder.nStartCount = 0;
+    sRecorder.nStopAtStart = -1;
+
+    CPLPushErrorHandler( CPLQuietErrorHandler );
+    CPLXMLNode *psTree = CPLParseXMLString( pszXML );
+    CPLString osTreeError = CPLGetLastErrorMsg();
+    CPLXMLNode *psArena = CPLParseXMLStringInArena( pszXML );
+    CPLString osArenaError = CPLGetLastErrorMsg();
+    int bEvents = CPLParseXMLStringWithHandlers( pszXML, &sHandlers,
+                                                 &sRecorder );
+    CPLString osEventsError = CPLGetLastErrorMsg();
+    CPLPopErrorHandler();
+
+    CHECK( psTree == NULL );
+    CHECK( psArena == NULL );
+    CHECK( !bEvents );
+    CHECK( osTreeError.size() > 0 );
+    CHECK( osArenaError == osTreeError );
+    CHECK( osEventsError == osTreeError );
+
+    CPLDestroyXMLNode( psTree );
+    CPLDestroyXMLArenaTree( psArena );
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char *argv[] )
+
+{
+    (void) argc;
+    (void) argv;
+
+    CheckDocument( "simple", "<a/>" );
+    CheckDocument( "attributes",
+                   "<a x=\"1\" y='two words' z=\"&lt;&amp;&gt;\"><b c=\"\"/></a>" );
+    CheckDocument( "text and entities",
+                   "<a>some &lt;text&gt; &amp; &quot;quotes&quot;<b>x</b>"
+                   "tail</a>" );
+    CheckDocument( "cdata", "<a><![CDATA[<not> & parsed]]></a>" );
+    CheckDocument( "prolog",
+                   "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                   "<!DOCTYPE a SYSTEM \"a.dtd\">\n"
+                   "<!-- a comment -->\n"
+                   "<a>\n  <b>1</b>\n  <!-- inner -->\n  <c/>\n</a>" );
+    CheckDocument( "namespaces",
+                   "<ns:a xmlns:ns=\"http://x\"><ns:b ns:c=\"1\">v</ns:b>"
+                   "</ns:a>" );
+
+/* -------------------------------------------------------------------- */
+/*      A document large enough to span several arena blocks.           */
+/* -------------------------------------------------------------------- */
+    CPLString osLarge = "<VRTDataset rasterXSize=\"100\" rasterYSize=\"100\">";
+    for( int i = 0; i < 20000; i++ )
+    {
+        osLarge += CPLSPrintf(
+            "<SimpleSource><SourceFilename relativeToVRT=\"1\">tile_%d.tif"
+            "</SourceFilename><SrcRect xOff=\"%d\" yOff=\"0\" xSize=\"10\" "
+            "ySize=\"10\"/><!-- %d --></SimpleSource>", i, i, i );
+    }
+    osLarge += "</VRTDataset>";
+    CheckDocument( "large", osLarge );
+
+/* -------------------------------------------------------------------- */
+/*      Documents that are not well formed fail in all modes, with     */
+/*      the same error.                                                 */
+/* -------------------------------------------------------------------- */
+    CheckInvalid( "<a><b></a>" );
+    CheckInvalid( "<a" );
+    CheckInvalid( "<a x='1></a>" );
+    CheckInvalid( "<a></b>" );
+
+/* -------------------------------------------------------------------- */
+/*      A callback returning FALSE stops the parsing.                   */
+/* -------------------------------------------------------------------- */
+    EventRecorder sRecorder;
+    sRecorder.nStartCount = 0;
+    sRecorder.nStopAtStart = 2;
+    CHECK( !CPLParseXMLStringWithHandlers( "<a><b><c/></b><d/></a>",
+                                           &sHandlers, &sRecorder ) );
+    CHECK( sRecorder.nStartCount == 2 );
+    CHECK( sRecorder.osTrace == "S(a)S(b)" );
+
+    if( nErrors != 0 )
+    {
+        fprintf( stderr, "%d check(s) failed\n", nErrors );
+        return 1;
+    }
+
+    printf( "All checks passed\n" );
+    return 0;
+}
@@ -0,0 +1,190 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Check OGRGeometryFactory::organizePolygons() on rings whose
+ *           edges are tested with and without the edge index
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogr_geometry.h"
+#include "cpl_conv.h"
+
+CPL_CVSID("$Id$");
+
+static int nErrors = 0;
+
+#define CHECK(x) \
+    do { if( !(x) ) { fprintf(stderr, "%s:%d: check '%s' failed\n", \
+                              __FILE__, __LINE__, #x); nErrors++; } } while(0)
+
+/************************************************************************/
+/*                          MakeSteppedSquare()                         */
+/*                                                                      */
+/*      100x100 square whose right and top sides are staircases of      */
+/*      nSteps steps, so that it has horizontal and vertical edges at   */
+/*      every multiple of 100 / nSteps.                                 */
+/************************************************************************/
+
+static OGRPolygon *MakeSteppedSquare( int nSteps )
+
+{
+    OGRLinearRing *poRing = new OGRLinearRing();
+    const double dfStep = 100.0 / nSteps;
+    double dfX = 100.0;
+    double dfY = 100.0;
+    int i;
+
+    poRing->addPoint( 0.0, 0.0 );
+    poRing->addPoint( 100.0, 0.0 );
+    for( i = 1; i <= nSteps; i++ )
+    {
+        poRing->addPoint( dfX, i * dfStep );
+        dfX = (dfX == 100.0) ? 99.0 : 100.0;
+        poRing->addPoint( dfX, i * dfStep );
+    }
+    for( i = nSteps - 1; i >= 0; i-- )
+    {
+        poRing->addPoint( i * dfStep, dfY );
+        dfY = (dfY == 100.0) ? 99.0 : 100.0;
+        poRing->addPoint( i * dfStep, dfY );
+    }
+    poRing->addPoint( 0.0, 0.0 );
+
+    OGRPolygon *poPoly = new OGRPolygon();
+    poPoly->addRingDirectly( poRing );
+    return poPoly;
+}
+
+/************************************************************************/
+/*                             MakeSquare()                             */
+/************************************************************************/
+
+static OGRPolygon *MakeSquare( double dfMinX, double dfMinY,
+                               double dfMaxX, double dfMaxY )
+
+{
+    OGRLinearRing *poRing = new OGRLinearRing();
+    poRing->addPoint( dfMinX, dfMinY );
+    poRing->addPoint( dfMaxX, dfMinY );
+    poRing->addPoint( dfMaxX, dfMaxY );
+    poRing->addPoint( dfMinX, dfMaxY );
+    poRing->addPoint( dfMinX, dfMinY );
+
+    OGRPolygon *poPoly = new OGRPolygon();
+    poPoly->addRingDirectly( poRing );
+    return poPoly;
+}
+
+/************************************************************************/
+/*                          CheckSteppedSquare()                        */
+/*                                                                      */
+/*      The vertices of the inner squares, and the middles of their     */
+/*      edges, are on the supporting lines of edges of the outer ring,  */
+/*      but not on the edges.                                           */
+/*      With 3 inner rings, the outer ring is tested more than once,    */
+/*      and its edges get indexed if it is big enough.                  */
+/************************************************************************/
+
+static void CheckSteppedSquare( int nSteps )
+
+{
+    OGRGeometry *apoGeoms[4];
+
+    apoGeoms[0] = MakeSteppedSquare( nSteps );
+    apoGeoms[1] = MakeSquare( 10, 50, 20, 60 );
+    apoGeoms[2] = MakeSquare( 30, 50, 40, 60 );
+    apoGeoms[3] = MakeSquare( 60, 20, 70, 30 );
+
+    const int nOuterPoints =
+        ((OGRPolygon *) apoGeoms[0])->getExteriorRing()->getNumPoints();
+
+    int bIsValid = FALSE;
+    OGRGeometry *poRet =
+        OGRGeometryFactory::organizePolygons( apoGeoms, 4, &bIsValid, NULL );
+
+    printf( "Stepped square, %d points: %s\n",
+            nOuterPoints, poRet->getGeometryName() );
+
+    CHECK( bIsValid );
+    CHECK( wkbFlatten(poRet->getGeometryType()) == wkbPolygon );
+    if( wkbFlatten(poRet->getGeometryType()) == wkbPolygon )
+        CHECK( ((OGRPolygon *) poRet)->getNumInteriorRings() == 3 );
+
+    delete poRet;
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char *argv[] )
+
+{
+    (void) argc;
+    (void) argv;
+
+/* -------------------------------------------------------------------- */
+/*      Only a point on an edge is on the boundary, not a point on      */
+/*      the supporting line of an edge.                                 */
+/* -------------------------------------------------------------------- */
+    OGRPolygon *poPoly = MakeSteppedSquare( 10 );
+    OGRLinearRing *poRing = poPoly->getExteriorRing();
+    OGRPoint oPoint;
+
+    oPoint.setX( 10 ); oPoint.setY( 50 );
+    CHECK( !poRing->isPointOnRingBoundary( &oPoint ) );
+    CHECK( poRing->isPointInRing( &oPoint ) );
+
+    oPoint.setX( 99.5 ); oPoint.setY( 50 );
+    CHECK( poRing->isPointOnRingBoundary( &oPoint ) );
+
+    oPoint.setX( 50 ); oPoint.setY( 0 );
+    CHECK( poRing->isPointOnRingBoundary( &oPoint ) );
+
+    oPoint.setX( 0 ); oPoint.setY( 100 );
+    CHECK( poRing->isPointOnRingBoundary( &oPoint ) );
+
+    oPoint.setX( 0 ); oPoint.setY( 101 );
+    CHECK( !poRing->isPointOnRingBoundary( &oPoint, FALSE ) );
+
+    delete poPoly;
+
+/* -------------------------------------------------------------------- */
+/*      organizePolygons() must give the same result whether the        */
+/*      outer ring is small enough to be tested edge by edge or big     */
+/*      enough to have its edges indexed.                               */
+/* -------------------------------------------------------------------- */
+    CheckSteppedSquare( 10 );
+    CheckSteppedSquare( 100 );
+
+    if( nErrors != 0 )
+    {
+        fprintf( stderr, "%d check(s) failed\n", nErrors );
+        return 1;
+    }
+
+    printf( "All checks passed\n" );
+    return 0;
+}
@@ -0,0 +1,247 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Check that GDALSieveFilter() gives the same result with several
+ *           threads as with one, with and without a mask band
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal_alg.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+
+CPL_CVSID("$Id$");
+
+static int nErrors = 0;
+
+#define CHECK(x) \
+    do { if( !(x) ) { fprintf(stderr, "%s:%d: check '%s' failed\n", \
+                              __FILE__, __LINE__, #x); nErrors++; } } while(0)
+
+/************************************************************************/
+/*                             NextRandom()                             */
+/*                                                                      */
+/*      Small linear congruential generator, so that the rasters are    */
+/*      the same on all platforms.                                      */
+/************************************************************************/
+
+static GUInt32 nSeed = 12345;
+
+static int NextRandom( int nMax )
+
+{
+    nSeed = nSeed * 1103515245U + 12345U;
+    return (int) ((nSeed >> 16) % (GUInt32) nMax);
+}
+
+/************************************************************************/
+/*                            CreateBand()                              */
+/************************************************************************/
+
+static GDALDatasetH CreateBand( int nXSize, int nYSize, GByte *pabyData )
+
+{
+    GDALDriverH hDriver = GDALGetDriverByName( "MEM" );
+    GDALDatasetH hDS = GDALCreate( hDriver, "", nXSize, nYSize, 1, GDT_Byte,
+                                   NULL );
+
+    if( pabyData != NULL )
+        CHECK( GDALRasterIO( GDALGetRasterBand( hDS, 1 ), GF_Write,
+                             0, 0, nXSize, nYSize, pabyData, nXSize, nYSize,
+                             GDT_Byte, 0, 0 ) == CE_None );
+    return hDS;
+}
+
+/************************************************************************/
+/*                              RunSieve()                              */
+/*                                                                      */
+/*      Sieve the source into a new band and return its pixels.         */
+/************************************************************************/
+
+static GByte *RunSieve( GDALDatasetH hSrcDS, GDALDatasetH hMaskDS,
+                        int nThreshold, int nConnectedness,
+                        const char *pszThreads )
+
+{
+    const int nXSize = GDALGetRasterXSize( hSrcDS );
+    const int nYSize = GDALGetRasterYSize( hSrcDS );
+    GDALDatasetH hDstDS = CreateBand( nXSize, nYSize, NULL );
+    char **papszOptions = CSLSetNameValue( NULL, "NUM_THREADS", pszThreads );
+
+    CHECK( GDALSieveFilter( GDALGetRasterBand( hSrcDS, 1 ),
+                            hMaskDS ? GDALGetRasterBand( hMaskDS, 1 ) : NULL,
+                            GDALGetRasterBand( hDstDS, 1 ),
+                            nThreshold, nConnectedness, papszOptions,
+                            NULL, NULL ) == CE_None );
+    CSLDestroy( papszOptions );
+
+    GByte *pabyResult = (GByte *) CPLMalloc( nXSize * nYSize );
+    CHECK( GDALRasterIO( GDALGetRasterBand( hDstDS, 1 ), GF_Read,
+                         0, 0, nXSize, nYSize, pabyResult, nXSize, nYSize,
+                         GDT_Byte, 0, 0 ) == CE_None );
+    GDALClose( hDstDS );
+
+    return pabyResult;
+}
+
+/************************************************************************/
+/*                            CheckSmall()                              */
+/*                                                                      */
+/*      Single pixel islands are replaced when valid, and left alone    */
+/*      when masked out or surrounded by nodata.                        */
+/************************************************************************/
+
+static void CheckSmall()
+
+{
+    GByte abySrc[8 * 8];
+    GByte abyMask[8 * 8];
+
+    memset( abySrc, 1, sizeof(abySrc) );
+    memset( abyMask, 255, sizeof(abyMask) );
+
+    abySrc[2 * 8 + 2] = 7;              /* valid island */
+    abySrc[2 * 8 + 5] = 8;              /* masked out island */
+    abyMask[2 * 8 + 5] = 0;
+    abySrc[5 * 8 + 5] = 9;              /* island surrounded by nodata */
+    for( int iY = 4; iY <= 6; iY++ )
+        for( int iX = 4; iX <= 6; iX++ )
+            if( iX != 5 || iY != 5 )
+                abyMask[iY * 8 + iX] = 0;
+
+    GDALDatasetH hSrcDS = CreateBand( 8, 8, abySrc );
+    GDALDatasetH hMaskDS = CreateBand( 8, 8, abyMask );
+
+    for( int iThreads = 1; iThreads <= 2; iThreads++ )
+    {
+        GByte *pabyDst = RunSieve( hSrcDS, hMaskDS, 2, 4,
+                                   CPLSPrintf( "%d", iThreads ) );
+
+        CHECK( pabyDst[2 * 8 + 2] == 1 );
+        CHECK( pabyDst[2 * 8 + 5] == 8 );
+        CHECK( pabyDst[5 * 8 + 5] == 9 );
+        CHECK( pabyDst[0] == 1 );
+        CPLFree( pabyDst );
+    }
+
+    GDALClose( hSrcDS );
+    GDALClose( hMaskDS );
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char *argv[] )
+
+{
+    (void) argc;
+    (void) argv;
+
+    GDALAllRegister();
+
+    CheckSmall();
+
+/* -------------------------------------------------------------------- */
+/*      A raster tall enough to be processed in several stripes, made   */
+/*      of blocks of a few classes with noise, and a mask band with     */
+/*      nodata rectangles and scattered nodata pixels, some of them     */
+/*      on the stripe boundaries.                                       */
+/* -------------------------------------------------------------------- */
+    const int nXSize = 1024;
+    const int nYSize = 3000;
+    GByte *pabySrc = (GByte *) CPLMalloc( nXSize * nYSize );
+    GByte *pabyMask = (GByte *) CPLMalloc( nXSize * nYSize );
+
+    for( int iY = 0; iY < nYSize; iY++ )
+    {
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            const int iPixel = iY * nXSize + iX;
+
+            pabySrc[iPixel] = (GByte) (((iX / 37) + (iY / 23)) % 4);
+            if( NextRandom( 100 ) < 20 )
+                pabySrc[iPixel] = (GByte) NextRandom( 6 );
+
+            pabyMask[iPixel] = 255;
+            if( (iX / 100 + iY / 150) % 5 == 0 || NextRandom( 100 ) < 3 )
+                pabyMask[iPixel] = 0;
+        }
+    }
+
+    GDALDatasetH hSrcDS = CreateBand( nXSize, nYSize, pabySrc );
+    GDALDatasetH hMaskDS = CreateBand( nXSize, nYSize, pabyMask );
+
+/* -------------------------------------------------------------------- */
+/*      Compare the threaded result with the single threaded one.       */
+/* -------------------------------------------------------------------- */
+    for( int iCase = 0; iCase < 4; iCase++ )
+    {
+        GDALDatasetH hCaseMaskDS = (iCase % 2) ? hMaskDS : NULL;
+        const int nConnectedness = (iCase < 2) ? 4 : 8;
+
+        GByte *pabyRef = RunSieve( hSrcDS, hCaseMaskDS, 10, nConnectedness,
+                                   "1" );
+        GByte *pabyThreaded = RunSieve( hSrcDS, hCaseMaskDS, 10,
+                                        nConnectedness, "4" );
+        int nDiff = 0, nChanged = 0, nMaskChanged = 0;
+
+        for( int i = 0; i < nXSize * nYSize; i++ )
+        {
+            if( pabyRef[i] != pabyThreaded[i] )
+                nDiff++;
+            if( pabyRef[i] != pabySrc[i] )
+            {
+                nChanged++;
+                if( hCaseMaskDS != NULL && pabyMask[i] == 0 )
+                    nMaskChanged++;
+            }
+        }
+
+        printf( "%d-connected, %s mask: %d pixel(s) changed, "
+                "%d difference(s)\n", nConnectedness,
+                hCaseMaskDS ? "with" : "without", nChanged, nDiff );
+        CHECK( nChanged > 0 );
+        CHECK( nDiff == 0 );
+        CHECK( nMaskChanged == 0 );
+
+        CPLFree( pabyRef );
+        CPLFree( pabyThreaded );
+    }
+
+    GDALClose( hSrcDS );
+    GDALClose( hMaskDS );
+    CPLFree( pabySrc );
+    CPLFree( pabyMask );
+
+    if( nErrors != 0 )
+    {
+        fprintf( stderr, "%d check(s) failed\n", nErrors );
+        return 1;
+    }
+
+    printf( "All checks passed\n" );
+    return 0;
+}
@@ -0,0 +1,274 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Check that dirty blocks evicted from the block cache are written
+ *           back in runs along their row, with the right data
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal_priv.h"
+#include "cpl_conv.h"
+#include <vector>
+
+CPL_CVSID("$Id$");
+
+static int nErrors = 0;
+
+#define CHECK(x) \
+    do { if( !(x) ) { fprintf(stderr, "%s:%d: check '%s' failed\n", \
+                              __FILE__, __LINE__, #x); nErrors++; } } while(0)
+
+#define BLOCK_SIZE      64
+#define BLOCKS_PER_ROW  32
+#define BLOCKS_PER_COL  8
+
+/************************************************************************/
+/* ==================================================================== */
+/*                           RecordingDataset                           */
+/* ==================================================================== */
+/************************************************************************/
+
+class RecordingDataset : public GDALDataset
+{
+  public:
+    std::vector<GByte>                  abyData;
+    std::vector< std::pair<int,int> >   aoWrites;
+
+                RecordingDataset();
+};
+
+/************************************************************************/
+/* ==================================================================== */
+/*                           RecordingBand                              */
+/* ==================================================================== */
+/************************************************************************/
+
+class RecordingBand : public GDALRasterBand
+{
+  public:
+                RecordingBand( RecordingDataset *poDS );
+
+    virtual CPLErr IReadBlock( int, int, void * );
+    virtual CPLErr IWriteBlock( int, int, void * );
+};
+
+/************************************************************************/
+/*                          RecordingDataset()                          */
+/************************************************************************/
+
+RecordingDataset::RecordingDataset()
+
+{
+    nRasterXSize = BLOCKS_PER_ROW * BLOCK_SIZE;
+    nRasterYSize = BLOCKS_PER_COL * BLOCK_SIZE;
+    eAccess = GA_Update;
+    abyData.resize( (size_t) nRasterXSize * nRasterYSize );
+    SetBand( 1, new RecordingBand( this ) );
+}
+
+/************************************************************************/
+/*                           RecordingBand()                            */
+/************************************************************************/
+
+RecordingBand::RecordingBand( RecordingDataset *poDSIn )
+
+{
+    poDS = poDSIn;
+    nBand = 1;
+    eDataType = GDT_Byte;
+    nBlockXSize = BLOCK_SIZE;
+    nBlockYSize = BLOCK_SIZE;
+}
+
+/************************************************************************/
+/*                             IReadBlock()                             */
+/************************************************************************/
+
+CPLErr RecordingBand::IReadBlock( int nBlockXOff, int nBlockYOff,
+                                  void *pImage )
+
+{
+    RecordingDataset *poRDS = (RecordingDataset *) poDS;
+
+    for( int iY = 0; iY < BLOCK_SIZE; iY++ )
+        memcpy( (GByte *) pImage + iY * BLOCK_SIZE,
+                &poRDS->abyData[(nBlockYOff * BLOCK_SIZE + iY) * nRasterXSize
+                                + nBlockXOff * BLOCK_SIZE],
+                BLOCK_SIZE );
+    return CE_None;
+}
+
+/************************************************************************/
+/*                            IWriteBlock()                             */
+/************************************************************************/
+
+CPLErr RecordingBand::IWriteBlock( int nBlockXOff, int nBlockYOff,
+                                   void *pImage )
+
+{
+    RecordingDataset *poRDS = (RecordingDataset *) poDS;
+
+    poRDS->aoWrites.push_back( std::pair<int,int>( nBlockXOff, nBlockYOff ) );
+    for( int iY = 0; iY < BLOCK_SIZE; iY++ )
+        memcpy( &poRDS->abyData[(nBlockYOff * BLOCK_SIZE + iY) * nRasterXSize
+                                + nBlockXOff * BLOCK_SIZE],
+                (GByte *) pImage + iY * BLOCK_SIZE,
+                BLOCK_SIZE );
+    return CE_None;
+}
+
+/************************************************************************/
+/*                              Pattern()                               */
+/************************************************************************/
+
+static GByte Pattern( int iX, int iY )
+
+{
+    return (GByte) ((iX * 3 + iY * 5 + (iX / BLOCK_SIZE) * 11) & 0xff);
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char *argv[] )
+
+{
+    (void) argc;
+    (void) argv;
+
+    GDALAllRegister();
+
+/* -------------------------------------------------------------------- */
+/*      Dirty all the blocks column by column, with a cache of 64       */
+/*      blocks, so that blocks are evicted while the following blocks   */
+/*      of their row are still cached and dirty.                        */
+/* -------------------------------------------------------------------- */
+    const GIntBig nOldCacheMax = GDALGetCacheMax64();
+    GDALSetCacheMax64( 64 * BLOCK_SIZE * BLOCK_SIZE );
+
+    RecordingDataset *poDS = new RecordingDataset();
+    GDALRasterBand *poBand = poDS->GetRasterBand( 1 );
+
+    for( int iBlockX = 0; iBlockX < BLOCKS_PER_ROW; iBlockX++ )
+    {
+        for( int iBlockY = 0; iBlockY < BLOCKS_PER_COL; iBlockY++ )
+        {
+            GDALRasterBlock *poBlock =
+                poBand->GetLockedBlockRef( iBlockX, iBlockY, TRUE );
+            CHECK( poBlock != NULL );
+            if( poBlock == NULL )
+                continue;
+
+            GByte *pabyBlock = (GByte *) poBlock->GetDataRef();
+            for( int iY = 0; iY < BLOCK_SIZE; iY++ )
+                for( int iX = 0; iX < BLOCK_SIZE; iX++ )
+                    pabyBlock[iY * BLOCK_SIZE + iX] =
+                        Pattern( iBlockX * BLOCK_SIZE + iX,
+                                 iBlockY * BLOCK_SIZE + iY );
+            poBlock->MarkDirty();
+            poBlock->DropLock();
+        }
+    }
+
+    const int nEvictionWrites = (int) poDS->aoWrites.size();
+    poDS->FlushCache();
+
+/* -------------------------------------------------------------------- */
+/*      Every block is written once.  Evicted blocks are written with   */
+/*      the dirty blocks following them on their row, so most writes    */
+/*      on eviction follow the previous block of the same row, which    */
+/*      never happens when blocks are written one by one in eviction    */
+/*      order.                                                          */
+/* -------------------------------------------------------------------- */
+    std::vector<int> anWriteCount( BLOCKS_PER_ROW * BLOCKS_PER_COL, 0 );
+    int nInRun = 0, nLongestRun = 1, nRun = 1;
+
+    for( size_t i = 0; i < poDS->aoWrites.size(); i++ )
+    {
+        const int iBlockX = poDS->aoWrites[i].first;
+        const int iBlockY = poDS->aoWrites[i].second;
+        anWriteCount[iBlockY * BLOCKS_PER_ROW + iBlockX]++;
+
+        if( i > 0 && (int) i < nEvictionWrites
+            && iBlockY == poDS->aoWrites[i-1].second
+            && iBlockX == poDS->aoWrites[i-1].first + 1 )
+        {
+            nInRun++;
+            nRun++;
+            nLongestRun = MAX( nLongestRun, nRun );
+        }
+        else
+            nRun = 1;
+    }
+
+    printf( "%d block write(s), %d on eviction, %d of them following the "
+            "previous block, longest run %d\n",
+            (int) poDS->aoWrites.size(), nEvictionWrites, nInRun,
+            nLongestRun );
+
+    CHECK( nEvictionWrites > 0 );
+    CHECK( (int) poDS->aoWrites.size() == BLOCKS_PER_ROW * BLOCKS_PER_COL );
+    for( size_t i = 0; i < anWriteCount.size(); i++ )
+        CHECK( anWriteCount[i] == 1 );
+    CHECK( nInRun * 2 > nEvictionWrites );
+    CHECK( nLongestRun > 1 && nLongestRun <= 16 );
+
+/* -------------------------------------------------------------------- */
+/*      The data written, and read back through the cache, is right.    */
+/* -------------------------------------------------------------------- */
+    const int nXSize = poDS->GetRasterXSize();
+    const int nYSize = poDS->GetRasterYSize();
+    std::vector<GByte> abyRead( (size_t) nXSize * nYSize );
+    int nBadWritten = 0, nBadRead = 0;
+
+    CHECK( poBand->RasterIO( GF_Read, 0, 0, nXSize, nYSize, &abyRead[0],
+                             nXSize, nYSize, GDT_Byte, 0, 0,
+                             NULL ) == CE_None );
+    for( int iY = 0; iY < nYSize; iY++ )
+    {
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            if( poDS->abyData[iY * nXSize + iX] != Pattern( iX, iY ) )
+                nBadWritten++;
+            if( abyRead[iY * nXSize + iX] != Pattern( iX, iY ) )
+                nBadRead++;
+        }
+    }
+    CHECK( nBadWritten == 0 );
+    CHECK( nBadRead == 0 );
+
+    delete poDS;
+    GDALSetCacheMax64( nOldCacheMax );
+
+    if( nErrors != 0 )
+    {
+        fprintf( stderr, "%d check(s) failed\n", nErrors );
+        return 1;
+    }
+
+    printf( "All checks passed\n" );
+    return 0;
+}
@@ -420,6 +420,9 @@ void GDALRegister_BIGGIF()
         poDriver->pfnOpen = BIGGIFDataset::Open;
         poDriver->pfnIdentify = GIFAbstractDataset::Identify;
 
+        poDriver->AddOpenSignature( "GIF87a", 6 );
+        poDriver->AddOpenSignature( "GIF89a", 6 );
+
         GetGDALDriverManager()->RegisterDriver( poDriver );
     }
 }
@@ -734,6 +734,9 @@ void GDALRegister_GIF()
         poDriver->pfnCreateCopy = GIFDataset::CreateCopy;
         poDriver->pfnIdentify = GIFAbstractDataset::Identify;
 
+        poDriver->AddOpenSignature( "GIF87a", 6 );
+        poDriver->AddOpenSignature( "GIF89a", 6 );
+
         GetGDALDriverManager()->RegisterDriver( poDriver );
     }
 }
@@ -6104,6 +6104,8 @@ void GDALRegister_HFA()
         poDriver->pfnIdentify = HFADataset::Identify;
         poDriver->pfnRename = HFADataset::Rename;
         poDriver->pfnCopyFiles = HFADataset::CopyFiles;
+
+        poDriver->AddOpenSignature( "EHFA_HEADER_TAG", 15 );
         
 
         GetGDALDriverManager()->RegisterDriver( poDriver );
@@ -3731,6 +3731,9 @@ void GDALRegister_JPEG()
         poDriver->pfnOpen = JPGDatasetCommon::Open;
         poDriver->pfnCreateCopy = JPGDataset::CreateCopy;
 
+        poDriver->AddOpenSignature( "\xFF\xD8\xFF", 3 );
+        poDriver->AddOpenPrefix( "JPEG_SUBFILE:" );
+
         GetGDALDriverManager()->RegisterDriver( poDriver );
     }
 }
@@ -2039,6 +2039,7 @@ void GDALRegister_PNG()
         poDriver->pfnOpen = PNGDataset::Open;
         poDriver->pfnCreateCopy = PNGDataset::CreateCopy;
         poDriver->pfnIdentify = PNGDataset::Identify;
+        poDriver->AddOpenSignature( "\x89PNG\x0D\x0A\x1A\x0A", 8 );
 #ifdef SUPPORT_CREATE
         poDriver->pfnCreate = PNGDataset::Create;
 #endif
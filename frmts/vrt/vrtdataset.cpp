@@ -760,7 +760,8 @@ GDALDataset *VRTDataset::OpenXML( const char *pszXML, const char *pszVRTPath,
  /* -------------------------------------------------------------------- */
     CPLXMLNode	*psTree;
 
-    psTree = CPLParseXMLString( pszXML );
+    /* The tree is only read by XMLInit(), so it can live in an arena */
+    psTree = CPLParseXMLStringInArena( pszXML );
 
     if( psTree == NULL )
         return NULL;
@@ -770,7 +771,7 @@ GDALDataset *VRTDataset::OpenXML( const char *pszXML, const char *pszVRTPath,
     {
         CPLError( CE_Failure, CPLE_AppDefined,
                   "Missing VRTDataset element." );
-        CPLDestroyXMLNode( psTree );
+        CPLDestroyXMLArenaTree( psTree );
         return NULL;
     }
 
@@ -781,7 +782,7 @@ GDALDataset *VRTDataset::OpenXML( const char *pszXML, const char *pszVRTPath,
         CPLError( CE_Failure, CPLE_AppDefined, 
                   "Missing one of rasterXSize, rasterYSize or bands on"
                   " VRTDataset." );
-        CPLDestroyXMLNode( psTree );
+        CPLDestroyXMLArenaTree( psTree );
         return NULL;
     }
 
@@ -794,7 +795,7 @@ GDALDataset *VRTDataset::OpenXML( const char *pszXML, const char *pszVRTPath,
     
     if ( !GDALCheckDatasetDimensions(nXSize, nYSize) )
     {
-        CPLDestroyXMLNode( psTree );
+        CPLDestroyXMLArenaTree( psTree );
         return NULL;
     }
 
@@ -815,7 +816,7 @@ GDALDataset *VRTDataset::OpenXML( const char *pszXML, const char *pszVRTPath,
 /* -------------------------------------------------------------------- */
 /*      Try to return a regular handle on the file.                     */
 /* -------------------------------------------------------------------- */
-    CPLDestroyXMLNode( psTree );
+    CPLDestroyXMLArenaTree( psTree );
 
     return poDS;
 }
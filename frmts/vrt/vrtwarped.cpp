@@ -1030,17 +1030,22 @@ CPLErr VRTWarpedDataset::XMLInit( CPLXMLNode *psTree, const char *pszVRTPath )
         return eErr;
 
 /* -------------------------------------------------------------------- */
-/*      Find the GDALWarpOptions XML tree.                              */
+/*      Find the GDALWarpOptions XML tree.  Work on a copy of it, as    */
+/*      the source tree may be read-only.                               */
 /* -------------------------------------------------------------------- */
-    CPLXMLNode *psOptionsTree;
-    psOptionsTree = CPLGetXMLNode( psTree, "GDALWarpOptions" );
-    if( psOptionsTree == NULL )
+    CPLXMLNode *psOptionsTreeSrc;
+    psOptionsTreeSrc = CPLGetXMLNode( psTree, "GDALWarpOptions" );
+    if( psOptionsTreeSrc == NULL )
     {
         CPLError( CE_Failure, CPLE_AppDefined,
                   "Count not find required GDALWarpOptions in XML." );
         return CE_Failure;
     }
 
+    CPLXMLNode *psOptionsTree;
+    psOptionsTree = CPLCreateXMLNode( NULL, CXT_Element, "GDALWarpOptions" );
+    psOptionsTree->psChild = CPLCloneXMLTree( psOptionsTreeSrc->psChild );
+
 /* -------------------------------------------------------------------- */
 /*      Adjust the SourceDataset in the warp options to take into       */
 /*      account that it is relative to the VRT if appropriate.          */
@@ -1070,6 +1075,7 @@ CPLErr VRTWarpedDataset::XMLInit( CPLXMLNode *psTree, const char *pszVRTPath )
     GDALWarpOptions *psWO;
 
     psWO = GDALDeserializeWarpOptions( psOptionsTree );
+    CPLDestroyXMLNode( psOptionsTree );
     if( psWO == NULL )
         return CE_Failure;
 
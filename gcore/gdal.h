@@ -994,6 +994,9 @@ GIntBig CPL_DLL CPL_STDCALL GDALGetCacheUsed64(void);
 
 int CPL_DLL CPL_STDCALL GDALFlushCacheBlock(void);
 
+char CPL_DLL ** CPL_STDCALL GDALGetCacheStatistics( GDALDatasetH hDS );
+void CPL_DLL CPL_STDCALL GDALResetCacheStatistics( GDALDatasetH hDS );
+
 /* ==================================================================== */
 /*      GDAL virtual memory                                             */
 /* ==================================================================== */
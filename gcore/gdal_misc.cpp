@@ -889,7 +889,7 @@ CPLString GDALFindAssociatedFile( const char *pszBaseFilename,
     }
     else
     {
-        int iSibling = CSLFindString( papszSiblingFiles, 
+        int iSibling = GDALFindSiblingFile( papszSiblingFiles, 
                                       CPLGetFilename(osTarget) );
         if( iSibling < 0 )
             return "";
@@ -1321,7 +1321,7 @@ int GDALReadTabFile2( const char * pszBaseFilename,
 
     if (papszSiblingFiles)
     {
-        int iSibling = CSLFindString(papszSiblingFiles, CPLGetFilename(pszTAB));
+        int iSibling = GDALFindSiblingFile(papszSiblingFiles, CPLGetFilename(pszTAB));
         if (iSibling >= 0)
         {
             CPLString osTabFilename = pszBaseFilename;
@@ -1574,7 +1574,7 @@ int GDALReadWorldFile2( const char *pszBaseFilename, const char *pszExtension,
 
     if (papszSiblingFiles)
     {
-        int iSibling = CSLFindString(papszSiblingFiles, CPLGetFilename(pszTFW));
+        int iSibling = GDALFindSiblingFile(papszSiblingFiles, CPLGetFilename(pszTFW));
         if (iSibling >= 0)
         {
             CPLString osTFWFilename = pszBaseFilename;
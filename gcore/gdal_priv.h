@@ -58,6 +58,7 @@ class GDALAsyncReader;
 #include "cpl_string.h"
 #include "cpl_minixml.h"
 #include "cpl_multiproc.h"
+#include "cpl_hash_set.h"
 #include <vector>
 #include <map>
 #include "ogr_core.h"
@@ -268,6 +269,34 @@ typedef void signature_changed;
 #define OPTIONAL_OUTSIDE_GDAL(val) = val
 #endif
 
+/* ******************************************************************** */
+/*                          GDALCacheStatistics                         */
+/* ******************************************************************** */
+
+//! Block cache and I/O counters of a band, a dataset or the whole process.
+
+class CPL_DLL GDALCacheStatistics
+{
+  public:
+    GIntBig     nBlockHits;
+    GIntBig     nBlockMisses;
+    GIntBig     nBlockEvictions;
+    GIntBig     nDirtyBlockFlushes;
+    GIntBig     nReadBlockMicroSec;
+    GIntBig     nWriteBlockMicroSec;
+    GIntBig     nDecompressMicroSec;
+
+                GDALCacheStatistics() { Reset(); }
+
+    void        Reset();
+    void        Add( const GDALCacheStatistics& oOther );
+    char      **AppendToList( char **papszList ) const;
+
+    static void AddToGlobal( const GDALCacheStatistics& oStats );
+    static GDALCacheStatistics GetGlobal();
+    static void ResetGlobal();
+};
+
 //! A set of associated raster bands, usually from one file.
 
 class CPL_DLL GDALDataset : public GDALMajorObject
@@ -342,8 +371,10 @@ class CPL_DLL GDALDataset : public GDALMajorObject
     
     char            **papszOpenOptions;
 
+    GDALCacheStatistics oCacheStatistics;
+
     friend class GDALRasterBand;
-    
+
   public:
     virtual     ~GDALDataset();
 
@@ -412,6 +443,9 @@ class CPL_DLL GDALDataset : public GDALMajorObject
 
     static GDALDataset **GetOpenDatasets( int *pnDatasetCount );
 
+    GDALCacheStatistics GetCacheStatistics();
+    void          ResetCacheStatistics();
+
     CPLErr BuildOverviews( const char *, int, int *,
                            int, int *, GDALProgressFunc, void * );
 
@@ -509,6 +543,9 @@ class CPL_DLL GDALRasterBlock
     
     void        Touch_unlocked( void );
     void        Detach_unlocked( void );
+    void        WriteEvicted( void );
+
+                GDALRasterBlock( int, int );    /* lookup key in a block set */
 
   public:
                 GDALRasterBlock( GDALRasterBand *, int, int );
@@ -543,6 +580,14 @@ class CPL_DLL GDALRasterBlock
     static void Verify();
 
     static int  SafeLockBlock( GDALRasterBlock ** );
+
+    /* Block references of the bands with a very large number of blocks */
+    static CPLHashSet *CreateBlockSet();
+    static GDALRasterBlock *SafeLockBlock( CPLHashSet *, int, int, int bRemove );
+    static void AddToBlockSet( CPLHashSet *, GDALRasterBlock * );
+    static void RemoveFromBlockSet_unlocked( CPLHashSet *, int, int );
+    static GDALRasterBlock *LookupBlockSet_unlocked( CPLHashSet *, int, int );
+    static std::vector< std::pair<int,int> > GetBlockSetOffsets( CPLHashSet * );
     
     /* Should only be called by GDALDestroyDriverManager() */
     static void DestroyRBMutex();
@@ -592,6 +637,7 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
 
     friend class GDALRasterBlock;
     CPLErr         UnreferenceBlock( int nXBlockOff, int nYBlockOff );
+    GDALRasterBlock *GetCachedBlock_unlocked( int nXBlockOff, int nYBlockOff );
 
   protected:
     GDALDataset *poDS;
@@ -614,9 +660,13 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
     int         nSubBlocksPerColumn;
     GDALRasterBlock **papoBlocks;
 
+    CPLHashSet *hBlockSet;      /* used instead of papoBlocks when sparse */
+
     int         nBlockReads;
     int         bForceCachedIO;
 
+    GDALCacheStatistics oCacheStatistics;
+
     GDALRasterBand *poMask;
     bool        bOwnMask;
     int         nMaskFlags;
@@ -847,6 +897,17 @@ class GDALRescaledAlphaBand : public GDALRasterBand
 
 class CPL_DLL GDALDriver : public GDALMajorObject
 {
+    // Signatures declared with AddOpenSignature() and friends.
+    std::vector<CPLString> aosOpenSignatures;
+    std::vector<int>    anOpenSignatureOffsets;
+    char              **papszOpenExtensions;
+    char              **papszOpenPrefixes;
+
+    // Set, under the driver manager mutex, once pfnInitMetadata returned.
+    int                 bMetadataInitialized;
+
+    void                InitMetadata();
+
   public:
                         GDALDriver();
                         ~GDALDriver();
@@ -854,6 +915,10 @@ class CPL_DLL GDALDriver : public GDALMajorObject
     virtual CPLErr      SetMetadataItem( const char * pszName,
                                  const char * pszValue,
                                  const char * pszDomain = "" );
+    virtual char      **GetMetadataDomainList();
+    virtual char      **GetMetadata( const char * pszDomain = "" );
+    virtual const char *GetMetadataItem( const char * pszName,
+                                         const char * pszDomain = "" );
 
 /* -------------------------------------------------------------------- */
 /*      Public C++ methods.                                             */
@@ -915,6 +980,21 @@ class CPL_DLL GDALDriver : public GDALMajorObject
     CPLErr              (*pfnDeleteDataSource)( GDALDriver*,
                                                  const char * pszName );
 
+    /* Called on the first request for a metadata item that has not been */
+    /* set, so that costly metadata can be built on demand rather than   */
+    /* when registering the driver.  Capabilities (GDAL_DCAP_*) must be  */
+    /* set at registration: looking them up never runs it. */
+    void                (*pfnInitMetadata)( GDALDriver * );
+
+    /* Signatures of the datasets the driver handles, used by GDALOpen() */
+    /* to try it before the other drivers.  Leading bytes and prefixes   */
+    /* of the name are strong hints, extensions weak ones. */
+    void                AddOpenSignature( const void *pSignature, int nSize,
+                                          int nOffset = 0 );
+    void                AddOpenExtension( const char *pszExtension );
+    void                AddOpenPrefix( const char *pszPrefix );
+    int                 MatchOpenSignature( GDALOpenInfo *poOpenInfo );
+
 /* -------------------------------------------------------------------- */
 /*      Helper methods.                                                 */
 /* -------------------------------------------------------------------- */
@@ -969,6 +1049,9 @@ class CPL_DLL GDALDriverManager : public GDALMajorObject
 
     void        AutoLoadDrivers();
     void        AutoSkipDrivers();
+
+    void        GetDriversToProbe( GDALOpenInfo *poOpenInfo,
+                                   std::vector<GDALDriver*> &apoDrivers );
 };
 
 CPL_C_START
@@ -1148,11 +1231,20 @@ int GDALReadTabFile2( const char * pszBaseFilename,
 void CPL_DLL GDALCopyRasterIOExtraArg(GDALRasterIOExtraArg* psDestArg,
                                       GDALRasterIOExtraArg* psSrcArg);
 
+/* Shared, reference counted directory listings for sibling files */
+char CPL_DLL **GDALGetCachedSiblingFiles( const char *pszDirname );
+char CPL_DLL **GDALDuplicateSiblingFiles( char **papszSiblingFiles );
+void CPL_DLL GDALDestroySiblingFiles( char **papszSiblingFiles );
+int CPL_DLL GDALFindSiblingFile( char **papszSiblingFiles,
+                                 const char *pszFilename );
+
 CPL_C_END
 
 void GDALNullifyOpenDatasetsList();
+void GDALCleanupSiblingFilesCache();
 CPLMutex** GDALGetphDMMutex();
 CPLMutex** GDALGetphDLMutex();
+void GDALCleanupCacheStatistics();
 void GDALNullifyProxyPoolSingleton();
 GDALDriver* GDALGetAPIPROXYDriver();
 void GDALSetResponsiblePIDForCurrentThread(GIntBig responsiblePID);
@@ -192,7 +192,7 @@ char **CPL_STDCALL GDALLoadRPCFile( const char *pszFilename,
         }
         else
         {
-            int iSibling = CSLFindString( papszSiblingFiles, 
+            int iSibling = GDALFindSiblingFile( papszSiblingFiles, 
                                         CPLGetFilename(osTarget) );
             if( iSibling < 0 )
                 return NULL;
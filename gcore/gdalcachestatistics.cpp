@@ -0,0 +1,291 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Block cache and I/O statistics.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal_priv.h"
+#include "cpl_multiproc.h"
+
+CPL_CVSID("$Id$");
+
+/* Counters of the bands and datasets that have been destroyed */
+static GDALCacheStatistics oClosedStatistics;
+static CPLMutex* hStatisticsMutex = NULL;
+
+/************************************************************************/
+/*                               Reset()                                */
+/************************************************************************/
+
+void GDALCacheStatistics::Reset()
+
+{
+    nBlockHits = 0;
+    nBlockMisses = 0;
+    nBlockEvictions = 0;
+    nDirtyBlockFlushes = 0;
+    nReadBlockMicroSec = 0;
+    nWriteBlockMicroSec = 0;
+    nDecompressMicroSec = 0;
+}
+
+/************************************************************************/
+/*                                Add()                                 */
+/************************************************************************/
+
+void GDALCacheStatistics::Add( const GDALCacheStatistics& oOther )
+
+{
+    nBlockHits += oOther.nBlockHits;
+    nBlockMisses += oOther.nBlockMisses;
+    nBlockEvictions += oOther.nBlockEvictions;
+    nDirtyBlockFlushes += oOther.nDirtyBlockFlushes;
+    nReadBlockMicroSec += oOther.nReadBlockMicroSec;
+    nWriteBlockMicroSec += oOther.nWriteBlockMicroSec;
+    nDecompressMicroSec += oOther.nDecompressMicroSec;
+}
+
+/************************************************************************/
+/*                            AppendToList()                            */
+/************************************************************************/
+
+char **GDALCacheStatistics::AppendToList( char **papszList ) const
+
+{
+    papszList = CSLSetNameValue( papszList, "BLOCK_CACHE_HITS",
+                                 CPLSPrintf(CPL_FRMT_GIB, nBlockHits) );
+    papszList = CSLSetNameValue( papszList, "BLOCK_CACHE_MISSES",
+                                 CPLSPrintf(CPL_FRMT_GIB, nBlockMisses) );
+    papszList = CSLSetNameValue( papszList, "BLOCK_CACHE_EVICTIONS",
+                                 CPLSPrintf(CPL_FRMT_GIB, nBlockEvictions) );
+    papszList = CSLSetNameValue( papszList, "DIRTY_BLOCK_FLUSHES",
+                                 CPLSPrintf(CPL_FRMT_GIB, nDirtyBlockFlushes) );
+    papszList = CSLSetNameValue( papszList, "READ_BLOCK_TIME_US",
+                                 CPLSPrintf(CPL_FRMT_GIB, nReadBlockMicroSec) );
+    papszList = CSLSetNameValue( papszList, "WRITE_BLOCK_TIME_US",
+                                 CPLSPrintf(CPL_FRMT_GIB, nWriteBlockMicroSec) );
+    papszList = CSLSetNameValue( papszList, "DECOMPRESS_TIME_US",
+                                 CPLSPrintf(CPL_FRMT_GIB, nDecompressMicroSec) );
+    return papszList;
+}
+
+/************************************************************************/
+/*                            AddToGlobal()                             */
+/*                                                                      */
+/*      Called by the destructors of bands and datasets so that the     */
+/*      process wide totals survive them.                               */
+/************************************************************************/
+
+void GDALCacheStatistics::AddToGlobal( const GDALCacheStatistics& oStats )
+
+{
+    CPLMutexHolderD( &hStatisticsMutex );
+    oClosedStatistics.Add( oStats );
+}
+
+/************************************************************************/
+/*                             GetGlobal()                              */
+/************************************************************************/
+
+GDALCacheStatistics GDALCacheStatistics::GetGlobal()
+
+{
+    GDALCacheStatistics oStats;
+
+    {
+        CPLMutexHolderD( &hStatisticsMutex );
+        oStats = oClosedStatistics;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Add the counters of the datasets that are still open.  They     */
+/*      may be updated concurrently by the threads that use them, so    */
+/*      the result is only a snapshot.                                  */
+/* -------------------------------------------------------------------- */
+    CPLMutexHolderD( GDALGetphDLMutex() );
+
+    int nCount = 0;
+    GDALDataset** papoDS = GDALDataset::GetOpenDatasets( &nCount );
+    for( int i = 0; i < nCount; i++ )
+        oStats.Add( papoDS[i]->GetCacheStatistics() );
+
+    return oStats;
+}
+
+/************************************************************************/
+/*                            ResetGlobal()                             */
+/************************************************************************/
+
+void GDALCacheStatistics::ResetGlobal()
+
+{
+    {
+        CPLMutexHolderD( &hStatisticsMutex );
+        oClosedStatistics.Reset();
+    }
+
+    CPLMutexHolderD( GDALGetphDLMutex() );
+
+    int nCount = 0;
+    GDALDataset** papoDS = GDALDataset::GetOpenDatasets( &nCount );
+    for( int i = 0; i < nCount; i++ )
+        papoDS[i]->ResetCacheStatistics();
+}
+
+/************************************************************************/
+/*                       GDALGetCacheStatistics()                       */
+/************************************************************************/
+
+/**
+ * \brief Fetch block cache and I/O statistics.
+ *
+ * The returned list contains the following NAME=VALUE items :
+ * <ul>
+ * <li>BLOCK_CACHE_HITS: number of block requests served from the cache.</li>
+ * <li>BLOCK_CACHE_MISSES: number of block requests that required reading
+ *     the block.</li>
+ * <li>BLOCK_CACHE_EVICTIONS: number of blocks discarded from the cache to
+ *     make room for other blocks.</li>
+ * <li>DIRTY_BLOCK_FLUSHES: number of modified blocks written back.</li>
+ * <li>READ_BLOCK_TIME_US: time spent in IReadBlock(), in microseconds.</li>
+ * <li>WRITE_BLOCK_TIME_US: time spent in IWriteBlock(), in microseconds.</li>
+ * <li>DECOMPRESS_TIME_US: time spent decoding compressed blocks, in
+ *     microseconds, for the drivers that report it (currently GTiff).</li>
+ * </ul>
+ *
+ * When hDS is NULL, the process wide totals are returned, with in addition
+ * CACHE_USED, CACHE_MAX and the VSI_BYTES_READ[prefix] items of
+ * VSIGetIOStatistics().
+ *
+ * Those statistics can also be printed when the driver manager is destroyed
+ * by setting the GDAL_DUMP_CACHE_STATISTICS configuration option to YES
+ * (printed on the standard error) or to the name of a file to append to.
+ *
+ * @param hDS a dataset, or NULL for the process wide statistics.
+ *
+ * @return a list of strings to free with CSLDestroy().
+ *
+ * @since GDAL 2.0
+ */
+
+char ** CPL_STDCALL GDALGetCacheStatistics( GDALDatasetH hDS )
+
+{
+    if( hDS != NULL )
+        return ((GDALDataset *) hDS)->GetCacheStatistics().AppendToList( NULL );
+
+    char** papszList = GDALCacheStatistics::GetGlobal().AppendToList( NULL );
+    papszList = CSLSetNameValue( papszList, "CACHE_USED",
+                                 CPLSPrintf(CPL_FRMT_GIB, GDALGetCacheUsed64()) );
+    papszList = CSLSetNameValue( papszList, "CACHE_MAX",
+                                 CPLSPrintf(CPL_FRMT_GIB, GDALGetCacheMax64()) );
+
+    char** papszVSI = VSIGetIOStatistics();
+    for( int i = 0; papszVSI != NULL && papszVSI[i] != NULL; i++ )
+        papszList = CSLAddString( papszList, CPLSPrintf("VSI_%s", papszVSI[i]) );
+    CSLDestroy( papszVSI );
+
+    return papszList;
+}
+
+/************************************************************************/
+/*                      GDALResetCacheStatistics()                      */
+/************************************************************************/
+
+/**
+ * \brief Reset block cache and I/O statistics.
+ *
+ * @param hDS a dataset, or NULL to reset the process wide statistics,
+ * including the ones of all open datasets and of VSIGetIOStatistics().
+ *
+ * @since GDAL 2.0
+ */
+
+void CPL_STDCALL GDALResetCacheStatistics( GDALDatasetH hDS )
+
+{
+    if( hDS != NULL )
+    {
+        ((GDALDataset *) hDS)->ResetCacheStatistics();
+        return;
+    }
+
+    GDALCacheStatistics::ResetGlobal();
+    VSIResetIOStatistics();
+}
+
+/************************************************************************/
+/*                       DumpCacheStatistics()                          */
+/************************************************************************/
+
+static void DumpCacheStatistics( const char* pszDest )
+
+{
+    FILE* fp = stderr;
+    if( !EQUAL(pszDest, "YES") && !EQUAL(pszDest, "ON") &&
+        !EQUAL(pszDest, "TRUE") )
+    {
+        fp = fopen( pszDest, "at" );
+        if( fp == NULL )
+        {
+            CPLError( CE_Failure, CPLE_OpenFailed,
+                      "Cannot open %s to dump cache statistics", pszDest );
+            return;
+        }
+    }
+
+    char** papszList = GDALGetCacheStatistics( NULL );
+    fprintf( fp, "GDAL cache statistics:\n" );
+    for( int i = 0; papszList != NULL && papszList[i] != NULL; i++ )
+        fprintf( fp, "  %s\n", papszList[i] );
+    CSLDestroy( papszList );
+
+    if( fp != stderr )
+        fclose( fp );
+}
+
+/************************************************************************/
+/*                     GDALCleanupCacheStatistics()                     */
+/*                                                                      */
+/*      Called by GDALDestroyDriverManager() once the datasets are      */
+/*      closed.                                                         */
+/************************************************************************/
+
+void GDALCleanupCacheStatistics()
+
+{
+    const char* pszDest = CPLGetConfigOption( "GDAL_DUMP_CACHE_STATISTICS",
+                                              NULL );
+    if( pszDest != NULL && !EQUAL(pszDest, "NO") && !EQUAL(pszDest, "OFF") &&
+        !EQUAL(pszDest, "FALSE") )
+    {
+        DumpCacheStatistics( pszDest );
+    }
+
+    if( hStatisticsMutex != NULL )
+        CPLDestroyMutex( hStatisticsMutex );
+    hStatisticsMutex = NULL;
+}
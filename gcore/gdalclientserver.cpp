@@ -47,6 +47,10 @@
   #include <netinet/in.h>
   #include <arpa/inet.h>
   #include <netdb.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
   typedef int CPL_SOCKET;
   #define INVALID_SOCKET -1
   #define SOCKET_ERROR -1
@@ -60,6 +64,7 @@
 #include "gdal_rat.h"
 #include "cpl_spawn.h"
 #include "cpl_multiproc.h"
+#include "cpl_atomic_ops.h"
 
 /*! 
 \page gdal_api_proxy GDAL API Proxy
@@ -107,6 +112,15 @@ connections will be reused. This behaviour is controlled with the GDAL_API_PROXY
 that is set to YES by default, and will keep a maximum of 4 unused connections.
 GDAL_API_PROXY_CONN_POOL can be set to a integer value to specify the maximum number of unused connections.
 
+(GDAL >= 2.0) When the server runs on the same host, pixel data is exchanged through a shared memory
+region, and only the control messages go through the pipe or the socket. This behaviour can be disabled
+by setting the GDAL_API_PROXY_SHM config option to NO. The region is made of slots of
+GDAL_API_PROXY_SHM_SLOT_SIZE bytes (1 MB by default). Pixel buffers that do not fit into a slot are
+still transferred on the pipe. When blocks of a band are read from left to right and top to bottom,
+the following blocks of the row are requested in the same round trip. GDAL_API_PROXY_PIPELINED_BLOCKS
+(8 by default) is the maximum number of blocks requested at once, and also the number of slots
+written by each side.
+
 \section gdal_api_proxy_limitations Limitations
 
 Datasets stored in the memory virtual file system (/vsimem) or handled by the MEM driver are excluded from
@@ -122,7 +136,7 @@ from multiple threads. However, it is safe to use several client datasets from m
 /* REMINDER: upgrade this number when the on-wire protocol changes */
 /* Note: please at least keep the version exchange protocol unchanged ! */
 #define GDAL_CLIENT_SERVER_PROTOCOL_MAJOR 2
-#define GDAL_CLIENT_SERVER_PROTOCOL_MINOR 0
+#define GDAL_CLIENT_SERVER_PROTOCOL_MINOR 1
 
 #include <map>
 #include <vector>
@@ -133,6 +147,10 @@ const char* GDALClientDatasetGetFilename(const char* pszFilename);
 int CPL_DLL GDALServerLoopSocket(CPL_SOCKET nSocket);
 CPL_C_END
 
+#if defined(WIN32) || defined(_POSIX_SHARED_MEMORY_OBJECTS)
+#define HAVE_PROXY_SHM
+#endif
+
 #define BUFFER_SIZE 1024
 typedef struct
 {
@@ -142,6 +160,18 @@ typedef struct
     int             bOK;
     GByte           abyBuffer[BUFFER_SIZE];
     int             nBufferSize;
+
+    /* Shared memory region used to transfer pixel data. It is made of */
+    /* 2 rings of nShmSlots slots : the first one is written by the process */
+    /* that created the region, the second one by the other process. */
+    GByte          *pabyShm;
+    int             nShmSlots;
+    int             nShmSlotSize;
+    int             bShmCreator;
+    int             iShmNextSlot;
+#ifdef WIN32
+    HANDLE          hShmMapping;
+#endif
 } GDALPipe;
 
 typedef struct
@@ -240,6 +270,7 @@ typedef enum
     INSTR_Band_SetDefaultRAT,
     INSTR_Band_AdviseRead,
     INSTR_Band_End,
+    INSTR_SetupSharedMemory,
     INSTR_END
 } InstrEnum;
 
@@ -325,6 +356,7 @@ static const char* apszInstr[] =
     "Band_SetDefaultRAT",
     "Band_AdviseRead",
     "Band_End",
+    "SetupSharedMemory",
     "END",
 };
 #endif
@@ -338,6 +370,10 @@ static int bRecycleChild = FALSE;
 static int nMaxRecycled = 0;
 static GDALServerSpawnedProcess* aspRecycled[MAX_RECYCLED];
 
+/* Limits of the shared memory region used to transfer pixel data */
+#define MAX_SHM_SLOTS       64
+#define MAX_SHM_SLOT_SIZE   (64 * 1024 * 1024)
+
 /************************************************************************/
 /*                          EnterObject                                 */
 /************************************************************************/
@@ -534,7 +570,16 @@ class GDALClientRasterBand : public GDALPamRasterBand
     int                                              nCachedYStart;
     int                                              nCachedLines;
 
+    int                                              nPipelinedBlocks;
+    int                                              nLastBlockXOff;
+    int                                              nLastBlockYOff;
+    GByte                                           *pabyPrefetchedBlocks;
+    int                                              nPrefetchedBlockXOff;
+    int                                              nPrefetchedBlockYOff;
+    int                                              nPrefetchedBlocks;
+
     void    InvalidateCachedLines();
+    CPLErr  ReadBlockReply(void* pImage);
     CPLErr  IRasterIO_read_internal(
                                 int nXOff, int nYOff, int nXSize, int nYSize,
                                 void * pData, int nBufXSize, int nBufYSize,
@@ -648,39 +693,52 @@ class GDALClientRasterBand : public GDALPamRasterBand
 };
 
 /************************************************************************/
-/*                          GDALPipeBuild()                             */
+/*                            GDALPipeNew()                             */
 /************************************************************************/
 
-static GDALPipe* GDALPipeBuild(CPLSpawnedProcess* sp)
+static GDALPipe* GDALPipeNew()
 {
     GDALPipe* p = (GDALPipe*)CPLMalloc(sizeof(GDALPipe));
     p->bOK = TRUE;
-    p->fin = CPLSpawnAsyncGetInputFileHandle(sp);
-    p->fout = CPLSpawnAsyncGetOutputFileHandle(sp);
+    p->fin = CPL_FILE_INVALID_HANDLE;
+    p->fout = CPL_FILE_INVALID_HANDLE;
     p->nSocket = INVALID_SOCKET;
     p->nBufferSize = 0;
+    p->pabyShm = NULL;
+    p->nShmSlots = 0;
+    p->nShmSlotSize = 0;
+    p->bShmCreator = FALSE;
+    p->iShmNextSlot = 0;
+#ifdef WIN32
+    p->hShmMapping = NULL;
+#endif
+    return p;
+}
+
+/************************************************************************/
+/*                          GDALPipeBuild()                             */
+/************************************************************************/
+
+static GDALPipe* GDALPipeBuild(CPLSpawnedProcess* sp)
+{
+    GDALPipe* p = GDALPipeNew();
+    p->fin = CPLSpawnAsyncGetInputFileHandle(sp);
+    p->fout = CPLSpawnAsyncGetOutputFileHandle(sp);
     return p;
 }
 
 static GDALPipe* GDALPipeBuild(CPL_SOCKET nSocket)
 {
-    GDALPipe* p = (GDALPipe*)CPLMalloc(sizeof(GDALPipe));
-    p->bOK = TRUE;
-    p->fin = CPL_FILE_INVALID_HANDLE;
-    p->fout = CPL_FILE_INVALID_HANDLE;
+    GDALPipe* p = GDALPipeNew();
     p->nSocket = nSocket;
-    p->nBufferSize = 0;
     return p;
 }
 
 static GDALPipe* GDALPipeBuild(CPL_FILE_HANDLE fin, CPL_FILE_HANDLE fout)
 {
-    GDALPipe* p = (GDALPipe*)CPLMalloc(sizeof(GDALPipe));
-    p->bOK = TRUE;
+    GDALPipe* p = GDALPipeNew();
     p->fin = fin;
     p->fout = fout;
-    p->nSocket = INVALID_SOCKET;
-    p->nBufferSize = 0;
     return p;
 }
 
@@ -742,9 +800,12 @@ static int GDALPipeFlushBuffer(GDALPipe * p)
 /*                            GDALPipeFree()                            */
 /************************************************************************/
 
+static void GDALPipeUnmapSharedMemory(GDALPipe * p);
+
 static void GDALPipeFree(GDALPipe * p)
 {
     GDALPipeFlushBuffer(p);
+    GDALPipeUnmapSharedMemory(p);
     if( p->nSocket != INVALID_SOCKET )
     {
         closesocket(p->nSocket);
@@ -1264,6 +1325,157 @@ static int GDALPipeWrite(GDALPipe* p, int nGCPCount, const GDAL_GCP* pasGCPs)
     return TRUE;
 }
 
+/************************************************************************/
+/*                      GDALPipeAcquireShmSlot()                        */
+/************************************************************************/
+
+/* Return the next slot of the ring written by this process, or NULL if */
+/* no shared memory is used or if nSize bytes do not fit into a slot */
+static void* GDALPipeAcquireShmSlot(GDALPipe* p, int nSize)
+{
+    if( p->pabyShm == NULL || nSize > p->nShmSlotSize )
+        return NULL;
+    int iSlot = (p->bShmCreator ? 0 : p->nShmSlots) + p->iShmNextSlot;
+    p->iShmNextSlot = (p->iShmNextSlot + 1) % p->nShmSlots;
+    return p->pabyShm + (size_t)iSlot * p->nShmSlotSize;
+}
+
+/************************************************************************/
+/*                       GDALPipeGetDataBuffer()                        */
+/************************************************************************/
+
+/* Return a buffer of nSize bytes where to put pixel data that will then */
+/* be sent with GDALPipeWriteData() : a shared memory slot if possible, */
+/* otherwise *ppBuffer grown to nSize bytes */
+static void* GDALPipeGetDataBuffer(GDALPipe* p, int nSize,
+                                   void** ppBuffer, int* pnBufferSize)
+{
+    void* pSlot = GDALPipeAcquireShmSlot(p, nSize);
+    if( pSlot != NULL )
+        return pSlot;
+    if( nSize > *pnBufferSize )
+    {
+        *pnBufferSize = nSize;
+        *ppBuffer = CPLRealloc(*ppBuffer, nSize);
+    }
+    return *ppBuffer;
+}
+
+/************************************************************************/
+/*                         GDALPipeWriteData()                          */
+/************************************************************************/
+
+/* Write the size of pixel data, and when shared memory is used, the index */
+/* of the slot where the data has been put (copying it if it is not */
+/* already in a slot), or -1 followed by the data if it does not fit */
+static int GDALPipeWriteData(GDALPipe* p, int nSize, const void* pData)
+{
+    if( p->pabyShm == NULL )
+        return GDALPipeWrite(p, nSize, pData);
+
+    if( !GDALPipeWrite(p, nSize) )
+        return FALSE;
+
+    const GByte* pabyRing = p->pabyShm +
+        (size_t)(p->bShmCreator ? 0 : p->nShmSlots) * p->nShmSlotSize;
+    const GByte* pabyData = (const GByte*) pData;
+    int iSlot = -1;
+    if( pabyData >= pabyRing &&
+        pabyData < pabyRing + (size_t)p->nShmSlots * p->nShmSlotSize )
+    {
+        iSlot = (int)((pabyData - p->pabyShm) / p->nShmSlotSize);
+    }
+    else
+    {
+        GByte* pabySlot = (GByte*) GDALPipeAcquireShmSlot(p, nSize);
+        if( pabySlot != NULL )
+        {
+            memcpy(pabySlot, pData, nSize);
+            iSlot = (int)((pabySlot - p->pabyShm) / p->nShmSlotSize);
+        }
+    }
+
+    if( !GDALPipeWrite(p, iSlot) )
+        return FALSE;
+    if( iSlot >= 0 )
+        return TRUE;
+    return GDALPipeWrite_nolength(p, nSize, pData);
+}
+
+/************************************************************************/
+/*                        GDALPipeReadShmSlot()                         */
+/************************************************************************/
+
+/* When shared memory is used, read the slot index that follows the size */
+/* of pixel data and set *ppData to the slot. *ppData is set to NULL if */
+/* the data follows on the pipe */
+static int GDALPipeReadShmSlot(GDALPipe* p, int nSize, const void** ppData)
+{
+    *ppData = NULL;
+    if( p->pabyShm == NULL )
+        return TRUE;
+
+    int iSlot;
+    if( !GDALPipeRead(p, &iSlot) )
+        return FALSE;
+    if( iSlot < 0 )
+        return TRUE;
+
+    int iFirstSlot = p->bShmCreator ? p->nShmSlots : 0;
+    if( iSlot < iFirstSlot || iSlot >= iFirstSlot + p->nShmSlots ||
+        nSize < 0 || nSize > p->nShmSlotSize )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Invalid shared memory slot");
+        p->bOK = FALSE;
+        return FALSE;
+    }
+    *ppData = p->pabyShm + (size_t)iSlot * p->nShmSlotSize;
+    return TRUE;
+}
+
+/************************************************************************/
+/*                     GDALPipeReadData_nolength()                      */
+/************************************************************************/
+
+/* Read pixel data written by GDALPipeWriteData(), once its size is read */
+static int GDALPipeReadData_nolength(GDALPipe* p, int nSize, void* pData)
+{
+    const void* pShmData;
+    if( !GDALPipeReadShmSlot(p, nSize, &pShmData) )
+        return FALSE;
+    if( pShmData == NULL )
+        return GDALPipeRead_nolength(p, nSize, pData);
+    memcpy(pData, pShmData, nSize);
+    return TRUE;
+}
+
+/************************************************************************/
+/*                      GDALPipeReadDataInPlace()                       */
+/************************************************************************/
+
+/* Same as GDALPipeReadData_nolength(), except that *ppData is set to the */
+/* shared memory slot, so as to avoid a copy, or to *ppBuffer grown to */
+/* nSize bytes if the data follows on the pipe */
+static int GDALPipeReadDataInPlace(GDALPipe* p, int nSize, void** ppData,
+                                   void** ppBuffer, int* pnBufferSize)
+{
+    const void* pShmData;
+    if( !GDALPipeReadShmSlot(p, nSize, &pShmData) )
+        return FALSE;
+    if( pShmData != NULL )
+    {
+        *ppData = (void*) pShmData;
+        return TRUE;
+    }
+    if( nSize > *pnBufferSize )
+    {
+        *pnBufferSize = nSize;
+        *ppBuffer = CPLRealloc(*ppBuffer, nSize);
+    }
+    *ppData = *ppBuffer;
+    return GDALPipeRead_nolength(p, nSize, *ppBuffer);
+}
+
 /************************************************************************/
 /*                    GDALPipeWriteConfigOption()                       */
 /************************************************************************/
@@ -1337,6 +1549,174 @@ static int GDALEmitReset(GDALPipe* p)
     return bOK;
 }
 
+/************************************************************************/
+/*                      GDALPipeMapSharedMemory()                       */
+/************************************************************************/
+
+/* Create (bCreate = TRUE) or open the named shared memory region made of */
+/* 2 rings of nSlots slots of nSlotSize bytes, and attach it to the pipe */
+#ifdef HAVE_PROXY_SHM
+static int GDALPipeMapSharedMemory(GDALPipe* p, const char* pszName,
+                                   int nSlots, int nSlotSize, int bCreate)
+{
+    GUIntBig nSizeBig = (GUIntBig)2 * nSlots * nSlotSize;
+    size_t nSize = (size_t)nSizeBig;
+    if( nSize != nSizeBig )
+        return FALSE;
+
+#if defined(WIN32)
+    HANDLE hMapping;
+    if( bCreate )
+        hMapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                     (DWORD)(nSizeBig >> 32),
+                                     (DWORD)(nSizeBig & 0xFFFFFFFFU), pszName);
+    else
+        hMapping = OpenFileMapping(FILE_MAP_ALL_ACCESS, FALSE, pszName);
+    if( hMapping == NULL )
+        return FALSE;
+    void* pMap = MapViewOfFile(hMapping, FILE_MAP_ALL_ACCESS, 0, 0, nSize);
+    if( pMap == NULL )
+    {
+        CloseHandle(hMapping);
+        return FALSE;
+    }
+    p->hShmMapping = hMapping;
+#else
+    int fd = shm_open(pszName, bCreate ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR,
+                      0600);
+    if( fd < 0 )
+        return FALSE;
+    int bOK;
+    if( bCreate )
+    {
+#ifdef __linux__
+        /* Reserve the pages now, rather than getting a SIGBUS when */
+        /* touching them if the shared memory file system gets full */
+        bOK = posix_fallocate(fd, 0, nSize) == 0;
+#else
+        bOK = ftruncate(fd, nSize) == 0;
+#endif
+    }
+    else
+    {
+        struct stat sStat;
+        bOK = fstat(fd, &sStat) == 0 && (GUIntBig)sStat.st_size >= nSizeBig;
+    }
+    void* pMap = (bOK) ? mmap(NULL, nSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                              fd, 0) : MAP_FAILED;
+    close(fd);
+    if( pMap == MAP_FAILED )
+    {
+        if( bCreate )
+            shm_unlink(pszName);
+        return FALSE;
+    }
+#endif
+
+    p->pabyShm = (GByte*) pMap;
+    p->nShmSlots = nSlots;
+    p->nShmSlotSize = nSlotSize;
+    p->bShmCreator = bCreate;
+    p->iShmNextSlot = 0;
+    return TRUE;
+}
+#else
+static int GDALPipeMapSharedMemory(CPL_UNUSED GDALPipe* p,
+                                   CPL_UNUSED const char* pszName,
+                                   CPL_UNUSED int nSlots,
+                                   CPL_UNUSED int nSlotSize,
+                                   CPL_UNUSED int bCreate)
+{
+    return FALSE;
+}
+#endif
+
+/************************************************************************/
+/*                     GDALPipeUnmapSharedMemory()                      */
+/************************************************************************/
+
+static void GDALPipeUnmapSharedMemory(GDALPipe * p)
+{
+    if( p->pabyShm == NULL )
+        return;
+#if defined(WIN32)
+    UnmapViewOfFile(p->pabyShm);
+    CloseHandle(p->hShmMapping);
+    p->hShmMapping = NULL;
+#elif defined(HAVE_PROXY_SHM)
+    munmap(p->pabyShm, (size_t)2 * p->nShmSlots * p->nShmSlotSize);
+#endif
+    p->pabyShm = NULL;
+    p->nShmSlots = 0;
+    p->nShmSlotSize = 0;
+    p->iShmNextSlot = 0;
+}
+
+/************************************************************************/
+/*                     GDALEmitSetupSharedMemory()                      */
+/************************************************************************/
+
+/* Try to share with the server a memory region through which pixel data */
+/* will be exchanged, instead of being copied on the pipe or the socket. */
+/* This fails, without error, if the server runs on another host : the */
+/* data is then transferred inline. */
+static void GDALEmitSetupSharedMemory(GDALPipe* p)
+{
+    if( !CSLTestBoolean(CPLGetConfigOption("GDAL_API_PROXY_SHM", "YES")) )
+        return;
+
+    int nSlots = atoi(CPLGetConfigOption("GDAL_API_PROXY_PIPELINED_BLOCKS", "8"));
+    int nSlotSize = atoi(CPLGetConfigOption("GDAL_API_PROXY_SHM_SLOT_SIZE", "1048576"));
+    if( nSlots < 1 )
+        nSlots = 1;
+    else if( nSlots > MAX_SHM_SLOTS )
+        nSlots = MAX_SHM_SLOTS;
+    if( nSlotSize <= 0 || nSlotSize > MAX_SHM_SLOT_SIZE )
+        return;
+    /* Round up to the allocation granularity of Windows, which is also */
+    /* a multiple of the page size */
+    nSlotSize = ((nSlotSize + 65535) / 65536) * 65536;
+
+    static volatile int nCounter = 0;
+    CPLString osName;
+#ifdef WIN32
+    osName.Printf("Local\\gdal_api_proxy_%d_%d",
+                  (int)GetCurrentProcessId(), CPLAtomicInc(&nCounter));
+#else
+    osName.Printf("/gdal_api_proxy_%d_%d",
+                  (int)getpid(), CPLAtomicInc(&nCounter));
+#endif
+
+    if( !GDALPipeMapSharedMemory(p, osName, nSlots, nSlotSize, TRUE) )
+    {
+        CPLDebug("GDAL", "Cannot create shared memory region %s",
+                 osName.c_str());
+        return;
+    }
+
+    int bRet = FALSE;
+    if( GDALPipeWrite(p, INSTR_SetupSharedMemory) &&
+        GDALPipeWrite(p, osName) &&
+        GDALPipeWrite(p, nSlots) &&
+        GDALPipeWrite(p, nSlotSize) &&
+        GDALSkipUntilEndOfJunkMarker(p) &&
+        GDALPipeRead(p, &bRet) )
+    {
+        GDALConsumeErrors(p);
+    }
+
+#if !defined(WIN32) && defined(HAVE_PROXY_SHM)
+    /* The server has opened the region, or will never do it */
+    shm_unlink(osName);
+#endif
+
+    if( bRet )
+        CPLDebug("GDAL", "Pixel data exchanged through %d x %d bytes of shared memory",
+                 2 * nSlots, nSlotSize);
+    else
+        GDALPipeUnmapSharedMemory(p);
+}
+
 /************************************************************************/
 /*                       GDALEmitEXIT()                                 */
 /************************************************************************/
@@ -1463,6 +1843,11 @@ static int GDALCheckServerVersion(GDALPipe* p)
         CPLDebug("GDAL", "Note: client/server protocol versions differ by minor number.");
     }
     CPLFree(pszVersion);
+
+    /* INSTR_SetupSharedMemory appeared in protocol 2.1 */
+    if( nProtocolMinor >= 1 )
+        GDALEmitSetupSharedMemory(p);
+
     return TRUE;
 }
 
@@ -1708,6 +2093,8 @@ static GDALServerSpawnedProcess* GDALServerSpawnAsync()
         GDALServerSpawnAsyncFinish(ssp);
         return NULL;
     }
+    if( !bCheckVersions )
+        GDALEmitSetupSharedMemory(ssp->p);
     return ssp;
 }
 
@@ -1949,6 +2336,30 @@ static int GDALServerLoop(GDALPipe* p,
             GDALEmitEndOfJunkMarker(p);
             GDALPipeWrite(p, TRUE);
         }
+        else if( instr == INSTR_SetupSharedMemory )
+        {
+            char* pszName = NULL;
+            int nSlots, nSlotSize;
+            if( !GDALPipeRead(p, &pszName) ||
+                !GDALPipeRead(p, &nSlots) ||
+                !GDALPipeRead(p, &nSlotSize) )
+            {
+                CPLFree(pszName);
+                break;
+            }
+            int bRet = FALSE;
+            if( pszName != NULL &&
+                nSlots > 0 && nSlots <= MAX_SHM_SLOTS &&
+                nSlotSize > 0 && nSlotSize <= MAX_SHM_SLOT_SIZE )
+            {
+                GDALPipeUnmapSharedMemory(p);
+                bRet = GDALPipeMapSharedMemory(p, pszName, nSlots, nSlotSize,
+                                               FALSE);
+            }
+            CPLFree(pszName);
+            GDALEmitEndOfJunkMarker(p);
+            GDALPipeWrite(p, bRet);
+        }
         else if( instr == INSTR_Open )
         {
             int nAccess;
@@ -2568,15 +2979,11 @@ static int GDALServerLoop(GDALPipe* p,
             eBufType = (GDALDataType)nBufType;
             int nSize = nBufXSize * nBufYSize * nBandCount *
                 (GDALGetDataTypeSize(eBufType) / 8);
-            if( nSize > nBufferSize )
-            {
-                nBufferSize = nSize;
-                pBuffer = CPLRealloc(pBuffer, nSize);
-            }
+            void* pData = GDALPipeGetDataBuffer(p, nSize, &pBuffer, &nBufferSize);
 
             CPLErr eErr = poDS->RasterIO(GF_Read,
                                          nXOff, nYOff, nXSize, nYSize,
-                                         pBuffer, nBufXSize, nBufYSize,
+                                         pData, nBufXSize, nBufYSize,
                                          eBufType,
                                          nBandCount, panBandMap,
                                          nPixelSpace, nLineSpace, nBandSpace,
@@ -2585,7 +2992,7 @@ static int GDALServerLoop(GDALPipe* p,
             GDALEmitEndOfJunkMarker(p);
             GDALPipeWrite(p, eErr);
             if( eErr != CE_Failure )
-                GDALPipeWrite(p, nSize, pBuffer);
+                GDALPipeWriteData(p, nSize, pData);
         }
         else if( instr == INSTR_IRasterIO_Write )
         {
@@ -2625,17 +3032,13 @@ static int GDALServerLoop(GDALPipe* p,
                 break;
             if( nSize != nExpectedSize )
                 break;
-            if( nSize > nBufferSize )
-            {
-                nBufferSize = nSize;
-                pBuffer = CPLRealloc(pBuffer, nSize);
-            }
-            if( !GDALPipeRead_nolength(p, nSize, pBuffer) )
+            void* pData = NULL;
+            if( !GDALPipeReadDataInPlace(p, nSize, &pData, &pBuffer, &nBufferSize) )
                 break;
 
             CPLErr eErr = poDS->RasterIO(GF_Write,
                                          nXOff, nYOff, nXSize, nYSize,
-                                         pBuffer, nBufXSize, nBufYSize,
+                                         pData, nBufXSize, nBufYSize,
                                          eBufType,
                                          nBandCount, panBandMap,
                                          nPixelSpace, nLineSpace, nBandSpace,
@@ -2855,15 +3258,11 @@ static int GDALServerLoop(GDALPipe* p,
             poBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
             int nSize = nBlockXSize * nBlockYSize *
                 (GDALGetDataTypeSize(poBand->GetRasterDataType()) / 8);
-            if( nSize > nBufferSize )
-            {
-                nBufferSize = nSize;
-                pBuffer = CPLRealloc(pBuffer, nSize);
-            }
-            CPLErr eErr = poBand->ReadBlock(nBlockXOff, nBlockYOff, pBuffer);
+            void* pData = GDALPipeGetDataBuffer(p, nSize, &pBuffer, &nBufferSize);
+            CPLErr eErr = poBand->ReadBlock(nBlockXOff, nBlockYOff, pData);
             GDALEmitEndOfJunkMarker(p);
             GDALPipeWrite(p, eErr);
-            GDALPipeWrite(p, nSize, pBuffer);
+            GDALPipeWriteData(p, nSize, pData);
         }
         else if( instr == INSTR_Band_IWriteBlock )
         {
@@ -2878,15 +3277,11 @@ static int GDALServerLoop(GDALPipe* p,
                 (GDALGetDataTypeSize(poBand->GetRasterDataType()) / 8);
             if( nExpectedSize != nSize )
                 break;
-            if( nSize > nBufferSize )
-            {
-                nBufferSize = nSize;
-                pBuffer = CPLRealloc(pBuffer, nSize);
-            }
-            if( !GDALPipeRead_nolength(p, nSize, pBuffer) )
+            void* pData = NULL;
+            if( !GDALPipeReadDataInPlace(p, nSize, &pData, &pBuffer, &nBufferSize) )
                 break;
 
-            CPLErr eErr = poBand->WriteBlock(nBlockXOff, nBlockYOff, pBuffer);
+            CPLErr eErr = poBand->WriteBlock(nBlockXOff, nBlockYOff, pData);
             GDALEmitEndOfJunkMarker(p);
             GDALPipeWrite(p, eErr);
         }
@@ -2907,19 +3302,15 @@ static int GDALServerLoop(GDALPipe* p,
             eBufType = (GDALDataType)nBufType;
             int nSize = nBufXSize * nBufYSize *
                 (GDALGetDataTypeSize(eBufType) / 8);
-            if( nSize > nBufferSize )
-            {
-                nBufferSize = nSize;
-                pBuffer = CPLRealloc(pBuffer, nSize);
-            }
+            void* pData = GDALPipeGetDataBuffer(p, nSize, &pBuffer, &nBufferSize);
 
             CPLErr eErr = poBand->RasterIO(GF_Read,
                                            nXOff, nYOff, nXSize, nYSize,
-                                           pBuffer, nBufXSize, nBufYSize,
+                                           pData, nBufXSize, nBufYSize,
                                            eBufType, 0, 0, NULL);
             GDALEmitEndOfJunkMarker(p);
             GDALPipeWrite(p, eErr);
-            GDALPipeWrite(p, nSize, pBuffer);
+            GDALPipeWriteData(p, nSize, pData);
         }
         else if( instr == INSTR_Band_IRasterIO_Write )
         {
@@ -2943,17 +3334,13 @@ static int GDALServerLoop(GDALPipe* p,
                 break;
             if( nSize != nExpectedSize )
                 break;
-            if( nSize > nBufferSize )
-            {
-                nBufferSize = nSize;
-                pBuffer = CPLRealloc(pBuffer, nSize);
-            }
-            if( !GDALPipeRead_nolength(p, nSize, pBuffer) )
+            void* pData = NULL;
+            if( !GDALPipeReadDataInPlace(p, nSize, &pData, &pBuffer, &nBufferSize) )
                 break;
 
             CPLErr eErr = poBand->RasterIO(GF_Write,
                                            nXOff, nYOff, nXSize, nYSize,
-                                           pBuffer, nBufXSize, nBufYSize,
+                                           pData, nBufXSize, nBufYSize,
                                            eBufType, 0, 0, NULL);
             GDALEmitEndOfJunkMarker(p);
             GDALPipeWrite(p, eErr);
@@ -3537,7 +3924,7 @@ CPLErr GDALClientDataset::IRasterIO( GDALRWFlag eRWFlag,
                 return CE_Failure;
             if( bDirectCopy )
             {
-                if( !GDALPipeRead_nolength(p, nSize, pData) )
+                if( !GDALPipeReadData_nolength(p, nSize, pData) )
                     return CE_Failure;
             }
             else
@@ -3545,7 +3932,7 @@ CPLErr GDALClientDataset::IRasterIO( GDALRWFlag eRWFlag,
                 GByte* pBuf = (GByte*)VSIMalloc(nSize);
                 if( pBuf == NULL )
                     return CE_Failure;
-                if( !GDALPipeRead_nolength(p, nSize, pBuf) )
+                if( !GDALPipeReadData_nolength(p, nSize, pBuf) )
                 {
                     VSIFree(pBuf);
                     return CE_Failure;
@@ -3573,7 +3960,7 @@ CPLErr GDALClientDataset::IRasterIO( GDALRWFlag eRWFlag,
             return CE_Failure;
         if( bDirectCopy  )
         {
-            if( !GDALPipeWrite(p, nSize, pData) )
+            if( !GDALPipeWriteData(p, nSize, pData) )
                 return CE_Failure;
         }
         else
@@ -3592,7 +3979,7 @@ CPLErr GDALClientDataset::IRasterIO( GDALRWFlag eRWFlag,
                                    nBufXSize );
                 }
             }
-            if( !GDALPipeWrite(p, nSize, pBuf) )
+            if( !GDALPipeWriteData(p, nSize, pBuf) )
             {
                 VSIFree(pBuf);
                 return CE_Failure;
@@ -4094,6 +4481,21 @@ GDALClientRasterBand::GDALClientRasterBand(GDALPipe* p, int iSrvBand,
     nCachedYStart = -1;
     nCachedLines = 0;
 
+    /* Number of blocks requested in a single round trip when reading */
+    /* blocks sequentially. Their replies must fit in the shared memory */
+    /* slots written by the server */
+    nPipelinedBlocks = atoi(CPLGetConfigOption("GDAL_API_PROXY_PIPELINED_BLOCKS", "8"));
+    if( nPipelinedBlocks > MAX_SHM_SLOTS )
+        nPipelinedBlocks = MAX_SHM_SLOTS;
+    if( p->pabyShm != NULL && nPipelinedBlocks > p->nShmSlots )
+        nPipelinedBlocks = p->nShmSlots;
+    nLastBlockXOff = -1;
+    nLastBlockYOff = -1;
+    pabyPrefetchedBlocks = NULL;
+    nPrefetchedBlockXOff = -1;
+    nPrefetchedBlockYOff = -1;
+    nPrefetchedBlocks = 0;
+
 }
 
 /************************************************************************/
@@ -4108,6 +4510,7 @@ GDALClientRasterBand::~GDALClientRasterBand()
     delete poMaskBand;
     delete poRAT;
     CPLFree(pabyCachedLines);
+    CPLFree(pabyPrefetchedBlocks);
 
     std::map<int, GDALRasterBand*>::iterator oIter = aMapOvrBands.begin();
     for( ; oIter != aMapOvrBands.end(); ++oIter )
@@ -4659,22 +5062,11 @@ CPLErr GDALClientRasterBand::SetDefaultHistogram( double dfMin, double dfMax,
 }
 
 /************************************************************************/
-/*                            IReadBlock()                              */
+/*                          ReadBlockReply()                            */
 /************************************************************************/
 
-CPLErr GDALClientRasterBand::IReadBlock(int nBlockXOff, int nBlockYOff, void* pImage)
+CPLErr GDALClientRasterBand::ReadBlockReply(void* pImage)
 {
-    if( !SupportsInstr(INSTR_Band_IReadBlock) )
-        return CE_Failure;
-
-    CLIENT_ENTER();
-    if( poDS != NULL )
-        ((GDALClientDataset*)poDS)->ProcessAsyncProgress();
-
-    if( !WriteInstr(INSTR_Band_IReadBlock) ||
-        !GDALPipeWrite(p, nBlockXOff) ||
-        !GDALPipeWrite(p, nBlockYOff) )
-        return CE_Failure;
     if( !GDALSkipUntilEndOfJunkMarker(p) )
         return CE_Failure;
 
@@ -4684,13 +5076,101 @@ CPLErr GDALClientRasterBand::IReadBlock(int nBlockXOff, int nBlockYOff, void* pI
     int nSize;
     if( !GDALPipeRead(p, &nSize) ||
         nSize != nBlockXSize * nBlockYSize * (GDALGetDataTypeSize(eDataType) / 8) ||
-        !GDALPipeRead_nolength(p, nSize, pImage) )
+        !GDALPipeReadData_nolength(p, nSize, pImage) )
         return CE_Failure;
 
     GDALConsumeErrors(p);
     return eRet;
 }
 
+/************************************************************************/
+/*                            IReadBlock()                              */
+/************************************************************************/
+
+CPLErr GDALClientRasterBand::IReadBlock(int nBlockXOff, int nBlockYOff, void* pImage)
+{
+    if( !SupportsInstr(INSTR_Band_IReadBlock) )
+        return CE_Failure;
+
+    CLIENT_ENTER();
+    if( poDS != NULL )
+        ((GDALClientDataset*)poDS)->ProcessAsyncProgress();
+
+    int nBlockSize = nBlockXSize * nBlockYSize * (GDALGetDataTypeSize(eDataType) / 8);
+
+    /* Has the block been read ahead by a previous call ? */
+    if( nBlockYOff == nPrefetchedBlockYOff &&
+        nBlockXOff >= nPrefetchedBlockXOff &&
+        nBlockXOff < nPrefetchedBlockXOff + nPrefetchedBlocks )
+    {
+        memcpy(pImage,
+               pabyPrefetchedBlocks +
+                    (size_t)(nBlockXOff - nPrefetchedBlockXOff) * nBlockSize,
+               nBlockSize);
+        nLastBlockXOff = nBlockXOff;
+        nLastBlockYOff = nBlockYOff;
+        return CE_None;
+    }
+
+    /* When blocks are read from left to right and top to bottom, request */
+    /* the following blocks of the row in the same round trip */
+    int nBlocksToPrefetch = 0;
+    if( nPipelinedBlocks > 1 &&
+        ((nBlockYOff == nLastBlockYOff && nBlockXOff == nLastBlockXOff + 1) ||
+         (nBlockYOff == nLastBlockYOff + 1 && nBlockXOff == 0)) )
+    {
+        int nXBlocks = (nRasterXSize + nBlockXSize - 1) / nBlockXSize;
+        nBlocksToPrefetch = MIN(nPipelinedBlocks - 1, nXBlocks - 1 - nBlockXOff);
+        if( nBlocksToPrefetch > 0 && pabyPrefetchedBlocks == NULL )
+        {
+            pabyPrefetchedBlocks = (GByte*) VSIMalloc2(nPipelinedBlocks - 1,
+                                                       nBlockSize);
+            if( pabyPrefetchedBlocks == NULL )
+            {
+                nPipelinedBlocks = 1;
+                nBlocksToPrefetch = 0;
+            }
+        }
+    }
+    nLastBlockXOff = nBlockXOff;
+    nLastBlockYOff = nBlockYOff;
+    nPrefetchedBlocks = 0;
+
+    for( int i = 0; i <= nBlocksToPrefetch; i++ )
+    {
+        if( !WriteInstr(INSTR_Band_IReadBlock) ||
+            !GDALPipeWrite(p, nBlockXOff + i) ||
+            !GDALPipeWrite(p, nBlockYOff) )
+            return CE_Failure;
+    }
+
+    CPLErr eRet = ReadBlockReply(pImage);
+
+    /* Errors on the blocks read ahead will be reported if they are */
+    /* requested again */
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    int bPrefetchOK = TRUE;
+    for( int i = 1; i <= nBlocksToPrefetch; i++ )
+    {
+        CPLErr eErr = ReadBlockReply(pabyPrefetchedBlocks +
+                                     (size_t)(i - 1) * nBlockSize);
+        if( !p->bOK )
+        {
+            eRet = CE_Failure;
+            break;
+        }
+        if( eErr != CE_None )
+            bPrefetchOK = FALSE;
+        if( bPrefetchOK )
+            nPrefetchedBlocks = i;
+    }
+    CPLPopErrorHandler();
+
+    nPrefetchedBlockXOff = nBlockXOff + 1;
+    nPrefetchedBlockYOff = nBlockYOff;
+    return eRet;
+}
+
 /************************************************************************/
 /*                            IWriteBlock()                             */
 /************************************************************************/
@@ -4707,7 +5187,7 @@ CPLErr GDALClientRasterBand::IWriteBlock(int nBlockXOff, int nBlockYOff, void* p
     if( !WriteInstr(INSTR_Band_IWriteBlock) ||
         !GDALPipeWrite(p, nBlockXOff) ||
         !GDALPipeWrite(p, nBlockYOff) ||
-        !GDALPipeWrite(p, nSize, pImage) )
+        !GDALPipeWriteData(p, nSize, pImage) )
         return CE_Failure;
     return CPLErrOnlyRet(p);
 }
@@ -4749,7 +5229,7 @@ CPLErr GDALClientRasterBand::IRasterIO_read_internal(
     if( nPixelSpace == nDataTypeSize &&
         nLineSpace == nBufXSize * nDataTypeSize )
     {
-        if( !GDALPipeRead_nolength(p, nSize, pData) )
+        if( !GDALPipeReadData_nolength(p, nSize, pData) )
             return CE_Failure;
     }
     else
@@ -4757,7 +5237,7 @@ CPLErr GDALClientRasterBand::IRasterIO_read_internal(
         GByte* pBuf = (GByte*)VSIMalloc(nSize);
         if( pBuf == NULL )
             return CE_Failure;
-        if( !GDALPipeRead_nolength(p, nSize, pBuf) )
+        if( !GDALPipeReadData_nolength(p, nSize, pBuf) )
         {
             VSIFree(pBuf);
             return CE_Failure;
@@ -4785,6 +5265,7 @@ void GDALClientRasterBand::InvalidateCachedLines()
 {
     nSuccessiveLinesRead = 0;
     nCachedYStart = -1;
+    nPrefetchedBlocks = 0;
 }
 
 /************************************************************************/
@@ -4850,6 +5331,11 @@ CPLErr GDALClientRasterBand::IRasterIO( GDALRWFlag eRWFlag,
                     if( pabyCachedLines == NULL )
                     {
                         nCachedLines = 10 * 1024 * 1024 / (nXSize * nBufTypeSize);
+                        /* Make the lines fit into a shared memory slot */
+                        int nSlotLines = (p->pabyShm != NULL) ?
+                            p->nShmSlotSize / (nXSize * nBufTypeSize) : 0;
+                        if( nSlotLines > 1 && nSlotLines < nCachedLines )
+                            nCachedLines = nSlotLines;
                         if( nCachedLines > 1 )
                             pabyCachedLines = (GByte*) VSIMalloc(
                                 nCachedLines * nXSize * nBufTypeSize);
@@ -4919,7 +5405,7 @@ CPLErr GDALClientRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         if( nPixelSpace == nDataTypeSize &&
             nLineSpace == nBufXSize * nDataTypeSize )
         {
-            if( !GDALPipeWrite(p, nSize, pData) )
+            if( !GDALPipeWriteData(p, nSize, pData) )
                 return CE_Failure;
         }
         else
@@ -4935,7 +5421,7 @@ CPLErr GDALClientRasterBand::IRasterIO( GDALRWFlag eRWFlag,
                                eBufType, nDataTypeSize,
                                nBufXSize );
             }
-            if( !GDALPipeWrite(p, nSize, pBuf) )
+            if( !GDALPipeWriteData(p, nSize, pBuf) )
             {
                 VSIFree(pBuf);
                 return CE_Failure;
@@ -6040,7 +6526,7 @@ GDALDriver* GDALGetAPIPROXYDriver()
         CPLAssert(INSTR_END + 1 == sizeof(apszInstr) / sizeof(apszInstr[0]));
 #endif
         /* If asserted, change GDAL_CLIENT_SERVER_PROTOCOL_MAJOR / GDAL_CLIENT_SERVER_PROTOCOL_MINOR */
-        CPLAssert(INSTR_END + 1 == 80);
+        CPLAssert(INSTR_END + 1 == 81);
 
         const char* pszConnPool = CPLGetConfigOption("GDAL_API_PROXY_CONN_POOL", "YES");
         if( atoi(pszConnPool) > 0 )
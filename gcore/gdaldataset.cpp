@@ -275,6 +275,12 @@ GDALDataset::~GDALDataset()
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      Keep the dataset level counters in the process wide totals.     */
+/*      The bands do the same for theirs.                               */
+/* -------------------------------------------------------------------- */
+    GDALCacheStatistics::AddToGlobal( oCacheStatistics );
+
 /* -------------------------------------------------------------------- */
 /*      Destroy the raster bands if they exist.                         */
 /* -------------------------------------------------------------------- */
@@ -1928,6 +1934,58 @@ GDALDataset **GDALDataset::GetOpenDatasets( int *pnCount )
     }
 }
 
+/************************************************************************/
+/*                         GetCacheStatistics()                         */
+/************************************************************************/
+
+/**
+ * \brief Fetch the block cache and I/O statistics of the dataset.
+ *
+ * The returned counters are the ones of the dataset itself, such as the
+ * decompression time, summed with the ones of its raster bands.
+ *
+ * @see GDALGetCacheStatistics()
+ *
+ * @since GDAL 2.0
+ */
+
+GDALCacheStatistics GDALDataset::GetCacheStatistics()
+
+{
+    GDALCacheStatistics oStats( oCacheStatistics );
+
+    for( int i = 0; i < nBands && papoBands != NULL; i++ )
+    {
+        if( papoBands[i] != NULL )
+            oStats.Add( papoBands[i]->oCacheStatistics );
+    }
+
+    return oStats;
+}
+
+/************************************************************************/
+/*                        ResetCacheStatistics()                        */
+/************************************************************************/
+
+/**
+ * \brief Reset the block cache and I/O statistics of the dataset and of
+ * its raster bands.
+ *
+ * @since GDAL 2.0
+ */
+
+void GDALDataset::ResetCacheStatistics()
+
+{
+    oCacheStatistics.Reset();
+
+    for( int i = 0; i < nBands && papoBands != NULL; i++ )
+    {
+        if( papoBands[i] != NULL )
+            papoBands[i]->oCacheStatistics.Reset();
+    }
+}
+
 /************************************************************************/
 /*                        GDALGetOpenDatasets()                         */
 /************************************************************************/
@@ -2177,7 +2235,7 @@ char **GDALDataset::GetFileList()
 
             if (oOvManager.papszInitSiblingFiles)
             {
-                int iSibling = CSLFindString(oOvManager.papszInitSiblingFiles,
+                int iSibling = GDALFindSiblingFile(oOvManager.papszInitSiblingFiles,
                                              CPLGetFilename(osWorldFilename));
                 if (iSibling >= 0)
                 {
@@ -2501,7 +2559,13 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char* pszFilename,
                            (char**) papszSiblingFiles);
     oOpenInfo.papszOpenOptions = (char**) papszOpenOptions;
 
-    for( iDriver = -1; iDriver < poDM->GetDriverCount(); iDriver++ )
+/* -------------------------------------------------------------------- */
+/*      Probe first the drivers whose declared signature matches.       */
+/* -------------------------------------------------------------------- */
+    std::vector<GDALDriver*> apoDrivers;
+    poDM->GetDriversToProbe( &oOpenInfo, apoDrivers );
+
+    for( iDriver = -1; iDriver < (int) apoDrivers.size(); iDriver++ )
     {
         GDALDriver      *poDriver;
         GDALDataset     *poDS;
@@ -2510,7 +2574,7 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char* pszFilename,
             poDriver = GDALGetAPIPROXYDriver();
         else
         {
-            poDriver = poDM->GetDriver( iDriver );
+            poDriver = apoDrivers[iDriver];
             if (papszAllowedDrivers != NULL &&
                 CSLFindString((char**)papszAllowedDrivers, GDALGetDriverShortName(poDriver)) == -1)
                 continue;
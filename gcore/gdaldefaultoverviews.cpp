@@ -66,7 +66,7 @@ GDALDefaultOverviews::~GDALDefaultOverviews()
 
 {
     CPLFree( pszInitName );
-    CSLDestroy( papszInitSiblingFiles );
+    GDALDestroySiblingFiles( papszInitSiblingFiles );
 
     CloseDependentDatasets();
 }
@@ -149,10 +149,10 @@ void GDALDefaultOverviews::Initialize( GDALDataset *poDSIn,
         pszInitName = CPLStrdup(pszBasename);
     bInitNameIsOVR = bNameIsOVR;
 
-    CSLDestroy( papszInitSiblingFiles );
+    GDALDestroySiblingFiles( papszInitSiblingFiles );
     papszInitSiblingFiles = NULL;
     if( papszSiblingFiles != NULL )
-        papszInitSiblingFiles = CSLDuplicate(papszSiblingFiles);
+        papszInitSiblingFiles = GDALDuplicateSiblingFiles(papszSiblingFiles);
 }
 
 /************************************************************************/
@@ -226,13 +226,13 @@ void GDALDefaultOverviews::OverviewScan()
         if( papszInitSiblingFiles )
         {
             CPLString osAuxFilename = CPLResetExtension( pszInitName, "aux");
-            int iSibling = CSLFindString( papszInitSiblingFiles,
+            int iSibling = GDALFindSiblingFile( papszInitSiblingFiles,
                                         CPLGetFilename(osAuxFilename) );
             if( iSibling < 0 )
             {
                 osAuxFilename = pszInitName;
                 osAuxFilename += ".aux";
-                iSibling = CSLFindString( papszInitSiblingFiles,
+                iSibling = GDALFindSiblingFile( papszInitSiblingFiles,
                                         CPLGetFilename(osAuxFilename) );
                 if( iSibling < 0 )
                     bTryFindAssociatedAuxFile = FALSE;
@@ -56,6 +56,10 @@ GDALDriver::GDALDriver()
     pfnOpenWithDriverArg = NULL;
     pfnCreateVectorOnly = NULL;
     pfnDeleteDataSource = NULL;
+    pfnInitMetadata = NULL;
+    bMetadataInitialized = FALSE;
+    papszOpenExtensions = NULL;
+    papszOpenPrefixes = NULL;
 }
 
 /************************************************************************/
@@ -67,6 +71,190 @@ GDALDriver::~GDALDriver()
 {
     if( pfnUnloadDriver != NULL )
         pfnUnloadDriver( this );
+
+    CSLDestroy( papszOpenExtensions );
+    CSLDestroy( papszOpenPrefixes );
+}
+
+/************************************************************************/
+/*                            InitMetadata()                            */
+/*                                                                      */
+/*      Run the deferred metadata initialization of the driver once.    */
+/*      pfnInitMetadata is only set at registration, so it can be       */
+/*      tested without the mutex, but the metadata must not be read     */
+/*      while it is being built.                                        */
+/************************************************************************/
+
+void GDALDriver::InitMetadata()
+
+{
+    CPLMutexHolderD( GDALGetphDMMutex() );
+
+    if( !bMetadataInitialized )
+    {
+        pfnInitMetadata( this );
+        bMetadataInitialized = TRUE;
+    }
+}
+
+/************************************************************************/
+/*                       GetMetadataDomainList()                        */
+/************************************************************************/
+
+char **GDALDriver::GetMetadataDomainList()
+
+{
+    if( pfnInitMetadata != NULL )
+        InitMetadata();
+
+    return GDALMajorObject::GetMetadataDomainList();
+}
+
+/************************************************************************/
+/*                            GetMetadata()                             */
+/************************************************************************/
+
+char **GDALDriver::GetMetadata( const char * pszDomain )
+
+{
+    if( pfnInitMetadata != NULL )
+        InitMetadata();
+
+    return GDALMajorObject::GetMetadata( pszDomain );
+}
+
+/************************************************************************/
+/*                          GetMetadataItem()                           */
+/*                                                                      */
+/*      Items set at registration are returned without running the      */
+/*      deferred initialization, and capabilities are never looked      */
+/*      up in the deferred metadata, so that GDALOpenEx() can select    */
+/*      the drivers without running it.                                 */
+/************************************************************************/
+
+const char *GDALDriver::GetMetadataItem( const char * pszName,
+                                         const char * pszDomain )
+
+{
+    if( pfnInitMetadata == NULL )
+        return GDALMajorObject::GetMetadataItem( pszName, pszDomain );
+
+    CPLMutexHolderD( GDALGetphDMMutex() );
+
+    const char *pszValue = GDALMajorObject::GetMetadataItem( pszName,
+                                                             pszDomain );
+    if( pszValue == NULL && !bMetadataInitialized &&
+        !((pszDomain == NULL || pszDomain[0] == '\0') &&
+          EQUALN(pszName, "DCAP_", 5)) )
+    {
+        InitMetadata();
+        pszValue = GDALMajorObject::GetMetadataItem( pszName, pszDomain );
+    }
+
+    return pszValue;
+}
+
+/************************************************************************/
+/*                          AddOpenSignature()                          */
+/************************************************************************/
+
+/**
+ * \brief Declare leading bytes of the files handled by the driver.
+ *
+ * GDALOpen() tries the drivers whose signature matches the header of the
+ * file before all others, in registration order.  A driver should only
+ * declare signatures that identify its files without ambiguity.
+ *
+ * @param pSignature the bytes to match.
+ * @param nSize number of bytes to match.
+ * @param nOffset offset of the bytes in the file.
+ */
+
+void GDALDriver::AddOpenSignature( const void *pSignature, int nSize,
+                                   int nOffset )
+
+{
+    aosOpenSignatures.push_back(
+        CPLString( std::string( (const char *) pSignature, nSize ) ) );
+    anOpenSignatureOffsets.push_back( nOffset );
+}
+
+/************************************************************************/
+/*                          AddOpenExtension()                          */
+/************************************************************************/
+
+/**
+ * \brief Declare an extension of the files handled by the driver.
+ *
+ * Drivers matching the extension of a file are tried after the ones
+ * matching its signature, but before all others.
+ */
+
+void GDALDriver::AddOpenExtension( const char *pszExtension )
+
+{
+    papszOpenExtensions = CSLAddString( papszOpenExtensions, pszExtension );
+}
+
+/************************************************************************/
+/*                           AddOpenPrefix()                            */
+/************************************************************************/
+
+/**
+ * \brief Declare a prefix of the dataset names handled by the driver.
+ *
+ * For connection strings or URLs, like "PG:".  The comparison is case
+ * insensitive.  A matching prefix has the same priority as a signature.
+ */
+
+void GDALDriver::AddOpenPrefix( const char *pszPrefix )
+
+{
+    papszOpenPrefixes = CSLAddString( papszOpenPrefixes, pszPrefix );
+}
+
+/************************************************************************/
+/*                         MatchOpenSignature()                         */
+/************************************************************************/
+
+/**
+ * \brief Check a dataset against the declared signatures.
+ *
+ * @return 2 if a signature or prefix matches, 1 if only the extension
+ * matches, 0 otherwise.
+ */
+
+int GDALDriver::MatchOpenSignature( GDALOpenInfo *poOpenInfo )
+
+{
+    size_t i;
+
+    for( i = 0; i < aosOpenSignatures.size(); i++ )
+    {
+        const int nOffset = anOpenSignatureOffsets[i];
+        const int nSize = (int) aosOpenSignatures[i].size();
+        if( nOffset + nSize <= poOpenInfo->nHeaderBytes
+            && memcmp( poOpenInfo->pabyHeader + nOffset,
+                       aosOpenSignatures[i].data(), nSize ) == 0 )
+            return 2;
+    }
+
+    if( papszOpenPrefixes != NULL )
+    {
+        for( char **papszIter = papszOpenPrefixes; *papszIter; papszIter++ )
+        {
+            if( EQUALN( poOpenInfo->pszFilename, *papszIter,
+                        strlen(*papszIter) ) )
+                return 2;
+        }
+    }
+
+    if( papszOpenExtensions != NULL
+        && CSLFindString( papszOpenExtensions,
+                          CPLGetExtension( poOpenInfo->pszFilename ) ) >= 0 )
+        return 1;
+
+    return 0;
 }
 
 /************************************************************************/
@@ -1761,7 +1949,9 @@ GDALIdentifyDriver( const char * pszFilename,
     CPLErrorReset();
     CPLAssert( NULL != poDM );
 
-    int nDriverCount = poDM->GetDriverCount();
+    std::vector<GDALDriver*> apoDrivers;
+    poDM->GetDriversToProbe( &oOpenInfo, apoDrivers );
+    int nDriverCount = (int) apoDrivers.size();
 
     // First pass: only use drivers that have a pfnIdentify implementation
     for( iDriver = -1; iDriver < nDriverCount; iDriver++ )
@@ -1771,7 +1961,7 @@ GDALIdentifyDriver( const char * pszFilename,
         if( iDriver < 0 )
             poDriver = GDALGetAPIPROXYDriver();
         else
-            poDriver = poDM->GetDriver( iDriver );
+            poDriver = apoDrivers[iDriver];
 
         VALIDATE_POINTER1( poDriver, "GDALIdentifyDriver", NULL );
 
@@ -1791,7 +1981,7 @@ GDALIdentifyDriver( const char * pszFilename,
         if( iDriver < 0 )
             poDriver = GDALGetAPIPROXYDriver();
         else
-            poDriver = poDM->GetDriver( iDriver );
+            poDriver = apoDrivers[iDriver];
 
         VALIDATE_POINTER1( poDriver, "GDALIdentifyDriver", NULL );
 
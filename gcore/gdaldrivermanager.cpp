@@ -219,6 +219,17 @@ GDALDriverManager::~GDALDriverManager()
 /* -------------------------------------------------------------------- */
     PamCleanProxyDB();
 
+/* -------------------------------------------------------------------- */
+/*      Cleanup the cached directory listings.                          */
+/* -------------------------------------------------------------------- */
+    GDALCleanupSiblingFilesCache();
+
+/* -------------------------------------------------------------------- */
+/*      Report the cache statistics if requested, now that all the      */
+/*      datasets are closed.                                            */
+/* -------------------------------------------------------------------- */
+    GDALCleanupCacheStatistics();
+
 /* -------------------------------------------------------------------- */
 /*      Blow away all the finder hints paths.  We really shouldn't      */
 /*      be doing all of them, but it is currently hard to keep track    */
@@ -314,6 +325,56 @@ int GDALDriverManager::GetDriverCount()
     return( nDrivers );
 }
 
+/************************************************************************/
+/*                         GetDriversToProbe()                          */
+/************************************************************************/
+
+/**
+ * \brief Order the registered drivers for probing a dataset.
+ *
+ * Drivers whose declared signature or name prefix matches the dataset
+ * come first, then the ones whose declared extension matches, then all
+ * others, each group in registration order.  Setting the
+ * GDAL_OPEN_USE_SIGNATURES configuration option to NO keeps the
+ * registration order.
+ *
+ * @param poOpenInfo the dataset to probe.
+ * @param apoDrivers the ordered list of drivers (output).
+ */
+
+void GDALDriverManager::GetDriversToProbe( GDALOpenInfo *poOpenInfo,
+                                           std::vector<GDALDriver*> &apoDrivers )
+
+{
+    const int nCount = GetDriverCount();
+    int iDriver;
+
+    apoDrivers.resize( 0 );
+    apoDrivers.reserve( nCount );
+
+    if( !CSLTestBoolean( CPLGetConfigOption( "GDAL_OPEN_USE_SIGNATURES",
+                                             "YES" ) ) )
+    {
+        for( iDriver = 0; iDriver < nCount; iDriver++ )
+            apoDrivers.push_back( GetDriver( iDriver ) );
+        return;
+    }
+
+    std::vector<GByte> abyMatch( nCount );
+    for( iDriver = 0; iDriver < nCount; iDriver++ )
+        abyMatch[iDriver] =
+            (GByte) GetDriver( iDriver )->MatchOpenSignature( poOpenInfo );
+
+    for( int nLevel = 2; nLevel >= 0; nLevel-- )
+    {
+        for( iDriver = 0; iDriver < nCount; iDriver++ )
+        {
+            if( abyMatch[iDriver] == nLevel )
+                apoDrivers.push_back( GetDriver( iDriver ) );
+        }
+    }
+}
+
 /************************************************************************/
 /*                         GDALGetDriverCount()                         */
 /************************************************************************/
@@ -446,7 +507,9 @@ int GDALDriverManager::RegisterDriver( GDALDriver * poDriver )
         poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
     }
     
-    if( poDriver->GetMetadataItem( GDAL_DMD_OPENOPTIONLIST ) != NULL &&
+    /* Only look at the items set so far, so as not to run the deferred */
+    /* metadata initialization of the driver */
+    if( poDriver->GDALMajorObject::GetMetadataItem( GDAL_DMD_OPENOPTIONLIST ) != NULL &&
         poDriver->pfnIdentify == NULL )
     {
         CPLDebug("GDAL", "Driver %s that defines GDAL_DMD_OPENOPTIONLIST must also "
@@ -182,7 +182,7 @@ retry:
 /* -------------------------------------------------------------------- */
     if( papszSiblingsIn != NULL )
     {
-        papszSiblingFiles = CSLDuplicate( papszSiblingsIn );
+        papszSiblingFiles = GDALDuplicateSiblingFiles( papszSiblingsIn );
         bHasGotSiblingFiles = TRUE;
     }
     else if( bStatOK && !bIsDirectory )
@@ -226,7 +226,7 @@ GDALOpenInfo::~GDALOpenInfo()
 
     if( fpL != NULL )
         VSIFCloseL( fpL );
-    CSLDestroy( papszSiblingFiles );
+    GDALDestroySiblingFiles( papszSiblingFiles );
 }
 
 /************************************************************************/
@@ -240,7 +240,7 @@ char** GDALOpenInfo::GetSiblingFiles()
     bHasGotSiblingFiles = TRUE;
 
     CPLString osDir = CPLGetDirname( pszFilename );
-    papszSiblingFiles = VSIReadDir( osDir );
+    papszSiblingFiles = GDALGetCachedSiblingFiles( osDir );
 
     /* Small optimization to avoid unnecessary stat'ing from PAux or ENVI */
     /* drivers. The MBTiles driver needs no companion file. */
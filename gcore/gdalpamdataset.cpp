@@ -641,7 +641,7 @@ CPLErr GDALPamDataset::TryLoadXML(char **papszSiblingFiles)
 /* -------------------------------------------------------------------- */
     if (papszSiblingFiles != NULL && IsPamFilenameAPotentialSiblingFile())
     {
-        int iSibling = CSLFindString( papszSiblingFiles,
+        int iSibling = GDALFindSiblingFile( papszSiblingFiles,
                                       CPLGetFilename(psPam->pszPamFilename) );
         if( iSibling >= 0 )
         {
@@ -1008,7 +1008,7 @@ char **GDALPamDataset::GetFileList()
         if (!bAddPamFile)
         {
             if (oOvManager.GetSiblingFiles() != NULL && IsPamFilenameAPotentialSiblingFile())
-                bAddPamFile = CSLFindString(oOvManager.GetSiblingFiles(),
+                bAddPamFile = GDALFindSiblingFile(oOvManager.GetSiblingFiles(),
                                   CPLGetFilename(psPam->pszPamFilename)) >= 0;
             else
                 bAddPamFile = VSIStatExL( psPam->pszPamFilename, &sStatBuf,
@@ -1356,13 +1356,13 @@ CPLErr GDALPamDataset::TryLoadAux(char **papszSiblingFiles)
     if( papszSiblingFiles )
     {
         CPLString osAuxFilename = CPLResetExtension( pszPhysicalFile, "aux");
-        int iSibling = CSLFindString( papszSiblingFiles,
+        int iSibling = GDALFindSiblingFile( papszSiblingFiles,
                                       CPLGetFilename(osAuxFilename) );
         if( iSibling < 0 )
         {
             osAuxFilename = pszPhysicalFile;
             osAuxFilename += ".aux";
-            iSibling = CSLFindString( papszSiblingFiles,
+            iSibling = GDALFindSiblingFile( papszSiblingFiles,
                                       CPLGetFilename(osAuxFilename) );
             if( iSibling < 0 )
                 return CE_None;
@@ -32,11 +32,15 @@
 #include "gdal_priv.h"
 #include "gdal_rat.h"
 #include "cpl_string.h"
+#include "cpl_time.h"
 
 #define SUBBLOCK_SIZE 64
 #define TO_SUBBLOCK(x) ((x) >> 6)
 #define WITHIN_SUBBLOCK(x) ((x) & 0x3f)
 
+/* Above that number of blocks, they are referenced through a hash set */
+#define BLOCK_SET_THRESHOLD (1024 * 1024)
+
 CPL_CVSID("$Id$");
 
 /************************************************************************/
@@ -61,6 +65,7 @@ GDALRasterBand::GDALRasterBand()
 
     bSubBlockingActive = FALSE;
     papoBlocks = NULL;
+    hBlockSet = NULL;
 
     poMask = NULL;
     bOwnMask = false;
@@ -85,13 +90,17 @@ GDALRasterBand::~GDALRasterBand()
 {
     FlushCache();
 
+    GDALCacheStatistics::AddToGlobal( oCacheStatistics );
+
     CPLFree( papoBlocks );
+    if( hBlockSet != NULL )
+        CPLHashSetDestroy( hBlockSet );
 
-    if( nBlockReads > nBlocksPerRow * nBlocksPerColumn
+    if( nBlockReads > (GIntBig)nBlocksPerRow * nBlocksPerColumn
         && nBand == 1 && poDS != NULL )
     {
-        CPLDebug( "GDAL", "%d block reads on %d block band 1 of %s.",
-                  nBlockReads, nBlocksPerRow * nBlocksPerColumn, 
+        CPLDebug( "GDAL", "%d block reads on " CPL_FRMT_GIB " block band 1 of %s.",
+                  nBlockReads, (GIntBig)nBlocksPerRow * nBlocksPerColumn, 
                   poDS->GetDescription() );
     }
 
@@ -456,7 +465,11 @@ CPLErr GDALRasterBand::ReadBlock( int nXBlockOff, int nYBlockOff,
 /* -------------------------------------------------------------------- */
 /*      Invoke underlying implementation method.                        */
 /* -------------------------------------------------------------------- */
-    return( IReadBlock( nXBlockOff, nYBlockOff, pImage ) );
+    GIntBig nStart = CPLGetMicroSecTime();
+    CPLErr eErr = IReadBlock( nXBlockOff, nYBlockOff, pImage );
+    oCacheStatistics.nReadBlockMicroSec += CPLGetMicroSecTime() - nStart;
+
+    return eErr;
 }
 
 /************************************************************************/
@@ -577,7 +590,11 @@ CPLErr GDALRasterBand::WriteBlock( int nXBlockOff, int nYBlockOff,
 /* -------------------------------------------------------------------- */
 /*      Invoke underlying implementation method.                        */
 /* -------------------------------------------------------------------- */
-    return( IWriteBlock( nXBlockOff, nYBlockOff, pImage ) );
+    GIntBig nStart = CPLGetMicroSecTime();
+    CPLErr eErr = IWriteBlock( nXBlockOff, nYBlockOff, pImage );
+    oCacheStatistics.nWriteBlockMicroSec += CPLGetMicroSecTime() - nStart;
+
+    return eErr;
 }
 
 /************************************************************************/
@@ -713,7 +730,7 @@ GDALGetBlockSize( GDALRasterBandH hBand, int * pnXSize, int * pnYSize )
 int GDALRasterBand::InitBlockInfo()
 
 {
-    if( papoBlocks != NULL )
+    if( papoBlocks != NULL || hBlockSet != NULL )
         return TRUE;
 
     /* Do some validation of raster and block dimensions in case the driver */
@@ -753,6 +770,26 @@ int GDALRasterBand::InitBlockInfo()
     nBlocksPerRow = DIV_ROUND_UP(nRasterXSize, nBlockXSize);
     nBlocksPerColumn = DIV_ROUND_UP(nRasterYSize, nBlockYSize);
 
+/* -------------------------------------------------------------------- */
+/*      Only a small fraction of the blocks of a very large raster can  */
+/*      be in the cache at the same time, so rather than arrays sized   */
+/*      by the number of blocks, use a hash set of the cached ones.     */
+/* -------------------------------------------------------------------- */
+    if( (GIntBig)nBlocksPerRow * nBlocksPerColumn > BLOCK_SET_THRESHOLD )
+    {
+        bSubBlockingActive = FALSE;
+
+        hBlockSet = GDALRasterBlock::CreateBlockSet();
+        if( hBlockSet == NULL )
+        {
+            ReportError( CE_Failure, CPLE_OutOfMemory,
+                      "Out of memory in InitBlockInfo()." );
+            return FALSE;
+        }
+
+        return TRUE;
+    }
+
     if( nBlocksPerRow < SUBBLOCK_SIZE/2 )
     {
         bSubBlockingActive = FALSE;
@@ -817,6 +854,29 @@ CPLErr GDALRasterBand::AdoptBlock( int nXBlockOff, int nYBlockOff,
     
     if( !InitBlockInfo() )
         return CE_Failure;
+
+/* -------------------------------------------------------------------- */
+/*      Hashed block references.                                        */
+/* -------------------------------------------------------------------- */
+    if( hBlockSet != NULL )
+    {
+        GDALRasterBlock *poOldBlock =
+            GDALRasterBlock::SafeLockBlock( hBlockSet, nXBlockOff, nYBlockOff,
+                                            FALSE );
+        if( poOldBlock != NULL )
+        {
+            poOldBlock->DropLock();
+            if( poOldBlock == poBlock )
+                return CE_None;
+
+            FlushBlock( nXBlockOff, nYBlockOff );
+        }
+
+        GDALRasterBlock::AddToBlockSet( hBlockSet, poBlock );
+        poBlock->Touch();
+
+        return CE_None;
+    }
     
 /* -------------------------------------------------------------------- */
 /*      Simple case without subblocking.                                */
@@ -906,9 +966,27 @@ CPLErr GDALRasterBand::FlushCache()
         eFlushBlockErr = CE_None;
     }
 
-    if (papoBlocks == NULL)
+    if (papoBlocks == NULL && hBlockSet == NULL)
         return eGlobalErr;
 
+/* -------------------------------------------------------------------- */
+/*      With hashed block references, only visit the cached blocks.     */
+/* -------------------------------------------------------------------- */
+    if( hBlockSet != NULL )
+    {
+        std::vector< std::pair<int,int> > aoOffsets =
+            GDALRasterBlock::GetBlockSetOffsets( hBlockSet );
+
+        for( size_t i = 0; i < aoOffsets.size(); i++ )
+        {
+            CPLErr eErr = FlushBlock( aoOffsets[i].second, aoOffsets[i].first,
+                                      eGlobalErr == CE_None );
+            if( eErr != CE_None )
+                eGlobalErr = eErr;
+        }
+        return eGlobalErr;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Flush all blocks in memory ... this case is without subblocking.*/
 /* -------------------------------------------------------------------- */
@@ -1006,7 +1084,7 @@ CPLErr CPL_STDCALL GDALFlushRasterCache( GDALRasterBandH hBand )
 CPLErr GDALRasterBand::UnreferenceBlock( int nXBlockOff, int nYBlockOff )
 {
 
-    if( !papoBlocks )
+    if( !papoBlocks && !hBlockSet )
         return CE_None;
     
 /* -------------------------------------------------------------------- */
@@ -1032,10 +1110,19 @@ CPLErr GDALRasterBand::UnreferenceBlock( int nXBlockOff, int nYBlockOff )
         return( CE_Failure );
     }
 
+/* -------------------------------------------------------------------- */
+/*      Hashed block references.                                        */
+/* -------------------------------------------------------------------- */
+    if( hBlockSet != NULL )
+    {
+        GDALRasterBlock::RemoveFromBlockSet_unlocked( hBlockSet,
+                                                      nXBlockOff, nYBlockOff );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Simple case for single level caches.                            */
 /* -------------------------------------------------------------------- */
-    if( !bSubBlockingActive )
+    else if( !bSubBlockingActive )
     {
         int nBlockIndex = nXBlockOff + nYBlockOff * nBlocksPerRow;
 
@@ -1068,6 +1155,46 @@ CPLErr GDALRasterBand::UnreferenceBlock( int nXBlockOff, int nYBlockOff )
     return CE_None;
 }
 
+/************************************************************************/
+/*                      GetCachedBlock_unlocked()                       */
+/*                                                                      */
+/*      Return the cached block at the given offsets, or NULL, without  */
+/*      locking nor touching it.  To be called with the block cache     */
+/*      lock held, that is from GDALRasterBlock.                        */
+/************************************************************************/
+
+GDALRasterBlock *GDALRasterBand::GetCachedBlock_unlocked( int nXBlockOff,
+                                                          int nYBlockOff )
+
+{
+    if( !papoBlocks && !hBlockSet )
+        return NULL;
+
+    if( nXBlockOff < 0 || nXBlockOff >= nBlocksPerRow ||
+        nYBlockOff < 0 || nYBlockOff >= nBlocksPerColumn )
+        return NULL;
+
+    if( hBlockSet != NULL )
+        return GDALRasterBlock::LookupBlockSet_unlocked( hBlockSet,
+                                                         nXBlockOff,
+                                                         nYBlockOff );
+
+    if( !bSubBlockingActive )
+        return papoBlocks[nXBlockOff + nYBlockOff * nBlocksPerRow];
+
+    int nSubBlock = TO_SUBBLOCK(nXBlockOff)
+        + TO_SUBBLOCK(nYBlockOff) * nSubBlocksPerRow;
+
+    if( papoBlocks[nSubBlock] == NULL )
+        return NULL;
+
+    GDALRasterBlock **papoSubBlockGrid =
+        (GDALRasterBlock **) papoBlocks[nSubBlock];
+
+    return papoSubBlockGrid[WITHIN_SUBBLOCK(nXBlockOff)
+                            + WITHIN_SUBBLOCK(nYBlockOff) * SUBBLOCK_SIZE];
+}
+
 /************************************************************************/
 /*                             FlushBlock()                             */
 /*                                                                      */
@@ -1085,7 +1212,7 @@ CPLErr GDALRasterBand::FlushBlock( int nXBlockOff, int nYBlockOff,
     int             nBlockIndex;
     GDALRasterBlock *poBlock = NULL;
 
-    if( !papoBlocks )
+    if( !papoBlocks && !hBlockSet )
         return CE_None;
     
 /* -------------------------------------------------------------------- */
@@ -1111,10 +1238,20 @@ CPLErr GDALRasterBand::FlushBlock( int nXBlockOff, int nYBlockOff,
         return( CE_Failure );
     }
 
+/* -------------------------------------------------------------------- */
+/*      Hashed block references.                                        */
+/* -------------------------------------------------------------------- */
+    if( hBlockSet != NULL )
+    {
+        poBlock = GDALRasterBlock::SafeLockBlock( hBlockSet,
+                                                  nXBlockOff, nYBlockOff,
+                                                  TRUE );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Simple case for single level caches.                            */
 /* -------------------------------------------------------------------- */
-    if( !bSubBlockingActive )
+    else if( !bSubBlockingActive )
     {
         nBlockIndex = nXBlockOff + nYBlockOff * nBlocksPerRow;
 
@@ -1228,6 +1365,13 @@ GDALRasterBlock *GDALRasterBand::TryGetLockedBlockRef( int nXBlockOff,
         return( NULL );
     }
 
+/* -------------------------------------------------------------------- */
+/*      Hashed block references.                                        */
+/* -------------------------------------------------------------------- */
+    if( hBlockSet != NULL )
+        return GDALRasterBlock::SafeLockBlock( hBlockSet,
+                                               nXBlockOff, nYBlockOff, FALSE );
+
 /* -------------------------------------------------------------------- */
 /*      Simple case for single level caches.                            */
 /* -------------------------------------------------------------------- */
@@ -1308,6 +1452,8 @@ GDALRasterBlock * GDALRasterBand::GetLockedBlockRef( int nXBlockOff,
 /*      Try and fetch from cache.                                       */
 /* -------------------------------------------------------------------- */
     poBlock = TryGetLockedBlockRef( nXBlockOff, nYBlockOff );
+    if( poBlock != NULL )
+        oCacheStatistics.nBlockHits ++;
 
 /* -------------------------------------------------------------------- */
 /*      If we didn't find it in our memory cache, instantiate a         */
@@ -1361,8 +1507,17 @@ GDALRasterBlock * GDALRasterBand::GetLockedBlockRef( int nXBlockOff,
             return( NULL );
         }
 
-        if( !bJustInitialize
-         && IReadBlock(nXBlockOff,nYBlockOff,poBlock->GetDataRef()) != CE_None)
+        CPLErr eErr = CE_None;
+        if( !bJustInitialize )
+        {
+            oCacheStatistics.nBlockMisses ++;
+
+            GIntBig nStart = CPLGetMicroSecTime();
+            eErr = IReadBlock(nXBlockOff,nYBlockOff,poBlock->GetDataRef());
+            oCacheStatistics.nReadBlockMicroSec +=
+                CPLGetMicroSecTime() - nStart;
+        }
+        if( eErr != CE_None )
         {
             poBlock->DropLock();
             FlushBlock( nXBlockOff, nYBlockOff );
@@ -1375,7 +1530,7 @@ GDALRasterBlock * GDALRasterBand::GetLockedBlockRef( int nXBlockOff,
         if( !bJustInitialize )
         {
             nBlockReads++;
-            if( nBlockReads == nBlocksPerRow * nBlocksPerColumn + 1 
+            if( nBlockReads == (GIntBig)nBlocksPerRow * nBlocksPerColumn + 1 
                 && nBand == 1 && poDS != NULL )
             {
                 CPLDebug( "GDAL", "Potential thrashing on band %d of %s.",
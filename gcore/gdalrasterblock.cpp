@@ -31,6 +31,8 @@
 
 #include "gdal_priv.h"
 #include "cpl_multiproc.h"
+#include "cpl_time.h"
+#include <algorithm>
 
 CPL_CVSID("$Id$");
 
@@ -83,6 +85,20 @@ static CPLLockType GetLockType()
 
 //#define ENABLE_DEBUG
 
+/* Maximum number of dirty blocks written together when one is evicted */
+#define MAX_WRITE_BACK_GROUP    64
+
+static int GetWriteBackGroupSize()
+{
+    static int nWriteBackGroupSize = -1;
+    if( nWriteBackGroupSize < 0 )
+    {
+        int nSize = atoi(CPLGetConfigOption("GDAL_WRITE_BACK_GROUP_SIZE", "16"));
+        nWriteBackGroupSize = MAX(1, MIN(nSize, MAX_WRITE_BACK_GROUP));
+    }
+    return nWriteBackGroupSize;
+}
+
 /************************************************************************/
 /*                          GDALSetCacheMax()                           */
 /************************************************************************/
@@ -367,6 +383,7 @@ int GDALRasterBlock::FlushCacheBlock()
 
         poTarget->Detach_unlocked();
         poTarget->GetBand()->UnreferenceBlock(poTarget->GetXOff(),poTarget->GetYOff());
+        poTarget->GetBand()->oCacheStatistics.nBlockEvictions ++;
     }
 
     /* Note: flushing dirty blocks to disk is not really safe */
@@ -375,14 +392,7 @@ int GDALRasterBlock::FlushCacheBlock()
     /* So only read-only operations should be considered thread-safe with */
     /* the global cache */
     if( poTarget->GetDirty() )
-    {
-        CPLErr eErr = poTarget->Write();
-        if( eErr != CE_None )
-        {
-             /* Save the error for later reporting */
-            poTarget->GetBand()->SetFlushBlockErr(eErr);
-        }
-    }
+        poTarget->WriteEvicted();
     delete poTarget;
 
     return TRUE;
@@ -428,6 +438,31 @@ GDALRasterBlock::GDALRasterBlock( GDALRasterBand *poBandIn,
     bMustDetach = TRUE;
 }
 
+/************************************************************************/
+/*                          GDALRasterBlock()                           */
+/*                                                                      */
+/*      Block that only holds offsets, used as a key to look up the     */
+/*      blocks of a block set.  It is never put in the cache.           */
+/************************************************************************/
+
+GDALRasterBlock::GDALRasterBlock( int nXOffIn, int nYOffIn )
+
+{
+    poBand = NULL;
+
+    nXSize = nYSize = 0;
+    eType = GDT_Byte;
+    pData = NULL;
+    bDirty = FALSE;
+    nLockCount = 0;
+
+    poNext = poPrevious = NULL;
+
+    nXOff = nXOffIn;
+    nYOff = nYOffIn;
+    bMustDetach = FALSE;
+}
+
 /************************************************************************/
 /*                          ~GDALRasterBlock()                          */
 /************************************************************************/
@@ -568,11 +603,95 @@ CPLErr GDALRasterBlock::Write()
     MarkClean();
 
     if (poBand->eFlushBlockErr == CE_None)
-        return poBand->IWriteBlock( nXOff, nYOff, pData );
+    {
+        GIntBig nStart = CPLGetMicroSecTime();
+        CPLErr eErr = poBand->IWriteBlock( nXOff, nYOff, pData );
+        poBand->oCacheStatistics.nWriteBlockMicroSec +=
+            CPLGetMicroSecTime() - nStart;
+        poBand->oCacheStatistics.nDirtyBlockFlushes ++;
+        return eErr;
+    }
     else
         return poBand->eFlushBlockErr;
 }
 
+/************************************************************************/
+/*                            WriteEvicted()                            */
+/*                                                                      */
+/*      Write a dirty block that has been evicted from the cache,       */
+/*      together with the dirty blocks of its band that precede and    */
+/*      follow it on the same row of blocks, so that the driver         */
+/*      receives a run of adjacent blocks in file order rather than     */
+/*      scattered writes as blocks get old.  The neighbours stay        */
+/*      cached, but clean, so that their own eviction is cheap.         */
+/************************************************************************/
+
+void GDALRasterBlock::WriteEvicted()
+
+{
+    GDALRasterBlock *apoBefore[MAX_WRITE_BACK_GROUP];
+    GDALRasterBlock *apoAfter[MAX_WRITE_BACK_GROUP];
+    int nBefore = 0, nAfter = 0;
+    int nGroupSize = GetWriteBackGroupSize();
+
+/* -------------------------------------------------------------------- */
+/*      Lock the neighbours, so that they are not evicted by other      */
+/*      threads while we write them.  Blocks already locked may be      */
+/*      being modified, so stop at them.                                */
+/* -------------------------------------------------------------------- */
+    if( nGroupSize > 1 && poBand != NULL )
+    {
+        TAKE_LOCK;
+
+        for( int iX = nXOff - 1; iX >= 0 && nBefore + 1 < nGroupSize; iX-- )
+        {
+            GDALRasterBlock *poOther =
+                poBand->GetCachedBlock_unlocked( iX, nYOff );
+            if( poOther == NULL || !poOther->GetDirty() ||
+                poOther->GetLockCount() > 0 )
+                break;
+            poOther->AddLock();
+            apoBefore[nBefore++] = poOther;
+        }
+
+        for( int iX = nXOff + 1; nBefore + nAfter + 1 < nGroupSize; iX++ )
+        {
+            GDALRasterBlock *poOther =
+                poBand->GetCachedBlock_unlocked( iX, nYOff );
+            if( poOther == NULL || !poOther->GetDirty() ||
+                poOther->GetLockCount() > 0 )
+                break;
+            poOther->AddLock();
+            apoAfter[nAfter++] = poOther;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Write the group from left to right.                             */
+/* -------------------------------------------------------------------- */
+    GDALRasterBlock *apoGroup[2 * MAX_WRITE_BACK_GROUP];
+    int nGroup = 0;
+    int i;
+
+    for( i = nBefore - 1; i >= 0; i-- )
+        apoGroup[nGroup++] = apoBefore[i];
+    apoGroup[nGroup++] = this;
+    for( i = 0; i < nAfter; i++ )
+        apoGroup[nGroup++] = apoAfter[i];
+
+    for( i = 0; i < nGroup; i++ )
+    {
+        CPLErr eErr = apoGroup[i]->Write();
+        if( eErr != CE_None )
+        {
+             /* Save the error for later reporting */
+            poBand->SetFlushBlockErr(eErr);
+        }
+        if( apoGroup[i] != this )
+            apoGroup[i]->DropLock();
+    }
+}
+
 /************************************************************************/
 /*                               Touch()                                */
 /************************************************************************/
@@ -688,6 +807,7 @@ CPLErr GDALRasterBlock::Internalize()
 
                 poTarget->Detach_unlocked();
                 poTarget->GetBand()->UnreferenceBlock(poTarget->GetXOff(),poTarget->GetYOff());
+                poTarget->GetBand()->oCacheStatistics.nBlockEvictions ++;
 
                 apoBlocksToFree[nBlocksToFree++] = poTarget;
                 if( nBlocksToFree == 64 )
@@ -720,14 +840,7 @@ CPLErr GDALRasterBlock::Internalize()
         /* So only read-only operations should be considered thread-safe with */
         /* the global cache */
         if( poBlock->GetDirty() )
-        {
-            CPLErr eErr = poBlock->Write();
-            if( eErr != CE_None )
-            {
-                 /* Save the error for later reporting */
-                poBlock->GetBand()->SetFlushBlockErr(eErr);
-            }
-        }
+            poBlock->WriteEvicted();
 
         /* Try to recycle the data of an existing block */
         void* pDataBlock = poBlock->pData;
@@ -827,6 +940,195 @@ int GDALRasterBlock::SafeLockBlock( GDALRasterBlock ** ppBlock )
         return FALSE;
 }
 
+/************************************************************************/
+/*                         GDALBlockSetHash()                           */
+/************************************************************************/
+
+static unsigned long GDALBlockSetHash( const void* elt )
+
+{
+    GDALRasterBlock* poBlock = (GDALRasterBlock*) elt;
+    GUInt32 nHash = (GUInt32) poBlock->GetXOff() * 0x9E3779B1U
+                  + (GUInt32) poBlock->GetYOff() * 0x85EBCA77U;
+
+    return (unsigned long) (nHash ^ (nHash >> 15));
+}
+
+/************************************************************************/
+/*                         GDALBlockSetEqual()                          */
+/************************************************************************/
+
+static int GDALBlockSetEqual( const void* elt1, const void* elt2 )
+
+{
+    GDALRasterBlock* poBlock1 = (GDALRasterBlock*) elt1;
+    GDALRasterBlock* poBlock2 = (GDALRasterBlock*) elt2;
+
+    return poBlock1->GetXOff() == poBlock2->GetXOff() &&
+           poBlock1->GetYOff() == poBlock2->GetYOff();
+}
+
+/************************************************************************/
+/*                           CreateBlockSet()                           */
+/************************************************************************/
+
+/**
+ * \brief Create a set of blocks indexed by their offsets.
+ *
+ * Used by GDALRasterBand instead of a block array when the band has so
+ * many blocks that only a small fraction of them can be cached.  The set
+ * does not own its blocks.
+ *
+ * As other threads may remove blocks from the set when they evict them
+ * from the cache, the set must only be modified, or looked up, through
+ * the block set methods of GDALRasterBlock.
+ */
+
+CPLHashSet *GDALRasterBlock::CreateBlockSet()
+
+{
+    return CPLHashSetNew( GDALBlockSetHash, GDALBlockSetEqual, NULL );
+}
+
+/************************************************************************/
+/*                           SafeLockBlock()                            */
+/************************************************************************/
+
+/**
+ * \brief Safely lock the block of a block set.
+ *
+ * Same as SafeLockBlock(GDALRasterBlock**) for the bands using a block set.
+ *
+ * @param hBlockSet the block set of the band.
+ * @param nXOffIn horizontal offset of the block.
+ * @param nYOffIn vertical offset of the block.
+ * @param bRemove whether the block must also be removed from the set.
+ *
+ * @return the locked block, or NULL if it is not in the set.
+ */
+
+GDALRasterBlock *GDALRasterBlock::SafeLockBlock( CPLHashSet *hBlockSet,
+                                                 int nXOffIn, int nYOffIn,
+                                                 int bRemove )
+
+{
+    GDALRasterBlock oKey( nXOffIn, nYOffIn );
+
+    TAKE_LOCK;
+
+    GDALRasterBlock *poBlock =
+        (GDALRasterBlock *) CPLHashSetLookup( hBlockSet, &oKey );
+    if( poBlock == NULL )
+        return NULL;
+
+    poBlock->AddLock();
+    poBlock->Touch_unlocked();
+
+    if( bRemove )
+        CPLHashSetRemove( hBlockSet, &oKey );
+
+    return poBlock;
+}
+
+/************************************************************************/
+/*                           AddToBlockSet()                            */
+/************************************************************************/
+
+/**
+ * \brief Add a block to a block set, replacing any block with the same
+ * offsets.
+ */
+
+void GDALRasterBlock::AddToBlockSet( CPLHashSet *hBlockSet,
+                                     GDALRasterBlock *poBlock )
+
+{
+    TAKE_LOCK;
+
+    CPLHashSetInsert( hBlockSet, poBlock );
+}
+
+/************************************************************************/
+/*                    RemoveFromBlockSet_unlocked()                     */
+/************************************************************************/
+
+/**
+ * \brief Remove a block from a block set.
+ *
+ * To be called with the block cache lock already held, that is from
+ * GDALRasterBand::UnreferenceBlock().
+ */
+
+void GDALRasterBlock::RemoveFromBlockSet_unlocked( CPLHashSet *hBlockSet,
+                                                   int nXOffIn, int nYOffIn )
+
+{
+    GDALRasterBlock oKey( nXOffIn, nYOffIn );
+
+    CPLHashSetRemove( hBlockSet, &oKey );
+}
+
+/************************************************************************/
+/*                      LookupBlockSet_unlocked()                       */
+/************************************************************************/
+
+/**
+ * \brief Find a block of a block set, without locking it.
+ *
+ * To be called with the block cache lock already held.
+ */
+
+GDALRasterBlock *GDALRasterBlock::LookupBlockSet_unlocked( CPLHashSet *hBlockSet,
+                                                           int nXOffIn,
+                                                           int nYOffIn )
+
+{
+    GDALRasterBlock oKey( nXOffIn, nYOffIn );
+
+    return (GDALRasterBlock *) CPLHashSetLookup( hBlockSet, &oKey );
+}
+
+/************************************************************************/
+/*                         GetBlockSetOffsets()                         */
+/************************************************************************/
+
+static int GDALCollectBlockOffsets( void* elt, void* user_data )
+
+{
+    GDALRasterBlock* poBlock = (GDALRasterBlock*) elt;
+    std::vector< std::pair<int,int> >* paoOffsets =
+        (std::vector< std::pair<int,int> >*) user_data;
+
+    paoOffsets->push_back( std::pair<int,int>( poBlock->GetYOff(),
+                                               poBlock->GetXOff() ) );
+    return TRUE;
+}
+
+/**
+ * \brief Return the offsets of the blocks of a block set.
+ *
+ * @return a vector of (vertical offset, horizontal offset) pairs, sorted
+ * in raster order.
+ */
+
+std::vector< std::pair<int,int> >
+GDALRasterBlock::GetBlockSetOffsets( CPLHashSet *hBlockSet )
+
+{
+    std::vector< std::pair<int,int> > aoOffsets;
+
+    {
+        TAKE_LOCK;
+
+        aoOffsets.reserve( CPLHashSetSize( hBlockSet ) );
+        CPLHashSetForeach( hBlockSet, GDALCollectBlockOffsets, &aoOffsets );
+    }
+
+    std::sort( aoOffsets.begin(), aoOffsets.end() );
+
+    return aoOffsets;
+}
+
 /************************************************************************/
 /*                          DestroyRBMutex()                           */
 /************************************************************************/
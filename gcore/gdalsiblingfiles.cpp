@@ -0,0 +1,355 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Process wide cache of directory listings, used for the sibling
+ *           files of GDALOpenInfo and the lookups of side car files.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal_priv.h"
+#include "cpl_hash_set.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+#include <map>
+#include <ctype.h>
+#include <time.h>
+
+CPL_CVSID("$Id$");
+
+/*
+ * Opening every file of a directory used to read the directory listing
+ * once per file, and to look for side car files with linear searches
+ * in it.  Listings are now shared: a listing is read once, and kept as
+ * long as the modification time of the directory does not change.  The
+ * lists handed out are the usual NULL terminated string lists, so that
+ * drivers can keep using them as before, but they are reference counted
+ * and come with a case insensitive hash of their entries that
+ * GDALFindSiblingFile() uses.
+ */
+
+#define GDAL_DIR_LISTING_CACHE_MAX  32
+
+typedef struct
+{
+    CPLString   osDirname;
+    char      **papszFiles;
+    CPLHashSet *hSet;               // of pointers into papszFiles.
+    int         nRefCount;
+    time_t      nMTime;
+    GIntBig     nLastUse;
+    int         bCached;            // still in oMapDirListings.
+} GDALDirListing;
+
+static CPLMutex *hSiblingFilesMutex = NULL;
+static std::map<CPLString, GDALDirListing*> oMapDirListings;
+static std::map<char**, GDALDirListing*> oMapSharedLists;
+static GIntBig nDirListingUseCounter = 0;
+
+/************************************************************************/
+/*                      GDALSiblingHash() / Equal()                     */
+/*                                                                      */
+/*      Case insensitive, like CSLFindString().                         */
+/************************************************************************/
+
+static unsigned long GDALSiblingHash( const void *pElt )
+
+{
+    const char *pszName = *(const char * const *) pElt;
+    unsigned long nHash = 0;
+
+    for( ; *pszName != '\0'; pszName++ )
+        nHash = nHash * 31 + (unsigned char) toupper( *pszName );
+
+    return nHash;
+}
+
+static int GDALSiblingEqual( const void *pElt1, const void *pElt2 )
+
+{
+    return EQUAL( *(const char * const *) pElt1,
+                  *(const char * const *) pElt2 );
+}
+
+/************************************************************************/
+/*                        GDALDirListingFree()                          */
+/************************************************************************/
+
+static void GDALDirListingFree( GDALDirListing *psListing )
+
+{
+    oMapSharedLists.erase( psListing->papszFiles );
+    CPLHashSetDestroy( psListing->hSet );
+    CSLDestroy( psListing->papszFiles );
+    delete psListing;
+}
+
+/************************************************************************/
+/*                       GDALDirListingUncache()                        */
+/*                                                                      */
+/*      Remove a listing from the cache, freeing it if unreferenced.    */
+/************************************************************************/
+
+static void GDALDirListingUncache( GDALDirListing *psListing )
+
+{
+    oMapDirListings.erase( psListing->osDirname );
+    psListing->bCached = FALSE;
+    if( psListing->nRefCount == 0 )
+        GDALDirListingFree( psListing );
+}
+
+/************************************************************************/
+/*                     GDALGetCachedSiblingFiles()                      */
+/************************************************************************/
+
+/**
+ * Return the listing of a directory.
+ *
+ * The listing is shared with other callers, and must be released with
+ * GDALDestroySiblingFiles(), and never modified.  It is read again if the
+ * modification time of the directory has changed.  Virtual file systems,
+ * and all directories when the GDAL_DIR_LISTING_CACHE configuration
+ * option is set to NO, get a private VSIReadDir() listing.
+ *
+ * @param pszDirname the directory to list.
+ * @return a NULL terminated list of file names, or NULL.
+ */
+
+char **GDALGetCachedSiblingFiles( const char *pszDirname )
+
+{
+    VSIStatBufL sStat;
+
+    if( strncmp( pszDirname, "/vsi", 4 ) == 0
+        || !CSLTestBoolean( CPLGetConfigOption( "GDAL_DIR_LISTING_CACHE",
+                                                "YES" ) )
+        || VSIStatL( *pszDirname ? pszDirname : ".", &sStat ) != 0
+        || !VSI_ISDIR( sStat.st_mode ) )
+        return VSIReadDir( pszDirname );
+
+    CPLMutexHolderD( &hSiblingFilesMutex );
+
+/* -------------------------------------------------------------------- */
+/*      Reuse the cached listing if the directory did not change.       */
+/* -------------------------------------------------------------------- */
+    std::map<CPLString, GDALDirListing*>::iterator oIter =
+        oMapDirListings.find( pszDirname );
+
+    if( oIter != oMapDirListings.end() )
+    {
+        GDALDirListing *psListing = oIter->second;
+        if( psListing->nMTime == sStat.st_mtime )
+        {
+            psListing->nRefCount++;
+            psListing->nLastUse = ++nDirListingUseCounter;
+            return psListing->papszFiles;
+        }
+        GDALDirListingUncache( psListing );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Read the directory, and hash its entries.                       */
+/* -------------------------------------------------------------------- */
+    const time_t nListTime = time( NULL );
+    char **papszFiles = VSIReadDir( pszDirname );
+
+    if( papszFiles == NULL )
+        return NULL;
+
+    GDALDirListing *psListing = new GDALDirListing;
+    psListing->osDirname = pszDirname;
+    psListing->papszFiles = papszFiles;
+    psListing->hSet = CPLHashSetNew( GDALSiblingHash, GDALSiblingEqual, NULL );
+    psListing->nRefCount = 1;
+    psListing->nMTime = sStat.st_mtime;
+    psListing->nLastUse = ++nDirListingUseCounter;
+    psListing->bCached = FALSE;
+
+    for( char **papszIter = papszFiles; *papszIter != NULL; papszIter++ )
+    {
+        // Keep the first of names differing only by case.
+        if( CPLHashSetLookup( psListing->hSet, papszIter ) == NULL )
+            CPLHashSetInsert( psListing->hSet, papszIter );
+    }
+
+    oMapSharedLists[papszFiles] = psListing;
+
+/* -------------------------------------------------------------------- */
+/*      Cache it, unless the directory was modified in the same         */
+/*      second as the listing, as a later change in that second        */
+/*      would not change its modification time.                        */
+/* -------------------------------------------------------------------- */
+    if( nListTime > sStat.st_mtime )
+    {
+        if( oMapDirListings.size() >= GDAL_DIR_LISTING_CACHE_MAX )
+        {
+            GDALDirListing *psOldest = NULL;
+            for( oIter = oMapDirListings.begin();
+                 oIter != oMapDirListings.end(); ++oIter )
+            {
+                if( psOldest == NULL
+                    || oIter->second->nLastUse < psOldest->nLastUse )
+                    psOldest = oIter->second;
+            }
+            GDALDirListingUncache( psOldest );
+        }
+
+        psListing->bCached = TRUE;
+        oMapDirListings[pszDirname] = psListing;
+    }
+
+    return papszFiles;
+}
+
+/************************************************************************/
+/*                     GDALDuplicateSiblingFiles()                      */
+/************************************************************************/
+
+/**
+ * Duplicate a list of sibling files.
+ *
+ * Shared listings are only referenced again, other lists are copied with
+ * CSLDuplicate().  The result must be released with
+ * GDALDestroySiblingFiles().
+ */
+
+char **GDALDuplicateSiblingFiles( char **papszSiblingFiles )
+
+{
+    if( papszSiblingFiles == NULL )
+        return NULL;
+
+    {
+        CPLMutexHolderD( &hSiblingFilesMutex );
+
+        std::map<char**, GDALDirListing*>::iterator oIter =
+            oMapSharedLists.find( papszSiblingFiles );
+        if( oIter != oMapSharedLists.end() )
+        {
+            oIter->second->nRefCount++;
+            return papszSiblingFiles;
+        }
+    }
+
+    return CSLDuplicate( papszSiblingFiles );
+}
+
+/************************************************************************/
+/*                      GDALDestroySiblingFiles()                       */
+/************************************************************************/
+
+/**
+ * Release a list of sibling files.
+ *
+ * Counterpart of GDALGetCachedSiblingFiles() and
+ * GDALDuplicateSiblingFiles().  Lists that are not shared are destroyed
+ * with CSLDestroy().
+ */
+
+void GDALDestroySiblingFiles( char **papszSiblingFiles )
+
+{
+    if( papszSiblingFiles == NULL )
+        return;
+
+    {
+        CPLMutexHolderD( &hSiblingFilesMutex );
+
+        std::map<char**, GDALDirListing*>::iterator oIter =
+            oMapSharedLists.find( papszSiblingFiles );
+        if( oIter != oMapSharedLists.end() )
+        {
+            GDALDirListing *psListing = oIter->second;
+            if( --psListing->nRefCount == 0 && !psListing->bCached )
+                GDALDirListingFree( psListing );
+            return;
+        }
+    }
+
+    CSLDestroy( papszSiblingFiles );
+}
+
+/************************************************************************/
+/*                        GDALFindSiblingFile()                         */
+/************************************************************************/
+
+/**
+ * Find a file name in a list of sibling files.
+ *
+ * Same as CSLFindString() (case insensitive), but uses the hash of shared
+ * listings.
+ *
+ * @return the index of the file in the list, or -1.
+ */
+
+int GDALFindSiblingFile( char **papszSiblingFiles, const char *pszFilename )
+
+{
+    if( papszSiblingFiles == NULL )
+        return -1;
+
+    GDALDirListing *psListing = NULL;
+    {
+        CPLMutexHolderD( &hSiblingFilesMutex );
+
+        std::map<char**, GDALDirListing*>::iterator oIter =
+            oMapSharedLists.find( papszSiblingFiles );
+        if( oIter != oMapSharedLists.end() )
+            psListing = oIter->second;
+    }
+
+    // The caller holds a reference on the listing, and it is not modified
+    // once created, so the lookup can be done without the mutex.
+    if( psListing == NULL )
+        return CSLFindString( papszSiblingFiles, pszFilename );
+
+    char **papszFound = (char **)
+        CPLHashSetLookup( psListing->hSet, &pszFilename );
+    if( papszFound == NULL )
+        return -1;
+
+    return (int) (papszFound - papszSiblingFiles);
+}
+
+/************************************************************************/
+/*                    GDALCleanupSiblingFilesCache()                    */
+/************************************************************************/
+
+void GDALCleanupSiblingFilesCache()
+
+{
+    {
+        CPLMutexHolderD( &hSiblingFilesMutex );
+
+        while( !oMapDirListings.empty() )
+            GDALDirListingUncache( oMapDirListings.begin()->second );
+    }
+
+    if( hSiblingFilesMutex != NULL )
+    {
+        CPLDestroyMutex( hSiblingFilesMutex );
+        hSiblingFilesMutex = NULL;
+    }
+}
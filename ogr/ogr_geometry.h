@@ -376,6 +376,12 @@ class CPL_DLL OGRSimpleCurve: public OGRCurve
     OGRRawPoint *paoPoints;
     double      *padfZ;
 
+    /* 2D envelope of paoPoints, invalidated by the methods modifying it. */
+    /* Published by getEnvelope() through nCachedEnvelopeState, so that  */
+    /* it can be called concurrently on the same curve. */
+    mutable OGREnvelope sCachedEnvelope;
+    mutable volatile int nCachedEnvelopeState;
+
     void        Make3D();
     void        Make2D();
 
@@ -1288,5 +1294,7 @@ OGRPreparedGeometry* OGRCreatePreparedGeometry( const OGRGeometry* poGeom );
 void OGRDestroyPreparedGeometry( OGRPreparedGeometry* poPreparedGeom );
 int OGRPreparedGeometryIntersects( const OGRPreparedGeometry* poPreparedGeom,
                                    const OGRGeometry* poOtherGeom );
+int OGRPreparedGeometryContains( const OGRPreparedGeometry* poPreparedGeom,
+                                 const OGRGeometry* poOtherGeom );
 
 #endif /* ndef _OGR_GEOMETRY_H_INCLUDED */
@@ -81,7 +81,8 @@ void CPL_DLL OGRMakeWktCoordinate( char *, double, double, double, int );
 
 #endif
 
-void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal, char chDecimalSep, int nPrecision = 15 );
+/* A negative nPrecision writes the shortest string reading back as dfVal */
+void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal, char chDecimalSep, int nPrecision = -1 );
 
 /* -------------------------------------------------------------------- */
 /*      Date-time parsing and processing functions                      */
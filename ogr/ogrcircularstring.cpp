@@ -397,6 +397,7 @@ void OGRCircularString::segmentize( double dfMaxLength )
     if( nPointCount < (int)aoRawPoint.size() )
     {
         nPointCount = (int)aoRawPoint.size();
+        nCachedEnvelopeState = 0;
         paoPoints = (OGRRawPoint *)
                 OGRRealloc(paoPoints, sizeof(OGRRawPoint) * nPointCount);
         memcpy(paoPoints, &aoRawPoint[0], sizeof(OGRRawPoint) * nPointCount);
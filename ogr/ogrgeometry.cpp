@@ -2308,6 +2308,190 @@ void OGRGeometry::freeGEOSContext(GEOSContextHandle_t hGEOSCtxt)
 #endif
 }
 
+#ifdef HAVE_GEOS
+
+/************************************************************************/
+/*                      OGRSimpleCurveToGEOSSeq()                       */
+/************************************************************************/
+
+static GEOSCoordSequence* OGRSimpleCurveToGEOSSeq( GEOSContextHandle_t hGEOSCtxt,
+                                                   const OGRSimpleCurve* poCurve,
+                                                   int nDim )
+{
+    const int nPoints = poCurve->getNumPoints();
+    GEOSCoordSequence* hSeq = GEOSCoordSeq_create_r( hGEOSCtxt, nPoints, nDim );
+    if( hSeq == NULL )
+        return NULL;
+
+    for( int i = 0; i < nPoints; i++ )
+    {
+        if( !GEOSCoordSeq_setX_r( hGEOSCtxt, hSeq, i, poCurve->getX(i) ) ||
+            !GEOSCoordSeq_setY_r( hGEOSCtxt, hSeq, i, poCurve->getY(i) ) ||
+            (nDim == 3 &&
+             !GEOSCoordSeq_setZ_r( hGEOSCtxt, hSeq, i, poCurve->getZ(i) )) )
+        {
+            GEOSCoordSeq_destroy_r( hGEOSCtxt, hSeq );
+            return NULL;
+        }
+    }
+
+    return hSeq;
+}
+
+/************************************************************************/
+/*                        OGRIsValidGEOSRing()                          */
+/*                                                                      */
+/*      GEOS refuses to build rings of less than 4 points, or that      */
+/*      are not closed in 2D, and reports an error.  These are left     */
+/*      to the WKB path, so that the error is only reported once.       */
+/************************************************************************/
+
+static int OGRIsValidGEOSRing( const OGRLinearRing* poRing )
+{
+    const int nPoints = poRing->getNumPoints();
+    return nPoints >= 4 &&
+           poRing->getX(0) == poRing->getX(nPoints - 1) &&
+           poRing->getY(0) == poRing->getY(nPoints - 1);
+}
+
+/************************************************************************/
+/*                        OGRGeometryToGEOS()                           */
+/*                                                                      */
+/*      Build the GEOS geometry directly from the coordinate arrays,    */
+/*      without going through WKB. Returns NULL for the geometries it   */
+/*      does not handle (curves, empty geometries or parts, line        */
+/*      strings and rings GEOS would refuse), for which the caller      */
+/*      must use the WKB path.                                          */
+/************************************************************************/
+
+static GEOSGeom OGRGeometryToGEOS( GEOSContextHandle_t hGEOSCtxt,
+                                   const OGRGeometry* poGeom, int nDim )
+{
+    if( poGeom->IsEmpty() )
+        return NULL;
+
+    switch( wkbFlatten(poGeom->getGeometryType()) )
+    {
+        case wkbPoint:
+        {
+            const OGRPoint* poPoint = (const OGRPoint*) poGeom;
+            GEOSCoordSequence* hSeq = GEOSCoordSeq_create_r( hGEOSCtxt, 1, nDim );
+            if( hSeq == NULL )
+                return NULL;
+            if( !GEOSCoordSeq_setX_r( hGEOSCtxt, hSeq, 0, poPoint->getX() ) ||
+                !GEOSCoordSeq_setY_r( hGEOSCtxt, hSeq, 0, poPoint->getY() ) ||
+                (nDim == 3 &&
+                 !GEOSCoordSeq_setZ_r( hGEOSCtxt, hSeq, 0, poPoint->getZ() )) )
+            {
+                GEOSCoordSeq_destroy_r( hGEOSCtxt, hSeq );
+                return NULL;
+            }
+            return GEOSGeom_createPoint_r( hGEOSCtxt, hSeq );
+        }
+
+        case wkbLineString:
+        {
+            if( ((const OGRLineString*) poGeom)->getNumPoints() < 2 )
+                return NULL;
+            GEOSCoordSequence* hSeq = OGRSimpleCurveToGEOSSeq(
+                                hGEOSCtxt, (const OGRLineString*) poGeom, nDim );
+            if( hSeq == NULL )
+                return NULL;
+            return GEOSGeom_createLineString_r( hGEOSCtxt, hSeq );
+        }
+
+        case wkbPolygon:
+        {
+            const OGRPolygon* poPoly = (const OGRPolygon*) poGeom;
+            const int nHoles = poPoly->getNumInteriorRings();
+
+            if( !OGRIsValidGEOSRing( poPoly->getExteriorRing() ) )
+                return NULL;
+            for( int i = 0; i < nHoles; i++ )
+            {
+                if( !OGRIsValidGEOSRing( poPoly->getInteriorRing(i) ) )
+                    return NULL;
+            }
+
+            GEOSCoordSequence* hSeq = OGRSimpleCurveToGEOSSeq(
+                                hGEOSCtxt, poPoly->getExteriorRing(), nDim );
+            if( hSeq == NULL )
+                return NULL;
+            GEOSGeom hShell = GEOSGeom_createLinearRing_r( hGEOSCtxt, hSeq );
+            if( hShell == NULL )
+                return NULL;
+
+            GEOSGeom* pahHoles = NULL;
+            if( nHoles > 0 )
+            {
+                pahHoles = (GEOSGeom*) CPLMalloc( sizeof(GEOSGeom) * nHoles );
+                for( int i = 0; i < nHoles; i++ )
+                {
+                    hSeq = OGRSimpleCurveToGEOSSeq( hGEOSCtxt,
+                                            poPoly->getInteriorRing(i), nDim );
+                    pahHoles[i] = (hSeq != NULL) ?
+                        GEOSGeom_createLinearRing_r( hGEOSCtxt, hSeq ) : NULL;
+                    if( pahHoles[i] == NULL )
+                    {
+                        for( int j = 0; j < i; j++ )
+                            GEOSGeom_destroy_r( hGEOSCtxt, pahHoles[j] );
+                        GEOSGeom_destroy_r( hGEOSCtxt, hShell );
+                        CPLFree( pahHoles );
+                        return NULL;
+                    }
+                }
+            }
+
+            GEOSGeom hPoly = GEOSGeom_createPolygon_r( hGEOSCtxt, hShell,
+                                                       pahHoles, nHoles );
+            CPLFree( pahHoles );
+            return hPoly;
+        }
+
+        case wkbMultiPoint:
+        case wkbMultiLineString:
+        case wkbMultiPolygon:
+        case wkbGeometryCollection:
+        {
+            const OGRGeometryCollection* poGC = (const OGRGeometryCollection*) poGeom;
+            const int nParts = poGC->getNumGeometries();
+            int nGEOSType;
+
+            switch( wkbFlatten(poGeom->getGeometryType()) )
+            {
+                case wkbMultiPoint: nGEOSType = GEOS_MULTIPOINT; break;
+                case wkbMultiLineString: nGEOSType = GEOS_MULTILINESTRING; break;
+                case wkbMultiPolygon: nGEOSType = GEOS_MULTIPOLYGON; break;
+                default: nGEOSType = GEOS_GEOMETRYCOLLECTION; break;
+            }
+
+            GEOSGeom* pahParts = (GEOSGeom*) CPLMalloc( sizeof(GEOSGeom) * nParts );
+            for( int i = 0; i < nParts; i++ )
+            {
+                pahParts[i] = OGRGeometryToGEOS( hGEOSCtxt,
+                                                 poGC->getGeometryRef(i), nDim );
+                if( pahParts[i] == NULL )
+                {
+                    for( int j = 0; j < i; j++ )
+                        GEOSGeom_destroy_r( hGEOSCtxt, pahParts[j] );
+                    CPLFree( pahParts );
+                    return NULL;
+                }
+            }
+
+            GEOSGeom hGC = GEOSGeom_createCollection_r( hGEOSCtxt, nGEOSType,
+                                                        pahParts, nParts );
+            CPLFree( pahParts );
+            return hGC;
+        }
+
+        default:
+            return NULL;
+    }
+}
+
+#endif /* HAVE_GEOS */
+
 /************************************************************************/
 /*                            exportToGEOS()                            */
 /************************************************************************/
@@ -2339,12 +2523,22 @@ GEOSGeom OGRGeometry::exportToGEOS(GEOSContextHandle_t hGEOSCtxt) const
     unsigned char *pabyData = NULL;
 
     const OGRGeometry* poLinearGeom = (hasCurveGeometry()) ? getLinearGeometry() : this;
-    nDataSize = poLinearGeom->WkbSize();
-    pabyData = (unsigned char *) CPLMalloc(nDataSize);
-    if( poLinearGeom->exportToWkb( wkbNDR, pabyData ) == OGRERR_NONE )
-        hGeom = GEOSGeomFromWKB_buf_r( hGEOSCtxt, pabyData, nDataSize );
 
-    CPLFree( pabyData );
+/* -------------------------------------------------------------------- */
+/*      Build the coordinate sequences directly, and only go through    */
+/*      WKB for what is not handled that way.                           */
+/* -------------------------------------------------------------------- */
+    hGeom = OGRGeometryToGEOS( hGEOSCtxt, poLinearGeom,
+                               poLinearGeom->getCoordinateDimension() == 3 ? 3 : 2 );
+    if( hGeom == NULL )
+    {
+        nDataSize = poLinearGeom->WkbSize();
+        pabyData = (unsigned char *) CPLMalloc(nDataSize);
+        if( poLinearGeom->exportToWkb( wkbNDR, pabyData ) == OGRERR_NONE )
+            hGeom = GEOSGeomFromWKB_buf_r( hGEOSCtxt, pabyData, nDataSize );
+
+        CPLFree( pabyData );
+    }
 
     if( poLinearGeom != this )
         delete poLinearGeom;
@@ -4525,6 +4719,7 @@ struct _OGRPreparedGeometry
     GEOSContextHandle_t           hGEOSCtxt;
     GEOSGeom                      hGEOSGeom;
     const GEOSPreparedGeometry*   poPreparedGEOSGeom;
+    OGREnvelope                   sEnvelope;
 };
 #endif
 
@@ -4567,6 +4762,7 @@ OGRPreparedGeometry* OGRCreatePreparedGeometry( const OGRGeometry* poGeom )
     poPreparedGeom->hGEOSCtxt = hGEOSCtxt;
     poPreparedGeom->hGEOSGeom = hGEOSGeom;
     poPreparedGeom->poPreparedGEOSGeom = poPreparedGEOSGeom;
+    poGeom->getEnvelope( &poPreparedGeom->sEnvelope );
 
     return poPreparedGeom;
 #else
@@ -4602,6 +4798,15 @@ int OGRPreparedGeometryIntersects( const OGRPreparedGeometry* poPreparedGeom,
     if( poPreparedGeom == NULL || poOtherGeom == NULL )
         return FALSE;
 
+/* -------------------------------------------------------------------- */
+/*      Avoid the conversion of the other geometry to GEOS when the     */
+/*      envelopes are disjoint.                                         */
+/* -------------------------------------------------------------------- */
+    OGREnvelope sOtherEnvelope;
+    poOtherGeom->getEnvelope( &sOtherEnvelope );
+    if( !poPreparedGeom->sEnvelope.Intersects( sOtherEnvelope ) )
+        return FALSE;
+
     GEOSGeom hGEOSOtherGeom = poOtherGeom->exportToGEOS(poPreparedGeom->hGEOSCtxt);
     if( hGEOSOtherGeom == NULL )
         return FALSE;
@@ -4617,6 +4822,42 @@ int OGRPreparedGeometryIntersects( const OGRPreparedGeometry* poPreparedGeom,
 #endif
 }
 
+/************************************************************************/
+/*                       OGRPreparedGeometryContains()                  */
+/************************************************************************/
+
+/* Returns TRUE if the prepared geometry contains the other geometry, that */
+/* is to say if the intersection of both is the other geometry itself. */
+
+int OGRPreparedGeometryContains( const OGRPreparedGeometry* poPreparedGeom,
+                                 const OGRGeometry* poOtherGeom )
+{
+#ifdef HAVE_GEOS_PREPARED_GEOMETRY
+    if( poPreparedGeom == NULL || poOtherGeom == NULL )
+        return FALSE;
+
+    OGREnvelope sOtherEnvelope;
+    poOtherGeom->getEnvelope( &sOtherEnvelope );
+    if( !poPreparedGeom->sEnvelope.Contains( sOtherEnvelope ) )
+        return FALSE;
+
+    GEOSGeom hGEOSOtherGeom = poOtherGeom->exportToGEOS(poPreparedGeom->hGEOSCtxt);
+    if( hGEOSOtherGeom == NULL )
+        return FALSE;
+
+    int bRet = GEOSPreparedContains_r(poPreparedGeom->hGEOSCtxt,
+                                      poPreparedGeom->poPreparedGEOSGeom,
+                                      hGEOSOtherGeom);
+    GEOSGeom_destroy_r( poPreparedGeom->hGEOSCtxt, hGEOSOtherGeom );
+
+    return bRet == 1;
+#else
+    (void) poPreparedGeom;
+    (void) poOtherGeom;
+    return FALSE;
+#endif
+}
+
 /************************************************************************/
 /*                       OGRGeometryFromEWKB()                          */
 /************************************************************************/
@@ -33,6 +33,7 @@
 #include "ogr_api.h"
 #include "ogr_p.h"
 #include "ogr_geos.h"
+#include "cpl_quad_tree.h"
 
 CPL_CVSID("$Id$");
 
@@ -1121,6 +1122,18 @@ OGRGeometryH OGR_G_ForceToMultiLineString( OGRGeometryH hGeom )
 /*                          organizePolygons()                          */
 /************************************************************************/
 
+/* Edges of a ring bucketed by their Y range, so that point in ring tests */
+/* only have to look at the edges of the bucket of the point */
+typedef struct
+{
+    const OGRLinearRing* poRing;
+    int                  nBuckets;
+    double               dfMinY;
+    double               dfBucketHeight;
+    int*                 panBucketStart; /* nBuckets + 1 entries */
+    int*                 panEdges;       /* index of the end point of edges */
+} OGRRingEdgeIndex;
+
 typedef struct _sPolyExtended sPolyExtended;
 
 struct _sPolyExtended
@@ -1134,6 +1147,8 @@ struct _sPolyExtended
     OGRPolygon*     poEnclosingPolygon;
     double          dfArea;
     int             bIsCW;
+    int             nPointTests;
+    OGRRingEdgeIndex* psEdgeIndex;
 };
 
 static int OGRGeometryFactoryCompareArea(const void* p1, const void* p2)
@@ -1162,6 +1177,214 @@ static int OGRGeometryFactoryCompareByIndex(const void* p1, const void* p2)
 
 #define N_CRITICAL_PART_NUMBER   100
 
+/* Number of parts from which candidate enclosing rings are looked up */
+/* through a quad tree */
+#define N_QUADTREE_PART_NUMBER   16
+
+/* Minimum number of points of a ring to index its edges, and maximum */
+/* average number of buckets an edge may span */
+#define N_EDGE_INDEX_MIN_POINTS  128
+#define N_EDGE_INDEX_MAX_SPAN    16
+
+/************************************************************************/
+/*                      OGRRingEdgeIndexGetBucket()                     */
+/************************************************************************/
+
+static int OGRRingEdgeIndexGetBucket( const OGRRingEdgeIndex* psIndex,
+                                      double dfY )
+{
+    /* Must be monotonic in dfY so that a point whose Y is in the range */
+    /* of an edge falls in one of the buckets of the edge */
+    const double dfBucket = (dfY - psIndex->dfMinY) / psIndex->dfBucketHeight;
+    if( !(dfBucket > 0) )
+        return 0;
+    if( dfBucket >= psIndex->nBuckets - 1 )
+        return psIndex->nBuckets - 1;
+    return (int) dfBucket;
+}
+
+/************************************************************************/
+/*                       OGRRingEdgeIndexCreate()                       */
+/*                                                                      */
+/*      Returns NULL if the edges would span too many buckets.          */
+/************************************************************************/
+
+static OGRRingEdgeIndex* OGRRingEdgeIndexCreate( const OGRLinearRing* poRing )
+{
+    const int nPoints = poRing->getNumPoints();
+    const int nEdges = nPoints - 1;
+
+    OGREnvelope sEnvelope;
+    poRing->getEnvelope( &sEnvelope );
+
+    OGRRingEdgeIndex* psIndex = (OGRRingEdgeIndex*)
+        CPLCalloc( 1, sizeof(OGRRingEdgeIndex) );
+    psIndex->poRing = poRing;
+    psIndex->nBuckets = MAX(1, nEdges / 8);
+    psIndex->dfMinY = sEnvelope.MinY;
+    psIndex->dfBucketHeight = (sEnvelope.MaxY - sEnvelope.MinY) / psIndex->nBuckets;
+    if( !(psIndex->dfBucketHeight > 0) )
+    {
+        psIndex->nBuckets = 1;
+        psIndex->dfBucketHeight = 1.0;
+    }
+    psIndex->panBucketStart = (int*)
+        CPLCalloc( psIndex->nBuckets + 1, sizeof(int) );
+
+/* -------------------------------------------------------------------- */
+/*      Count the edges of each bucket.                                 */
+/* -------------------------------------------------------------------- */
+    GIntBig nTotal = 0;
+    int i, iBucket;
+    for( i = 1; i < nPoints; i++ )
+    {
+        const double dfY1 = poRing->getY(i - 1);
+        const double dfY2 = poRing->getY(i);
+        const int iFirst = OGRRingEdgeIndexGetBucket( psIndex, MIN(dfY1, dfY2) );
+        const int iLast = OGRRingEdgeIndexGetBucket( psIndex, MAX(dfY1, dfY2) );
+        for( iBucket = iFirst; iBucket <= iLast; iBucket++ )
+            psIndex->panBucketStart[iBucket + 1] ++;
+        nTotal += iLast - iFirst + 1;
+    }
+
+    if( nTotal > (GIntBig) nEdges * N_EDGE_INDEX_MAX_SPAN )
+    {
+        CPLFree( psIndex->panBucketStart );
+        CPLFree( psIndex );
+        return NULL;
+    }
+
+    for( iBucket = 0; iBucket < psIndex->nBuckets; iBucket++ )
+        psIndex->panBucketStart[iBucket + 1] += psIndex->panBucketStart[iBucket];
+
+/* -------------------------------------------------------------------- */
+/*      Fill the buckets.                                               */
+/* -------------------------------------------------------------------- */
+    psIndex->panEdges = (int*) CPLMalloc( sizeof(int) * (size_t) MAX(1, nTotal) );
+    int* panFill = (int*) CPLMalloc( sizeof(int) * psIndex->nBuckets );
+    memcpy( panFill, psIndex->panBucketStart, sizeof(int) * psIndex->nBuckets );
+    for( i = 1; i < nPoints; i++ )
+    {
+        const double dfY1 = poRing->getY(i - 1);
+        const double dfY2 = poRing->getY(i);
+        const int iFirst = OGRRingEdgeIndexGetBucket( psIndex, MIN(dfY1, dfY2) );
+        const int iLast = OGRRingEdgeIndexGetBucket( psIndex, MAX(dfY1, dfY2) );
+        for( iBucket = iFirst; iBucket <= iLast; iBucket++ )
+            psIndex->panEdges[panFill[iBucket] ++] = i;
+    }
+    CPLFree( panFill );
+
+    return psIndex;
+}
+
+/************************************************************************/
+/*                      OGRRingEdgeIndexDestroy()                       */
+/************************************************************************/
+
+static void OGRRingEdgeIndexDestroy( OGRRingEdgeIndex* psIndex )
+{
+    if( psIndex != NULL )
+    {
+        CPLFree( psIndex->panBucketStart );
+        CPLFree( psIndex->panEdges );
+        CPLFree( psIndex );
+    }
+}
+
+#define POINT_OUTSIDE_RING      0
+#define POINT_INSIDE_RING       1
+#define POINT_ON_RING_BOUNDARY  2
+
+/************************************************************************/
+/*                       OGRRingEdgeIndexLocate()                       */
+/*                                                                      */
+/*      Same boundary and crossing number tests as                      */
+/*      OGRLinearRing::isPointOnRingBoundary() and isPointInRing(),     */
+/*      restricted to the edges of the bucket of the point.             */
+/************************************************************************/
+
+static int OGRRingEdgeIndexLocate( const OGRRingEdgeIndex* psIndex,
+                                   double dfTestX, double dfTestY )
+{
+    const OGRLinearRing* poRing = psIndex->poRing;
+    const int iBucket = OGRRingEdgeIndexGetBucket( psIndex, dfTestY );
+    int iNumCrossings = 0;
+
+    for( int i = psIndex->panBucketStart[iBucket];
+         i < psIndex->panBucketStart[iBucket + 1]; i++ )
+    {
+        const int iPoint = psIndex->panEdges[i];
+        const double x1 = poRing->getX(iPoint) - dfTestX;
+        const double y1 = poRing->getY(iPoint) - dfTestY;
+        const double x2 = poRing->getX(iPoint - 1) - dfTestX;
+        const double y2 = poRing->getY(iPoint - 1) - dfTestY;
+
+        /* Point on the segment (and not only on its supporting line) */
+        if( x1 * y2 - x2 * y1 == 0 &&
+            MIN(x1, x2) <= 0 && MAX(x1, x2) >= 0 &&
+            MIN(y1, y2) <= 0 && MAX(y1, y2) >= 0 &&
+            !(x1 == x2 && y1 == y2) )
+        {
+            return POINT_ON_RING_BOUNDARY;
+        }
+
+        if( ( ( y1 > 0 ) && ( y2 <= 0 ) ) || ( ( y2 > 0 ) && ( y1 <= 0 ) ) )
+        {
+            const double dfIntersection = ( x1 * y2 - x2 * y1 ) / (y2 - y1);
+            if ( 0.0 < dfIntersection )
+                iNumCrossings++;
+        }
+    }
+
+    return ( iNumCrossings % 2 ) == 1 ? POINT_INSIDE_RING : POINT_OUTSIDE_RING;
+}
+
+/************************************************************************/
+/*                       OGRLocatePointInPolyEx()                       */
+/*                                                                      */
+/*      Locate a point relatively to the exterior ring of a polygon.    */
+/*      The edges of big rings are indexed when they are tested more    */
+/*      than once.                                                      */
+/************************************************************************/
+
+static int OGRLocatePointInPolyEx( sPolyExtended* psPoly,
+                                   double dfX, double dfY )
+{
+    if( psPoly->psEdgeIndex == NULL &&
+        psPoly->nPointTests ++ == 1 &&
+        psPoly->poExteriorRing->getNumPoints() >= N_EDGE_INDEX_MIN_POINTS )
+    {
+        psPoly->psEdgeIndex = OGRRingEdgeIndexCreate( psPoly->poExteriorRing );
+    }
+
+    if( psPoly->psEdgeIndex != NULL )
+        return OGRRingEdgeIndexLocate( psPoly->psEdgeIndex, dfX, dfY );
+
+    OGRPoint oPoint( dfX, dfY );
+    if( psPoly->poExteriorRing->isPointOnRingBoundary( &oPoint, FALSE ) )
+        return POINT_ON_RING_BOUNDARY;
+    /* Note that isPointInRing only test strict inclusion in the ring */
+    if( psPoly->poExteriorRing->isPointInRing( &oPoint, FALSE ) )
+        return POINT_INSIDE_RING;
+    return POINT_OUTSIDE_RING;
+}
+
+/************************************************************************/
+/*                  OGRGeometryFactoryCompareIntDesc()                  */
+/************************************************************************/
+
+static int OGRGeometryFactoryCompareIntDesc(const void* p1, const void* p2)
+{
+    const int n1 = *(const int*) p1;
+    const int n2 = *(const int*) p2;
+    if (n1 > n2)
+        return -1;
+    else if (n1 < n2)
+        return 1;
+    else
+        return 0;
+}
+
 typedef enum
 {
    METHOD_NORMAL,
@@ -1307,6 +1530,8 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
     {
         asPolyEx[i].nInitialIndex = i;
         asPolyEx[i].poPolygon = (OGRPolygon*)papoPolygons[i];
+        asPolyEx[i].nPointTests = 0;
+        asPolyEx[i].psEdgeIndex = NULL;
         papoPolygons[i]->getEnvelope(&asPolyEx[i].sEnvelope);
 
         if( wkbFlatten(papoPolygons[i]->getGeometryType()) == wkbPolygon
@@ -1451,7 +1676,11 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
        4) For each non toplevel polygon (= inner ring), add it to its outer ring
        5) Add the toplevel polygons to the multipolygon
 
-       Complexity : O(nPolygonCount^2)
+       Complexity : O(nPolygonCount^2) in the worst case. When there are
+       many polygons, the candidates of step 2 are only the polygons whose
+       envelope intersects the one of the tested polygon (found through a
+       quad tree), and the edges of the big rings are bucketed by Y so
+       that a point in ring test does not need to go through all of them.
     */
 
     /* Compute how each polygon relate to the other ones
@@ -1487,6 +1716,48 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
 
     int nCountTopLevel = 1;
 
+/* -------------------------------------------------------------------- */
+/*      Index the envelopes when there are many polygons, so that only  */
+/*      the polygons whose envelope intersects the one of a polygon     */
+/*      are considered as candidates to enclose it.                     */
+/* -------------------------------------------------------------------- */
+    CPLQuadTree* hQuadTree = NULL;
+    int* panCandidates = NULL;
+
+    if( !bMixedUpGeometries )
+    {
+        panCandidates = (int*) CPLMalloc( sizeof(int) * nPolygonCount );
+
+        if( nPolygonCount >= N_QUADTREE_PART_NUMBER )
+        {
+            CPLRectObj sGlobalBounds;
+            sGlobalBounds.minx = asPolyEx[0].sEnvelope.MinX;
+            sGlobalBounds.miny = asPolyEx[0].sEnvelope.MinY;
+            sGlobalBounds.maxx = asPolyEx[0].sEnvelope.MaxX;
+            sGlobalBounds.maxy = asPolyEx[0].sEnvelope.MaxY;
+            for(i=1; i<nPolygonCount; i++)
+            {
+                sGlobalBounds.minx = MIN(sGlobalBounds.minx, asPolyEx[i].sEnvelope.MinX);
+                sGlobalBounds.miny = MIN(sGlobalBounds.miny, asPolyEx[i].sEnvelope.MinY);
+                sGlobalBounds.maxx = MAX(sGlobalBounds.maxx, asPolyEx[i].sEnvelope.MaxX);
+                sGlobalBounds.maxy = MAX(sGlobalBounds.maxy, asPolyEx[i].sEnvelope.MaxY);
+            }
+
+            hQuadTree = CPLQuadTreeCreate( &sGlobalBounds, NULL );
+            CPLQuadTreeSetMaxDepth( hQuadTree,
+                            CPLQuadTreeGetAdvisedMaxDepth(nPolygonCount) );
+            for(i=0; i<nPolygonCount; i++)
+            {
+                CPLRectObj sBounds;
+                sBounds.minx = asPolyEx[i].sEnvelope.MinX;
+                sBounds.miny = asPolyEx[i].sEnvelope.MinY;
+                sBounds.maxx = asPolyEx[i].sEnvelope.MaxX;
+                sBounds.maxy = asPolyEx[i].sEnvelope.MaxY;
+                CPLQuadTreeInsertWithBounds( hQuadTree, asPolyEx + i, &sBounds );
+            }
+        }
+    }
+
     /* STEP 2 */
     for(i=1; !bMixedUpGeometries && go_on && i<nPolygonCount; i++)
     {
@@ -1498,9 +1769,40 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
             continue;
         }
 
-        for(j=i-1; go_on && j>=0;j--)
+        /* Candidates are the bigger polygons, from the smallest one */
+        int nCandidates = 0;
+        if( hQuadTree != NULL )
+        {
+            CPLRectObj sAoi;
+            sAoi.minx = asPolyEx[i].sEnvelope.MinX;
+            sAoi.miny = asPolyEx[i].sEnvelope.MinY;
+            sAoi.maxx = asPolyEx[i].sEnvelope.MaxX;
+            sAoi.maxy = asPolyEx[i].sEnvelope.MaxY;
+
+            int nFeatureCount = 0;
+            void** pahFeatures = CPLQuadTreeSearch( hQuadTree, &sAoi, &nFeatureCount );
+            for(int k=0; k<nFeatureCount; k++)
+            {
+                j = (int) ((sPolyExtended*) pahFeatures[k] - asPolyEx);
+                if( j < i )
+                    panCandidates[nCandidates++] = j;
+            }
+            CPLFree( pahFeatures );
+            qsort( panCandidates, nCandidates, sizeof(int),
+                   OGRGeometryFactoryCompareIntDesc );
+        }
+        else
+        {
+            for(j=i-1; j>=0; j--)
+                panCandidates[nCandidates++] = j;
+        }
+
+        int b_i_enclosed = FALSE;
+
+        for(int iCandidate=0; go_on && iCandidate<nCandidates; iCandidate++)
         {
             int b_i_inside_j = FALSE;
+            j = panCandidates[iCandidate];
 
             if (method == METHOD_ONLY_CCW && asPolyEx[j].bIsCW == FALSE)
             {
@@ -1513,6 +1815,8 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
             {
                 if (bUseFastVersion)
                 {
+                    int nLocation;
+
                     if( method == METHOD_ONLY_CCW && j == 0 )
                     {
                         /* We are testing if a CCW ring is in the biggest CW ring */
@@ -1520,19 +1824,22 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
                         /* the winding order rules is broken */
                         b_i_inside_j = TRUE;
                     }
-                    else if (asPolyEx[j].poExteriorRing->isPointOnRingBoundary(&asPolyEx[i].poAPoint, FALSE))
+                    else if ((nLocation = OGRLocatePointInPolyEx(&asPolyEx[j],
+                                    asPolyEx[i].poAPoint.getX(),
+                                    asPolyEx[i].poAPoint.getY())) == POINT_ON_RING_BOUNDARY)
                     {
                         /* If the point of i is on the boundary of j, we will iterate over the other points of i */
                         int k, nPoints = asPolyEx[i].poExteriorRing->getNumPoints();
                         for(k=1;k<nPoints;k++)
                         {
-                            OGRPoint point;
-                            asPolyEx[i].poExteriorRing->getPoint(k, &point);
-                            if (asPolyEx[j].poExteriorRing->isPointOnRingBoundary(&point, FALSE))
+                            nLocation = OGRLocatePointInPolyEx(&asPolyEx[j],
+                                            asPolyEx[i].poExteriorRing->getX(k),
+                                            asPolyEx[i].poExteriorRing->getY(k));
+                            if (nLocation == POINT_ON_RING_BOUNDARY)
                             {
                                 /* If it is on the boundary of j, iterate again */ 
                             }
-                            else if (asPolyEx[j].poExteriorRing->isPointInRing(&point, FALSE))
+                            else if (nLocation == POINT_INSIDE_RING)
                             {
                                 /* If then point is strictly included in j, then i is considered inside j */
                                 b_i_inside_j = TRUE;
@@ -1551,16 +1858,16 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
                             /* test it against j */
                             for(k=0;k<nPoints-1;k++)
                             {
-                                OGRPoint point1, point2, pointMiddle;
-                                asPolyEx[i].poExteriorRing->getPoint(k, &point1);
-                                asPolyEx[i].poExteriorRing->getPoint(k+1, &point2);
-                                pointMiddle.setX((point1.getX() + point2.getX()) / 2);
-                                pointMiddle.setY((point1.getY() + point2.getY()) / 2);
-                                if (asPolyEx[j].poExteriorRing->isPointOnRingBoundary(&pointMiddle, FALSE))
+                                nLocation = OGRLocatePointInPolyEx(&asPolyEx[j],
+                                    (asPolyEx[i].poExteriorRing->getX(k) +
+                                     asPolyEx[i].poExteriorRing->getX(k+1)) / 2,
+                                    (asPolyEx[i].poExteriorRing->getY(k) +
+                                     asPolyEx[i].poExteriorRing->getY(k+1)) / 2);
+                                if (nLocation == POINT_ON_RING_BOUNDARY)
                                 {
                                     /* If it is on the boundary of j, iterate again */ 
                                 }
-                                else if (asPolyEx[j].poExteriorRing->isPointInRing(&pointMiddle, FALSE))
+                                else if (nLocation == POINT_INSIDE_RING)
                                 {
                                     /* If then point is strictly included in j, then i is considered inside j */
                                     b_i_inside_j = TRUE;
@@ -1574,8 +1881,7 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
                             }
                         }
                     }
-                    /* Note that isPointInRing only test strict inclusion in the ring */
-                    else if (asPolyEx[j].poExteriorRing->isPointInRing(&asPolyEx[i].poAPoint, FALSE))
+                    else if (nLocation == POINT_INSIDE_RING)
                     {
                         b_i_inside_j = TRUE;
                     }
@@ -1589,6 +1895,7 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
 
             if (b_i_inside_j)
             {
+                b_i_enclosed = TRUE;
                 if (asPolyEx[j].bIsTopLevel)
                 {
                     /* We are a lake */
@@ -1635,7 +1942,7 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
             }
         }
 
-        if (j < 0)
+        if (!b_i_enclosed)
         {
             /* We come here because we are not included in anything */
             /* We are toplevel */
@@ -1645,6 +1952,15 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
         }
     }
 
+    if( hQuadTree != NULL )
+        CPLQuadTreeDestroy( hQuadTree );
+    CPLFree( panCandidates );
+    for(i=0; i<nPolygonCount; i++)
+    {
+        OGRRingEdgeIndexDestroy( asPolyEx[i].psEdgeIndex );
+        asPolyEx[i].psEdgeIndex = NULL;
+    }
+
     if (pbIsValidGeometry)
         *pbIsValidGeometry = go_on && !bMixedUpGeometries;
 
@@ -1755,6 +2071,146 @@ OGRGeometry *OGRGeometryFactory::createFromGML( const char *pszData )
     return (OGRGeometry *) hGeom;
 }
 
+#if defined(HAVE_GEOS) && (GEOS_VERSION_MAJOR > 3 || (GEOS_VERSION_MAJOR == 3 && GEOS_VERSION_MINOR >= 3))
+#define HAVE_GEOS_DIRECT_IMPORT
+
+/************************************************************************/
+/*                      GEOSSeqToOGRSimpleCurve()                       */
+/************************************************************************/
+
+static int GEOSSeqToOGRSimpleCurve( GEOSContextHandle_t hGEOSCtxt,
+                                    const GEOSCoordSequence* hSeq,
+                                    OGRSimpleCurve* poCurve, int nDim )
+{
+    unsigned int nPoints = 0;
+    if( hSeq == NULL || !GEOSCoordSeq_getSize_r( hGEOSCtxt, hSeq, &nPoints ) )
+        return FALSE;
+
+    poCurve->setNumPoints( (int) nPoints, FALSE );
+    for( unsigned int i = 0; i < nPoints; i++ )
+    {
+        double dfX = 0.0, dfY = 0.0, dfZ = 0.0;
+        if( !GEOSCoordSeq_getX_r( hGEOSCtxt, hSeq, i, &dfX ) ||
+            !GEOSCoordSeq_getY_r( hGEOSCtxt, hSeq, i, &dfY ) ||
+            (nDim == 3 && !GEOSCoordSeq_getZ_r( hGEOSCtxt, hSeq, i, &dfZ )) )
+            return FALSE;
+        if( nDim == 3 )
+            poCurve->setPoint( (int) i, dfX, dfY, dfZ );
+        else
+            poCurve->setPoint( (int) i, dfX, dfY );
+    }
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                          GEOSToOGRGeometry()                         */
+/*                                                                      */
+/*      Build the OGR geometry directly from the coordinate sequences,  */
+/*      without going through WKB. Returns NULL for the geometries it   */
+/*      does not handle (empty geometries or parts), for which the      */
+/*      caller must use the WKB path.                                   */
+/************************************************************************/
+
+static OGRGeometry* GEOSToOGRGeometry( GEOSContextHandle_t hGEOSCtxt,
+                                       const GEOSGeometry* hGeom, int nDim )
+{
+    if( GEOSisEmpty_r( hGEOSCtxt, hGeom ) != 0 )
+        return NULL;
+
+    const int nGEOSType = GEOSGeomTypeId_r( hGEOSCtxt, hGeom );
+    switch( nGEOSType )
+    {
+        case GEOS_POINT:
+        {
+            const GEOSCoordSequence* hSeq = GEOSGeom_getCoordSeq_r( hGEOSCtxt, hGeom );
+            double dfX = 0.0, dfY = 0.0, dfZ = 0.0;
+            if( hSeq == NULL ||
+                !GEOSCoordSeq_getX_r( hGEOSCtxt, hSeq, 0, &dfX ) ||
+                !GEOSCoordSeq_getY_r( hGEOSCtxt, hSeq, 0, &dfY ) ||
+                (nDim == 3 && !GEOSCoordSeq_getZ_r( hGEOSCtxt, hSeq, 0, &dfZ )) )
+                return NULL;
+            if( nDim == 3 )
+                return new OGRPoint( dfX, dfY, dfZ );
+            return new OGRPoint( dfX, dfY );
+        }
+
+        case GEOS_LINESTRING:
+        case GEOS_LINEARRING:
+        {
+            OGRLineString* poLS = new OGRLineString();
+            if( !GEOSSeqToOGRSimpleCurve( hGEOSCtxt,
+                        GEOSGeom_getCoordSeq_r( hGEOSCtxt, hGeom ), poLS, nDim ) )
+            {
+                delete poLS;
+                return NULL;
+            }
+            return poLS;
+        }
+
+        case GEOS_POLYGON:
+        {
+            OGRPolygon* poPoly = new OGRPolygon();
+            const int nHoles = GEOSGetNumInteriorRings_r( hGEOSCtxt, hGeom );
+            for( int i = -1; i < nHoles; i++ )
+            {
+                const GEOSGeometry* hRing = (i < 0) ?
+                    GEOSGetExteriorRing_r( hGEOSCtxt, hGeom ) :
+                    GEOSGetInteriorRingN_r( hGEOSCtxt, hGeom, i );
+                OGRLinearRing* poRing = new OGRLinearRing();
+                if( hRing == NULL ||
+                    GEOSisEmpty_r( hGEOSCtxt, hRing ) != 0 ||
+                    !GEOSSeqToOGRSimpleCurve( hGEOSCtxt,
+                        GEOSGeom_getCoordSeq_r( hGEOSCtxt, hRing ), poRing, nDim ) )
+                {
+                    delete poRing;
+                    delete poPoly;
+                    return NULL;
+                }
+                poPoly->addRingDirectly( poRing );
+            }
+            return poPoly;
+        }
+
+        case GEOS_MULTIPOINT:
+        case GEOS_MULTILINESTRING:
+        case GEOS_MULTIPOLYGON:
+        case GEOS_GEOMETRYCOLLECTION:
+        {
+            OGRGeometryCollection* poGC;
+            if( nGEOSType == GEOS_MULTIPOINT )
+                poGC = new OGRMultiPoint();
+            else if( nGEOSType == GEOS_MULTILINESTRING )
+                poGC = new OGRMultiLineString();
+            else if( nGEOSType == GEOS_MULTIPOLYGON )
+                poGC = new OGRMultiPolygon();
+            else
+                poGC = new OGRGeometryCollection();
+
+            const int nParts = GEOSGetNumGeometries_r( hGEOSCtxt, hGeom );
+            for( int i = 0; i < nParts; i++ )
+            {
+                const GEOSGeometry* hPart = GEOSGetGeometryN_r( hGEOSCtxt, hGeom, i );
+                OGRGeometry* poPart = (hPart != NULL) ?
+                    GEOSToOGRGeometry( hGEOSCtxt, hPart, nDim ) : NULL;
+                if( poPart == NULL ||
+                    poGC->addGeometryDirectly( poPart ) != OGRERR_NONE )
+                {
+                    delete poPart;
+                    delete poGC;
+                    return NULL;
+                }
+            }
+            return poGC;
+        }
+
+        default:
+            return NULL;
+    }
+}
+
+#endif /* HAVE_GEOS_DIRECT_IMPORT */
+
 /************************************************************************/
 /*                           createFromGEOS()                           */
 /************************************************************************/
@@ -1780,9 +2236,16 @@ OGRGeometryFactory::createFromGEOS( GEOSContextHandle_t hGEOSCtxt, GEOSGeom geos
         GEOSisEmpty_r(hGEOSCtxt, geosGeom))
         return new OGRPoint();
 
-#if GEOS_VERSION_MAJOR > 3 || (GEOS_VERSION_MAJOR == 3 && GEOS_VERSION_MINOR >= 3)
+#ifdef HAVE_GEOS_DIRECT_IMPORT
     /* GEOSGeom_getCoordinateDimension only available in GEOS 3.3.0 (unreleased at time of writing) */
     int nCoordDim = GEOSGeom_getCoordinateDimension_r(hGEOSCtxt, geosGeom);
+
+    /* Read the coordinate sequences directly, and only go through WKB */
+    /* for what is not handled that way */
+    poGeometry = GEOSToOGRGeometry( hGEOSCtxt, geosGeom, nCoordDim );
+    if( poGeometry != NULL )
+        return poGeometry;
+
     GEOSWKBWriter* wkbwriter = GEOSWKBWriter_create_r(hGEOSCtxt);
     GEOSWKBWriter_setOutputDimension_r(hGEOSCtxt, wkbwriter, nCoordDim);
     pabyBuf = GEOSWKBWriter_write_r(hGEOSCtxt, wkbwriter, geosGeom, &nSize );
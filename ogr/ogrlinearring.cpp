@@ -534,6 +534,10 @@ OGRBoolean OGRLinearRing::isPointInRing(const OGRPoint* poPoint, int bTestEnvelo
 
 /************************************************************************/
 /*                       isPointOnRingBoundary()                        */
+/*                                                                      */
+/*      Returns TRUE if the point is exactly on one of the segments     */
+/*      of the ring.  A point on the supporting line of a segment, but  */
+/*      outside of it, is not on the boundary.                          */
 /************************************************************************/
 
 OGRBoolean OGRLinearRing::isPointOnRingBoundary(const OGRPoint* poPoint, int bTestEnvelope) const
@@ -581,7 +585,11 @@ OGRBoolean OGRLinearRing::isPointOnRingBoundary(const OGRPoint* poPoint, int bTe
         /* the vertices of the ring, but somewhere on a segment, there's */
         /* little chance that we get 0. So that should be tested against some epsilon */
 
-        if ( x1 * y2 - x2 * y1 == 0 )
+        /* The point must be on the segment itself, and not only on its */
+        /* supporting line, hence the bounding box test */
+        if ( x1 * y2 - x2 * y1 == 0 &&
+             MIN(x1, x2) <= 0 && MAX(x1, x2) >= 0 &&
+             MIN(y1, y2) <= 0 && MAX(y1, y2) >= 0 )
         {
             /* If iPoint and iPointPrev are the same, go on */
             if( !(x1 == x2 && y1 == y2) )
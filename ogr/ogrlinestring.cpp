@@ -32,9 +32,15 @@
 #include "ogr_p.h"
 #include <assert.h>
 #include "ogr_geos.h"
+#include "cpl_atomic_ops.h"
 
 CPL_CVSID("$Id$");
 
+/* nCachedEnvelopeState is 0 when sCachedEnvelope is invalid.  It is */
+/* incremented by each thread computing the envelope, and the first one */
+/* adds ENVELOPE_CACHE_VALID once it has written sCachedEnvelope. */
+#define ENVELOPE_CACHE_VALID  0x10000000
+
 /************************************************************************/
 /*                           OGRSimpleCurve()                           */
 /************************************************************************/
@@ -45,6 +51,7 @@ OGRSimpleCurve::OGRSimpleCurve()
     nPointCount = 0;
     paoPoints = NULL;
     padfZ = NULL;
+    nCachedEnvelopeState = 0;
 }
 
 /************************************************************************/
@@ -266,6 +273,8 @@ double OGRSimpleCurve::getZ( int iVertex ) const
 void OGRSimpleCurve::setNumPoints( int nNewPointCount, int bZeroizeNewContent )
 
 {
+    nCachedEnvelopeState = 0;
+
     if( nNewPointCount == 0 )
     {
         OGRFree( paoPoints );
@@ -374,6 +383,7 @@ void OGRSimpleCurve::setPoint( int iPoint, double xIn, double yIn, double zIn )
 
     paoPoints[iPoint].x = xIn;
     paoPoints[iPoint].y = yIn;
+    nCachedEnvelopeState = 0;
 
     if( zIn != 0.0 )
     {
@@ -398,6 +408,7 @@ void OGRSimpleCurve::setPoint( int iPoint, double xIn, double yIn )
 
     paoPoints[iPoint].x = xIn;
     paoPoints[iPoint].y = yIn;
+    nCachedEnvelopeState = 0;
 }
 
 /************************************************************************/
@@ -967,6 +978,7 @@ OGRErr OGRSimpleCurve::importFromWkt( char ** ppszInput )
 /*      Read the point list.                                            */
 /* -------------------------------------------------------------------- */
     nPointCount = 0;
+    nCachedEnvelopeState = 0;
 
     int nMaxPoints = 0;
     pszInput = OGRWktReadPoints( pszInput, &paoPoints, &padfZ, &nMaxPoints,
@@ -1473,8 +1485,6 @@ OGRLineString* OGRSimpleCurve::getSubLine(double dfDistanceFrom, double dfDistan
 void OGRSimpleCurve::getEnvelope( OGREnvelope * psEnvelope ) const
 
 {
-    double      dfMinX, dfMinY, dfMaxX, dfMaxY;
-
     if( IsEmpty() )
     {
         psEnvelope->MinX = 0;
@@ -1483,28 +1493,68 @@ void OGRSimpleCurve::getEnvelope( OGREnvelope * psEnvelope ) const
         psEnvelope->MaxY = 0;
         return;
     }
-    
-    dfMinX = dfMaxX = paoPoints[0].x;
-    dfMinY = dfMaxY = paoPoints[0].y;
 
-    for( int iPoint = 1; iPoint < nPointCount; iPoint++ )
+    // The atomic operations are full memory barriers: sCachedEnvelope is
+    // read after the state, and written before it.
+    if( CPLAtomicAdd( &nCachedEnvelopeState, 0 ) >= ENVELOPE_CACHE_VALID )
     {
-        if( dfMaxX < paoPoints[iPoint].x )
-            dfMaxX = paoPoints[iPoint].x;
-        if( dfMaxY < paoPoints[iPoint].y )
-            dfMaxY = paoPoints[iPoint].y;
-        if( dfMinX > paoPoints[iPoint].x )
-            dfMinX = paoPoints[iPoint].x;
-        if( dfMinY > paoPoints[iPoint].y )
-            dfMinY = paoPoints[iPoint].y;
+        *psEnvelope = sCachedEnvelope;
+        return;
     }
 
-    psEnvelope->MinX = dfMinX;
-    psEnvelope->MaxX = dfMaxX;
-    psEnvelope->MinY = dfMinY;
-    psEnvelope->MaxY = dfMaxY;
-}
+/* -------------------------------------------------------------------- */
+/*      Branchless min/max over two interleaved accumulators, so that   */
+/*      the compiler can use maxsd/minsd and overlap the dependency     */
+/*      chains.  The comparisons are written as in the former           */
+/*      implementation so that NaN values are ignored the same way.     */
+/* -------------------------------------------------------------------- */
+    double dfMinX0, dfMinY0, dfMaxX0, dfMaxY0;
+    double dfMinX1, dfMinY1, dfMaxX1, dfMaxY1;
 
+    dfMinX0 = dfMaxX0 = dfMinX1 = dfMaxX1 = paoPoints[0].x;
+    dfMinY0 = dfMaxY0 = dfMinY1 = dfMaxY1 = paoPoints[0].y;
+
+    int iPoint = 1;
+    for( ; iPoint + 1 < nPointCount; iPoint += 2 )
+    {
+        const double dfX0 = paoPoints[iPoint].x;
+        const double dfY0 = paoPoints[iPoint].y;
+        const double dfX1 = paoPoints[iPoint+1].x;
+        const double dfY1 = paoPoints[iPoint+1].y;
+        dfMaxX0 = ( dfMaxX0 < dfX0 ) ? dfX0 : dfMaxX0;
+        dfMaxY0 = ( dfMaxY0 < dfY0 ) ? dfY0 : dfMaxY0;
+        dfMinX0 = ( dfMinX0 > dfX0 ) ? dfX0 : dfMinX0;
+        dfMinY0 = ( dfMinY0 > dfY0 ) ? dfY0 : dfMinY0;
+        dfMaxX1 = ( dfMaxX1 < dfX1 ) ? dfX1 : dfMaxX1;
+        dfMaxY1 = ( dfMaxY1 < dfY1 ) ? dfY1 : dfMaxY1;
+        dfMinX1 = ( dfMinX1 > dfX1 ) ? dfX1 : dfMinX1;
+        dfMinY1 = ( dfMinY1 > dfY1 ) ? dfY1 : dfMinY1;
+    }
+    if( iPoint < nPointCount )
+    {
+        const double dfX0 = paoPoints[iPoint].x;
+        const double dfY0 = paoPoints[iPoint].y;
+        dfMaxX0 = ( dfMaxX0 < dfX0 ) ? dfX0 : dfMaxX0;
+        dfMaxY0 = ( dfMaxY0 < dfY0 ) ? dfY0 : dfMaxY0;
+        dfMinX0 = ( dfMinX0 > dfX0 ) ? dfX0 : dfMinX0;
+        dfMinY0 = ( dfMinY0 > dfY0 ) ? dfY0 : dfMinY0;
+    }
+
+    psEnvelope->MinX = ( dfMinX0 > dfMinX1 ) ? dfMinX1 : dfMinX0;
+    psEnvelope->MaxX = ( dfMaxX0 < dfMaxX1 ) ? dfMaxX1 : dfMaxX0;
+    psEnvelope->MinY = ( dfMinY0 > dfMinY1 ) ? dfMinY1 : dfMinY0;
+    psEnvelope->MaxY = ( dfMaxY0 < dfMaxY1 ) ? dfMaxY1 : dfMaxY0;
+
+/* -------------------------------------------------------------------- */
+/*      Only the first thread to get there writes the cache, the        */
+/*      others concurrently computing the envelope just return it.      */
+/* -------------------------------------------------------------------- */
+    if( CPLAtomicInc( &nCachedEnvelopeState ) == 1 )
+    {
+        sCachedEnvelope = *psEnvelope;
+        CPLAtomicAdd( &nCachedEnvelopeState, ENVELOPE_CACHE_VALID );
+    }
+}
 
 /************************************************************************/
 /*                            getEnvelope()                             */
@@ -1780,6 +1830,7 @@ void OGRSimpleCurve::segmentize( double dfMaxLength )
     OGRFree(paoPoints);
     paoPoints = paoNewPoints;
     nPointCount = nNewPointCount;
+    nCachedEnvelopeState = 0;
 
     if( nCoordinateDimension == 3 )
     {
@@ -1801,6 +1852,7 @@ void OGRSimpleCurve::swapXY()
         paoPoints[i].x = paoPoints[i].y;
         paoPoints[i].y = dfTemp;
     }
+    nCachedEnvelopeState = 0;
 }
 
 /************************************************************************/
@@ -1953,6 +2005,8 @@ OGRLineString* OGRLineString::TransferMembersAndDestroy(
     poDst->nPointCount = poSrc->nPointCount;
     poDst->paoPoints = poSrc->paoPoints;
     poDst->padfZ = poSrc->padfZ;
+    poDst->nCachedEnvelopeState = poSrc->nCachedEnvelopeState;
+    poDst->sCachedEnvelope = poSrc->sCachedEnvelope;
     poSrc->nPointCount = 0;
     poSrc->paoPoints = NULL;
     poSrc->padfZ = NULL;
@@ -34,6 +34,7 @@
 #include "ogr_attrind.h"
 #include "swq.h"
 #include "ograpispy.h"
+#include <vector>
 
 CPL_CVSID("$Id$");
 
@@ -1956,6 +1957,235 @@ static OGRGeometry* promote_to_multi(OGRGeometry* poGeom)
         return poGeom;
 }
 
+/************************************************************************/
+/*                        OGRMethodLayerReader                          */
+/*                                                                      */
+/*      Iterates over the features of the method layer that intersect   */
+/*      a feature of the input layer.  When the method layer is small   */
+/*      enough, its features are read once and their geometries are     */
+/*      prepared, so that the complex geometries of the method layer    */
+/*      are not converted to GEOS again for each input feature.         */
+/*      Otherwise the spatial filter of the method layer is used.       */
+/************************************************************************/
+
+class OGRMethodLayerReader
+{
+    OGRLayer                           *poLayer;
+    OGRGeometry                        *poExistingFilter;
+
+    int                                 bCached;
+    std::vector<OGRFeature*>            apoFeatures;
+    std::vector<OGRPreparedGeometry*>   apoPrepared;
+    std::vector<OGREnvelope>            asEnvelopes;
+
+    OGRGeometry                        *poFilterGeom;
+    int                                 bOwnFilterGeom;
+    OGREnvelope                         sFilterEnvelope;
+    size_t                              iNext;
+    OGRFeature                         *poCurrent;
+
+    void                ClearFilter();
+    void                ClearCache();
+
+  public:
+                        OGRMethodLayerReader( OGRLayer *poLayerIn );
+                       ~OGRMethodLayerReader();
+
+    void                Init( OGRGeometry *poExistingFilterIn );
+    OGRGeometry        *SetFilterFrom( OGRFeature *poFeature );
+    OGRFeature         *GetNextFeature( const OGRPreparedGeometry **ppoPrepared );
+};
+
+/************************************************************************/
+/*                        OGRMethodLayerReader()                        */
+/************************************************************************/
+
+OGRMethodLayerReader::OGRMethodLayerReader( OGRLayer *poLayerIn ) :
+    poLayer(poLayerIn), poExistingFilter(NULL), bCached(FALSE),
+    poFilterGeom(NULL), bOwnFilterGeom(FALSE), iNext(0), poCurrent(NULL)
+{
+}
+
+/************************************************************************/
+/*                       ~OGRMethodLayerReader()                        */
+/************************************************************************/
+
+OGRMethodLayerReader::~OGRMethodLayerReader()
+{
+    ClearFilter();
+    ClearCache();
+    delete poCurrent;
+}
+
+/************************************************************************/
+/*                            ClearFilter()                             */
+/************************************************************************/
+
+void OGRMethodLayerReader::ClearFilter()
+{
+    if( bOwnFilterGeom )
+        delete poFilterGeom;
+    poFilterGeom = NULL;
+    bOwnFilterGeom = FALSE;
+}
+
+/************************************************************************/
+/*                             ClearCache()                             */
+/************************************************************************/
+
+void OGRMethodLayerReader::ClearCache()
+{
+    for( size_t i = 0; i < apoFeatures.size(); i++ )
+    {
+        delete apoFeatures[i];
+        OGRDestroyPreparedGeometry( apoPrepared[i] );
+    }
+    apoFeatures.clear();
+    apoPrepared.clear();
+    asEnvelopes.clear();
+    bCached = FALSE;
+}
+
+/************************************************************************/
+/*                                Init()                                */
+/*                                                                      */
+/*      Must be called once the spatial filter of the method layer      */
+/*      has been saved.                                                 */
+/************************************************************************/
+
+void OGRMethodLayerReader::Init( OGRGeometry *poExistingFilterIn )
+{
+    poExistingFilter = poExistingFilterIn;
+
+    if( !OGRHasPreparedGeometrySupport() )
+        return;
+
+    const int nMaxFeatures = atoi(
+        CPLGetConfigOption("OGR_OVERLAY_MAX_CACHED_METHOD_FEATURES", "1000") );
+    if( nMaxFeatures <= 0 )
+        return;
+
+/* -------------------------------------------------------------------- */
+/*      Read the method layer (with its own spatial filter) and give    */
+/*      up as soon as it has too many features.                        */
+/* -------------------------------------------------------------------- */
+    bCached = TRUE;
+    poLayer->ResetReading();
+    OGRFeature *poFeature;
+    while( (poFeature = poLayer->GetNextFeature()) != NULL )
+    {
+        OGRGeometry *poGeom = poFeature->GetGeometryRef();
+        if( poGeom == NULL )
+        {
+            delete poFeature;
+            continue;
+        }
+        if( (int)apoFeatures.size() == nMaxFeatures )
+        {
+            delete poFeature;
+            ClearCache();
+            break;
+        }
+
+        OGRPreparedGeometry *poPrepared = OGRCreatePreparedGeometry( poGeom );
+        if( poPrepared == NULL )
+        {
+            delete poFeature;
+            ClearCache();
+            break;
+        }
+
+        OGREnvelope sEnvelope;
+        poGeom->getEnvelope( &sEnvelope );
+        apoFeatures.push_back( poFeature );
+        apoPrepared.push_back( poPrepared );
+        asEnvelopes.push_back( sEnvelope );
+    }
+
+    if( bCached )
+        CPLDebug( "OGR", "Overlay: %d features of layer %s prepared",
+                  (int)apoFeatures.size(), poLayer->GetName() );
+}
+
+/************************************************************************/
+/*                           SetFilterFrom()                            */
+/*                                                                      */
+/*      Same as set_filter_from(), and restarts the reading.            */
+/************************************************************************/
+
+OGRGeometry *OGRMethodLayerReader::SetFilterFrom( OGRFeature *poFeature )
+{
+    if( !bCached )
+    {
+        OGRGeometry *poGeom = set_filter_from( poLayer, poExistingFilter,
+                                               poFeature );
+        if( poGeom != NULL )
+            poLayer->ResetReading();
+        return poGeom;
+    }
+
+    ClearFilter();
+    iNext = 0;
+
+    OGRGeometry *poGeom = poFeature->GetGeometryRef();
+    if( poGeom == NULL )
+        return NULL;
+    if( poExistingFilter != NULL )
+    {
+        if( !poGeom->Intersects(poExistingFilter) )
+            return NULL;
+        poFilterGeom = poGeom->Intersection(poExistingFilter);
+        bOwnFilterGeom = TRUE;
+        if( poFilterGeom == NULL )
+            return NULL;
+    }
+    else
+        poFilterGeom = poGeom;
+    poFilterGeom->getEnvelope( &sFilterEnvelope );
+
+    return poGeom;
+}
+
+/************************************************************************/
+/*                           GetNextFeature()                           */
+/*                                                                      */
+/*      The returned feature is owned by the reader and remains valid   */
+/*      until the next call.  *ppoPrepared is set to its prepared       */
+/*      geometry, or NULL if not available.                             */
+/************************************************************************/
+
+OGRFeature *OGRMethodLayerReader::GetNextFeature(
+                                    const OGRPreparedGeometry **ppoPrepared )
+{
+    *ppoPrepared = NULL;
+
+    delete poCurrent;
+    poCurrent = NULL;
+
+    if( !bCached )
+    {
+        poCurrent = poLayer->GetNextFeature();
+        return poCurrent;
+    }
+
+    if( poFilterGeom == NULL )
+        return NULL;
+
+    while( iNext < apoFeatures.size() )
+    {
+        const size_t i = iNext ++;
+        if( !asEnvelopes[i].Intersects( sFilterEnvelope ) )
+            continue;
+        if( !OGRPreparedGeometryIntersects( apoPrepared[i], poFilterGeom ) )
+            continue;
+
+        *ppoPrepared = apoPrepared[i];
+        return apoFeatures[i];
+    }
+
+    return NULL;
+}
+
 /************************************************************************/
 /*                          Intersection()                              */
 /************************************************************************/
@@ -2023,6 +2253,8 @@ OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
     OGRFeatureDefn *poDefnMethod = pLayerMethod->GetLayerDefn();
     OGRFeatureDefn *poDefnResult = NULL;
+    OGRMethodLayerReader oMethodReader(pLayerMethod);
+    const OGRPreparedGeometry *poPreparedY = NULL;
     OGRGeometry *pGeometryMethodFilter = NULL;
     int *mapInput = NULL;
     int *mapMethod = NULL;
@@ -2049,6 +2281,7 @@ OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
     ret = set_result_schema(pLayerResult, poDefnInput, poDefnMethod, mapInput, mapMethod, 1, papszOptions);
     if (ret != OGRERR_NONE) goto done;
     poDefnResult = pLayerResult->GetLayerDefn();
+    oMethodReader.Init(pGeometryMethodFilter);
     bEnvelopeSet = pLayerMethod->GetExtent(&sEnvelopeMethod, 1) == OGRERR_NONE;
 
     ResetReading();
@@ -2087,24 +2320,24 @@ OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
         }
 
         // set up the filter for method layer
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x);
+        OGRGeometry *x_geom = oMethodReader.SetFilterFrom(x);
         if (!x_geom) {
             delete x;
             continue;
         }
 
-        pLayerMethod->ResetReading();
-        while (OGRFeature *y = pLayerMethod->GetNextFeature()) {
+        while (OGRFeature *y = oMethodReader.GetNextFeature(&poPreparedY)) {
             OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) {delete y; continue;}
-            OGRGeometry* poIntersection = x_geom->Intersection(y_geom);
+            if (!y_geom) continue;
+            // if y contains x, their intersection is x itself
+            const int bXInY = OGRPreparedGeometryContains(poPreparedY, x_geom);
+            OGRGeometry *poIntersection = bXInY ? x_geom->clone() : x_geom->Intersection(y_geom);
             if( poIntersection == NULL || poIntersection->IsEmpty() ||
                 (x_geom->getDimension() == 2 &&
                 y_geom->getDimension() == 2 &&
                 poIntersection->getDimension() < 2) )
             {
                 delete poIntersection;
-                delete y;
             }
             else
             {
@@ -2114,7 +2347,6 @@ OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
                 if( bPromoteToMulti )
                     poIntersection = promote_to_multi(poIntersection);
                 z->SetGeometryDirectly(poIntersection);
-                delete y;
                 ret = pLayerResult->CreateFeature(z);
                 delete z;
                 if (ret != OGRERR_NONE) {
@@ -2289,6 +2521,8 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
     OGRFeatureDefn *poDefnMethod = pLayerMethod->GetLayerDefn();
     OGRFeatureDefn *poDefnResult = NULL;
+    OGRMethodLayerReader oMethodReader(pLayerMethod);
+    const OGRPreparedGeometry *poPreparedY = NULL;
     OGRGeometry *pGeometryMethodFilter = NULL;
     OGRGeometry *pGeometryInputFilter = NULL;
     int *mapInput = NULL;
@@ -2316,6 +2550,7 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
     ret = set_result_schema(pLayerResult, poDefnInput, poDefnMethod, mapInput, mapMethod, 1, papszOptions);
     if (ret != OGRERR_NONE) goto done;
     poDefnResult = pLayerResult->GetLayerDefn();
+    oMethodReader.Init(pGeometryMethodFilter);
 
     // add features based on input layer
     ResetReading();
@@ -2335,25 +2570,25 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
         }
 
         // set up the filter on method layer
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x);
+        OGRGeometry *x_geom = oMethodReader.SetFilterFrom(x);
         if (!x_geom) {
             delete x; 
             continue;
         }
         
         OGRGeometry *x_geom_diff = x_geom->clone(); // this will be the geometry of the result feature
-        pLayerMethod->ResetReading();
-        while (OGRFeature *y = pLayerMethod->GetNextFeature()) {
+        while (OGRFeature *y = oMethodReader.GetNextFeature(&poPreparedY)) {
             OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) {delete y; continue;}
-            OGRGeometry *poIntersection = x_geom->Intersection(y_geom);
+            if (!y_geom) continue;
+            // if y contains x, their intersection is x itself
+            const int bXInY = OGRPreparedGeometryContains(poPreparedY, x_geom);
+            OGRGeometry *poIntersection = bXInY ? x_geom->clone() : x_geom->Intersection(y_geom);
             if( poIntersection == NULL || poIntersection->IsEmpty() ||
                 (x_geom->getDimension() == 2 &&
                 y_geom->getDimension() == 2 &&
                 poIntersection->getDimension() < 2) )
             {
                 delete poIntersection;
-                delete y;
             }
             else
             {
@@ -2363,10 +2598,9 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
                 if( bPromoteToMulti )
                     poIntersection = promote_to_multi(poIntersection);
                 z->SetGeometryDirectly(poIntersection);
-                OGRGeometry *x_geom_diff_new = x_geom_diff ? x_geom_diff->Difference(y_geom) : NULL;
+                OGRGeometry *x_geom_diff_new = (x_geom_diff && !bXInY) ? x_geom_diff->Difference(y_geom) : NULL;
                 if (x_geom_diff) delete x_geom_diff;
                 x_geom_diff = x_geom_diff_new;
-                delete y;
                 ret = pLayerResult->CreateFeature(z);
                 delete z;
                 if (ret != OGRERR_NONE) {
@@ -2633,6 +2867,8 @@ OGRErr OGRLayer::SymDifference( OGRLayer *pLayerMethod,
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
     OGRFeatureDefn *poDefnMethod = pLayerMethod->GetLayerDefn();
     OGRFeatureDefn *poDefnResult = NULL;
+    OGRMethodLayerReader oMethodReader(pLayerMethod);
+    const OGRPreparedGeometry *poPreparedY = NULL;
     OGRGeometry *pGeometryMethodFilter = NULL;
     OGRGeometry *pGeometryInputFilter = NULL;
     int *mapInput = NULL;
@@ -2660,6 +2896,7 @@ OGRErr OGRLayer::SymDifference( OGRLayer *pLayerMethod,
     ret = set_result_schema(pLayerResult, poDefnInput, poDefnMethod, mapInput, mapMethod, 1, papszOptions);
     if (ret != OGRERR_NONE) goto done;
     poDefnResult = pLayerResult->GetLayerDefn();
+    oMethodReader.Init(pGeometryMethodFilter);
 
     // add features based on input layer
     ResetReading();
@@ -2679,21 +2916,25 @@ OGRErr OGRLayer::SymDifference( OGRLayer *pLayerMethod,
         }
 
         // set up the filter on method layer
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x);
+        OGRGeometry *x_geom = oMethodReader.SetFilterFrom(x);
         if (!x_geom) {
             delete x; 
             continue;
         }
         
         OGRGeometry *geom = x_geom->clone(); // this will be the geometry of the result feature
-        pLayerMethod->ResetReading();
-        while (OGRFeature *y = pLayerMethod->GetNextFeature()) {
+        while (OGRFeature *y = oMethodReader.GetNextFeature(&poPreparedY)) {
             OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) {delete y; continue;}
+            if (!y_geom) continue;
+            if (OGRPreparedGeometryContains(poPreparedY, x_geom)) {
+                // nothing of x remains
+                delete geom;
+                geom = NULL;
+                break;
+            }
             OGRGeometry *geom_new = geom ? geom->Difference(y_geom) : NULL;
             if (geom) delete geom;
             geom = geom_new;
-            delete y;
             if (geom && geom->IsEmpty()) break;
         }
 
@@ -2944,6 +3185,8 @@ OGRErr OGRLayer::Identity( OGRLayer *pLayerMethod,
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
     OGRFeatureDefn *poDefnMethod = pLayerMethod->GetLayerDefn();
     OGRFeatureDefn *poDefnResult = NULL;
+    OGRMethodLayerReader oMethodReader(pLayerMethod);
+    const OGRPreparedGeometry *poPreparedY = NULL;
     OGRGeometry *pGeometryMethodFilter = NULL;
     int *mapInput = NULL;
     int *mapMethod = NULL;
@@ -2968,6 +3211,7 @@ OGRErr OGRLayer::Identity( OGRLayer *pLayerMethod,
     ret = set_result_schema(pLayerResult, poDefnInput, poDefnMethod, mapInput, mapMethod, 1, papszOptions);
     if (ret != OGRERR_NONE) goto done;
     poDefnResult = pLayerResult->GetLayerDefn();
+    oMethodReader.Init(pGeometryMethodFilter);
 
     // split the features in input layer to the result layer
     ResetReading();
@@ -2987,25 +3231,25 @@ OGRErr OGRLayer::Identity( OGRLayer *pLayerMethod,
         }
 
         // set up the filter on method layer
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x);
+        OGRGeometry *x_geom = oMethodReader.SetFilterFrom(x);
         if (!x_geom) {
             delete x; 
             continue;
         }
         
         OGRGeometry *x_geom_diff = x_geom->clone(); // this will be the geometry of the result feature
-        pLayerMethod->ResetReading();
-        while (OGRFeature *y = pLayerMethod->GetNextFeature()) {
+        while (OGRFeature *y = oMethodReader.GetNextFeature(&poPreparedY)) {
             OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) {delete y; continue;}
-            OGRGeometry* poIntersection = x_geom->Intersection(y_geom);
+            if (!y_geom) continue;
+            // if y contains x, their intersection is x itself
+            const int bXInY = OGRPreparedGeometryContains(poPreparedY, x_geom);
+            OGRGeometry *poIntersection = bXInY ? x_geom->clone() : x_geom->Intersection(y_geom);
             if( poIntersection == NULL || poIntersection->IsEmpty() ||
                 (x_geom->getDimension() == 2 &&
                 y_geom->getDimension() == 2 &&
                 poIntersection->getDimension() < 2) )
             {
                 delete poIntersection;
-                delete y;
             }
             else
             {
@@ -3015,10 +3259,9 @@ OGRErr OGRLayer::Identity( OGRLayer *pLayerMethod,
                 if( bPromoteToMulti )
                     poIntersection = promote_to_multi(poIntersection);
                 z->SetGeometryDirectly(poIntersection);
-                OGRGeometry *x_geom_diff_new = x_geom_diff ? x_geom_diff->Difference(y_geom) : NULL;
+                OGRGeometry *x_geom_diff_new = (x_geom_diff && !bXInY) ? x_geom_diff->Difference(y_geom) : NULL;
                 if (x_geom_diff) delete x_geom_diff;
                 x_geom_diff = x_geom_diff_new;
-                delete y;
                 ret = pLayerResult->CreateFeature(z);
                 delete z;
                 if (ret != OGRERR_NONE) {
@@ -3218,6 +3461,8 @@ OGRErr OGRLayer::Update( OGRLayer *pLayerMethod,
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
     OGRFeatureDefn *poDefnMethod = pLayerMethod->GetLayerDefn();
     OGRFeatureDefn *poDefnResult = NULL;
+    OGRMethodLayerReader oMethodReader(pLayerMethod);
+    const OGRPreparedGeometry *poPreparedY = NULL;
     OGRGeometry *pGeometryMethodFilter = NULL;
     int *mapInput = NULL;
     int *mapMethod = NULL;
@@ -3242,6 +3487,7 @@ OGRErr OGRLayer::Update( OGRLayer *pLayerMethod,
     ret = set_result_schema(pLayerResult, poDefnInput, poDefnMethod, mapInput, mapMethod, 0, papszOptions);
     if (ret != OGRERR_NONE) goto done;
     poDefnResult = pLayerResult->GetLayerDefn();
+    oMethodReader.Init(pGeometryMethodFilter);
 
     // add clipped features from the input layer
     ResetReading();
@@ -3261,21 +3507,25 @@ OGRErr OGRLayer::Update( OGRLayer *pLayerMethod,
         }
 
         // set up the filter on method layer
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x);
+        OGRGeometry *x_geom = oMethodReader.SetFilterFrom(x);
         if (!x_geom) {
             delete x; 
             continue;
         }
         
         OGRGeometry *x_geom_diff = x_geom->clone(); //this will be the geometry of a result feature
-        pLayerMethod->ResetReading();
-        while (OGRFeature *y = pLayerMethod->GetNextFeature()) {
+        while (OGRFeature *y = oMethodReader.GetNextFeature(&poPreparedY)) {
             OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) {delete y; continue;}
+            if (!y_geom) continue;
+            if (OGRPreparedGeometryContains(poPreparedY, x_geom)) {
+                // nothing of x remains
+                delete x_geom_diff;
+                x_geom_diff = NULL;
+                break;
+            }
             OGRGeometry *x_geom_diff_new = x_geom_diff ? x_geom_diff->Difference(y_geom) : NULL;
             if (x_geom_diff) delete x_geom_diff;
             x_geom_diff = x_geom_diff_new;
-            delete y;
         }
 
         if( x_geom_diff == NULL || x_geom_diff->IsEmpty() )
@@ -3492,6 +3742,8 @@ OGRErr OGRLayer::Clip( OGRLayer *pLayerMethod,
     OGRErr ret = OGRERR_NONE;
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
     OGRFeatureDefn *poDefnResult = NULL;
+    OGRMethodLayerReader oMethodReader(pLayerMethod);
+    const OGRPreparedGeometry *poPreparedY = NULL;
     OGRGeometry *pGeometryMethodFilter = NULL;
     int *mapInput = NULL;
     double progress_max = (double) GetFeatureCount(0);
@@ -3513,6 +3765,7 @@ OGRErr OGRLayer::Clip( OGRLayer *pLayerMethod,
     if (ret != OGRERR_NONE) goto done;
     
     poDefnResult = pLayerResult->GetLayerDefn();
+    oMethodReader.Init(pGeometryMethodFilter);
     ResetReading();
     while (OGRFeature *x = GetNextFeature()) {
 
@@ -3530,18 +3783,23 @@ OGRErr OGRLayer::Clip( OGRLayer *pLayerMethod,
         }
 
         // set up the filter on method layer
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x);
+        OGRGeometry *x_geom = oMethodReader.SetFilterFrom(x);
         if (!x_geom) {
             delete x; 
             continue;
         }
         
         OGRGeometry *geom = NULL; // this will be the geometry of the result feature 
-        pLayerMethod->ResetReading();
+        int bXCovered = FALSE;
         // incrementally add area from y to geom
-        while (OGRFeature *y = pLayerMethod->GetNextFeature()) {
+        while (OGRFeature *y = oMethodReader.GetNextFeature(&poPreparedY)) {
             OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) {delete y; continue;}
+            if (!y_geom) continue;
+            if (OGRPreparedGeometryContains(poPreparedY, x_geom)) {
+                // x is entirely covered by y
+                bXCovered = TRUE;
+                break;
+            }
             if (!geom) {
                 geom = y_geom->clone();
             } else {
@@ -3549,13 +3807,12 @@ OGRErr OGRLayer::Clip( OGRLayer *pLayerMethod,
                 delete geom;
                 geom = geom_new;
             }
-            delete y;
         }
 
         // possibly add a new feature with area x intersection sum of y
         OGRFeature *z = NULL;
-        if (geom) {
-            OGRGeometry* poIntersection = x_geom->Intersection(geom);
+        if (geom || bXCovered) {
+            OGRGeometry* poIntersection = bXCovered ? x_geom->clone() : x_geom->Intersection(geom);
             if( poIntersection != NULL && !poIntersection->IsEmpty() )
             {
                 z = new OGRFeature(poDefnResult);
@@ -3728,6 +3985,8 @@ OGRErr OGRLayer::Erase( OGRLayer *pLayerMethod,
     OGRErr ret = OGRERR_NONE;
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
     OGRFeatureDefn *poDefnResult = NULL;
+    OGRMethodLayerReader oMethodReader(pLayerMethod);
+    const OGRPreparedGeometry *poPreparedY = NULL;
     OGRGeometry *pGeometryMethodFilter = NULL;
     int *mapInput = NULL;
     double progress_max = (double) GetFeatureCount(0);
@@ -3749,6 +4008,7 @@ OGRErr OGRLayer::Erase( OGRLayer *pLayerMethod,
     ret = set_result_schema(pLayerResult, poDefnInput, NULL, mapInput, NULL, 0, papszOptions);
     if (ret != OGRERR_NONE) goto done;
     poDefnResult = pLayerResult->GetLayerDefn();
+    oMethodReader.Init(pGeometryMethodFilter);
 
     ResetReading();
     while (OGRFeature *x = GetNextFeature()) {
@@ -3767,18 +4027,23 @@ OGRErr OGRLayer::Erase( OGRLayer *pLayerMethod,
         }
 
         // set up the filter on the method layer
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x);
+        OGRGeometry *x_geom = oMethodReader.SetFilterFrom(x);
         if (!x_geom) {
             delete x; 
             continue;
         }
 
         OGRGeometry *geom = NULL; // this will be the geometry of the result feature
-        pLayerMethod->ResetReading();
+        int bXCovered = FALSE;
         // incrementally add area from y to geom
-        while (OGRFeature *y = pLayerMethod->GetNextFeature()) {
+        while (OGRFeature *y = oMethodReader.GetNextFeature(&poPreparedY)) {
             OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) {delete y; continue;}
+            if (!y_geom) continue;
+            if (OGRPreparedGeometryContains(poPreparedY, x_geom)) {
+                // x is entirely covered by y
+                bXCovered = TRUE;
+                break;
+            }
             if (!geom) {
                 geom = y_geom->clone();
             } else {
@@ -3786,12 +4051,13 @@ OGRErr OGRLayer::Erase( OGRLayer *pLayerMethod,
                 delete geom;
                 geom = geom_new;
             }
-            delete y;
         }
 
         // possibly add a new feature with area x minus sum of y
         OGRFeature *z = NULL;
-        if (geom) {
+        if (bXCovered) {
+            delete geom;
+        } else if (geom) {
             OGRGeometry* x_geom_diff = x_geom->Difference(geom);
             if( x_geom_diff != NULL && !x_geom_diff->IsEmpty() )
             {
@@ -642,7 +642,7 @@ static int OGR_json_double_with_precision_to_string(struct json_object *jso,
     char szBuffer[75];
     int nPrecision = (int) (size_t) jso->_userdata;
     OGRFormatDouble( szBuffer, sizeof(szBuffer), jso->o.c_double, '.',
-                     (nPrecision < 0) ? 15 : nPrecision );
+                     nPrecision );
     if( szBuffer[0] == 't' /*oobig */ )
     {
         CPLsnprintf(szBuffer, sizeof(szBuffer), "%.18g", jso->o.c_double);
@@ -159,6 +159,8 @@ void RegisterOGRPG()
         poDriver->pfnIdentify = OGRPGDriverIdentify;
         poDriver->pfnCreate = OGRPGDriverCreate;
 
+        poDriver->AddOpenPrefix( "PG:" );
+
         GetGDALDriverManager()->RegisterDriver( poDriver );
     }
 }
@@ -286,6 +286,11 @@ void RegisterOGRShape()
         poDriver->pfnCreate = OGRShapeDriverCreate;
         poDriver->pfnDelete = OGRShapeDriverDelete;
 
+        poDriver->AddOpenSignature( "\x00\x00\x27\x0A", 4 );
+        poDriver->AddOpenExtension( "shp" );
+        poDriver->AddOpenExtension( "shx" );
+        poDriver->AddOpenExtension( "dbf" );
+
         GetGDALDriverManager()->RegisterDriver( poDriver );
     }
 }
@@ -1572,7 +1572,7 @@ void OGRWFSDataSource::LoadMultipleLayerDefn(const char* pszLayerName,
         return;
     }
 
-    CPLXMLNode* psXML = CPLParseXMLString( (const char*) psResult->pabyData );
+    CPLXMLNode* psXML = CPLParseXMLStringInArena( (const char*) psResult->pabyData );
     if (psXML == NULL)
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Invalid XML content : %s",
@@ -1587,7 +1587,7 @@ void OGRWFSDataSource::LoadMultipleLayerDefn(const char* pszLayerName,
     if (psSchema == NULL)
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Cannot find <Schema>");
-        CPLDestroyXMLNode( psXML );
+        CPLDestroyXMLArenaTree( psXML );
         bLoadMultipleLayerDefn = FALSE;
         return;
     }
@@ -1741,7 +1741,7 @@ void OGRWFSDataSource::LoadMultipleLayerDefn(const char* pszLayerName,
 
     VSIUnlink(osTmpFileName);
 
-    CPLDestroyXMLNode( psXML );
+    CPLDestroyXMLArenaTree( psXML );
 }
 
 /************************************************************************/
@@ -248,7 +248,7 @@ OGRFeatureDefn* OGRWFSLayer::DescribeFeatureType()
         return NULL;
     }
 
-    CPLXMLNode* psXML = CPLParseXMLString( (const char*) psResult->pabyData );
+    CPLXMLNode* psXML = CPLParseXMLStringInArena( (const char*) psResult->pabyData );
     if (psXML == NULL)
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Invalid XML content : %s",
@@ -262,7 +262,7 @@ OGRFeatureDefn* OGRWFSLayer::DescribeFeatureType()
     if (psSchema == NULL)
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Cannot find <Schema>");
-        CPLDestroyXMLNode( psXML );
+        CPLDestroyXMLArenaTree( psXML );
 
         return NULL;
     }
@@ -271,7 +271,7 @@ OGRFeatureDefn* OGRWFSLayer::DescribeFeatureType()
     if (poFDefn)
         poDS->SaveLayerSchema(pszName, psSchema);
 
-    CPLDestroyXMLNode( psXML );
+    CPLDestroyXMLArenaTree( psXML );
     return poFDefn;
 }
 
@@ -1327,6 +1327,97 @@ int OGRWFSLayer::TestCapability( const char * pszCap )
     return FALSE;
 }
 
+/************************************************************************/
+/*                        Hits response parsing                         */
+/*                                                                      */
+/*      Only the attributes of the root FeatureCollection element are   */
+/*      of interest, so the response is scanned with the event driven   */
+/*      parser, which is stopped as soon as the root start tag has      */
+/*      been read.                                                      */
+/************************************************************************/
+
+typedef struct
+{
+    int         nDepth;
+    int         bInRoot;
+    int         bFoundRoot;
+    int         bDone;
+    int         bHasNumberOfFeatures;
+    int         bHasNumberMatched;
+    CPLString   osNumberOfFeatures;
+    CPLString   osNumberMatched;
+} WFSHitsParseState;
+
+static const char* WFSStripNamespace(const char* pszName)
+{
+    const char* pszSep = strchr(pszName, ':');
+    return pszSep ? pszSep + 1 : pszName;
+}
+
+static int WFSHitsStartElement(void* pUserData, const char* pszName)
+{
+    WFSHitsParseState* psState = (WFSHitsParseState*) pUserData;
+    if (psState->bInRoot)
+    {
+        psState->bDone = TRUE;
+        return FALSE;
+    }
+    psState->nDepth ++;
+    if (psState->nDepth == 1 &&
+        EQUAL(WFSStripNamespace(pszName), "FeatureCollection"))
+    {
+        psState->bInRoot = TRUE;
+        psState->bFoundRoot = TRUE;
+    }
+    return TRUE;
+}
+
+static int WFSHitsAttribute(void* pUserData, const char* pszName,
+                            const char* pszValue)
+{
+    WFSHitsParseState* psState = (WFSHitsParseState*) pUserData;
+    if (psState->bInRoot)
+    {
+        pszName = WFSStripNamespace(pszName);
+        if (EQUAL(pszName, "numberOfFeatures") &&
+            !psState->bHasNumberOfFeatures)
+        {
+            psState->bHasNumberOfFeatures = TRUE;
+            psState->osNumberOfFeatures = pszValue;
+        }
+        else if (EQUAL(pszName, "numberMatched") &&
+                 !psState->bHasNumberMatched)
+        {
+            psState->bHasNumberMatched = TRUE;
+            psState->osNumberMatched = pszValue;
+        }
+    }
+    return TRUE;
+}
+
+static int WFSHitsEndElement(void* pUserData, CPL_UNUSED const char* pszName)
+{
+    WFSHitsParseState* psState = (WFSHitsParseState*) pUserData;
+    if (psState->bInRoot)
+    {
+        psState->bDone = TRUE;
+        return FALSE;
+    }
+    psState->nDepth --;
+    return TRUE;
+}
+
+static int WFSHitsText(void* pUserData, CPL_UNUSED const char* pszText)
+{
+    WFSHitsParseState* psState = (WFSHitsParseState*) pUserData;
+    if (psState->bInRoot)
+    {
+        psState->bDone = TRUE;
+        return FALSE;
+    }
+    return TRUE;
+}
+
 /************************************************************************/
 /*                  ExecuteGetFeatureResultTypeHits()                   */
 /************************************************************************/
@@ -1413,8 +1504,23 @@ GIntBig OGRWFSLayer::ExecuteGetFeatureResultTypeHits()
         return -1;
     }
 
-    CPLXMLNode* psXML = CPLParseXMLString( pabyData );
-    if (psXML == NULL)
+    WFSHitsParseState sState;
+    sState.nDepth = 0;
+    sState.bInRoot = FALSE;
+    sState.bFoundRoot = FALSE;
+    sState.bDone = FALSE;
+    sState.bHasNumberOfFeatures = FALSE;
+    sState.bHasNumberMatched = FALSE;
+
+    CPLXMLParseHandlers sHandlers;
+    memset(&sHandlers, 0, sizeof(sHandlers));
+    sHandlers.pfnStartElement = WFSHitsStartElement;
+    sHandlers.pfnAttribute = WFSHitsAttribute;
+    sHandlers.pfnEndElement = WFSHitsEndElement;
+    sHandlers.pfnText = WFSHitsText;
+
+    if (!CPLParseXMLStringWithHandlers( pabyData, &sHandlers, &sState ) &&
+        !sState.bDone)
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Invalid XML content : %s",
                 pabyData);
@@ -1423,24 +1529,22 @@ GIntBig OGRWFSLayer::ExecuteGetFeatureResultTypeHits()
         return -1;
     }
 
-    CPLStripXMLNamespace( psXML, NULL, TRUE );
-    CPLXMLNode* psRoot = CPLGetXMLNode( psXML, "=FeatureCollection" );
-    if (psRoot == NULL)
+    if (!sState.bFoundRoot)
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Cannot find <FeatureCollection>");
-        CPLDestroyXMLNode( psXML );
         CPLHTTPDestroyResult(psResult);
         CPLFree(pabyData);
         return -1;
     }
 
-    const char* pszValue = CPLGetXMLValue(psRoot, "numberOfFeatures", NULL);
-    if (pszValue == NULL)
-        pszValue = CPLGetXMLValue(psRoot, "numberMatched", NULL); /* WFS 2.0.0 */
+    const char* pszValue = NULL;
+    if (sState.bHasNumberOfFeatures)
+        pszValue = sState.osNumberOfFeatures.c_str();
+    else if (sState.bHasNumberMatched)
+        pszValue = sState.osNumberMatched.c_str(); /* WFS 2.0.0 */
     if (pszValue == NULL)
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Cannot find numberOfFeatures");
-        CPLDestroyXMLNode( psXML );
         CPLHTTPDestroyResult(psResult);
         CPLFree(pabyData);
         
@@ -1463,7 +1567,6 @@ GIntBig OGRWFSLayer::ExecuteGetFeatureResultTypeHits()
         }
     }
 
-    CPLDestroyXMLNode( psXML );
     CPLHTTPDestroyResult(psResult);
     CPLFree(pabyData);
 
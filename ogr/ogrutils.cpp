@@ -49,6 +49,40 @@ CPL_CVSID("$Id$");
 
 void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal, char chDecimalSep, int nPrecision )
 {
+/* -------------------------------------------------------------------- */
+/*      Without an explicit precision, write the shortest string that   */
+/*      reads back as the same value, rather than trying to guess which */
+/*      trailing digits are roundoff error.                             */
+/* -------------------------------------------------------------------- */
+    if( nPrecision < 0 )
+    {
+        char szShortest[40];
+        int nLen = CPLDoubleToShortestString( dfVal, szShortest,
+                                              sizeof(szShortest) );
+
+        /* Keep a decimal part on integral values, as "%.15f" did, so */
+        /* that they are still read as reals (GeoJSON, GPX, ...) */
+        if( strpbrk(szShortest, ".ein") == NULL )
+        {
+            szShortest[nLen++] = '.';
+            szShortest[nLen++] = '0';
+            szShortest[nLen] = '\0';
+        }
+
+        if( chDecimalSep != '\0' && chDecimalSep != '.' )
+        {
+            char* pszPoint = strchr(szShortest, '.');
+            if( pszPoint != NULL )
+                *pszPoint = chDecimalSep;
+        }
+
+        if( nLen >= nBufferLen )
+            CPLsnprintf(pszBuffer, nBufferLen, "%s", "too_big");
+        else
+            memcpy(pszBuffer, szShortest, nLen + 1);
+        return;
+    }
+
     int i;
     int nTruncations = 0;
     char szFormat[16];
@@ -1083,73 +1117,16 @@ double OGRCallAtofOnShortString(const char* pszStr)
 }
 
 /** Same contract as CPLAtof, except than it doesn't always call the
- *  system CPLAtof() that may be slow on some platforms. For simple but
- *  common strings, it'll use a faster implementation (up to 20x faster
- *  than CPLAtof() on MS runtime libraries) that has no garanty to return
- *  exactly the same floating point number.
+ *  system CPLAtof() that may be slow on some platforms if the number is
+ *  followed by other long content. The common decimal forms are converted
+ *  by the fast path of CPLStrtod(), that returns the same correctly rounded
+ *  value as the system strtod(), and the other ones on a short copy of the
+ *  number.
  */
  
 double OGRFastAtof(const char* pszStr)
 {
-    double dfVal = 0;
-    double dfSign = 1.0;
-    const char* p = pszStr;
-    
-    static const double adfTenPower[] =
-    {
-        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
-        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
-        1e21, 1e22, 1e23, 1e24, 1e25, 1e26, 1e27, 1e28, 1e29, 1e30, 1e31
-    };
-        
-    while(*p == ' ' || *p == '\t')
-        p++;
-
-    if (*p == '+')
-        p++;
-    else if (*p == '-')
-    {
-        dfSign = -1.0;
-        p++;
-    }
-    
-    while(TRUE)
-    {
-        if (*p >= '0' && *p <= '9')
-        {
-            dfVal = dfVal * 10.0 + (*p - '0');
-            p++;
-        }
-        else if (*p == '.')
-        {
-            p++;
-            break;
-        }
-        else if (*p == 'e' || *p == 'E' || *p == 'd' || *p == 'D')
-            return OGRCallAtofOnShortString(pszStr);
-        else
-            return dfSign * dfVal;
-    }
-    
-    unsigned int countFractionnal = 0;
-    while(TRUE)
-    {
-        if (*p >= '0' && *p <= '9')
-        {
-            dfVal = dfVal * 10.0 + (*p - '0');
-            countFractionnal ++;
-            p++;
-        }
-        else if (*p == 'e' || *p == 'E' || *p == 'd' || *p == 'D')
-            return OGRCallAtofOnShortString(pszStr);
-        else
-        {
-            if (countFractionnal < sizeof(adfTenPower) / sizeof(adfTenPower[0]))
-                return dfSign * (dfVal / adfTenPower[countFractionnal]);
-            else
-                return OGRCallAtofOnShortString(pszStr);
-        }
-    }
+    return OGRCallAtofOnShortString(pszStr);
 }
 
 /**
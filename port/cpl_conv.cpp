@@ -34,6 +34,7 @@
 #include "cpl_string.h"
 #include "cpl_vsi.h"
 #include "cpl_multiproc.h"
+#include "cpl_atomic_ops.h"
 #include <errno.h>
 
 CPL_CVSID("$Id$");
@@ -45,6 +46,24 @@ CPL_CVSID("$Id$");
 static CPLMutex *hConfigMutex = NULL;
 static volatile char **papszConfigOptions = NULL;
 
+/* Read-only hashed snapshot of papszConfigOptions, used by */
+/* CPLGetConfigOption() without taking hConfigMutex.  See */
+/* CPLConfigOptionTablePublish(). */
+typedef struct
+{
+    int         nMask;          /* number of slots - 1 */
+    char      **papszSlots;     /* "KEY=VALUE" strings, or NULL */
+} CPLConfigOptionTable;
+
+static CPLConfigOptionTable * volatile psConfigOptionTable = NULL;
+/* Readers announce themselves in the counter of the current epoch.  See */
+/* CPLConfigOptionWaitForReaders(). */
+static volatile int nConfigOptionEpoch = 0;
+static volatile int anConfigOptionReaders[2] = { 0, 0 };
+static void **papRetiredConfigOptions = NULL;
+static int nRetiredConfigOptions = 0;
+static int nRetiredConfigOptionsMax = 0;
+
 /* Used by CPLOpenShared() and friends */
 static CPLMutex *hSharedFileMutex = NULL;
 static volatile int nSharedFileCount = 0;
@@ -1570,6 +1589,170 @@ static void CPLAccessConfigOption(const char* pszKey, int bGet)
 }
 #endif
 
+/************************************************************************/
+/*                       CPLConfigOptionKeyHash()                       */
+/*                                                                      */
+/*      Case insensitive hash of a key, which ends at the end of the    */
+/*      string or at the '=' of a "KEY=VALUE" entry.                    */
+/************************************************************************/
+
+static unsigned int CPLConfigOptionKeyHash( const char *pszKey )
+
+{
+    unsigned int nHash = 0;
+
+    for( ; *pszKey != '\0' && *pszKey != '='; pszKey++ )
+        nHash = nHash * 31 + (unsigned char) toupper( *pszKey );
+
+    return nHash;
+}
+
+/************************************************************************/
+/*                     CPLConfigOptionTableLookup()                     */
+/************************************************************************/
+
+static const char *
+CPLConfigOptionTableLookup( const CPLConfigOptionTable *psTable,
+                            const char *pszKey )
+
+{
+    const size_t nKeyLen = strlen( pszKey );
+    int iSlot = (int) (CPLConfigOptionKeyHash( pszKey ) & psTable->nMask);
+
+    for( ; psTable->papszSlots[iSlot] != NULL;
+         iSlot = (iSlot + 1) & psTable->nMask )
+    {
+        const char *pszEntry = psTable->papszSlots[iSlot];
+        if( EQUALN( pszEntry, pszKey, nKeyLen ) && pszEntry[nKeyLen] == '=' )
+            return pszEntry + nKeyLen + 1;
+    }
+
+    return NULL;
+}
+
+/************************************************************************/
+/*                    CPLConfigOptionTableDestroy()                     */
+/************************************************************************/
+
+static void CPLConfigOptionTableDestroy( CPLConfigOptionTable *psTable )
+
+{
+    if( psTable != NULL )
+    {
+        CPLFree( psTable->papszSlots );
+        CPLFree( psTable );
+    }
+}
+
+/************************************************************************/
+/*                      CPLConfigOptionRetire()                         */
+/*                                                                      */
+/*      Defer the freeing of memory that readers of the previous        */
+/*      table may still access.  Called with hConfigMutex held.         */
+/************************************************************************/
+
+static void CPLConfigOptionRetire( void *pData )
+
+{
+    if( nRetiredConfigOptions == nRetiredConfigOptionsMax )
+    {
+        nRetiredConfigOptionsMax = nRetiredConfigOptionsMax * 2 + 16;
+        papRetiredConfigOptions = (void **)
+            CPLRealloc( papRetiredConfigOptions,
+                        sizeof(void*) * nRetiredConfigOptionsMax );
+    }
+    papRetiredConfigOptions[nRetiredConfigOptions++] = pData;
+}
+
+/************************************************************************/
+/*                    CPLConfigOptionWaitForReaders()                   */
+/*                                                                      */
+/*      Wait for the readers that may have seen the previous table.     */
+/*      Called with hConfigMutex held, after the new table is           */
+/*      published.                                                      */
+/*                                                                      */
+/*      Readers increment the counter of the epoch they read before     */
+/*      loading the table.  Once the epoch is flipped, new readers      */
+/*      use the other counter, so the counter of the previous epoch     */
+/*      only decreases and reaches zero even under a constant flow of   */
+/*      readers.  As a reader may increment the counter of an epoch     */
+/*      after it was flipped away, both counters are waited for.        */
+/************************************************************************/
+
+static void CPLConfigOptionWaitForReaders()
+
+{
+    for( int iPass = 0; iPass < 2; iPass++ )
+    {
+        const int iOldEpoch = nConfigOptionEpoch;
+
+        // The atomic operations are full memory barriers.
+        CPLAtomicAdd( &nConfigOptionEpoch, iOldEpoch == 0 ? 1 : -1 );
+        while( CPLAtomicAdd( &anConfigOptionReaders[iOldEpoch], 0 ) != 0 )
+            CPLSleep( 0.0 );
+    }
+}
+
+/************************************************************************/
+/*                     CPLConfigOptionTablePublish()                    */
+/*                                                                      */
+/*      Replace the hashed snapshot after papszConfigOptions has        */
+/*      changed.  Called with hConfigMutex held.                        */
+/*                                                                      */
+/*      Once the new table is published and the readers that may       */
+/*      have seen the previous one are gone, nobody can access the      */
+/*      previous table or the entries removed from it anymore, so       */
+/*      these are freed before returning.                               */
+/************************************************************************/
+
+static void CPLConfigOptionTablePublish()
+
+{
+    CPLConfigOptionTable *psNewTable = NULL;
+    const int nCount = CSLCount( (char **) papszConfigOptions );
+
+    if( nCount > 0 )
+    {
+        int nSlots = 16;
+        while( nSlots < 2 * nCount )
+            nSlots *= 2;
+
+        psNewTable = (CPLConfigOptionTable *)
+            CPLMalloc( sizeof(CPLConfigOptionTable) );
+        psNewTable->nMask = nSlots - 1;
+        psNewTable->papszSlots = (char **) CPLCalloc( nSlots, sizeof(char*) );
+
+        for( int i = 0; i < nCount; i++ )
+        {
+            char *pszEntry = (char *) papszConfigOptions[i];
+            int iSlot = (int) (CPLConfigOptionKeyHash( pszEntry )
+                               & psNewTable->nMask);
+            while( psNewTable->papszSlots[iSlot] != NULL )
+                iSlot = (iSlot + 1) & psNewTable->nMask;
+            psNewTable->papszSlots[iSlot] = pszEntry;
+        }
+    }
+
+    CPLConfigOptionTable *psOldTable = psConfigOptionTable;
+
+    // The atomic operations are full memory barriers: the content of the
+    // new table is visible before the pointer.
+    CPLAtomicAdd( &nConfigOptionEpoch, 0 );
+    psConfigOptionTable = psNewTable;
+
+    if( psOldTable != NULL )
+    {
+        CPLConfigOptionRetire( psOldTable->papszSlots );
+        CPLConfigOptionRetire( psOldTable );
+    }
+
+    CPLConfigOptionWaitForReaders();
+
+    for( int i = 0; i < nRetiredConfigOptions; i++ )
+        CPLFree( papRetiredConfigOptions[i] );
+    nRetiredConfigOptions = 0;
+}
+
 /************************************************************************/
 /*                         CPLGetConfigOption()                         */
 /************************************************************************/
@@ -1621,9 +1804,14 @@ CPLGetConfigOption( const char *pszKey, const char *pszDefault )
 
     if( pszResult == NULL )
     {
-        CPLMutexHolderD( &hConfigMutex );
+        const int iEpoch = nConfigOptionEpoch;
+        CPLAtomicInc( &anConfigOptionReaders[iEpoch] );
 
-        pszResult = CSLFetchNameValue( (char **) papszConfigOptions, pszKey );
+        const CPLConfigOptionTable *psTable = psConfigOptionTable;
+        if( psTable != NULL )
+            pszResult = CPLConfigOptionTableLookup( psTable, pszKey );
+
+        CPLAtomicDec( &anConfigOptionReaders[iEpoch] );
     }
 
 #if !defined(WIN32CE) 
@@ -1676,8 +1864,40 @@ CPLSetConfigOption( const char *pszKey, const char *pszValue )
 #endif
     CPLMutexHolderD( &hConfigMutex );
 
-    papszConfigOptions = (volatile char **) 
-        CSLSetNameValue( (char **) papszConfigOptions, pszKey, pszValue );
+/* -------------------------------------------------------------------- */
+/*      Update the list like CSLSetNameValue() would, except that the   */
+/*      replaced entry is retired rather than freed, as lock-less       */
+/*      readers may still access it.                                    */
+/* -------------------------------------------------------------------- */
+    char **papszList = (char **) papszConfigOptions;
+    const int iEntry = CSLFindName( papszList, pszKey );
+
+    if( iEntry >= 0 )
+    {
+        CPLConfigOptionRetire( papszList[iEntry] );
+        if( pszValue != NULL )
+        {
+            papszList[iEntry] = (char *)
+                CPLMalloc( strlen(pszKey) + strlen(pszValue) + 2 );
+            sprintf( papszList[iEntry], "%s=%s", pszKey, pszValue );
+        }
+        else
+        {
+            // Remove the entry, keeping the NULL terminator.
+            memmove( papszList + iEntry, papszList + iEntry + 1,
+                     sizeof(char*) * (CSLCount( papszList + iEntry + 1 ) + 1) );
+        }
+    }
+    else if( pszValue != NULL )
+    {
+        papszList = CSLAddNameValue( papszList, pszKey, pszValue );
+    }
+    else
+        return;
+
+    papszConfigOptions = (volatile char **) papszList;
+
+    CPLConfigOptionTablePublish();
 }
 
 /************************************************************************/
@@ -1741,6 +1961,15 @@ void CPL_STDCALL CPLFreeConfig()
 
         CSLDestroy( (char **) papszConfigOptions);
         papszConfigOptions = NULL;
+
+        CPLConfigOptionTableDestroy( psConfigOptionTable );
+        psConfigOptionTable = NULL;
+        for( int i = 0; i < nRetiredConfigOptions; i++ )
+            CPLFree( papRetiredConfigOptions[i] );
+        CPLFree( papRetiredConfigOptions );
+        papRetiredConfigOptions = NULL;
+        nRetiredConfigOptions = 0;
+        nRetiredConfigOptionsMax = 0;
         
         char **papszTLConfigOptions = (char **) CPLGetTLS( CTLS_CONFIGOPTIONS );
         if( papszTLConfigOptions != NULL )
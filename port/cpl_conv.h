@@ -88,6 +88,12 @@ double CPL_DLL CPLStrtodDelim(const char *, char **, char);
 float CPL_DLL CPLStrtof(const char *, char **);
 float CPL_DLL CPLStrtofDelim(const char *, char **, char);
 
+/* -------------------------------------------------------------------- */
+/*      Convert floating point number to the shortest ASCII string      */
+/*      that reads back as the same number (NOT LOCALE AWARE!).         */
+/* -------------------------------------------------------------------- */
+int CPL_DLL CPLDoubleToShortestString(double, char *, int);
+
 /* -------------------------------------------------------------------- */
 /*      Convert number to string.  This function is locale agnostic     */
 /*      (ie. it will support "," or "." regardless of current locale)   */
@@ -0,0 +1,465 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Shortest round-trip conversion of a double to a string, using
+ *           the Grisu2 algorithm of Florian Loitsch, "Printing Floating-Point
+ *           Numbers Quickly and Accurately with Integers", PLDI 2010.
+ *           Derived from the Grisu2 implementation of Milo Yip
+ *           (https://github.com/miloyip/dtoa-benchmark, src/milo/dtoa_milo.h,
+ *           also used by RapidJSON): DiyFp arithmetic, cached powers table,
+ *           digit generation and rounding.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2014, Milo Yip
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ******************************************************************************
+ * Original notice of dtoa_milo.h:
+ *
+ * Copyright (C) 2014 Milo Yip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_conv.h"
+
+CPL_CVSID("$Id$");
+
+#define CPL_DTOA_UINT64(hi, lo) ((((GUIntBig)(hi)) << 32) | (GUIntBig)(lo))
+
+/* Maximum number of characters written by CPLDoubleToShortestString(), */
+/* including the terminating nul character. */
+#define CPL_DTOA_MAX_LEN    32
+
+/************************************************************************/
+/*                              CPLDiyFp                                */
+/*                                                                      */
+/*      A floating point number with a 64 bit significand and no        */
+/*      normalization constraint: f * 2^e.                              */
+/************************************************************************/
+
+typedef struct
+{
+    GUIntBig f;
+    int      e;
+} CPLDiyFp;
+
+/* Normalized approximations of 10^-348, 10^-340, ..., 10^340 */
+static const GUIntBig anCachedPowersF[] =
+{
+    CPL_DTOA_UINT64(0xfa8fd5a0, 0x081c0288), CPL_DTOA_UINT64(0xbaaee17f, 0xa23ebf76), CPL_DTOA_UINT64(0x8b16fb20, 0x3055ac76),
+    CPL_DTOA_UINT64(0xcf42894a, 0x5dce35ea), CPL_DTOA_UINT64(0x9a6bb0aa, 0x55653b2d), CPL_DTOA_UINT64(0xe61acf03, 0x3d1a45df),
+    CPL_DTOA_UINT64(0xab70fe17, 0xc79ac6ca), CPL_DTOA_UINT64(0xff77b1fc, 0xbebcdc4f), CPL_DTOA_UINT64(0xbe5691ef, 0x416bd60c),
+    CPL_DTOA_UINT64(0x8dd01fad, 0x907ffc3c), CPL_DTOA_UINT64(0xd3515c28, 0x31559a83), CPL_DTOA_UINT64(0x9d71ac8f, 0xada6c9b5),
+    CPL_DTOA_UINT64(0xea9c2277, 0x23ee8bcb), CPL_DTOA_UINT64(0xaecc4991, 0x4078536d), CPL_DTOA_UINT64(0x823c1279, 0x5db6ce57),
+    CPL_DTOA_UINT64(0xc2109436, 0x4dfb5637), CPL_DTOA_UINT64(0x9096ea6f, 0x3848984f), CPL_DTOA_UINT64(0xd77485cb, 0x25823ac7),
+    CPL_DTOA_UINT64(0xa086cfcd, 0x97bf97f4), CPL_DTOA_UINT64(0xef340a98, 0x172aace5), CPL_DTOA_UINT64(0xb23867fb, 0x2a35b28e),
+    CPL_DTOA_UINT64(0x84c8d4df, 0xd2c63f3b), CPL_DTOA_UINT64(0xc5dd4427, 0x1ad3cdba), CPL_DTOA_UINT64(0x936b9fce, 0xbb25c996),
+    CPL_DTOA_UINT64(0xdbac6c24, 0x7d62a584), CPL_DTOA_UINT64(0xa3ab6658, 0x0d5fdaf6), CPL_DTOA_UINT64(0xf3e2f893, 0xdec3f126),
+    CPL_DTOA_UINT64(0xb5b5ada8, 0xaaff80b8), CPL_DTOA_UINT64(0x87625f05, 0x6c7c4a8b), CPL_DTOA_UINT64(0xc9bcff60, 0x34c13053),
+    CPL_DTOA_UINT64(0x964e858c, 0x91ba2655), CPL_DTOA_UINT64(0xdff97724, 0x70297ebd), CPL_DTOA_UINT64(0xa6dfbd9f, 0xb8e5b88f),
+    CPL_DTOA_UINT64(0xf8a95fcf, 0x88747d94), CPL_DTOA_UINT64(0xb9447093, 0x8fa89bcf), CPL_DTOA_UINT64(0x8a08f0f8, 0xbf0f156b),
+    CPL_DTOA_UINT64(0xcdb02555, 0x653131b6), CPL_DTOA_UINT64(0x993fe2c6, 0xd07b7fac), CPL_DTOA_UINT64(0xe45c10c4, 0x2a2b3b06),
+    CPL_DTOA_UINT64(0xaa242499, 0x697392d3), CPL_DTOA_UINT64(0xfd87b5f2, 0x8300ca0e), CPL_DTOA_UINT64(0xbce50864, 0x92111aeb),
+    CPL_DTOA_UINT64(0x8cbccc09, 0x6f5088cc), CPL_DTOA_UINT64(0xd1b71758, 0xe219652c), CPL_DTOA_UINT64(0x9c400000, 0x00000000),
+    CPL_DTOA_UINT64(0xe8d4a510, 0x00000000), CPL_DTOA_UINT64(0xad78ebc5, 0xac620000), CPL_DTOA_UINT64(0x813f3978, 0xf8940984),
+    CPL_DTOA_UINT64(0xc097ce7b, 0xc90715b3), CPL_DTOA_UINT64(0x8f7e32ce, 0x7bea5c70), CPL_DTOA_UINT64(0xd5d238a4, 0xabe98068),
+    CPL_DTOA_UINT64(0x9f4f2726, 0x179a2245), CPL_DTOA_UINT64(0xed63a231, 0xd4c4fb27), CPL_DTOA_UINT64(0xb0de6538, 0x8cc8ada8),
+    CPL_DTOA_UINT64(0x83c7088e, 0x1aab65db), CPL_DTOA_UINT64(0xc45d1df9, 0x42711d9a), CPL_DTOA_UINT64(0x924d692c, 0xa61be758),
+    CPL_DTOA_UINT64(0xda01ee64, 0x1a708dea), CPL_DTOA_UINT64(0xa26da399, 0x9aef774a), CPL_DTOA_UINT64(0xf209787b, 0xb47d6b85),
+    CPL_DTOA_UINT64(0xb454e4a1, 0x79dd1877), CPL_DTOA_UINT64(0x865b8692, 0x5b9bc5c2), CPL_DTOA_UINT64(0xc83553c5, 0xc8965d3d),
+    CPL_DTOA_UINT64(0x952ab45c, 0xfa97a0b3), CPL_DTOA_UINT64(0xde469fbd, 0x99a05fe3), CPL_DTOA_UINT64(0xa59bc234, 0xdb398c25),
+    CPL_DTOA_UINT64(0xf6c69a72, 0xa3989f5c), CPL_DTOA_UINT64(0xb7dcbf53, 0x54e9bece), CPL_DTOA_UINT64(0x88fcf317, 0xf22241e2),
+    CPL_DTOA_UINT64(0xcc20ce9b, 0xd35c78a5), CPL_DTOA_UINT64(0x98165af3, 0x7b2153df), CPL_DTOA_UINT64(0xe2a0b5dc, 0x971f303a),
+    CPL_DTOA_UINT64(0xa8d9d153, 0x5ce3b396), CPL_DTOA_UINT64(0xfb9b7cd9, 0xa4a7443c), CPL_DTOA_UINT64(0xbb764c4c, 0xa7a44410),
+    CPL_DTOA_UINT64(0x8bab8eef, 0xb6409c1a), CPL_DTOA_UINT64(0xd01fef10, 0xa657842c), CPL_DTOA_UINT64(0x9b10a4e5, 0xe9913129),
+    CPL_DTOA_UINT64(0xe7109bfb, 0xa19c0c9d), CPL_DTOA_UINT64(0xac2820d9, 0x623bf429), CPL_DTOA_UINT64(0x80444b5e, 0x7aa7cf85),
+    CPL_DTOA_UINT64(0xbf21e440, 0x03acdd2d), CPL_DTOA_UINT64(0x8e679c2f, 0x5e44ff8f), CPL_DTOA_UINT64(0xd433179d, 0x9c8cb841),
+    CPL_DTOA_UINT64(0x9e19db92, 0xb4e31ba9), CPL_DTOA_UINT64(0xeb96bf6e, 0xbadf77d9), CPL_DTOA_UINT64(0xaf87023b, 0x9bf0ee6b)
+};
+
+static const short anCachedPowersE[] =
+{
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066
+};
+
+static const GUIntBig anPow10[] =
+{
+    1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U, 100000000U,
+    1000000000U, CPL_DTOA_UINT64(0x00000002, 0x540be400) /* 10^10 */,
+    CPL_DTOA_UINT64(0x00000017, 0x4876e800), CPL_DTOA_UINT64(0x000000e8, 0xd4a51000),
+    CPL_DTOA_UINT64(0x00000918, 0x4e72a000), CPL_DTOA_UINT64(0x00005af3, 0x107a4000),
+    CPL_DTOA_UINT64(0x00038d7e, 0xa4c68000), CPL_DTOA_UINT64(0x002386f2, 0x6fc10000),
+    CPL_DTOA_UINT64(0x01634578, 0x5d8a0000), CPL_DTOA_UINT64(0x0de0b6b3, 0xa7640000),
+    CPL_DTOA_UINT64(0x8ac72304, 0x89e80000) /* 10^19 */
+};
+
+/************************************************************************/
+/*                          CPLDiyFpMultiply()                          */
+/*                                                                      */
+/*      Upper 64 bits of the 128 bit product, rounded.                  */
+/************************************************************************/
+
+static CPLDiyFp CPLDiyFpMultiply( const CPLDiyFp& a, const CPLDiyFp& b )
+
+{
+    const GUIntBig M32 = 0xFFFFFFFFU;
+    const GUIntBig a1 = a.f >> 32, a0 = a.f & M32;
+    const GUIntBig b1 = b.f >> 32, b0 = b.f & M32;
+    const GUIntBig p11 = a1 * b1, p10 = a1 * b0, p01 = a0 * b1, p00 = a0 * b0;
+    GUIntBig nMid = (p00 >> 32) + (p10 & M32) + (p01 & M32);
+    nMid += (GUIntBig)1U << 31; /* rounding */
+
+    CPLDiyFp r;
+    r.f = p11 + (p10 >> 32) + (p01 >> 32) + (nMid >> 32);
+    r.e = a.e + b.e + 64;
+    return r;
+}
+
+/************************************************************************/
+/*                         CPLDiyFpNormalize()                          */
+/************************************************************************/
+
+static CPLDiyFp CPLDiyFpNormalize( CPLDiyFp v )
+
+{
+    while( (v.f & CPL_DTOA_UINT64(0xFFC00000, 0)) == 0 )
+    {
+        v.f <<= 10;
+        v.e -= 10;
+    }
+    while( (v.f & CPL_DTOA_UINT64(0x80000000, 0)) == 0 )
+    {
+        v.f <<= 1;
+        v.e --;
+    }
+    return v;
+}
+
+/************************************************************************/
+/*                            CPLGrisuRound()                           */
+/*                                                                      */
+/*      Move the last digit down while the result stays in the          */
+/*      boundaries and gets closer to the exact value.                  */
+/************************************************************************/
+
+static void CPLGrisuRound( char *pszDigits, int nLen, GUIntBig nDelta,
+                           GUIntBig nRest, GUIntBig nTenKappa, GUIntBig nDist )
+
+{
+    while( nRest < nDist && nDelta - nRest >= nTenKappa &&
+           (nRest + nTenKappa < nDist ||
+            nDist - nRest > nRest + nTenKappa - nDist) )
+    {
+        pszDigits[nLen - 1] --;
+        nRest += nTenKappa;
+    }
+}
+
+/************************************************************************/
+/*                           CPLGrisuDigits()                           */
+/*                                                                      */
+/*      Generate the digits of a value in ]w-, w+[, w+ being the upper  */
+/*      boundary scaled by the cached power.                            */
+/************************************************************************/
+
+static int CPLGrisuDigits( const CPLDiyFp& W, const CPLDiyFp& Mp,
+                           GUIntBig nDelta, char *pszDigits, int *pnK )
+
+{
+    const int nShift = -Mp.e;
+    const GUIntBig nOne = (GUIntBig)1U << nShift;
+    const GUIntBig nDist = Mp.f - W.f;
+    GUInt32 p1 = (GUInt32) (Mp.f >> nShift);
+    GUIntBig p2 = Mp.f & (nOne - 1);
+    int nLen = 0;
+
+/* -------------------------------------------------------------------- */
+/*      Integral part.                                                  */
+/* -------------------------------------------------------------------- */
+    int nKappa = 1;
+    while( nKappa < 10 && p1 >= anPow10[nKappa] )
+        nKappa ++;
+
+    while( nKappa > 0 )
+    {
+        const GUInt32 nDiv = (GUInt32) anPow10[nKappa - 1];
+        const GUInt32 d = p1 / nDiv;
+        p1 %= nDiv;
+        if( d != 0 || nLen != 0 )
+            pszDigits[nLen++] = (char) ('0' + d);
+        nKappa --;
+
+        const GUIntBig nRest = ((GUIntBig) p1 << nShift) + p2;
+        if( nRest <= nDelta )
+        {
+            *pnK += nKappa;
+            CPLGrisuRound( pszDigits, nLen, nDelta, nRest,
+                           anPow10[nKappa] << nShift, nDist );
+            return nLen;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Fractional part.                                                */
+/* -------------------------------------------------------------------- */
+    for( ;; )
+    {
+        p2 *= 10;
+        nDelta *= 10;
+        const int d = (int) (p2 >> nShift);
+        if( d != 0 || nLen != 0 )
+            pszDigits[nLen++] = (char) ('0' + d);
+        p2 &= nOne - 1;
+        nKappa --;
+        if( p2 < nDelta )
+        {
+            *pnK += nKappa;
+            CPLGrisuRound( pszDigits, nLen, nDelta, p2, nOne,
+                           (-nKappa < 20) ? nDist * anPow10[-nKappa] : 0 );
+            return nLen;
+        }
+    }
+}
+
+/************************************************************************/
+/*                              CPLGrisu2()                             */
+/*                                                                      */
+/*      Compute the digits of a strictly positive finite value, so      */
+/*      that it is equal to digits * 10^K once read back.               */
+/************************************************************************/
+
+static int CPLGrisu2( double dfVal, char *pszDigits, int *pnK )
+
+{
+    GUIntBig nBits;
+    memcpy( &nBits, &dfVal, sizeof(nBits) );
+
+    const GUIntBig nHiddenBit = CPL_DTOA_UINT64(0x00100000, 0);
+    const int nBiasedExp = (int) ((nBits >> 52) & 0x7FF);
+    CPLDiyFp v;
+    v.f = nBits & (nHiddenBit - 1);
+    if( nBiasedExp != 0 )
+    {
+        v.f += nHiddenBit;
+        v.e = nBiasedExp - 1075;
+    }
+    else
+        v.e = -1074;
+
+/* -------------------------------------------------------------------- */
+/*      Boundaries halfway to the neighbouring doubles, the lower one   */
+/*      being closer when v is a power of two.                          */
+/* -------------------------------------------------------------------- */
+    CPLDiyFp oPlus, oMinus;
+    oPlus.f = (v.f << 1) + 1;
+    oPlus.e = v.e - 1;
+    oPlus = CPLDiyFpNormalize( oPlus );
+    if( v.f == nHiddenBit )
+    {
+        oMinus.f = (v.f << 2) - 1;
+        oMinus.e = v.e - 2;
+    }
+    else
+    {
+        oMinus.f = (v.f << 1) - 1;
+        oMinus.e = v.e - 1;
+    }
+    oMinus.f <<= oMinus.e - oPlus.e;
+    oMinus.e = oPlus.e;
+
+/* -------------------------------------------------------------------- */
+/*      Cached power c such that the scaled upper boundary has its      */
+/*      binary exponent in [-60, -32].                                  */
+/* -------------------------------------------------------------------- */
+    const double dfK = (-61 - oPlus.e) * 0.30102999566398114 + 347;
+    int k = (int) dfK;
+    if( dfK - k > 0.0 )
+        k ++;
+    const int iIndex = (k >> 3) + 1;
+    *pnK = -(-348 + iIndex * 8);
+
+    CPLDiyFp oCached;
+    oCached.f = anCachedPowersF[iIndex];
+    oCached.e = anCachedPowersE[iIndex];
+
+    const CPLDiyFp W = CPLDiyFpMultiply( CPLDiyFpNormalize( v ), oCached );
+    CPLDiyFp Wp = CPLDiyFpMultiply( oPlus, oCached );
+    CPLDiyFp Wm = CPLDiyFpMultiply( oMinus, oCached );
+    Wm.f ++;
+    Wp.f --;
+
+    return CPLGrisuDigits( W, Wp, Wp.f - Wm.f, pszDigits, pnK );
+}
+
+/************************************************************************/
+/*                     CPLDoubleToShortestString()                      */
+/************************************************************************/
+
+/**
+ * Converts a double to the shortest string that reads back as the same
+ * double.
+ *
+ * The digits are computed with the Grisu2 algorithm, which always produces
+ * a string that round-trips through CPLStrtod(), and the shortest one in the
+ * vast majority of cases. The value is written in fixed notation when its
+ * decimal exponent is in [-6, 20], e.g. "123.25", "1000" or "0.0001",
+ * and in exponential notation otherwise, e.g. "1e+21" or "1.5e-10".
+ * Infinite and NaN values are written as "inf", "-inf" and "nan". The
+ * decimal delimiter is always '.', regardless of the locale.
+ *
+ * @param dfVal the value to convert.
+ * @param pszBuffer the output buffer.
+ * @param nBufferLen the size of the output buffer. 32 bytes are always enough.
+ *
+ * @return the length of the string, or -1 if the buffer is too small.
+ *
+ * @since GDAL 2.0
+ */
+
+int CPLDoubleToShortestString( double dfVal, char *pszBuffer, int nBufferLen )
+
+{
+    char szOut[CPL_DTOA_MAX_LEN];
+    int nOut = 0;
+
+    GUIntBig nBits;
+    memcpy( &nBits, &dfVal, sizeof(nBits) );
+    if( nBits >> 63 )
+    {
+        szOut[nOut++] = '-';
+        nBits &= ~(CPL_DTOA_UINT64(0x80000000, 0));
+        memcpy( &dfVal, &nBits, sizeof(nBits) );
+    }
+
+    if( ((nBits >> 52) & 0x7FF) == 0x7FF )
+    {
+        if( (nBits & CPL_DTOA_UINT64(0x000FFFFF, 0xFFFFFFFF)) != 0 )
+        {
+            nOut = 0; /* no sign for NaN */
+            memcpy( szOut, "nan", 3 );
+        }
+        else
+            memcpy( szOut + nOut, "inf", 3 );
+        nOut += 3;
+    }
+    else if( dfVal == 0.0 )
+    {
+        szOut[nOut++] = '0';
+    }
+    else
+    {
+        char szDigits[20];
+        int nK = 0;
+        const int nLen = CPLGrisu2( dfVal, szDigits, &nK );
+
+        /* Position of the decimal point relatively to the first digit */
+        const int nPoint = nLen + nK;
+
+        if( nK >= 0 && nPoint <= 21 )
+        {
+            /* Integer: 1234e7 -> 12340000000 */
+            memcpy( szOut + nOut, szDigits, nLen );
+            nOut += nLen;
+            for( int i = 0; i < nK; i++ )
+                szOut[nOut++] = '0';
+        }
+        else if( nPoint > 0 && nPoint <= 21 )
+        {
+            /* 1234e-2 -> 12.34 */
+            memcpy( szOut + nOut, szDigits, nPoint );
+            nOut += nPoint;
+            szOut[nOut++] = '.';
+            memcpy( szOut + nOut, szDigits + nPoint, nLen - nPoint );
+            nOut += nLen - nPoint;
+        }
+        else if( nPoint > -6 && nPoint <= 0 )
+        {
+            /* 1234e-6 -> 0.001234 */
+            szOut[nOut++] = '0';
+            szOut[nOut++] = '.';
+            for( int i = nPoint; i < 0; i++ )
+                szOut[nOut++] = '0';
+            memcpy( szOut + nOut, szDigits, nLen );
+            nOut += nLen;
+        }
+        else
+        {
+            /* 1234e30 -> 1.234e+33 */
+            szOut[nOut++] = szDigits[0];
+            if( nLen > 1 )
+            {
+                szOut[nOut++] = '.';
+                memcpy( szOut + nOut, szDigits + 1, nLen - 1 );
+                nOut += nLen - 1;
+            }
+            int nExp = nPoint - 1;
+            szOut[nOut++] = 'e';
+            if( nExp < 0 )
+            {
+                szOut[nOut++] = '-';
+                nExp = -nExp;
+            }
+            else
+                szOut[nOut++] = '+';
+            if( nExp >= 100 )
+            {
+                szOut[nOut++] = (char) ('0' + nExp / 100);
+                nExp %= 100;
+                szOut[nOut++] = (char) ('0' + nExp / 10);
+            }
+            else if( nExp >= 10 )
+                szOut[nOut++] = (char) ('0' + nExp / 10);
+            szOut[nOut++] = (char) ('0' + nExp % 10);
+        }
+    }
+
+    if( nOut >= nBufferLen )
+        return -1;
+    memcpy( pszBuffer, szOut, nOut );
+    pszBuffer[nOut] = '\0';
+    return nOut;
+}
@@ -30,28 +30,45 @@
 
 #include "cpl_conv.h"
 #include "cpl_hash_set.h"
-#include "cpl_list.h"
+
+/* The elements are stored in a CPLRobinHoodHashSet of pointers, calling */
+/* the functions provided by the user. */
+
+class CPLHashSetHashFunctor
+{
+  public:
+    CPLHashSetHashFunc fnHashFunc;
+
+    CPLHashSetHashFunctor( CPLHashSetHashFunc fnHashFuncIn ) :
+        fnHashFunc( fnHashFuncIn ) {}
+    unsigned long operator()( const void *elt ) const
+        { return fnHashFunc( elt ); }
+};
+
+class CPLHashSetEqualFunctor
+{
+  public:
+    CPLHashSetEqualFunc fnEqualFunc;
+
+    CPLHashSetEqualFunctor( CPLHashSetEqualFunc fnEqualFuncIn ) :
+        fnEqualFunc( fnEqualFuncIn ) {}
+    bool operator()( const void *elt1, const void *elt2 ) const
+        { return fnEqualFunc( elt1, elt2 ) != FALSE; }
+};
+
+typedef CPLRobinHoodHashSet<void*, CPLHashSetHashFunctor,
+                            CPLHashSetEqualFunctor> CPLHashSetImpl;
 
 struct _CPLHashSet
 {
-    CPLHashSetHashFunc    fnHashFunc;
-    CPLHashSetEqualFunc   fnEqualFunc;
     CPLHashSetFreeEltFunc fnFreeEltFunc;
-    CPLList**             tabList;
-    int                   nSize;
-    int                   nIndiceAllocatedSize;
-    int                   nAllocatedSize;
-#ifdef HASH_DEBUG
-    int                   nCollisions;
-#endif
-};
+    CPLHashSetImpl        oSet;
 
-static const int anPrimes[] = 
-{ 53, 97, 193, 389, 769, 1543, 3079, 6151,
-  12289, 24593, 49157, 98317, 196613, 393241,
-  786433, 1572869, 3145739, 6291469, 12582917,
-  25165843, 50331653, 100663319, 201326611,
-  402653189, 805306457, 1610612741 };
+    _CPLHashSet( CPLHashSetHashFunc fnHashFunc,
+                 CPLHashSetEqualFunc fnEqualFunc ) :
+        oSet( CPLHashSetHashFunctor( fnHashFunc ),
+              CPLHashSetEqualFunctor( fnEqualFunc ) ) {}
+};
 
 /************************************************************************/
 /*                          CPLHashSetNew()                             */
@@ -81,17 +98,10 @@ CPLHashSet* CPLHashSetNew(CPLHashSetHashFunc fnHashFunc,
                           CPLHashSetEqualFunc fnEqualFunc,
                           CPLHashSetFreeEltFunc fnFreeEltFunc)
 {
-    CPLHashSet* set = (CPLHashSet*) CPLMalloc(sizeof(CPLHashSet));
-    set->fnHashFunc = (fnHashFunc) ? fnHashFunc : CPLHashSetHashPointer;
-    set->fnEqualFunc = (fnEqualFunc) ? fnEqualFunc : CPLHashSetEqualPointer;
+    CPLHashSet* set = new CPLHashSet(
+        (fnHashFunc) ? fnHashFunc : CPLHashSetHashPointer,
+        (fnEqualFunc) ? fnEqualFunc : CPLHashSetEqualPointer );
     set->fnFreeEltFunc = fnFreeEltFunc;
-    set->nSize = 0;
-    set->tabList = (CPLList**) CPLCalloc(sizeof(CPLList*), 53);
-    set->nIndiceAllocatedSize = 0;
-    set->nAllocatedSize = 53;
-#ifdef HASH_DEBUG
-    set->nCollisions = 0;
-#endif
     return set;
 }
 
@@ -113,13 +123,21 @@ CPLHashSet* CPLHashSetNew(CPLHashSetHashFunc fnHashFunc,
 int CPLHashSetSize(const CPLHashSet* set)
 {
     CPLAssert(set != NULL);
-    return set->nSize;
+    return set->oSet.Size();
 }
 
 /************************************************************************/
 /*                        CPLHashSetDestroy()                           */
 /************************************************************************/
 
+class CPLHashSetFreeFunctor
+{
+  public:
+    CPLHashSetFreeEltFunc fnFreeEltFunc;
+
+    bool operator()( void *elt ) { fnFreeEltFunc( elt ); return true; }
+};
+
 /**
  * Destroys an allocated hash set.
  *
@@ -132,27 +150,27 @@ int CPLHashSetSize(const CPLHashSet* set)
 void CPLHashSetDestroy(CPLHashSet* set)
 {
     CPLAssert(set != NULL);
-    for(int i=0;i<set->nAllocatedSize;i++)
+    if (set->fnFreeEltFunc)
     {
-        if (set->fnFreeEltFunc)
-        {
-            CPLList* cur = set->tabList[i];
-            while(cur)
-            {
-                set->fnFreeEltFunc(cur->pData);
-                cur = cur->psNext;
-            }
-        }
-        CPLListDestroy(set->tabList[i]);
+        CPLHashSetFreeFunctor oFree;
+        oFree.fnFreeEltFunc = set->fnFreeEltFunc;
+        set->oSet.Foreach( oFree );
     }
-    CPLFree(set->tabList);
-    CPLFree(set);
+    delete set;
 }
 
 /************************************************************************/
 /*                       CPLHashSetForeach()                            */
 /************************************************************************/
 
+class CPLHashSetIterFunctor
+{
+  public:
+    CPLHashSetIterEltFunc fnIterFunc;
+    void                 *user_data;
+
+    bool operator()( void *elt ) { return fnIterFunc( elt, user_data ) != FALSE; }
+};
 
 /**
  * Walk through the hash set and runs the provided function on all the
@@ -177,68 +195,10 @@ void  CPLHashSetForeach(CPLHashSet* set,
     CPLAssert(set != NULL);
     if (!fnIterFunc) return;
 
-    for(int i=0;i<set->nAllocatedSize;i++)
-    {
-        CPLList* cur = set->tabList[i];
-        while(cur)
-        {
-            if (fnIterFunc(cur->pData, user_data) == FALSE)
-                return;
-
-            cur = cur->psNext;
-        }
-    }
-}
-
-/************************************************************************/
-/*                        CPLHashSetRehash()                            */
-/************************************************************************/
-
-static void CPLHashSetRehash(CPLHashSet* set)
-{
-    int nNewAllocatedSize = anPrimes[set->nIndiceAllocatedSize];
-    CPLList** newTabList = (CPLList**) CPLCalloc(sizeof(CPLList*), nNewAllocatedSize);
-#ifdef HASH_DEBUG
-    CPLDebug("CPLHASH", "hashSet=%p, nSize=%d, nCollisions=%d, fCollisionRate=%.02f",
-             set, set->nSize, set->nCollisions, set->nCollisions * 100.0 / set->nSize);
-    set->nCollisions = 0;
-#endif
-    for(int i=0;i<set->nAllocatedSize;i++)
-    {
-        CPLList* cur = set->tabList[i];
-        while(cur)
-        {
-            unsigned long nNewHashVal = set->fnHashFunc(cur->pData) % nNewAllocatedSize;
-#ifdef HASH_DEBUG
-            if (newTabList[nNewHashVal])
-                set->nCollisions ++;
-#endif
-            newTabList[nNewHashVal] = CPLListInsert(newTabList[nNewHashVal], cur->pData, 0);
-            cur = cur->psNext;
-        }
-        CPLListDestroy(set->tabList[i]);
-    }
-    CPLFree(set->tabList);
-    set->tabList = newTabList;
-    set->nAllocatedSize = nNewAllocatedSize;
-}
-
-
-/************************************************************************/
-/*                        CPLHashSetFindPtr()                           */
-/************************************************************************/
-
-static void** CPLHashSetFindPtr(CPLHashSet* set, const void* elt)
-{
-    unsigned long nHashVal = set->fnHashFunc(elt) % set->nAllocatedSize;
-    CPLList* cur = set->tabList[nHashVal];
-    while(cur)
-    {
-        if (set->fnEqualFunc(cur->pData, elt))
-            return &cur->pData;
-        cur = cur->psNext;
-    }
-    return NULL;
+    CPLHashSetIterFunctor oIter;
+    oIter.fnIterFunc = fnIterFunc;
+    oIter.user_data = user_data;
+    set->oSet.Foreach( oIter );
 }
 
 /************************************************************************/
@@ -261,31 +221,13 @@ static void** CPLHashSetFindPtr(CPLHashSet* set, const void* elt)
 int CPLHashSetInsert(CPLHashSet* set, void* elt)
 {
     CPLAssert(set != NULL);
-    void** pElt = CPLHashSetFindPtr(set, elt);
-    if (pElt)
-    {
-        if (set->fnFreeEltFunc)
-            set->fnFreeEltFunc(*pElt);
-
-        *pElt = elt;
-        return FALSE;
-    }
-
-    if (set->nSize >= 2 * set->nAllocatedSize / 3)
-    {
-        set->nIndiceAllocatedSize++;
-        CPLHashSetRehash(set);
-    }
-
-    unsigned long nHashVal = set->fnHashFunc(elt) % set->nAllocatedSize;
-#ifdef HASH_DEBUG
-    if (set->tabList[nHashVal])
-        set->nCollisions ++;
-#endif
-    set->tabList[nHashVal] = CPLListInsert(set->tabList[nHashVal], (void*) elt, 0);
-    set->nSize++;
+    void* old_elt = NULL;
+    if (set->oSet.Insert(elt, &old_elt))
+        return TRUE;
 
-    return TRUE;
+    if (set->fnFreeEltFunc && old_elt != elt)
+        set->fnFreeEltFunc(old_elt);
+    return FALSE;
 }
 
 /************************************************************************/
@@ -305,7 +247,7 @@ int CPLHashSetInsert(CPLHashSet* set, void* elt)
 void* CPLHashSetLookup(CPLHashSet* set, const void* elt)
 {
     CPLAssert(set != NULL);
-    void** pElt = CPLHashSetFindPtr(set, elt);
+    void** pElt = set->oSet.Lookup((void*) elt);
     if (pElt)
         return *pElt;
     else
@@ -328,40 +270,13 @@ void* CPLHashSetLookup(CPLHashSet* set, const void* elt)
 int CPLHashSetRemove(CPLHashSet* set, const void* elt)
 {
     CPLAssert(set != NULL);
-    if (set->nIndiceAllocatedSize > 0 && set->nSize <= set->nAllocatedSize / 2)
-    {
-        set->nIndiceAllocatedSize--;
-        CPLHashSetRehash(set);
-    }
+    void* old_elt = NULL;
+    if (!set->oSet.Remove((void*) elt, &old_elt))
+        return FALSE;
 
-    int nHashVal = set->fnHashFunc(elt) % set->nAllocatedSize;
-    CPLList* cur = set->tabList[nHashVal];
-    CPLList* prev = NULL;
-    while(cur)
-    {
-        if (set->fnEqualFunc(cur->pData, elt))
-        {
-            if (prev)
-                prev->psNext = cur->psNext;
-            else
-                set->tabList[nHashVal] = cur->psNext;
-
-            if (set->fnFreeEltFunc)
-                set->fnFreeEltFunc(cur->pData);
-
-            CPLFree(cur);
-#ifdef HASH_DEBUG
-            if (set->tabList[nHashVal])
-                set->nCollisions --;
-#endif
-
-            set->nSize--;
-            return TRUE;
-        }
-        prev = cur;
-        cur = cur->psNext;
-    }
-    return FALSE;
+    if (set->fnFreeEltFunc)
+        set->fnFreeEltFunc(old_elt);
+    return TRUE;
 }
 
 
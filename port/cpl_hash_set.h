@@ -88,5 +88,227 @@ int          CPL_DLL CPLHashSetEqualStr(const void* pszStr1, const void* pszStr2
 
 CPL_C_END
 
+#ifdef __cplusplus
+
+#include "cpl_conv.h"
+
+/************************************************************************/
+/*                         CPLRobinHoodHashSet                          */
+/************************************************************************/
+
+/**
+ * Typed hash set, used to implement CPLHashSet.
+ *
+ * Elements are stored by value in an open addressing table, with Robin
+ * Hood probing and backward shift deletion, along with a 32 bit digest of
+ * their hash so that most unsuccessful comparisons do not touch the
+ * elements.  The number of slots is a power of two, and the table is
+ * kept at most 3/4 full.
+ *
+ * HashFunc and EqualFunc are function objects taking elements: the first
+ * one returns an unsigned long hash, that does not need to be well mixed,
+ * the second one returns whether two elements are equal.  T must be
+ * default constructible and copyable.
+ *
+ * Pointers returned by Lookup() become invalid after the next insertion
+ * or removal.
+ */
+
+template<class T, class HashFunc, class EqualFunc> class CPLRobinHoodHashSet
+{
+    HashFunc      oHashFunc;
+    EqualFunc     oEqualFunc;
+    GUInt32      *panDigest;    /* 0 for an empty slot */
+    T            *paoElts;
+    GUInt32       nMask;
+    int           nSize;
+
+    GUInt32       Digest( const T& oElt ) const
+    {
+        /* Finalizer of MurmurHash3, so that hashes that only differ */
+        /* in their high bits, like aligned pointers, spread well. */
+        GUIntBig nHash64 = (GUIntBig) oHashFunc( oElt );
+        GUInt32 nHash = (GUInt32) (nHash64 ^ (nHash64 >> 32));
+        nHash ^= nHash >> 16;
+        nHash *= 0x85ebca6bU;
+        nHash ^= nHash >> 13;
+        nHash *= 0xc2b2ae35U;
+        nHash ^= nHash >> 16;
+        return nHash | 0x80000000U;
+    }
+
+    GUInt32       ProbeDistance( GUInt32 iSlot ) const
+    {
+        return (iSlot - panDigest[iSlot]) & nMask;
+    }
+
+    int           Find( const T& oElt, GUInt32 nDigest ) const
+    {
+        GUInt32 iSlot = nDigest & nMask;
+        for( GUInt32 nDist = 0; panDigest[iSlot] != 0; nDist++ )
+        {
+            if( nDist > ProbeDistance( iSlot ) )
+                break;
+            if( panDigest[iSlot] == nDigest
+                && oEqualFunc( paoElts[iSlot], oElt ) )
+                return (int) iSlot;
+            iSlot = (iSlot + 1) & nMask;
+        }
+        return -1;
+    }
+
+    void          Place( T oElt, GUInt32 nDigest )
+    {
+        GUInt32 iSlot = nDigest & nMask;
+        GUInt32 nDist = 0;
+        while( panDigest[iSlot] != 0 )
+        {
+            /* Take the place of elements closer to their home slot. */
+            GUInt32 nSlotDist = ProbeDistance( iSlot );
+            if( nSlotDist < nDist )
+            {
+                T oTmp = paoElts[iSlot];
+                paoElts[iSlot] = oElt;
+                oElt = oTmp;
+                GUInt32 nTmp = panDigest[iSlot];
+                panDigest[iSlot] = nDigest;
+                nDigest = nTmp;
+                nDist = nSlotDist;
+            }
+            iSlot = (iSlot + 1) & nMask;
+            nDist++;
+        }
+        panDigest[iSlot] = nDigest;
+        paoElts[iSlot] = oElt;
+    }
+
+    void          Resize( GUInt32 nSlots )
+    {
+        GUInt32 *panOldDigest = panDigest;
+        T *paoOldElts = paoElts;
+        GUInt32 nOldSlots = nMask + 1;
+
+        panDigest = (GUInt32 *) CPLCalloc( nSlots, sizeof(GUInt32) );
+        paoElts = new T[nSlots];
+        nMask = nSlots - 1;
+
+        for( GUInt32 i = 0; i < nOldSlots; i++ )
+        {
+            if( panOldDigest[i] != 0 )
+                Place( paoOldElts[i], panOldDigest[i] );
+        }
+
+        CPLFree( panOldDigest );
+        delete[] paoOldElts;
+    }
+
+    /* Non copyable. */
+    CPLRobinHoodHashSet( const CPLRobinHoodHashSet& );
+    CPLRobinHoodHashSet& operator=( const CPLRobinHoodHashSet& );
+
+  public:
+    enum { MIN_SLOTS = 16 };
+
+    CPLRobinHoodHashSet( HashFunc oHashFuncIn = HashFunc(),
+                         EqualFunc oEqualFuncIn = EqualFunc() ) :
+        oHashFunc( oHashFuncIn ), oEqualFunc( oEqualFuncIn ),
+        panDigest( (GUInt32 *) CPLCalloc( MIN_SLOTS, sizeof(GUInt32) ) ),
+        paoElts( new T[MIN_SLOTS] ), nMask( MIN_SLOTS - 1 ), nSize( 0 ) {}
+
+    ~CPLRobinHoodHashSet()
+    {
+        CPLFree( panDigest );
+        delete[] paoElts;
+    }
+
+    /** Number of elements. */
+    int           Size() const { return nSize; }
+
+    /** Return the stored element equal to oElt, or NULL. */
+    T            *Lookup( const T& oElt )
+    {
+        int iSlot = Find( oElt, Digest( oElt ) );
+        return iSlot < 0 ? NULL : &paoElts[iSlot];
+    }
+
+    /**
+     * Insert an element, or replace the stored element equal to it, in
+     * which case the replaced element is returned in *poReplaced if not
+     * NULL.
+     *
+     * @return true if the element was not in the set.
+     */
+    bool          Insert( const T& oElt, T *poReplaced = NULL )
+    {
+        GUInt32 nDigest = Digest( oElt );
+        int iSlot = Find( oElt, nDigest );
+        if( iSlot >= 0 )
+        {
+            if( poReplaced != NULL )
+                *poReplaced = paoElts[iSlot];
+            paoElts[iSlot] = oElt;
+            return false;
+        }
+
+        if( (GUInt32) (nSize + 1) * 4 > (nMask + 1) * 3 )
+            Resize( (nMask + 1) * 2 );
+
+        Place( oElt, nDigest );
+        nSize++;
+        return true;
+    }
+
+    /**
+     * Remove the element equal to oElt, which is returned in *poRemoved if
+     * not NULL.
+     *
+     * @return true if the element was in the set.
+     */
+    bool          Remove( const T& oElt, T *poRemoved = NULL )
+    {
+        int iFound = Find( oElt, Digest( oElt ) );
+        if( iFound < 0 )
+            return false;
+
+        GUInt32 iSlot = (GUInt32) iFound;
+        if( poRemoved != NULL )
+            *poRemoved = paoElts[iSlot];
+
+        /* Shift back the following elements of the cluster, rather */
+        /* than leaving a tombstone. */
+        GUInt32 iNext = (iSlot + 1) & nMask;
+        while( panDigest[iNext] != 0 && ProbeDistance( iNext ) != 0 )
+        {
+            panDigest[iSlot] = panDigest[iNext];
+            paoElts[iSlot] = paoElts[iNext];
+            iSlot = iNext;
+            iNext = (iNext + 1) & nMask;
+        }
+        panDigest[iSlot] = 0;
+        paoElts[iSlot] = T();
+        nSize--;
+
+        if( nMask + 1 > MIN_SLOTS && (GUInt32) nSize * 8 < nMask + 1 )
+            Resize( (nMask + 1) / 2 );
+
+        return true;
+    }
+
+    /**
+     * Call oFunc on each element, until it returns false.  The set must
+     * not be modified during the walk.
+     */
+    template<class IterFunc> void Foreach( IterFunc& oFunc )
+    {
+        for( GUInt32 i = 0; i <= nMask; i++ )
+        {
+            if( panDigest[i] != 0 && !oFunc( paoElts[i] ) )
+                return;
+        }
+    }
+};
+
+#endif /* __cplusplus */
+
 #endif /* _CPL_HASH_SET_H_INCLUDED */
 
@@ -60,12 +60,6 @@ typedef enum {
     TLiteral
 } XMLTokenType;
 
-typedef struct
-{
-    CPLXMLNode *psFirstNode;
-    CPLXMLNode *psLastChild;
-} StackContext;
-
 typedef struct {
     const char *pszInput;
     int        nInputOffset;
@@ -76,13 +70,51 @@ typedef struct {
     size_t     nTokenMaxSize;
     size_t     nTokenSize;
 
+    /* Names of the currently open elements, stored one after the other */
+    /* in pszNames at the offsets listed in panNameOffsets. */
+    int        nStackMaxSize;
+    int        nStackSize;
+    size_t     *panNameOffsets;
+    char       *pszNames;
+    size_t     nNamesMaxSize;
+    size_t     nNamesSize;
+} ParseContext;
+
+typedef struct
+{
+    CPLXMLNode *psFirstNode;
+    CPLXMLNode *psLastChild;
+} StackContext;
+
+/* Header of the blocks holding the nodes of a tree built by */
+/* CPLParseXMLStringInArena().  The root node is the first allocation */
+/* of the first block, right after its header. */
+typedef struct _CPLXMLArenaBlock
+{
+    unsigned int nMagic;
+    size_t      nSize;
+    size_t      nUsed;
+    struct _CPLXMLArenaBlock *psNext;
+} CPLXMLArenaBlock;
+
+#define ARENA_MAGIC             0x584D4C41 /* "XMLA" */
+#define ARENA_HEADER_SIZE       ((sizeof(CPLXMLArenaBlock) + 7) & ~((size_t)7))
+#define ARENA_MIN_BLOCK_SIZE    4096
+#define ARENA_MAX_BLOCK_SIZE    (16 * 1024 * 1024)
+
+typedef struct {
     int        nStackMaxSize;
     int        nStackSize;
     StackContext *papsStack;
 
     CPLXMLNode *psFirstNode;
     CPLXMLNode *psLastNode;
-} ParseContext;
+
+    int        bUseArena;
+    CPLXMLArenaBlock *psFirstBlock;
+    CPLXMLArenaBlock *psCurBlock;
+    size_t     nNextBlockSize;
+} TreeBuilder;
 
 static CPLXMLNode *_CPLCreateXMLNode( CPLXMLNode *poParent, CPLXMLNodeType eType, 
                                       const char *pszText );
@@ -129,6 +161,30 @@ static CPL_INLINE void UnreadChar( ParseContext *psContext, char chToUnread )
     }
 }
 
+/************************************************************************/
+/*                             SkipUntil()                              */
+/*                                                                      */
+/*      Advance over the characters up to, but not including, the       */
+/*      first occurence of chStop (or of the end of input), and         */
+/*      return how many were skipped.                                   */
+/************************************************************************/
+
+static CPL_INLINE size_t SkipUntil( ParseContext *psContext, char chStop )
+
+{
+    const char *pszStart = psContext->pszInput + psContext->nInputOffset;
+    const char *pszIter = pszStart;
+
+    for( ; *pszIter != chStop && *pszIter != '\0'; pszIter++ )
+    {
+        if( *pszIter == 10 )
+            psContext->nInputLine++;
+    }
+
+    psContext->nInputOffset += (int) (pszIter - pszStart);
+    return (size_t) (pszIter - pszStart);
+}
+
 /************************************************************************/
 /*                           ReallocToken()                             */
 /************************************************************************/
@@ -179,6 +235,49 @@ static CPL_INLINE int _AddToToken( ParseContext *psContext, char chNewChar )
 
 #define AddToToken(psContext, chNewChar) if (!_AddToToken(psContext, chNewChar)) goto fail;
 
+/************************************************************************/
+/*                            AddToTokenN()                             */
+/*                                                                      */
+/*      Append a run of characters of the input to the token.           */
+/************************************************************************/
+
+static int _AddToTokenN( ParseContext *psContext, const char *pachChars,
+                         size_t nChars )
+
+{
+    while( psContext->nTokenSize + nChars + 2 > psContext->nTokenMaxSize )
+    {
+        if (!ReallocToken(psContext))
+            return FALSE;
+    }
+
+    memcpy( psContext->pszToken + psContext->nTokenSize, pachChars, nChars );
+    psContext->nTokenSize += nChars;
+    psContext->pszToken[psContext->nTokenSize] = '\0';
+    return TRUE;
+}
+
+#define AddToTokenN(psContext, pachChars, nChars) if (!_AddToTokenN(psContext, pachChars, nChars)) goto fail;
+
+/************************************************************************/
+/*                          UnescapeToken()                             */
+/************************************************************************/
+
+static void UnescapeToken( ParseContext *psContext )
+
+{
+    /* Do we need to unescape it? */
+    if( memchr(psContext->pszToken, '&', psContext->nTokenSize) != NULL )
+    {
+        int  nLength;
+        char *pszUnescaped = CPLUnescapeString( psContext->pszToken, 
+                                                &nLength, CPLES_XML );
+        strcpy( psContext->pszToken, pszUnescaped );
+        CPLFree( pszUnescaped );
+        psContext->nTokenSize = strlen(psContext->pszToken );
+    }
+}
+
 /************************************************************************/
 /*                             ReadToken()                              */
 /************************************************************************/
@@ -187,6 +286,7 @@ static XMLTokenType ReadToken( ParseContext *psContext )
 
 {
     char        chNext;
+    size_t      nRunLength;
 
     psContext->nTokenSize = 0;
     psContext->pszToken[0] = '\0';
@@ -373,9 +473,11 @@ static XMLTokenType ReadToken( ParseContext *psContext )
     {
         psContext->eTokenType = TString;
 
-        while( (chNext = ReadChar(psContext)) != '"' 
-               && chNext != '\0' )
-            AddToToken( psContext, chNext );
+        nRunLength = SkipUntil( psContext, '"' );
+        AddToTokenN( psContext,
+                     psContext->pszInput + psContext->nInputOffset - nRunLength,
+                     nRunLength );
+        chNext = ReadChar( psContext );
         
         if( chNext != '"' )
         {
@@ -385,25 +487,18 @@ static XMLTokenType ReadToken( ParseContext *psContext )
                       psContext->nInputLine );
         }
 
-        /* Do we need to unescape it? */
-        if( strchr(psContext->pszToken,'&') != NULL )
-        {
-            int  nLength;
-            char *pszUnescaped = CPLUnescapeString( psContext->pszToken, 
-                                                    &nLength, CPLES_XML );
-            strcpy( psContext->pszToken, pszUnescaped );
-            CPLFree( pszUnescaped );
-            psContext->nTokenSize = strlen(psContext->pszToken );
-        }
+        UnescapeToken( psContext );
     }
 
     else if( psContext->bInElement && chNext == '\'' )
     {
         psContext->eTokenType = TString;
 
-        while( (chNext = ReadChar(psContext)) != '\'' 
-               && chNext != '\0' )
-            AddToToken( psContext, chNext );
+        nRunLength = SkipUntil( psContext, '\'' );
+        AddToTokenN( psContext,
+                     psContext->pszInput + psContext->nInputOffset - nRunLength,
+                     nRunLength );
+        chNext = ReadChar( psContext );
         
         if( chNext != '\'' )
         {
@@ -413,16 +508,7 @@ static XMLTokenType ReadToken( ParseContext *psContext )
                       psContext->nInputLine );
         }
 
-        /* Do we need to unescape it? */
-        if( strchr(psContext->pszToken,'&') != NULL )
-        {
-            int  nLength;
-            char *pszUnescaped = CPLUnescapeString( psContext->pszToken, 
-                                                    &nLength, CPLES_XML );
-            strcpy( psContext->pszToken, pszUnescaped );
-            CPLFree( pszUnescaped );
-            psContext->nTokenSize = strlen(psContext->pszToken );
-        }
+        UnescapeToken( psContext );
     }
 
 /* -------------------------------------------------------------------- */
@@ -434,21 +520,12 @@ static XMLTokenType ReadToken( ParseContext *psContext )
         psContext->eTokenType = TString;
 
         AddToToken( psContext, chNext );
-        while( (chNext = ReadChar(psContext)) != '<' 
-               && chNext != '\0' )
-            AddToToken( psContext, chNext );
-        UnreadChar( psContext, chNext );
+        nRunLength = SkipUntil( psContext, '<' );
+        AddToTokenN( psContext,
+                     psContext->pszInput + psContext->nInputOffset - nRunLength,
+                     nRunLength );
 
-        /* Do we need to unescape it? */
-        if( strchr(psContext->pszToken,'&') != NULL )
-        {
-            int  nLength;
-            char *pszUnescaped = CPLUnescapeString( psContext->pszToken, 
-                                                    &nLength, CPLES_XML );
-            strcpy( psContext->pszToken, pszUnescaped );
-            CPLFree( pszUnescaped );
-            psContext->nTokenSize = strlen(psContext->pszToken );
-        }
+        UnescapeToken( psContext );
     }
     
 /* -------------------------------------------------------------------- */
@@ -486,117 +563,93 @@ fail:
 }
 
 /************************************************************************/
-/*                              PushNode()                              */
+/*                              PushName()                              */
 /************************************************************************/
 
-static int PushNode( ParseContext *psContext, CPLXMLNode *psNode )
+static int PushName( ParseContext *psContext, const char *pszName )
 
 {
     if( psContext->nStackMaxSize <= psContext->nStackSize )
     {
         psContext->nStackMaxSize += 10;
 
-        if (psContext->nStackMaxSize >= (int)(INT_MAX / sizeof(StackContext)))
+        if (psContext->nStackMaxSize >= (int)(INT_MAX / sizeof(size_t)))
         {
             CPLError(CE_Failure, CPLE_OutOfMemory,
-                 "Out of memory allocating %d*%d bytes", (int)sizeof(StackContext), psContext->nStackMaxSize);
-            VSIFree(psContext->papsStack);
-            psContext->papsStack = NULL;
+                 "Out of memory allocating %d*%d bytes", (int)sizeof(size_t), psContext->nStackMaxSize);
             return FALSE;
         }
-        StackContext* papsStack;
-        papsStack = (StackContext *)VSIRealloc(psContext->papsStack, 
-                    sizeof(StackContext) * psContext->nStackMaxSize);
-        if (papsStack == NULL)
+        size_t* panNameOffsets;
+        panNameOffsets = (size_t *)VSIRealloc(psContext->panNameOffsets, 
+                    sizeof(size_t) * psContext->nStackMaxSize);
+        if (panNameOffsets == NULL)
         {
             CPLError(CE_Failure, CPLE_OutOfMemory,
-                 "Out of memory allocating %d bytes", (int)(sizeof(StackContext) * psContext->nStackMaxSize));
-            VSIFree(psContext->papsStack);
-            psContext->papsStack = NULL;
+                 "Out of memory allocating %d bytes", (int)(sizeof(size_t) * psContext->nStackMaxSize));
             return FALSE;
         }
-        psContext->papsStack = papsStack;
+        psContext->panNameOffsets = panNameOffsets;
     }
 
-    psContext->papsStack[psContext->nStackSize].psFirstNode = psNode;
-    psContext->papsStack[psContext->nStackSize].psLastChild = NULL;
+    size_t nNameLen = strlen(pszName) + 1;
+    if( psContext->nNamesSize + nNameLen > psContext->nNamesMaxSize )
+    {
+        size_t nNewMaxSize = psContext->nNamesMaxSize * 2 + nNameLen + 100;
+        char* pszNames = (char *) VSIRealloc(psContext->pszNames, nNewMaxSize);
+        if (pszNames == NULL)
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Out of memory allocating %d bytes", (int)nNewMaxSize);
+            return FALSE;
+        }
+        psContext->pszNames = pszNames;
+        psContext->nNamesMaxSize = nNewMaxSize;
+    }
+
+    memcpy( psContext->pszNames + psContext->nNamesSize, pszName, nNameLen );
+    psContext->panNameOffsets[psContext->nStackSize] = psContext->nNamesSize;
+    psContext->nNamesSize += nNameLen;
     psContext->nStackSize ++;
     return TRUE;
 }
-    
+
 /************************************************************************/
-/*                             AttachNode()                             */
-/*                                                                      */
-/*      Attach the passed node as a child of the current node.          */
-/*      Special handling exists for adding siblings to psFirst if       */
-/*      there is nothing on the stack.                                  */
+/*                              TopName()                               */
 /************************************************************************/
 
-static void AttachNode( ParseContext *psContext, CPLXMLNode *psNode )
+static CPL_INLINE const char *TopName( ParseContext *psContext )
 
 {
-    if( psContext->psFirstNode == NULL )
-    {
-        psContext->psFirstNode = psNode;
-        psContext->psLastNode = psNode;
-    }
-    else if( psContext->nStackSize == 0 )
-    {
-        psContext->psLastNode->psNext = psNode;
-        psContext->psLastNode = psNode;
-    }
-    else if( psContext->papsStack[psContext->nStackSize-1].psFirstNode->psChild == NULL )
-    {
-        psContext->papsStack[psContext->nStackSize-1].psFirstNode->psChild = psNode;
-        psContext->papsStack[psContext->nStackSize-1].psLastChild = psNode;
-    }
-    else
-    {
-        psContext->papsStack[psContext->nStackSize-1].psLastChild->psNext = psNode;
-        psContext->papsStack[psContext->nStackSize-1].psLastChild = psNode;
-    }
+    return psContext->pszNames
+        + psContext->panNameOffsets[psContext->nStackSize-1];
 }
 
 /************************************************************************/
-/*                         CPLParseXMLString()                          */
+/*                              PopName()                               */
 /************************************************************************/
 
-/**
- * \brief Parse an XML string into tree form.
- *
- * The passed document is parsed into a CPLXMLNode tree representation. 
- * If the document is not well formed XML then NULL is returned, and errors
- * are reported via CPLError().  No validation beyond wellformedness is
- * done.  The CPLParseXMLFile() convenience function can be used to parse
- * from a file. 
- *
- * The returned document tree is is owned by the caller and should be freed
- * with CPLDestroyXMLNode() when no longer needed.
- *
- * If the document has more than one "root level" element then those after the 
- * first will be attached to the first as siblings (via the psNext pointers)
- * even though there is no common parent.  A document with no XML structure
- * (no angle brackets for instance) would be considered well formed, and 
- * returned as a single CXT_Text node.  
- * 
- * @param pszString the document to parse. 
- *
- * @return parsed tree or NULL on error. 
- */
-
-CPLXMLNode *CPLParseXMLString( const char *pszString )
+static CPL_INLINE void PopName( ParseContext *psContext )
 
 {
-    ParseContext sContext;
+    psContext->nStackSize--;
+    psContext->nNamesSize = psContext->panNameOffsets[psContext->nStackSize];
+}
 
-    CPLErrorReset();
+/************************************************************************/
+/*                            ParseXMLEvents()                          */
+/*                                                                      */
+/*      Tokenize the document and report its structure through the      */
+/*      handlers.  Returns TRUE if the whole document was parsed        */
+/*      without error.                                                  */
+/************************************************************************/
 
-    if( pszString == NULL )
-    {
-        CPLError( CE_Failure, CPLE_AppDefined, 
-                  "CPLParseXMLString() called with NULL pointer." );
-        return NULL;
-    }
+static int ParseXMLEvents( const char *pszString,
+                           const CPLXMLParseHandlers *psHandlers,
+                           void *pUserData )
+
+{
+    ParseContext sContext;
+    int bStopped = FALSE;
 
 /* -------------------------------------------------------------------- */
 /*      Initialize parse context.                                       */
@@ -608,14 +661,15 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
     sContext.nTokenMaxSize = 10;
     sContext.pszToken = (char *) VSIMalloc(sContext.nTokenMaxSize);
     if (sContext.pszToken == NULL)
-        return NULL;
+        return FALSE;
     sContext.nTokenSize = 0;
     sContext.eTokenType = TNone;
     sContext.nStackMaxSize = 0;
     sContext.nStackSize = 0;
-    sContext.papsStack = NULL;
-    sContext.psFirstNode = NULL;
-    sContext.psLastNode = NULL;
+    sContext.panNameOffsets = NULL;
+    sContext.pszNames = NULL;
+    sContext.nNamesMaxSize = 0;
+    sContext.nNamesSize = 0;
 
 /* ==================================================================== */
 /*      Loop reading tokens.                                            */
@@ -627,8 +681,6 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
 /* -------------------------------------------------------------------- */
         if( sContext.eTokenType == TOpen )
         {
-            CPLXMLNode *psElement;
-
             if( ReadToken(&sContext) != TToken )
             {
                 CPLError( CE_Failure, CPLE_AppDefined, 
@@ -639,18 +691,20 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
 
             if( sContext.pszToken[0] != '/' )
             {
-                psElement = _CPLCreateXMLNode( NULL, CXT_Element,
-                                              sContext.pszToken );
-                if (!psElement) break;
-                AttachNode( &sContext, psElement );
-                if (!PushNode( &sContext, psElement ))
+                if (!PushName( &sContext, sContext.pszToken ))
+                    break;
+                if( psHandlers->pfnStartElement != NULL
+                    && !psHandlers->pfnStartElement( pUserData,
+                                                     sContext.pszToken ) )
+                {
+                    bStopped = TRUE;
                     break;
+                }
             }
             else 
             {
                 if( sContext.nStackSize == 0
-                    || !EQUAL(sContext.pszToken+1,
-                         sContext.papsStack[sContext.nStackSize-1].psFirstNode->pszValue) )
+                    || !EQUAL(sContext.pszToken+1, TopName(&sContext)) )
                 {
                     CPLError( CE_Failure, CPLE_AppDefined, 
                               "Line %d: <%.500s> doesn't have matching <%.500s>.",
@@ -660,8 +714,7 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
                 }
                 else
                 {
-                    if (strcmp(sContext.pszToken+1,
-                         sContext.papsStack[sContext.nStackSize-1].psFirstNode->pszValue) != 0)
+                    if (strcmp(sContext.pszToken+1, TopName(&sContext)) != 0)
                     {
                         /* TODO: at some point we could just error out like any other */
                         /* sane XML parser would do */
@@ -670,7 +723,7 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
                                 "Going on, but this is invalid XML that might be rejected in "
                                 "future versions.",
                                 sContext.nInputLine,
-                                sContext.papsStack[sContext.nStackSize-1].psFirstNode->pszValue,
+                                TopName(&sContext),
                                 sContext.pszToken );
                     }
 
@@ -683,8 +736,16 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
                         break;
                     }
 
+                    if( psHandlers->pfnEndElement != NULL
+                        && !psHandlers->pfnEndElement( pUserData,
+                                                       TopName(&sContext) ) )
+                    {
+                        bStopped = TRUE;
+                        break;
+                    }
+
                     /* pop element off stack */
-                    sContext.nStackSize--;
+                    PopName( &sContext );
                 }
             }
         }
@@ -694,17 +755,13 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
 /* -------------------------------------------------------------------- */
         else if( sContext.eTokenType == TToken )
         {
-            CPLXMLNode *psAttr;
+            CPLString osName( sContext.pszToken );
 
-            psAttr = _CPLCreateXMLNode(NULL, CXT_Attribute, sContext.pszToken);
-            if (!psAttr) break;
-            AttachNode( &sContext, psAttr );
-            
             if( ReadToken(&sContext) != TEqual )
             {
                 CPLError( CE_Failure, CPLE_AppDefined, 
                           "Line %d: Didn't find expected '=' for value of attribute '%.500s'.",
-                          sContext.nInputLine, psAttr->pszValue );
+                          sContext.nInputLine, osName.c_str() );
                 break;
             }
 
@@ -726,7 +783,13 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
                 break;
             }
 
-            if (!_CPLCreateXMLNode( psAttr, CXT_Text, sContext.pszToken )) break;
+            if( psHandlers->pfnAttribute != NULL
+                && !psHandlers->pfnAttribute( pUserData, osName,
+                                              sContext.pszToken ) )
+            {
+                bStopped = TRUE;
+                break;
+            }
         }
 
 /* -------------------------------------------------------------------- */
@@ -757,7 +820,15 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
                 break;
             }
 
-            sContext.nStackSize--;
+            if( psHandlers->pfnEndElement != NULL
+                && !psHandlers->pfnEndElement( pUserData,
+                                               TopName(&sContext) ) )
+            {
+                bStopped = TRUE;
+                break;
+            }
+
+            PopName( &sContext );
         }
 
 /* -------------------------------------------------------------------- */
@@ -773,7 +844,7 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
                           sContext.nInputLine );
                 break;
             }
-            else if( sContext.papsStack[sContext.nStackSize-1].psFirstNode->pszValue[0] != '?' )
+            else if( TopName(&sContext)[0] != '?' )
             {
                 CPLError( CE_Failure, CPLE_AppDefined, 
                           "Line %d: Found '?>' without matching '<?'.",
@@ -781,7 +852,15 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
                 break;
             }
 
-            sContext.nStackSize--;
+            if( psHandlers->pfnEndElement != NULL
+                && !psHandlers->pfnEndElement( pUserData,
+                                               TopName(&sContext) ) )
+            {
+                bStopped = TRUE;
+                break;
+            }
+
+            PopName( &sContext );
         }
 
 /* -------------------------------------------------------------------- */
@@ -791,11 +870,12 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
 /* -------------------------------------------------------------------- */
         else if( sContext.eTokenType == TComment )
         {
-            CPLXMLNode *psValue;
-
-            psValue = _CPLCreateXMLNode(NULL, CXT_Comment, sContext.pszToken);
-            if (!psValue) break;
-            AttachNode( &sContext, psValue );
+            if( psHandlers->pfnComment != NULL
+                && !psHandlers->pfnComment( pUserData, sContext.pszToken ) )
+            {
+                bStopped = TRUE;
+                break;
+            }
         }
 
 /* -------------------------------------------------------------------- */
@@ -803,11 +883,12 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
 /* -------------------------------------------------------------------- */
         else if( sContext.eTokenType == TLiteral )
         {
-            CPLXMLNode *psValue;
-
-            psValue = _CPLCreateXMLNode(NULL, CXT_Literal, sContext.pszToken);
-            if (!psValue) break;
-            AttachNode( &sContext, psValue );
+            if( psHandlers->pfnLiteral != NULL
+                && !psHandlers->pfnLiteral( pUserData, sContext.pszToken ) )
+            {
+                bStopped = TRUE;
+                break;
+            }
         }
 
 /* -------------------------------------------------------------------- */
@@ -815,11 +896,12 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
 /* -------------------------------------------------------------------- */
         else if( sContext.eTokenType == TString && !sContext.bInElement )
         {
-            CPLXMLNode *psValue;
-
-            psValue = _CPLCreateXMLNode(NULL, CXT_Text, sContext.pszToken);
-            if (!psValue) break;
-            AttachNode( &sContext, psValue );
+            if( psHandlers->pfnText != NULL
+                && !psHandlers->pfnText( pUserData, sContext.pszToken ) )
+            {
+                bStopped = TRUE;
+                break;
+            }
         }
 /* -------------------------------------------------------------------- */
 /*      Anything else is an error.                                      */
@@ -836,29 +918,468 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
 /* -------------------------------------------------------------------- */
 /*      Did we pop all the way out of our stack?                        */
 /* -------------------------------------------------------------------- */
-    if( CPLGetLastErrorType() != CE_Failure && sContext.nStackSize != 0 )
+    if( !bStopped && CPLGetLastErrorType() != CE_Failure
+        && sContext.nStackSize != 0 )
     {
         CPLError( CE_Failure, CPLE_AppDefined, 
                   "Parse error at EOF, not all elements have been closed,\n"
                   "starting with %.500s\n", 
-                  sContext.papsStack[sContext.nStackSize-1].psFirstNode->pszValue );
+                  TopName(&sContext) );
     }
 
 /* -------------------------------------------------------------------- */
 /*      Cleanup                                                         */
 /* -------------------------------------------------------------------- */
     CPLFree( sContext.pszToken );
-    if( sContext.papsStack != NULL )
-        CPLFree( sContext.papsStack );
+    CPLFree( sContext.panNameOffsets );
+    CPLFree( sContext.pszNames );
+
+    return !bStopped && CPLGetLastErrorType() != CE_Failure;
+}
+
+/************************************************************************/
+/*                   CPLParseXMLStringWithHandlers()                    */
+/************************************************************************/
+
+/**
+ * \brief Parse an XML string, reporting its content through callbacks.
+ *
+ * This is an event driven (SAX like) alternative to CPLParseXMLString().
+ * The document is tokenized exactly in the same way, but instead of
+ * building a CPLXMLNode tree, the handlers are invoked as the start and end
+ * of elements, attributes, text, comments and literals are encountered, in
+ * document order.  This avoids keeping a representation of the whole
+ * document in memory, and allows stopping the parsing as soon as the
+ * information of interest has been collected.
+ *
+ * Each element start is followed by the attributes of the element, and
+ * eventually by the matching element end.  <?...?> processing
+ * instructions are reported as elements whose name starts with '?'.
+ *
+ * @param pszString the document to parse. 
+ * @param psHandlers the callbacks to invoke.  Members may be NULL.
+ * @param pUserData user data passed to the callbacks.
+ *
+ * @return TRUE if the whole document was parsed successfully, FALSE if it
+ * is not well formed (errors are then reported via CPLError()), or if a
+ * callback returned FALSE.
+ *
+ * @since GDAL 2.0
+ */
+
+int CPLParseXMLStringWithHandlers( const char *pszString,
+                                   const CPLXMLParseHandlers *psHandlers,
+                                   void *pUserData )
+
+{
+    CPLErrorReset();
+
+    if( pszString == NULL || psHandlers == NULL )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, 
+                  "CPLParseXMLStringWithHandlers() called with NULL pointer." );
+        return FALSE;
+    }
+
+    return ParseXMLEvents( pszString, psHandlers, pUserData );
+}
+
+/************************************************************************/
+/*                           ArenaAlloc()                               */
+/************************************************************************/
+
+static void *ArenaAlloc( TreeBuilder *psBuilder, size_t nBytes )
+
+{
+    nBytes = (nBytes + 7) & ~((size_t)7);
+
+    CPLXMLArenaBlock *psBlock = psBuilder->psCurBlock;
+    if( psBlock == NULL || psBlock->nSize - psBlock->nUsed < nBytes )
+    {
+        size_t nSize = MAX(psBuilder->nNextBlockSize, nBytes);
+
+        psBlock = (CPLXMLArenaBlock *) VSIMalloc( ARENA_HEADER_SIZE + nSize );
+        if( psBlock == NULL )
+        {
+            CPLError( CE_Failure, CPLE_OutOfMemory,
+                      "Out of memory allocating %lu bytes",
+                      (unsigned long) (ARENA_HEADER_SIZE + nSize) );
+            return NULL;
+        }
+        psBlock->nMagic = ARENA_MAGIC;
+        psBlock->nSize = nSize;
+        psBlock->nUsed = 0;
+
+        /* Keep the first block, which holds the root, at the head of */
+        /* the list. */
+        if( psBuilder->psFirstBlock == NULL )
+        {
+            psBlock->psNext = NULL;
+            psBuilder->psFirstBlock = psBlock;
+        }
+        else
+        {
+            psBlock->psNext = psBuilder->psFirstBlock->psNext;
+            psBuilder->psFirstBlock->psNext = psBlock;
+        }
+        psBuilder->psCurBlock = psBlock;
 
-    if( CPLGetLastErrorType() == CE_Failure )
+        if( psBuilder->nNextBlockSize < ARENA_MAX_BLOCK_SIZE )
+            psBuilder->nNextBlockSize *= 2;
+    }
+
+    void *pRet = ((GByte *) psBlock) + ARENA_HEADER_SIZE + psBlock->nUsed;
+    psBlock->nUsed += nBytes;
+    return pRet;
+}
+
+/************************************************************************/
+/*                          FreeArenaBlocks()                           */
+/************************************************************************/
+
+static void FreeArenaBlocks( CPLXMLArenaBlock *psBlock )
+
+{
+    while( psBlock != NULL )
+    {
+        CPLXMLArenaBlock *psNext = psBlock->psNext;
+        psBlock->nMagic = 0;
+        VSIFree( psBlock );
+        psBlock = psNext;
+    }
+}
+
+/************************************************************************/
+/*                            CreateNode()                              */
+/************************************************************************/
+
+static CPLXMLNode *CreateNode( TreeBuilder *psBuilder, CPLXMLNodeType eType,
+                               const char *pszText )
+
+{
+    if( !psBuilder->bUseArena )
+        return _CPLCreateXMLNode( NULL, eType, pszText );
+
+/* -------------------------------------------------------------------- */
+/*      In arena mode, the value is stored right after the node.        */
+/* -------------------------------------------------------------------- */
+    size_t nTextLen = strlen(pszText) + 1;
+    CPLXMLNode *psNode = (CPLXMLNode *)
+        ArenaAlloc( psBuilder, sizeof(CPLXMLNode) + nTextLen );
+    if( psNode == NULL )
+        return NULL;
+
+    psNode->eType = eType;
+    psNode->pszValue = (char *) (psNode + 1);
+    memcpy( psNode->pszValue, pszText, nTextLen );
+    psNode->psNext = NULL;
+    psNode->psChild = NULL;
+
+    return psNode;
+}
+
+/************************************************************************/
+/*                              PushNode()                              */
+/************************************************************************/
+
+static int PushNode( TreeBuilder *psBuilder, CPLXMLNode *psNode )
+
+{
+    if( psBuilder->nStackMaxSize <= psBuilder->nStackSize )
     {
-        CPLDestroyXMLNode( sContext.psFirstNode );
-        sContext.psFirstNode = NULL;
-        sContext.psLastNode = NULL;
+        psBuilder->nStackMaxSize += 10;
+
+        if (psBuilder->nStackMaxSize >= (int)(INT_MAX / sizeof(StackContext)))
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Out of memory allocating %d*%d bytes", (int)sizeof(StackContext), psBuilder->nStackMaxSize);
+            VSIFree(psBuilder->papsStack);
+            psBuilder->papsStack = NULL;
+            return FALSE;
+        }
+        StackContext* papsStack;
+        papsStack = (StackContext *)VSIRealloc(psBuilder->papsStack, 
+                    sizeof(StackContext) * psBuilder->nStackMaxSize);
+        if (papsStack == NULL)
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Out of memory allocating %d bytes", (int)(sizeof(StackContext) * psBuilder->nStackMaxSize));
+            VSIFree(psBuilder->papsStack);
+            psBuilder->papsStack = NULL;
+            return FALSE;
+        }
+        psBuilder->papsStack = papsStack;
     }
 
-    return sContext.psFirstNode;
+    psBuilder->papsStack[psBuilder->nStackSize].psFirstNode = psNode;
+    psBuilder->papsStack[psBuilder->nStackSize].psLastChild = NULL;
+    psBuilder->nStackSize ++;
+    return TRUE;
+}
+    
+/************************************************************************/
+/*                             AttachNode()                             */
+/*                                                                      */
+/*      Attach the passed node as a child of the current node.          */
+/*      Special handling exists for adding siblings to psFirst if       */
+/*      there is nothing on the stack.                                  */
+/************************************************************************/
+
+static void AttachNode( TreeBuilder *psBuilder, CPLXMLNode *psNode )
+
+{
+    if( psBuilder->psFirstNode == NULL )
+    {
+        psBuilder->psFirstNode = psNode;
+        psBuilder->psLastNode = psNode;
+    }
+    else if( psBuilder->nStackSize == 0 )
+    {
+        psBuilder->psLastNode->psNext = psNode;
+        psBuilder->psLastNode = psNode;
+    }
+    else if( psBuilder->papsStack[psBuilder->nStackSize-1].psFirstNode->psChild == NULL )
+    {
+        psBuilder->papsStack[psBuilder->nStackSize-1].psFirstNode->psChild = psNode;
+        psBuilder->papsStack[psBuilder->nStackSize-1].psLastChild = psNode;
+    }
+    else
+    {
+        psBuilder->papsStack[psBuilder->nStackSize-1].psLastChild->psNext = psNode;
+        psBuilder->papsStack[psBuilder->nStackSize-1].psLastChild = psNode;
+    }
+}
+
+/************************************************************************/
+/*                  Tree building handlers.                             */
+/************************************************************************/
+
+static int TreeStartElement( void *pUserData, const char *pszName )
+
+{
+    TreeBuilder *psBuilder = (TreeBuilder *) pUserData;
+    CPLXMLNode *psElement = CreateNode( psBuilder, CXT_Element, pszName );
+
+    if( psElement == NULL )
+        return FALSE;
+    AttachNode( psBuilder, psElement );
+    return PushNode( psBuilder, psElement );
+}
+
+static int TreeAttribute( void *pUserData, const char *pszName,
+                          const char *pszValue )
+
+{
+    TreeBuilder *psBuilder = (TreeBuilder *) pUserData;
+    CPLXMLNode *psAttr = CreateNode( psBuilder, CXT_Attribute, pszName );
+
+    if( psAttr == NULL )
+        return FALSE;
+    AttachNode( psBuilder, psAttr );
+
+    psAttr->psChild = CreateNode( psBuilder, CXT_Text, pszValue );
+    return psAttr->psChild != NULL;
+}
+
+static int TreeEndElement( void *pUserData,
+                           CPL_UNUSED const char *pszName )
+
+{
+    TreeBuilder *psBuilder = (TreeBuilder *) pUserData;
+
+    psBuilder->nStackSize--;
+    return TRUE;
+}
+
+static int TreeAddValue( TreeBuilder *psBuilder, CPLXMLNodeType eType,
+                         const char *pszText )
+
+{
+    CPLXMLNode *psValue = CreateNode( psBuilder, eType, pszText );
+
+    if( psValue == NULL )
+        return FALSE;
+    AttachNode( psBuilder, psValue );
+    return TRUE;
+}
+
+static int TreeText( void *pUserData, const char *pszText )
+
+{
+    return TreeAddValue( (TreeBuilder *) pUserData, CXT_Text, pszText );
+}
+
+static int TreeComment( void *pUserData, const char *pszText )
+
+{
+    return TreeAddValue( (TreeBuilder *) pUserData, CXT_Comment, pszText );
+}
+
+static int TreeLiteral( void *pUserData, const char *pszText )
+
+{
+    return TreeAddValue( (TreeBuilder *) pUserData, CXT_Literal, pszText );
+}
+
+/************************************************************************/
+/*                           ParseXMLTree()                             */
+/************************************************************************/
+
+static CPLXMLNode *ParseXMLTree( const char *pszString, int bUseArena )
+
+{
+    static const CPLXMLParseHandlers sTreeHandlers = {
+        TreeStartElement, TreeAttribute, TreeEndElement,
+        TreeText, TreeComment, TreeLiteral };
+    TreeBuilder sBuilder;
+
+    sBuilder.nStackMaxSize = 0;
+    sBuilder.nStackSize = 0;
+    sBuilder.papsStack = NULL;
+    sBuilder.psFirstNode = NULL;
+    sBuilder.psLastNode = NULL;
+    sBuilder.bUseArena = bUseArena;
+    sBuilder.psFirstBlock = NULL;
+    sBuilder.psCurBlock = NULL;
+
+    /* Size the first block after the document, since the tree usually */
+    /* takes a bit more room than its serialized form. */
+    if( bUseArena )
+    {
+        size_t nLen = strlen(pszString);
+        sBuilder.nNextBlockSize =
+            MIN( MAX( nLen, ARENA_MIN_BLOCK_SIZE ), ARENA_MAX_BLOCK_SIZE / 16 );
+    }
+    else
+        sBuilder.nNextBlockSize = 0;
+
+    int bOK = ParseXMLEvents( pszString, &sTreeHandlers, &sBuilder );
+
+    CPLFree( sBuilder.papsStack );
+
+    if( !bOK )
+    {
+        if( bUseArena )
+            FreeArenaBlocks( sBuilder.psFirstBlock );
+        else
+            CPLDestroyXMLNode( sBuilder.psFirstNode );
+        return NULL;
+    }
+
+    /* A document without any node does not use the arena. */
+    if( sBuilder.psFirstNode == NULL && sBuilder.psFirstBlock != NULL )
+        FreeArenaBlocks( sBuilder.psFirstBlock );
+
+    return sBuilder.psFirstNode;
+}
+
+/************************************************************************/
+/*                         CPLParseXMLString()                          */
+/************************************************************************/
+
+/**
+ * \brief Parse an XML string into tree form.
+ *
+ * The passed document is parsed into a CPLXMLNode tree representation. 
+ * If the document is not well formed XML then NULL is returned, and errors
+ * are reported via CPLError().  No validation beyond wellformedness is
+ * done.  The CPLParseXMLFile() convenience function can be used to parse
+ * from a file. 
+ *
+ * The returned document tree is is owned by the caller and should be freed
+ * with CPLDestroyXMLNode() when no longer needed.
+ *
+ * If the document has more than one "root level" element then those after the 
+ * first will be attached to the first as siblings (via the psNext pointers)
+ * even though there is no common parent.  A document with no XML structure
+ * (no angle brackets for instance) would be considered well formed, and 
+ * returned as a single CXT_Text node.  
+ * 
+ * @param pszString the document to parse. 
+ *
+ * @return parsed tree or NULL on error. 
+ */
+
+CPLXMLNode *CPLParseXMLString( const char *pszString )
+
+{
+    CPLErrorReset();
+
+    if( pszString == NULL )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, 
+                  "CPLParseXMLString() called with NULL pointer." );
+        return NULL;
+    }
+
+    return ParseXMLTree( pszString, FALSE );
+}
+
+/************************************************************************/
+/*                      CPLParseXMLStringInArena()                      */
+/************************************************************************/
+
+/**
+ * \brief Parse an XML string into a read-only tree held in an arena.
+ *
+ * This is similar to CPLParseXMLString(), except that the nodes and their
+ * values are packed into a few large memory blocks instead of being
+ * allocated one by one.  This is faster and uses less memory for big
+ * documents, but the returned tree must be treated as read-only: nodes
+ * may not be added, removed or have their value changed, and none of them
+ * may be passed to CPLDestroyXMLNode().  Clone the relevant part of the
+ * tree with CPLCloneXMLTree() if it needs to be modified or kept.
+ *
+ * The returned tree should be freed with CPLDestroyXMLArenaTree().
+ *
+ * @param pszString the document to parse. 
+ *
+ * @return parsed tree or NULL on error. 
+ *
+ * @since GDAL 2.0
+ */
+
+CPLXMLNode *CPLParseXMLStringInArena( const char *pszString )
+
+{
+    CPLErrorReset();
+
+    if( pszString == NULL )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, 
+                  "CPLParseXMLStringInArena() called with NULL pointer." );
+        return NULL;
+    }
+
+    return ParseXMLTree( pszString, TRUE );
+}
+
+/************************************************************************/
+/*                       CPLDestroyXMLArenaTree()                       */
+/************************************************************************/
+
+/**
+ * \brief Destroy a tree returned by CPLParseXMLStringInArena().
+ *
+ * All the nodes of the tree are released at once.
+ *
+ * @param psTree the root of the tree, as returned by
+ * CPLParseXMLStringInArena().  May be NULL.
+ *
+ * @since GDAL 2.0
+ */
+
+void CPLDestroyXMLArenaTree( CPLXMLNode *psTree )
+
+{
+    if( psTree == NULL )
+        return;
+
+    CPLXMLArenaBlock *psFirstBlock = (CPLXMLArenaBlock *)
+        (((GByte *) psTree) - ARENA_HEADER_SIZE);
+
+    CPLAssert( psFirstBlock->nMagic == ARENA_MAGIC );
+    FreeArenaBlocks( psFirstBlock );
 }
 
 /************************************************************************/
@@ -155,6 +155,41 @@ CPLXMLNode CPL_DLL *CPLParseXMLFile( const char *pszFilename );
 int        CPL_DLL CPLSerializeXMLTreeToFile( const CPLXMLNode *psTree,
                                               const char *pszFilename );
 
+/**
+ * Callbacks for CPLParseXMLStringWithHandlers().
+ *
+ * Any of the members may be NULL if the caller is not interested in the
+ * corresponding event.  Each callback receives the pUserData passed to
+ * CPLParseXMLStringWithHandlers(), and returns TRUE to continue parsing or
+ * FALSE to stop it.  The strings passed to the callbacks are only valid
+ * for the duration of the call.
+ */
+
+typedef struct
+{
+    /** Start of an element (or of a <?...?> processing instruction) */
+    int (*pfnStartElement)( void *pUserData, const char *pszName );
+    /** Attribute of the element most recently started */
+    int (*pfnAttribute)( void *pUserData, const char *pszName,
+                         const char *pszValue );
+    /** End of the element named pszName */
+    int (*pfnEndElement)( void *pUserData, const char *pszName );
+    /** Text (or CDATA) content, with XML entities already unescaped */
+    int (*pfnText)( void *pUserData, const char *pszText );
+    /** Comment, without the <!-- and --> delimiters */
+    int (*pfnComment)( void *pUserData, const char *pszText );
+    /** Literal such as <!DOCTYPE ...>, returned as is */
+    int (*pfnLiteral)( void *pUserData, const char *pszText );
+} CPLXMLParseHandlers;
+
+int        CPL_DLL CPLParseXMLStringWithHandlers(
+                                    const char *pszString,
+                                    const CPLXMLParseHandlers *psHandlers,
+                                    void *pUserData );
+
+CPLXMLNode CPL_DLL *CPLParseXMLStringInArena( const char *pszString );
+void       CPL_DLL  CPLDestroyXMLArenaTree( CPLXMLNode *psTree );
+
 CPL_C_END
 
 #endif /* _CPL_MINIXML_H_INCLUDED */
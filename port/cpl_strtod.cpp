@@ -31,6 +31,7 @@
 #include <locale.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <float.h>
 
 #include "cpl_conv.h"
 
@@ -235,6 +236,136 @@ static char* CPLReplacePointByLocalePoint(const char* pszNumber, char point)
     return (char*) pszNumber;
 }
 
+/************************************************************************/
+/*                          CPLStrtodFastPath()                         */
+/*                                                                      */
+/*      Converts the common decimal forms, [+-]ddd[.ddd][e[+-]dd],      */
+/*      with at most 19 significant digits and a value that can be      */
+/*      computed exactly: a significand lower than 2^53 multiplied or   */
+/*      divided by a power of ten lower than 10^23, which are both      */
+/*      exact doubles, gives the correctly rounded result (Clinger's    */
+/*      fast path). Returns FALSE for the other cases, that are left    */
+/*      to strtod().                                                    */
+/************************************************************************/
+
+static int CPLStrtodFastPath( const char *nptr, char **endptr, char point,
+                              double *pdfValue )
+
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+    /* Extended precision intermediate results could be rounded twice */
+    (void) nptr;
+    (void) endptr;
+    (void) point;
+    (void) pdfValue;
+    return FALSE;
+#else
+    static const double adfPow10[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char *p = nptr;
+    int bNegative = FALSE;
+
+    if( *p == '-' )
+    {
+        bNegative = TRUE;
+        p ++;
+    }
+    else if( *p == '+' )
+        p ++;
+
+/* -------------------------------------------------------------------- */
+/*      Significand.                                                    */
+/* -------------------------------------------------------------------- */
+    GUIntBig nSignificand = 0;
+    int nDigits = 0;
+    int nExp10 = 0;
+    int bHasDigit = FALSE;
+
+    for( ; *p >= '0' && *p <= '9'; p++ )
+    {
+        bHasDigit = TRUE;
+        if( nDigits == 0 && *p == '0' )
+            continue;
+        if( nDigits == 19 )
+            return FALSE;
+        nSignificand = nSignificand * 10 + (*p - '0');
+        nDigits ++;
+    }
+
+    if( *p == point )
+    {
+        p ++;
+        for( ; *p >= '0' && *p <= '9'; p++ )
+        {
+            bHasDigit = TRUE;
+            if( nDigits == 0 && *p == '0' )
+            {
+                nExp10 --;
+                continue;
+            }
+            if( nDigits == 19 )
+                return FALSE;
+            nSignificand = nSignificand * 10 + (*p - '0');
+            nDigits ++;
+            nExp10 --;
+        }
+    }
+
+    /* Also rules out "inf", "nan" and hexadecimal values */
+    if( !bHasDigit || *p == 'x' || *p == 'X' )
+        return FALSE;
+
+/* -------------------------------------------------------------------- */
+/*      Exponent.                                                       */
+/* -------------------------------------------------------------------- */
+    if( *p == 'e' || *p == 'E' )
+    {
+        const char *q = p + 1;
+        int bNegativeExp = FALSE;
+        if( *q == '-' )
+        {
+            bNegativeExp = TRUE;
+            q ++;
+        }
+        else if( *q == '+' )
+            q ++;
+
+        if( *q >= '0' && *q <= '9' )
+        {
+            int nExp = 0;
+            for( ; *q >= '0' && *q <= '9'; q++ )
+            {
+                if( nExp < 10000 )
+                    nExp = nExp * 10 + (*q - '0');
+            }
+            nExp10 += bNegativeExp ? -nExp : nExp;
+            p = q;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Compute the value if it can be done exactly.                    */
+/* -------------------------------------------------------------------- */
+    double dfValue;
+    if( nSignificand == 0 )
+        dfValue = 0.0;
+    else if( nSignificand > ((GUIntBig)1 << 53) || nExp10 < -22 || nExp10 > 22 )
+        return FALSE;
+    else if( nExp10 >= 0 )
+        dfValue = (double) (GIntBig) nSignificand * adfPow10[nExp10];
+    else
+        dfValue = (double) (GIntBig) nSignificand / adfPow10[-nExp10];
+
+    *pdfValue = bNegative ? -dfValue : dfValue;
+    if( endptr )
+        *endptr = (char *) p;
+    return TRUE;
+#endif
+}
+
 /************************************************************************/
 /*                          CPLStrtodDelim()                            */
 /************************************************************************/
@@ -301,13 +432,17 @@ double CPLStrtodDelim(const char *nptr, char **endptr, char point)
         return NAN;
     }
 
+    double      dfValue;
+
+    if( CPLStrtodFastPath( nptr, endptr, point, &dfValue ) )
+        return dfValue;
+
 /* -------------------------------------------------------------------- */
 /*  We are implementing a simple method here: copy the input string     */
 /*  into the temporary buffer, replace the specified decimal delimiter  */
 /*  with the one, taken from locale settings and use standard strtod()  */
 /*  on that buffer.                                                     */
 /* -------------------------------------------------------------------- */
-    double      dfValue;
     int         nError;
 
     char*       pszNumber = CPLReplacePointByLocalePoint(nptr, point);
@@ -20,6 +20,12 @@
 
 #include "cpl_time.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
 #define SECSPERMIN      60L
 #define MINSPERHOUR     60L
 #define HOURSPERDAY     24L
@@ -151,3 +157,46 @@ GIntBig CPLYMDHMSToUnixTime(const struct tm *brokendowntime)
          brokendowntime->tm_hour * SECSPERHOUR +
          days * SECSPERDAY;
 }
+
+/************************************************************************/
+/*                        CPLGetMicroSecTime()                          */
+/************************************************************************/
+
+/** Return a time in microseconds, to measure elapsed durations.
+ *
+ * Only the difference between two values returned by this function is
+ * meaningful.
+ *
+ * @return a number of microseconds since an unspecified origin.
+ *
+ * @since GDAL 2.0
+ */
+
+GIntBig CPLGetMicroSecTime(void)
+{
+#ifdef _WIN32
+  static LARGE_INTEGER nFrequency = { 0 };
+  LARGE_INTEGER nCounter;
+
+  if( nFrequency.QuadPart == 0 )
+    QueryPerformanceFrequency( &nFrequency );
+  QueryPerformanceCounter( &nCounter );
+  return (GIntBig) (nCounter.QuadPart * 1000000.0 / nFrequency.QuadPart);
+#elif defined(CLOCK_MONOTONIC)
+  /* Not affected by the adjustments of the system clock */
+  struct timespec ts;
+
+  if( clock_gettime( CLOCK_MONOTONIC, &ts ) == 0 )
+    return (GIntBig) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+
+  struct timeval tv;
+
+  gettimeofday( &tv, NULL );
+  return (GIntBig) tv.tv_sec * 1000000 + tv.tv_usec;
+#else
+  struct timeval tv;
+
+  gettimeofday( &tv, NULL );
+  return (GIntBig) tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
@@ -37,5 +37,6 @@
 
 struct tm CPL_DLL * CPLUnixTimeToYMDHMS(GIntBig unixTime, struct tm* pRet);
 GIntBig CPL_DLL CPLYMDHMSToUnixTime(const struct tm *brokendowntime);
+GIntBig CPL_DLL CPLGetMicroSecTime(void);
 
 #endif // _CPL_TIME_H_INCLUDED
@@ -169,6 +169,9 @@ int CPL_DLL     VSIStatL( const char *, VSIStatBufL * );
 #define VSI_STAT_SIZE_FLAG      0x4
 
 int CPL_DLL     VSIStatExL( const char * pszFilename, VSIStatBufL * psStatBuf, int nFlags );
+void CPL_DLL    VSIClearStatCache( const char * pszFilename );
+char CPL_DLL  **VSIGetIOStatistics( void );
+void CPL_DLL    VSIResetIOStatistics( void );
 
 int CPL_DLL     VSIIsCaseSensitiveFS( const char * pszFilename );
 
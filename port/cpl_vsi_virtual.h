@@ -45,6 +45,7 @@
 #endif
 
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -52,8 +53,18 @@
 /*                           VSIVirtualHandle                           */
 /************************************************************************/
 
+class VSIFilesystemHandler;
+
 class CPL_DLL VSIVirtualHandle { 
   public:
+    /* Bytes read through VSIFReadL() and VSIFReadMultiRangeL(), and the */
+    /* handler that opened the file, for VSIGetIOStatistics(). */
+    GUIntBig          nStatBytesRead;
+    VSIFilesystemHandler *poStatHandler;
+
+                      VSIVirtualHandle() : nStatBytesRead(0),
+                                           poStatHandler(NULL) { }
+
     virtual int       Seek( vsi_l_offset nOffset, int nWhence ) = 0;
     virtual vsi_l_offset Tell() = 0;
     virtual size_t    Read( void *pBuffer, size_t nSize, size_t nMemb ) = 0;
@@ -98,22 +109,59 @@ public:
 /*                            VSIFileManager                            */
 /************************************************************************/
 
+typedef struct
+{
+    int         nResult;
+    int         nFlags;
+    VSIStatBufL sStat;
+    time_t      nTime;
+} VSIStatCacheEntry;
+
 class CPL_DLL VSIFileManager 
 {
 private:
     VSIFilesystemHandler *poDefaultHandler;
     std::map<std::string, VSIFilesystemHandler *> oHandlers;
 
+    /* Cache of Stat() results, enabled by VSI_STAT_CACHE_TTL. */
+    CPLMutex     *hStatCacheMutex;
+    std::map<std::string, VSIStatCacheEntry> oStatCache;
+    std::map<VSIVirtualHandle *, std::string> oMapWriteHandles;
+    std::map<std::string, int> oMapFilesOpenForWriting;
+    volatile int  nWriteHandles;
+    GUIntBig      nStatCacheGeneration;
+
+    /* Bytes read per handler, from the closed files and the open ones. */
+    CPLMutex     *hIOStatsMutex;
+    std::map<VSIFilesystemHandler *, GUIntBig> oMapBytesRead;
+    std::set<VSIVirtualHandle *> oSetOpenHandles;
+
     VSIFileManager();
 
     static VSIFileManager *Get();
 
+    void        InvalidateStatCacheEntry( const std::string& osFilename );
+
 public:
     ~VSIFileManager();
 
     static VSIFilesystemHandler *GetHandler( const char * );
     static void InstallHandler( const std::string& osPrefix, 
                                 VSIFilesystemHandler * );
+
+    static int  CachedStat( VSIFilesystemHandler *poFSHandler,
+                            const char *pszFilename,
+                            VSIStatBufL *psStatBuf, int nFlags );
+    static void InvalidateStatCache( const char *pszFilename );
+    static void RegisterWriteHandle( VSIVirtualHandle *poHandle,
+                                     const char *pszFilename );
+    static void UnregisterWriteHandle( VSIVirtualHandle *poHandle );
+
+    static void RegisterOpenHandle( VSIVirtualHandle *poHandle,
+                                    VSIFilesystemHandler *poFSHandler );
+    static void UnregisterOpenHandle( VSIVirtualHandle *poHandle );
+    static char **GetIOStatistics();
+    static void ResetIOStatistics();
     /* RemoveHandler is never defined. */
     /* static void RemoveHandler( const std::string& osPrefix ); */
 };
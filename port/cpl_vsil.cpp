@@ -31,6 +31,7 @@
 
 #include "cpl_vsi_virtual.h"
 #include "cpl_multiproc.h"
+#include "cpl_atomic_ops.h"
 #include "cpl_string.h"
 #include <string>
 
@@ -269,6 +270,8 @@ int VSIMkdir( const char *pszPathname, long mode )
     VSIFilesystemHandler *poFSHandler = 
         VSIFileManager::GetHandler( pszPathname );
 
+    VSIFileManager::InvalidateStatCache( pszPathname );
+
     return poFSHandler->Mkdir( pszPathname, mode );
 }
 
@@ -297,6 +300,8 @@ int VSIUnlink( const char * pszFilename )
     VSIFilesystemHandler *poFSHandler = 
         VSIFileManager::GetHandler( pszFilename );
 
+    VSIFileManager::InvalidateStatCache( pszFilename );
+
     return poFSHandler->Unlink( pszFilename );
 }
 
@@ -328,6 +333,9 @@ int VSIRename( const char * oldpath, const char * newpath )
     VSIFilesystemHandler *poFSHandler = 
         VSIFileManager::GetHandler( oldpath );
 
+    VSIFileManager::InvalidateStatCache( oldpath );
+    VSIFileManager::InvalidateStatCache( newpath );
+
     return poFSHandler->Rename( oldpath, newpath );
 }
 
@@ -357,6 +365,8 @@ int VSIRmdir( const char * pszDirname )
     VSIFilesystemHandler *poFSHandler = 
         VSIFileManager::GetHandler( pszDirname );
 
+    VSIFileManager::InvalidateStatCache( pszDirname );
+
     return poFSHandler->Rmdir( pszDirname );
 }
 
@@ -411,6 +421,15 @@ int VSIStatL( const char * pszFilename, VSIStatBufL *psStatBuf )
  * which information is needed, which offers a potential for speed optimizations
  * on specialized and potentially slow virtual filesystem objects (/vsigzip/, /vsicurl/)
  *
+ * When the VSI_STAT_CACHE_TTL configuration option is set to a number of
+ * seconds, results, including failures, are cached for that long, which
+ * saves round trips when probing for side car files on network file
+ * systems.  Cached results are invalidated by the changes done through the
+ * VSI API (files opened for writing, VSIUnlink(), VSIRename(), VSIMkdir(),
+ * VSIRmdir()), but not by changes done by other means: see
+ * VSIClearStatCache().  The VSI_STAT_CACHE_SIZE configuration option sets
+ * the maximum number of cached results (10000 by default).
+ *
  * @param pszFilename the path of the filesystem object to be queried.  UTF-8 encoded.
  * @param psStatBuf the structure to load with information.
  * @param nFlags 0 to get all information, or VSI_STAT_EXISTS_FLAG, VSI_STAT_NATURE_FLAG or
@@ -442,7 +461,71 @@ int VSIStatExL( const char * pszFilename, VSIStatBufL *psStatBuf, int nFlags )
     if (nFlags == 0)
         nFlags = VSI_STAT_EXISTS_FLAG | VSI_STAT_NATURE_FLAG | VSI_STAT_SIZE_FLAG;
 
-    return poFSHandler->Stat( pszFilename, psStatBuf, nFlags );
+    return VSIFileManager::CachedStat( poFSHandler, pszFilename,
+                                       psStatBuf, nFlags );
+}
+
+/************************************************************************/
+/*                         VSIClearStatCache()                          */
+/************************************************************************/
+
+/**
+ * \brief Invalidate cached VSIStatExL() results.
+ *
+ * To be called when a file has been modified without going through the
+ * VSI API, if the VSI_STAT_CACHE_TTL configuration option is set.
+ *
+ * @param pszFilename the path whose cached result must be dropped, along
+ * with the one of its directory, or NULL to empty the cache.
+ *
+ * @since GDAL 2.0
+ */
+
+void VSIClearStatCache( const char * pszFilename )
+
+{
+    VSIFileManager::InvalidateStatCache( pszFilename );
+}
+
+/************************************************************************/
+/*                         VSIGetIOStatistics()                         */
+/************************************************************************/
+
+/**
+ * \brief Return the number of bytes read per filesystem handler.
+ *
+ * The counts cover the reads done with VSIFReadL() and VSIFReadMultiRangeL()
+ * on the files opened with VSIFOpenL(), since the start of the process or
+ * the last call to VSIResetIOStatistics().  Handlers that have not served
+ * any read are omitted.
+ *
+ * @return a list of BYTES_READ[prefix]=count strings, where prefix is the
+ * prefix of the handler (such as /vsicurl/), or "default" for regular
+ * files.  To be freed with CSLDestroy().
+ *
+ * @since GDAL 2.0
+ */
+
+char **VSIGetIOStatistics( void )
+
+{
+    return VSIFileManager::GetIOStatistics();
+}
+
+/************************************************************************/
+/*                        VSIResetIOStatistics()                        */
+/************************************************************************/
+
+/**
+ * \brief Reset the counters reported by VSIGetIOStatistics().
+ *
+ * @since GDAL 2.0
+ */
+
+void VSIResetIOStatistics( void )
+
+{
+    VSIFileManager::ResetIOStatistics();
 }
 
 /************************************************************************/
@@ -511,9 +594,22 @@ VSILFILE *VSIFOpenL( const char * pszFilename, const char * pszAccess )
     VSIFilesystemHandler *poFSHandler = 
         VSIFileManager::GetHandler( pszFilename );
         
+    const int bWrite = strchr( pszAccess, 'w' ) != NULL
+        || strchr( pszAccess, 'a' ) != NULL
+        || strchr( pszAccess, '+' ) != NULL;
+    if( bWrite )
+        VSIFileManager::InvalidateStatCache( pszFilename );
+
     VSILFILE* fp = (VSILFILE *) poFSHandler->Open( pszFilename, pszAccess );
 
     VSIDebug3( "VSIFOpenL(%s,%s) = %p", pszFilename, pszAccess, fp );
+
+    if( bWrite && fp != NULL )
+        VSIFileManager::RegisterWriteHandle( (VSIVirtualHandle *) fp,
+                                             pszFilename );
+    if( fp != NULL )
+        VSIFileManager::RegisterOpenHandle( (VSIVirtualHandle *) fp,
+                                            poFSHandler );
         
     return fp;
 }
@@ -545,6 +641,9 @@ int VSIFCloseL( VSILFILE * fp )
     VSIDebug1( "VSICloseL(%p)", fp );
     
     int nResult = poFileHandle->Close();
+
+    VSIFileManager::UnregisterWriteHandle( poFileHandle );
+    VSIFileManager::UnregisterOpenHandle( poFileHandle );
     
     delete poFileHandle;
 
@@ -675,7 +774,9 @@ size_t VSIFReadL( void * pBuffer, size_t nSize, size_t nCount, VSILFILE * fp )
 {
     VSIVirtualHandle *poFileHandle = (VSIVirtualHandle *) fp;
     
-    return poFileHandle->Read( pBuffer, nSize, nCount );
+    size_t nRet = poFileHandle->Read( pBuffer, nSize, nCount );
+    poFileHandle->nStatBytesRead += (GUIntBig) nRet * nSize;
+    return nRet;
 }
 
 
@@ -712,7 +813,13 @@ int VSIFReadMultiRangeL( int nRanges, void ** ppData,
 {
     VSIVirtualHandle *poFileHandle = (VSIVirtualHandle *) fp;
 
-    return poFileHandle->ReadMultiRange( nRanges, ppData, panOffsets, panSizes );
+    int nRet = poFileHandle->ReadMultiRange( nRanges, ppData, panOffsets, panSizes );
+    if( nRet == 0 )
+    {
+        for( int i = 0; i < nRanges; i++ )
+            poFileHandle->nStatBytesRead += panSizes[i];
+    }
+    return nRet;
 }
 
 /************************************************************************/
@@ -1061,6 +1168,10 @@ VSIFileManager::VSIFileManager()
 
 {
     poDefaultHandler = NULL;
+    hStatCacheMutex = NULL;
+    nWriteHandles = 0;
+    nStatCacheGeneration = 0;
+    hIOStatsMutex = NULL;
 }
 
 /************************************************************************/
@@ -1079,6 +1190,11 @@ VSIFileManager::~VSIFileManager()
     }
 
     delete poDefaultHandler;
+
+    if( hStatCacheMutex != NULL )
+        CPLDestroyMutex( hStatCacheMutex );
+    if( hIOStatsMutex != NULL )
+        CPLDestroyMutex( hIOStatsMutex );
 }
 
 
@@ -1189,6 +1305,308 @@ void VSIFileManager::InstallHandler( const std::string& osPrefix,
         Get()->oHandlers[osPrefix] = poHandler;
 }
 
+/************************************************************************/
+/*                             CachedStat()                             */
+/*                                                                      */
+/*      Stat() through the cache, if enabled.  Files currently open     */
+/*      for writing through the VSI API are never served from it.       */
+/************************************************************************/
+
+int VSIFileManager::CachedStat( VSIFilesystemHandler *poFSHandler,
+                                const char *pszFilename,
+                                VSIStatBufL *psStatBuf, int nFlags )
+
+{
+    const int nTTL = atoi( CPLGetConfigOption( "VSI_STAT_CACHE_TTL", "0" ) );
+
+    if( nTTL <= 0 || strncmp( pszFilename, "/vsimem/", 8 ) == 0 )
+        return poFSHandler->Stat( pszFilename, psStatBuf, nFlags );
+
+    VSIFileManager *poThis = Get();
+    const std::string osFilename( pszFilename );
+    GUIntBig nGeneration;
+
+/* -------------------------------------------------------------------- */
+/*      A failure answers all requests, a success only the ones         */
+/*      asking for no more information than it was obtained with.       */
+/* -------------------------------------------------------------------- */
+    {
+        CPLMutexHolderD( &poThis->hStatCacheMutex );
+
+        if( poThis->oMapFilesOpenForWriting.find( osFilename )
+            != poThis->oMapFilesOpenForWriting.end() )
+            return poFSHandler->Stat( pszFilename, psStatBuf, nFlags );
+
+        std::map<std::string, VSIStatCacheEntry>::iterator oIter =
+            poThis->oStatCache.find( osFilename );
+        if( oIter != poThis->oStatCache.end() )
+        {
+            const VSIStatCacheEntry &sEntry = oIter->second;
+            if( time( NULL ) - sEntry.nTime > nTTL )
+                poThis->oStatCache.erase( oIter );
+            else if( sEntry.nResult != 0 )
+            {
+                errno = ENOENT;
+                return sEntry.nResult;
+            }
+            else if( (nFlags & ~sEntry.nFlags) == 0 )
+            {
+                memcpy( psStatBuf, &sEntry.sStat, sizeof(VSIStatBufL) );
+                return 0;
+            }
+        }
+
+        nGeneration = poThis->nStatCacheGeneration;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Query the file system without holding the mutex.                */
+/* -------------------------------------------------------------------- */
+    VSIStatCacheEntry sEntry;
+
+    memset( &sEntry, 0, sizeof(sEntry) );
+    sEntry.nTime = time( NULL );
+    sEntry.nFlags = nFlags;
+    sEntry.nResult = poFSHandler->Stat( pszFilename, &sEntry.sStat, nFlags );
+
+    {
+        CPLMutexHolderD( &poThis->hStatCacheMutex );
+
+        const size_t nMaxEntries = (size_t)
+            atoi( CPLGetConfigOption( "VSI_STAT_CACHE_SIZE", "10000" ) );
+
+        // An invalidation happened while we were querying: our result
+        // may predate it, so leave it out of the cache.
+        if( poThis->nStatCacheGeneration == nGeneration && nMaxEntries > 0 )
+        {
+            if( poThis->oStatCache.size() >= nMaxEntries )
+            {
+                // Drop the expired entries, or everything if none is.
+                std::map<std::string, VSIStatCacheEntry>::iterator oIter =
+                    poThis->oStatCache.begin();
+                while( oIter != poThis->oStatCache.end() )
+                {
+                    if( sEntry.nTime - oIter->second.nTime > nTTL )
+                        poThis->oStatCache.erase( oIter++ );
+                    else
+                        ++oIter;
+                }
+                if( poThis->oStatCache.size() >= nMaxEntries )
+                    poThis->oStatCache.clear();
+            }
+
+            poThis->oStatCache[osFilename] = sEntry;
+        }
+    }
+
+    if( sEntry.nResult == 0 )
+        memcpy( psStatBuf, &sEntry.sStat, sizeof(VSIStatBufL) );
+
+    return sEntry.nResult;
+}
+
+/************************************************************************/
+/*                      InvalidateStatCacheEntry()                      */
+/*                                                                      */
+/*      Called with hStatCacheMutex held.  The directory is             */
+/*      invalidated too, as its modification time changes when an       */
+/*      entry is added or removed.                                      */
+/************************************************************************/
+
+void VSIFileManager::InvalidateStatCacheEntry( const std::string& osFilename )
+
+{
+    nStatCacheGeneration++;
+    oStatCache.erase( osFilename );
+
+    CPLString osDir( CPLGetPath( osFilename.c_str() ) );
+    if( osDir.size() == 0 )
+        osDir = ".";
+    oStatCache.erase( osDir );
+}
+
+/************************************************************************/
+/*                        InvalidateStatCache()                         */
+/************************************************************************/
+
+void VSIFileManager::InvalidateStatCache( const char *pszFilename )
+
+{
+    VSIFileManager *poThis = Get();
+
+    CPLMutexHolderD( &poThis->hStatCacheMutex );
+
+    if( pszFilename == NULL )
+    {
+        poThis->nStatCacheGeneration++;
+        poThis->oStatCache.clear();
+    }
+    else
+        poThis->InvalidateStatCacheEntry( pszFilename );
+}
+
+/************************************************************************/
+/*                        RegisterWriteHandle()                         */
+/*                                                                      */
+/*      The entry is invalidated again here, as the file may have       */
+/*      been stat'ed and cached between the invalidation done by        */
+/*      VSIFOpenL() and the end of Open().                              */
+/************************************************************************/
+
+void VSIFileManager::RegisterWriteHandle( VSIVirtualHandle *poHandle,
+                                          const char *pszFilename )
+
+{
+    if( atoi( CPLGetConfigOption( "VSI_STAT_CACHE_TTL", "0" ) ) <= 0 )
+        return;
+
+    VSIFileManager *poThis = Get();
+
+    CPLMutexHolderD( &poThis->hStatCacheMutex );
+
+    poThis->oMapWriteHandles[poHandle] = pszFilename;
+    poThis->oMapFilesOpenForWriting[pszFilename]++;
+    CPLAtomicInc( &poThis->nWriteHandles );
+
+    poThis->InvalidateStatCacheEntry( pszFilename );
+}
+
+/************************************************************************/
+/*                       UnregisterWriteHandle()                        */
+/************************************************************************/
+
+void VSIFileManager::UnregisterWriteHandle( VSIVirtualHandle *poHandle )
+
+{
+    VSIFileManager *poThis = Get();
+
+    // Only modified under hStatCacheMutex, but read here without it.
+    if( CPLAtomicAdd( &poThis->nWriteHandles, 0 ) == 0 )
+        return;
+
+    CPLMutexHolderD( &poThis->hStatCacheMutex );
+
+    std::map<VSIVirtualHandle *, std::string>::iterator oIter =
+        poThis->oMapWriteHandles.find( poHandle );
+    if( oIter == poThis->oMapWriteHandles.end() )
+        return;
+
+    const std::string osFilename( oIter->second );
+    poThis->oMapWriteHandles.erase( oIter );
+    CPLAtomicDec( &poThis->nWriteHandles );
+
+    if( --poThis->oMapFilesOpenForWriting[osFilename] == 0 )
+        poThis->oMapFilesOpenForWriting.erase( osFilename );
+
+    poThis->InvalidateStatCacheEntry( osFilename );
+}
+
+/************************************************************************/
+/*                         RegisterOpenHandle()                         */
+/************************************************************************/
+
+void VSIFileManager::RegisterOpenHandle( VSIVirtualHandle *poHandle,
+                                         VSIFilesystemHandler *poFSHandler )
+
+{
+    VSIFileManager *poThis = Get();
+
+    CPLMutexHolderD( &poThis->hIOStatsMutex );
+
+    poHandle->poStatHandler = poFSHandler;
+    poThis->oSetOpenHandles.insert( poHandle );
+}
+
+/************************************************************************/
+/*                        UnregisterOpenHandle()                        */
+/************************************************************************/
+
+void VSIFileManager::UnregisterOpenHandle( VSIVirtualHandle *poHandle )
+
+{
+    if( poHandle->poStatHandler == NULL )
+        return;
+
+    VSIFileManager *poThis = Get();
+
+    CPLMutexHolderD( &poThis->hIOStatsMutex );
+
+    poThis->oSetOpenHandles.erase( poHandle );
+    if( poHandle->nStatBytesRead != 0 )
+        poThis->oMapBytesRead[poHandle->poStatHandler] +=
+            poHandle->nStatBytesRead;
+}
+
+/************************************************************************/
+/*                          GetIOStatistics()                           */
+/************************************************************************/
+
+char **VSIFileManager::GetIOStatistics()
+
+{
+    VSIFileManager *poThis = Get();
+
+    CPLMutexHolderD( &poThis->hIOStatsMutex );
+
+    std::map<VSIFilesystemHandler *, GUIntBig> oMapBytesRead =
+        poThis->oMapBytesRead;
+    std::set<VSIVirtualHandle *>::const_iterator oIterHandle;
+    for( oIterHandle = poThis->oSetOpenHandles.begin();
+         oIterHandle != poThis->oSetOpenHandles.end();
+         ++oIterHandle )
+    {
+        if( (*oIterHandle)->nStatBytesRead != 0 )
+            oMapBytesRead[(*oIterHandle)->poStatHandler] +=
+                (*oIterHandle)->nStatBytesRead;
+    }
+
+    char **papszList = NULL;
+    std::map<VSIFilesystemHandler *, GUIntBig>::const_iterator oIter;
+    for( oIter = oMapBytesRead.begin(); oIter != oMapBytesRead.end(); ++oIter )
+    {
+        std::string osPrefix( "default" );
+        std::map<std::string, VSIFilesystemHandler *>::const_iterator
+            oIterPrefix;
+        for( oIterPrefix = poThis->oHandlers.begin();
+             oIterPrefix != poThis->oHandlers.end();
+             ++oIterPrefix )
+        {
+            if( oIterPrefix->second == oIter->first )
+            {
+                osPrefix = oIterPrefix->first;
+                break;
+            }
+        }
+
+        papszList = CSLAddString( papszList,
+            CPLSPrintf( "BYTES_READ[%s]=" CPL_FRMT_GUIB,
+                        osPrefix.c_str(), oIter->second ) );
+    }
+
+    return papszList;
+}
+
+/************************************************************************/
+/*                         ResetIOStatistics()                          */
+/************************************************************************/
+
+void VSIFileManager::ResetIOStatistics()
+
+{
+    VSIFileManager *poThis = Get();
+
+    CPLMutexHolderD( &poThis->hIOStatsMutex );
+
+    poThis->oMapBytesRead.clear();
+    std::set<VSIVirtualHandle *>::const_iterator oIterHandle;
+    for( oIterHandle = poThis->oSetOpenHandles.begin();
+         oIterHandle != poThis->oSetOpenHandles.end();
+         ++oIterHandle )
+    {
+        (*oIterHandle)->nStatBytesRead = 0;
+    }
+}
+
 /************************************************************************/
 /*                       VSICleanupFileManager()                        */
 /************************************************************************/